@@ -184,6 +184,8 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 					autostep = 0.1;
 					extstep = -1.0;
 					
+					useTreeCode = algo->get(Parameters::UseTreeCode).toBool();
+					openingAngle = algo->get(Parameters::TreeCodeOpeningAngle).toDouble();
 				}
 				
 				~PieceWiseKernel()
@@ -191,6 +193,7 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 				}
 				
 				//! Complexity O(M*N) ,where M is the number of nodes of the model and N is the numbder of nodes of the coil
+				//! or O(M*log(N)) with the tree code
 				virtual bool Integrate(FieldHandle& mesh, FieldHandle& coil, MatrixHandle& outdata)
 				{
 
@@ -224,6 +227,13 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 						coilNodes.push_back(Vector(enode2));
 					}
 
+					DiscretizeCoil();
+
+					if (useTreeCode)
+					{
+						tree.reset(new BiotSavartTreeCode(elementCenters, elementStrengths, openingAngle));
+					}
+
 					//! Start the multi threaded
 					Parallel::RunTasks([this](int i) { ParallelKernel(i); }, numprocessors_);
 					
@@ -252,6 +262,106 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 
 				//! keep nodes on the coil cached
 				std::vector<Vector> coilNodes;
+
+				//! infinitesimal curve-elements of all coil segments: their centers and
+				//! 1e-7 * current * element vector
+				std::vector<Point> elementCenters;
+				std::vector<Vector> elementStrengths;
+
+				//! evaluate the sum over the curve-elements with a Barnes-Hut tree
+				bool useTreeCode;
+				double openingAngle;
+				boost::shared_ptr<BiotSavartTreeCode> tree;
+
+				//! the curve-elements are the same for every model node, so they are computed once
+				void DiscretizeCoil()
+				{
+					double current = 1.0;
+
+					//! keep previous step length
+					//! used for optimization purpose
+					double prevSegLen = 123456789.12345678;
+
+					//! number of integration points
+					int nips = 0;
+
+					//! buffer of points used for integration
+					std::vector<Vector> integrPoints;
+					integrPoints.reserve(256);
+
+					elementCenters.clear();
+					elementStrengths.clear();
+
+					for( size_t iC0 = 0, iC1 =1, iCV = 0;
+						iC0 < coilNodes.size();
+						iC0+=2, iC1+=2, iCV++)
+					{
+						vcoilField->get_value(current,iCV);
+
+						current = current == 0.0 ? 1.0 : current;
+
+						Vector coilNodeThis;
+						Vector coilNodeNext;
+
+						if(current >= 0.0)
+						{
+							coilNodeThis = coilNodes[iC0];
+							coilNodeNext = coilNodes[iC1];
+						}
+						else
+						{
+							coilNodeThis = coilNodes[iC1];
+							coilNodeNext = coilNodes[iC0];
+						}
+
+						//! Length of the curve element
+						Vector diffNodes = coilNodeNext - coilNodeThis;
+						double newSegLen = diffNodes.length();
+
+						//first check if externally suplied integration step is available and use it
+						if(extstep > 0)
+						{
+							nips = newSegLen / extstep;
+						}
+						else
+						{
+							//! optimization
+							//! only rexompute integration step only if segment length changes
+							if( Abs(prevSegLen - newSegLen ) > 0.00000001 )
+							{
+								prevSegLen = newSegLen;
+
+								//auto adaptive integration step calculation
+								nips =  AdjustNumberOfIntegrationPoints(newSegLen);
+							}
+						}
+
+						if( nips < 3 )
+						{
+							algo_->warning("integration step too big");
+						}
+
+						integrPoints.clear();
+
+						//! curve segment discretization
+						for(int iip = 0; iip < nips; iip++)
+						{
+							double interpolant = static_cast<double>(iip) / static_cast<double>(nips);
+							Vector v = Interpolate( coilNodeThis, coilNodeNext, interpolant );
+							integrPoints.push_back( v );
+						}
+
+						for(int iip = 0; iip < nips -1; iip++)
+						{
+							//! center of the infinitesimal curve-element
+							elementCenters.push_back( Point( (integrPoints[iip] + integrPoints[iip+1] ) / 2 ) );
+
+							//! Infinitesimal curve-element components
+							Vector dLxyz = integrPoints[iip+1] - integrPoints[iip];
+							elementStrengths.push_back( 1.0e-7 * Abs(current) * dLxyz );
+						}
+					}
+				}
 				
 				//! execute in parallel
 				void ParallelKernel(int proc_num)
@@ -260,7 +370,6 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 					assert(proc_num >= 0);
 
 					int cnt = 0;
-					double current = 1.0; 
 					Point modelNode;
 
 					const index_type begins = (modelSize * proc_num) / numprocessors_;
@@ -268,16 +377,6 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 
 					assert( begins <= ends );
 
-					//! buffer of points used for integration
-					std::vector<Vector> integrPoints;
-					integrPoints.reserve(256);
-
-					//! keep previous step length
-					//! used for optimization purpose
-					double prevSegLen = 123456789.12345678;
-
-					//! number of integration points
-					int nips = 0;
 					index_type helpme=0;
 
 					try{
@@ -292,77 +391,27 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 							// result
 							Vector F;
 
-							for( size_t iC0 = 0, iC1 =1, iCV = 0; 
-								iC0 < coilNodes.size(); 
-								iC0+=2, iC1+=2, iCV++)
+							if (tree)
 							{
-								vcoilField->get_value(current,iCV);
-
-								current = current == 0.0 ? 1.0 : current;
-
-								Vector coilNodeThis;
-								Vector coilNodeNext;
-
-								if(current >= 0.0)
-								{
-									coilNodeThis = coilNodes[iC0];
-									coilNodeNext = coilNodes[iC1];
-								}
-								else
-								{
-									coilNodeThis = coilNodes[iC1];
-									coilNodeNext = coilNodes[iC0];
-								}
+								double nearest;
+								F = typeOut == 1 ? tree->field(modelNode, -1, &nearest) : tree->potential(modelNode, -1, &nearest);
 
-								//! Length of the curve element
-								Vector diffNodes = coilNodeNext - coilNodeThis;
-								double newSegLen = diffNodes.length();
-
-								//first check if externally suplied integration step is available and use it
-								if(extstep > 0)
+								//! same check as the direct sum below, for the sources the tree sums directly
+								if(nearest < 0.00001)
 								{
-									nips = newSegLen / extstep;
+									algo_->warning("coil<->model distance approaching zero!");
 								}
-								else
-								{
-									//! optimization
-									//! only rexompute integration step only if segment length changes
-									if( Abs(prevSegLen - newSegLen ) > 0.00000001 )
-									{
-										prevSegLen = newSegLen;
-
-										//auto adaptive integration step calculation
-										nips =  AdjustNumberOfIntegrationPoints(newSegLen);
-									}
-								}
-
-								if( nips < 3 )
-								{
-									algo_->warning("integration step too big");
-								}
-								
-								integrPoints.clear();
-								
-								//! curve segment discretization
-								for(int iip = 0; iip < nips; iip++)
-								{
-									double interpolant = static_cast<double>(iip) / static_cast<double>(nips);
-									Vector v = Interpolate( coilNodeThis, coilNodeNext, interpolant );
-									integrPoints.push_back( v );
-								}
-
-
-								//! integration step over line segment				
-								for(int iip = 0; iip < nips -1; iip++)								
+							}
+							else
+							{
+								//! integration over all curve-elements
+								for(size_t iE = 0; iE < elementCenters.size(); iE++)
 								{
-									//! Vector connecting the infinitesimal curve-element			
-									Vector Rxyz = (integrPoints[iip] + integrPoints[iip+1] ) / 2  - Vector(modelNode);
-
-									//! Infinitesimal curve-element components
-									Vector dLxyz = integrPoints[iip+1] - integrPoints[iip];
+									//! Vector connecting the infinitesimal curve-element
+									Vector Rxyz = elementCenters[iE] - modelNode;
 
 									double Rn = Rxyz.length();
-									
+
 									//! check for distance between coil and model close to zero
 									//! it might cause numerical stability issues with respect to the cross-product
 									if(Rn < 0.00001)
@@ -373,18 +422,15 @@ ALGORITHM_PARAMETER_DEF(BrainStimulator, OutType);
 									if(typeOut == 1)
 									{
 										//! Biot-Savart Magnetic Field
-										F +=  1.0e-7 * Cross( Rxyz, dLxyz ) * ( Abs(current) / (Rn*Rn*Rn) );
-									
-									}	
-								
+										F += Cross( Rxyz, elementStrengths[iE] ) * ( 1.0 / (Rn*Rn*Rn) );
+									}
+
 									if(typeOut == 2)
 									{
 										//! Biot-Savart Magnetic Vector Potential Field
-										F += 1.0e-7 * dLxyz * ( Abs(current) / (Rn) );
+										F += elementStrengths[iE] * ( 1.0 / Rn );
 									}
-									
 								}
-
 							}
 
 							matOut->put(iM,0, F[0]);
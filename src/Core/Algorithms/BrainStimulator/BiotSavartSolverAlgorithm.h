@@ -34,6 +34,7 @@
 #include <Core/Datatypes/Matrix.h>
 
 #include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/Algorithms/BrainStimulator/BiotSavartTreeCode.h>
 #include <Core/Algorithms/BrainStimulator/share.h>
 
 ///@file BiotSavartSolverAlgorithm
@@ -66,6 +67,8 @@ namespace BrainStimulator {
      //istep=0.0;
      //tfactor = 0;
      addParameter(Parameters::OutType,0);
+     addParameter(Parameters::UseTreeCode,false);
+     addParameter(Parameters::TreeCodeOpeningAngle,0.3);
     }
     AlgorithmOutput run(const AlgorithmInput& input) const override;
     bool run(FieldHandle mesh, FieldHandle coil, Datatypes::MatrixHandle &outdata, int outtype) const;
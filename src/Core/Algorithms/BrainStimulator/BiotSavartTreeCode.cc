@@ -0,0 +1,272 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/BrainStimulator/BiotSavartTreeCode.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/GeometryPrimitives/PointVectorOperators.h>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Algorithms::BrainStimulator;
+using namespace SCIRun::Core::Geometry;
+
+ALGORITHM_PARAMETER_DEF(BrainStimulator, UseTreeCode);
+ALGORITHM_PARAMETER_DEF(BrainStimulator, TreeCodeOpeningAngle);
+
+namespace
+{
+  const size_t leafSize = 16;
+  const int maxDepth = 32;
+}
+
+BiotSavartTreeCode::BiotSavartTreeCode(const std::vector<Point>& locations,
+  const std::vector<Vector>& strengths, double openingAngle) : theta_(openingAngle)
+{
+  if (locations.size() != strengths.size())
+    THROW_ALGORITHM_INPUT_ERROR_SIMPLE("Number of source locations and strengths do not match");
+
+  std::vector<size_t> order(locations.size());
+  std::iota(order.begin(), order.end(), 0);
+  location_.resize(locations.size());
+  for (size_t j = 0; j < locations.size(); j++)
+    location_[j] = Vector(locations[j]);
+  strength_ = strengths;
+
+  if (!order.empty())
+  {
+    cells_.reserve(2 * (order.size() / leafSize + 1));
+    // sort the sources in tree order while building, keeping track of where each went
+    std::vector<Vector> loc(location_), str(strength_);
+    slot_.swap(order);
+    build(0, slot_.size(), 0);
+    for (size_t i = 0; i < slot_.size(); i++)
+    {
+      location_[i] = loc[slot_[i]];
+      strength_[i] = str[slot_[i]];
+    }
+    std::vector<size_t> inverse(slot_.size());
+    for (size_t i = 0; i < slot_.size(); i++)
+      inverse[slot_[i]] = i;
+    slot_.swap(inverse);
+
+    // moments, from the sources in tree order
+    for (auto& cell : cells_)
+    {
+      Vector center(0, 0, 0);
+      for (size_t i = cell.begin; i < cell.end; i++)
+        center += location_[i];
+      center /= static_cast<double>(cell.end - cell.begin);
+
+      cell.center = center;
+      cell.radius = 0;
+      cell.Q = Vector(0, 0, 0);
+      std::fill(&cell.M[0][0], &cell.M[0][0] + 9, 0.0);
+      std::fill(&cell.T[0][0][0], &cell.T[0][0][0] + 27, 0.0);
+      for (size_t i = cell.begin; i < cell.end; i++)
+      {
+        const Vector e = location_[i] - center;
+        const Vector& q = strength_[i];
+        cell.radius = std::max(cell.radius, e.length());
+        cell.Q += q;
+        for (int k = 0; k < 3; k++)
+          for (int m = 0; m < 3; m++)
+          {
+            cell.M[k][m] += q[k] * e[m];
+            for (int n = 0; n < 3; n++)
+              cell.T[k][m][n] += q[k] * e[m] * e[n];
+          }
+      }
+    }
+  }
+}
+
+int BiotSavartTreeCode::build(size_t begin, size_t end, int depth)
+{
+  // slot_ holds the permutation while building
+  const int index = static_cast<int>(cells_.size());
+  cells_.push_back(Cell());
+  cells_[index].begin = begin;
+  cells_[index].end = end;
+  cells_[index].leaf = true;
+  std::fill(cells_[index].child, cells_[index].child + 8, -1);
+
+  Vector lo = location_[slot_[begin]], hi = lo;
+  for (size_t i = begin; i < end; i++)
+  {
+    lo = Min(lo, location_[slot_[i]]);
+    hi = Max(hi, location_[slot_[i]]);
+  }
+  if (end - begin <= leafSize || depth >= maxDepth || lo == hi)
+    return index;
+
+  // split into octants around the middle of the bounding box
+  const Vector mid = 0.5 * (lo + hi);
+  auto first = slot_.begin() + begin, last = slot_.begin() + end;
+  auto below = [this, &mid](int axis) { return [this, &mid, axis](size_t j) { return location_[j][axis] < mid[axis]; }; };
+  std::vector<size_t>::iterator bounds[9];
+  bounds[0] = first;
+  bounds[8] = last;
+  bounds[4] = std::partition(first, last, below(0));
+  bounds[2] = std::partition(first, bounds[4], below(1));
+  bounds[6] = std::partition(bounds[4], last, below(1));
+  for (int k = 0; k < 8; k += 2)
+    bounds[k + 1] = std::partition(bounds[k], bounds[k + 2], below(2));
+
+  cells_[index].leaf = false;
+  for (int k = 0; k < 8; k++)
+  {
+    if (bounds[k] != bounds[k + 1])
+    {
+      const int child = build(bounds[k] - slot_.begin(), bounds[k + 1] - slot_.begin(), depth + 1);
+      cells_[index].child[k] = child;
+    }
+  }
+  return index;
+}
+
+template <class Far, class Near>
+void BiotSavartTreeCode::traverse(const Vector& x, index_type exclude, Far far, Near near) const
+{
+  if (cells_.empty())
+    return;
+
+  const size_t excluded = exclude >= 0 ? slot_[exclude] : slot_.size();
+  int stack[8 * maxDepth + 8];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0)
+  {
+    const Cell& cell = cells_[stack[--top]];
+    const bool containsExcluded = excluded >= cell.begin && excluded < cell.end;
+    const Vector d = x - cell.center;
+    if (!containsExcluded && cell.radius < theta_ * d.length())
+      far(cell, d);
+    else if (cell.leaf)
+    {
+      for (size_t i = cell.begin; i < cell.end; i++)
+        if (i != excluded)
+          near(location_[i], strength_[i]);
+    }
+    else
+    {
+      for (int k = 0; k < 8; k++)
+        if (cell.child[k] >= 0)
+          stack[top++] = cell.child[k];
+    }
+  }
+}
+
+Vector BiotSavartTreeCode::field(const Point& p, index_type exclude, double* nearest) const
+{
+  const Vector x(p);
+  Vector F(0, 0, 0);
+  double closest = std::numeric_limits<double>::infinity();
+  traverse(x, exclude,
+    [&F](const Cell& cell, const Vector& d)
+    {
+      // Cross(q, H(d - e)) with H(v) = v/|v|^3, expanded to second order in e = y - center:
+      // H(d - e) = H(d) - J e + K[e, e]/2, with J and K the first and second derivatives of H.
+      // Summed over the cell this is Cross(Q, H(d)) plus the axial vector of
+      // N(k,l) = sum q_k * (K[e, e]/2 - J e)_l.
+      const double r2 = d.length2();
+      const double r = std::sqrt(r2);
+      const double inv3 = 1 / (r2 * r);
+      const double inv5 = inv3 / r2;
+      const double inv7 = inv5 / r2;
+      double N[3][3];
+      for (int k = 0; k < 3; k++)
+      {
+        double trace = 0, dTd = 0, Td[3], Md = 0;
+        for (int m = 0; m < 3; m++)
+        {
+          trace += cell.T[k][m][m];
+          Td[m] = cell.T[k][m][0] * d[0] + cell.T[k][m][1] * d[1] + cell.T[k][m][2] * d[2];
+          dTd += d[m] * Td[m];
+          Md += cell.M[k][m] * d[m];
+        }
+        for (int l = 0; l < 3; l++)
+        {
+          const double Je = cell.M[k][l] * inv3 - 3 * d[l] * Md * inv5;
+          const double Kee = -3 * (2 * Td[l] + d[l] * trace) * inv5 + 15 * d[l] * dTd * inv7;
+          N[k][l] = 0.5 * Kee - Je;
+        }
+      }
+      F += Cross(cell.Q, d) * inv3 + Vector(N[1][2] - N[2][1], N[2][0] - N[0][2], N[0][1] - N[1][0]);
+    },
+    [&F, &x, &closest](const Vector& y, const Vector& q)
+    {
+      const Vector R = x - y;
+      const double Rl = R.length();
+      closest = std::min(closest, Rl);
+      if (Rl > 0)
+        F += Cross(q, R) / (Rl * Rl * Rl);
+    });
+  if (nearest)
+    *nearest = closest;
+  return F;
+}
+
+Vector BiotSavartTreeCode::potential(const Point& p, index_type exclude, double* nearest) const
+{
+  const Vector x(p);
+  Vector A(0, 0, 0);
+  double closest = std::numeric_limits<double>::infinity();
+  traverse(x, exclude,
+    [&A](const Cell& cell, const Vector& d)
+    {
+      // 1/|d - e| = 1/|d| + Dot(d, e)/|d|^3 + (3 Dot(d, e)^2 - |d|^2 |e|^2) / (2 |d|^5) + ...
+      const double r2 = d.length2();
+      const double r = std::sqrt(r2);
+      const double inv3 = 1 / (r2 * r);
+      const double inv5 = inv3 / r2;
+      for (int k = 0; k < 3; k++)
+      {
+        double Md = 0, dTd = 0, trace = 0;
+        for (int m = 0; m < 3; m++)
+        {
+          Md += cell.M[k][m] * d[m];
+          trace += cell.T[k][m][m];
+          for (int n = 0; n < 3; n++)
+            dTd += d[m] * cell.T[k][m][n] * d[n];
+        }
+        A[k] += cell.Q[k] / r + Md * inv3 + 0.5 * (3 * dTd - r2 * trace) * inv5;
+      }
+    },
+    [&A, &x, &closest](const Vector& y, const Vector& q)
+    {
+      const double Rl = (x - y).length();
+      closest = std::min(closest, Rl);
+      if (Rl > 0)
+        A += q / Rl;
+    });
+  if (nearest)
+    *nearest = closest;
+  return A;
+}
@@ -0,0 +1,103 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_ALGORITHMS_BRAINSTIMULATOR_BIOTSAVARTTREECODE_H
+#define CORE_ALGORITHMS_BRAINSTIMULATOR_BIOTSAVARTTREECODE_H
+
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <Core/GeometryPrimitives/Point.h>
+#include <Core/GeometryPrimitives/Vector.h>
+#include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/Algorithms/BrainStimulator/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace BrainStimulator {
+
+  ALGORITHM_PARAMETER_DECL(UseTreeCode);
+  ALGORITHM_PARAMETER_DECL(TreeCodeOpeningAngle);
+
+  /// Barnes-Hut evaluation of the fields of a set of vector sources (current elements,
+  /// current dipoles, current density times cell volume) at arbitrary points:
+  ///
+  ///   field(x)     = sum_j Cross(q_j, x - y_j) / |x - y_j|^3
+  ///   potential(x) = sum_j q_j / |x - y_j|
+  ///
+  /// The sources are sorted into an octree. Every octree cell keeps the sum of its
+  /// strengths and their first and second moments about the cell center, so a cell
+  /// that is far from x compared to its size is evaluated as one expansion instead of
+  /// source by source. The opening angle is the largest cell radius / distance ratio
+  /// that is approximated: 0 evaluates every pair, smaller is more accurate. On coil
+  /// models, 0.3 gives relative errors of a few 1e-3 and 0.2 below 1e-3.
+  /// Evaluation is read only and may be called from several threads at once.
+  class SCISHARE BiotSavartTreeCode : boost::noncopyable
+  {
+  public:
+    BiotSavartTreeCode(const std::vector<Geometry::Point>& locations,
+      const std::vector<Geometry::Vector>& strengths, double openingAngle = 0.3);
+
+    /// Source number exclude (an index into the constructor arguments) is left out of the sum.
+    /// If nearest is given, it receives the distance to the closest source summed directly;
+    /// sources at distance zero are skipped, as their contribution is undefined.
+    Geometry::Vector field(const Geometry::Point& x, index_type exclude = -1, double* nearest = nullptr) const;
+    Geometry::Vector potential(const Geometry::Point& x, index_type exclude = -1, double* nearest = nullptr) const;
+
+    size_t size() const { return slot_.size(); }
+    size_t numCells() const { return cells_.size(); }
+
+  private:
+    struct Cell
+    {
+      Geometry::Vector center;
+      double radius;
+      size_t begin, end;
+      int child[8];
+      bool leaf;
+      // Sum of the strengths, and moments M(k,m) = sum q_k * e_m and
+      // T(k,m,n) = sum q_k * e_m * e_n, with e = y - center
+      Geometry::Vector Q;
+      double M[3][3];
+      double T[3][3][3];
+    };
+
+    int build(size_t begin, size_t end, int depth);
+    template <class Far, class Near>
+    void traverse(const Geometry::Vector& x, index_type exclude, Far far, Near near) const;
+
+    double theta_;
+    std::vector<Geometry::Vector> location_, strength_;
+    std::vector<size_t> slot_;
+    std::vector<Cell> cells_;
+  };
+
+}}}}
+
+#endif
@@ -60,6 +60,12 @@ AlgorithmInputName SimulateForwardMagneticFieldAlgo::DetectorLocations("Detector
 AlgorithmOutputName SimulateForwardMagneticFieldAlgo::MagneticField("MagneticField");
 AlgorithmOutputName SimulateForwardMagneticFieldAlgo::MagneticFieldMagnitudes("MagneticFieldMagnitudes");
 
+SimulateForwardMagneticFieldAlgo::SimulateForwardMagneticFieldAlgo()
+{
+  addParameter(Parameters::UseTreeCode, false);
+  addParameter(Parameters::TreeCodeOpeningAngle, 0.3);
+}
+
 class CalcFMField
 {
   public:
@@ -77,6 +83,7 @@ class CalcFMField
   private:
     void interpolate(int proc, Point p);
     void set_up_cell_cache();
+    void set_up_tree_code();
     void calc_parallel(int proc);
 
     const AlgorithmBase* algo_;
@@ -93,6 +100,10 @@ class CalcFMField
 
     std::vector<per_cell_cache>  cell_cache_;
 
+    // the cells (current density times volume) followed by the dipoles, summed with a tree
+    // code instead of one by one
+    boost::shared_ptr<BiotSavartTreeCode> tree_;
+
     VField* efld_; // Electric Field
     VField* ctfld_; // Conductivity Field
     VField* dipfld_; // Dipole Field
@@ -186,6 +197,30 @@ void CalcFMField::set_up_cell_cache()
   }
 }
 
+void CalcFMField::set_up_tree_code()
+{
+  std::vector<Point> locations;
+  std::vector<Vector> strengths;
+  for (const auto& c : cell_cache_)
+  {
+    locations.push_back(c.center_);
+    strengths.push_back(c.cur_density_ * c.volume_);
+  }
+
+  VMesh::size_type num_dipoles = dipmsh_->num_nodes();
+  Point pt;
+  Vector P;
+  for (VMesh::Node::index_type dip_idx = 0; dip_idx < num_dipoles; dip_idx++)
+  {
+    dipmsh_->get_center(pt, dip_idx);
+    dipfld_->value(P, dip_idx);
+    locations.push_back(pt);
+    strengths.push_back(P);
+  }
+
+  tree_.reset(new BiotSavartTreeCode(locations, strengths, algo_->get(Parameters::TreeCodeOpeningAngle).toDouble()));
+}
+
 void CalcFMField::calc_parallel(int proc)
 {
 
@@ -211,26 +246,37 @@ void CalcFMField::calc_parallel(int proc)
 
     detmsh_->get_center(pt, idx);
 
-    // init the interp val to 0
-    interp_value_[proc] = Vector(0,0,0);
-    interpolate(proc, pt);
-
-    mag_field = interp_value_[proc];
-
     Vector normal;
     detfld_->get_value(normal,idx);
 
-    // iterate over the dipoles.
-    for (VMesh::Node::index_type dip_idx = 0; dip_idx < num_dipoles; dip_idx++)
+    if (tree_)
+    {
+      // as in interpolate, the cell containing the detector is left out
+      emsh_->synchronize(Mesh::ELEM_LOCATE_E);
+      VMesh::Elem::index_type inside_cell = 0;
+      bool outside = !(emsh_->locate(inside_cell, pt));
+      mag_field = tree_->field(pt, outside ? -1 : static_cast<index_type>(inside_cell));
+    }
+    else
     {
-      dipmsh_->get_center(pt2, dip_idx);
-      dipfld_->value(P,dip_idx);
+      // init the interp val to 0
+      interp_value_[proc] = Vector(0,0,0);
+      interpolate(proc, pt);
 
-      Vector radius = pt - pt2; // detector - source
-      Vector valuePXR = Cross(P, radius);
-      double length = radius.length();
+      mag_field = interp_value_[proc];
+
+      // iterate over the dipoles.
+      for (VMesh::Node::index_type dip_idx = 0; dip_idx < num_dipoles; dip_idx++)
+      {
+        dipmsh_->get_center(pt2, dip_idx);
+        dipfld_->value(P,dip_idx);
 
-      mag_field += valuePXR / (length * length * length);
+        Vector radius = pt - pt2; // detector - source
+        Vector valuePXR = Cross(P, radius);
+        double length = radius.length();
+
+        mag_field += valuePXR / (length * length * length);
+      }
     }
 
     mag_field *= one_over_4_pi;
@@ -303,6 +349,9 @@ boost::tuple<FieldHandle,FieldHandle> CalcFMField::calc_forward_magnetic_field(F
   // cache per cell calculations that are used over and over again.
   set_up_cell_cache();
 
+  if (algo_->get(Parameters::UseTreeCode).toBool())
+    set_up_tree_code();
+
 #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
   // do the parallel work.
   Thread::parallel(this, &CalcFMField::calc_parallel, np_, mod);
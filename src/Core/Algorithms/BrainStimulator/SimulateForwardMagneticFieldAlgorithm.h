@@ -42,6 +42,7 @@
 
 #include <Core/Datatypes/MatrixFwd.h>
 #include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/Algorithms/BrainStimulator/BiotSavartTreeCode.h>
 #include <vector>
 #include <Core/Algorithms/BrainStimulator/share.h>
 
@@ -60,6 +61,7 @@ class SCISHARE SimulateForwardMagneticFieldAlgo : public AlgorithmBase
     static AlgorithmInputName DetectorLocations;
     static AlgorithmOutputName MagneticField;
     static AlgorithmOutputName MagneticFieldMagnitudes;
+    SimulateForwardMagneticFieldAlgo();
     boost::tuple<FieldHandle, FieldHandle> run(FieldHandle ElectricField, FieldHandle ConductivityTensors, FieldHandle DipoleSources, FieldHandle DetectorLocations) const;
     virtual AlgorithmOutput run(const AlgorithmInput &) const override;
  
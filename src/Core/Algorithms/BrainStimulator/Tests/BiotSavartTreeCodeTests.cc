@@ -0,0 +1,164 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Algorithms/BrainStimulator/BiotSavartTreeCode.h>
+#include <Core/GeometryPrimitives/PointVectorOperators.h>
+#include <cmath>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms::BrainStimulator;
+
+namespace
+{
+  // Current elements of a figure-of-eight coil made of two flat spirals above the origin
+  void figureOfEight(std::vector<Point>& centers, std::vector<Vector>& elements)
+  {
+    const int perTurn = 200, turns = 9;
+    for (int side = -1; side <= 1; side += 2)
+    {
+      for (int i = 0; i < perTurn * turns; i++)
+      {
+        const double a0 = 2 * M_PI * i / perTurn, a1 = 2 * M_PI * (i + 1) / perTurn;
+        const double r0 = 0.01 + 0.004 * a0 / (2 * M_PI), r1 = 0.01 + 0.004 * a1 / (2 * M_PI);
+        const Point p0(side * 0.05 + r0 * std::cos(a0), side * r0 * std::sin(a0), 0.1);
+        const Point p1(side * 0.05 + r1 * std::cos(a1), side * r1 * std::sin(a1), 0.1);
+        centers.push_back(Point(0.5 * (Vector(p0) + Vector(p1))));
+        elements.push_back(1e-7 * (p1 - p0));
+      }
+    }
+  }
+
+  std::vector<Point> targets()
+  {
+    std::vector<Point> points;
+    for (int i = 0; i < 12; i++)
+      for (int j = 0; j < 12; j++)
+        points.push_back(Point(-0.08 + 0.015 * i, -0.08 + 0.015 * j, 0.02 + 0.005 * ((i + j) % 5)));
+    return points;
+  }
+
+  Vector directField(const std::vector<Point>& y, const std::vector<Vector>& q, const Point& x, int exclude = -1)
+  {
+    Vector F(0, 0, 0);
+    for (size_t j = 0; j < y.size(); j++)
+    {
+      if (static_cast<int>(j) == exclude) continue;
+      const Vector R = x - y[j];
+      F += Cross(q[j], R) / (R.length() * R.length2());
+    }
+    return F;
+  }
+
+  Vector directPotential(const std::vector<Point>& y, const std::vector<Vector>& q, const Point& x)
+  {
+    Vector A(0, 0, 0);
+    for (size_t j = 0; j < y.size(); j++)
+      A += q[j] / (x - y[j]).length();
+    return A;
+  }
+}
+
+TEST(BiotSavartTreeCodeTests, MatchesDirectSumsWithinOpeningAngleAccuracy)
+{
+  std::vector<Point> centers;
+  std::vector<Vector> elements;
+  figureOfEight(centers, elements);
+  BiotSavartTreeCode tree(centers, elements, 0.2);
+  EXPECT_EQ(centers.size(), tree.size());
+  EXPECT_GT(tree.numCells(), 1u);
+
+  double errB = 0, normB = 0, errA = 0, normA = 0;
+  for (const auto& x : targets())
+  {
+    const Vector B = directField(centers, elements, x), A = directPotential(centers, elements, x);
+    errB += (tree.field(x) - B).length2();
+    normB += B.length2();
+    errA += (tree.potential(x) - A).length2();
+    normA += A.length2();
+  }
+  EXPECT_LT(std::sqrt(errB / normB), 2e-3);
+  EXPECT_LT(std::sqrt(errA / normA), 2e-3);
+}
+
+TEST(BiotSavartTreeCodeTests, ZeroOpeningAngleIsExact)
+{
+  std::vector<Point> centers;
+  std::vector<Vector> elements;
+  figureOfEight(centers, elements);
+  BiotSavartTreeCode tree(centers, elements, 0.0);
+
+  for (const auto& x : targets())
+  {
+    const Vector B = directField(centers, elements, x);
+    EXPECT_LT((tree.field(x) - B).length(), 1e-12 * B.length());
+  }
+}
+
+TEST(BiotSavartTreeCodeTests, ExcludedSourceIsLeftOut)
+{
+  std::vector<Point> centers;
+  std::vector<Vector> elements;
+  figureOfEight(centers, elements);
+  BiotSavartTreeCode tree(centers, elements, 0.0);
+
+  // evaluate right at a source, which is only finite when that source is skipped
+  const int k = 1234;
+  const Vector B = tree.field(centers[k], k);
+  const Vector expected = directField(centers, elements, centers[k], k);
+  EXPECT_TRUE(std::isfinite(B.length()));
+  EXPECT_LT((B - expected).length(), 1e-12 * expected.length());
+}
+
+TEST(BiotSavartTreeCodeTests, ReportsCoincidentSource)
+{
+  std::vector<Point> centers;
+  std::vector<Vector> elements;
+  figureOfEight(centers, elements);
+  BiotSavartTreeCode tree(centers, elements, 0.3);
+
+  const int k = 1234;
+  double nearest = -1;
+  const Vector B = tree.field(centers[k], -1, &nearest);
+  EXPECT_EQ(0.0, nearest);
+  EXPECT_TRUE(std::isfinite(B.length()));
+  EXPECT_TRUE(std::isfinite(tree.potential(centers[k], -1, &nearest).length()));
+  EXPECT_EQ(0.0, nearest);
+
+  tree.field(centers[k] + Vector(0.5, 0, 0), -1, &nearest);
+  EXPECT_GT(nearest, 0.0);
+}
+
+TEST(BiotSavartTreeCodeTests, NoSources)
+{
+  std::vector<Point> none;
+  BiotSavartTreeCode tree(none, std::vector<Vector>());
+  EXPECT_EQ(0u, tree.size());
+  EXPECT_EQ(Vector(0, 0, 0), tree.field(Point(1, 2, 3)));
+}
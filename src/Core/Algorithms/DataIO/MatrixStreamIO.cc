@@ -0,0 +1,81 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include <Core/Algorithms/DataIO/MatrixStreamIO.h>
+#include <Core/Utils/Exception.h>
+
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::DataIO;
+
+namespace
+{
+  typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor> ColumnMajor;
+}
+
+MatrixStreamHandle SCIRun::Core::Algorithms::DataIO::streamMatrixFromRawFile(const std::string& filename, size_t rows, size_t blockSize)
+{
+  if (0 == rows)
+    THROW_INVALID_ARGUMENT("Number of rows must be positive.");
+  if (!boost::filesystem::exists(filename))
+    THROW_INVALID_ARGUMENT("File not found: " + filename);
+
+  const auto bytes = boost::filesystem::file_size(filename);
+  const auto columnBytes = rows * sizeof(double);
+  if (bytes % columnBytes != 0)
+    THROW_INVALID_ARGUMENT("Size of " + filename + " is not a whole number of columns of " + std::to_string(rows) + " rows.");
+
+  // each read opens its own stream, so several consumers can pull from the file at once
+  return boost::make_shared<MatrixStream>(rows, bytes / columnBytes, blockSize,
+    [filename, rows, columnBytes](size_t first, size_t n)
+    {
+      ColumnMajor block(rows, n);
+      std::ifstream file(filename, std::ios::binary);
+      file.seekg(first * columnBytes);
+      file.read(reinterpret_cast<char*>(block.data()), n * columnBytes);
+      if (!file)
+        THROW_INVALID_ARGUMENT("Failed to read columns from " + filename);
+      return DenseMatrix(block);
+    });
+}
+
+void SCIRun::Core::Algorithms::DataIO::writeMatrixStreamToRawFile(const MatrixStream& stream, const std::string& filename)
+{
+  std::ofstream file(filename, std::ios::binary);
+  if (!file)
+    THROW_INVALID_ARGUMENT("Could not open file for writing: " + filename);
+
+  stream.forEachBlock([&file](size_t, const DenseMatrix& block)
+  {
+    const ColumnMajor columns(block);
+    file.write(reinterpret_cast<const char*>(columns.data()), columns.size() * sizeof(double));
+  });
+  if (!file)
+    THROW_INVALID_ARGUMENT("Failed to write " + filename);
+}
@@ -0,0 +1,52 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef ALGORITHMS_DATAIO_MATRIXSTREAMIO_H
+#define ALGORITHMS_DATAIO_MATRIXSTREAMIO_H
+
+#include <string>
+#include <Core/Datatypes/MatrixStream.h>
+#include <Core/Algorithms/DataIO/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace DataIO {
+
+  // Raw time series files hold native doubles in column-major order, one column (time sample)
+  // after another, so any window of columns is a single contiguous read.
+
+  /// Stream over a raw file with the given number of rows; the number of columns follows from its size.
+  SCISHARE Datatypes::MatrixStreamHandle streamMatrixFromRawFile(const std::string& filename, size_t rows, size_t blockSize);
+
+  /// Writes the stream block by block.
+  SCISHARE void writeMatrixStreamToRawFile(const Datatypes::MatrixStream& stream, const std::string& filename);
+
+}}}}
+
+#endif
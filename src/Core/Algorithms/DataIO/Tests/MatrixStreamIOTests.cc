@@ -0,0 +1,81 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include <Core/Algorithms/DataIO/MatrixStreamIO.h>
+#include <Core/Utils/Exception.h>
+
+using namespace SCIRun::Core;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::DataIO;
+
+namespace
+{
+  struct ScopedFile
+  {
+    ScopedFile() : path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("stream-%%%%-%%%%.raw")) {}
+    ~ScopedFile() { boost::filesystem::remove(path); }
+    boost::filesystem::path path;
+  };
+}
+
+TEST(MatrixStreamIOTests, RoundTripsThroughRawFile)
+{
+  auto m = boost::make_shared<DenseMatrix>(DenseMatrix::Random(5, 23));
+  ScopedFile file;
+  writeMatrixStreamToRawFile(*MatrixStream::fromMatrix(m, 4), file.path.string());
+  EXPECT_EQ(5 * 23 * sizeof(double), boost::filesystem::file_size(file.path));
+
+  auto stream = streamMatrixFromRawFile(file.path.string(), 5, 6);
+  EXPECT_EQ(5, stream->nrows());
+  ASSERT_EQ(23, stream->ncols());
+  EXPECT_EQ(4, stream->numBlocks());
+  EXPECT_EQ(m->middleCols(18, 5), stream->block(3));
+  EXPECT_EQ(*m, *stream->toDense());
+}
+
+TEST(MatrixStreamIOTests, ColumnsAreContiguousInFile)
+{
+  ScopedFile file;
+  {
+    std::ofstream out(file.path.string(), std::ios::binary);
+    const double values[] = { 1, 2, 3, 4, 5, 6 };
+    out.write(reinterpret_cast<const char*>(values), sizeof(values));
+  }
+  auto stream = streamMatrixFromRawFile(file.path.string(), 2, 10);
+  ASSERT_EQ(3, stream->ncols());
+  DenseMatrix expected(2, 3);
+  expected << 1, 3, 5,
+              2, 4, 6;
+  EXPECT_EQ(expected, stream->block(0));
+
+  EXPECT_THROW(streamMatrixFromRawFile(file.path.string(), 4, 10), InvalidArgumentException);
+  EXPECT_THROW(streamMatrixFromRawFile(file.path.string() + ".missing", 2, 10), InvalidArgumentException);
+}
@@ -0,0 +1,411 @@
+/*
+For more information, please see: http://software.sci.utah.edu
+
+The MIT License
+
+Copyright (c) 2015 Scientific Computing and Imaging Institute,
+University of Utah.
+
+License for the specific language governing rights and limitations under
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the "Software"),
+to deal in the Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute, sublicense,
+and/or sell copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <gtest/gtest.h>
+
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/MatrixTypeConversions.h>
+#include <Core/Algorithms/Legacy/Fields/MarchingCubes/MarchingCubes.h>
+#include <Core/Algorithms/Legacy/Fields/MarchingCubes/SpanSpace.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms;
+
+namespace
+{
+  // Block of n^3 cubes, each split into six tets, with the distance to an
+  // off center point as data
+  FieldHandle SphereTetVol(int n, int basis_order)
+  {
+    FieldInformation fi("TetVolMesh", basis_order, "double");
+    FieldHandle field = CreateField(fi);
+    VMesh* mesh = field->vmesh();
+
+    const Point center(0.43, 0.51, 0.47);
+    for (int k = 0; k <= n; k++)
+      for (int j = 0; j <= n; j++)
+        for (int i = 0; i <= n; i++)
+          mesh->add_point(Point(double(i)/n, double(j)/n, double(k)/n));
+
+    static const int tets[6][4] = { {0,1,3,7}, {0,1,5,7}, {0,2,3,7},
+                                    {0,2,6,7}, {0,4,5,7}, {0,4,6,7} };
+    VMesh::Node::array_type nodes(4);
+    for (int k = 0; k < n; k++)
+      for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+        {
+          index_type corner[8];
+          for (int c = 0; c < 8; c++)
+            corner[c] = (i + (c&1)) + (n+1)*((j + ((c>>1)&1)) + (n+1)*(k + ((c>>2)&1)));
+          for (int t = 0; t < 6; t++)
+          {
+            for (int c = 0; c < 4; c++) nodes[c] = corner[tets[t][c]];
+            mesh->add_elem(nodes);
+          }
+        }
+
+    VField* vfield = field->vfield();
+    vfield->resize_values();
+    if (basis_order == 0)
+    {
+      for (VMesh::Elem::index_type e = 0; e < mesh->num_elems(); e++)
+      {
+        Point p;
+        mesh->get_center(p, e);
+        vfield->set_value((p - center).length(), e);
+      }
+    }
+    else
+    {
+      for (VMesh::Node::index_type v = 0; v < mesh->num_nodes(); v++)
+      {
+        Point p;
+        mesh->get_center(p, v);
+        vfield->set_value((p - center).length(), v);
+      }
+    }
+    return field;
+  }
+
+  // Block of n^3 cubes as LatVolMesh, HexVolMesh or PrismVolMesh (two
+  // prisms per cube), with data that only takes the values 0 to 3, so
+  // isovalues can be put exactly on data values
+  FieldHandle LabeledBlock(const std::string& mesh_type, int n, int basis_order = 1)
+  {
+    FieldInformation fi(mesh_type, basis_order, "double");
+    FieldHandle field;
+    if (fi.is_structuredmesh())
+    {
+      MeshHandle mesh = CreateMesh(fi, n+1, n+1, n+1, Point(0,0,0), Point(1,1,1));
+      field = CreateField(fi, mesh);
+    }
+    else
+    {
+      field = CreateField(fi);
+      VMesh* mesh = field->vmesh();
+      for (int k = 0; k <= n; k++)
+        for (int j = 0; j <= n; j++)
+          for (int i = 0; i <= n; i++)
+            mesh->add_point(Point(double(i)/n, double(j)/n, double(k)/n));
+
+      static const int hex[1][8] = { {0,1,3,2,4,5,7,6} };
+      static const int prisms[2][8] = { {0,1,2,4,5,6}, {1,3,2,5,7,6} };
+      const bool is_hex = fi.is_hex_element();
+      const int num_cells = is_hex ? 1 : 2;
+      VMesh::Node::array_type nodes(is_hex ? 8 : 6);
+      for (int k = 0; k < n; k++)
+        for (int j = 0; j < n; j++)
+          for (int i = 0; i < n; i++)
+          {
+            index_type corner[8];
+            for (int c = 0; c < 8; c++)
+              corner[c] = (i + (c&1)) + (n+1)*((j + ((c>>1)&1)) + (n+1)*(k + ((c>>2)&1)));
+            for (int t = 0; t < num_cells; t++)
+            {
+              for (size_t c = 0; c < nodes.size(); c++)
+                nodes[c] = corner[is_hex ? hex[t][c] : prisms[t][c]];
+              mesh->add_elem(nodes);
+            }
+          }
+    }
+
+    VMesh* mesh = field->vmesh();
+    VField* vfield = field->vfield();
+    vfield->resize_values();
+    const Point center(0.43, 0.51, 0.47);
+    if (basis_order == 0)
+    {
+      for (VMesh::Elem::index_type e = 0; e < mesh->num_elems(); e++)
+      {
+        Point p;
+        mesh->get_center(p, e);
+        vfield->set_value(std::floor(6.0*(p - center).length()), e);
+      }
+    }
+    else
+    {
+      for (VMesh::Node::index_type v = 0; v < mesh->num_nodes(); v++)
+      {
+        Point p;
+        mesh->get_center(p, v);
+        vfield->set_value(std::floor(6.0*(p - center).length()), v);
+      }
+    }
+    return field;
+  }
+
+  struct Isosurface
+  {
+    FieldHandle field;
+    MatrixHandle node_interpolant;
+    MatrixHandle elem_interpolant;
+  };
+
+  Isosurface Extract(FieldHandle input, const std::vector<double>& isovalues, int num_threads,
+    MarchingCubesAlgo& algo)
+  {
+    algo.set(MarchingCubesAlgo::build_field, true);
+    algo.set(MarchingCubesAlgo::build_node_interpolant, true);
+    algo.set(MarchingCubesAlgo::build_elem_interpolant, true);
+    algo.set(MarchingCubesAlgo::num_threads, num_threads);
+    Isosurface iso;
+    algo.run(input, isovalues, iso.field, iso.node_interpolant, iso.elem_interpolant);
+    return iso;
+  }
+
+  Isosurface Extract(FieldHandle input, const std::vector<double>& isovalues, int num_threads)
+  {
+    MarchingCubesAlgo algo;
+    return Extract(input, isovalues, num_threads, algo);
+  }
+
+  void ExpectSameMatrix(MatrixHandle expected, MatrixHandle actual)
+  {
+    ASSERT_TRUE(expected != nullptr);
+    ASSERT_TRUE(actual != nullptr);
+    auto a = castMatrix::toSparse(expected);
+    auto b = castMatrix::toSparse(actual);
+    ASSERT_EQ(a->nrows(), b->nrows());
+    ASSERT_EQ(a->ncols(), b->ncols());
+    ASSERT_EQ(a->nonZeros(), b->nonZeros());
+    if (a->nonZeros() > 0)
+      EXPECT_EQ(0.0, (*a - *b).norm());
+  }
+
+  void ExpectSameIsosurface(const Isosurface& expected, const Isosurface& actual)
+  {
+    ASSERT_TRUE(expected.field != nullptr);
+    ASSERT_TRUE(actual.field != nullptr);
+    VMesh* emesh = expected.field->vmesh();
+    VMesh* amesh = actual.field->vmesh();
+    ASSERT_EQ(emesh->num_nodes(), amesh->num_nodes());
+    ASSERT_EQ(emesh->num_elems(), amesh->num_elems());
+
+    for (VMesh::Node::index_type i = 0; i < emesh->num_nodes(); i++)
+    {
+      Point p, q;
+      emesh->get_center(p, i);
+      amesh->get_center(q, i);
+      ASSERT_EQ(p, q);
+    }
+    VMesh::Node::array_type enodes, anodes;
+    for (VMesh::Elem::index_type i = 0; i < emesh->num_elems(); i++)
+    {
+      emesh->get_nodes(enodes, i);
+      amesh->get_nodes(anodes, i);
+      ASSERT_EQ(enodes.size(), anodes.size());
+      for (size_t k = 0; k < enodes.size(); k++)
+        ASSERT_EQ(enodes[k], anodes[k]);
+    }
+
+    ExpectSameMatrix(expected.node_interpolant, actual.node_interpolant);
+    ExpectSameMatrix(expected.elem_interpolant, actual.elem_interpolant);
+  }
+}
+
+TEST(MarchingCubesAlgoTests, ThreadedNodeDataMatchesSerial)
+{
+  FieldHandle input = SphereTetVol(8, 1);
+  std::vector<double> isovalues;
+  isovalues.push_back(0.25);
+  isovalues.push_back(0.4);
+
+  Isosurface serial = Extract(input, isovalues, 1);
+  ASSERT_TRUE(serial.field != nullptr);
+  EXPECT_GT(serial.field->vmesh()->num_elems(), 0);
+  EXPECT_EQ(serial.field->vmesh()->num_elems(), serial.elem_interpolant->nrows());
+  EXPECT_EQ(serial.field->vmesh()->num_nodes(), serial.node_interpolant->nrows());
+
+  // The number of ranges is capped at the number of cores, so the stitching
+  // is only exercised on machines with more than one
+  for (int num_threads = 2; num_threads <= 7; num_threads += 5)
+  {
+    Isosurface threaded = Extract(input, isovalues, num_threads);
+    ExpectSameIsosurface(serial, threaded);
+  }
+}
+
+TEST(MarchingCubesAlgoTests, ThreadedCellDataMatchesSerial)
+{
+  FieldHandle input = SphereTetVol(6, 0);
+  std::vector<double> isovalues;
+  isovalues.push_back(0.3);
+
+  Isosurface serial = Extract(input, isovalues, 1);
+  ASSERT_TRUE(serial.field != nullptr);
+  EXPECT_GT(serial.field->vmesh()->num_elems(), 0);
+
+  Isosurface threaded = Extract(input, isovalues, 5);
+  ExpectSameIsosurface(serial, threaded);
+}
+
+TEST(MarchingCubesAlgoTests, ThreadedHexAndPrismMatchSerial)
+{
+  const char* mesh_types[] = { "LatVolMesh", "HexVolMesh", "PrismVolMesh" };
+  for (const char* mesh_type : mesh_types)
+  {
+    for (int basis_order = 0; basis_order <= 1; basis_order++)
+    {
+      FieldHandle input = LabeledBlock(mesh_type, 7, basis_order);
+      std::vector<double> isovalues;
+      isovalues.push_back(0.5);
+      isovalues.push_back(2.0);
+
+      Isosurface serial = Extract(input, isovalues, 1);
+      ASSERT_TRUE(serial.field != nullptr);
+      EXPECT_GT(serial.field->vmesh()->num_elems(), 0) << mesh_type << " " << basis_order;
+
+      Isosurface threaded = Extract(input, isovalues, 4);
+      ExpectSameIsosurface(serial, threaded);
+    }
+  }
+}
+
+TEST(MarchingCubesAlgoTests, SpanSpaceFindsStraddlingCells)
+{
+  FieldHandle input = SphereTetVol(6, 1);
+  SpanSpace index;
+  EXPECT_FALSE(index.is_valid_for(input));
+  index.build(input);
+  EXPECT_TRUE(index.is_valid_for(input));
+  EXPECT_EQ(input->vmesh()->num_elems(), index.num_cells());
+
+  VMesh* mesh = input->vmesh();
+  VMesh::Node::array_type nodes;
+  std::vector<double> values;
+  // Includes the node values themselves, which lie on the ends of ranges
+  std::vector<double> isovalues;
+  for (double iso = -0.1; iso < 1.0; iso += 0.07)
+    isovalues.push_back(iso);
+  for (VMesh::Node::index_type v = 0; v < mesh->num_nodes(); v += 17)
+  {
+    double value;
+    input->vfield()->get_value(value, v);
+    isovalues.push_back(value);
+  }
+
+  for (double iso : isovalues)
+  {
+    std::vector<index_type> expected, found;
+    for (VMesh::Elem::index_type e = 0; e < mesh->num_elems(); e++)
+    {
+      mesh->get_nodes(nodes, e);
+      input->vfield()->get_values(values, nodes);
+      if (*std::min_element(values.begin(), values.end()) <= iso &&
+          iso <= *std::max_element(values.begin(), values.end()))
+        expected.push_back(e);
+    }
+    index.find_cells(iso, found);
+    EXPECT_EQ(expected, found);
+  }
+
+  FieldHandle copy(input->clone());
+  EXPECT_FALSE(index.is_valid_for(copy));
+}
+
+TEST(MarchingCubesAlgoTests, CellIndexGivesSameIsosurface)
+{
+  for (int basis_order = 0; basis_order <= 1; basis_order++)
+  {
+    FieldHandle input = SphereTetVol(6, basis_order);
+    MarchingCubesAlgo indexed;
+    indexed.set(MarchingCubesAlgo::build_cell_index, true);
+
+    // Scrubbing through isovalues reuses the index built on the first run
+    for (double iso = 0.1; iso < 0.6; iso += 0.15)
+    {
+      std::vector<double> isovalues(1, iso);
+      Isosurface full = Extract(input, isovalues, 1);
+      ExpectSameIsosurface(full, Extract(input, isovalues, 1, indexed));
+      ExpectSameIsosurface(full, Extract(input, isovalues, 3, indexed));
+    }
+  }
+}
+
+TEST(MarchingCubesAlgoTests, CellIndexCanBeSharedByConcurrentRuns)
+{
+  // Alternating fields make the runs replace each other's index
+  FieldHandle inputs[] = { SphereTetVol(5, 0), SphereTetVol(5, 1) };
+  std::vector<double> isovalues(1, 0.3);
+  Isosurface full[] = { Extract(inputs[0], isovalues, 1), Extract(inputs[1], isovalues, 1) };
+
+  MarchingCubesAlgo indexed;
+  indexed.set(MarchingCubesAlgo::build_cell_index, true);
+  indexed.set(MarchingCubesAlgo::build_field, true);
+  indexed.set(MarchingCubesAlgo::build_node_interpolant, true);
+  indexed.set(MarchingCubesAlgo::build_elem_interpolant, true);
+  indexed.set(MarchingCubesAlgo::num_threads, 1);
+
+  const int num_runs = 8;
+  std::vector<Isosurface> results(num_runs);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_runs; i++)
+    threads.emplace_back([&, i]()
+    {
+      Isosurface& iso = results[i];
+      indexed.run(inputs[i % 2], isovalues, iso.field, iso.node_interpolant, iso.elem_interpolant);
+    });
+  for (auto& t : threads)
+    t.join();
+
+  for (int i = 0; i < num_runs; i++)
+    ExpectSameIsosurface(full[i % 2], results[i]);
+}
+
+TEST(MarchingCubesAlgoTests, CellIndexKeepsCellsEndingAtIsovalue)
+{
+  // The hex and prism tesselators cut a cell whose largest node value equals
+  // the isovalue, so the index has to hand out those cells as well
+  const char* mesh_types[] = { "LatVolMesh", "HexVolMesh", "PrismVolMesh" };
+  for (const char* mesh_type : mesh_types)
+  {
+    FieldHandle input = LabeledBlock(mesh_type, 6);
+    MarchingCubesAlgo indexed;
+    indexed.set(MarchingCubesAlgo::build_cell_index, true);
+
+    for (double iso = 1.0; iso <= 2.0; iso += 0.5)
+    {
+      std::vector<double> isovalues(1, iso);
+      Isosurface full = Extract(input, isovalues, 1);
+      ASSERT_TRUE(full.field != nullptr);
+      EXPECT_GT(full.field->vmesh()->num_elems(), 0) << mesh_type << " " << iso;
+      ExpectSameIsosurface(full, Extract(input, isovalues, 1, indexed));
+      ExpectSameIsosurface(full, Extract(input, isovalues, 3, indexed));
+    }
+  }
+}
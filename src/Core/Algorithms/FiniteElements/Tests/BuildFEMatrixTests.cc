@@ -36,6 +36,7 @@
 #include <Core/Algorithms/DataIO/ReadMatrix.h>
 #include <Testing/Utils/SCIRunUnitTests.h>
 #include <Testing/Utils/MatrixTestUtilities.h>
+#include <Testing/Utils/SCIRunFieldSamples.h>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
@@ -161,6 +162,169 @@ TEST(BuildFEMatrixAlgorithmTests, TestMeshSize1e4)
   EXPECT_TRUE(expectedOutput("1e4.mat")->isApprox(*output));
 }
 
+namespace
+{
+  FieldHandle cubeWithConductivity(double sigma)
+  {
+    auto field = CubeTetVolConstantBasis(DOUBLE_E);
+    for (VMesh::Elem::index_type i = 0; i < field->vmesh()->num_elems(); ++i)
+      field->vfield()->set_value(sigma, i);
+    return field;
+  }
+
+  SparseRowMatrixHandle stiffness(const BuildFEMatrixAlgo& algo, FieldHandle field)
+  {
+    auto out = algo.run(withInputData((Variables::InputField, field)));
+    return out.get<SparseRowMatrix>(BuildFEMatrixAlgo::Stiffness_Matrix);
+  }
+}
+
+TEST(BuildFEMatrixAlgorithmTests, StiffnessMatrixOfTetCubeIsSymmetricWithZeroRowSums)
+{
+  BuildFEMatrixAlgo algo;
+  auto A = stiffness(algo, cubeWithConductivity(1.0));
+  ASSERT_THAT(A, NotNull());
+
+  EXPECT_EQ(8, A->nrows());
+  SparseRowMatrix At = A->transpose();
+  EXPECT_TRUE(At.isApprox(*A));
+  for (int i = 0; i < A->nrows(); ++i)
+  {
+    EXPECT_GT(A->coeff(i, i), 0.0);
+    double sum = 0;
+    for (SparseRowMatrix::InnerIterator it(*A, i); it; ++it)
+      sum += it.value();
+    EXPECT_NEAR(0.0, sum, 1e-12);
+  }
+}
+
+TEST(BuildFEMatrixAlgorithmTests, ReusesSparsityPatternWhenOnlyConductivitiesChange)
+{
+  auto field = cubeWithConductivity(1.0);
+
+  BuildFEMatrixAlgo algo;
+  auto first = stiffness(algo, field);
+  ASSERT_THAT(first, NotNull());
+
+  // Same mesh with other conductivities, as SetConductivitiesToTetMesh produces
+  FieldInformation fi(field);
+  FieldHandle scaled = CreateField(fi, field->mesh());
+  for (VMesh::Elem::index_type i = 0; i < field->vmesh()->num_elems(); ++i)
+    scaled->vfield()->set_value(2.5, i);
+
+  auto second = stiffness(algo, scaled);
+  ASSERT_THAT(second, NotNull());
+  EXPECT_EQ(first->nonZeros(), second->nonZeros());
+  SparseRowMatrix expected = 2.5 * *first;
+  EXPECT_TRUE(expected.isApprox(*second));
+
+  // Matches a build from scratch
+  BuildFEMatrixAlgo fresh;
+  EXPECT_TRUE(stiffness(fresh, scaled)->isApprox(*second));
+
+  // A different mesh gets its own pattern
+  auto other = stiffness(algo, TetrahedronTetVolConstantBasis(DOUBLE_E));
+  ASSERT_THAT(other, NotNull());
+  EXPECT_NE(first->nrows(), other->nrows());
+}
+
+TEST(BuildFEMatrixAlgorithmTests, RebuildsSparsityPatternWhenConnectivityIsEditedInPlace)
+{
+  FieldInformation fi(TETVOLMESH_E, CONSTANTDATA_E, DOUBLE_E);
+  auto field = CreateField(fi);
+  auto vmesh = field->vmesh();
+  vmesh->add_point(Point(0, 0, 0));
+  vmesh->add_point(Point(1, 0, 0));
+  vmesh->add_point(Point(0, 1, 0));
+  vmesh->add_point(Point(0, 0, 1));
+  vmesh->add_point(Point(1, 1, 1));
+  VMesh::Node::array_type nodes(4);
+  for (int i = 0; i < 4; ++i)
+    nodes[i] = i;
+  vmesh->add_elem(nodes);
+  for (int i = 0; i < 4; ++i)
+    nodes[i] = i + 1;
+  vmesh->add_elem(nodes);
+  field->vfield()->resize_values();
+  field->vfield()->set_all_values(1.0);
+
+  BuildFEMatrixAlgo algo;
+  auto before = stiffness(algo, field);
+  ASSERT_THAT(before, NotNull());
+  EXPECT_EQ(0.0, before->coeff(0, 4));
+
+  // same mesh object and sizes, but node 3 is now only in the first element
+  nodes[0] = 0; nodes[1] = 1; nodes[2] = 2; nodes[3] = 4;
+  vmesh->set_nodes(nodes, VMesh::Elem::index_type(1));
+  vmesh->clear_synchronization();
+
+  auto after = stiffness(algo, field);
+  ASSERT_THAT(after, NotNull());
+  BuildFEMatrixAlgo fresh;
+  auto expected = stiffness(fresh, field);
+  EXPECT_NE(0.0, after->coeff(0, 4));
+  EXPECT_EQ(expected->nonZeros(), after->nonZeros());
+  EXPECT_TRUE(expected->isApprox(*after));
+}
+
+TEST(BuildFEMatrixAlgorithmTests, LinearTetStiffnessMatchesClosedForm)
+{
+  FieldInformation fi(TETVOLMESH_E, CONSTANTDATA_E, DOUBLE_E);
+  auto field = CreateField(fi);
+  auto vmesh = field->vmesh();
+  vmesh->add_point(Point(0, 0, 0));
+  vmesh->add_point(Point(1, 0, 0));
+  vmesh->add_point(Point(0, 1, 0));
+  vmesh->add_point(Point(0, 0, 1));
+  VMesh::Node::array_type nodes(4);
+  for (int i = 0; i < 4; ++i)
+    nodes[i] = i;
+  vmesh->add_elem(nodes);
+  field->vfield()->resize_values();
+  field->vfield()->set_value(2.0, VMesh::Elem::index_type(0));
+
+  BuildFEMatrixAlgo algo;
+  auto A = stiffness(algo, field);
+  ASSERT_THAT(A, NotNull());
+
+  // sigma * volume * grad(N_i) . grad(N_j)
+  EXPECT_NEAR(1.0, A->coeff(0, 0), 1e-14);
+  EXPECT_NEAR(-1.0/3, A->coeff(0, 1), 1e-14);
+  EXPECT_NEAR(1.0/3, A->coeff(1, 1), 1e-14);
+  EXPECT_NEAR(0.0, A->coeff(1, 2), 1e-14);
+}
+
+TEST(BuildFEMatrixAlgorithmTests, TrilinearHexStiffnessMatchesClosedForm)
+{
+  FieldInformation fi(HEXVOLMESH_E, CONSTANTDATA_E, DOUBLE_E);
+  auto field = CreateField(fi);
+  auto vmesh = field->vmesh();
+  vmesh->add_point(Point(0, 0, 0));
+  vmesh->add_point(Point(1, 0, 0));
+  vmesh->add_point(Point(1, 1, 0));
+  vmesh->add_point(Point(0, 1, 0));
+  vmesh->add_point(Point(0, 0, 1));
+  vmesh->add_point(Point(1, 0, 1));
+  vmesh->add_point(Point(1, 1, 1));
+  vmesh->add_point(Point(0, 1, 1));
+  VMesh::Node::array_type nodes(8);
+  for (int i = 0; i < 8; ++i)
+    nodes[i] = i;
+  vmesh->add_elem(nodes);
+  field->vfield()->resize_values();
+  field->vfield()->set_value(1.0, VMesh::Elem::index_type(0));
+
+  BuildFEMatrixAlgo algo;
+  auto A = stiffness(algo, field);
+  ASSERT_THAT(A, NotNull());
+
+  // Unit cube: 1/3 on the diagonal, 0 along edges, -1/12 across faces and the body
+  EXPECT_NEAR(1.0/3, A->coeff(0, 0), 1e-10);
+  EXPECT_NEAR(0.0, A->coeff(0, 1), 1e-10);
+  EXPECT_NEAR(-1.0/12, A->coeff(0, 2), 1e-10);
+  EXPECT_NEAR(-1.0/12, A->coeff(0, 6), 1e-10);
+}
+
 // move to nightly: file too big for github unit test repo
 TEST(BuildFEMatrixAlgorithmTests, DISABLED_TestMeshSize1e5)
 {
@@ -0,0 +1,139 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+// Compares the CSR and SELL-C-sigma matrix-vector products used by the parallel
+// solvers on stiffness matrices produced by BuildFEMatrix. Not run by ctest; build
+// the Algorithms_FiniteElements_SpMVBenchmark target. Larger meshes are disabled;
+// run them with --gtest_also_run_disabled_tests. Correctness of the SELL products
+// is covered by SlicedEllpackMatrixTests.
+
+#include <chrono>
+#include <iomanip>
+#include <Testing/Utils/SCIRunUnitTests.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Algorithms/Legacy/FiniteElements/BuildMatrix/BuildFEMatrix.h>
+#include <Core/Algorithms/Math/ParallelAlgebra/ParallelLinearAlgebra.h>
+#include <Core/Algorithms/Math/ParallelAlgebra/SlicedEllpackMatrix.h>
+#include <Testing/Utils/MatrixTestUtilities.h>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::FiniteElements;
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::TestUtils;
+using ::testing::NotNull;
+
+namespace
+{
+  SparseRowMatrixHandle stiffnessMatrix(const std::string& file)
+  {
+    auto mesh = loadFieldFromFile(TestResources::rootDir() / "Fields" / "buildFE" / "inputFields" / file);
+    if (!mesh)
+      return nullptr;
+
+    BuildFEMatrixAlgo algo;
+    auto out = algo.run(withInputData((Variables::InputField, mesh)));
+    return out.get<SparseRowMatrix>(BuildFEMatrixAlgo::Stiffness_Matrix);
+  }
+
+  template <class Product>
+  double millisecondsPerProduct(Product product)
+  {
+    product();
+    const int repetitions = 50;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; ++i)
+      product();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repetitions;
+  }
+
+  void compareFormats(SparseRowMatrixHandle A)
+  {
+    ASSERT_THAT(A, NotNull());
+
+    SolverInputs system;
+    system.A = A;
+    system.b = boost::make_shared<DenseColumnMatrix>(A->ncols());
+    system.x = boost::make_shared<DenseColumnMatrix>(A->nrows());
+    system.x0 = system.x;
+    for (size_t i = 0; i < A->ncols(); ++i)
+      (*system.b)[i] = std::sin(0.001 * i);
+
+    ParallelLinearAlgebraSharedData data(system, 1);
+    ParallelLinearAlgebra PLA(data, 0);
+    ParallelLinearAlgebra::ParallelMatrix M;
+    ParallelLinearAlgebra::ParallelVector x, y;
+    ASSERT_TRUE(PLA.add_matrix(A, M));
+    ASSERT_TRUE(PLA.add_vector(system.b, x));
+    ASSERT_TRUE(PLA.add_vector(system.x, y));
+
+    auto csr = millisecondsPerProduct([&]() { PLA.mult(M, x, y); });
+    DenseColumnMatrix expected = *system.x;
+
+    auto start = std::chrono::steady_clock::now();
+    PLA.build_sliced_ellpack(M);
+    std::chrono::duration<double, std::milli> build = std::chrono::steady_clock::now() - start;
+
+    std::cout << std::fixed << std::setprecision(3)
+      << "rows " << A->nrows() << ", nonzeros " << A->nonZeros()
+      << ", SELL padding " << 100.0 * (M.sliced_->storedEntries() - A->nonZeros()) / A->nonZeros() << "%"
+      << ", SELL build " << build.count() << " ms\n"
+      << "  CSR              " << csr << " ms\n";
+
+    for (auto kernel : { SlicedEllpackMatrix::Kernel::Scalar, SlicedEllpackMatrix::Kernel::AVX2, SlicedEllpackMatrix::Kernel::AVX512 })
+    {
+      if (!SlicedEllpackMatrix::supports(kernel))
+        continue;
+      system.x->setZero();
+      auto sell = millisecondsPerProduct([&]() { M.sliced_->multiply(x.data_, y.data_, kernel); });
+      std::cout << "  SELL " << std::setw(8) << std::left << SlicedEllpackMatrix::kernelName(kernel) << std::right
+        << "    " << sell << " ms (" << csr / sell << "x)\n";
+      EXPECT_LT((*system.x - expected).norm(), 1e-12 * expected.norm());
+    }
+  }
+}
+
+TEST(SparseMatrixVectorBenchmark, FEMatrix1e4)
+{
+  compareFormats(stiffnessMatrix("fem_1e4_elements.fld"));
+}
+
+TEST(SparseMatrixVectorBenchmark, DISABLED_FEMatrix1e5)
+{
+  compareFormats(stiffnessMatrix("fem_1e5_elements.fld"));
+}
+
+TEST(SparseMatrixVectorBenchmark, DISABLED_FEMatrix1e6)
+{
+  compareFormats(stiffnessMatrix("fem_1e6_elements.fld"));
+}
@@ -244,7 +244,7 @@ ConvertBundleToFieldAlgo::run(BundleHandle& input, FieldHandle& output)
   size_type elems_count = 0;  
 
   Point P;
-  Point* points = 0;
+  const Point* points = 0;
   std::vector<int> values;
   int curval;
   if (match_node_values)
@@ -261,29 +261,21 @@ FieldHandle CalculateInsideWhichFieldAlgorithm::run(FieldHandle input,const std:
     
     VMesh::size_type numNodes = omesh->num_nodes();
     
-    int cnt = 0;
-    
+    std::vector<Point> points(numNodes);
     for(VMesh::Node::index_type idx=0; idx<numNodes;idx++)
+      omesh->get_center(points[idx],idx);
+    
+    // Locate all nodes in one go, so the object mesh can order the queries
+    // and reuse each hit as the guess for the next point
+    std::vector<VMesh::Elem::index_type> elems;
+    for (size_t p=0; p<objmesh.size(); p++)
     {
-      Point point;
-      VMesh::Elem::index_type cidx;
-      omesh->get_center(point,idx);
-      
-      for (size_t p=0; p<objmesh.size(); p++)
+      elems.clear();
+      objmesh[p]->mlocate(elems,points);
+      for(VMesh::Node::index_type idx=0; idx<numNodes;idx++)
       {
-        if (objmesh[p]->locate(cidx,point))
-        {
-          ofield->set_value(startValue+p,idx);
-        }
+        if (elems[idx] >= 0) ofield->set_value(startValue+p,idx);
       }
-      
-      // Progress Reporting
-      cnt++;
-     /* if (cnt == 100)
-      {
-        update_progress(idx/numNodes);
-        cnt = 0;
-      }*/
     }
   }
     return output;
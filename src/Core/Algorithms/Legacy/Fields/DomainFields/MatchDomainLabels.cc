@@ -92,7 +92,7 @@ run( FieldHandle input, FieldHandle domain, FieldHandle& output)
   }
 
   ofield->resize_values();
-  int* olabels = reinterpret_cast<int*>(ofield->get_values_pointer());
+  int* olabels = reinterpret_cast<int*>(ofield->mutable_values_pointer());
   
   std::vector<int> labels;
   ifield->get_values(labels);
@@ -71,8 +71,8 @@ CalculateVectorMagnitudesAlgo::run(FieldHandle input, FieldHandle& output)
   VField* ofield = output->vfield();  
   ofield->resize_values();
   
-  Vector* vec = reinterpret_cast<Vector*>(ifield->get_values_pointer());
-  double* mag = reinterpret_cast<double*>(ofield->get_values_pointer());
+  const Vector* vec = reinterpret_cast<const Vector*>(ifield->get_values_pointer());
+  double* mag = reinterpret_cast<double*>(ofield->mutable_values_pointer());
   
   VField::size_type num_values = ifield->num_values();
 
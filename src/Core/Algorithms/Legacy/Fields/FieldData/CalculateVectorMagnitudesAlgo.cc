@@ -74,8 +74,8 @@ CalculateVectorMagnitudesAlgo::run(FieldHandle input, FieldHandle& output) const
   if (num_fielddata!=num_nodes &&  num_fielddata!=num_elems)
     THROW_ALGORITHM_INPUT_ERROR("Input data inconsistent");
   
-  Vector* vec = reinterpret_cast<Vector*>(ifield->get_values_pointer());
-  double* mag = reinterpret_cast<double*>(ofield->get_values_pointer());
+  const Vector* vec = reinterpret_cast<const Vector*>(ifield->get_values_pointer());
+  double* mag = reinterpret_cast<double*>(ofield->mutable_values_pointer());
   
   if (!vec)
    THROW_ALGORITHM_INPUT_ERROR("Could not acces input field pointer");
@@ -137,8 +137,9 @@ bool DilateFieldDataNodeV(AlgoBase *algo, FieldHandle input, FieldHandle& output
   VMesh::Node::size_type sz;  
   vmesh->size(sz);
 
-  DATA* idata = reinterpret_cast<DATA*>(input->vfield()->fdata_pointer()); 
-  DATA* odata = reinterpret_cast<DATA*>(output->vfield()->fdata_pointer()); 
+  // input is the work buffer that is overwritten after every iteration
+  const DATA* idata = reinterpret_cast<const DATA*>(input->vfield()->mutable_fdata_pointer()); 
+  DATA* odata = reinterpret_cast<DATA*>(output->vfield()->mutable_fdata_pointer()); 
 
   for (int p=0; p <num_iter; p++)
   {
@@ -196,8 +197,9 @@ bool DilateFieldDataElemV(AlgoBase *algo, FieldHandle input, FieldHandle& output
   VMesh::Elem::size_type sz;  
   vmesh->size(sz);
 
-  DATA* idata = reinterpret_cast<DATA*>(input->vfield()->fdata_pointer()); 
-  DATA* odata = reinterpret_cast<DATA*>(output->vfield()->fdata_pointer()); 
+  // input is the work buffer that is overwritten after every iteration
+  const DATA* idata = reinterpret_cast<const DATA*>(input->vfield()->mutable_fdata_pointer()); 
+  DATA* odata = reinterpret_cast<DATA*>(output->vfield()->mutable_fdata_pointer()); 
   
   for (int p=0; p <num_iter; p++)
   {
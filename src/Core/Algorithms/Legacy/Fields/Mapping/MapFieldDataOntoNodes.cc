@@ -134,39 +134,41 @@ MapFieldDataOntoNodesPAlgo::parallel(int proc)
   }
   else
   {
+    // Fetch the node locations of this thread's range in one go
+    std::vector<Point> points(end-start);
+    if (end > start) omesh->get_points(VMesh::Node::index_type(start),
+      VMesh::Node::index_type(end), &points[0]);
+
     // To map value, gradient, or gradientnorm
     if (datasource->is_scalar())
     {
-      Point p; double val;
+      double val;
       for (VMesh::Node::index_type idx=start; idx<end; idx++)
       {
         checkForInterruption();
-        omesh->get_center(p,idx);
-        datasource->get_data(val,p);
+        datasource->get_data(val,points[idx-start]);
         ofield->set_value(val,idx);
         if (proc == 0) { cnt++; if (cnt == 400) {cnt = 0; algo_->update_progress_max(idx,end); } }
       }
     }
     else if (datasource->is_vector())
     {
-      Point p; Vector val;
+      Vector val;
       for (VMesh::Node::index_type idx=start; idx<end; idx++)
       {
         checkForInterruption();
-        omesh->get_center(p,idx);
-        datasource->get_data(val,p);
+        datasource->get_data(val,points[idx-start]);
         ofield->set_value(val,idx);
         if (proc == 0) { cnt++; if (cnt == 400) {cnt = 0; algo_->update_progress_max(idx,end); } }
       }
     }
     else
     {
-      Point p; Tensor val;
+      Tensor val;
       for (VMesh::Node::index_type idx=start; idx<end; idx++)
       {
         checkForInterruption();
-        omesh->get_center(p,idx);
-        datasource->get_data(val,p);
+        datasource->get_data(val,points[idx-start]);
         ofield->set_value(val,idx);
         if (proc == 0) { cnt++; if (cnt == 400) {cnt = 0; algo_->update_progress_max(idx,end); } }
       }
@@ -27,98 +27,272 @@
 */
 
 #include <Core/Algorithms/Legacy/Fields/MarchingCubes/BaseMC.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Thread/Parallel.h>
+#include <algorithm>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Thread;
+
+namespace
+{
+  // A tesselator on its own, or the parts merged into it
+  std::vector<const BaseMC*> sources(const BaseMC* part, const std::vector<const BaseMC*>& merged)
+  {
+    if (merged.empty()) return (std::vector<const BaseMC*>(1, part));
+    return (merged);
+  }
+}
 
 MatrixHandle BaseMC::get_interpolant()
 {
-  #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-   if( !build_field_ ) return (0);
-
-    // The columns represent the source nodes while the rows
-    // represent the destination nodes
-    const size_type nrows = static_cast<size_type>(edge_map_.size());
-    const size_type ncols = nnodes_;
-    
-    //  Yale Sparse Row Matrix format.
-    SparseRowMatrix::Data sparseData(nrows+1, nrows*2);
-    const SparseRowMatrix::Rows& rr = sparseData.rows();
-    const SparseRowMatrix::Columns& cc = sparseData.columns();
-    const SparseRowMatrix::Storage& dd = sparseData.data();
-    
-    edge_hash_type::iterator eiter = edge_map_.begin();
-    while (eiter != edge_map_.end())
-    {
-      const SCIRun::index_type ei = (*eiter).second;
-      
-      cc[ei * 2 + 0] = (*eiter).first.first;
-      cc[ei * 2 + 1] = (*eiter).first.second;
-      dd[ei * 2 + 0] = 1.0 - (*eiter).first.dfirst;
-      dd[ei * 2 + 1] = (*eiter).first.dfirst;
-          
-      ++eiter;
-    }
+  return (get_interpolant(std::vector<BaseMC*>(1, this)));
+}
+
+
+MatrixHandle BaseMC::get_parent_cells()
+{
+  return (get_parent_cells(std::vector<BaseMC*>(1, this)));
+}
+
+
+MatrixHandle BaseMC::get_interpolant(const std::vector<BaseMC*>& parts)
+{
+  if (parts.empty() || !parts[0]->build_field_) return (MatrixHandle());
 
-    size_type nnz = 0;
-    index_type i;
-    for (i = 0; i < nrows; i++)
+  // The columns represent the source nodes (or cells when surfacing cell
+  // data) while the rows represent the destination nodes (or faces)
+  const size_type ncols = (parts[0]->basis_order_ == 0) ? parts[0]->ncells_ : parts[0]->nnodes_;
+
+  std::vector<SparseRowMatrix::Triplet> entries;
+  size_type nrows = 0;
+  for (size_t k = 0; k < parts.size(); k++)
+  {
+    const std::vector<const BaseMC*> srcs = sources(parts[k], parts[k]->merged_);
+    for (size_t s = 0; s < srcs.size(); s++)
     {
-      rr[i] = nnz;
-      if (cc[i * 2 + 0] >= 0)
-      {
-        cc[nnz] = cc[i * 2 + 0];
-        dd[nnz] = dd[i * 2 + 0];
-        nnz++;
-      }
-      if (cc[i * 2 + 1] >= 0)
+      const edge_hash_type& edge_map = srcs[s]->edge_map_;
+      const std::vector<index_type>& row_remap = srcs[s]->row_remap_;
+      entries.reserve(entries.size() + 2*edge_map.size());
+
+      edge_hash_type::const_iterator eiter = edge_map.begin();
+      while (eiter != edge_map.end())
       {
-        cc[nnz] = cc[i * 2 + 1];
-        dd[nnz] = dd[i * 2 + 1];
-        nnz++;
+        const index_type local = (*eiter).second;
+        const index_type row = row_remap.empty() ? local : row_remap[local];
+        if (row >= 0)
+        {
+          if ((*eiter).first.first >= 0)
+            entries.push_back(SparseRowMatrix::Triplet(nrows + row, (*eiter).first.first, 1.0 - (*eiter).first.dfirst));
+          if ((*eiter).first.second >= 0)
+            entries.push_back(SparseRowMatrix::Triplet(nrows + row, (*eiter).first.second, (*eiter).first.dfirst));
+        }
+        ++eiter;
       }
     }
+    nrows += parts[k]->merged_.empty() ? static_cast<size_type>(parts[k]->edge_map_.size()) : parts[k]->merged_rows_;
+  }
 
-    rr[i] = nnz;
-  
-    return new SparseRowMatrix(nrows, ncols, sparseData, nnz);
-   #endif 
-    return MatrixHandle();
+  SparseRowMatrixHandle mat(new SparseRowMatrix(nrows, ncols));
+  mat->setFromTriplets(entries.begin(), entries.end());
+  return (mat);
 }
 
-  
-MatrixHandle BaseMC::get_parent_cells()
+
+MatrixHandle BaseMC::get_parent_cells(const std::vector<BaseMC*>& parts)
 {
-  #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-   if( !build_field_ ) return (0);
+  if (parts.empty() || !parts[0]->build_field_) return (MatrixHandle());
 
+  // The columns represent the source cells while the rows
+  // represent the destination cells
+  const size_type ncols = parts[0]->ncells_;
 
-    // The columns represent the source cells while the rows
-    // represent the destination cells
-    const size_type nrows = cell_map_.size();
-    const size_type ncols = ncells_;
+  // Merged parts keep their elements in order, so their cells just follow
+  // each other
+  std::vector<SparseRowMatrix::Triplet> entries;
+  size_type nrows = 0;
+  for (size_t k = 0; k < parts.size(); k++)
+  {
+    const std::vector<const BaseMC*> srcs = sources(parts[k], parts[k]->merged_);
+    for (size_t s = 0; s < srcs.size(); s++)
+    {
+      const std::vector<index_type>& cell_map = srcs[s]->cell_map_;
+      for (size_t i = 0; i < cell_map.size(); i++)
+        entries.push_back(SparseRowMatrix::Triplet(nrows + static_cast<index_type>(i), cell_map[i], 1.0));
+      nrows += static_cast<size_type>(cell_map.size());
+    }
+  }
+
+  SparseRowMatrixHandle mat(new SparseRowMatrix(nrows, ncols));
+  mat->setFromTriplets(entries.begin(), entries.end());
+  return (mat);
+}
+
+
+void BaseMC::merge(const std::vector<BaseMC*>& parts, const std::vector<FieldHandle>& fields)
+{
+  const size_t num_parts = parts.size();
+  if (num_parts == 0 || !fields[0]) return;
 
-    // Yale Sparse Row Matrix format.
-    SparseRowMatrix::Data sparseData(nrows+1, nrows);
-    const SparseRowMatrix::Rows& rr = sparseData.rows();
-    const SparseRowMatrix::Columns& cc = sparseData.columns();
-    const SparseRowMatrix::Storage& dd = sparseData.data();
+  VMesh* mesh = fields[0]->vmesh();
+  const int basis_order = parts[0]->basis_order_;
+  // Point clouds have no elements of their own
+  const bool elems_are_nodes = mesh->is_pointcloudmesh();
 
-    size_type nnz = nrows;
-    index_type i;
+  // Every output node is identified by the edge it was cut from when
+  // surfacing node data, or by the input node when surfacing cell data.
+  // Each part sorts its keys, so later parts can look up which of their
+  // nodes an earlier part already created.
+  typedef std::pair<index_type, index_type> key_type;
+  std::vector<std::vector<key_type> > keys(num_parts);
+  std::vector<std::vector<index_type> > sorted(num_parts);
+  std::vector<size_type> num_nodes(num_parts, 0);
+  std::vector<size_type> num_elems(num_parts, 0);
 
-    for (i = 0; i < nrows; i++)
+  Parallel::For(0, num_parts, 1, [&](size_t begin, size_t end)
+  {
+    for (size_t p = begin; p < end; p++)
     {
-      rr[i] = i;
+      if (!fields[p]) continue;
+      VMesh* pmesh = fields[p]->vmesh();
+      num_nodes[p] = pmesh->num_nodes();
+      num_elems[p] = pmesh->num_elems();
 
-      cc[i] = cell_map_[i];
-      dd[i] = 1;
+      std::vector<key_type>& key = keys[p];
+      key.assign(num_nodes[p], key_type(-1, -1));
+      if (basis_order == 0)
+      {
+        node_hash_type::const_iterator niter = parts[p]->node_map_.begin();
+        while (niter != parts[p]->node_map_.end())
+        {
+          key[(*niter).second] = key_type((*niter).first, -1);
+          ++niter;
+        }
+      }
+      else
+      {
+        edge_hash_type::const_iterator eiter = parts[p]->edge_map_.begin();
+        while (eiter != parts[p]->edge_map_.end())
+        {
+          key[(*eiter).second] = key_type((*eiter).first.first, (*eiter).first.second);
+          ++eiter;
+        }
+      }
+
+      // Only earlier parts are searched
+      if (p+1 == num_parts) continue;
+      std::vector<index_type>& order = sorted[p];
+      order.resize(num_nodes[p]);
+      for (index_type j = 0; j < num_nodes[p]; j++) order[j] = j;
+      std::sort(order.begin(), order.end(),
+        [&key](index_type a, index_type b) { return (key[a] < key[b]); });
     }
+  });
 
-    rr[i] = nrows;
+  // For every node the part that created it first and its index there. A node
+  // is looked up in the earlier parts in order, so the part found is the
+  // first one using it and the node is new in that part. New nodes are
+  // numbered in the order in which the part created them, which is the order
+  // a single pass over all cells would have created them in.
+  typedef std::pair<size_t, index_type> source_type;
+  std::vector<std::vector<source_type> > source(num_parts);
+  std::vector<size_type> num_new(num_parts, 0);
 
-    return new SparseRowMatrix(nrows, ncols, sparseData, nnz);
-  #endif  
-    return MatrixHandle();
-}
+  Parallel::For(0, num_parts, 1, [&](size_t begin, size_t end)
+  {
+    for (size_t p = begin; p < end; p++)
+    {
+      const std::vector<key_type>& key = keys[p];
+      std::vector<source_type>& src = source[p];
+      src.resize(num_nodes[p]);
+      size_type count = 0;
+      for (index_type j = 0; j < num_nodes[p]; j++)
+      {
+        src[j] = source_type(p, -1);
+        for (size_t q = 0; q < p; q++)
+        {
+          const std::vector<key_type>& qkey = keys[q];
+          std::vector<index_type>::const_iterator it = std::lower_bound(sorted[q].begin(), sorted[q].end(), key[j],
+            [&qkey](index_type a, const key_type& k) { return (qkey[a] < k); });
+          if (it != sorted[q].end() && qkey[*it] == key[j])
+          {
+            src[j] = source_type(q, *it);
+            break;
+          }
+        }
+        if (src[j].first == p) src[j].second = count++;
+      }
+      num_new[p] = count;
+    }
+  });
+
+  std::vector<size_type> node_offset(num_parts, 0);
+  std::vector<size_type> elem_offset(num_parts, 0);
+  for (size_t p = 1; p < num_parts; p++)
+  {
+    node_offset[p] = node_offset[p-1] + num_new[p-1];
+    elem_offset[p] = elem_offset[p-1] + num_elems[p-1];
+  }
+  const size_type total_nodes = node_offset[num_parts-1] + num_new[num_parts-1];
+  const size_type total_elems = elem_offset[num_parts-1] + num_elems[num_parts-1];
+
+  mesh->resize_nodes(total_nodes);
+  if (!elems_are_nodes) mesh->resize_elems(total_elems);
+
+  // Every part copies its new nodes and all its elements into the output
+  Parallel::For(1, num_parts, 1, [&](size_t begin, size_t end)
+  {
+    for (size_t p = begin; p < end; p++)
+    {
+      if (!fields[p]) continue;
+      VMesh* pmesh = fields[p]->vmesh();
+      const std::vector<source_type>& src = source[p];
 
+      std::vector<index_type> remap(num_nodes[p]);
+      Core::Geometry::Point pnt;
+      for (index_type j = 0; j < num_nodes[p]; j++)
+      {
+        const source_type& first = (src[j].first == p) ? src[j] : source[src[j].first][src[j].second];
+        remap[j] = node_offset[first.first] + first.second;
+        if (src[j].first == p)
+        {
+          pmesh->get_center(pnt, VMesh::Node::index_type(j));
+          mesh->set_point(pnt, VMesh::Node::index_type(remap[j]));
+        }
+      }
+
+      if (!elems_are_nodes)
+      {
+        VMesh::Node::array_type nodes;
+        for (VMesh::Elem::index_type e = 0; e < num_elems[p]; e++)
+        {
+          pmesh->get_nodes(nodes, e);
+          for (size_t k = 0; k < nodes.size(); k++) nodes[k] = remap[nodes[k]];
+          mesh->set_nodes(nodes, VMesh::Elem::index_type(elem_offset[p] + e));
+        }
+      }
+
+      // Interpolant rows are output nodes when surfacing node data and
+      // output elements otherwise
+      std::vector<index_type>& row_remap = parts[p]->row_remap_;
+      if (basis_order == 0 && !elems_are_nodes)
+      {
+        row_remap.resize(num_elems[p]);
+        for (index_type e = 0; e < num_elems[p]; e++) row_remap[e] = elem_offset[p] + e;
+      }
+      else
+      {
+        row_remap.resize(num_nodes[p]);
+        for (index_type j = 0; j < num_nodes[p]; j++) row_remap[j] = (src[j].first == p) ? remap[j] : -1;
+      }
+    }
+  });
+
+  // Rows of the interpolant, which for cell data is the number of faces: a
+  // face split into two triangles only records its parents for the first one
+  BaseMC* first = parts[0];
+  first->merged_.assign(parts.begin(), parts.end());
+  first->merged_rows_ = (basis_order == 0 && !elems_are_nodes) ? total_elems : total_nodes;
+}
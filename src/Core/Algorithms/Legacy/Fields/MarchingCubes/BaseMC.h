@@ -59,7 +59,7 @@ namespace SCIRun {
   public:
 
     BaseMC() : build_field_(false), build_geom_(false), basis_order_(-1),
-      nnodes_(0), ncells_(0) {}
+      nnodes_(0), ncells_(0), merged_rows_(0) {}
 
     virtual ~BaseMC() {}
 
@@ -77,6 +77,19 @@ namespace SCIRun {
     Core::Datatypes::MatrixHandle get_interpolant();
     Core::Datatypes::MatrixHandle get_parent_cells();
 
+    /// Same matrices for several tesselators, stacked row wise
+    static Core::Datatypes::MatrixHandle get_interpolant(const std::vector<BaseMC*>& parts);
+    static Core::Datatypes::MatrixHandle get_parent_cells(const std::vector<BaseMC*>& parts);
+
+    /// Merge the outputs (fields) of tesselators that processed consecutive
+    /// ranges of cells, given in cell order, into the field of the first one.
+    /// Also needed for a single part, before asking for its interpolant.
+    /// Points cut from edges or nodes that several ranges share are kept once.
+    /// The first tesselator is left with exactly the output and interpolants
+    /// it would have produced extracting all cells itself. Finding the shared
+    /// points and copying the output is done for all ranges in parallel.
+    static void merge(const std::vector<BaseMC*>& parts, const std::vector<FieldHandle>& fields);
+
     bool build_field_;
     bool build_geom_;
     int basis_order_;
@@ -98,14 +111,22 @@ namespace SCIRun {
     };
 
     typedef boost::unordered_map<edgepair_t, SCIRun::index_type, edgepairhash> edge_hash_type;
+    typedef boost::unordered_map<SCIRun::index_type, SCIRun::index_type> node_hash_type;
 
     std::vector<SCIRun::index_type> cell_map_;  // Unique cells when surfacing node data.
-    std::vector<SCIRun::index_type> node_map_;  // Unique nodes when surfacing cell data.
+    node_hash_type node_map_;  // Unique nodes when surfacing cell data, only the ones used.
 
     SCIRun::size_type nnodes_;
     SCIRun::size_type ncells_;
 
     edge_hash_type edge_map_;  // Unique edge cuts when surfacing node data
+
+    // Set by merge(): the parts merged into the first one, the number of rows
+    // of the merged interpolant, and for the other parts the row of each of
+    // their interpolant rows in the merged output (-1 if already present)
+    std::vector<const BaseMC*> merged_;
+    SCIRun::size_type merged_rows_;
+    std::vector<SCIRun::index_type> row_remap_;
   };
 
   inline bool operator==(const BaseMC::edgepair_t& lhs, const BaseMC::edgepair_t& rhs)
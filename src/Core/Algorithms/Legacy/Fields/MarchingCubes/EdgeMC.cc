@@ -62,7 +62,7 @@ void EdgeMC::reset( int /*n*/, bool build_field,bool build_geom,bool transparenc
     mesh_->synchronize(Mesh::EDGES_E|Mesh::ELEM_NEIGHBORS_E);
     if (build_field_)
     {
-      node_map_ = std::vector<index_type>(nsize, -1);
+      node_map_.clear();
     }
   }
  
@@ -202,9 +202,9 @@ VMesh::Node::index_type EdgeMC::find_or_add_edgepoint(index_type u0, index_type
 VMesh::Node::index_type EdgeMC::find_or_add_nodepoint(VMesh::Node::index_type &curve_node_idx)
 {
   VMesh::Node::index_type point_node_idx;
-  index_type i = node_map_[curve_node_idx];
-  if (i != -1) point_node_idx = (VMesh::Node::index_type) i;
-  else 
+  const node_hash_type::iterator loc = node_map_.find(curve_node_idx);
+  if (loc != node_map_.end()) point_node_idx = VMesh::Node::index_type((*loc).second);
+  else
   {
     Point p;
     mesh_->get_center(p, curve_node_idx);
@@ -67,7 +67,7 @@ void  HexMC::reset( int /*n*/, bool build_field, bool build_geom, bool transpare
     mesh_->synchronize(Mesh::FACES_E|Mesh::ELEM_NEIGHBORS_E);
     if (build_field_)
     {
-      node_map_ = std::vector<index_type>(nnodes_, -1);
+      node_map_.clear();
     }
   }
 
@@ -105,10 +105,9 @@ void  HexMC::reset( int /*n*/, bool build_field, bool build_geom, bool transpare
 VMesh::Node::index_type HexMC::find_or_add_nodepoint(VMesh::Node::index_type& tet_node_idx)
 {
   VMesh::Node::index_type surf_node_idx;
-  index_type i = node_map_[tet_node_idx];
-  
-  if (i != -1) surf_node_idx = VMesh::Node::index_type(i);
-  else 
+  const node_hash_type::iterator loc = node_map_.find(tet_node_idx);
+  if (loc != node_map_.end()) surf_node_idx = VMesh::Node::index_type((*loc).second);
+  else
   {
     Point p;
     mesh_->get_point(p, tet_node_idx);
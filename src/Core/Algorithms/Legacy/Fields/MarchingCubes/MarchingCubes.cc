@@ -35,7 +35,6 @@
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Algorithms/Legacy/Fields/MarchingCubes/MarchingCubes.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
-#include <Core/Algorithms/Math/AppendMatrix.h>
 #include <Core/Algorithms/Legacy/Fields/MergeFields/AppendFieldsAlgo.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 
@@ -46,6 +45,7 @@
 #include <Core/Algorithms/Legacy/Fields/MarchingCubes/TriMC.h>
 #include <Core/Algorithms/Legacy/Fields/MarchingCubes/QuadMC.h>
 #include <Core/Algorithms/Legacy/Fields/MarchingCubes/EdgeMC.h>
+#include <Core/Algorithms/Legacy/Fields/MarchingCubes/SpanSpace.h>
 
 #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
  #include <Core/Geom/GeomGroup.h>
@@ -59,9 +59,8 @@ using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Thread;
 using namespace SCIRun::Core::Algorithm::Fields;
-using namespace SCIRun::Core::Algorithm::Fields::Math;
 
-MarchingCubesAlgo::MarchingCubesAlgo()
+MarchingCubesAlgo::MarchingCubesAlgo() : cell_index_lock_("MarchingCubes cell index")
 {
   addParameter(transparency,false);
   addParameter(build_geometry,false);
@@ -69,6 +68,7 @@ MarchingCubesAlgo::MarchingCubesAlgo()
   addParameter(build_node_interpolant,false);
   addParameter(build_elem_interpolant,false);
   addParameter(num_threads,-1);
+  addParameter(build_cell_index,false);
 }
 
 AlgorithmParameterName MarchingCubesAlgo::transparency("transparency");
@@ -77,6 +77,7 @@ AlgorithmParameterName MarchingCubesAlgo::build_field("build_field");
 AlgorithmParameterName MarchingCubesAlgo::build_node_interpolant("build_node_interpolant");
 AlgorithmParameterName MarchingCubesAlgo::build_elem_interpolant("build_elem_interpolant");
 AlgorithmParameterName MarchingCubesAlgo::num_threads("num_threads");
+AlgorithmParameterName MarchingCubesAlgo::build_cell_index("build_cell_index");
 
 AlgorithmOutput MarchingCubesAlgo::run(const AlgorithmInput& input) const
 {
@@ -91,23 +92,24 @@ class MarchingCubesAlgoP {
 
   public:
 
-    MarchingCubesAlgoP(FieldHandle input,const std::vector<double>& iso_values) :
+    MarchingCubesAlgoP(FieldHandle input,const std::vector<double>& iso_values,
+                       const SpanSpace* cell_index) :
      input_(input),
-     iso_values_(iso_values) { }
+     iso_values_(iso_values),
+     cell_index_(cell_index) { }
 
     ~MarchingCubesAlgoP()
     {
-      #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-       delete_all_items(tesselator_);
-      #endif
+      for (size_t j=0; j<tesselator_.size(); j++)
+        delete tesselator_[j];
     }
 
     FieldHandle    input_;
 
+    /// One tesselator per iso value and range of cells, stored as
+    /// iso*nproc+proc
     std::vector<TESSELATOR*>   tesselator_;
     std::vector<FieldHandle>  output_field_;
-    std::vector<MatrixHandle> output_interpolant_matrix_;
-    std::vector<MatrixHandle> output_parent_cell_matrix_;
     #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
      std::vector<GeomHandle>   output_geometry_;
     #endif
@@ -120,15 +122,17 @@ class MarchingCubesAlgoP {
 
     const std::vector<double>& iso_values_;
     const AlgorithmBase* algo_;
+    /// When given, only the cells it lists in active_cells_ are visited
+    const SpanSpace* cell_index_;
+    std::vector<std::vector<index_type> > active_cells_;
 
     bool run(const AlgorithmBase* algo, FieldHandle& output,
              MatrixHandle& node_interpolant,MatrixHandle& elem_interpolant );
 
-    void parallel(int proc, int nproc, size_t iso);
+    void parallel(int proc, int nproc);
 
   private:
     AppendFieldsAlgorithm append_fields_;
-    AppendMatrixAlgorithm append_matrices_;
 
 };
 
@@ -157,28 +161,18 @@ MarchingCubesAlgoP<TESSELATOR>::run(const AlgorithmBase* algo,
 {
   algo_ = algo;
 
- #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-  int np = algo->get_int("num_threads");
-  /// By default (-1) choose number of processors
-  if (np < 1) np = Thread::numProcessors();
-  /// Cap the number of threads
-  if (np > 4*Thread::numProcessors()) np = 4*Thread::numProcessors();
-  */
-  /// @todo: FIX MULTI THREADING OF MARCHING CUBES FIELDS ARE NOT PROPORLY LINKED
- #endif
-  int np = Parallel::NumCores();
+  const size_t num_values = iso_values_.size();
+  const VMesh::size_type num_elems = input_->vmesh()->num_elems();
 
-  np = 1;
-  size_t num_values = iso_values_.size();
-
-  tesselator_.resize(np);
-  for (size_t j=0; j<tesselator_.size(); j++)
-    tesselator_[j] = new TESSELATOR(input_);
-
-  output_field_.resize(np*num_values);
-  output_interpolant_matrix_.resize(np*num_values);
-  output_parent_cell_matrix_.resize(np*num_values);
-  //output_geometry_.resize(np*num_values);
+  /// By default (-1) choose number of processors
+  int np = algo->get(MarchingCubesAlgo::num_threads).toInt();
+  const int ncores = static_cast<int>(Parallel::NumCores());
+  if (np < 1) np = ncores;
+  /// Every thread holds a tesselator per iso value, so more threads than
+  /// cores only cost memory
+  if (np > ncores) np = ncores;
+  if (np > num_elems) np = static_cast<int>(num_elems);
+  if (np < 1) np = 1;
 
   build_field_ = algo->get(MarchingCubesAlgo::build_field).toBool();
   build_geometry_ = algo->get(MarchingCubesAlgo::build_geometry).toBool();
@@ -186,25 +180,56 @@ MarchingCubesAlgoP<TESSELATOR>::run(const AlgorithmBase* algo,
   build_elem_interpolant_ = algo->get(MarchingCubesAlgo::build_elem_interpolant).toBool();
   transparency_ = algo->get(MarchingCubesAlgo::transparency).toBool();
 
+  // Resetting synchronizes the input mesh and creates the output fields,
+  // which is done up front so the extraction itself only reads the input.
+  tesselator_.resize(np*num_values);
+  for (size_t j=0; j<tesselator_.size(); j++)
+  {
+    tesselator_[j] = new TESSELATOR(input_);
+    tesselator_[j]->reset(0, build_field_, build_geometry_, transparency_);
+  }
+
  #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
   append_fields_.set_progress_reporter(algo->get_progress_reporter());
-  append_matrices_.set_progress_reporter(algo->get_progress_reporter());
-  append_matrices_.setOption("method","append_rows");
  #endif
 
-  for (size_t j=0; j<iso_values_.size(); j++)
+  if (cell_index_)
   {
-    if (np == 1)
-    {
-      parallel(0,1,j);
-    }
-    else
+    active_cells_.resize(num_values);
+    for (size_t j=0; j<num_values; j++)
+      cell_index_->find_cells(iso_values_[j], active_cells_[j]);
+  }
+
+  // Every thread extracts all iso values from its own range of cells in a
+  // single pass
+  Parallel::For(0, np, 1, [this, np](size_t begin, size_t end)
+  {
+    for (size_t proc = begin; proc < end; proc++)
+      parallel(static_cast<int>(proc), np);
+  });
+
+  // Stitch the ranges together in cell order, which yields the same nodes,
+  // elements and interpolants as a serial extraction
+  output_field_.resize(num_values);
+  std::vector<BaseMC*> merged(num_values);
+  for (size_t j=0; j<num_values; j++)
+  {
+    TESSELATOR* first = tesselator_[j*np];
+    merged[j] = first;
+    if (!build_field_) continue;
+
+    const double isoval = iso_values_[j];
+    std::vector<BaseMC*> parts(np);
+    std::vector<FieldHandle> fields(np);
+    for (int proc=0; proc<np; proc++)
     {
-      #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-       Thread::parallel(this,&MarchingCubesAlgoP<TESSELATOR>::parallel,np,np,j);
-      #endif
+      parts[proc] = tesselator_[j*np+proc];
+      fields[proc] = parts[proc]->get_field(isoval);
     }
+    BaseMC::merge(parts, fields);
+    output_field_[j] = first->get_field(isoval);
   }
+
   #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
   if (output_geometry_.size() == 0)
   {
@@ -229,19 +254,15 @@ MarchingCubesAlgoP<TESSELATOR>::run(const AlgorithmBase* algo,
       return (false);
   }
 
- #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
   if (build_node_interpolant_)
   {
-    if (!(append_matrices_.run(output_interpolant_matrix_,node_interpolant)))
-      return (false);
+    node_interpolant = BaseMC::get_interpolant(merged);
   }
 
   if (build_elem_interpolant_)
   {
-    if (!(append_matrices_.run(output_parent_cell_matrix_,elem_interpolant)))
-      return (false);
+    elem_interpolant = BaseMC::get_parent_cells(merged);
   }
- #endif
 
   return (true);
 }
@@ -258,45 +279,61 @@ bool MarchingCubesAlgo::run(FieldHandle input, const std::vector<double>& isoval
 
   FieldInformation fi(input);
 
+  // run() may be called concurrently: a stale index is replaced rather than
+  // rebuilt in place, so a run still using it keeps a valid copy
+  boost::shared_ptr<const SpanSpace> index;
+  if (get(build_cell_index).toBool() && !fi.is_pnt_element() && !fi.is_nodata() && fi.is_scalar())
+  {
+    Guard g(cell_index_lock_.get());
+    if (!cell_index_ || !cell_index_->is_valid_for(input))
+    {
+      boost::shared_ptr<SpanSpace> fresh(new SpanSpace);
+      fresh->build(input);
+      cell_index_ = fresh;
+    }
+    index = cell_index_;
+  }
+  const SpanSpace* cell_index = index.get();
+
   if (fi.is_pnt_element())
   {
     error("Field needs to have elements in order to extract isosurfaces");
   }
   else if (fi.is_crv_element())
   {
-    MarchingCubesAlgoP<EdgeMC> algo(input,isovalues);
+    MarchingCubesAlgoP<EdgeMC> algo(input,isovalues,cell_index);
     success = algo.run(this,field,node_interpolant,elem_interpolant);
   }
   else if (fi.is_tri_element())
   {
-    MarchingCubesAlgoP<TriMC> algo(input,isovalues);
+    MarchingCubesAlgoP<TriMC> algo(input,isovalues,cell_index);
     success = algo.run(this,field,node_interpolant,elem_interpolant);
   }
   else if (fi.is_quad_element())
   {
-    MarchingCubesAlgoP<QuadMC> algo(input,isovalues);
+    MarchingCubesAlgoP<QuadMC> algo(input,isovalues,cell_index);
     success = algo.run(this,field,node_interpolant,elem_interpolant);
   }
   else if (fi.is_tet_element())
   {
-    MarchingCubesAlgoP<TetMC> algo(input,isovalues);
+    MarchingCubesAlgoP<TetMC> algo(input,isovalues,cell_index);
     success = algo.run(this,field,node_interpolant,elem_interpolant);
   }
   else if (fi.is_prism_element())
   {
-    MarchingCubesAlgoP<PrismMC> algo(input,isovalues);
+    MarchingCubesAlgoP<PrismMC> algo(input,isovalues,cell_index);
     success = algo.run(this,field,node_interpolant,elem_interpolant);
   }
   else if (fi.is_hex_element())
   {
     if (fi.is_structuredmesh())
     {
-      MarchingCubesAlgoP<HexMC> algo(input,isovalues);
+      MarchingCubesAlgoP<HexMC> algo(input,isovalues,cell_index);
       success = algo.run(this,field,node_interpolant,elem_interpolant);
     }
     else
     {
-      MarchingCubesAlgoP<UHexMC> algo(input,isovalues);
+      MarchingCubesAlgoP<UHexMC> algo(input,isovalues,cell_index);
       success = algo.run(this,field,node_interpolant,elem_interpolant);
     }
   }
@@ -306,10 +343,8 @@ bool MarchingCubesAlgo::run(FieldHandle input, const std::vector<double>& isoval
 
 
 template<class TESSELATOR>
-void MarchingCubesAlgoP<TESSELATOR>::parallel( int proc, int nproc, size_t iso)
+void MarchingCubesAlgoP<TESSELATOR>::parallel( int proc, int nproc)
 {
-  tesselator_[proc]->reset(0, build_field_, build_geometry_, transparency_);
-
   VMesh*  imesh  = input_->vmesh();
 
   VMesh::size_type num_elems = imesh->num_elems();
@@ -317,69 +352,63 @@ void MarchingCubesAlgoP<TESSELATOR>::parallel( int proc, int nproc, size_t iso)
   index_type start = (proc)*(num_elems/nproc);
   index_type end = (proc < nproc-1) ? (proc+1)*(num_elems/nproc) : num_elems;
 
+  const size_t num_values = iso_values_.size();
   index_type cnt = 0;
-  size_type total = (num_elems*iso_values_.size()/nproc);
-  index_type offset = (num_elems*iso/nproc);
-  double isoval = iso_values_[iso];
 
-  for(VMesh::Elem::index_type idx= start ; idx<end; idx++)
+  if (cell_index_)
   {
-    tesselator_[proc]->extract(idx, isoval);
+    // Same partitioning, applied to the cells listed by the index
+    for (size_t iso=0; iso<num_values; iso++)
+    {
+      const std::vector<index_type>& cells = active_cells_[iso];
+      const size_t num_cells = cells.size();
+      const size_t first = proc*(num_cells/nproc);
+      const size_t last = (proc < nproc-1) ? (proc+1)*(num_cells/nproc) : num_cells;
+      for (size_t j=first; j<last; j++)
+        tesselator_[iso*nproc+proc]->extract(VMesh::Elem::index_type(cells[j]), iso_values_[iso]);
+    }
+  }
+  else for(VMesh::Elem::index_type idx= start ; idx<end; idx++)
+  {
+    for (size_t iso=0; iso<num_values; iso++)
+      tesselator_[iso*nproc+proc]->extract(idx, iso_values_[iso]);
     if (proc == 0)
     {
       cnt++;
       if (cnt == 300)
       {
         cnt = 0;
-        algo_->update_progress(idx+offset/total);
+        algo_->update_progress((idx-start)/static_cast<double>(end-start));
       }
     }
   }
 
-  output_field_[iso*nproc+proc] = 0;
-  output_interpolant_matrix_[iso*nproc+proc] = 0;
-  output_parent_cell_matrix_[iso*nproc+proc] = 0;
-
-  #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-   output_geometry_[iso*nproc+proc] = 0;
-  #endif
-
-  if (build_field_)
-  {
-    output_field_[iso*nproc+proc] = tesselator_[proc]->get_field(isoval);
-  }
-  if (build_node_interpolant_)
-  {
-    output_interpolant_matrix_[iso*nproc+proc] = tesselator_[proc]->get_interpolant();
-  }
-  if (build_elem_interpolant_)
-  {
-    output_parent_cell_matrix_[iso*nproc+proc] = tesselator_[proc]->get_parent_cells();
-  }
-
   #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
-  if (build_geometry_)
+  for (size_t iso=0; iso<num_values && build_geometry_; iso++)
   {
-    MaterialHandle mathandle;
-    ColorMapHandle colormap;
-    colormap = algo_->get_colormap("colormap");
-    if (colormap.get_rep())
+    const double isoval = iso_values_[iso];
     {
-      mathandle = colormap->lookup(isoval);
-    }
-    else
-    {
-      Color color = algo_->get_color("color");
-      mathandle = new Material(color);
-    }
-    if (mathandle.get_rep())
-    {
-      GeomHandle geom = tesselator_[proc]->get_geom();
-      output_geometry_[iso*nproc+proc] = new GeomMaterial(geom,mathandle);
-    }
-    else
-    {
-      output_geometry_[iso*nproc+proc] = 0;
+      MaterialHandle mathandle;
+      ColorMapHandle colormap;
+      colormap = algo_->get_colormap("colormap");
+      if (colormap.get_rep())
+      {
+        mathandle = colormap->lookup(isoval);
+      }
+      else
+      {
+        Color color = algo_->get_color("color");
+        mathandle = new Material(color);
+      }
+      if (mathandle.get_rep())
+      {
+        GeomHandle geom = tesselator_[iso*nproc+proc]->get_geom();
+        output_geometry_[iso*nproc+proc] = new GeomMaterial(geom,mathandle);
+      }
+      else
+      {
+        output_geometry_[iso*nproc+proc] = 0;
+      }
     }
   }
   #endif
@@ -37,15 +37,20 @@
 
 #include <string>
 #include <vector>
+#include <boost/shared_ptr.hpp>
 
 #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
  #include <Core/Algorithms/Util/AlgoBase.h>
 #endif
 
 #include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <Core/Thread/Mutex.h>
 #include <Core/Algorithms/Legacy/Fields/share.h>
 
 namespace SCIRun {
+
+ class SpanSpace;
+
  namespace Core {
   namespace Algorithms {
 
@@ -62,6 +67,10 @@ namespace SCIRun {
     static AlgorithmParameterName build_node_interpolant;
     static AlgorithmParameterName build_elem_interpolant;
     static AlgorithmParameterName num_threads;
+    /// Keep an index of the value range of every cell, so that extracting
+    /// another isovalue from the same field only visits the cells the
+    /// isosurface passes through
+    static AlgorithmParameterName build_cell_index;
 
    #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
    {
@@ -83,6 +92,10 @@ namespace SCIRun {
              FieldHandle& field,
              Datatypes::MatrixHandle& node_interpolant,
              Datatypes::MatrixHandle& elem_interpolant ) const;
+
+    private:
+     mutable boost::shared_ptr<const SpanSpace> cell_index_;
+     mutable Core::Thread::Mutex cell_index_lock_;
    };
 
   }
@@ -61,7 +61,7 @@ void QuadMC::reset( int /*n*/, bool build_field, bool build_geom, bool transpare
     mesh_->synchronize(Mesh::EDGES_E|Mesh::ELEM_NEIGHBORS_E);
     if (build_field_)
     {
-      node_map_ = std::vector<index_type>(nsize, -1);
+      node_map_.clear();
     }
   }
  
@@ -109,9 +109,9 @@ void QuadMC::find_or_add_parent(index_type u0, index_type u1, double d0, index_t
 VMesh::Node::index_type QuadMC::find_or_add_nodepoint(VMesh::Node::index_type &tri_node_idx)
 {
   VMesh::Node::index_type curve_node_idx;
-  index_type i = node_map_[tri_node_idx];
-  if (i != -1) curve_node_idx = VMesh::Node::index_type(i);
-  else 
+  const node_hash_type::iterator loc = node_map_.find(tri_node_idx);
+  if (loc != node_map_.end()) curve_node_idx = VMesh::Node::index_type((*loc).second);
+  else
   {
     Point p;
     mesh_->get_point(p, tri_node_idx);
@@ -0,0 +1,187 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+   */
+
+
+#include <Core/Algorithms/Legacy/Fields/MarchingCubes/SpanSpace.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/Mesh.h>
+
+#include <algorithm>
+
+using namespace SCIRun;
+
+SpanSpace::SpanSpace() :
+  field_id_(-1), mesh_id_(-1), basis_order_(-1), num_values_(0)
+{
+}
+
+
+bool
+SpanSpace::is_valid_for(FieldHandle field) const
+{
+  return (field && field->id() == field_id_ && field->mesh()->id() == mesh_id_ &&
+          field->basis_order() == basis_order_ &&
+          field->vfield()->num_values() == num_values_ &&
+          field->vmesh()->num_elems() == num_cells());
+}
+
+
+void
+SpanSpace::build(FieldHandle field)
+{
+  VMesh*  mesh  = field->vmesh();
+  VField* vfield = field->vfield();
+
+  field_id_ = field->id();
+  mesh_id_ = field->mesh()->id();
+  basis_order_ = field->basis_order();
+  num_values_ = vfield->num_values();
+
+  const VMesh::size_type num_elems = mesh->num_elems();
+  min_.resize(num_elems);
+  max_.resize(num_elems);
+
+  std::vector<double> values;
+  if (basis_order_ == 0)
+  {
+    mesh->synchronize(Mesh::DELEMS_E|Mesh::ELEM_NEIGHBORS_E);
+    VMesh::Elem::array_type neighbors;
+    for (VMesh::Elem::index_type idx = 0; idx < num_elems; idx++)
+    {
+      double self;
+      vfield->get_value(self, idx);
+      mesh->get_neighbors(neighbors, idx);
+      double mx = self;
+      if (!neighbors.empty())
+      {
+        vfield->get_values(values, neighbors);
+        mx = *std::max_element(values.begin(), values.end());
+      }
+      min_[idx] = self;
+      max_[idx] = mx;
+    }
+  }
+  else
+  {
+    VMesh::Node::array_type nodes;
+    for (VMesh::Elem::index_type idx = 0; idx < num_elems; idx++)
+    {
+      mesh->get_nodes(nodes, idx);
+      vfield->get_values(values, nodes);
+      min_[idx] = *std::min_element(values.begin(), values.end());
+      max_[idx] = *std::max_element(values.begin(), values.end());
+    }
+  }
+
+  // Cells with an empty range never contribute
+  std::vector<index_type> cells;
+  cells.reserve(num_elems);
+  for (index_type idx = 0; idx < num_elems; idx++)
+  {
+    if (min_[idx] < max_[idx]) cells.push_back(idx);
+  }
+
+  tree_.clear();
+  by_min_.clear();
+  by_max_.clear();
+  by_min_.reserve(cells.size());
+  by_max_.reserve(cells.size());
+  build_tree(cells);
+}
+
+
+index_type
+SpanSpace::build_tree(std::vector<index_type>& cells)
+{
+  if (cells.empty()) return (-1);
+
+  // Split at the median of the range midpoints, so each side gets at most
+  // half of the ranges that do not contain the center
+  std::vector<double> mid(cells.size());
+  for (size_t j = 0; j < cells.size(); j++)
+    mid[j] = 0.5*(min_[cells[j]] + max_[cells[j]]);
+  std::nth_element(mid.begin(), mid.begin() + mid.size()/2, mid.end());
+  const double center = mid[mid.size()/2];
+
+  std::vector<index_type> left, right;
+  const index_type begin = static_cast<index_type>(by_min_.size());
+  for (size_t j = 0; j < cells.size(); j++)
+  {
+    const index_type c = cells[j];
+    if (max_[c] <= center) left.push_back(c);
+    else if (min_[c] > center) right.push_back(c);
+    else { by_min_.push_back(c); by_max_.push_back(c); }
+  }
+  const index_type end = static_cast<index_type>(by_min_.size());
+  cells.clear();
+  cells.shrink_to_fit();
+
+  std::sort(by_min_.begin() + begin, by_min_.end(),
+    [this](index_type a, index_type b) { return (min_[a] < min_[b]); });
+  std::sort(by_max_.begin() + begin, by_max_.end(),
+    [this](index_type a, index_type b) { return (max_[a] > max_[b]); });
+
+  const index_type node = static_cast<index_type>(tree_.size());
+  TreeNode n = { center, begin, end, -1, -1 };
+  tree_.push_back(n);
+
+  const index_type l = build_tree(left);
+  const index_type r = build_tree(right);
+  tree_[node].left = l;
+  tree_[node].right = r;
+  return (node);
+}
+
+
+void
+SpanSpace::find_cells(double iso, std::vector<index_type>& cells) const
+{
+  cells.clear();
+  index_type node = tree_.empty() ? -1 : 0;
+  while (node >= 0)
+  {
+    const TreeNode& n = tree_[node];
+    if (iso <= n.center)
+    {
+      // All ranges here end above center, so above iso. On the left, ranges
+      // ending exactly at iso = center still count.
+      for (index_type j = n.begin; j < n.end && min_[by_min_[j]] <= iso; j++)
+        cells.push_back(by_min_[j]);
+      node = n.left;
+    }
+    else
+    {
+      // All ranges here start at or below center, so below iso
+      for (index_type j = n.begin; j < n.end && max_[by_max_[j]] >= iso; j++)
+        cells.push_back(by_max_[j]);
+      node = n.right;
+    }
+  }
+  std::sort(cells.begin(), cells.end());
+}
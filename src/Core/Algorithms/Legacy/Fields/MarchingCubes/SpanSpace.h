@@ -0,0 +1,103 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+   */
+
+
+#ifndef CORE_ALGORITHMS_LEGACY_FIELDS_MARCHINGCUBES_SPANSPACE_H
+#define CORE_ALGORITHMS_LEGACY_FIELDS_MARCHINGCUBES_SPANSPACE_H 1
+
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <vector>
+
+#include <Core/Algorithms/Legacy/Fields/share.h>
+
+namespace SCIRun {
+
+/// Index of the value range of every cell of a field, used by marching
+/// cubes to visit only the cells an isosurface passes through.
+///
+/// For node data min and max are the extremes of the node values of a cell,
+/// for cell data min is the value of the cell and max the largest value of
+/// its neighbors. The tet, triangle, quad and edge tesselators count a value
+/// above iso as inside, so their cells are crossed when min <= iso < max;
+/// the hex and prism tesselators count a value below iso as inside, which
+/// gives min < iso <= max. The index returns every cell with
+/// min <= iso <= max and leaves the rest to the tesselators, which produce
+/// nothing for a cell that is not crossed. The ranges are stored in a centered interval tree (the span
+/// space of the field), so finding the active cells for an isovalue takes
+/// O(log n + k) instead of a pass over all cells.
+///
+/// The index is tied to the field it was built for through the id of the
+/// field and of its mesh. Fields are not modified once they have been sent
+/// downstream, so a new id is a sufficient signal that the data changed.
+class SCISHARE SpanSpace
+{
+  public:
+    SpanSpace();
+
+    /// Compute the value range of every cell and build the tree
+    void build(FieldHandle field);
+
+    /// Whether the index describes the current contents of field
+    bool is_valid_for(FieldHandle field) const;
+
+    /// Cells that may contribute to the isosurface at iso, in increasing
+    /// order, so extracting them gives the same output as a full pass.
+    void find_cells(double iso, std::vector<index_type>& cells) const;
+
+    size_type num_cells() const { return (static_cast<size_type>(min_.size())); }
+
+  private:
+    struct TreeNode
+    {
+      double     center;
+      /// Ranges containing center, by_min_[begin,end) sorted on increasing
+      /// min and by_max_[begin,end) on decreasing max
+      index_type begin;
+      index_type end;
+      /// Ranges entirely below and above center, -1 if there are none
+      index_type left;
+      index_type right;
+    };
+
+    index_type build_tree(std::vector<index_type>& cells);
+
+    std::vector<double>     min_;
+    std::vector<double>     max_;
+    std::vector<TreeNode>   tree_;
+    std::vector<index_type> by_min_;
+    std::vector<index_type> by_max_;
+
+    int        field_id_;
+    int        mesh_id_;
+    int        basis_order_;
+    size_type  num_values_;
+};
+
+} // End namespace SCIRun
+
+#endif
@@ -57,12 +57,15 @@ TetMC::reset( int /*n*/, bool build_field, bool build_geom, bool transparency )
   mesh_->size(csize);
   ncells_ = csize;
 
+  points_ = mesh_->node_span();
+  cells_ = mesh_->elem_connectivity_span();
+
   if (basis_order_ == 0)
   {
     mesh_->synchronize(Mesh::FACES_E|Mesh::ELEM_NEIGHBORS_E);
     if (build_field_)
     {
-      node_map_ = std::vector<SCIRun::index_type>(nnodes_, -1);
+      node_map_.clear();
     }
   }
  
@@ -116,9 +119,9 @@ VMesh::Node::index_type
 TetMC::find_or_add_nodepoint(VMesh::Node::index_type &tet_node_idx) 
 {
   VMesh::Node::index_type surf_node_idx;
-  index_type i = node_map_[tet_node_idx];
-  if (i != -1) surf_node_idx = (VMesh::Node::index_type) i;
-  else 
+  const node_hash_type::iterator loc = node_map_.find(tet_node_idx);
+  if (loc != node_map_.end()) surf_node_idx = VMesh::Node::index_type((*loc).second);
+  else
   {
     Point p;
     mesh_->get_point(p, tet_node_idx);
@@ -233,8 +236,21 @@ void TetMC::extract_n( VMesh::Elem::index_type cell, double v )
   Point p[4];
   double value[4];
 
-  mesh_->get_nodes( node, cell );
-  mesh_->get_centers(p,node);
+  if (!cells_.empty() && !points_.empty())
+  {
+    const VMesh::index_type* c = cells_.data() + 4*static_cast<VMesh::index_type>(cell);
+    node.resize(4);
+    for (int i=0; i<4; i++)
+    {
+      node[i] = c[i];
+      p[i] = points_[c[i]];
+    }
+  }
+  else
+  {
+    mesh_->get_nodes( node, cell );
+    mesh_->get_centers(p,node);
+  }
   field_->get_values(value,node);
   
   int code = 0;
@@ -89,6 +89,8 @@ class TetMC : public BaseMC
     FieldHandle field_handle_;
     VField*     field_;
     VMesh*      mesh_;
+    VMesh::PointSpan points_;
+    VMesh::IndexSpan cells_;
     
     #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
      GeomFastTriangles *triangles_;
@@ -72,8 +72,8 @@ bool find_second_closest_elem(VMesh *tsm, SearchGridHandle elem_grid,
   if (bk > nk) bk = nk; if (bk < 0) bk = 0;
   
   ei = bi; ej = bj; ek = bk;
-  Point *points = tsm->get_points_pointer();
-  VMesh::index_type *faces = tsm->get_elems_pointer();
+  const Point *points = tsm->get_points_pointer();
+  const VMesh::index_type *faces = tsm->get_elems_pointer();
 
   double mindist2=(diffdist+pqdist)*(diffdist+pqdist);
   bool found = true;
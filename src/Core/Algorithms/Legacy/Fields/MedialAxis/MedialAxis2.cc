@@ -295,8 +295,8 @@ MedialAxisP::find_closest_two_distances(VMesh* surfmesh,
   const size_type nj = elem_grid->get_nj();
   const size_type nk = elem_grid->get_nk();
 
-  Point *points            = surfmesh->get_points_pointer();
-  VMesh::index_type *faces = surfmesh->get_elems_pointer();
+  const Point *points      = surfmesh->get_points_pointer();
+  const VMesh::index_type *faces = surfmesh->get_elems_pointer();
 
   const double epsilon = surfmesh->get_epsilon();
   const double epsilon2 = epsilon*epsilon;
@@ -56,6 +56,7 @@ ALGORITHM_PARAMETER_DEF(Fields, ManualMaximumIsovalue);
 ALGORITHM_PARAMETER_DEF(Fields, ListOfIsovalues);
 ALGORITHM_PARAMETER_DEF(Fields, QuantityOfIsovalues);
 ALGORITHM_PARAMETER_DEF(Fields, IsovalueListString);
+ALGORITHM_PARAMETER_DEF(Fields, BuildCellIndex);
 
 ExtractSimpleIsosurfaceAlgo::ExtractSimpleIsosurfaceAlgo()
 {
@@ -67,7 +68,12 @@ ExtractSimpleIsosurfaceAlgo::ExtractSimpleIsosurfaceAlgo()
   addParameter(Parameters::IsovalueQuantityFromField, 1);
   addParameter(Parameters::ManualMaximumIsovalue, 0.0);
   addParameter(Parameters::ManualMinimumIsovalue, 0.0);
+  addParameter(Parameters::BuildCellIndex, false);
   addOption(Parameters::IsovalueChoice, "Single", "Single|List|Quantity");
+
+  marching_.reset(new MarchingCubesAlgo);
+  marching_->set(MarchingCubesAlgo::build_field, true);
+  marching_->set(MarchingCubesAlgo::build_cell_index, true);
 }
 
 bool ExtractSimpleIsosurfaceAlgo::run(FieldHandle input, const std::vector<double>& isovalues, FieldHandle& output) const
@@ -77,10 +83,16 @@ bool ExtractSimpleIsosurfaceAlgo::run(FieldHandle input, const std::vector<doubl
     THROW_ALGORITHM_INPUT_ERROR("Error in ExtractIsosurface algorithm: No Isovalue available.");
   }
 
-  MarchingCubesAlgo marching_;
-  marching_.set(MarchingCubesAlgo::build_field, true);
-
-  marching_.run(input, isovalues, output);
+  if (get(Parameters::BuildCellIndex).toBool())
+  {
+    marching_->run(input, isovalues, output);
+  }
+  else
+  {
+    MarchingCubesAlgo marching;
+    marching.set(MarchingCubesAlgo::build_field, true);
+    marching.run(input, isovalues, output);
+  }
 
   return (true);
 }
@@ -32,11 +32,15 @@
 
 #include <Core/Datatypes/DatatypeFwd.h>
 #include <Core/Algorithms/Base/AlgorithmBase.h>
+#include <boost/shared_ptr.hpp>
 #include <Core/Algorithms/Legacy/Fields/share.h>
 
 namespace SCIRun {
 namespace Core {
 namespace Algorithms {
+
+  class MarchingCubesAlgo;
+
 namespace Fields {
 
   ALGORITHM_PARAMETER_DECL(SingleIsoValue);
@@ -49,6 +53,7 @@ namespace Fields {
   ALGORITHM_PARAMETER_DECL(Isovalues);
   ALGORITHM_PARAMETER_DECL(IsovalueChoice);
   ALGORITHM_PARAMETER_DECL(IsovalueListString);
+  ALGORITHM_PARAMETER_DECL(BuildCellIndex);
 
 class SCISHARE ExtractSimpleIsosurfaceAlgo : public AlgorithmBase
 {
@@ -58,6 +63,11 @@ public:
   bool run(FieldHandle input, const std::vector<double>& isovalues, FieldHandle& output) const;
 
   AlgorithmOutput run(const AlgorithmInput& input) const;
+
+private:
+  /// Only used with BuildCellIndex on: kept between runs, so isovalue
+  /// changes on the same field reuse its cell index
+  boost::shared_ptr<MarchingCubesAlgo> marching_;
 };
 
 }}}}
@@ -957,21 +957,9 @@ DenseMatrixHandle RegisterWithCorrespondencesAlgo::runN(FieldHandle input, Field
     return nullptr;
   }
 
-  FieldHandle input_cp;
+  // The identity registration leaves the field untouched, so hand the input on.
+  output = input;
 
-  output.reset(input->deep_clone());
-
-  if (!output)
-  {
-    error("Could not allocate output field");
-    return nullptr;
-  }
-
-  VMesh* imesh = input->vmesh();
-  VMesh* omesh = output->vmesh();
-
-  omesh = imesh;
-  
   return boost::make_shared<DenseMatrix>(Eigen::MatrixXd::Identity(4,4));
 
 }
@@ -100,7 +100,7 @@ bool FairMeshAlgo::runImpl(FieldHandle input,FieldHandle& output) const
     }
 
     std::vector<Vector> disp(num_nodes);
-    Point*  point = mesh->get_points_pointer();
+    Point*  point = mesh->mutable_points_pointer();
     Point p0;
     for (int it = 0; it<num_iter; it++)
     {
@@ -161,7 +161,7 @@ bool FairMeshAlgo::runImpl(FieldHandle input,FieldHandle& output) const
     }
     
     std::vector<Vector> disp(num_nodes);
-    Point*  point = mesh->get_points_pointer();
+    Point*  point = mesh->mutable_points_pointer();
     Point p0;
 
     double epsilon = mesh->get_epsilon();
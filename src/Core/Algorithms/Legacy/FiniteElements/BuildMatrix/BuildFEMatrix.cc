@@ -27,6 +27,7 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <Core/Algorithms/Legacy/FiniteElements/BuildMatrix/BuildFEMatrix.h>
+#include <Core/Algorithms/Legacy/FiniteElements/BuildMatrix/ElementStiffnessKernels.h>
 
 #include <Core/Datatypes/DenseMatrix.h>
 #include <Core/Datatypes/SparseRowMatrix.h>
@@ -46,7 +47,8 @@ DEALINGS IN THE SOFTWARE.
 #include <string>
 #include <vector>
 #include <algorithm>
-#include <boost/shared_array.hpp>
+#include <limits>
+#include <cstdint>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Geometry;
@@ -66,14 +68,72 @@ namespace SCIRun {
         template <typename T>
         using matrix_pointer_type = boost::shared_ptr<matrix_type<T>>;
 
+// Symbolic part of the stiffness matrix: its CSR structure, and for every row the
+// position within the row of each dof of each element around it. This only
+// depends on the mesh, so it is kept and reused when just the conductivities change.
+// Meshes keep their id when their connectivity is edited in place, so the key also
+// holds a hash of the element nodes.
+class FEMatrixPattern
+{
+public:
+  bool matches(Mesh::id_type id, index_type dimension, size_type elems, index_type local, std::uint64_t hash) const
+  {
+    return mesh_id == id && global_dimension == dimension &&
+      num_elems == elems && local_dimension == local && connectivity_hash == hash;
+  }
+
+  // Order dependent hash of the element nodes; 0 for meshes with implicit connectivity,
+  // where the sizes determine the pattern.
+  static std::uint64_t connectivityHash(VMesh* mesh)
+  {
+    if (!mesh->is_unstructuredmesh())
+      return 0;
+    auto elems = mesh->get_elems_pointer();
+    if (!elems)
+      return 0;
+    const size_t n = static_cast<size_t>(mesh->num_elems()) * mesh->num_nodes_per_elem();
+    std::uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < n; ++i)
+      hash = (hash ^ static_cast<std::uint64_t>(elems[i])) * 1099511628211ull;
+    return hash;
+  }
+
+  Mesh::id_type mesh_id = 0;
+  std::uint64_t connectivity_hash = 0;
+  index_type global_dimension = 0;
+  size_type num_elems = 0;
+  index_type local_dimension = 0;
+
+  std::vector<index_type> rows;
+  std::vector<index_type> columns;
+  // slots[slot_rows[i] + j*local_dimension + k] is the offset in row i of dof k
+  // of the j-th element around dof i. Empty if a row is too long for the offsets.
+  std::vector<index_type> slot_rows;
+  std::vector<unsigned short> slots;
+};
+
+// Dispatch to the batched kernel for the element type
+inline void stiffness_rows(const ElementBatch<4>& batch, double tet_scale, const HexQuadratureTable&,
+  double (&out)[4][STIFFNESS_BATCH_WIDTH], double (&det)[STIFFNESS_BATCH_WIDTH])
+{
+  tetLinearStiffnessRows(batch, tet_scale, out, det);
+}
+
+inline void stiffness_rows(const ElementBatch<8>& batch, double, const HexQuadratureTable& hex_table,
+  double (&out)[8][STIFFNESS_BATCH_WIDTH], double (&det)[STIFFNESS_BATCH_WIDTH])
+{
+  hexTrilinearStiffnessRows(batch, hex_table, out, det);
+}
+
 template <typename T>
 class BuildFEMatrixAlgoImpl
 {
 public:
-  explicit BuildFEMatrixAlgoImpl(const AlgorithmBase* algo) : algo_(algo) {}
+  BuildFEMatrixAlgoImpl(const AlgorithmBase* algo, boost::shared_ptr<FEMatrixPattern>& pattern) : algo_(algo), pattern_(pattern) {}
   bool run(FieldHandle input, Datatypes::DenseMatrixHandle ctable, matrix_pointer_type<T>& output) const;
 private:
   const AlgorithmBase* algo_;
+  boost::shared_ptr<FEMatrixPattern>& pattern_;
   mutable int generation_ = 0;
   mutable std::vector<std::vector<T>> basis_values_;
   mutable matrix_pointer_type<T> basis_fematrix_;
@@ -84,10 +144,12 @@ template <typename T>
 class FEMBuilder
 {
 public:
-  explicit FEMBuilder(const AlgorithmBase* algo) :
+  FEMBuilder(const AlgorithmBase* algo, boost::shared_ptr<FEMatrixPattern>& pattern) :
     algo_(algo), numprocessors_(Parallel::NumCores()),
     barrier_("FEMBuilder Barrier", numprocessors_),
-    mesh_(nullptr), field_(nullptr),
+    mesh_(nullptr), field_(nullptr), mesh_id_(0),
+    cached_pattern_(pattern), build_pattern_(true),
+    element_kernel_(ElementKernel::Virtual),
     domain_dimension(0), local_dimension_nodes(0),
     local_dimension_add_nodes(0),
     local_dimension_derivatives(0),
@@ -110,14 +172,23 @@ private:
 
   VMesh* mesh_;
   VField *field_;
+  Mesh::id_type mesh_id_;
 
   matrix_pointer_type<T> fematrix_;
 
   std::vector<bool> success_;
 
-  boost::shared_array<index_type> rows_;
-  boost::shared_array<index_type> allcols_;
+  boost::shared_ptr<FEMatrixPattern>& cached_pattern_;
+  boost::shared_ptr<FEMatrixPattern> pattern_;
+  bool build_pattern_;
   std::vector<index_type> colidx_;
+  std::vector<index_type> slotidx_;
+  std::vector<char> slots_ok_;
+
+  // Linear tetrahedra and hexahedra use the batched kernels, other elements
+  // the virtual mesh interface
+  enum class ElementKernel { Virtual, TetLinear, HexTrilinear };
+  ElementKernel element_kernel_;
 
   index_type domain_dimension;
 
@@ -137,11 +208,21 @@ private:
 
   // Entry point for the parallel version
   void parallel(int proc);
+  bool build_pattern(int proc, index_type start_gd, index_type end_gd);
 
-  void add_lcl_gbl(index_type row, const std::vector<index_type> &cols, const std::vector<T> &lcl_a)
+  void add_lcl_gbl(index_type row, const unsigned short* slots, const std::vector<index_type> &cols, const std::vector<T> &lcl_a)
   {
-    for (size_t i = 0; i < lcl_a.size(); i++)
-      fematrix_->coeffRef(row, cols[i]) += lcl_a[i];
+    if (slots)
+    {
+      auto a = fematrix_->valuePtr() + fematrix_->outerIndexPtr()[row];
+      for (size_t i = 0; i < lcl_a.size(); i++)
+        a[slots[i]] += lcl_a[i];
+    }
+    else
+    {
+      for (size_t i = 0; i < lcl_a.size(); i++)
+        fematrix_->coeffRef(row, cols[i]) += lcl_a[i];
+    }
   }
 
   void create_numerical_integration(std::vector<VMesh::coords_type>& p,
@@ -160,6 +241,15 @@ private:
                                   std::vector<double>& w,
                                   std::vector<std::vector<double>>& d,
                                   std::vector<std::vector<T>>& precompute);
+  void element_tensor(VMesh::Elem::index_type c_ind, Tensor& tensor) const;
+  template <int Nodes>
+  bool build_rows_batched(index_type row,
+                          const VMesh::Elem::array_type& ca,
+                          const unsigned short* slots,
+                          double tet_scale,
+                          const HexQuadratureTable& hex_table,
+                          std::vector<T>& lsml,
+                          std::vector<index_type>& dofs);
   bool setup();
 
 };
@@ -174,6 +264,7 @@ FEMBuilder<T>::build_matrix(FieldHandle input,
   // Get virtual interface to data
   field_ = input->vfield();
   mesh_  = input->vmesh();
+  mesh_id_ = input->mesh()->id();
 
 #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
   // If we have the Conductivity property use it, if not we assume the values on
@@ -267,6 +358,8 @@ FEMBuilder<T>::build_matrix(FieldHandle input,
     }
   }
 
+  cached_pattern_ = pattern_;
+
   // Make sure it is symmetric
   if (algo_->get(BuildFEMatrixAlgo::ForceSymmetry).toBool())
   {
@@ -606,6 +699,103 @@ FEMBuilder<T>::build_local_matrix_regular(VMesh::Elem::index_type c_ind,
   return true;
 }
 
+template <typename T>
+void
+FEMBuilder<T>::element_tensor(VMesh::Elem::index_type c_ind, Tensor& tensor) const
+{
+  if (tensors_.empty())
+  {
+    field_->get_value(tensor,c_ind);
+  }
+  else
+  {
+    int tensor_index;
+    field_->get_value(tensor_index,c_ind);
+    tensor = tensors_[tensor_index].second;
+  }
+}
+
+/// rows of the local stiffness matrices of all elements around a node, computed
+/// STIFFNESS_BATCH_WIDTH elements at a time
+template <typename T>
+template <int Nodes>
+bool
+FEMBuilder<T>::build_rows_batched(index_type row,
+                                  const VMesh::Elem::array_type& ca,
+                                  const unsigned short* slots,
+                                  double tet_scale,
+                                  const HexQuadratureTable& hex_table,
+                                  std::vector<T>& lsml,
+                                  std::vector<index_type>& dofs)
+{
+  const int width = STIFFNESS_BATCH_WIDTH;
+  const Point* points = mesh_->get_points_pointer();
+  const VMesh::index_type* elems = mesh_->get_elems_pointer();
+
+  ElementBatch<Nodes> batch;
+  double out[Nodes][width];
+  double det[width];
+  bool zero[width];
+  Tensor tensor;
+
+  dofs.resize(Nodes);
+  const size_t num = ca.size();
+  for (size_t j0 = 0; j0 < num; j0 += width)
+  {
+    const size_t count = std::min<size_t>(width, num - j0);
+
+    // Gather the batch; the lanes of a partial batch repeat the first element
+    for (int l = 0; l < width; l++)
+    {
+      const VMesh::Elem::index_type c_ind = ca[j0 + (static_cast<size_t>(l) < count ? l : 0)];
+      const VMesh::index_type* nodes = elems + Nodes*c_ind;
+
+      batch.row[l] = 0;
+      for (int a = 0; a < Nodes; a++)
+      {
+        const Point& p = points[nodes[a]];
+        batch.x[a][l] = p.x();
+        batch.y[a][l] = p.y();
+        batch.z[a][l] = p.z();
+        if (nodes[a] == row)
+          batch.row[l] = a;
+      }
+
+      element_tensor(c_ind, tensor);
+      batch.sigma[0][l] = tensor.val(0,0);
+      batch.sigma[1][l] = tensor.val(0,1);
+      batch.sigma[2][l] = tensor.val(0,2);
+      batch.sigma[3][l] = tensor.val(1,1);
+      batch.sigma[4][l] = tensor.val(1,2);
+      batch.sigma[5][l] = tensor.val(2,2);
+      zero[l] = true;
+      for (int k = 0; k < 6; k++)
+        zero[l] = zero[l] && batch.sigma[k][l] == 0.0;
+    }
+
+    stiffness_rows(batch, tet_scale, hex_table, out, det);
+
+    for (size_t l = 0; l < count; l++)
+    {
+      // Elements without conductivity do not contribute, whatever their shape
+      if (!zero[l] && det[l] <= 0.0)
+      {
+        algo_->error("Mesh has elements with negative jacobians, check the order of the nodes that define an element");
+        return false;
+      }
+
+      const VMesh::index_type* nodes = elems + Nodes*ca[j0+l];
+      for (int j = 0; j < Nodes; j++)
+      {
+        lsml[j] = zero[l] ? 0.0 : out[j][l];
+        dofs[j] = nodes[j];
+      }
+      add_lcl_gbl(row, slots ? slots + (j0+l)*Nodes : nullptr, dofs, lsml);
+    }
+  }
+  return true;
+}
+
 template <typename T>
 bool
 FEMBuilder<T>::setup()
@@ -669,58 +859,68 @@ FEMBuilder<T>::setup()
     algo_->error("Mesh size < 0");
     success_[0] = false;
   }
-  LOG_DEBUG("Allocating buffer for nonzero row indices of size: {}", global_dimension+1);
-  rows_.reset(new index_type[global_dimension+1]);
-
-  colidx_.resize(numprocessors_+1);
-  return true;
-}
 
-// -- callback routine to execute in parallel
-template <typename T>
-void
-FEMBuilder<T>::parallel(int proc_num)
-{
-  success_[proc_num] = true;
-
-  if (proc_num == 0)
+  element_kernel_ = ElementKernel::Virtual;
+  if (local_dimension_add_nodes == 0 && mesh_->is_linearmesh())
   {
-    try
-    {
-      success_[proc_num] = setup();
-    }
-    catch (...)
-    {
-      algo_->error("BuildFEMatrix could not setup FE Stiffness computation");
-      success_[proc_num] = false;
-    }
+    if (mesh_->is_tetvolmesh() && local_dimension == 4)
+      element_kernel_ = ElementKernel::TetLinear;
+    else if (mesh_->is_hexvolmesh() && local_dimension == 8)
+      element_kernel_ = ElementKernel::HexTrilinear;
+
+    if (element_kernel_ != ElementKernel::Virtual &&
+        (!mesh_->get_points_pointer() || !mesh_->get_elems_pointer()))
+      element_kernel_ = ElementKernel::Virtual;
   }
 
-  barrier_.wait();
-
-  // In case one of the threads fails, we should have them fail all
-  for (int q = 0; q < numprocessors_; q++)
+  // The sparsity pattern only depends on the mesh, so a pattern built for this
+  // mesh before (for other conductivities) can be used as is
+  const size_type num_elems = mesh_->num_elems();
+  const auto connectivity_hash = FEMatrixPattern::connectivityHash(mesh_);
+  if (cached_pattern_ && cached_pattern_->matches(mesh_id_, global_dimension, num_elems, local_dimension, connectivity_hash))
   {
-    if (!success_[q])
-    {
-      std::ostringstream oss;
-      oss << "FEMBuilder::setup failed in thread " << q;
-      algo_->error(oss.str());
-      return;
-    }
+    pattern_ = cached_pattern_;
+    build_pattern_ = false;
+  }
+  else
+  {
+    pattern_ = boost::make_shared<FEMatrixPattern>();
+    pattern_->mesh_id = mesh_id_;
+    pattern_->connectivity_hash = connectivity_hash;
+    pattern_->global_dimension = global_dimension;
+    pattern_->num_elems = num_elems;
+    pattern_->local_dimension = local_dimension;
+    LOG_DEBUG("Allocating buffer for nonzero row indices of size: {}", global_dimension+1);
+    pattern_->rows.resize(global_dimension+1);
+    pattern_->slot_rows.resize(global_dimension+1);
+    build_pattern_ = true;
   }
 
-  /// distributing dofs among processors
-  const index_type start_gd = (global_dimension * proc_num)/numprocessors_;
-  const index_type end_gd  = (global_dimension * (proc_num+1))/numprocessors_;
+  colidx_.resize(numprocessors_+1);
+  slotidx_.resize(numprocessors_+1);
+  slots_ok_.assign(numprocessors_, 1);
+  return true;
+}
 
+// Symbolic phase: the CSR structure of the rows in [start_gd,end_gd), and where
+// in each row the contributions of the elements around the dof go
+template <typename T>
+bool
+FEMBuilder<T>::build_pattern(int proc_num, index_type start_gd, index_type end_gd)
+{
   /// creating sparse matrix structure
   std::vector<index_type> mycols;
+  std::vector<index_type> myslotrows;
+  std::vector<unsigned short> myslots;
 
   VMesh::Elem::array_type ca;
   VMesh::Node::array_type na;
   VMesh::Edge::array_type ea;
   std::vector<index_type> neib_dofs;
+  std::vector<index_type> elem_dofs;
+
+  auto& rows = pattern_->rows;
+  auto& slot_rows = pattern_->slot_rows;
 
   /// loop over system dofs for this thread
   int cnt = 0;
@@ -729,12 +929,14 @@ FEMBuilder<T>::parallel(int proc_num)
   try
   {
     mycols.reserve((end_gd - start_gd)*local_dimension*8);  //<! rough estimate
+    myslots.reserve((end_gd - start_gd)*local_dimension*24);
 
     for (VMesh::Node::index_type i = start_gd; i<end_gd; ++i)
     {
-      rows_[i] = mycols.size();
+      rows[i] = mycols.size();
+      slot_rows[i] = myslots.size();
 
-      neib_dofs.clear();
+      elem_dofs.clear();
       /// check for nodes
       if (i < global_dimension_nodes)
       {
@@ -762,7 +964,7 @@ FEMBuilder<T>::parallel(int proc_num)
 
         for(size_t k = 0; k < na.size(); k++)
         {
-          neib_dofs.push_back(static_cast<index_type>(na[k]));
+          elem_dofs.push_back(static_cast<index_type>(na[k]));
         }
 
         /// check for additional nodes at edges
@@ -772,12 +974,14 @@ FEMBuilder<T>::parallel(int proc_num)
           mesh_->get_edges(ea, ca[j]);
 
           for(size_t k = 0; k < ea.size(); k++)
-            neib_dofs.push_back(global_dimension + ea[k]);
+            elem_dofs.push_back(global_dimension + ea[k]);
         }
       }
 
+      neib_dofs = elem_dofs;
       std::sort(neib_dofs.begin(), neib_dofs.end());
 
+      const size_t row_start = mycols.size();
       for (size_t j=0; j<neib_dofs.size(); j++)
       {
         if (j == 0 || neib_dofs[j] != mycols.back())
@@ -785,6 +989,24 @@ FEMBuilder<T>::parallel(int proc_num)
           mycols.push_back(neib_dofs[j]);
         }
       }
+
+      // Position of every element dof within this row, in the order the numeric
+      // phase visits them
+      if (mycols.size() - row_start > std::numeric_limits<unsigned short>::max() ||
+          elem_dofs.size() != ca.size()*local_dimension)
+      {
+        slots_ok_[proc_num] = 0;
+      }
+      if (slots_ok_[proc_num])
+      {
+        auto row_begin = mycols.begin() + row_start;
+        for (size_t j=0; j<elem_dofs.size(); j++)
+        {
+          auto pos = std::lower_bound(row_begin, mycols.end(), elem_dofs[j]);
+          myslots.push_back(static_cast<unsigned short>(pos - row_begin));
+        }
+      }
+
       if (proc_num == 0)
       {
         cnt++;
@@ -797,6 +1019,7 @@ FEMBuilder<T>::parallel(int proc_num)
     }
 
     colidx_[proc_num] = mycols.size();
+    slotidx_[proc_num] = myslots.size();
     success_[proc_num] = true;
   }
   catch (...)
@@ -813,37 +1036,43 @@ FEMBuilder<T>::parallel(int proc_num)
   {
     if (!success_[q])
     {
-      return;
+      return false;
     }
   }
 
-  std::vector<std::vector<T>> precompute;
-  index_type st = 0;
-
-  if (proc_num == 0)
-    allcols_.reset();
-
   try
   {
     if (proc_num == 0)
     {
+      index_type st = 0;
+      index_type sst = 0;
+      bool slots_ok = true;
       for(int i=0; i<numprocessors_; i++)
       {
         const index_type ns = colidx_[i];
         colidx_[i] = st;
         st += ns;
+
+        const index_type nss = slotidx_[i];
+        slotidx_[i] = sst;
+        sst += nss;
+
+        slots_ok = slots_ok && slots_ok_[i];
       }
 
       colidx_[numprocessors_] = st;
-      allcols_.reset(new index_type[st]);
+      slotidx_[numprocessors_] = sst;
+      pattern_->columns.resize(st);
+      // A row that does not fit the slot type falls back to searching the columns
+      if (slots_ok)
+        pattern_->slots.resize(sst);
+      rows[global_dimension] = st;
+      slot_rows[global_dimension] = sst;
     }
     success_[proc_num] = true;
   }
   catch (...)
   {
-    if (proc_num == 0)
-      allcols_.reset();
-
     algo_->error("Could not allocate enough memory");
     success_[proc_num] = false;
   }
@@ -855,20 +1084,26 @@ FEMBuilder<T>::parallel(int proc_num)
   for (int q=0; q<numprocessors_;q++)
   {
     if (! success_[q])
-      return;
+      return false;
   }
 
   try
   {
     /// updating global column by each of the processors
     const index_type s = colidx_[proc_num];
-    const size_t n = mycols.size();
-
-    for(size_t i=0; i<n; i++)
-      allcols_[i+s] = mycols[i];
+    std::copy(mycols.begin(), mycols.end(), pattern_->columns.begin() + s);
 
     for(index_type i = start_gd; i<end_gd; i++)
-      rows_[i] += s;
+      rows[i] += s;
+
+    if (!pattern_->slots.empty())
+    {
+      const index_type ss = slotidx_[proc_num];
+      std::copy(myslots.begin(), myslots.end(), pattern_->slots.begin() + ss);
+
+      for(index_type i = start_gd; i<end_gd; i++)
+        slot_rows[i] += ss;
+    }
 
     success_[proc_num] = true;
   }
@@ -885,19 +1120,62 @@ FEMBuilder<T>::parallel(int proc_num)
   for (auto q=0; q<numprocessors_; q++)
   {
     if (!success_[q])
+      return false;
+  }
+  return true;
+}
+
+// -- callback routine to execute in parallel
+template <typename T>
+void
+FEMBuilder<T>::parallel(int proc_num)
+{
+  success_[proc_num] = true;
+
+  if (proc_num == 0)
+  {
+    try
+    {
+      success_[proc_num] = setup();
+    }
+    catch (...)
+    {
+      algo_->error("BuildFEMatrix could not setup FE Stiffness computation");
+      success_[proc_num] = false;
+    }
+  }
+
+  barrier_.wait();
+
+  // In case one of the threads fails, we should have them fail all
+  for (int q = 0; q < numprocessors_; q++)
+  {
+    if (!success_[q])
+    {
+      std::ostringstream oss;
+      oss << "FEMBuilder::setup failed in thread " << q;
+      algo_->error(oss.str());
       return;
+    }
   }
 
+  /// distributing dofs among processors
+  const index_type start_gd = (global_dimension * proc_num)/numprocessors_;
+  const index_type end_gd  = (global_dimension * (proc_num+1))/numprocessors_;
+
+  if (build_pattern_ && !build_pattern(proc_num, start_gd, end_gd))
+    return;
+
   try
   {
-    /// the main thread makes the matrix
+    /// the main thread makes the matrix, directly from the compressed pattern
     if (proc_num == 0)
     {
-      rows_[global_dimension] = st;
-      algo_->remark("Creating fematrix on main thread.");
-      fematrix_ = boost::make_shared<matrix_type<T>>(global_dimension, global_dimension, rows_.get(), allcols_.get(), st);
-      rows_.reset();
-      allcols_.reset();
+      const auto nnz = pattern_->rows[global_dimension];
+      fematrix_ = boost::make_shared<matrix_type<T>>(global_dimension, global_dimension);
+      fematrix_->resizeNonZeros(nnz);
+      std::copy(pattern_->rows.begin(), pattern_->rows.end(), fematrix_->outerIndexPtr());
+      std::copy(pattern_->columns.begin(), pattern_->columns.end(), fematrix_->innerIndexPtr());
     }
     success_[proc_num] = true;
   }
@@ -917,11 +1195,23 @@ FEMBuilder<T>::parallel(int proc_num)
       return;
   }
 
+  // Numeric phase: every thread fills the rows it owns, adding the element
+  // contributions at the positions found by the symbolic phase. No searching
+  // and no locking is needed.
+  std::vector<std::vector<T>> precompute;
+
+  VMesh::Elem::array_type ca;
+  VMesh::Node::array_type na;
+  VMesh::Edge::array_type ea;
+  std::vector<index_type> neib_dofs;
+
+  const bool use_slots = !pattern_->slots.empty();
+
   try
   {
     /// zeroing in parallel
-    const auto ns = colidx_[proc_num];
-    const auto ne = colidx_[proc_num+1];
+    const auto ns = pattern_->rows[start_gd];
+    const auto ne = pattern_->rows[end_gd];
     auto a = &(fematrix_->valuePtr()[ns]), ae=&(fematrix_->valuePtr()[ne]);
     while (a<ae) *a++=0.0;
 
@@ -931,12 +1221,26 @@ FEMBuilder<T>::parallel(int proc_num)
 
     create_numerical_integration(ni_points, ni_weights, ni_derivatives);
 
+    // Integration rule for the batched kernels: the gradients of a linear
+    // tetrahedron are constant, a hexahedron uses the quadrature table
+    const double element_size = mesh_->get_element_size();
+    double tet_scale = 0.0;
+    HexQuadratureTable hex_table;
+    for (size_t q = 0; q < ni_weights.size(); q++)
+    {
+      tet_scale += ni_weights[q]*element_size;
+      hex_table.weights.push_back(ni_weights[q]*element_size);
+    }
+    hex_table.derivatives = ni_derivatives;
+
     std::vector<T> lsml; ///< line of local stiffnes matrix
     lsml.resize(local_dimension);
+    bool filled = true;
 
     /// loop over system dofs for this thread
-    cnt = 0;
-    size_gd = end_gd-start_gd;
+    int cnt = 0;
+    size_type size_gd = end_gd-start_gd;
+    auto updateFrequency = 2*size_gd / 100;
     for (VMesh::Node::index_type i = start_gd; i<end_gd; ++i)
     {
       if (i < global_dimension_nodes)
@@ -959,9 +1263,19 @@ FEMBuilder<T>::parallel(int proc_num)
         algo_->warning("BuildFEMatrix only supports linear basis functions.");
       }
 
+      const unsigned short* slots = use_slots ? &pattern_->slots[pattern_->slot_rows[i]] : nullptr;
+
       /// loop over elements attributed elements
 
-      if (mesh_->is_regularmesh())
+      if (element_kernel_ == ElementKernel::TetLinear)
+      {
+        filled = build_rows_batched<4>(i, ca, slots, tet_scale, hex_table, lsml, neib_dofs);
+      }
+      else if (element_kernel_ == ElementKernel::HexTrilinear)
+      {
+        filled = build_rows_batched<8>(i, ca, slots, tet_scale, hex_table, lsml, neib_dofs);
+      }
+      else if (mesh_->is_regularmesh())
       {
         for (size_t j = 0; j < ca.size(); j++)
         {
@@ -977,9 +1291,10 @@ FEMBuilder<T>::parallel(int proc_num)
             if (na[k] == i)
             {
               build_local_matrix_regular(ca[j], k , lsml, ni_points, ni_weights, ni_derivatives,precompute);
-              add_lcl_gbl(i, neib_dofs, lsml);
+              add_lcl_gbl(i, slots, neib_dofs, lsml);
             }
           }
+          if (slots) slots += local_dimension;
         }
       }
       else
@@ -1009,7 +1324,7 @@ FEMBuilder<T>::parallel(int proc_num)
             if (na[k] == i)
             {
               build_local_matrix(ca[j], k , lsml, ni_points, ni_weights, ni_derivatives);
-              add_lcl_gbl(i, neib_dofs, lsml);
+              add_lcl_gbl(i, slots, neib_dofs, lsml);
             }
           }
 
@@ -1020,10 +1335,11 @@ FEMBuilder<T>::parallel(int proc_num)
               if (global_dimension + static_cast<int>(ea[k]) == i)
               {
                 build_local_matrix(ca[j], k+na.size(), lsml, ni_points, ni_weights, ni_derivatives);
-                add_lcl_gbl(i, neib_dofs, lsml);
+                add_lcl_gbl(i, slots, neib_dofs, lsml);
               }
             }
           }
+          if (slots) slots += local_dimension;
         }
       }
 
@@ -1036,8 +1352,11 @@ FEMBuilder<T>::parallel(int proc_num)
           algo_->update_progress_max(i+size_gd,2*size_gd);
         }
       }
+
+      if (!filled)
+        break;
     }
-    success_[proc_num] = true;
+    success_[proc_num] = filled;
   }
   catch (...)
   {
@@ -1096,7 +1415,7 @@ BuildFEMatrixAlgoImpl<T>::run(FieldHandle input, DenseMatrixHandle ctable, matri
     }
   }
 
-  FEMBuilder<T> builder(algo_);
+  FEMBuilder<T> builder(algo_, pattern_);
 
   if (algo_->get(BuildFEMatrixAlgo::GenerateBasis).toBool())
   {
@@ -1226,7 +1545,7 @@ AlgorithmOutput BuildFEMatrixAlgo::run(const AlgorithmInput& input) const
   if (field && field->vfield() && field->vfield()->is_complex_double())
 	{
 		matrix_pointer_type<complex> stiffness;
-	  BuildFEMatrixAlgoImpl<complex> impl(this);
+	  BuildFEMatrixAlgoImpl<complex> impl(this, pattern_);
 	  if (!impl.run(field, ctable, stiffness))
 	    THROW_ALGORITHM_PROCESSING_ERROR("False returned on legacy run call.--complex detected	");
 		output[Stiffness_Matrix_Complex] = stiffness;
@@ -1234,7 +1553,7 @@ AlgorithmOutput BuildFEMatrixAlgo::run(const AlgorithmInput& input) const
 	else
 	{
 		matrix_pointer_type<double> stiffness;
-	  BuildFEMatrixAlgoImpl<double> impl(this);
+	  BuildFEMatrixAlgoImpl<double> impl(this, pattern_);
 	  if (!impl.run(field, ctable, stiffness))
 	    THROW_ALGORITHM_PROCESSING_ERROR("False returned on legacy run call.");
 		output[Stiffness_Matrix] = stiffness;
@@ -0,0 +1,200 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef CORE_ALGORITHMS_FINITEELEMENTS_ELEMENTSTIFFNESSKERNELS_H
+#define CORE_ALGORITHMS_FINITEELEMENTS_ELEMENTSTIFFNESSKERNELS_H 1
+
+#include <vector>
+
+namespace SCIRun {
+	namespace Core {
+		namespace Algorithms {
+			namespace FiniteElements {
+
+/// Stiffness kernels for linear tetrahedra and trilinear hexahedra that work on
+/// a batch of elements at once. The batch is stored as structure of arrays, so
+/// each loop over the lanes maps onto SIMD registers. They do not go through the
+/// virtual mesh interface; BuildFEMatrix uses them for TetLinearLgn and
+/// HexTrilinearLgn meshes and the virtual path for everything else.
+
+const int STIFFNESS_BATCH_WIDTH = 4;
+
+template <int Nodes, int Width = STIFFNESS_BATCH_WIDTH>
+struct ElementBatch
+{
+  // Node coordinates
+  double x[Nodes][Width];
+  double y[Nodes][Width];
+  double z[Nodes][Width];
+  // Symmetric conductivity tensor: xx, xy, xz, yy, yz, zz
+  double sigma[6][Width];
+  // Local index of the node whose row of the stiffness matrix is computed
+  int row[Width];
+};
+
+namespace detail
+{
+  // (C g) for a symmetric tensor C stored as xx, xy, xz, yy, yz, zz
+  template <int Width>
+  inline void applyTensor(const double (&s)[6][Width], int l, double gx, double gy, double gz,
+    double& cx, double& cy, double& cz)
+  {
+    cx = s[0][l]*gx + s[1][l]*gy + s[2][l]*gz;
+    cy = s[1][l]*gx + s[3][l]*gy + s[4][l]*gz;
+    cz = s[2][l]*gx + s[4][l]*gy + s[5][l]*gz;
+  }
+}
+
+/// Row batch.row[l] of the stiffness matrix of each linear tetrahedron, using
+/// the closed form gradients of the barycentric basis functions.
+/// scale is the quadrature weight times the size of the unit element.
+/// out[j][l] receives entry j of the row, det[l] the Jacobian determinant.
+template <int Width>
+void tetLinearStiffnessRows(const ElementBatch<4,Width>& b, double scale,
+  double (&out)[4][Width], double (&det)[Width])
+{
+  double gx[4][Width], gy[4][Width], gz[4][Width];
+
+  for (int l = 0; l < Width; l++)
+  {
+    const double e1x = b.x[1][l] - b.x[0][l], e1y = b.y[1][l] - b.y[0][l], e1z = b.z[1][l] - b.z[0][l];
+    const double e2x = b.x[2][l] - b.x[0][l], e2y = b.y[2][l] - b.y[0][l], e2z = b.z[2][l] - b.z[0][l];
+    const double e3x = b.x[3][l] - b.x[0][l], e3y = b.y[3][l] - b.y[0][l], e3z = b.z[3][l] - b.z[0][l];
+
+    // The rows of the inverse Jacobian are the cross products of the edges
+    const double c23x = e2y*e3z - e2z*e3y, c23y = e2z*e3x - e2x*e3z, c23z = e2x*e3y - e2y*e3x;
+    const double c31x = e3y*e1z - e3z*e1y, c31y = e3z*e1x - e3x*e1z, c31z = e3x*e1y - e3y*e1x;
+    const double c12x = e1y*e2z - e1z*e2y, c12y = e1z*e2x - e1x*e2z, c12z = e1x*e2y - e1y*e2x;
+
+    const double d = e1x*c23x + e1y*c23y + e1z*c23z;
+    det[l] = d;
+    const double id = (d != 0.0) ? 1.0/d : 0.0;
+
+    gx[1][l] = c23x*id; gy[1][l] = c23y*id; gz[1][l] = c23z*id;
+    gx[2][l] = c31x*id; gy[2][l] = c31y*id; gz[2][l] = c31z*id;
+    gx[3][l] = c12x*id; gy[3][l] = c12y*id; gz[3][l] = c12z*id;
+    gx[0][l] = -(gx[1][l] + gx[2][l] + gx[3][l]);
+    gy[0][l] = -(gy[1][l] + gy[2][l] + gy[3][l]);
+    gz[0][l] = -(gz[1][l] + gz[2][l] + gz[3][l]);
+  }
+
+  for (int l = 0; l < Width; l++)
+  {
+    const int r = b.row[l];
+    const double f = det[l]*scale;
+    double cx, cy, cz;
+    detail::applyTensor(b.sigma, l, f*gx[r][l], f*gy[r][l], f*gz[r][l], cx, cy, cz);
+    for (int j = 0; j < 4; j++)
+      out[j][l] = gx[j][l]*cx + gy[j][l]*cy + gz[j][l]*cz;
+  }
+}
+
+/// Quadrature table of the trilinear hexahedron: for every integration point the
+/// weight (times the size of the unit element) and the derivatives of the eight
+/// basis functions, stored as dN/du for all nodes, then dN/dv, then dN/dw.
+struct HexQuadratureTable
+{
+  std::vector<double> weights;
+  std::vector<std::vector<double>> derivatives;
+};
+
+/// Row batch.row[l] of the stiffness matrix of each trilinear hexahedron.
+/// out[j][l] receives entry j of the row, det[l] the smallest Jacobian
+/// determinant over the integration points.
+template <int Width>
+void hexTrilinearStiffnessRows(const ElementBatch<8,Width>& b, const HexQuadratureTable& table,
+  double (&out)[8][Width], double (&det)[Width])
+{
+  for (int l = 0; l < Width; l++)
+  {
+    det[l] = 1.0;
+    for (int j = 0; j < 8; j++)
+      out[j][l] = 0.0;
+  }
+
+  for (size_t q = 0; q < table.weights.size(); q++)
+  {
+    const double* Nu = &table.derivatives[q][0];
+    const double* Nv = Nu + 8;
+    const double* Nw = Nu + 16;
+    const double w = table.weights[q];
+
+    // Jacobian J(c,r) = dx_c/du_r
+    double J[9][Width];
+    for (int l = 0; l < Width; l++)
+    {
+      for (int k = 0; k < 9; k++)
+        J[k][l] = 0.0;
+      for (int a = 0; a < 8; a++)
+      {
+        J[0][l] += b.x[a][l]*Nu[a]; J[1][l] += b.x[a][l]*Nv[a]; J[2][l] += b.x[a][l]*Nw[a];
+        J[3][l] += b.y[a][l]*Nu[a]; J[4][l] += b.y[a][l]*Nv[a]; J[5][l] += b.y[a][l]*Nw[a];
+        J[6][l] += b.z[a][l]*Nu[a]; J[7][l] += b.z[a][l]*Nv[a]; J[8][l] += b.z[a][l]*Nw[a];
+      }
+    }
+
+    for (int l = 0; l < Width; l++)
+    {
+      // Inverse Jacobian Ji(r,c) = du_r/dx_c from the adjugate
+      const double a00 = J[4][l]*J[8][l] - J[5][l]*J[7][l];
+      const double a01 = J[2][l]*J[7][l] - J[1][l]*J[8][l];
+      const double a02 = J[1][l]*J[5][l] - J[2][l]*J[4][l];
+      const double a10 = J[5][l]*J[6][l] - J[3][l]*J[8][l];
+      const double a11 = J[0][l]*J[8][l] - J[2][l]*J[6][l];
+      const double a12 = J[2][l]*J[3][l] - J[0][l]*J[5][l];
+      const double a20 = J[3][l]*J[7][l] - J[4][l]*J[6][l];
+      const double a21 = J[1][l]*J[6][l] - J[0][l]*J[7][l];
+      const double a22 = J[0][l]*J[4][l] - J[1][l]*J[3][l];
+      const double d = J[0][l]*a00 + J[1][l]*a10 + J[2][l]*a20;
+      if (q == 0 || d < det[l])
+        det[l] = d;
+      const double id = (d != 0.0) ? 1.0/d : 0.0;
+
+      // Gradient of basis function a: dN/dx_c = sum_r dN/du_r Ji(r,c)
+      double gx[8], gy[8], gz[8];
+      for (int a = 0; a < 8; a++)
+      {
+        gx[a] = (Nu[a]*a00 + Nv[a]*a10 + Nw[a]*a20)*id;
+        gy[a] = (Nu[a]*a01 + Nv[a]*a11 + Nw[a]*a21)*id;
+        gz[a] = (Nu[a]*a02 + Nv[a]*a12 + Nw[a]*a22)*id;
+      }
+
+      const int r = b.row[l];
+      const double f = d*w;
+      double cx, cy, cz;
+      detail::applyTensor(b.sigma, l, f*gx[r], f*gy[r], f*gz[r], cx, cy, cz);
+      for (int j = 0; j < 8; j++)
+        out[j][l] += gx[j]*cx + gy[j]*cy + gz[j]*cz;
+    }
+  }
+}
+
+}}}}
+
+#endif
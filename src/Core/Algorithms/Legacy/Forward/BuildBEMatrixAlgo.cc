@@ -49,23 +49,28 @@ DEALINGS IN THE SOFTWARE.
 
 #include <Core/Datatypes/DenseMatrix.h>
 #include <Core/Datatypes/BlockMatrix.h>
+#include <Core/Algorithms/Math/HierarchicalMatrix.h>
 #include <Core/Basis/TriLinearLgn.h>
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Datatypes/Legacy/Field/TriSurfMesh.h>
 #include <Core/GeometryPrimitives/Vector.h>
 #include <Core/GeometryPrimitives/Point.h>
 #include <Core/GeometryPrimitives/PointVectorOperators.h>
+#include <Core/Thread/Parallel.h>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Algorithms::Forward;
+using namespace SCIRun::Core::Algorithms::Math;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
+using SCIRun::Core::Thread::Parallel;
 
 ALGORITHM_PARAMETER_DEF(Forward, FieldNameList);
 ALGORITHM_PARAMETER_DEF(Forward, FieldTypeList);
 ALGORITHM_PARAMETER_DEF(Forward, BoundaryConditionList);
 ALGORITHM_PARAMETER_DEF(Forward, InsideConductivityList);
 ALGORITHM_PARAMETER_DEF(Forward, OutsideConductivityList);
+ALGORITHM_PARAMETER_DEF(Forward, UseHierarchicalMatrix);
 
 void BuildBEMatrixBase::getOmega(
   const Vector& y1,
@@ -515,8 +520,331 @@ public:
   double,
   double,
   const std::vector<double>& );
+
+  // Same matrices as make_cross_P_compute and make_cross_G_compute, as hierarchical
+  // matrices: parts where the nodes of hsurf1 are far from the triangles of hsurf2
+  // are stored as low rank products, computed from a few of their rows and columns.
+  static HierarchicalMatrixHandle make_cross_P_hierarchical(VMesh*, VMesh*, double, double);
+  static HierarchicalMatrixHandle make_cross_G_hierarchical(VMesh*, VMesh*, double, double,
+    const std::vector<double>&);
+
+private:
+  struct SolidAngleTable;
+  struct RadonTable;
+};
+
+namespace
+{
+  // Nodes and triangles of a surface copied out of the mesh, so hierarchical matrix
+  // blocks can be evaluated from several threads at once
+  struct SurfaceGeometry
+  {
+    explicit SurfaceGeometry(VMesh* mesh)
+    {
+      VMesh::Node::size_type nnodes;
+      mesh->size(nnodes);
+      points.resize(nnodes);
+      for (VMesh::Node::index_type i = 0; i < nnodes; ++i)
+        points[i] = Vector(mesh->get_point(i));
+
+      VMesh::Face::size_type nfaces;
+      mesh->size(nfaces);
+      faces.resize(3 * static_cast<size_t>(nfaces));
+      nodeFaces.resize(nnodes);
+      VMesh::Node::array_type nodes;
+      for (VMesh::Face::index_type f = 0; f < nfaces; ++f)
+      {
+        mesh->get_nodes(nodes, f);
+        for (int k = 0; k < 3; k++)
+        {
+          faces[3 * f + k] = nodes[k];
+          nodeFaces[nodes[k]].push_back(f);
+        }
+      }
+    }
+
+    // A node as observation point
+    std::vector<BBox> nodeBoxes() const
+    {
+      std::vector<BBox> boxes(points.size());
+      for (size_t i = 0; i < points.size(); i++)
+        boxes[i] = BBox(Point(points[i]), Point(points[i]));
+      return boxes;
+    }
+
+    // The triangles around a node, where its basis function is not zero
+    std::vector<BBox> supportBoxes() const
+    {
+      std::vector<BBox> boxes(nodeBoxes());
+      for (size_t i = 0; i < points.size(); i++)
+        for (auto f : nodeFaces[i])
+          for (int k = 0; k < 3; k++)
+            boxes[i].extend(Point(points[faces[3 * f + k]]));
+      return boxes;
+    }
+
+    // Triangles that touch any of the nodes in cols, and for every corner of those
+    // triangles the position of the node in cols, or -1
+    void gather(const std::vector<index_type>& cols, std::vector<index_type>& tris,
+      std::vector<int>& local) const
+    {
+      std::vector<std::pair<index_type, int> > lookup(cols.size());
+      tris.clear();
+      for (size_t c = 0; c < cols.size(); c++)
+      {
+        lookup[c] = std::make_pair(cols[c], static_cast<int>(c));
+        tris.insert(tris.end(), nodeFaces[cols[c]].begin(), nodeFaces[cols[c]].end());
+      }
+      std::sort(lookup.begin(), lookup.end());
+      std::sort(tris.begin(), tris.end());
+      tris.erase(std::unique(tris.begin(), tris.end()), tris.end());
+
+      local.resize(3 * tris.size());
+      for (size_t t = 0; t < tris.size(); t++)
+      {
+        for (int k = 0; k < 3; k++)
+        {
+          const index_type node = faces[3 * tris[t] + k];
+          auto it = std::lower_bound(lookup.begin(), lookup.end(), std::make_pair(node, -1));
+          local[3 * t + k] = (it != lookup.end() && it->first == node) ? it->second : -1;
+        }
+      }
+    }
+
+    std::vector<Vector> points;
+    std::vector<index_type> faces;
+    std::vector<std::vector<index_type> > nodeFaces;
+  };
+}
+
+// The parts of getOmega that only depend on the triangle, for every triangle of a surface
+struct BuildBEMatrixBaseCompute::SolidAngleTable
+{
+  explicit SolidAngleTable(const SurfaceGeometry& surface) : surface_(surface)
+  {
+    const size_t nfaces = surface.faces.size() / 3;
+    for (int k = 0; k < 3; k++)
+    {
+      ex[k].resize(nfaces); ey[k].resize(nfaces); ez[k].resize(nfaces);
+      length[k].resize(nfaces);
+    }
+    nx.resize(nfaces); ny.resize(nfaces); nz.resize(nfaces);
+    invA2.resize(nfaces);
+
+    for (size_t f = 0; f < nfaces; f++)
+    {
+      const Vector& p1 = surface.points[surface.faces[3 * f]];
+      const Vector& p2 = surface.points[surface.faces[3 * f + 1]];
+      const Vector& p3 = surface.points[surface.faces[3 * f + 2]];
+      const Vector edges[3] = { p2 - p1, p3 - p2, p1 - p3 };
+      for (int k = 0; k < 3; k++)
+      {
+        ex[k][f] = edges[k].x(); ey[k][f] = edges[k].y(); ez[k][f] = edges[k].z();
+        length[k][f] = edges[k].length();
+      }
+      const Vector N = Cross(edges[0], -edges[2]);
+      nx[f] = N.x(); ny[f] = N.y(); nz[f] = N.z();
+      invA2[f] = 1 / N.length2();
+    }
+  }
+
+  // Same as getOmega(p1 - pp, p2 - pp, p3 - pp, coef) for triangle f
+  void coefficients(size_t f, const Vector& pp, double coef[3]) const
+  {
+    const double epsilon = 1e-12;
+    const Vector y[3] = { surface_.points[surface_.faces[3 * f]] - pp,
+      surface_.points[surface_.faces[3 * f + 1]] - pp,
+      surface_.points[surface_.faces[3 * f + 2]] - pp };
+    const Vector e[3] = { Vector(ex[0][f], ey[0][f], ez[0][f]),
+      Vector(ex[1][f], ey[1][f], ez[1][f]), Vector(ex[2][f], ey[2][f], ez[2][f]) };
+    const double Ny[3] = { y[0].length(), y[1].length(), y[2].length() };
+
+    // edge k runs from vertex k to vertex k+1
+    double gamma[3];
+    for (int k = 0; k < 3; k++)
+    {
+      const int k1 = (k + 1) % 3;
+      const double NomGamma = Ny[k] * length[k][f] + Dot(y[k], e[k]);
+      const double DenomGamma = Ny[k1] * length[k][f] + Dot(y[k1], e[k]);
+      gamma[k] = 0;
+      if (fabs(DenomGamma - NomGamma) > epsilon && DenomGamma != 0 && NomGamma != 0)
+        gamma[k] = -1 / length[k][f] * log(NomGamma / DenomGamma);
+    }
+
+    const Vector c23 = Cross(y[1], y[2]);
+    const Vector c31 = Cross(y[2], y[0]);
+    const Vector c12 = Cross(y[0], y[1]);
+    const double d = Dot(y[0], c23);
+    const Vector OmegaVec = (gamma[2] - gamma[0]) * y[0] + (gamma[0] - gamma[1]) * y[1] + (gamma[1] - gamma[2]) * y[2];
+
+    const double Nn = Ny[0] * Ny[1] * Ny[2] + Ny[0] * Dot(y[1], y[2]) + Ny[2] * Dot(y[0], y[1]) + Ny[1] * Dot(y[2], y[0]);
+    double Omega;
+    if (Nn > 0) Omega = 2 * atan(d / Nn);
+    else if (Nn < 0) Omega = 2 * atan(d / Nn) + 2 * M_PI;
+    else Omega = d > 0 ? M_PI : -M_PI;
+
+    const Vector N(nx[f], ny[f], nz[f]);
+    coef[0] = invA2[f] * (Dot(c23, N) * Omega + d * Dot(e[1], OmegaVec));
+    coef[1] = invA2[f] * (Dot(c31, N) * Omega + d * Dot(e[2], OmegaVec));
+    coef[2] = invA2[f] * (Dot(c12, N) * Omega + d * Dot(e[0], OmegaVec));
+  }
+
+  const SurfaceGeometry& surface_;
+  std::vector<double> ex[3], ey[3], ez[3], length[3];
+  std::vector<double> nx, ny, nz, invA2;
+};
+
+// The seven Radon points of every triangle of a surface, with the cruse weights times the
+// Radon weights times the area, so one G entry is a weighted sum of 1/r over the points
+struct BuildBEMatrixBaseCompute::RadonTable
+{
+  RadonTable(const SurfaceGeometry& surface, const std::vector<double>& areas) :
+    R_W(1, 7)
+  {
+    const double sqrt15 = sqrt(15.0);
+    R_W(0,0) = 9.0/40.0;
+    R_W(0,1) = R_W(0,2) = R_W(0,3) = (155 + sqrt15) / 1200;
+    R_W(0,4) = R_W(0,5) = R_W(0,6) = (155 - sqrt15) / 1200;
+    s = (1 - sqrt15) / 7;
+    r = (1 + sqrt15) / 7;
+
+    const size_t nfaces = surface.faces.size() / 3;
+    for (int k = 0; k < 7; k++)
+    {
+      qx[k].resize(nfaces); qy[k].resize(nfaces); qz[k].resize(nfaces);
+      for (int i = 0; i < 3; i++)
+        w[i][k].resize(nfaces);
+    }
+
+    DenseMatrix cruse_weights(3, 7);
+    for (size_t f = 0; f < nfaces; f++)
+    {
+      const Vector& p1 = surface.points[surface.faces[3 * f]];
+      const Vector& p2 = surface.points[surface.faces[3 * f + 1]];
+      const Vector& p3 = surface.points[surface.faces[3 * f + 2]];
+      const Vector centroid = (p1 + p2 + p3) / 3.0;
+      const Vector points[7] = { centroid,
+        centroid * (1 - s) + p1 * s, centroid * (1 - s) + p2 * s, centroid * (1 - s) + p3 * s,
+        centroid * (1 - r) + p1 * r, centroid * (1 - r) + p2 * r, centroid * (1 - r) + p3 * r };
+
+      get_cruse_weights(p1, p2, p3, s, r, areas[f], cruse_weights);
+      for (int k = 0; k < 7; k++)
+      {
+        qx[k][f] = points[k].x(); qy[k][f] = points[k].y(); qz[k][f] = points[k].z();
+        for (int i = 0; i < 3; i++)
+          w[i][k][f] = areas[f] * cruse_weights(i, k) * R_W(0, k);
+      }
+    }
+  }
+
+  // The integral of 1/|x - op| times each of the three vertex basis functions over triangle f
+  void coefficients(size_t f, const Vector& op, double g_values[3]) const
+  {
+    double inv[7];
+    for (int k = 0; k < 7; k++)
+    {
+      const double dx = qx[k][f] - op.x(), dy = qy[k][f] - op.y(), dz = qz[k][f] - op.z();
+      inv[k] = 1 / sqrt(dx * dx + dy * dy + dz * dz);
+    }
+    for (int i = 0; i < 3; i++)
+    {
+      double sum = 0;
+      for (int k = 0; k < 7; k++)
+        sum += w[i][k][f] * inv[k];
+      g_values[i] = sum;
+    }
+  }
+
+  DenseMatrix R_W; // Radon Points Weights
+  double s, r;
+  std::vector<double> qx[7], qy[7], qz[7];
+  std::vector<double> w[3][7];
 };
 
+namespace
+{
+  // Splits the rows of a BEM block over the thread pool. Every task accumulates a whole
+  // row in a buffer of its own, then adds it to the matrix, so rows are never shared.
+  template <class MatrixType, class RowFunction>
+  void for_each_row(MatrixType& M, size_t nrows, size_t ncols, RowFunction fill)
+  {
+    const size_t threads = Parallel::NumCores();
+    Parallel::For(0, nrows, std::max<size_t>(1, nrows / (4 * threads)), [&](size_t begin, size_t end)
+    {
+      std::vector<double> row(ncols);
+      for (size_t i = begin; i < end; i++)
+      {
+        std::fill(row.begin(), row.end(), 0.0);
+        fill(static_cast<index_type>(i), row);
+        for (size_t j = 0; j < ncols; j++)
+          M(i, j) += row[j];
+      }
+    });
+  }
+}
+
+HierarchicalMatrixHandle BuildBEMatrixBaseCompute::make_cross_P_hierarchical(VMesh* hsurf1, VMesh* hsurf2,
+  double in_cond, double out_cond)
+{
+  const double mult = 1/(4*M_PI)*(out_cond - in_cond);
+  auto rows = boost::make_shared<SurfaceGeometry>(hsurf1);
+  auto cols = boost::make_shared<SurfaceGeometry>(hsurf2);
+  auto table = boost::make_shared<SolidAngleTable>(*cols);
+
+  auto entries = [rows, cols, table, mult](const std::vector<index_type>& r, const std::vector<index_type>& c, DenseMatrix& block)
+  {
+    std::vector<index_type> tris;
+    std::vector<int> local;
+    cols->gather(c, tris, local);
+    double coef[3];
+
+    for (size_t i = 0; i < r.size(); i++)
+    {
+      const Vector& pp = rows->points[r[i]];
+      for (size_t t = 0; t < tris.size(); t++)
+      {
+        table->coefficients(tris[t], pp, coef);
+        for (int k = 0; k < 3; k++)
+          if (local[3 * t + k] >= 0)
+            block(i, local[3 * t + k]) -= coef[k] * mult;
+      }
+    }
+  };
+
+  return boost::make_shared<HierarchicalMatrix>(rows->nodeBoxes(), cols->supportBoxes(), entries);
+}
+
+HierarchicalMatrixHandle BuildBEMatrixBaseCompute::make_cross_G_hierarchical(VMesh* hsurf1, VMesh* hsurf2,
+  double in_cond, double out_cond, const std::vector<double>& avInn)
+{
+  const double mult = 1/(4*M_PI)*(out_cond - in_cond);
+  auto rows = boost::make_shared<SurfaceGeometry>(hsurf1);
+  auto cols = boost::make_shared<SurfaceGeometry>(hsurf2);
+  auto table = boost::make_shared<RadonTable>(*cols, avInn);
+
+  auto entries = [rows, cols, table, mult](const std::vector<index_type>& r, const std::vector<index_type>& c, DenseMatrix& block)
+  {
+    std::vector<index_type> tris;
+    std::vector<int> local;
+    cols->gather(c, tris, local);
+    double g_values[3];
+
+    for (size_t i = 0; i < r.size(); i++)
+    {
+      const Vector& op = rows->points[r[i]];
+      for (size_t t = 0; t < tris.size(); t++)
+      {
+        table->coefficients(tris[t], op, g_values);
+        for (int k = 0; k < 3; k++)
+          if (local[3 * t + k] >= 0)
+            block(i, local[3 * t + k]) += g_values[k] * mult;
+      }
+    }
+  };
+
+  return boost::make_shared<HierarchicalMatrix>(rows->nodeBoxes(), cols->supportBoxes(), entries);
+}
+
 void BuildBEMatrixBase::make_auto_G_allocate(VMesh* hsurf, DenseMatrixHandle &h_GG_)
 {
   auto nnodes = numNodes(hsurf);
@@ -537,66 +865,38 @@ void BuildBEMatrixBaseCompute::make_auto_G_compute(VMesh* hsurf, MatrixType& aut
   //const double mult = 1/(2*M_PI)*((out_cond - in_cond)/op_cond);  // op_cond=out_cond for all the surfaces but the outermost surface which in op_cond=in_cond
   const double mult = 1/(4*M_PI)*(out_cond - in_cond);  // op_cond=out_cond for all the surfaces but the outermost surface which in op_cond=in_cond
 
-  VMesh::Node::array_type nodes;
-
-  VMesh::Node::iterator ni, nie;
-  VMesh::Face::iterator fi, fie;
-  DenseMatrix cruse_weights(3, 7);
-  DenseMatrix g_coef(1, 7);
-  DenseMatrix R_W(1,7); // Radon Points Weights
-  DenseMatrix temp(1,7);
-  DenseMatrix g_values(3, 1);
-
-  double area;
-
-  double sqrt15 = sqrt(15.0);
-  //R_W(0,0) = 9/40; // <- Burak! FIX ME!
-  R_W(0,0) = 9.0/40.0;
-  R_W(0,1) = (155 + sqrt15) / 1200;
-  R_W(0,2) = R_W(0,1);
-  R_W(0,3) = R_W(0,1);
-  R_W(0,4) = (155 - sqrt15) / 1200;
-  R_W(0,5) = R_W(0,4);
-  R_W(0,6) = R_W(0,4);
-
-  double s = (1 - sqrt15) / 7;
-  double r = (1 + sqrt15) / 7;
+  const SurfaceGeometry surface(hsurf);
+  const RadonTable table(surface, avInn);
+  const size_t nnodes = surface.points.size();
+  const size_t nfaces = surface.faces.size() / 3;
 
-
-  hsurf->begin(fi); hsurf->end(fie);
-  for (; fi != fie; ++fi)
-  { //! find contributions from every triangle
-    hsurf->get_nodes(nodes, *fi);
-    Vector p1(hsurf->get_point(nodes[0]));
-    Vector p2(hsurf->get_point(nodes[1]));
-    Vector p3(hsurf->get_point(nodes[2]));
-
-    area = avInn[*fi];
-
-    get_cruse_weights(p1, p2, p3, s, r, area, cruse_weights);
-    Vector centroid = (p1 + p2 + p3) / 3.0;
-    hsurf->begin(ni); hsurf->end(nie);
-    for (; ni != nie; ++ni)
-    { //! for every node
-      VMesh::Node::index_type ppi = *ni;
-      Vector op(hsurf->get_point(ppi));
-
-      if (ppi == nodes[0])       bem_sing(p1, p2, p3, 0, g_values, s, r, R_W);
-      else if (ppi == nodes[1])       bem_sing(p1, p2, p3, 1, g_values, s, r, R_W);
-      else if (ppi == nodes[2])       bem_sing(p1, p2, p3, 2, g_values, s, r, R_W);
-      else
+  for_each_row(auto_G, nnodes, nnodes, [&](index_type ppi, std::vector<double>& row)
+  {
+    DenseMatrix g_values(3, 1);
+    DenseMatrix R_W(table.R_W);
+    double g[3];
+    const Vector& op = surface.points[ppi];
+
+    for (size_t f = 0; f < nfaces; f++)
+    { //! find contributions from every triangle
+      const index_type* nodes = &surface.faces[3 * f];
+      int op_n = -1;
+      for (int i = 0; i < 3; i++)
+        if (nodes[i] == ppi) op_n = i;
+
+      if (op_n >= 0)
       {
-        get_g_coef(p1, p2, p3, op, s, r, centroid, g_coef);
-
-        for (int i=0; i<7; i++)  temp(0,i) = g_coef(0,i)*R_W(0,i);
-
-        g_values = area * (cruse_weights * temp.transpose());
-      } // else
+        bem_sing(surface.points[nodes[0]], surface.points[nodes[1]], surface.points[nodes[2]], op_n, g_values, table.s, table.r, R_W);
+        for (int i = 0; i < 3; ++i)
+          g[i] = g_values(i,0);
+      }
+      else
+        table.coefficients(f, op, g);
 
-      for (int i=0; i<3; ++i)
-        auto_G(ppi, nodes[i])+=g_values(i,0)*mult;
+      for (int i = 0; i < 3; ++i)
+        row[nodes[i]] += g[i]*mult;
     }
-  }
+  });
 }
 
 void BuildBEMatrixBase::make_cross_G_allocate(VMesh* hsurf1, VMesh* hsurf2, DenseMatrixHandle &h_GG_)
@@ -618,60 +918,22 @@ void BuildBEMatrixBaseCompute::make_cross_G_compute(VMesh* hsurf1, VMesh* hsurf2
   const double mult = 1/(4*M_PI)*(out_cond - in_cond);
   //   out_cond and in_cond belong to hsurf2 and op_cond is the out_cond of hsurf1 for all the surfaces but the outermost surface which in op_cond=in_cond
 
-  VMesh::Node::array_type nodes;
-
-  VMesh::Node::iterator  ni, nie;
-  VMesh::Face::iterator  fi, fie;
-
-  DenseMatrix cruse_weights(3, 7);
-  DenseMatrix g_coef(1, 7);
-  DenseMatrix R_W(1,7); // Radon Points Weights
-  DenseMatrix temp(1,7);
-  DenseMatrix g_values(3, 1);
-
-  double area;
-
-  double sqrt15 = sqrt(15.0);
-  //R_W(0,0) = 9/40; // <- Burak! FIX ME!
-  R_W(0,0) = 9.0/40.0;
-  R_W(0,1) = (155 + sqrt15) / 1200;
-  R_W(0,2) = R_W(0,1);
-  R_W(0,3) = R_W(0,1);
-  R_W(0,4) = (155 - sqrt15) / 1200;
-  R_W(0,5) = R_W(0,4);
-  R_W(0,6) = R_W(0,4);
-
-  double s = (1 - sqrt15) / 7;
-  double r = (1 + sqrt15) / 7;
-
-  hsurf2->begin(fi); hsurf2->end(fie);
-  for (; fi != fie; ++fi)
-  { //! find contributions from every triangle
-    hsurf2->get_nodes(nodes, *fi);
-    Vector p1(hsurf2->get_point(nodes[0]));
-    Vector p2(hsurf2->get_point(nodes[1]));
-    Vector p3(hsurf2->get_point(nodes[2]));
-
-    area = avInn[*fi];
-
-    get_cruse_weights(p1, p2, p3, s, r, area, cruse_weights);
-    Vector centroid = (p1 + p2 + p3) / 3.0;
-
-    hsurf1->begin(ni); hsurf1->end(nie);
-    for (; ni != nie; ++ni)
-    { //! for every node
-      VMesh::Node::index_type ppi = *ni;
-      Vector op(hsurf1->get_point(ppi));
-      get_g_coef(p1, p2, p3, op, s, r, centroid, g_coef);
-
-      for (int i=0; i<7; i++)  temp(0,i) = g_coef(0,i)*R_W(0,i);
+  const SurfaceGeometry observers(hsurf1);
+  const SurfaceGeometry surface(hsurf2);
+  const RadonTable table(surface, avInn);
+  const size_t nfaces = surface.faces.size() / 3;
 
-      g_values = area * (cruse_weights * temp.transpose());
-
-      for (int i=0; i<3; ++i)
-        cross_G(ppi, nodes[i])+=g_values(i,0)*mult;
+  for_each_row(cross_G, observers.points.size(), surface.points.size(), [&](index_type ppi, std::vector<double>& row)
+  {
+    double g[3];
+    const Vector& op = observers.points[ppi];
+    for (size_t f = 0; f < nfaces; f++)
+    { //! find contributions from every triangle
+      table.coefficients(f, op, g);
+      for (int i = 0; i < 3; ++i)
+        row[surface.faces[3 * f + i]] += g[i]*mult;
     }
-  }
+  });
 }
 
 void BuildBEMatrixBase::make_cross_P_allocate(VMesh* hsurf1, VMesh* hsurf2, DenseMatrixHandle &h_PP_)
@@ -691,32 +953,23 @@ void BuildBEMatrixBaseCompute::make_cross_P_compute(VMesh* hsurf1, VMesh* hsurf2
 {
   const double mult = 1/(4*M_PI)*(out_cond - in_cond);
   //   out_cond and in_cond belong to hsurf2 and op_cond is the out_cond of hsurf1 for all the surfaces but the outermost surface which in op_cond=in_cond
-  VMesh::Node::array_type nodes;
-  DenseMatrix coef(1, 3);
-  int i;
-
-  VMesh::Node::iterator  ni, nie;
-  VMesh::Face::iterator  fi, fie;
-
-  hsurf1->begin(ni); hsurf1->end(nie);
-  for (; ni != nie; ++ni){ //! for every node
-    VMesh::Node::index_type ppi = *ni;
-    Point pp = hsurf1->get_point(ppi);
 
-    hsurf2->begin(fi); hsurf2->end(fie);
-    for (; fi != fie; ++fi){ //! find contributions from every triangle
+  const SurfaceGeometry observers(hsurf1);
+  const SurfaceGeometry surface(hsurf2);
+  const SolidAngleTable table(surface);
+  const size_t nfaces = surface.faces.size() / 3;
 
-      hsurf2->get_nodes(nodes, *fi);
-      Vector v1 = hsurf2->get_point(nodes[0]) - pp;
-      Vector v2 = hsurf2->get_point(nodes[1]) - pp;
-      Vector v3 = hsurf2->get_point(nodes[2]) - pp;
-
-      getOmega(v1, v2, v3, coef);
-
-      for (i=0; i<3; ++i)
-        cross_P(ppi, nodes[i])-=coef(0,i)*mult;
+  for_each_row(cross_P, observers.points.size(), surface.points.size(), [&](index_type ppi, std::vector<double>& row)
+  {
+    double coef[3];
+    const Vector& pp = observers.points[ppi];
+    for (size_t f = 0; f < nfaces; f++)
+    { //! find contributions from every triangle
+      table.coefficients(f, pp, coef);
+      for (int i = 0; i < 3; ++i)
+        row[surface.faces[3 * f + i]] -= coef[i]*mult;
     }
-  }
+  });
 }
 
 void BuildBEMatrixBase::make_auto_P_allocate(VMesh* hsurf, DenseMatrixHandle &h_PP_)
@@ -741,43 +994,30 @@ template <class MatrixType>
 void BuildBEMatrixBaseCompute::make_auto_P_compute(VMesh* hsurf, MatrixType& auto_P, double in_cond, double out_cond, double op_cond)
 {
   auto nnodes = auto_P.rows();
-  
-  
 
   //const double mult = 1/(2*M_PI)*((out_cond - in_cond)/op_cond);  // op_cond=out_cond for all the surfaces but the outermost surface which in op_cond=in_cond
   const double mult = 1/(4*M_PI)*(out_cond - in_cond);
 
-  VMesh::Node::array_type nodes;
-  DenseMatrix coef(1, 3);
-
-  VMesh::Node::iterator ni, nie;
-  VMesh::Face::iterator fi, fie;
-
+  const SurfaceGeometry surface(hsurf);
+  const SolidAngleTable table(surface);
+  const size_t nfaces = surface.faces.size() / 3;
   unsigned int i;
 
-  hsurf->begin(ni); hsurf->end(nie);
-
-  for (; ni != nie; ++ni){ //! for every node
-    VMesh::Node::index_type ppi = *ni;
-    Point pp = hsurf->get_point(ppi);
-
-    hsurf->begin(fi); hsurf->end(fie);
-    
-    for (; fi != fie; ++fi) { //! find contributions from every triangle
-
-      hsurf->get_nodes(nodes, *fi);
-      if (ppi!=nodes[0] && ppi!=nodes[1] && ppi!=nodes[2]){
-        Vector v1 = hsurf->get_point(nodes[0]) - pp;
-        Vector v2 = hsurf->get_point(nodes[1]) - pp;
-        Vector v3 = hsurf->get_point(nodes[2]) - pp;
-        
-        getOmega(v1, v2, v3, coef);
-
-        for (i=0; i<3; ++i)
-          auto_P(ppi, nodes[i])-=coef(0,i)*mult;
+  for_each_row(auto_P, surface.points.size(), surface.points.size(), [&](index_type ppi, std::vector<double>& row)
+  {
+    double coef[3];
+    const Vector& pp = surface.points[ppi];
+    for (size_t f = 0; f < nfaces; f++)
+    { //! find contributions from every triangle
+      const index_type* nodes = &surface.faces[3 * f];
+      if (ppi != nodes[0] && ppi != nodes[1] && ppi != nodes[2])
+      {
+        table.coefficients(f, pp, coef);
+        for (int k = 0; k < 3; ++k)
+          row[nodes[k]] -= coef[k]*mult;
       }
     }
-  }
+  });
 
   //! accounting for autosolid angle
   auto sumOfRows = auto_P.rowwise().sum().eval();
@@ -943,16 +1183,26 @@ bool BuildBEMatrixBase::compute_nesting(std::vector<int> &nesting, const std::ve
 class SurfaceAndPoints : public BEMAlgoImpl, public BuildBEMatrixBaseCompute
 {
 public:
+  explicit SurfaceAndPoints(bool hierarchical) : hierarchical_(hierarchical) {}
   virtual MatrixHandle compute(const bemfield_vector& fields) const override;
+private:
+  bool hierarchical_;
 };
 
 class SurfaceToSurface : public BEMAlgoImpl, public BuildBEMatrixBaseCompute
 {
 public:
+  explicit SurfaceToSurface(bool hierarchical) : hierarchical_(hierarchical) {}
   virtual MatrixHandle compute(const bemfield_vector& fields) const override;
+private:
+  // Same transfer matrix, with the blocks between different surfaces kept as
+  // hierarchical matrices and only applied through products
+  MatrixHandle computeHierarchical(const bemfield_vector& fields,
+    const std::vector<int>& sourcefieldindices, const std::vector<int>& measurementfieldindices) const;
+  bool hierarchical_;
 };
 
-BEMAlgoPtr BEMAlgoImplFactory::create(const bemfield_vector& fields)
+BEMAlgoPtr BEMAlgoImplFactory::create(const bemfield_vector& fields, bool hierarchical)
 {
   ///////////////////////////////////////////////////////////////////////////////////////////////////
   // Check for special case where the potentials need to be evaluated at the nodes of a lead
@@ -995,7 +1245,7 @@ BEMAlgoPtr BEMAlgoImplFactory::create(const bemfield_vector& fields)
     // If all of the checks above don't flag meets_conditions as false,
     // return a value that indicates the algorithm to use is the surface-to-nodes case
     if ( meets_conditions )
-      return boost::make_shared<SurfaceAndPoints>();
+      return boost::make_shared<SurfaceAndPoints>(hierarchical);
   }
 
   //////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1020,7 +1270,7 @@ BEMAlgoPtr BEMAlgoImplFactory::create(const bemfield_vector& fields)
   // if all fields are surfaces, there exists a measurement and a source surface, then use the surface-to-surface algorithm... else fail
   if (allsurfaces && hasmeasurementsurf && hassourcesurf)
   {
-    return boost::make_shared<SurfaceToSurface>();
+    return boost::make_shared<SurfaceToSurface>(hierarchical);
   }
   else
   {
@@ -1089,6 +1339,9 @@ MatrixHandle SurfaceToSurface::compute(const bemfield_vector& fields) const
     }
   }
 
+  if (hierarchical_)
+    return computeHierarchical(fields, sourcefieldindices, measurementfieldindices);
+
   std::vector<int> fieldNodeSize(fields.size());
   std::transform(fields.begin(), fields.end(), fieldNodeSize.begin(), [this](const bemfield& f) { return numNodes(f.field_); } );
   DenseBlockMatrix EE(fieldNodeSize, fieldNodeSize);
@@ -1252,6 +1505,130 @@ MatrixHandle SurfaceToSurface::compute(const bemfield_vector& fields) const
 }
 
 
+MatrixHandle SurfaceToSurface::computeHierarchical(const bemfield_vector& fields,
+  const std::vector<int>& sourcefieldindices, const std::vector<int>& measurementfieldindices) const
+{
+  // Same math as compute(), T = inv(Pmm - Y*Psm)*(Y*Pss - Pms) with Y = Gms*inv(Gss).
+  // EE and EJ are never formed: the blocks of a surface with itself are dense, all
+  // others are hierarchical matrices that are only multiplied with or added into
+  // the dense m x m, m x s and s x s matrices the solve needs anyway.
+  const double op_cond = 0.0;
+  const size_t Nsources = sourcefieldindices.size();
+  const size_t Nmeasurements = measurementfieldindices.size();
+
+  auto mesh = [&fields](int f) { return fields[f].field_->vmesh(); };
+  auto offsets = [this, &fields](const std::vector<int>& indices, std::vector<int>& offset, std::vector<int>& size)
+  {
+    offset.resize(indices.size());
+    size.resize(indices.size());
+    int total = 0;
+    for (size_t k = 0; k < indices.size(); k++)
+    {
+      offset[k] = total;
+      size[k] = numNodes(fields[indices[k]].field_);
+      total += size[k];
+    }
+    return total;
+  };
+
+  std::vector<int> sOffset, sSize, mOffset, mSize;
+  const int ns = offsets(sourcefieldindices, sOffset, sSize);
+  const int nm = offsets(measurementfieldindices, mOffset, mSize);
+
+  std::vector<std::vector<double> > triangleareas(Nsources);
+  for (size_t j = 0; j < Nsources; j++)
+    pre_calc_tri_areas(mesh(sourcefieldindices[j]), triangleareas[j]);
+
+  // Gss is factored, so it is dense
+  DenseMatrix Gss = DenseMatrix::Zero(ns, ns);
+  for (size_t j = 0; j < Nsources; j++)
+  {
+    for (size_t i = 0; i < Nsources; i++)
+    {
+      auto block = Gss.block(sOffset[i], sOffset[j], sSize[i], sSize[j]);
+      if (i == j)
+        make_auto_G_compute(mesh(sourcefieldindices[i]), block, fields[sourcefieldindices[i]].insideconductivity, fields[sourcefieldindices[i]].outsideconductivity, op_cond, triangleareas[j]);
+      else
+        make_cross_G_hierarchical(mesh(sourcefieldindices[i]), mesh(sourcefieldindices[j]), fields[j].insideconductivity, fields[j].outsideconductivity, triangleareas[j])->addTo(block);
+    }
+  }
+  printInfo(Gss, "Gss");
+
+  // Y = Gms*inv(Gss), the rows of Gms for a measurement surface as one product each
+  const DenseMatrix iGss = Gss.partialPivLu().inverse();
+  DenseMatrix Y = DenseMatrix::Zero(nm, ns);
+  for (size_t i = 0; i < Nmeasurements; i++)
+  {
+    for (size_t j = 0; j < Nsources; j++)
+    {
+      auto Gms = make_cross_G_hierarchical(mesh(measurementfieldindices[i]), mesh(sourcefieldindices[j]), fields[j].insideconductivity, fields[j].outsideconductivity, triangleareas[j]);
+      Y.middleRows(mOffset[i], mSize[i]) += Gms->multiply(iGss.middleRows(sOffset[j], sSize[j]));
+    }
+  }
+  printInfo(Y, "Y");
+
+  // Y*H for a block H of EE, as (H^T*Y^T)^T
+  auto multiplyLeft = [](const DenseMatrix& Ycols, const HierarchicalMatrix& H) -> DenseMatrix
+  {
+    return H.transposeMultiply(Ycols.transpose()).transpose();
+  };
+
+  // C = Pmm - Y*Psm
+  DenseMatrix C = DenseMatrix::Zero(nm, nm);
+  for (size_t j = 0; j < Nmeasurements; j++)
+  {
+    const int fj = measurementfieldindices[j];
+    for (size_t i = 0; i < Nmeasurements; i++)
+    {
+      const int fi = measurementfieldindices[i];
+      auto block = C.block(mOffset[i], mOffset[j], mSize[i], mSize[j]);
+      if (i == j)
+        make_auto_P_compute(mesh(fi), block, fields[fi].insideconductivity, fields[fi].outsideconductivity, op_cond);
+      else
+        make_cross_P_hierarchical(mesh(fi), mesh(fj), fields[fj].insideconductivity, fields[fj].outsideconductivity)->addTo(block);
+    }
+    for (size_t i = 0; i < Nsources; i++)
+    {
+      const int fi = sourcefieldindices[i];
+      auto Psm = make_cross_P_hierarchical(mesh(fi), mesh(fj), fields[fj].insideconductivity, fields[fj].outsideconductivity);
+      C.middleCols(mOffset[j], mSize[j]) -= multiplyLeft(Y.middleCols(sOffset[i], sSize[i]), *Psm);
+    }
+  }
+  printInfo(C, "C");
+
+  // D = Y*Pss - Pms
+  DenseMatrix D = DenseMatrix::Zero(nm, ns);
+  for (size_t j = 0; j < Nsources; j++)
+  {
+    const int fj = sourcefieldindices[j];
+    for (size_t i = 0; i < Nsources; i++)
+    {
+      const int fi = sourcefieldindices[i];
+      if (i == j)
+      {
+        DenseMatrix Pss = DenseMatrix::Zero(sSize[i], sSize[i]);
+        make_auto_P_compute(mesh(fi), Pss, fields[fi].insideconductivity, fields[fi].outsideconductivity, op_cond);
+        D.middleCols(sOffset[j], sSize[j]) += Y.middleCols(sOffset[i], sSize[i]) * Pss;
+      }
+      else
+      {
+        auto Pss = make_cross_P_hierarchical(mesh(fi), mesh(fj), fields[fj].insideconductivity, fields[fj].outsideconductivity);
+        D.middleCols(sOffset[j], sSize[j]) += multiplyLeft(Y.middleCols(sOffset[i], sSize[i]), *Pss);
+      }
+    }
+    for (size_t i = 0; i < Nmeasurements; i++)
+    {
+      const int fi = measurementfieldindices[i];
+      auto block = D.block(mOffset[i], sOffset[j], mSize[i], sSize[j]);
+      make_cross_P_hierarchical(mesh(fi), mesh(fj), fields[fj].insideconductivity, fields[fj].outsideconductivity)->addTo(block, -1.0);
+    }
+  }
+  printInfo(D, "D");
+
+  return boost::make_shared<DenseMatrix>(C.partialPivLu().solve(D));
+}
+
+
 MatrixHandle SurfaceAndPoints::compute(const bemfield_vector& fields) const
 {
   // NOTE: This is Jeroen's code that has been adapted to fit the new module structure
@@ -1310,6 +1687,24 @@ MatrixHandle SurfaceAndPoints::compute(const bemfield_vector& fields) const
   DenseMatrixHandle Gss;
   DenseMatrixHandle Pns;
   DenseMatrixHandle Gns;
+
+  if (hierarchical_)
+  {
+    // Gns is only applied to inv(Gss)*Pss, so it is never expanded to a dense matrix
+    make_auto_P( surface, Pss, 1.0, 0.0, 1.0 );
+    std::vector<double> area;
+    pre_calc_tri_areas( surface, area );
+    make_auto_G( surface, Gss, 1.0, 0.0, 1.0, area );
+
+    auto hPns = make_cross_P_hierarchical( nodes, surface, 1.0, 0.0 );
+    auto hGns = make_cross_G_hierarchical( nodes, surface, 1.0, 0.0, area );
+    const DenseMatrix W = Gss->inverse() * *Pss;
+    auto T = boost::make_shared<DenseMatrix>(hGns->multiply(W));
+    *T *= -1.0;
+    hPns->addTo(*T);
+    return T;
+  }
+
   make_auto_P( surface, Pss, 1.0, 0.0, 1.0 );
   make_cross_P( nodes, surface, Pns, 1.0, 0.0, 1.0 );
 
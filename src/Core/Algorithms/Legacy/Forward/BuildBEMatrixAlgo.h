@@ -55,6 +55,7 @@ namespace SCIRun {
         ALGORITHM_PARAMETER_DECL(BoundaryConditionList);
         ALGORITHM_PARAMETER_DECL(InsideConductivityList);
         ALGORITHM_PARAMETER_DECL(OutsideConductivityList);
+        ALGORITHM_PARAMETER_DECL(UseHierarchicalMatrix);
 
         typedef std::vector<std::string> FieldTypeListType;
 
@@ -226,7 +227,11 @@ namespace SCIRun {
         class SCISHARE BEMAlgoImplFactory
         {
         public:
-          static BEMAlgoPtr create(const bemfield_vector& fields);
+          /// With hierarchical set, the blocks between different surfaces are built as
+          /// hierarchical matrices instead of evaluating every node/triangle pair.
+          /// They are only applied through products, so the dense cross-surface
+          /// blocks of EE, EJ and Gns are never formed.
+          static BEMAlgoPtr create(const bemfield_vector& fields, bool hierarchical = false);
         };
 
       }}}}
@@ -0,0 +1,303 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Algorithms/Legacy/Forward/BuildBEMatrixAlgo.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/MatrixTypeConversions.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/GeometryPrimitives/Vector.h>
+#include <Core/GeometryPrimitives/Point.h>
+#include <Core/Thread/Parallel.h>
+#include <map>
+#include <tuple>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Algorithms::Forward;
+using SCIRun::Core::Thread::Parallel;
+
+namespace
+{
+  // Sphere made of the surface of a cube with n x n squares per side, each split
+  // in two triangles, projected onto the sphere. The triangles face outwards.
+  FieldHandle CubeSphere(int n, double radius)
+  {
+    FieldInformation fi("TriSurfMesh", 1, "double");
+    FieldHandle field = CreateField(fi);
+    VMesh* mesh = field->vmesh();
+
+    std::map<std::tuple<int, int, int>, VMesh::Node::index_type> nodes;
+    auto node = [&](int axis, int c, int a, int b)
+    {
+      int ijk[3];
+      ijk[axis] = c;
+      ijk[(axis + 1) % 3] = a;
+      ijk[(axis + 2) % 3] = b;
+      const auto key = std::make_tuple(ijk[0], ijk[1], ijk[2]);
+      auto it = nodes.find(key);
+      if (it != nodes.end())
+        return it->second;
+      Vector v(2.0 * ijk[0] / n - 1, 2.0 * ijk[1] / n - 1, 2.0 * ijk[2] / n - 1);
+      v.normalize();
+      return nodes[key] = mesh->add_point(Point(v * radius));
+    };
+
+    for (int axis = 0; axis < 3; axis++)
+      for (int c = 0; c <= n; c += n)
+        for (int a = 0; a < n; a++)
+          for (int b = 0; b < n; b++)
+          {
+            VMesh::Node::array_type quad(4);
+            quad[0] = node(axis, c, a, b);
+            quad[1] = node(axis, c, a + 1, b);
+            quad[2] = node(axis, c, a + 1, b + 1);
+            quad[3] = node(axis, c, a, b + 1);
+            if (c == 0)
+              std::swap(quad[1], quad[3]);
+            VMesh::Node::array_type tri(3);
+            tri[0] = quad[0]; tri[1] = quad[1]; tri[2] = quad[2];
+            mesh->add_elem(tri);
+            tri[1] = quad[2]; tri[2] = quad[3];
+            mesh->add_elem(tri);
+          }
+    return field;
+  }
+
+  // The serial loops the BEM matrices were assembled with before they were
+  // parallelized, straight from getOmega and get_g_coef
+  class ReferenceBEM : public BuildBEMatrixBase
+  {
+  public:
+    static DenseMatrix crossP(VMesh* hsurf1, VMesh* hsurf2, double in_cond, double out_cond)
+    {
+      const double mult = 1/(4*M_PI)*(out_cond - in_cond);
+      DenseMatrix P(DenseMatrix::Zero(numNodes(hsurf1), numNodes(hsurf2)));
+      DenseMatrix coef(1, 3);
+      VMesh::Node::array_type nodes;
+      VMesh::Face::size_type nfaces;
+      hsurf2->size(nfaces);
+      for (int ppi = 0; ppi < P.rows(); ++ppi)
+      {
+        const Point pp = hsurf1->get_point(VMesh::Node::index_type(ppi));
+        for (VMesh::Face::index_type f = 0; f < nfaces; ++f)
+        {
+          hsurf2->get_nodes(nodes, f);
+          getOmega(hsurf2->get_point(nodes[0]) - pp, hsurf2->get_point(nodes[1]) - pp, hsurf2->get_point(nodes[2]) - pp, coef);
+          for (int i = 0; i < 3; ++i)
+            P(ppi, static_cast<int>(nodes[i])) -= coef(0, i) * mult;
+        }
+      }
+      return P;
+    }
+
+    static DenseMatrix autoP(VMesh* hsurf, double in_cond, double out_cond)
+    {
+      const double mult = 1/(4*M_PI)*(out_cond - in_cond);
+      const int nnodes = numNodes(hsurf);
+      DenseMatrix P(DenseMatrix::Zero(nnodes, nnodes));
+      DenseMatrix coef(1, 3);
+      VMesh::Node::array_type nodes;
+      VMesh::Face::size_type nfaces;
+      hsurf->size(nfaces);
+      for (int ppi = 0; ppi < nnodes; ++ppi)
+      {
+        const Point pp = hsurf->get_point(VMesh::Node::index_type(ppi));
+        for (VMesh::Face::index_type f = 0; f < nfaces; ++f)
+        {
+          hsurf->get_nodes(nodes, f);
+          if (ppi == nodes[0] || ppi == nodes[1] || ppi == nodes[2])
+            continue;
+          getOmega(hsurf->get_point(nodes[0]) - pp, hsurf->get_point(nodes[1]) - pp, hsurf->get_point(nodes[2]) - pp, coef);
+          for (int i = 0; i < 3; ++i)
+            P(ppi, static_cast<int>(nodes[i])) -= coef(0, i) * mult;
+        }
+      }
+      const DenseMatrix sumOfRows = P.rowwise().sum();
+      for (int i = 0; i < nnodes; ++i)
+        P(i, i) = out_cond - sumOfRows(i, 0);
+      return P;
+    }
+
+    static DenseMatrix G(VMesh* hsurf1, VMesh* hsurf2, double in_cond, double out_cond, const std::vector<double>& areas)
+    {
+      const double mult = 1/(4*M_PI)*(out_cond - in_cond);
+      const bool same = hsurf1 == hsurf2;
+      DenseMatrix G(DenseMatrix::Zero(numNodes(hsurf1), numNodes(hsurf2)));
+
+      const double sqrt15 = sqrt(15.0);
+      DenseMatrix R_W(1, 7);
+      R_W(0,0) = 9.0/40.0;
+      R_W(0,1) = R_W(0,2) = R_W(0,3) = (155 + sqrt15) / 1200;
+      R_W(0,4) = R_W(0,5) = R_W(0,6) = (155 - sqrt15) / 1200;
+      const double s = (1 - sqrt15) / 7;
+      const double r = (1 + sqrt15) / 7;
+
+      DenseMatrix cruse_weights(3, 7), g_coef(1, 7), temp(1, 7), g_values(3, 1);
+      VMesh::Node::array_type nodes;
+      VMesh::Face::size_type nfaces;
+      hsurf2->size(nfaces);
+      for (VMesh::Face::index_type f = 0; f < nfaces; ++f)
+      {
+        hsurf2->get_nodes(nodes, f);
+        const Vector p1(hsurf2->get_point(nodes[0]));
+        const Vector p2(hsurf2->get_point(nodes[1]));
+        const Vector p3(hsurf2->get_point(nodes[2]));
+        get_cruse_weights(p1, p2, p3, s, r, areas[f], cruse_weights);
+        const Vector centroid = (p1 + p2 + p3) / 3.0;
+
+        for (int ppi = 0; ppi < G.rows(); ++ppi)
+        {
+          if (same && ppi == nodes[0]) bem_sing(p1, p2, p3, 0, g_values, s, r, R_W);
+          else if (same && ppi == nodes[1]) bem_sing(p1, p2, p3, 1, g_values, s, r, R_W);
+          else if (same && ppi == nodes[2]) bem_sing(p1, p2, p3, 2, g_values, s, r, R_W);
+          else
+          {
+            get_g_coef(p1, p2, p3, Vector(hsurf1->get_point(VMesh::Node::index_type(ppi))), s, r, centroid, g_coef);
+            for (int i = 0; i < 7; i++)
+              temp(0, i) = g_coef(0, i) * R_W(0, i);
+            g_values = areas[f] * (cruse_weights * temp.transpose());
+          }
+          for (int i = 0; i < 3; ++i)
+            G(ppi, static_cast<int>(nodes[i])) += g_values(i, 0) * mult;
+        }
+      }
+      return G;
+    }
+  };
+
+  double relativeDifference(const DenseMatrix& A, const DenseMatrix& B)
+  {
+    return (A - B).norm() / B.norm();
+  }
+
+  class BuildBEMatrixTests : public ::testing::Test
+  {
+  protected:
+    BuildBEMatrixTests() :
+      inner_(CubeSphere(5, 0.6)), outer_(CubeSphere(7, 1.0))
+    {
+      BuildBEMatrixBase::pre_calc_tri_areas(inner_->vmesh(), innerAreas_);
+      BuildBEMatrixBase::pre_calc_tri_areas(outer_->vmesh(), outerAreas_);
+    }
+
+    FieldHandle inner_, outer_;
+    std::vector<double> innerAreas_, outerAreas_;
+  };
+}
+
+TEST_F(BuildBEMatrixTests, NestedSpheresMatchSerialKernels)
+{
+  VMesh* inner = inner_->vmesh();
+  VMesh* outer = outer_->vmesh();
+  DenseMatrixHandle P, G;
+
+  BuildBEMatrixBase::make_cross_P(inner, outer, P, 0.0, 1.0, 1.0);
+  EXPECT_LT(relativeDifference(*P, ReferenceBEM::crossP(inner, outer, 0.0, 1.0)), 1e-12);
+  BuildBEMatrixBase::make_cross_P(outer, inner, P, 1.0, 2.0, 1.0);
+  EXPECT_LT(relativeDifference(*P, ReferenceBEM::crossP(outer, inner, 1.0, 2.0)), 1e-12);
+  BuildBEMatrixBase::make_auto_P(inner, P, 1.0, 2.0, 2.0);
+  EXPECT_LT(relativeDifference(*P, ReferenceBEM::autoP(inner, 1.0, 2.0)), 1e-12);
+
+  BuildBEMatrixBase::make_cross_G(inner, outer, G, 0.0, 1.0, 1.0, outerAreas_);
+  EXPECT_LT(relativeDifference(*G, ReferenceBEM::G(inner, outer, 0.0, 1.0, outerAreas_)), 1e-12);
+  BuildBEMatrixBase::make_auto_G(outer, G, 0.0, 1.0, 1.0, outerAreas_);
+  EXPECT_LT(relativeDifference(*G, ReferenceBEM::G(outer, outer, 0.0, 1.0, outerAreas_)), 1e-12);
+}
+
+TEST_F(BuildBEMatrixTests, ResultDoesNotDependOnThreadCount)
+{
+  VMesh* inner = inner_->vmesh();
+  VMesh* outer = outer_->vmesh();
+  DenseMatrixHandle P1, G1, PN, GN;
+
+  Parallel::SetMaximumCores(1);
+  BuildBEMatrixBase::make_auto_P(outer, P1, 0.0, 1.0, 1.0);
+  BuildBEMatrixBase::make_cross_G(outer, inner, G1, 1.0, 2.0, 1.0, innerAreas_);
+  Parallel::SetMaximumCores(0);
+  BuildBEMatrixBase::make_auto_P(outer, PN, 0.0, 1.0, 1.0);
+  BuildBEMatrixBase::make_cross_G(outer, inner, GN, 1.0, 2.0, 1.0, innerAreas_);
+
+  // every row is summed by one task in the same order
+  EXPECT_EQ(*P1, *PN);
+  EXPECT_EQ(*G1, *GN);
+}
+
+TEST_F(BuildBEMatrixTests, HierarchicalTransferMatrixMatchesDense)
+{
+  FieldInformation fi("PointCloudMesh", 1, "double");
+  FieldHandle electrodes = CreateField(fi);
+  VMesh* points = electrodes->vmesh();
+  for (int i = 0; i < 400; i++)
+  {
+    // points spread over a sphere around the surface, some of them close to it
+    const double z = 1.0 - (2.0 * i + 1.0) / 400;
+    const double phi = 2.399963 * i;
+    const double radius = i % 4 == 0 ? 1.1 : 2.0;
+    points->add_point(Point(Vector(sqrt(1 - z * z) * cos(phi), sqrt(1 - z * z) * sin(phi), z) * radius));
+  }
+
+  bemfield surface(outer_), nodes(electrodes);
+  surface.surface = true;
+  bemfield_vector fields { surface, nodes };
+
+  auto dense = castMatrix::toDense(BEMAlgoImplFactory::create(fields, false)->compute(fields));
+  auto hierarchical = castMatrix::toDense(BEMAlgoImplFactory::create(fields, true)->compute(fields));
+  ASSERT_TRUE(dense && hierarchical);
+  ASSERT_EQ(dense->rows(), hierarchical->rows());
+  ASSERT_EQ(dense->cols(), hierarchical->cols());
+  EXPECT_LT(relativeDifference(*hierarchical, *dense), 1e-4);
+}
+
+TEST_F(BuildBEMatrixTests, HierarchicalSurfaceToSurfaceMatchesDense)
+{
+  // heart, lungs and torso like nesting, with two measurement surfaces so that
+  // both products with the cross blocks and the ones added into Pmm are used
+  bemfield heart(inner_), lungs(CubeSphere(6, 0.8)), torso(outer_);
+  heart.surface = lungs.surface = torso.surface = true;
+  heart.set_source_dirichlet();
+  heart.insideconductivity = 0.0;
+  heart.outsideconductivity = 1.0;
+  lungs.set_measurement_neumann();
+  lungs.insideconductivity = 1.0;
+  lungs.outsideconductivity = 2.0;
+  torso.set_measurement_neumann();
+  torso.insideconductivity = 2.0;
+  torso.outsideconductivity = 0.0;
+  bemfield_vector fields { heart, lungs, torso };
+
+  auto dense = castMatrix::toDense(BEMAlgoImplFactory::create(fields, false)->compute(fields));
+  auto hierarchical = castMatrix::toDense(BEMAlgoImplFactory::create(fields, true)->compute(fields));
+  ASSERT_TRUE(dense && hierarchical);
+  ASSERT_EQ(dense->rows(), hierarchical->rows());
+  ASSERT_EQ(dense->cols(), hierarchical->cols());
+  EXPECT_LT(relativeDifference(*hierarchical, *dense), 1e-4);
+}
@@ -0,0 +1,320 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+//    File       : SolveInverseProblemWithSpectralTikhonovImpl.cc
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include <Core/Algorithms/Legacy/Inverse/TikhonovAlgoAbstractBase.h>
+#include <Core/Algorithms/Legacy/Inverse/SolveInverseProblemWithSpectralTikhonovImpl.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Utils/Exception.h>
+
+#include <Eigen/Eigenvalues>
+#include <Eigen/SVD>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Inverse;
+
+SolveInverseProblemWithSpectralTikhonovImpl::SolveInverseProblemWithSpectralTikhonovImpl(const DenseMatrix& forwardMatrix_, const DenseMatrix& measuredData_,
+	const DenseMatrixHandle& sourceWeighting_, const DenseMatrixHandle& sensorWeighting_,
+	const int regularizationSolutionSubcase_, const int regularizationResidualSubcase_, const int rank_) : residual2(0)
+{
+	const int M = forwardMatrix_.nrows();
+	const int N = forwardMatrix_.ncols();
+
+	// WEIGHTED FORWARD MATRIX AND DATA: C*A and C*y
+	DenseMatrix C, CA, Cy;
+	if (sensorWeighting_)
+	{
+		if (regularizationResidualSubcase_ == TikhonovAlgoAbstractBase::residual_constrained)
+		{
+			C = *sensorWeighting_;
+		}
+		// squared form C^T*C: use its Cholesky factor
+		else
+		{
+			Eigen::LLT<DenseMatrix::EigenBase> LLtrCCtr(*sensorWeighting_);
+			if (LLtrCCtr.info() != Eigen::Success)
+				THROW_ALGORITHM_INPUT_ERROR_SIMPLE("Squared residual weighting matrix must be positive definite for the spectral decomposition.");
+			C = DenseMatrix::EigenBase(LLtrCCtr.matrixU());
+		}
+		CA = C * forwardMatrix_;
+		Cy = C * measuredData_;
+	}
+	else
+	{
+		CA = forwardMatrix_;
+		Cy = measuredData_;
+	}
+
+	if (sourceWeighting_)
+	{
+		DenseMatrix RtrR;
+		if (regularizationSolutionSubcase_ == TikhonovAlgoAbstractBase::solution_constrained)
+			RtrR = sourceWeighting_->transpose() * (*sourceWeighting_);
+		else
+			RtrR = *sourceWeighting_;
+		generalizedDecompose(CA, Cy, RtrR);
+	}
+	else if (rank_ > 0 && rank_ < std::min(M, N))
+	{
+		randomizedDecompose(CA, Cy, rank_);
+	}
+	else
+	{
+		decompose(CA, Cy);
+	}
+
+	beta2 = beta.rowwise().squaredNorm();
+
+	// the decompositions project C*y, fold C into the operators applied to y
+	if (sensorWeighting_)
+	{
+		projection = projection * C;
+		if (nullOperator.nrows() > 0)
+			nullOperator = nullOperator * C;
+	}
+}
+
+///// SVD of C*A
+void SolveInverseProblemWithSpectralTikhonovImpl::decompose(const DenseMatrix& CA, const DenseMatrix& Cy)
+{
+	Eigen::BDCSVD<DenseMatrix::EigenBase> svd(CA, Eigen::ComputeThinU | Eigen::ComputeThinV);
+	const int rank = svd.rank();
+
+	gamma = svd.singularValues().head(rank);
+	basis = svd.matrixV().leftCols(rank);
+	DenseMatrix U = svd.matrixU().leftCols(rank);
+	projection = U.transpose();
+	beta = projection * Cy;
+	x0 = DenseMatrix::Zero(CA.ncols(), Cy.ncols());
+	residual2 = (Cy - U * beta).squaredNorm();
+}
+
+///// Truncated SVD of C*A from a randomized range finder (Halko, Martinsson & Tropp)
+void SolveInverseProblemWithSpectralTikhonovImpl::randomizedDecompose(const DenseMatrix& CA, const DenseMatrix& Cy, int rank)
+{
+	const int M = CA.nrows();
+	const int N = CA.ncols();
+	const int oversampling = std::min(10, std::min(M, N) - rank);
+	const int numSamples = rank + oversampling;
+	const int powerIterations = 2;
+
+	// fixed seed, so that repeated executions give the same solution
+	std::mt19937 generator(5489u);
+	std::normal_distribution<double> normal;
+	DenseMatrix Omega(N, numSamples);
+	for (int i = 0; i < N; i++)
+		for (int j = 0; j < numSamples; j++)
+			Omega(i, j) = normal(generator);
+
+	auto orthonormalize = [](const DenseMatrix& Y)
+	{
+		Eigen::HouseholderQR<DenseMatrix::EigenBase> qr(Y);
+		return DenseMatrix(qr.householderQ() * DenseMatrix::EigenBase::Identity(Y.nrows(), Y.ncols()));
+	};
+
+	// orthonormal basis Q of the dominant range of C*A, sharpened by power iterations
+	DenseMatrix Q = orthonormalize(CA * Omega);
+	for (int k = 0; k < powerIterations; k++)
+	{
+		DenseMatrix Z = orthonormalize(CA.transpose() * Q);
+		Q = orthonormalize(CA * Z);
+	}
+
+	DenseMatrix B = Q.transpose() * CA;
+	Eigen::BDCSVD<DenseMatrix::EigenBase> svd(B, Eigen::ComputeThinU | Eigen::ComputeThinV);
+	rank = std::min(rank, static_cast<int>(svd.rank()));
+
+	gamma = svd.singularValues().head(rank);
+	basis = svd.matrixV().leftCols(rank);
+	DenseMatrix U = Q * svd.matrixU().leftCols(rank);
+	projection = U.transpose();
+	beta = projection * Cy;
+	x0 = DenseMatrix::Zero(N, Cy.ncols());
+	residual2 = (Cy - U * beta).squaredNorm();
+}
+
+///// Generalized SVD of (C*A, R)
+//      With H = A^T C^T C A and K = R^T R, the generalized eigenvectors of K w = theta (H + K) w satisfy
+//      W^T (H + K) W = I and W^T K W = diag(theta), so ||C A w_i||^2 = 1 - theta_i, ||R w_i||^2 = theta_i
+//      and the generalized singular values are gamma_i^2 = (1 - theta_i) / theta_i.
+//      Directions with theta_i = 0 (null space of R) are not regularized and directions with
+//      theta_i = 1 (null space of C*A) do not contribute to the solution.
+void SolveInverseProblemWithSpectralTikhonovImpl::generalizedDecompose(const DenseMatrix& CA, const DenseMatrix& Cy, const DenseMatrix& RtrR)
+{
+	const int N = CA.ncols();
+	const int numTimeSamples = Cy.ncols();
+
+	DenseMatrix H = CA.transpose() * CA;
+
+	// balance both terms so that the eigenproblem is well scaled; gamma is corrected accordingly
+	const double scale = RtrR.trace() > 0 ? H.trace() / RtrR.trace() : 1.0;
+	DenseMatrix K = scale * RtrR;
+	DenseMatrix S = H + K;
+
+	Eigen::GeneralizedSelfAdjointEigenSolver<DenseMatrix::EigenBase> ges(K, S);
+	if (ges.info() != Eigen::Success)
+		THROW_ALGORITHM_INPUT_ERROR_SIMPLE("Forward matrix and solution regularization matrix have a common null space; the spectral decomposition is not defined.");
+
+	const DenseMatrix W = ges.eigenvectors();
+	const DenseColumnMatrix theta = ges.eigenvalues();
+	const DenseMatrix P = CA * W;
+	const DenseMatrix c = P.transpose() * Cy;
+	const double tolerance = N * std::numeric_limits<double>::epsilon();
+
+	// eigenvalues are in increasing order, so gamma comes out in decreasing order
+	std::vector<int> regularized;
+	x0 = DenseMatrix::Zero(N, numTimeSamples);
+	DenseMatrix nullSpace = DenseMatrix::Zero(N, Cy.nrows());
+	DenseMatrix range = DenseMatrix::Zero(Cy.nrows(), numTimeSamples);
+	for (int i = 0; i < N; i++)
+	{
+		const double Pnorm2 = P.col(i).squaredNorm();
+		if (Pnorm2 <= tolerance)
+			continue;
+
+		range += P.col(i) * c.row(i) / Pnorm2;
+		if (theta[i] <= tolerance)
+		{
+			x0 += W.col(i) * c.row(i) / Pnorm2;
+			nullSpace += W.col(i) * P.col(i).transpose() / Pnorm2;
+		}
+		else
+			regularized.push_back(i);
+	}
+
+	const int rank = static_cast<int>(regularized.size());
+	gamma.resize(rank);
+	basis.resize(N, rank);
+	beta.resize(rank, numTimeSamples);
+	projection.resize(rank, Cy.nrows());
+	for (int k = 0; k < rank; k++)
+	{
+		const int i = regularized[k];
+		const double Pnorm2 = P.col(i).squaredNorm();
+		gamma[k] = std::sqrt(scale * Pnorm2 / theta[i]);
+		basis.col(k) = W.col(i) * std::sqrt(scale / theta[i]);
+		beta.row(k) = c.row(i) / std::sqrt(Pnorm2);
+		projection.row(k) = P.col(i).transpose() / std::sqrt(Pnorm2);
+	}
+	if (!x0.isZero(0))
+		nullOperator = nullSpace;
+	residual2 = (Cy - range).squaredNorm();
+}
+
+/////////////////////////
+///////// compute Inverse solution
+DenseMatrix SolveInverseProblemWithSpectralTikhonovImpl::computeInverseSolution( double lambda, bool inverseCalculation) const
+{
+	DenseColumnMatrix filterFactors(gamma.nrows());
+	for (size_t i = 0; i < gamma.nrows(); i++)
+		filterFactors[i] = gamma[i] / (gamma[i] * gamma[i] + lambda * lambda);
+
+	DenseMatrix solution = x0;
+	solution += basis * (filterFactors.asDiagonal() * beta);
+	return solution;
+}
+
+///// x(lambda) = (nullOperator + basis * diag(filter factors) * projection) * y
+bool SolveInverseProblemWithSpectralTikhonovImpl::computeRegularizedInverse( double lambda, DenseMatrix& inverse ) const
+{
+	DenseColumnMatrix filterFactors(gamma.nrows());
+	for (size_t i = 0; i < gamma.nrows(); i++)
+		filterFactors[i] = gamma[i] / (gamma[i] * gamma[i] + lambda * lambda);
+
+	inverse = basis * (filterFactors.asDiagonal() * projection);
+	if (nullOperator.nrows() > 0)
+		inverse += nullOperator;
+	return true;
+}
+
+/////////////////////////
+///////// L-curve in closed form
+//      With filter factors f_i = gamma_i^2 / (gamma_i^2 + lambda^2):
+//          rho^2 = sum (1 - f_i)^2 beta_i^2 + ||C*y outside the range of C*A||^2
+//          eta^2 = sum f_i^2 beta_i^2 / gamma_i^2
+//      and the curvature of (log rho, log eta) follows from their derivatives with respect to lambda
+//      (Hansen, Regularization Tools). beta_i^2 is summed over time samples, giving Frobenius norms.
+bool SolveInverseProblemWithSpectralTikhonovImpl::computeLcurve( const std::vector<double>& lambdaArray, std::vector<double>& rho, std::vector<double>& eta, std::vector<double>& kappa ) const
+{
+	const size_t nLambda = lambdaArray.size();
+	rho.assign(nLambda, 0.0);
+	eta.assign(nLambda, 0.0);
+	kappa.assign(nLambda, 0.0);
+
+	for (size_t j = 0; j < nLambda; j++)
+	{
+		const double lambda = lambdaArray[j];
+		const double lambda2 = lambda * lambda;
+		double rho2 = residual2, eta2 = 0;
+		double phi = 0, psi = 0, dphi = 0, dpsi = 0;
+
+		for (size_t i = 0; i < gamma.nrows(); i++)
+		{
+			const double gamma2 = gamma[i] * gamma[i];
+			const double f = gamma2 / (gamma2 + lambda2);
+			const double cf = lambda2 / (gamma2 + lambda2);
+			const double xi2 = beta2[i] / gamma2;
+
+			// derivatives of the filter factor with respect to lambda
+			const double f1 = -2.0 * f * cf / lambda;
+			const double f2 = -f1 * (3.0 - 4.0 * f) / lambda;
+
+			rho2 += cf * cf * beta2[i];
+			eta2 += f * f * xi2;
+			phi += f * f1 * xi2;
+			psi += cf * f1 * beta2[i];
+			dphi += (f1 * f1 + f * f2) * xi2;
+			dpsi += (-f1 * f1 + cf * f2) * beta2[i];
+		}
+
+		rho[j] = std::sqrt(rho2);
+		eta[j] = std::sqrt(eta2);
+
+		const double deta = phi / eta[j];
+		const double drho = -psi / rho[j];
+		const double ddeta = dphi / eta[j] - deta * deta / eta[j];
+		const double ddrho = -dpsi / rho[j] - drho * drho / rho[j];
+
+		const double dlogeta = deta / eta[j];
+		const double dlogrho = drho / rho[j];
+		const double ddlogeta = ddeta / eta[j] - dlogeta * dlogeta;
+		const double ddlogrho = ddrho / rho[j] - dlogrho * dlogrho;
+
+		const double k = (dlogrho * ddlogeta - ddlogrho * dlogeta) / std::pow(dlogrho * dlogrho + dlogeta * dlogeta, 1.5);
+		kappa[j] = std::isfinite(k) ? k : 0.0;
+	}
+
+	return true;
+}
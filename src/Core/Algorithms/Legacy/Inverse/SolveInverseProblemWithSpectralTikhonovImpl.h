@@ -0,0 +1,95 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+//    File       : SolveInverseProblemWithSpectralTikhonovImpl.h
+
+#ifndef BioPSE_SolveInverseProblemWithSpectralTikhonovImpl_H__
+#define BioPSE_SolveInverseProblemWithSpectralTikhonovImpl_H__
+
+#include <vector>
+#include <Core/Datatypes/MatrixFwd.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Algorithms/Legacy/Inverse/TikhonovImpl.h>
+#include <Core/Algorithms/Legacy/Inverse/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace Inverse {
+
+	// Tikhonov regularization through one spectral decomposition of the (weighted) forward matrix:
+	//
+	//      min  || C (A x - y) ||^2 + lambda^2 || R x ||^2
+	//
+	// Without a source weighting R this is the SVD of C*A; otherwise it is the generalized SVD of
+	// the pair (C*A, R), computed from the generalized eigenproblem R^T R w = theta (A^T C^T C A + R^T R) w.
+	// Both reduce the problem to filter factors gamma_i^2 / (gamma_i^2 + lambda^2) of the (generalized)
+	// singular values gamma_i, so the solution, the residual and solution norms and the curvature of
+	// the L-curve are evaluated in closed form: every lambda costs O(rank), independent of the number
+	// of time samples in the measured data.
+	//
+	// If rank > 0 and no source weighting is given, a randomized SVD truncated to that rank is used
+	// instead of the full decomposition.
+	class SCISHARE SolveInverseProblemWithSpectralTikhonovImpl : public TikhonovImpl
+	{
+	public:
+		SolveInverseProblemWithSpectralTikhonovImpl(const SCIRun::Core::Datatypes::DenseMatrix& forwardMatrix_, const SCIRun::Core::Datatypes::DenseMatrix& measuredData_,
+			const SCIRun::Core::Datatypes::DenseMatrixHandle& sourceWeighting_, const SCIRun::Core::Datatypes::DenseMatrixHandle& sensorWeighting_,
+			const int regularizationSolutionSubcase_, const int regularizationResidualSubcase_, const int rank_ = 0);
+
+		virtual SCIRun::Core::Datatypes::DenseMatrix computeInverseSolution( double lambda, bool inverseCalculation) const override;
+		virtual bool computeLcurve( const std::vector<double>& lambdaArray, std::vector<double>& rho, std::vector<double>& eta, std::vector<double>& kappa ) const override;
+		virtual bool computeRegularizedInverse( double lambda, SCIRun::Core::Datatypes::DenseMatrix& inverse ) const override;
+
+		// (generalized) singular values, in decreasing order
+		const SCIRun::Core::Datatypes::DenseColumnMatrix& singularValues() const { return gamma; }
+
+	private:
+		void decompose(const SCIRun::Core::Datatypes::DenseMatrix& CA, const SCIRun::Core::Datatypes::DenseMatrix& Cy);
+		void generalizedDecompose(const SCIRun::Core::Datatypes::DenseMatrix& CA, const SCIRun::Core::Datatypes::DenseMatrix& Cy, const SCIRun::Core::Datatypes::DenseMatrix& RtrR);
+		void randomizedDecompose(const SCIRun::Core::Datatypes::DenseMatrix& CA, const SCIRun::Core::Datatypes::DenseMatrix& Cy, int rank);
+
+		// x(lambda) = x0 + basis * diag( gamma / (gamma^2 + lambda^2) ) * beta
+		SCIRun::Core::Datatypes::DenseMatrix basis;
+		SCIRun::Core::Datatypes::DenseColumnMatrix gamma;
+		SCIRun::Core::Datatypes::DenseMatrix beta;
+		// unregularized part of the solution (null space of R)
+		SCIRun::Core::Datatypes::DenseMatrix x0;
+		// beta = projection * y and x0 = nullOperator * y; nullOperator is empty when x0 is zero
+		SCIRun::Core::Datatypes::DenseMatrix projection;
+		SCIRun::Core::Datatypes::DenseMatrix nullOperator;
+		// squared norms of the rows of beta, summed over time samples
+		SCIRun::Core::Datatypes::DenseColumnMatrix beta2;
+		// squared norm of the part of C*y outside the range of C*A
+		double residual2;
+	};
+
+}}}}
+
+#endif
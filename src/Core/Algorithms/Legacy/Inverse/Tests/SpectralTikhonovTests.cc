@@ -0,0 +1,221 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Algorithms/Legacy/Inverse/SolveInverseProblemWithSpectralTikhonovImpl.h>
+#include <Core/Algorithms/Legacy/Inverse/TikhonovAlgoAbstractBase.h>
+#include <cmath>
+
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::Inverse;
+
+namespace
+{
+  // Smoothing kernel with quickly decaying singular values, like a forward matrix
+  DenseMatrix forwardMatrix(int M, int N)
+  {
+    DenseMatrix A(M, N);
+    for (int i = 0; i < M; i++)
+      for (int j = 0; j < N; j++)
+      {
+        const double d = (i + 0.5) / M - (j + 0.5) / N;
+        A(i, j) = std::exp(-40.0 * d * d) / N;
+      }
+    return A;
+  }
+
+  DenseMatrix measurements(const DenseMatrix& A, int numTimeSamples)
+  {
+    DenseMatrix X(A.ncols(), numTimeSamples);
+    for (int i = 0; i < X.rows(); i++)
+      for (int t = 0; t < numTimeSamples; t++)
+        X(i, t) = std::sin(0.2 * i + 0.5 * t);
+    DenseMatrix Y = A * X;
+    for (int i = 0; i < Y.rows(); i++)
+      for (int t = 0; t < numTimeSamples; t++)
+        Y(i, t) += 1e-3 * std::cos(7.0 * i + 3.0 * t);
+    return Y;
+  }
+
+  // First difference operator, singular (constants are in its null space)
+  DenseMatrixHandle gradient(int N)
+  {
+    DenseMatrixHandle R(new DenseMatrix(DenseMatrix::Zero(N - 1, N)));
+    for (int i = 0; i < N - 1; i++)
+    {
+      (*R)(i, i) = -1.0;
+      (*R)(i, i + 1) = 1.0;
+    }
+    return R;
+  }
+
+  DenseMatrixHandle sensorWeighting(int M)
+  {
+    DenseMatrixHandle C(new DenseMatrix(DenseMatrix::Identity(M, M)));
+    for (int i = 0; i < M; i++)
+      (*C)(i, i) = 1.0 + 0.5 * std::sin(1.0 * i);
+    return C;
+  }
+
+  // Solution of the regularized normal equations
+  DenseMatrix directSolution(const DenseMatrix& A, const DenseMatrix& Y, const DenseMatrix& R, const DenseMatrix& C, double lambda)
+  {
+    const DenseMatrix CA = C * A;
+    const DenseMatrix G = CA.transpose() * CA + lambda * lambda * R.transpose() * R;
+    return G.ldlt().solve(CA.transpose() * (C * Y));
+  }
+}
+
+TEST(SpectralTikhonovTests, MatchesNormalEquationsWithoutWeighting)
+{
+  const DenseMatrix A = forwardMatrix(40, 60);
+  const DenseMatrix Y = measurements(A, 5);
+  SolveInverseProblemWithSpectralTikhonovImpl impl(A, Y, nullptr, nullptr,
+    TikhonovAlgoAbstractBase::solution_constrained, TikhonovAlgoAbstractBase::residual_constrained);
+
+  const DenseMatrix I60 = DenseMatrix::Identity(60, 60), I40 = DenseMatrix::Identity(40, 40);
+  for (double lambda : { 1e-4, 1e-3, 1e-2 })
+  {
+    const DenseMatrix expected = directSolution(A, Y, I60, I40, lambda);
+    const DenseMatrix x = impl.computeInverseSolution(lambda, false);
+    EXPECT_LT((x - expected).norm(), 1e-6 * expected.norm());
+  }
+}
+
+TEST(SpectralTikhonovTests, LcurveMatchesResidualAndSolutionNorms)
+{
+  const DenseMatrix A = forwardMatrix(30, 50);
+  const DenseMatrix Y = measurements(A, 8);
+  auto R = gradient(50);
+  auto C = sensorWeighting(30);
+  SolveInverseProblemWithSpectralTikhonovImpl impl(A, Y, R, C,
+    TikhonovAlgoAbstractBase::solution_constrained, TikhonovAlgoAbstractBase::residual_constrained);
+
+  const std::vector<double> lambdas = impl.computeLambdaArray(1e-5, 1e-1, 9);
+  std::vector<double> rho, eta, kappa;
+  ASSERT_TRUE(impl.computeLcurve(lambdas, rho, eta, kappa));
+  ASSERT_EQ(lambdas.size(), rho.size());
+  ASSERT_EQ(lambdas.size(), kappa.size());
+
+  for (size_t j = 0; j < lambdas.size(); j++)
+  {
+    const DenseMatrix expected = directSolution(A, Y, *R, *C, lambdas[j]);
+    const DenseMatrix x = impl.computeInverseSolution(lambdas[j], false);
+    EXPECT_LT((x - expected).norm(), 1e-6 * expected.norm());
+
+    // Frobenius norms over all time samples
+    EXPECT_NEAR((*C * (A * expected - Y)).norm(), rho[j], 1e-6 * rho[j]);
+    EXPECT_NEAR((*R * expected).norm(), eta[j], 1e-6 * eta[j]);
+  }
+}
+
+TEST(SpectralTikhonovTests, CurvatureMatchesFiniteDifferences)
+{
+  const DenseMatrix A = forwardMatrix(30, 30);
+  const DenseMatrix Y = measurements(A, 3);
+  SolveInverseProblemWithSpectralTikhonovImpl impl(A, Y, nullptr, nullptr,
+    TikhonovAlgoAbstractBase::solution_constrained, TikhonovAlgoAbstractBase::residual_constrained);
+
+  const double lambda = 3e-3, h = 1e-4 * lambda;
+  std::vector<double> rho, eta, kappa;
+  impl.computeLcurve({ lambda - h, lambda, lambda + h }, rho, eta, kappa);
+
+  const double dx = (std::log(rho[2]) - std::log(rho[0])) / (2 * h);
+  const double dy = (std::log(eta[2]) - std::log(eta[0])) / (2 * h);
+  const double ddx = (std::log(rho[2]) - 2 * std::log(rho[1]) + std::log(rho[0])) / (h * h);
+  const double ddy = (std::log(eta[2]) - 2 * std::log(eta[1]) + std::log(eta[0])) / (h * h);
+  const double expected = (dx * ddy - ddx * dy) / std::pow(dx * dx + dy * dy, 1.5);
+  EXPECT_NEAR(expected, kappa[1], 1e-3 * std::abs(expected));
+}
+
+TEST(SpectralTikhonovTests, RandomizedSVDMatchesFullForLowRankMatrix)
+{
+  // forward matrix of rank 6
+  DenseMatrix U(50, 6), V(80, 6);
+  for (int i = 0; i < 50; i++)
+    for (int k = 0; k < 6; k++)
+      U(i, k) = std::cos(0.3 * i * (k + 1));
+  for (int i = 0; i < 80; i++)
+    for (int k = 0; k < 6; k++)
+      V(i, k) = std::sin(0.1 * i * (k + 1) + k) / (k + 1);
+  const DenseMatrix A = U * V.transpose();
+  const DenseMatrix Y = measurements(A, 4);
+
+  SolveInverseProblemWithSpectralTikhonovImpl full(A, Y, nullptr, nullptr,
+    TikhonovAlgoAbstractBase::solution_constrained, TikhonovAlgoAbstractBase::residual_constrained);
+  SolveInverseProblemWithSpectralTikhonovImpl randomized(A, Y, nullptr, nullptr,
+    TikhonovAlgoAbstractBase::solution_constrained, TikhonovAlgoAbstractBase::residual_constrained, 8);
+
+  EXPECT_EQ(6, full.singularValues().nrows());
+  ASSERT_EQ(6, randomized.singularValues().nrows());
+  EXPECT_LT((full.singularValues() - randomized.singularValues()).norm(), 1e-10 * full.singularValues().norm());
+
+  const DenseMatrix x = full.computeInverseSolution(0.1, false);
+  EXPECT_LT((randomized.computeInverseSolution(0.1, false) - x).norm(), 1e-8 * x.norm());
+}
+
+TEST(SpectralTikhonovTests, SquaredWeightingsGiveSameSolution)
+{
+  const DenseMatrix A = forwardMatrix(25, 35);
+  const DenseMatrix Y = measurements(A, 2);
+  auto R = gradient(35);
+  auto C = sensorWeighting(25);
+  DenseMatrixHandle RtrR(new DenseMatrix(R->transpose() * *R));
+  DenseMatrixHandle CtrC(new DenseMatrix(C->transpose() * *C));
+
+  SolveInverseProblemWithSpectralTikhonovImpl plain(A, Y, R, C,
+    TikhonovAlgoAbstractBase::solution_constrained, TikhonovAlgoAbstractBase::residual_constrained);
+  SolveInverseProblemWithSpectralTikhonovImpl squared(A, Y, RtrR, CtrC,
+    TikhonovAlgoAbstractBase::solution_constrained_squared, TikhonovAlgoAbstractBase::residual_constrained_squared);
+
+  const DenseMatrix x = plain.computeInverseSolution(1e-3, false);
+  EXPECT_LT((squared.computeInverseSolution(1e-3, false) - x).norm(), 1e-6 * x.norm());
+}
+
+TEST(SpectralTikhonovTests, RegularizedInverseReproducesTheSolution)
+{
+  const DenseMatrix A = forwardMatrix(30, 50);
+  const DenseMatrix Y = measurements(A, 6);
+  auto R = gradient(50);
+  auto C = sensorWeighting(30);
+
+  SolveInverseProblemWithSpectralTikhonovImpl plain(A, Y, nullptr, C,
+    TikhonovAlgoAbstractBase::solution_constrained, TikhonovAlgoAbstractBase::residual_constrained);
+  SolveInverseProblemWithSpectralTikhonovImpl weighted(A, Y, R, C,
+    TikhonovAlgoAbstractBase::solution_constrained, TikhonovAlgoAbstractBase::residual_constrained);
+
+  for (const auto* impl : { &plain, &weighted })
+  {
+    DenseMatrix inverse;
+    ASSERT_TRUE(impl->computeRegularizedInverse(1e-3, inverse));
+    ASSERT_EQ(50, inverse.nrows());
+    ASSERT_EQ(30, inverse.ncols());
+    const DenseMatrix x = impl->computeInverseSolution(1e-3, false);
+    EXPECT_LT((inverse * Y - x).norm(), 1e-8 * x.norm());
+  }
+}
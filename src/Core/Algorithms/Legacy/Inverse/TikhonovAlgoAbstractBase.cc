@@ -29,6 +29,7 @@
 //    Author     : Jaume Coll-Font
 //    Date       : September 06th, 2017 (last update)
 
+#include <algorithm>
 #include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -38,6 +39,7 @@
 #include <Core/Algorithms/Legacy/Inverse/SolveInverseProblemWithStandardTikhonovImpl.h>
 #include <Core/Algorithms/Legacy/Inverse/SolveInverseProblemWithTikhonovSVD_impl.h>
 #include <Core/Algorithms/Legacy/Inverse/SolveInverseProblemWithTSVD_impl.h>
+#include <Core/Algorithms/Legacy/Inverse/SolveInverseProblemWithSpectralTikhonovImpl.h>
 
 // Datatypes
 #include <Core/Datatypes/Matrix.h>
@@ -89,6 +91,8 @@ ALGORITHM_PARAMETER_DEF( Inverse, LambdaMax);
 ALGORITHM_PARAMETER_DEF( Inverse, LambdaNum);
 ALGORITHM_PARAMETER_DEF( Inverse, LambdaResolution);
 ALGORITHM_PARAMETER_DEF( Inverse, LambdaSliderValue);
+ALGORITHM_PARAMETER_DEF( Inverse, UseSpectralDecomposition);
+ALGORITHM_PARAMETER_DEF( Inverse, SpectralRank);
 //ALGORITHM_PARAMETER_DEF( Inverse, LambdaCorner);
 //ALGORITHM_PARAMETER_DEF( Inverse, LCurveText);
 ALGORITHM_PARAMETER_DEF( Inverse, regularizationSolutionSubcase);
@@ -105,6 +109,8 @@ TikhonovAlgoAbstractBase::TikhonovAlgoAbstractBase()
 	addParameter(Parameters::LambdaNum,200);
 	addParameter(Parameters::LambdaResolution,1e-6);
 	addParameter(Parameters::LambdaSliderValue,0);
+	addParameter(Parameters::UseSpectralDecomposition,false);
+	addParameter(Parameters::SpectralRank,0);
 	addParameter(Parameters::regularizationSolutionSubcase,solution_constrained);
 	addParameter(Parameters::regularizationResidualSubcase,residual_constrained);
 }
@@ -198,8 +204,13 @@ AlgorithmOutput TikhonovAlgoAbstractBase::run(const AlgorithmInput & input) cons
 		int regularizationSolutionSubcase = get(Parameters::regularizationSolutionSubcase).toInt();
 		int regularizationResidualSubcase = get(Parameters::regularizationResidualSubcase).toInt();
 
-		algoImpl = std::make_shared<SolveInverseProblemWithStandardTikhonovImpl>( *forwardMatrix, *measuredData, *sourceWeighting, *sensorWeighting,
-      regularizationChoice, regularizationSolutionSubcase, regularizationResidualSubcase);
+		// one (generalized) SVD shared by all lambdas, instead of a factorization per lambda
+		if (get(Parameters::UseSpectralDecomposition).toBool())
+			algoImpl = std::make_shared<SolveInverseProblemWithSpectralTikhonovImpl>( *forwardMatrix, *measuredData, sourceWeighting, sensorWeighting,
+				regularizationSolutionSubcase, regularizationResidualSubcase, get(Parameters::SpectralRank).toInt());
+		else
+			algoImpl = std::make_shared<SolveInverseProblemWithStandardTikhonovImpl>( *forwardMatrix, *measuredData, *sourceWeighting, *sensorWeighting,
+				regularizationChoice, regularizationSolutionSubcase, regularizationResidualSubcase);
 	}
 	else if (implOption == "TikhonovSVD")
   {
@@ -270,6 +281,10 @@ AlgorithmOutput TikhonovAlgoAbstractBase::run(const AlgorithmInput & input) cons
   output[LambdaArray] = lambdamatrix;
   output[Lambda_Index]= boost::make_shared<DenseMatrix>(1, 1, lambda_index);
 
+  DenseMatrix regInverse;
+  if (algoImpl->computeRegularizedInverse(lambda, regInverse))
+    output[RegInverse] = boost::make_shared<DenseMatrix>(regInverse);
+
 	return output;
 }
 
@@ -299,6 +314,25 @@ double TikhonovAlgoAbstractBase::computeLcurve( const SCIRun::Core::Algorithms::
 
   lambdaArray[0] = lambdaMin;
 
+  // closed form evaluation of the whole L-curve, if the implementation supports it
+  std::vector<double> kappa;
+  if (algoImpl.computeLcurve( lambdaArray, rho, eta, kappa ))
+  {
+    for (int j = 0; j < nLambda; j++)
+    {
+      lambdamatrix->put(j,0,lambdaArray[j]);
+      lambdamatrix->put(j,1,rho[j]);
+      lambdamatrix->put(j,2,eta[j]);
+    }
+
+    // corner at the maximal curvature
+    lambda_index = static_cast<int>(std::max_element(kappa.begin(), kappa.end()) - kappa.begin());
+    lambda = lambdaArray[lambda_index];
+
+    LOG_DEBUG("Lambda: {}", lambda);
+    return lambda;
+  }
+
   // for all lambdas
   for (int j = 0; j < nLambda; j++)
   {
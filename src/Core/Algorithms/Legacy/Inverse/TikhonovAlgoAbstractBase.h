@@ -53,6 +53,8 @@ namespace Inverse {
 	ALGORITHM_PARAMETER_DECL(LambdaNum);
 	ALGORITHM_PARAMETER_DECL(LambdaResolution);
 	ALGORITHM_PARAMETER_DECL(LambdaSliderValue);
+	ALGORITHM_PARAMETER_DECL(UseSpectralDecomposition);
+	ALGORITHM_PARAMETER_DECL(SpectralRank);
 	//ALGORITHM_PARAMETER_DECL(LambdaCorner);
 	//ALGORITHM_PARAMETER_DECL(LCurveText);
 
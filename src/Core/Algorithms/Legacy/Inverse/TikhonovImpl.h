@@ -56,6 +56,15 @@ namespace Inverse {
 		// default lambda step. Can ve overriden if necessary (see TSVD as reference)
 		virtual std::vector<double> computeLambdaArray( double lambdaMin, double lambdaMax, int nLambda ) const;
 
+		// residual norm (rho), solution norm (eta) and L-curve curvature (kappa) for all lambdas at once.
+		// Returns false when the implementation has no closed form, in which case the L-curve is
+		// evaluated by solving the inverse problem for every lambda (see TikhonovAlgoAbstractBase)
+		virtual bool computeLcurve( const std::vector<double>& lambdaArray, std::vector<double>& rho, std::vector<double>& eta, std::vector<double>& kappa ) const { return false; }
+
+		// matrix mapping the measured data to the inverse solution for this lambda (RegInverse output).
+		// Returns false when the implementation does not form it
+		virtual bool computeRegularizedInverse( double lambda, SCIRun::Core::Datatypes::DenseMatrix& inverse ) const { return false; }
+
 	};
 
 	}}}}
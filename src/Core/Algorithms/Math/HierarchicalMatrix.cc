@@ -0,0 +1,364 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Math/HierarchicalMatrix.h>
+#include <Core/Thread/Parallel.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
+
+namespace
+{
+  double distance(const BBox& a, const BBox& b)
+  {
+    double d2 = 0.0;
+    for (int k = 0; k < 3; k++)
+    {
+      const double gap = std::max(std::max(b.get_min()[k] - a.get_max()[k], a.get_min()[k] - b.get_max()[k]), 0.0);
+      d2 += gap * gap;
+    }
+    return std::sqrt(d2);
+  }
+}
+
+HierarchicalMatrix::HierarchicalMatrix(const std::vector<BBox>& rowSupport,
+  const std::vector<BBox>& columnSupport, BlockFunction entries, const Parameters& parameters)
+  : entries_(entries), parameters_(parameters)
+{
+  parameters_.leafSize = std::max<size_t>(parameters_.leafSize, 1);
+  buildClusters(rowSupport, parameters_.leafSize, rowPerm_, rowClusters_);
+  buildClusters(columnSupport, parameters_.leafSize, colPerm_, colClusters_);
+  if (rowClusters_.empty() || colClusters_.empty())
+    return;
+
+  buildBlocks(0, 0);
+  Parallel::For(0, blocks_.size(), 1, [this](size_t begin, size_t end)
+  {
+    for (size_t k = begin; k < end; k++)
+      assemble(blocks_[k]);
+  });
+}
+
+void HierarchicalMatrix::buildClusters(const std::vector<BBox>& support, size_t leafSize,
+  std::vector<index_type>& perm, std::vector<Cluster>& clusters)
+{
+  perm.resize(support.size());
+  for (size_t k = 0; k < perm.size(); k++)
+    perm[k] = static_cast<index_type>(k);
+  clusters.clear();
+  if (!perm.empty())
+    buildCluster(support, leafSize, perm, clusters, 0, perm.size());
+}
+
+int HierarchicalMatrix::buildCluster(const std::vector<BBox>& support, size_t leafSize,
+  std::vector<index_type>& perm, std::vector<Cluster>& clusters, size_t begin, size_t end)
+{
+  const int index = static_cast<int>(clusters.size());
+  clusters.push_back(Cluster());
+  BBox box, centers;
+  for (size_t k = begin; k < end; k++)
+  {
+    box.extend(support[perm[k]]);
+    centers.extend(support[perm[k]].center());
+  }
+  clusters[index].begin = begin;
+  clusters[index].end = end;
+  clusters[index].box = box;
+  clusters[index].child[0] = clusters[index].child[1] = -1;
+  if (end - begin <= leafSize)
+    return index;
+
+  // Split at the median along the axis in which the centers are spread the most
+  const Vector extent = centers.diagonal();
+  const int axis = (extent.x() >= extent.y() && extent.x() >= extent.z()) ? 0 : (extent.y() >= extent.z() ? 1 : 2);
+  const size_t mid = begin + (end - begin) / 2;
+  std::nth_element(perm.begin() + begin, perm.begin() + mid, perm.begin() + end,
+    [&support, axis](index_type a, index_type b) { return support[a].center()[axis] < support[b].center()[axis]; });
+
+  const int left = buildCluster(support, leafSize, perm, clusters, begin, mid);
+  const int right = buildCluster(support, leafSize, perm, clusters, mid, end);
+  clusters[index].child[0] = left;
+  clusters[index].child[1] = right;
+  return index;
+}
+
+bool HierarchicalMatrix::admissible(const Cluster& row, const Cluster& col) const
+{
+  const double dist = distance(row.box, col.box);
+  const double diameter = std::min(row.box.diagonal().length(), col.box.diagonal().length());
+  return dist > 0.0 && diameter <= parameters_.eta * dist;
+}
+
+void HierarchicalMatrix::buildBlocks(int row, int col)
+{
+  const Cluster& R = rowClusters_[row];
+  const Cluster& C = colClusters_[col];
+  const bool rowLeaf = R.child[0] < 0;
+  const bool colLeaf = C.child[0] < 0;
+  const bool farField = admissible(R, C);
+
+  if (farField || (rowLeaf && colLeaf))
+  {
+    Block b;
+    b.rowBegin = R.begin; b.rowEnd = R.end;
+    b.colBegin = C.begin; b.colEnd = C.end;
+    b.lowRank = farField;
+    blocks_.push_back(b);
+  }
+  else if (rowLeaf)
+  {
+    buildBlocks(row, C.child[0]);
+    buildBlocks(row, C.child[1]);
+  }
+  else if (colLeaf)
+  {
+    buildBlocks(R.child[0], col);
+    buildBlocks(R.child[1], col);
+  }
+  else
+  {
+    for (int i = 0; i < 2; i++)
+      for (int j = 0; j < 2; j++)
+        buildBlocks(R.child[i], C.child[j]);
+  }
+}
+
+void HierarchicalMatrix::assemble(Block& block) const
+{
+  std::vector<index_type> rows(rowPerm_.begin() + block.rowBegin, rowPerm_.begin() + block.rowEnd);
+  std::vector<index_type> cols(colPerm_.begin() + block.colBegin, colPerm_.begin() + block.colEnd);
+
+  if (block.lowRank && crossApproximation(block, rows, cols))
+    return;
+
+  // Blocks that are not admissible, or whose rank turns out too high to pay off
+  block.lowRank = false;
+  block.U.resize(0, 0);
+  block.V.resize(0, 0);
+  block.D.setZero(rows.size(), cols.size());
+  entries_(rows, cols, block.D);
+}
+
+bool HierarchicalMatrix::crossApproximation(Block& block, const std::vector<index_type>& rows,
+  const std::vector<index_type>& cols) const
+{
+  // Adaptive cross approximation with partial pivoting: pick a row, take the largest
+  // remaining entry of it as pivot, add the cross through the pivot, and continue with
+  // the row where the new column is largest. Stops once the last cross is small
+  // compared to the estimated norm of the whole approximation.
+  const size_t m = rows.size(), n = cols.size();
+  // Beyond this rank the factors take more memory than the dense block
+  const size_t maxRank = m * n / (m + n);
+  if (maxRank == 0)
+    return false;
+
+  std::vector<Eigen::VectorXd> us, vs;
+  std::vector<char> usedRow(m, 0);
+  std::vector<index_type> single(1);
+  DenseMatrix rowEntries(1, n), colEntries(m, 1);
+  double norm2 = 0.0;
+  size_t i = 0;
+  bool converged = false;
+
+  while (us.size() < maxRank)
+  {
+    usedRow[i] = 1;
+    single[0] = rows[i];
+    rowEntries.setZero();
+    entries_(single, cols, rowEntries);
+    Eigen::VectorXd v = rowEntries.row(0).transpose();
+    for (size_t l = 0; l < us.size(); l++)
+      v -= us[l](i) * vs[l];
+
+    Eigen::Index j;
+    const double pivot = v.cwiseAbs().maxCoeff(&j);
+    if (pivot == 0.0)
+    {
+      // This row is reproduced exactly already, try one that is not
+      const auto next = std::find(usedRow.begin(), usedRow.end(), 0);
+      if (next == usedRow.end())
+      {
+        converged = true;
+        break;
+      }
+      i = next - usedRow.begin();
+      continue;
+    }
+    v /= v(j);
+
+    single[0] = cols[j];
+    colEntries.setZero();
+    entries_(rows, single, colEntries);
+    Eigen::VectorXd u = colEntries.col(0);
+    for (size_t l = 0; l < us.size(); l++)
+      u -= vs[l](j) * us[l];
+
+    const double uu = u.squaredNorm(), vv = v.squaredNorm();
+    double cross = 0.0;
+    for (size_t l = 0; l < us.size(); l++)
+      cross += u.dot(us[l]) * v.dot(vs[l]);
+    norm2 += uu * vv + 2.0 * cross;
+    us.push_back(u);
+    vs.push_back(v);
+
+    if (std::sqrt(uu * vv) <= parameters_.tolerance * std::sqrt(std::fabs(norm2)))
+    {
+      converged = true;
+      break;
+    }
+
+    double best = -1.0;
+    for (size_t k = 0; k < m; k++)
+    {
+      if (!usedRow[k] && std::fabs(u(k)) > best)
+      {
+        best = std::fabs(u(k));
+        i = k;
+      }
+    }
+    if (best < 0.0)
+    {
+      converged = true;
+      break;
+    }
+  }
+
+  if (!converged)
+    return false;
+
+  block.U.resize(m, us.size());
+  block.V.resize(n, vs.size());
+  for (size_t l = 0; l < us.size(); l++)
+  {
+    block.U.col(l) = us[l];
+    block.V.col(l) = vs[l];
+  }
+  return true;
+}
+
+void HierarchicalMatrix::apply(const DenseMatrix& Xp, DenseMatrix& Yp, bool transpose) const
+{
+  const size_t p = Xp.cols();
+  const size_t threads = Parallel::NumCores();
+
+  auto applyBlock = [&Xp, transpose](const Block& b, DenseMatrix& Y, size_t first, size_t count)
+  {
+    const size_t m = b.rowEnd - b.rowBegin, n = b.colEnd - b.colBegin;
+    if (transpose)
+    {
+      const auto x = Xp.block(b.rowBegin, first, m, count);
+      auto y = Y.block(b.colBegin, first, n, count);
+      if (b.lowRank)
+        y.noalias() += b.V * (b.U.transpose() * x);
+      else
+        y.noalias() += b.D.transpose() * x;
+      return;
+    }
+    const auto x = Xp.block(b.colBegin, first, n, count);
+    auto y = Y.block(b.rowBegin, first, m, count);
+    if (b.lowRank)
+      y.noalias() += b.U * (b.V.transpose() * x);
+    else
+      y.noalias() += b.D * x;
+  };
+
+  if (p >= 2 * threads)
+  {
+    // Enough right hand sides to give every thread its own columns
+    Parallel::For(0, p, std::max<size_t>(1, p / (4 * threads)), [&](size_t begin, size_t end)
+    {
+      for (const auto& b : blocks_)
+        applyBlock(b, Yp, begin, end - begin);
+    });
+    return;
+  }
+
+  // Few right hand sides: split the blocks over the threads, each summing into its
+  // own copy of the result
+  std::vector<DenseMatrix> partial(threads);
+  Parallel::RunTasks([&](int t)
+  {
+    partial[t].setZero(Yp.rows(), p);
+    for (size_t k = t; k < blocks_.size(); k += threads)
+      applyBlock(blocks_[k], partial[t], 0, p);
+  }, static_cast<int>(threads));
+  for (const auto& y : partial)
+    Yp += y;
+}
+
+void HierarchicalMatrix::multiply(const double* x, double* y) const
+{
+  DenseMatrix Xp(cols(), 1), Yp = DenseMatrix::Zero(rows(), 1);
+  for (size_t k = 0; k < cols(); k++)
+    Xp(k, 0) = x[colPerm_[k]];
+  apply(Xp, Yp, false);
+  for (size_t k = 0; k < rows(); k++)
+    y[rowPerm_[k]] = Yp(k, 0);
+}
+
+DenseMatrix HierarchicalMatrix::multiply(const DenseMatrix& X) const
+{
+  DenseMatrix Xp(cols(), X.cols()), Yp = DenseMatrix::Zero(rows(), X.cols());
+  for (size_t k = 0; k < cols(); k++)
+    Xp.row(k) = X.row(colPerm_[k]);
+  apply(Xp, Yp, false);
+  DenseMatrix Y(rows(), X.cols());
+  for (size_t k = 0; k < rows(); k++)
+    Y.row(rowPerm_[k]) = Yp.row(k);
+  return Y;
+}
+
+DenseMatrix HierarchicalMatrix::transposeMultiply(const DenseMatrix& X) const
+{
+  DenseMatrix Xp(rows(), X.cols()), Yp = DenseMatrix::Zero(cols(), X.cols());
+  for (size_t k = 0; k < rows(); k++)
+    Xp.row(k) = X.row(rowPerm_[k]);
+  apply(Xp, Yp, true);
+  DenseMatrix Y(cols(), X.cols());
+  for (size_t k = 0; k < cols(); k++)
+    Y.row(colPerm_[k]) = Yp.row(k);
+  return Y;
+}
+
+size_t HierarchicalMatrix::storedEntries() const
+{
+  size_t stored = 0;
+  for (const auto& b : blocks_)
+    stored += b.lowRank ? static_cast<size_t>(b.U.size() + b.V.size()) : static_cast<size_t>(b.D.size());
+  return stored;
+}
+
+size_t HierarchicalMatrix::numLowRankBlocks() const
+{
+  return std::count_if(blocks_.begin(), blocks_.end(), [](const Block& b) { return b.lowRank; });
+}
@@ -0,0 +1,143 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_ALGORITHMS_MATH_HIERARCHICALMATRIX_H
+#define CORE_ALGORITHMS_MATH_HIERARCHICALMATRIX_H
+
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/GeometryPrimitives/BBox.h>
+#include <Core/Algorithms/Math/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace Math {
+
+  // Hierarchical (H-) matrix approximation of a dense matrix whose entries come from a
+  // smooth kernel between two point sets, such as the node by triangle matrices of a
+  // boundary element method.
+  //
+  // Rows and columns are each clustered with a bounding box tree over the region that
+  // supports them. Pairs of clusters that are far apart compared to their size
+  // (admissible blocks) are compressed with adaptive cross approximation, which only
+  // evaluates a few of their rows and columns and stores the block as U*V^T. All other
+  // leaf blocks are kept dense. Blocks are assembled in parallel.
+  class SCISHARE HierarchicalMatrix : boost::noncopyable
+  {
+  public:
+    // Fills block(r, c) with the entry at row rows[r] and column cols[c] of the matrix
+    typedef boost::function<void(const std::vector<index_type>& rows,
+      const std::vector<index_type>& cols, Datatypes::DenseMatrix& block)> BlockFunction;
+
+    struct Parameters
+    {
+      Parameters() : leafSize(32), eta(2.0), tolerance(1e-6) {}
+      // Largest cluster that is not split further
+      size_t leafSize;
+      // A block is admissible when min(diameters) <= eta * distance between the clusters
+      double eta;
+      // Relative accuracy of the low rank blocks, in the Frobenius norm
+      double tolerance;
+    };
+
+    HierarchicalMatrix(const std::vector<Geometry::BBox>& rowSupport,
+      const std::vector<Geometry::BBox>& columnSupport,
+      BlockFunction entries, const Parameters& parameters = Parameters());
+
+    size_t rows() const { return rowPerm_.size(); }
+    size_t cols() const { return colPerm_.size(); }
+
+    // y = A*x
+    void multiply(const double* x, double* y) const;
+    // A*X
+    Datatypes::DenseMatrix multiply(const Datatypes::DenseMatrix& X) const;
+    // A^T*X, so X*A can be formed as transposeMultiply(X^T)^T
+    Datatypes::DenseMatrix transposeMultiply(const Datatypes::DenseMatrix& X) const;
+
+    // A += scale * this, for any matrix type that can be indexed with (row, column)
+    template <class MatrixType>
+    void addTo(MatrixType& A, double scale = 1.0) const
+    {
+      for (const auto& b : blocks_)
+      {
+        const Datatypes::DenseMatrix block = b.lowRank ? Datatypes::DenseMatrix(b.U * b.V.transpose()) : b.D;
+        for (size_t c = 0; c < b.colEnd - b.colBegin; c++)
+          for (size_t r = 0; r < b.rowEnd - b.rowBegin; r++)
+            A(rowPerm_[b.rowBegin + r], colPerm_[b.colBegin + c]) += scale * block(r, c);
+      }
+    }
+
+    // Number of values stored, rows()*cols() for a dense matrix
+    size_t storedEntries() const;
+    size_t numBlocks() const { return blocks_.size(); }
+    size_t numLowRankBlocks() const;
+
+  private:
+    struct Cluster
+    {
+      size_t begin, end;
+      Geometry::BBox box;
+      int child[2];
+    };
+
+    struct Block
+    {
+      size_t rowBegin, rowEnd, colBegin, colEnd;
+      bool lowRank;
+      Datatypes::DenseMatrix U, V, D;
+    };
+
+    static void buildClusters(const std::vector<Geometry::BBox>& support, size_t leafSize,
+      std::vector<index_type>& perm, std::vector<Cluster>& clusters);
+    static int buildCluster(const std::vector<Geometry::BBox>& support, size_t leafSize,
+      std::vector<index_type>& perm, std::vector<Cluster>& clusters, size_t begin, size_t end);
+    void buildBlocks(int row, int col);
+    bool admissible(const Cluster& row, const Cluster& col) const;
+    void assemble(Block& block) const;
+    bool crossApproximation(Block& block, const std::vector<index_type>& rows,
+      const std::vector<index_type>& cols) const;
+    // Yp += A*Xp (or A^T*Xp), with rows and columns in cluster order
+    void apply(const Datatypes::DenseMatrix& Xp, Datatypes::DenseMatrix& Yp, bool transpose) const;
+
+    BlockFunction entries_;
+    Parameters parameters_;
+    std::vector<index_type> rowPerm_, colPerm_;
+    std::vector<Cluster> rowClusters_, colClusters_;
+    std::vector<Block> blocks_;
+  };
+
+  typedef boost::shared_ptr<HierarchicalMatrix> HierarchicalMatrixHandle;
+
+}}}}
+
+#endif
@@ -0,0 +1,855 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+
+ The MIT License
+
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <Eigen/Dense>
+#include <Core/Algorithms/Math/LinearSystem/Preconditioners.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun;
+
+namespace
+{
+  // Compressed row view shared by the input matrix and the AMG coarse levels
+  struct CsrView
+  {
+    size_t n;
+    const index_type* rows;
+    const index_type* columns;
+    const double* data;
+  };
+
+  CsrView view(const ParallelLinearAlgebra::ParallelMatrix& A)
+  {
+    CsrView v = { A.m_, A.rows_, A.columns_, A.data_ };
+    return v;
+  }
+
+  CsrView view(const SparseRowMatrix& A)
+  {
+    CsrView v = { static_cast<size_t>(A.rows()), A.outerIndexPtr(), A.innerIndexPtr(), A.valuePtr() };
+    return v;
+  }
+
+  // FNV-1a style hash over the sparsity pattern and the values. Eigen lets callers
+  // write to the storage (coeffRef, valuePtr, iterators) without going through
+  // SparseRowMatrix, so the generation alone does not tell whether A changed.
+  uint64_t contentsHash(const CsrView& A, size_t nnz)
+  {
+    const uint64_t prime = 0x100000001b3ULL;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    auto mix = [&h, prime](uint64_t word) { h = (h ^ word) * prime; };
+    mix(A.n);
+    mix(nnz);
+    for (size_t i = 0; i <= A.n; ++i)
+      mix(static_cast<uint64_t>(A.rows[i]));
+    for (size_t j = 0; j < nnz; ++j)
+    {
+      uint64_t bits;
+      std::memcpy(&bits, &A.data[j], sizeof(bits));
+      mix(static_cast<uint64_t>(A.columns[j]));
+      mix(bits);
+    }
+    return h;
+  }
+
+  double diagonalEntry(const CsrView& A, size_t i)
+  {
+    for (auto j = A.rows[i]; j < A.rows[i + 1]; ++j)
+      if (A.columns[j] == static_cast<index_type>(i))
+        return A.data[j];
+    return 0.0;
+  }
+
+  // Rows of an n-row vector handled by thread proc on the coarse AMG levels
+  size_t rangeBegin(size_t n, int proc, int nproc) { return n * proc / nproc; }
+}
+
+LinearSystemPreconditioner::LinearSystemPreconditioner() :
+  matrix_(), id_(-1), generation_(0), hash_(0), nproc_(0), rebuild_(true), numBuilds_(0)
+{
+}
+
+LinearSystemPreconditioner::~LinearSystemPreconditioner()
+{
+}
+
+void LinearSystemPreconditioner::setup(ParallelLinearAlgebra& PLA, const ParallelMatrix& A)
+{
+  PLA.wait();
+  if (PLA.first())
+  {
+    const uint64_t hash = reusable() ? contentsHash(view(A), A.nnz_) : 0;
+    rebuild_ = !reusable() || numBuilds_ == 0 || A.id_ != id_ || A.generation_ != generation_ || hash != hash_ || PLA.nproc() != nproc_;
+    id_ = A.id_;
+    generation_ = A.generation_;
+    hash_ = hash;
+    nproc_ = PLA.nproc();
+    matrix_ = A;
+    if (rebuild_)
+      ++numBuilds_;
+  }
+  PLA.wait();
+
+  if (rebuild_)
+    build(PLA, A);
+  PLA.wait();
+}
+
+void LinearSystemPreconditioner::applyTranspose(ParallelLinearAlgebra& PLA, const ParallelVector& r, ParallelVector& z) const
+{
+  apply(PLA, r, z);
+}
+
+void LinearSystemPreconditioner::applyDot(ParallelLinearAlgebra& PLA, const ParallelVector& r, ParallelVector& z, double& rr, double& rz) const
+{
+  apply(PLA, r, z);
+  PLA.dot2(r, r, r, z, rr, rz);
+}
+
+namespace
+{
+  class NoPreconditioner : public LinearSystemPreconditioner
+  {
+  public:
+    virtual void apply(ParallelLinearAlgebra& PLA, const ParallelVector& r, ParallelVector& z) const override
+    {
+      if (r.data_ != z.data_)
+        PLA.copy(r, z);
+    }
+    virtual void applyDot(ParallelLinearAlgebra& PLA, const ParallelVector& r, ParallelVector& z, double& rr, double& rz) const override
+    {
+      double dots[2] = { 0.0, 0.0 };
+      for (size_t i = PLA.start(); i < PLA.end(); i++)
+      {
+        z.data_[i] = r.data_[i];
+        dots[0] += r.data_[i] * r.data_[i];
+      }
+      dots[1] = dots[0];
+      PLA.reduce_sum(dots, 2);
+      rr = dots[0];
+      rz = dots[1];
+    }
+  protected:
+    virtual void build(ParallelLinearAlgebra&, const ParallelMatrix&) override {}
+    virtual bool reusable() const override { return false; }
+  };
+
+  class JacobiPreconditioner : public LinearSystemPreconditioner
+  {
+  public:
+    virtual void apply(ParallelLinearAlgebra& PLA, const ParallelVector& r, ParallelVector& z) const override
+    {
+      PLA.mult(r, diag_, z);
+    }
+    virtual void applyDot(ParallelLinearAlgebra& PLA, const ParallelVector& r, ParallelVector& z, double& rr, double& rz) const override
+    {
+      double dots[2] = { 0.0, 0.0 };
+      for (size_t i = PLA.start(); i < PLA.end(); i++)
+      {
+        const double ri = r.data_[i];
+        z.data_[i] = diag_.data_[i] * ri;
+        dots[0] += ri * ri;
+        dots[1] += ri * z.data_[i];
+      }
+      PLA.reduce_sum(dots, 2);
+      rr = dots[0];
+      rz = dots[1];
+    }
+  protected:
+    virtual void build(ParallelLinearAlgebra& PLA, const ParallelMatrix& A) override
+    {
+      if (PLA.first())
+        storage_.resize(A.m_);
+      PLA.wait();
+      diag_.data_ = &storage_[0];
+      diag_.size_ = storage_.size();
+
+      PLA.absdiag(A, diag_);
+      double max = PLA.max(diag_);
+      PLA.absthreshold_invert(diag_, diag_, 1e-18*max);
+    }
+  private:
+    std::vector<double> storage_;
+    ParallelVector diag_;
+  };
+
+  // Symmetric Gauss-Seidel, M = (D+L) D^-1 (D+U), applied to the diagonal block of
+  // the rows owned by each thread so that the sweeps need no synchronization.
+  class SymmetricGaussSeidelPreconditioner : public LinearSystemPreconditioner
+  {
+  public:
+    virtual void apply(ParallelLinearAlgebra& PLA, const ParallelVector& r, ParallelVector& z) const override
+    {
+      const auto A = view(matrix());
+      const auto s = static_cast<index_type>(PLA.start());
+      const auto e = static_cast<index_type>(PLA.end());
+      const double* rdata = r.data_;
+      double* zdata = z.data_;
+
+      for (index_type i = s; i < e; i++)
+      {
+        double sum = rdata[i];
+        for (auto j = A.rows[i]; j < A.rows[i + 1]; j++)
+        {
+          const auto c = A.columns[j];
+          if (c >= s && c < i) sum -= A.data[j] * zdata[c];
+        }
+        zdata[i] = sum*invDiag_[i];
+      }
+
+      for (index_type i = e - 1; i >= s; i--)
+      {
+        double sum = 0.0;
+        for (auto j = A.rows[i]; j < A.rows[i + 1]; j++)
+        {
+          const auto c = A.columns[j];
+          if (c > i && c < e) sum += A.data[j] * zdata[c];
+        }
+        zdata[i] -= sum*invDiag_[i];
+      }
+    }
+
+    virtual void applyTranspose(ParallelLinearAlgebra& PLA, const ParallelVector& r, ParallelVector& z) const override
+    {
+      const auto A = view(matrix());
+      const auto s = static_cast<index_type>(PLA.start());
+      const auto e = static_cast<index_type>(PLA.end());
+      double* zdata = z.data_;
+      if (r.data_ != z.data_)
+        PLA.copy(r, z);
+
+      // (D+U^T) y = r, column oriented
+      for (index_type i = s; i < e; i++)
+      {
+        zdata[i] *= invDiag_[i];
+        for (auto j = A.rows[i]; j < A.rows[i + 1]; j++)
+        {
+          const auto c = A.columns[j];
+          if (c > i && c < e) zdata[c] -= A.data[j] * zdata[i];
+        }
+      }
+      // (D+L^T) z = D y, column oriented
+      for (index_type i = e - 1; i >= s; i--)
+      {
+        for (auto j = A.rows[i]; j < A.rows[i + 1]; j++)
+        {
+          const auto c = A.columns[j];
+          if (c >= s && c < i) zdata[c] -= invDiag_[c] * A.data[j] * zdata[i];
+        }
+      }
+    }
+
+  protected:
+    virtual void build(ParallelLinearAlgebra& PLA, const ParallelMatrix& A) override
+    {
+      if (PLA.first())
+        invDiag_.resize(A.m_);
+      PLA.wait();
+      const auto M = view(A);
+      for (size_t i = PLA.start(); i < PLA.end(); i++)
+      {
+        const double d = diagonalEntry(M, i);
+        invDiag_[i] = d != 0.0 ? 1.0/d : 1.0;
+      }
+    }
+  private:
+    std::vector<double> invDiag_;
+  };
+
+  // Incomplete LU factorization without fill-in of the diagonal block owned by
+  // each thread (block Jacobi with ILU(0) blocks). For a symmetric matrix the
+  // factors satisfy U = D L^T, so this is IC(0) and can be used with CG and MINRES.
+  class ILU0Preconditioner : public LinearSystemPreconditioner
+  {
+  public:
+    virtual void apply(ParallelLinearAlgebra& PLA, const ParallelVector& r, ParallelVector& z) const override
+    {
+      const auto& f = factors_[PLA.proc()];
+      const double* rdata = r.data_ + PLA.start();
+      double* zdata = z.data_ + PLA.start();
+      const auto n = static_cast<index_type>(f.diag.size());
+
+      for (index_type i = 0; i < n; i++)
+      {
+        double sum = rdata[i];
+        for (auto p = f.rows[i]; p < f.diag[i]; p++)
+          sum -= f.data[p] * zdata[f.columns[p]];
+        zdata[i] = sum;
+      }
+      for (index_type i = n - 1; i >= 0; i--)
+      {
+        double sum = zdata[i];
+        for (auto p = f.diag[i] + 1; p < f.rows[i + 1]; p++)
+          sum -= f.data[p] * zdata[f.columns[p]];
+        zdata[i] = sum / f.data[f.diag[i]];
+      }
+    }
+
+    virtual void applyTranspose(ParallelLinearAlgebra& PLA, const ParallelVector& r, ParallelVector& z) const override
+    {
+      const auto& f = factors_[PLA.proc()];
+      if (r.data_ != z.data_)
+        PLA.copy(r, z);
+      double* zdata = z.data_ + PLA.start();
+      const auto n = static_cast<index_type>(f.diag.size());
+
+      // U^T y = r, column oriented
+      for (index_type i = 0; i < n; i++)
+      {
+        zdata[i] /= f.data[f.diag[i]];
+        for (auto p = f.diag[i] + 1; p < f.rows[i + 1]; p++)
+          zdata[f.columns[p]] -= f.data[p] * zdata[i];
+      }
+      // L^T z = y, column oriented
+      for (index_type i = n - 1; i >= 0; i--)
+      {
+        for (auto p = f.rows[i]; p < f.diag[i]; p++)
+          zdata[f.columns[p]] -= f.data[p] * zdata[i];
+      }
+    }
+
+  protected:
+    virtual void build(ParallelLinearAlgebra& PLA, const ParallelMatrix& A) override
+    {
+      if (PLA.first())
+        factors_.resize(PLA.nproc());
+      PLA.wait();
+
+      auto& f = factors_[PLA.proc()];
+      const auto s = static_cast<index_type>(PLA.start());
+      const auto e = static_cast<index_type>(PLA.end());
+      const auto n = e - s;
+
+      // Copy the diagonal block, making sure every row has a diagonal entry
+      f.rows.assign(1, 0);
+      f.columns.clear();
+      f.data.clear();
+      f.diag.resize(n);
+      for (index_type i = s; i < e; i++)
+      {
+        bool hasDiag = false;
+        for (auto j = A.rows_[i]; j < A.rows_[i + 1]; j++)
+        {
+          const auto c = A.columns_[j];
+          if (c < s || c >= e) continue;
+          if (!hasDiag && c >= i)
+          {
+            f.diag[i - s] = f.columns.size();
+            if (c > i)
+            {
+              f.columns.push_back(i - s);
+              f.data.push_back(0.0);
+            }
+            hasDiag = true;
+          }
+          f.columns.push_back(c - s);
+          f.data.push_back(A.data_[j]);
+        }
+        if (!hasDiag)
+        {
+          f.diag[i - s] = f.columns.size();
+          f.columns.push_back(i - s);
+          f.data.push_back(0.0);
+        }
+        f.rows.push_back(f.columns.size());
+      }
+
+      // IKJ variant of ILU(0)
+      std::vector<index_type> position(n, -1);
+      for (index_type i = 0; i < n; i++)
+      {
+        for (auto p = f.rows[i]; p < f.rows[i + 1]; p++)
+          position[f.columns[p]] = p;
+
+        for (auto p = f.rows[i]; p < f.diag[i]; p++)
+        {
+          const auto k = f.columns[p];
+          f.data[p] /= f.data[f.diag[k]];
+          const double l = f.data[p];
+          for (auto q = f.diag[k] + 1; q < f.rows[k + 1]; q++)
+          {
+            const auto pos = position[f.columns[q]];
+            if (pos >= 0) f.data[pos] -= l * f.data[q];
+          }
+        }
+
+        double& pivot = f.data[f.diag[i]];
+        if (pivot == 0.0 || !std::isfinite(pivot)) pivot = 1.0;
+
+        for (auto p = f.rows[i]; p < f.rows[i + 1]; p++)
+          position[f.columns[p]] = -1;
+      }
+    }
+
+  private:
+    struct LocalFactor
+    {
+      std::vector<index_type> rows;
+      std::vector<index_type> columns;
+      std::vector<index_type> diag;
+      std::vector<double> data;
+    };
+    std::vector<LocalFactor> factors_;
+  };
+
+  // Smoothed aggregation algebraic multigrid, applied as one symmetric V-cycle with
+  // damped Jacobi smoothing. The hierarchy is built and the V-cycle is run by all
+  // threads of the solver, each working on its own block of rows.
+  class SmoothedAggregationAMGPreconditioner : public LinearSystemPreconditioner
+  {
+  public:
+    virtual void apply(ParallelLinearAlgebra& PLA, const ParallelVector& r, ParallelVector& z) const override
+    {
+      auto& finest = levels_[0];
+      for (size_t i = PLA.start(); i < PLA.end(); i++)
+        finest.b[i] = r.data_[i];
+      PLA.wait();
+
+      cycle(PLA, 0);
+
+      for (size_t i = PLA.start(); i < PLA.end(); i++)
+        z.data_[i] = finest.x[i];
+    }
+
+  protected:
+    virtual void build(ParallelLinearAlgebra& PLA, const ParallelMatrix& A) override
+    {
+      const int proc = PLA.proc();
+      const int nproc = PLA.nproc();
+      if (PLA.first())
+      {
+        levels_.clear();
+        levels_.resize(1);
+        blocks_.resize(nproc);
+        offsets_.assign(nproc + 1, 0);
+      }
+      PLA.wait();
+      initializeLevel(PLA, levels_[0], view(A));
+
+      typedef Eigen::Map<const SparseRowMatrix::EigenBase> MappedMatrix;
+      MappedMatrix A0(A.m_, A.n_, A.nnz_, A.rows_, A.columns_, A.data_);
+
+      // Every thread sees the same levels_ between the barriers, so they all
+      // take the same decisions
+      while (levels_.size() < maxLevels_)
+      {
+        const size_t l = levels_.size() - 1;
+        const bool finest = l == 0;
+        const auto M = finest ? view(A) : view(levels_[l].A);
+        if (M.n <= coarsestSize_)
+          break;
+
+        const size_t begin = rangeBegin(M.n, proc, nproc);
+        const size_t end = rangeBegin(M.n, proc + 1, nproc);
+        tentativeProlongator(PLA, M, begin, end);
+        if (tentative_.cols() > static_cast<index_type>(0.9 * M.n))
+          break;
+
+        // P = (I - omega D^-1 A) T, one block of rows per thread
+        auto& fine = levels_[l];
+        const auto rows = static_cast<index_type>(end - begin);
+        SparseRowMatrix AT = finest ? SparseRowMatrix(A0.middleRows(begin, rows) * tentative_) : SparseRowMatrix(fine.A.middleRows(begin, rows) * tentative_);
+        for (index_type i = 0; i < AT.outerSize(); i++)
+          for (SparseRowMatrix::InnerIterator it(AT, i); it; ++it)
+            it.valueRef() *= fine.weight * fine.invDiag[begin + i];
+        blocks_[proc] = SparseRowMatrix(tentative_.middleRows(begin, rows)) - AT;
+        assemble(PLA, fine.P, M.n, tentative_.cols(), begin);
+
+        if (PLA.first())
+        {
+          fine.R = fine.P.transpose();
+          fine.R.makeCompressed();
+        }
+
+        // Galerkin product R*(A*P), again by blocks of rows
+        blocks_[proc] = finest ? SparseRowMatrix(A0.middleRows(begin, rows) * fine.P) : SparseRowMatrix(fine.A.middleRows(begin, rows) * fine.P);
+        assemble(PLA, product_, M.n, fine.P.cols(), begin);
+
+        const size_t nc = fine.P.cols();
+        const size_t cbegin = rangeBegin(nc, proc, nproc);
+        const size_t cend = rangeBegin(nc, proc + 1, nproc);
+        blocks_[proc] = SparseRowMatrix(fine.R.middleRows(cbegin, static_cast<index_type>(cend - cbegin)) * product_);
+        assemble(PLA, coarse_.A, nc, nc, cbegin);
+
+        if (PLA.first())
+          levels_.push_back(std::move(coarse_));
+        PLA.wait();
+        initializeLevel(PLA, levels_.back(), view(levels_.back().A));
+      }
+      PLA.wait();
+
+      if (PLA.first())
+      {
+        product_ = SparseRowMatrix();
+        tentative_ = SparseRowMatrix();
+        blocks_.clear();
+        auto& coarsest = levels_.back();
+        directSolve_ = coarsest.x.size() <= maxDirectSize_;
+        if (directSolve_)
+          coarseSolver_.compute(levels_.size() == 1 ? Eigen::MatrixXd(A0) : Eigen::MatrixXd(coarsest.A));
+      }
+    }
+
+  private:
+    struct Level
+    {
+      SparseRowMatrix A, P, R;
+      std::vector<double> invDiag, x, b, r;
+      double weight = 0.0;
+    };
+
+    CsrView op(size_t level) const
+    {
+      return level == 0 ? view(matrix()) : view(levels_[level].A);
+    }
+
+    // Concatenates the blocks of rows in blocks_ into A; the block of this thread
+    // starts at row begin
+    void assemble(ParallelLinearAlgebra& PLA, SparseRowMatrix& A, size_t rows, size_t cols, size_t begin)
+    {
+      const int proc = PLA.proc();
+      auto& block = blocks_[proc];
+      block.makeCompressed();
+      offsets_[proc + 1] = block.nonZeros();
+      PLA.wait();
+      if (PLA.first())
+      {
+        for (int p = 0; p < PLA.nproc(); p++)
+          offsets_[p + 1] += offsets_[p];
+        A.resize(rows, cols);
+        A.resizeNonZeros(offsets_.back());
+        A.outerIndexPtr()[rows] = offsets_.back();
+      }
+      PLA.wait();
+
+      const auto offset = offsets_[proc];
+      for (index_type i = 0; i < block.rows(); i++)
+        A.outerIndexPtr()[begin + i] = offset + block.outerIndexPtr()[i];
+      std::copy(block.innerIndexPtr(), block.innerIndexPtr() + block.nonZeros(), A.innerIndexPtr() + offset);
+      std::copy(block.valuePtr(), block.valuePtr() + block.nonZeros(), A.valuePtr() + offset);
+      PLA.wait();
+    }
+
+    void initializeLevel(ParallelLinearAlgebra& PLA, Level& level, const CsrView& A)
+    {
+      if (PLA.first())
+      {
+        level.invDiag.resize(A.n);
+        level.x.assign(A.n, 0.0);
+        level.b.assign(A.n, 0.0);
+        level.r.assign(A.n, 0.0);
+        v_.resize(A.n);
+        w_.resize(A.n);
+      }
+      PLA.wait();
+
+      const size_t begin = rangeBegin(A.n, PLA.proc(), PLA.nproc());
+      const size_t end = rangeBegin(A.n, PLA.proc() + 1, PLA.nproc());
+      for (size_t i = begin; i < end; i++)
+      {
+        const double d = diagonalEntry(A, i);
+        level.invDiag[i] = d != 0.0 ? 1.0/d : 0.0;
+        v_[i] = 1.0 + static_cast<double>(i % 7) / 7.0;
+      }
+      PLA.wait();
+
+      // Estimate the spectral radius of D^-1 A with a few power iterations
+      double rho = 1.0;
+      for (int it = 0; it < 15; it++)
+      {
+        double norms[2] = { 0.0, 0.0 };
+        for (size_t i = begin; i < end; i++)
+        {
+          double sum = 0.0;
+          for (auto j = A.rows[i]; j < A.rows[i + 1]; j++)
+            sum += A.data[j] * v_[A.columns[j]];
+          w_[i] = level.invDiag[i] * sum;
+          norms[0] += v_[i]*v_[i];
+          norms[1] += w_[i]*w_[i];
+        }
+        PLA.reduce_sum(norms, 2);
+        if (norms[0] == 0.0 || norms[1] == 0.0)
+          break;
+        rho = std::sqrt(norms[1]/norms[0]);
+        const double scale = 1.0/std::sqrt(norms[1]);
+        for (size_t i = begin; i < end; i++)
+          v_[i] = w_[i]*scale;
+        PLA.wait();
+      }
+      if (PLA.first())
+        level.weight = 4.0/(3.0*std::max(rho, 1e-12));
+    }
+
+    // Aggregates strongly connected nodes and builds the piecewise constant
+    // prolongator in tentative_, normalized per aggregate. Every thread aggregates
+    // the rows in [begin, end) and ignores connections to the rows of other
+    // threads, so the aggregation needs no communication.
+    void tentativeProlongator(ParallelLinearAlgebra& PLA, const CsrView& A, size_t begin, size_t end)
+    {
+      const int proc = PLA.proc();
+      if (PLA.first())
+      {
+        aggregate_.assign(A.n, -1);
+        diag_.resize(A.n);
+      }
+      PLA.wait();
+
+      for (size_t i = begin; i < end; i++)
+        diag_[i] = std::abs(diagonalEntry(A, i));
+
+      auto strong = [&](size_t i, index_type j)
+      {
+        const auto c = static_cast<size_t>(A.columns[j]);
+        return c != i && c >= begin && c < end && std::abs(A.data[j]) >= strength_ * std::sqrt(diag_[i] * diag_[c]);
+      };
+
+      std::vector<index_type>& aggregate = aggregate_;
+      index_type numAggregates = 0;
+
+      // Pass 1: nodes whose strong neighborhood is untouched become aggregate roots
+      for (size_t i = begin; i < end; i++)
+      {
+        if (aggregate[i] >= 0) continue;
+        bool free = true, hasNeighbors = false;
+        for (auto j = A.rows[i]; j < A.rows[i + 1] && free; j++)
+        {
+          if (!strong(i, j)) continue;
+          hasNeighbors = true;
+          if (aggregate[A.columns[j]] >= 0) free = false;
+        }
+        if (!free || !hasNeighbors) continue;
+        aggregate[i] = numAggregates;
+        for (auto j = A.rows[i]; j < A.rows[i + 1]; j++)
+          if (strong(i, j)) aggregate[A.columns[j]] = numAggregates;
+        numAggregates++;
+      }
+
+      // Pass 2: attach remaining nodes to a neighboring aggregate from pass 1
+      std::vector<index_type> firstPass(aggregate.begin() + begin, aggregate.begin() + end);
+      for (size_t i = begin; i < end; i++)
+      {
+        if (aggregate[i] >= 0) continue;
+        for (auto j = A.rows[i]; j < A.rows[i + 1]; j++)
+        {
+          if (strong(i, j) && firstPass[A.columns[j] - begin] >= 0)
+          {
+            aggregate[i] = firstPass[A.columns[j] - begin];
+            break;
+          }
+        }
+      }
+
+      // Pass 3: whatever is left forms new aggregates with its free neighbors
+      for (size_t i = begin; i < end; i++)
+      {
+        if (aggregate[i] >= 0) continue;
+        aggregate[i] = numAggregates;
+        for (auto j = A.rows[i]; j < A.rows[i + 1]; j++)
+          if (strong(i, j) && aggregate[A.columns[j]] < 0) aggregate[A.columns[j]] = numAggregates;
+        numAggregates++;
+      }
+
+      // Number the aggregates of all threads consecutively
+      offsets_[proc + 1] = numAggregates;
+      PLA.wait();
+      if (PLA.first())
+      {
+        for (int p = 0; p < PLA.nproc(); p++)
+          offsets_[p + 1] += offsets_[p];
+        tentative_.resize(A.n, offsets_.back());
+        tentative_.resizeNonZeros(A.n);
+        tentative_.outerIndexPtr()[A.n] = static_cast<index_type>(A.n);
+      }
+      PLA.wait();
+
+      // T has one entry per row, so every thread fills in its own rows
+      const auto offset = static_cast<index_type>(offsets_[proc]);
+      std::vector<double> count(numAggregates, 0.0);
+      for (size_t i = begin; i < end; i++)
+        count[aggregate[i]] += 1.0;
+      for (size_t i = begin; i < end; i++)
+      {
+        tentative_.outerIndexPtr()[i] = static_cast<index_type>(i);
+        tentative_.innerIndexPtr()[i] = offset + aggregate[i];
+        tentative_.valuePtr()[i] = 1.0/std::sqrt(count[aggregate[i]]);
+      }
+      PLA.wait();
+    }
+
+    // r = b - A x for the rows in [begin, end)
+    static void residual(const CsrView& A, const Level& level, std::vector<double>& r, size_t begin, size_t end)
+    {
+      for (size_t i = begin; i < end; i++)
+      {
+        double sum = level.b[i];
+        for (auto j = A.rows[i]; j < A.rows[i + 1]; j++)
+          sum -= A.data[j] * level.x[A.columns[j]];
+        r[i] = sum;
+      }
+    }
+
+    void smooth(ParallelLinearAlgebra& PLA, size_t l, size_t begin, size_t end) const
+    {
+      auto& level = levels_[l];
+      residual(op(l), level, level.r, begin, end);
+      PLA.wait();
+      for (size_t i = begin; i < end; i++)
+        level.x[i] += level.weight * level.invDiag[i] * level.r[i];
+      PLA.wait();
+    }
+
+    void cycle(ParallelLinearAlgebra& PLA, size_t l) const
+    {
+      auto& level = levels_[l];
+      const auto n = level.x.size();
+      const size_t begin = l == 0 ? PLA.start() : rangeBegin(n, PLA.proc(), PLA.nproc());
+      const size_t end = l == 0 ? PLA.end() : rangeBegin(n, PLA.proc() + 1, PLA.nproc());
+
+      if (l + 1 == levels_.size())
+      {
+        if (PLA.first())
+          solveCoarsest();
+        PLA.wait();
+        return;
+      }
+
+      // Pre-smoothing, starting from a zero initial guess
+      for (size_t i = begin; i < end; i++)
+        level.x[i] = level.weight * level.invDiag[i] * level.b[i];
+      PLA.wait();
+      for (int s = 1; s < smoothingSteps_; s++)
+        smooth(PLA, l, begin, end);
+
+      // Restrict the residual
+      residual(op(l), level, level.r, begin, end);
+      PLA.wait();
+      auto& coarse = levels_[l + 1];
+      const auto R = view(level.R);
+      const auto nc = coarse.b.size();
+      for (size_t i = rangeBegin(nc, PLA.proc(), PLA.nproc()); i < rangeBegin(nc, PLA.proc() + 1, PLA.nproc()); i++)
+      {
+        double sum = 0.0;
+        for (auto j = R.rows[i]; j < R.rows[i + 1]; j++)
+          sum += R.data[j] * level.r[R.columns[j]];
+        coarse.b[i] = sum;
+      }
+      PLA.wait();
+
+      cycle(PLA, l + 1);
+
+      // Prolongate the coarse correction
+      const auto P = view(level.P);
+      for (size_t i = begin; i < end; i++)
+      {
+        double sum = 0.0;
+        for (auto j = P.rows[i]; j < P.rows[i + 1]; j++)
+          sum += P.data[j] * coarse.x[P.columns[j]];
+        level.x[i] += sum;
+      }
+      PLA.wait();
+
+      // Post-smoothing
+      for (int s = 0; s < smoothingSteps_; s++)
+        smooth(PLA, l, begin, end);
+    }
+
+    void solveCoarsest() const
+    {
+      auto& level = levels_.back();
+      if (directSolve_)
+      {
+        Eigen::Map<const Eigen::VectorXd> b(&level.b[0], level.b.size());
+        Eigen::Map<Eigen::VectorXd> x(&level.x[0], level.x.size());
+        x = coarseSolver_.solve(b);
+        return;
+      }
+
+      // Coarsening stalled or the system is tiny: fall back to Jacobi sweeps
+      const auto A = op(levels_.size() - 1);
+      const auto n = level.x.size();
+      for (size_t i = 0; i < n; i++)
+        level.x[i] = level.weight * level.invDiag[i] * level.b[i];
+      for (int s = 1; s < coarseSweeps_; s++)
+      {
+        residual(A, level, level.r, 0, n);
+        for (size_t i = 0; i < n; i++)
+          level.x[i] += level.weight * level.invDiag[i] * level.r[i];
+      }
+    }
+
+    mutable std::vector<Level> levels_;
+    Eigen::PartialPivLU<Eigen::MatrixXd> coarseSolver_;
+    bool directSolve_ = false;
+
+    // Shared by the threads while the hierarchy is built
+    std::vector<SparseRowMatrix> blocks_;
+    std::vector<size_t> offsets_;
+    std::vector<index_type> aggregate_;
+    std::vector<double> diag_, v_, w_;
+    SparseRowMatrix tentative_, product_;
+    Level coarse_;
+
+    const double strength_ = 0.08;
+    const size_t maxLevels_ = 10;
+    const size_t coarsestSize_ = 500;
+    const size_t maxDirectSize_ = 2000;
+    const int smoothingSteps_ = 2;
+    const int coarseSweeps_ = 20;
+  };
+}
+
+LinearSystemPreconditionerHandle SCIRun::Core::Algorithms::Math::makePreconditioner(const std::string& name)
+{
+  if (name == "Jacobi")
+    return boost::make_shared<JacobiPreconditioner>();
+  if (name == "SymmetricGaussSeidel")
+    return boost::make_shared<SymmetricGaussSeidelPreconditioner>();
+  if (name == "ILU0")
+    return boost::make_shared<ILU0Preconditioner>();
+  if (name == "AMG")
+    return boost::make_shared<SmoothedAggregationAMGPreconditioner>();
+  return boost::make_shared<NoPreconditioner>();
+}
+
+LinearSystemPreconditionerHandle PreconditionerCache::get(const std::string& name)
+{
+  auto& preconditioner = preconditioners_[name];
+  if (!preconditioner)
+    preconditioner = makePreconditioner(name);
+  return preconditioner;
+}
+
+void PreconditionerCache::clear()
+{
+  preconditioners_.clear();
+}
@@ -0,0 +1,106 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+
+ The MIT License
+
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CORE_ALGORITHMS_MATH_LINEARSYSTEM_PRECONDITIONERS_H
+#define CORE_ALGORITHMS_MATH_LINEARSYSTEM_PRECONDITIONERS_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <Core/Algorithms/Math/ParallelAlgebra/ParallelLinearAlgebra.h>
+#include <Core/Algorithms/Math/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace Math {
+
+  // Preconditioner M for the parallel iterative solvers. setup() and apply() are
+  // collective: every thread of a ParallelLinearAlgebra region calls them.
+  class SCISHARE LinearSystemPreconditioner : boost::noncopyable
+  {
+  public:
+    typedef ParallelLinearAlgebra::ParallelMatrix ParallelMatrix;
+    typedef ParallelLinearAlgebra::ParallelVector ParallelVector;
+
+    LinearSystemPreconditioner();
+    virtual ~LinearSystemPreconditioner();
+
+    // Prepare M for matrix A. Building M is skipped when A is the same matrix, with
+    // the same generation and contents, as in the previous setup with the same
+    // number of threads.
+    void setup(ParallelLinearAlgebra& PLA, const ParallelMatrix& A);
+
+    // z = M^-1 r; r and z may refer to the same vector
+    virtual void apply(ParallelLinearAlgebra& PLA, const ParallelVector& r, ParallelVector& z) const = 0;
+    // z = M^-T r, needed for the shadow residual of BiCG
+    virtual void applyTranspose(ParallelLinearAlgebra& PLA, const ParallelVector& r, ParallelVector& z) const;
+    // z = M^-1 r together with rr = dot(r,r) and rz = dot(r,z), using a single reduction
+    virtual void applyDot(ParallelLinearAlgebra& PLA, const ParallelVector& r, ParallelVector& z, double& rr, double& rz) const;
+
+    size_t numBuilds() const { return numBuilds_; }
+
+  protected:
+    virtual void build(ParallelLinearAlgebra& PLA, const ParallelMatrix& A) = 0;
+    // Preconditioners with nothing to build are not tracked
+    virtual bool reusable() const { return true; }
+    const ParallelMatrix& matrix() const { return matrix_; }
+
+  private:
+    ParallelMatrix matrix_;
+    int id_;
+    unsigned int generation_;
+    uint64_t hash_;
+    int nproc_;
+    bool rebuild_;
+    size_t numBuilds_;
+  };
+
+  typedef boost::shared_ptr<LinearSystemPreconditioner> LinearSystemPreconditionerHandle;
+
+  // Supported names: None, Jacobi, SymmetricGaussSeidel, ILU0 and AMG. Unknown names
+  // fall back to None.
+  SCISHARE LinearSystemPreconditionerHandle makePreconditioner(const std::string& name);
+
+  // Keeps one preconditioner per type, so that repeated solves with the same
+  // matrix and a different right hand side reuse the factorization.
+  class SCISHARE PreconditionerCache : boost::noncopyable
+  {
+  public:
+    LinearSystemPreconditionerHandle get(const std::string& name);
+    void clear();
+  private:
+    std::map<std::string, LinearSystemPreconditionerHandle> preconditioners_;
+  };
+
+  typedef boost::shared_ptr<PreconditionerCache> PreconditionerCacheHandle;
+
+}}}}
+
+#endif
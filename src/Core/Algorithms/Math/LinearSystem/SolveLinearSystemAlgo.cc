@@ -33,25 +33,35 @@
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Algorithms/Math/LinearSystem/SolveLinearSystemAlgo.h>
 #include <Core/Algorithms/Math/ParallelAlgebra/ParallelLinearAlgebra.h>
+#include <Core/Algorithms/Math/LinearSystem/Preconditioners.h>
 #include <Core/Algorithms/Base/AlgorithmVariableNames.h>
 #include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/DenseColumnMatrix.h>
 #include <Core/Datatypes/DenseMatrix.h>
 #include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/MatrixTypeConversions.h>
+#include <Core/Thread/Parallel.h>
+#include <boost/scoped_ptr.hpp>
 
 using namespace SCIRun::Core::Algorithms;
 using namespace SCIRun::Core::Algorithms::Math;
 using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Thread;
 
-SolveLinearSystemAlgo::SolveLinearSystemAlgo()
+ALGORITHM_PARAMETER_DEF(Math, BlockSize);
+ALGORITHM_PARAMETER_DEF(Math, SparseFormat);
+
+SolveLinearSystemAlgo::SolveLinearSystemAlgo() : preconditioners_(new PreconditionerCache)
 {
   // For solver
-  addOption(Variables::Method,"cg","jacobi|cg|bicg|minres");
-  addOption(Variables::Preconditioner,"Jacobi","None|Jacobi");
+  addOption(Variables::Method,"cg","jacobi|cg|pipecg|bicg|minres");
+  addOption(Variables::Preconditioner,"Jacobi","None|Jacobi|SymmetricGaussSeidel|ILU0|AMG");
+  addOption(Parameters::SparseFormat,"CSR","CSR|SELL");
 
   addParameter(Variables::TargetError, 1e-5);
   addParameter(Variables::MaxIterations, 500);
+  // Right hand side columns solved together by block CG
+  addParameter(Parameters::BlockSize, 32);
 
   addParameter(Variables::BuildConvergence, true);
 
@@ -73,20 +83,22 @@ SolveLinearSystemAlgo::SolveLinearSystemAlgo()
 class SolveLinearSystemParallelAlgo : public ParallelLinearAlgebraBase
 {
 public:
-  explicit SolveLinearSystemParallelAlgo(const AlgorithmBase* base);
+  SolveLinearSystemParallelAlgo(const AlgorithmBase* base, LinearSystemPreconditionerHandle preconditioner);
 
   bool run(SparseRowMatrixHandle a, DenseColumnMatrixHandle b,
             DenseColumnMatrixHandle x0, DenseColumnMatrixHandle& x,
             DenseColumnMatrixHandle& convergence) const;
 protected:
   const AlgorithmBase* algo_;
-  std::string pre_conditioner_;
+  LinearSystemPreconditionerHandle preconditioner_;
   DenseColumnMatrixHandle convergence_;
+  bool slicedEllpack_;
 };
 
-SolveLinearSystemParallelAlgo::SolveLinearSystemParallelAlgo(const AlgorithmBase* base) : algo_(base),
-  pre_conditioner_(base->getOption(Variables::Preconditioner)),
-  convergence_(new DenseColumnMatrix(base->get(Variables::MaxIterations).toInt()))
+SolveLinearSystemParallelAlgo::SolveLinearSystemParallelAlgo(const AlgorithmBase* base, LinearSystemPreconditionerHandle preconditioner) : algo_(base),
+  preconditioner_(preconditioner),
+  convergence_(new DenseColumnMatrix(base->get(Variables::MaxIterations).toInt())),
+  slicedEllpack_(base->getOption(Parameters::SparseFormat) == "SELL")
 {
 }
 
@@ -131,14 +143,14 @@ SolveLinearSystemParallelAlgo::run(SparseRowMatrixHandle a, DenseColumnMatrixHan
 class SolveLinearSystemCGAlgo : public SolveLinearSystemParallelAlgo
 {
   public:
-    explicit SolveLinearSystemCGAlgo(const AlgorithmBase* base) : SolveLinearSystemParallelAlgo(base) {}
+    SolveLinearSystemCGAlgo(const AlgorithmBase* base, LinearSystemPreconditionerHandle preconditioner) : SolveLinearSystemParallelAlgo(base, preconditioner) {}
     virtual bool parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const;
 };
 
 bool SolveLinearSystemCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
 {
   ParallelLinearAlgebra::ParallelMatrix A;
-  ParallelLinearAlgebra::ParallelVector B, X, X0, XMIN, DIAG, R, Z, P;
+  ParallelLinearAlgebra::ParallelVector B, X, X0, XMIN, R, Z, P;
 
   double tolerance =     algo_->get(Variables::TargetError).toDouble();
   int    max_iter =      algo_->get(Variables::MaxIterations).toInt();
@@ -167,7 +179,6 @@ bool SolveLinearSystemCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs&
     return (false);
   }
   if ( !PLA.new_vector(X) ||
-       !PLA.new_vector(DIAG) ||
        !PLA.new_vector(R) ||
        !PLA.new_vector(Z) ||
        !PLA.new_vector(P))
@@ -185,26 +196,24 @@ bool SolveLinearSystemCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs&
     return (false);
   }
 
+  if (slicedEllpack_)
+    PLA.build_sliced_ellpack(A);
+
   PLA.copy(X0,X);
   PLA.copy(X0,XMIN);
 
-  // Build a preconditioner
-  if (pre_conditioner_ == "Jacobi")
-  {
-    PLA.absdiag(A,DIAG);
-    double max = PLA.max(DIAG);
-    PLA.absthreshold_invert(DIAG,DIAG,1e-18*max);
-  }
-  else
-  {
-    PLA.ones(DIAG);
-  }
+  // Build a preconditioner, or reuse the one from a previous solve with this matrix
+  preconditioner_->setup(PLA,A);
 
   PLA.mult(A,X,R);
   PLA.sub(B,R,R);
 
+  // The fused operations below need three barriers per iteration: one for the
+  // matrix product and one for each of the two reductions
   double bnorm = PLA.norm(B);
-  double error = PLA.norm(R)/bnorm;
+  double rr, bknum;
+  preconditioner_->applyDot(PLA,R,Z,rr,bknum);
+  double error = sqrt(rr)/bnorm;
 
   double xmin = error;
   double orig = error;
@@ -256,9 +265,6 @@ bool SolveLinearSystemCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs&
       return true;
     }
 
-    PLA.mult(R,DIAG,Z);
-    double bknum = PLA.dot(Z,R);
-
     if (niter == 0)
     {
       PLA.copy(Z,P);
@@ -268,16 +274,15 @@ bool SolveLinearSystemCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs&
       double bk = bknum/bkden;
       PLA.scale_add(bk,P,Z,P);
     }
-    PLA.mult(A,P,Z);
+    double akden = PLA.spmv_dot(A,P,Z);
     bkden = bknum;
 
-    double akden = PLA.dot(Z,P);
     double ak=bknum/akden;
 
-    PLA.scale_add(ak,P,X,X);
-    PLA.scale_add(-ak,Z,R,R);
+    PLA.axpy2(ak,P,X,Z,R);
 
-    error = PLA.norm(R)/bnorm;
+    preconditioner_->applyDot(PLA,R,Z,rr,bknum);
+    error = sqrt(rr)/bnorm;
     if (error < xmin)
     {
       PLA.copy(X,XMIN);
@@ -338,12 +343,188 @@ bool SolveLinearSystemCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs&
 }
 
 
+//------------------------------------------------------------------
+// Pipelined CG (Ghysels and Vanroose): the three inner products of an iteration
+// are reduced together, and the reduction completes at the barrier of the matrix
+// product, so an iteration needs a single barrier.
+
+class SolveLinearSystemPipelinedCGAlgo : public SolveLinearSystemParallelAlgo
+{
+  public:
+    SolveLinearSystemPipelinedCGAlgo(const AlgorithmBase* base, LinearSystemPreconditionerHandle preconditioner) : SolveLinearSystemParallelAlgo(base, preconditioner) {}
+    virtual bool parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const;
+};
+
+bool SolveLinearSystemPipelinedCGAlgo::parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
+{
+  ParallelLinearAlgebra::ParallelMatrix A;
+  ParallelLinearAlgebra::ParallelVector B, X, X0, XMIN, R, U, W, M[2], N, Z, Q, S, P;
+
+  double tolerance =     algo_->get(Variables::TargetError).toDouble();
+  int    max_iter =      algo_->get(Variables::MaxIterations).toInt();
+  int    niter = 0;
+
+  if ( !PLA.add_matrix(matrices.A, A) ||
+       !PLA.add_vector(matrices.b, B) ||
+       !PLA.add_vector(matrices.x0, X0) ||
+       !PLA.add_vector(matrices.x, X))
+  {
+    if (PLA.first())
+      algo_->error("Could not link matrices");
+    PLA.wait();
+    return (false);
+  }
+  if ( !PLA.new_vector(R) || !PLA.new_vector(U) ||
+       !PLA.new_vector(W) || !PLA.new_vector(M[0]) ||
+       !PLA.new_vector(M[1]) || !PLA.new_vector(N) || !PLA.new_vector(Z) ||
+       !PLA.new_vector(Q) || !PLA.new_vector(S) ||
+       !PLA.new_vector(P) || !PLA.new_vector(XMIN))
+  {
+    if (PLA.first())
+      algo_->error("Could not allocate enough memory for algorithm");
+    PLA.wait();
+    return (false);
+  }
+
+  if (slicedEllpack_)
+    PLA.build_sliced_ellpack(A);
+
+  PLA.copy(X0,X);
+  PLA.zeros(Z);
+  PLA.zeros(Q);
+  PLA.zeros(S);
+  PLA.zeros(P);
+
+  preconditioner_->setup(PLA,A);
+
+  // r = b - A*x, u = M*r, w = A*u
+  PLA.mult(A,X,R);
+  PLA.sub(B,R,R);
+  preconditioner_->apply(PLA,R,U);
+  PLA.mult(A,U,W);
+
+  double bnorm = PLA.norm(B);
+  double orig = 0.0;
+  double error = 0.0;
+  double xmin = 0.0;
+  double gamma_old = 0.0;
+  double alpha = 0.0;
+
+  int cnt = 0;
+  double log_target = log(tolerance);
+  double log_orig = 0.0;
+  double log_scale = 1.0;
+
+  const size_t start = PLA.start();
+  const size_t end = PLA.end();
+
+  while (true)
+  {
+    // gamma = (r,u), delta = (w,u), rr = (r,r)
+    double dots[3] = { 0.0, 0.0, 0.0 };
+    for (size_t i = start; i < end; i++)
+    {
+      dots[0] += R.data_[i]*U.data_[i];
+      dots[1] += W.data_[i]*U.data_[i];
+      dots[2] += R.data_[i]*R.data_[i];
+    }
+    PLA.reduce_begin(dots, 3);
+
+    // m = M*w, n = A*m: the product waits for all threads, which completes the reduction.
+    // Without a second barrier a thread may get here again while others still read m
+    // in the previous product, so m alternates between two vectors.
+    ParallelLinearAlgebra::ParallelVector& Mi = M[niter % 2];
+    preconditioner_->apply(PLA,W,Mi);
+    PLA.mult(A,Mi,N);
+
+    PLA.reduce_end(dots, 3);
+    const double gamma = dots[0];
+    const double delta = dots[1];
+    error = sqrt(dots[2])/bnorm;
+
+    // The residual belongs to the current x, which is saved as the best one
+    // in the sweep below rather than in a separate copy
+    const bool improved = (niter == 0 || error < xmin);
+    if (improved)
+      xmin = error;
+
+    if (niter == 0)
+    {
+      orig = error;
+      log_orig = log(orig);
+      log_scale = log_orig - log_target;
+    }
+    else if (PLA.first())
+    {
+      (*convergence_)[niter-1] = xmin;
+    }
+
+    if (error <= tolerance || niter >= max_iter)
+      break;
+
+    double beta = 0.0;
+    if (niter == 0)
+    {
+      alpha = gamma/delta;
+    }
+    else
+    {
+      beta = gamma/gamma_old;
+      alpha = gamma/(delta - beta*gamma/alpha);
+    }
+    gamma_old = gamma;
+
+    // All recurrences in one sweep over the local rows
+    double* xmin_ptr = improved ? XMIN.data_ : 0;
+    for (size_t i = start; i < end; i++)
+    {
+      if (xmin_ptr) xmin_ptr[i] = X.data_[i];
+      Z.data_[i] = N.data_[i] + beta*Z.data_[i];
+      Q.data_[i] = Mi.data_[i] + beta*Q.data_[i];
+      S.data_[i] = W.data_[i] + beta*S.data_[i];
+      P.data_[i] = U.data_[i] + beta*P.data_[i];
+      X.data_[i] += alpha*P.data_[i];
+      R.data_[i] -= alpha*S.data_[i];
+      U.data_[i] -= alpha*Q.data_[i];
+      W.data_[i] -= alpha*Z.data_[i];
+    }
+
+    niter++;
+
+    cnt++;
+    if (cnt == 20)
+    {
+      cnt = 0;
+      algo_->update_progress((log_orig-log(error))/log_scale);
+    }
+  }
+
+  // Return the best solution seen if the iterations stopped on a worse one.
+  // Every thread only copies its own rows, so no barrier is needed.
+  if (error > xmin)
+    PLA.copy(XMIN,X);
+
+  if (PLA.first())
+  {
+    std::ostringstream ostr;
+    if (error <= tolerance)
+      ostr << "Solver converged after " << niter << " iterations with error " << error;
+    else
+      ostr << "Solver stopped after " << niter << " iterations. Error was " << error;
+    algo_->remark(ostr.str());
+  }
+
+  PLA.wait();
+
+  return true;
+}
+
 //------------------------------------------------------------------
 // BICG Solver with simple preconditioner
 class SolveLinearSystemBICGAlgo : public SolveLinearSystemParallelAlgo
 {
   public:
-    explicit SolveLinearSystemBICGAlgo(const AlgorithmBase* base) : SolveLinearSystemParallelAlgo(base) {}
+    SolveLinearSystemBICGAlgo(const AlgorithmBase* base, LinearSystemPreconditionerHandle preconditioner) : SolveLinearSystemParallelAlgo(base, preconditioner) {}
     virtual bool parallel(ParallelLinearAlgebra& PLA,
                           SolverInputs& matrices) const;
 };
@@ -357,7 +538,7 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
   // Define matrices and vectors to be used in the algorithm
   ParallelLinearAlgebra::ParallelMatrix A;
   ParallelLinearAlgebra::ParallelVector B, X, X0, XMIN;
-  ParallelLinearAlgebra::ParallelVector DIAG, R, R1, Z, Z1, P, P1;
+  ParallelLinearAlgebra::ParallelVector R, R1, Z, Z1, P, P1;
 
   double tolerance =     algo_->get(Variables::TargetError).toDouble();
   int    max_iter =      algo_->get(Variables::MaxIterations).toInt();
@@ -373,7 +554,6 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
        !PLA.add_vector(matrices.x0,X0) ||
        !PLA.add_vector(matrices.x,XMIN) ||
        !PLA.new_vector(X) ||
-       !PLA.new_vector(DIAG) ||
        !PLA.new_vector(R) ||
        !PLA.new_vector(R1) ||
        !PLA.new_vector(Z) ||
@@ -395,20 +575,14 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
     return (false);
   }
 
+  if (slicedEllpack_)
+    PLA.build_sliced_ellpack(A);
+
   PLA.copy(X0,X);
   PLA.copy(X0,XMIN);
 
-  // Build a preconditioner
-  if (pre_conditioner_ == "Jacobi")
-  {
-    PLA.absdiag(A,DIAG);
-    double max = PLA.max(DIAG);
-    PLA.absthreshold_invert(DIAG,DIAG,1e-18*max);
-  }
-  else
-  {
-    PLA.ones(DIAG);
-  }
+  // Build a preconditioner, or reuse the one from a previous solve with this matrix
+  preconditioner_->setup(PLA,A);
 
   PLA.mult(A,X,R);
   PLA.sub(B,R,R);
@@ -460,8 +634,8 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
       return (true);
     }
 
-    PLA.mult(R,DIAG,Z);
-    PLA.mult(R1,DIAG,Z1);
+    preconditioner_->apply(PLA,R,Z);
+    preconditioner_->applyTranspose(PLA,R1,Z1);
 
     double bknum = PLA.dot(Z,R1);
 
@@ -499,10 +673,10 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
     double ak=bknum/akden;
 
     PLA.scale_add(ak,P,X,X);
-    PLA.scale_add(-ak,Z,R,R);
-
     PLA.scale_add(-ak,Z1,R1,R1);
-    error = PLA.norm(R)/bnorm;
+
+    // Update the residual and reduce its norm in the same sweep
+    error = sqrt(PLA.axpy_dot(-ak,Z,R))/bnorm;
 
     if (error < xmin) { PLA.copy(X,XMIN); xmin = error; }
     if (PLA.first()) (*convergence_)[niter] = xmin;
@@ -558,7 +732,7 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
 class SolveLinearSystemMINRESAlgo : public SolveLinearSystemParallelAlgo
 {
 public:
-  explicit SolveLinearSystemMINRESAlgo(const AlgorithmBase* base) : SolveLinearSystemParallelAlgo(base) {}
+  SolveLinearSystemMINRESAlgo(const AlgorithmBase* base, LinearSystemPreconditionerHandle preconditioner) : SolveLinearSystemParallelAlgo(base, preconditioner) {}
   virtual bool parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const;
 };
 
@@ -572,7 +746,7 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
   // Define matrices and vectors to be used in the algorithm
   ParallelLinearAlgebra::ParallelMatrix A;
   ParallelLinearAlgebra::ParallelVector B, X, X0, XMIN;
-  ParallelLinearAlgebra::ParallelVector DIAG, R, V, VOLD, VV;
+  ParallelLinearAlgebra::ParallelVector R, V, VOLD, VV;
   ParallelLinearAlgebra::ParallelVector VOLDER, M, MOLD, MOLDER, XCG;
 
   double tolerance =     algo_->get(Variables::TargetError).toDouble();
@@ -590,7 +764,6 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
        !PLA.add_vector(matrices.x,XMIN) ||
        !PLA.new_vector(X) ||
        !PLA.new_vector(R) ||
-       !PLA.new_vector(DIAG) ||
        !PLA.new_vector(V) ||
        !PLA.new_vector(VV) ||
        !PLA.new_vector(VOLD) ||
@@ -614,20 +787,14 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
     return (false);
   }
 
+  if (slicedEllpack_)
+    PLA.build_sliced_ellpack(A);
+
   PLA.copy(X0,X);
   PLA.copy(X0,XMIN);
 
-  // Build a preconditioner
-  if (pre_conditioner_ == "Jacobi")
-  {
-    PLA.absdiag(A,DIAG);
-    double max = PLA.max(DIAG);
-    PLA.absthreshold_invert(DIAG,DIAG,1e-18*max);
-  }
-  else
-  {
-    PLA.ones(DIAG);
-  }
+  // Build a preconditioner, or reuse the one from a previous solve with this matrix
+  preconditioner_->setup(PLA,A);
 
   PLA.mult(A,X,R);
   PLA.sub(B,R,R);
@@ -656,7 +823,7 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
   PLA.copy(R,VOLD);
   PLA.copy(R,V);
 
-  PLA.mult(DIAG,V,V);
+  preconditioner_->apply(PLA,V,V);
 
   double beta1   = sqrt(PLA.dot(V,VOLD));
   double snprod  = beta1;
@@ -673,7 +840,7 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
   PLA.copy(VOLD,VOLDER);
   PLA.copy(V,VOLD);
 
-  PLA.mult(DIAG,V,V);
+  preconditioner_->apply(PLA,V,V);
 
   double betaold = beta1;
   double beta = sqrt(PLA.dot(VOLD,V));
@@ -734,7 +901,7 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
     PLA.copy(VOLD,VOLDER);
     PLA.copy(V,VOLD);
 
-    PLA.mult(DIAG,V,V);
+    preconditioner_->apply(PLA,V,V);
 
     betaold = beta;
     beta = sqrt(PLA.dot(VOLD,V));
@@ -910,7 +1077,7 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
 class SolveLinearSystemJACOBIAlgo : public SolveLinearSystemParallelAlgo
 {
 public:
-  explicit SolveLinearSystemJACOBIAlgo(const AlgorithmBase* base) : SolveLinearSystemParallelAlgo(base) {}
+  SolveLinearSystemJACOBIAlgo(const AlgorithmBase* base, LinearSystemPreconditionerHandle preconditioner) : SolveLinearSystemParallelAlgo(base, preconditioner) {}
   virtual bool parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const;
 };
 
@@ -956,6 +1123,9 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
     return (false);
   }
 
+  if (slicedEllpack_)
+    PLA.build_sliced_ellpack(A);
+
   PLA.copy(X0,X);
   PLA.copy(X0,XMIN);
 
@@ -1067,6 +1237,305 @@ parallel(ParallelLinearAlgebra& PLA, SolverInputs& matrices) const
   return (true);
 }
 
+//------------------------------------------------------------------
+// Block CG for several right hand sides that share the matrix A.
+// This is the breakdown-free variant of block CG: the search block is
+// orthonormalized every iteration and directions that have become linearly
+// dependent are dropped, so columns can converge and be deflated one at a
+// time. Every product with A is a sparse matrix times dense block product,
+// which streams the matrix once per iteration for all active columns.
+
+namespace
+{
+  // Row major, so that each nonzero of A touches one contiguous block row
+  typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> BlockVectors;
+  typedef Eigen::MatrixXd SmallMatrix;
+
+  const size_t blockRowGrain = 1024;
+
+  // Applies one of the PLA preconditioners to each column of a block on the calling thread
+  class ColumnwisePreconditioner : boost::noncopyable
+  {
+  public:
+    ColumnwisePreconditioner(SparseRowMatrixHandle A, LinearSystemPreconditionerHandle preconditioner);
+    void apply(const BlockVectors& R, BlockVectors& Z);
+  private:
+    static SolverInputs inputs(SparseRowMatrixHandle A, DenseColumnMatrixHandle r, DenseColumnMatrixHandle z);
+
+    LinearSystemPreconditionerHandle preconditioner_;
+    DenseColumnMatrixHandle r_, z_;
+    ParallelLinearAlgebraSharedData data_;
+    ParallelLinearAlgebra PLA_;
+    ParallelLinearAlgebra::ParallelMatrix A_;
+    ParallelLinearAlgebra::ParallelVector R_, Z_;
+  };
+
+  ColumnwisePreconditioner::ColumnwisePreconditioner(SparseRowMatrixHandle A, LinearSystemPreconditionerHandle preconditioner) :
+    preconditioner_(preconditioner),
+    r_(new DenseColumnMatrix(A->nrows())),
+    z_(new DenseColumnMatrix(A->nrows())),
+    data_(inputs(A, r_, z_), 1),
+    PLA_(data_, 0)
+  {
+    r_->setZero();
+    z_->setZero();
+    if (!PLA_.add_matrix(A, A_) || !PLA_.add_vector(r_, R_) || !PLA_.add_vector(z_, Z_))
+      BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << SCIRun::Core::ErrorMessage("Could not link matrices"));
+    preconditioner_->setup(PLA_, A_);
+  }
+
+  SolverInputs ColumnwisePreconditioner::inputs(SparseRowMatrixHandle A, DenseColumnMatrixHandle r, DenseColumnMatrixHandle z)
+  {
+    SolverInputs system;
+    system.A = A;
+    system.b = r;
+    system.x0 = r;
+    system.x = z;
+    return system;
+  }
+
+  void ColumnwisePreconditioner::apply(const BlockVectors& R, BlockVectors& Z)
+  {
+    Z.resize(R.rows(), R.cols());
+    for (Eigen::Index j = 0; j < R.cols(); ++j)
+    {
+      *r_ = R.col(j);
+      preconditioner_->apply(PLA_, R_, Z_);
+      Z.col(j) = *z_;
+    }
+  }
+}
+
+class SolveLinearSystemBlockCGAlgo
+{
+public:
+  SolveLinearSystemBlockCGAlgo(const AlgorithmBase* base, LinearSystemPreconditionerHandle preconditioner) :
+    algo_(base), preconditioner_(preconditioner) {}
+
+  // Solves A*X = B for the columns [first, first+count) of B, writing the same columns of X
+  bool run(SparseRowMatrixHandle A, const DenseMatrix& B, const DenseMatrix& X0,
+           DenseMatrix& X, Eigen::Index first, Eigen::Index count) const;
+
+private:
+  // Q = A*P
+  static void multiply(const SparseRowMatrix& A, const BlockVectors& P, BlockVectors& Q);
+  // U^T*V
+  static SmallMatrix innerProduct(const BlockVectors& U, const BlockVectors& V);
+  // V += U*M
+  static void multiplyAdd(const BlockVectors& U, const SmallMatrix& M, BlockVectors& V);
+  // Replaces W by an orthonormal basis of its column space, dropping dependent directions
+  static void orthonormalize(BlockVectors& W);
+  static Eigen::VectorXd columnNorms(const BlockVectors& U);
+
+  const AlgorithmBase* algo_;
+  LinearSystemPreconditionerHandle preconditioner_;
+};
+
+void SolveLinearSystemBlockCGAlgo::multiply(const SparseRowMatrix& A, const BlockVectors& P, BlockVectors& Q)
+{
+  Q.resize(A.rows(), P.cols());
+  Parallel::For(0, A.rows(), blockRowGrain, [&](size_t begin, size_t end)
+  {
+    Q.middleRows(begin, end - begin).noalias() = A.middleRows(begin, end - begin) * P;
+  });
+}
+
+SmallMatrix SolveLinearSystemBlockCGAlgo::innerProduct(const BlockVectors& U, const BlockVectors& V)
+{
+  // One partial sum per chunk, added up in a fixed order to keep results reproducible
+  const size_t rows = U.rows();
+  std::vector<SmallMatrix> partial((rows + blockRowGrain - 1) / blockRowGrain);
+  Parallel::For(0, rows, blockRowGrain, [&](size_t begin, size_t end)
+  {
+    partial[begin / blockRowGrain].noalias() = U.middleRows(begin, end - begin).transpose() * V.middleRows(begin, end - begin);
+  });
+
+  SmallMatrix sum = SmallMatrix::Zero(U.cols(), V.cols());
+  for (const auto& p : partial)
+    if (p.size() > 0)
+      sum += p;
+  return sum;
+}
+
+void SolveLinearSystemBlockCGAlgo::multiplyAdd(const BlockVectors& U, const SmallMatrix& M, BlockVectors& V)
+{
+  Parallel::For(0, U.rows(), blockRowGrain, [&](size_t begin, size_t end)
+  {
+    V.middleRows(begin, end - begin).noalias() += U.middleRows(begin, end - begin) * M;
+  });
+}
+
+Eigen::VectorXd SolveLinearSystemBlockCGAlgo::columnNorms(const BlockVectors& U)
+{
+  return innerProduct(U, U).diagonal().cwiseSqrt();
+}
+
+void SolveLinearSystemBlockCGAlgo::orthonormalize(BlockVectors& W)
+{
+  // Scale the columns to unit length first, otherwise the search direction of a
+  // nearly converged column would be mistaken for a dependent one
+  SmallMatrix gram = innerProduct(W, W);
+  Eigen::VectorXd scale(gram.rows());
+  for (Eigen::Index i = 0; i < gram.rows(); ++i)
+    scale[i] = gram(i, i) > 0 ? 1.0 / std::sqrt(gram(i, i)) : 0.0;
+  gram = scale.asDiagonal() * gram * scale.asDiagonal();
+
+  Eigen::SelfAdjointEigenSolver<SmallMatrix> eigen(gram);
+  const Eigen::VectorXd& lambda = eigen.eigenvalues();
+  const double cutoff = 1e-12 * std::max(lambda.maxCoeff(), 0.0);
+
+  std::vector<Eigen::Index> kept;
+  for (Eigen::Index i = 0; i < lambda.size(); ++i)
+    if (lambda[i] > cutoff)
+      kept.push_back(i);
+
+  SmallMatrix basis(gram.rows(), kept.size());
+  for (size_t k = 0; k < kept.size(); ++k)
+    basis.col(k) = scale.asDiagonal() * eigen.eigenvectors().col(kept[k]) / std::sqrt(lambda[kept[k]]);
+
+  BlockVectors Q = BlockVectors::Zero(W.rows(), basis.cols());
+  multiplyAdd(W, basis, Q);
+  W.swap(Q);
+}
+
+bool SolveLinearSystemBlockCGAlgo::run(SparseRowMatrixHandle A, const DenseMatrix& B, const DenseMatrix& X0,
+                                       DenseMatrix& X, Eigen::Index first, Eigen::Index count) const
+{
+  double tolerance = algo_->get(Variables::TargetError).toDouble();
+  int    max_iter =  algo_->get(Variables::MaxIterations).toInt();
+
+  boost::scoped_ptr<ColumnwisePreconditioner> preconditioner;
+  if (preconditioner_)
+    preconditioner.reset(new ColumnwisePreconditioner(A, preconditioner_));
+
+  // Columns that have not converged yet; X and R only hold these
+  std::vector<Eigen::Index> active;
+  BlockVectors Xa = X0.middleCols(first, count);
+  BlockVectors R = B.middleCols(first, count);
+  BlockVectors Q, Z;
+  Eigen::VectorXd bnorm = B.middleCols(first, count).colwise().norm().transpose();
+  for (Eigen::Index j = 0; j < count; ++j)
+  {
+    active.push_back(first + j);
+    if (bnorm[j] == 0.0)
+      bnorm[j] = 1.0;
+  }
+
+  multiply(*A, Xa, Q);
+  R -= Q;
+
+  int niter = 0;
+  double error = 0.0, orig = 0.0;
+  size_t numConverged = 0;
+  BlockVectors P;
+  Eigen::LDLT<SmallMatrix> PtQ;
+
+  // Moves converged columns into X and returns the largest remaining error
+  auto deflate = [&]() -> double
+  {
+    Eigen::VectorXd errors = columnNorms(R).cwiseQuotient(bnorm);
+    std::vector<Eigen::Index> keep;
+    double worst = 0.0;
+    for (size_t j = 0; j < active.size(); ++j)
+    {
+      if (errors[j] <= tolerance)
+        X.col(active[j]) = Xa.col(j);
+      else
+      {
+        keep.push_back(j);
+        worst = std::max(worst, errors[j]);
+      }
+    }
+    if (keep.size() == active.size())
+      return worst;
+
+    numConverged += active.size() - keep.size();
+    std::vector<Eigen::Index> stillActive;
+    BlockVectors Xk(Xa.rows(), keep.size()), Rk(R.rows(), keep.size());
+    Eigen::VectorXd bk(keep.size());
+    for (size_t k = 0; k < keep.size(); ++k)
+    {
+      stillActive.push_back(active[keep[k]]);
+      Xk.col(k) = Xa.col(keep[k]);
+      Rk.col(k) = R.col(keep[k]);
+      bk[k] = bnorm[keep[k]];
+    }
+    active.swap(stillActive);
+    Xa.swap(Xk);
+    R.swap(Rk);
+    bnorm.swap(bk);
+    return worst;
+  };
+
+  error = orig = deflate();
+  if (active.empty())
+  {
+    std::ostringstream ostr;
+    ostr << "Solver found solution for all " << count << " columns with error <= " << tolerance;
+    algo_->remark(ostr.str());
+    return true;
+  }
+
+  int cnt = 0;
+  double log_target = log(tolerance);
+  double log_orig =  log(orig);
+  double log_scale = log_orig - log_target;
+
+  if (preconditioner)
+    preconditioner->apply(R, Z);
+  else
+    Z = R;
+  P = Z;
+  orthonormalize(P);
+
+  while (niter < max_iter && !active.empty() && P.cols() > 0)
+  {
+    multiply(*A, P, Q);
+    PtQ.compute(innerProduct(P, Q));
+
+    // X += P*alpha, R -= Q*alpha with alpha = (P^T A P)^-1 P^T R
+    SmallMatrix alpha = PtQ.solve(innerProduct(P, R));
+    multiplyAdd(P, alpha, Xa);
+    multiplyAdd(Q, -alpha, R);
+    niter++;
+
+    error = deflate();
+    if (active.empty())
+      break;
+
+    if (preconditioner)
+      preconditioner->apply(R, Z);
+    else
+      Z = R;
+
+    // New search block Z + P*beta, A-orthogonal to P
+    SmallMatrix beta = -PtQ.solve(innerProduct(Q, Z));
+    multiplyAdd(P, beta, Z);
+    P.swap(Z);
+    orthonormalize(P);
+
+    cnt++;
+    if (cnt == 20)
+    {
+      cnt = 0;
+      algo_->update_progress((log_orig-log(error))/log_scale);
+    }
+  }
+
+  for (size_t j = 0; j < active.size(); ++j)
+    X.col(active[j]) = Xa.col(j);
+
+  std::ostringstream ostr;
+  if (active.empty())
+    ostr << "Block solver converged for all " << count << " columns after " << niter << " iterations";
+  else
+    ostr << "Block solver stopped after " << niter << " iterations with " << numConverged << " of " << count
+      << " columns converged. Largest error was " << error;
+  algo_->remark(ostr.str());
+
+  return true;
+}
+
 bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
                            DenseColumnMatrixHandle b,
                            DenseColumnMatrixHandle x0,
@@ -1146,19 +1615,28 @@ bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
   }
 
   std::string method = getOption(Variables::Method);
+  auto preconditioner = preconditioners_->get(getOption(Variables::Preconditioner));
 
   DenseColumnMatrixHandle conv;
   if (method == "cg")
   {
-    SolveLinearSystemCGAlgo algo(this);
+    SolveLinearSystemCGAlgo algo(this, preconditioner);
     if(!algo.run(A,b,x0,x,conv))
     {
       BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("Conjugate Gradient method failed"));
     }
   }
+  else if (method == "pipecg")
+  {
+    SolveLinearSystemPipelinedCGAlgo algo(this, preconditioner);
+    if(!algo.run(A,b,x0,x,conv))
+    {
+      BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("Pipelined Conjugate Gradient method failed"));
+    }
+  }
   else if (method == "bicg")
   {
-    SolveLinearSystemBICGAlgo algo(this);
+    SolveLinearSystemBICGAlgo algo(this, preconditioner);
     if(!(algo.run(A,b,x0,x,conv)))
     {
       BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("BiConjugate Gradient method failed"));
@@ -1166,7 +1644,7 @@ bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
   }
   else if (method == "jacobi")
   {
-    SolveLinearSystemJACOBIAlgo algo(this);
+    SolveLinearSystemJACOBIAlgo algo(this, preconditioner);
     if(!(algo.run(A,b,x0,x,conv)))
     {
       BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("Jacobi method failed"));
@@ -1174,7 +1652,7 @@ bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
   }
   else if (method == "minres")
   {
-    SolveLinearSystemMINRESAlgo algo(this);
+    SolveLinearSystemMINRESAlgo algo(this, preconditioner);
     if(!(algo.run(A,b,x0,x,conv)))
     {
       BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("MINRES method failed"));
@@ -1200,9 +1678,103 @@ bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
   return true;
 }
 
+bool SolveLinearSystemAlgo::run(SparseRowMatrixHandle A,
+                           DenseMatrixHandle B,
+                           DenseMatrixHandle X0,
+                           DenseMatrixHandle& X) const
+{
+  ScopedAlgorithmStatusReporter ssr(this, "SolveLinearSystem");
+  ENSURE_ALGORITHM_INPUT_NOT_NULL(A, "No matrix A is given");
+  ENSURE_ALGORITHM_INPUT_NOT_NULL(B, "No matrix b is given");
+
+  double tolerance = get(Variables::TargetError).toDouble();
+  int maxIterations = get(Variables::MaxIterations).toInt();
+  int blockSize = get(Parameters::BlockSize).toInt();
+  ENSURE_POSITIVE_DOUBLE(tolerance, "Tolerance out of range!");
+  ENSURE_POSITIVE_INT(maxIterations, "Max iterations out of range!");
+  ENSURE_POSITIVE_INT(blockSize, "Block size out of range!");
+
+  if (!X0)
+  {
+    auto temp(boost::make_shared<DenseMatrix>(B->nrows(), B->ncols()));
+    temp->setZero();
+    X0 = temp;
+  }
+
+  if (X0->ncols() != B->ncols())
+  {
+    THROW_ALGORITHM_INPUT_ERROR("Matrix x0 and b need to have the same number of columns");
+  }
+
+  if (A->nrows() != A->ncols())
+  {
+    THROW_ALGORITHM_INPUT_ERROR("Matrix A is not square");
+  }
+
+  if (A->nrows() != B->nrows())
+  {
+    THROW_ALGORITHM_INPUT_ERROR("Matrix A and b do not have the same number of rows");
+  }
+
+  if (A->nrows() != X0->nrows())
+  {
+    THROW_ALGORITHM_INPUT_ERROR("Matrix A and x0 do not have the same number of rows");
+  }
+
+  X = boost::make_shared<DenseMatrix>(B->nrows(), B->ncols());
+
+  std::string method = getOption(Variables::Method);
+  std::string preconditionerName = getOption(Variables::Preconditioner);
+  const auto numColumns = static_cast<Eigen::Index>(B->ncols());
+
+  if (method == "cg")
+  {
+    LinearSystemPreconditionerHandle preconditioner;
+    if (preconditionerName != "None")
+      preconditioner = preconditioners_->get(preconditionerName);
+
+    SolveLinearSystemBlockCGAlgo algo(this, preconditioner);
+    for (Eigen::Index first = 0; first < numColumns; first += blockSize)
+    {
+      auto count = std::min<Eigen::Index>(blockSize, numColumns - first);
+      if (!algo.run(A, *B, *X0, *X, first, count))
+      {
+        BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("Block Conjugate Gradient method failed"));
+      }
+    }
+    return true;
+  }
+
+  // The other methods have no block variant, so solve one column at a time
+  for (Eigen::Index j = 0; j < numColumns; ++j)
+  {
+    auto b = boost::make_shared<DenseColumnMatrix>(B->col(j));
+    auto x0 = boost::make_shared<DenseColumnMatrix>(X0->col(j));
+    DenseColumnMatrixHandle x;
+    if (!run(A, b, x0, x))
+      return false;
+    X->col(j) = *x;
+  }
+  return true;
+}
+
 AlgorithmOutput SolveLinearSystemAlgo::run(const AlgorithmInput& input) const
 {
   auto lhs = input.get<SparseRowMatrix>(Variables::LHS);
+
+  auto rhsColumns = input.get<DenseMatrix>(Variables::RHS);
+  if (rhsColumns)
+  {
+    DenseMatrixHandle solution;
+    if (!run(lhs, rhsColumns, DenseMatrixHandle(), solution))
+    {
+      BOOST_THROW_EXCEPTION(AlgorithmProcessingException() << ErrorMessage("SolveLinearSystem Algo returned false--need to improve error conditions so it throws before returning."));
+    }
+    AlgorithmOutput output;
+    output[Variables::Solution] = solution;
+    return output;
+  }
+
   auto rhs = input.get<DenseColumnMatrix>(Variables::RHS);
 
   DenseColumnMatrixHandle solution;
@@ -35,6 +35,7 @@
 
 #include <Core/Algorithms/Base/AlgorithmBase.h>
 #include <Core/Datatypes/MatrixFwd.h>
+#include <boost/shared_ptr.hpp>
 #include <Core/Algorithms/Math/share.h>
 
 namespace SCIRun {
@@ -42,8 +43,16 @@ namespace Core {
 namespace Algorithms {
 namespace Math {
 
+class PreconditionerCache;
+
+ALGORITHM_PARAMETER_DECL(BlockSize);
+ALGORITHM_PARAMETER_DECL(SparseFormat);
+
 // Solve a linear system in parallel using a standard iterative method
 // Method solves A*x = b, with x0 being the initializer for the solution
+// The preconditioner is kept between runs and only rebuilt when A changes
+// A b with several columns is solved with block CG, BlockSize columns at a time
+// SparseFormat SELL multiplies with a sliced ELLPACK copy of A instead of the CSR arrays
 
 class SCISHARE SolveLinearSystemAlgo : public AlgorithmBase
 {
@@ -61,7 +70,15 @@ class SCISHARE SolveLinearSystemAlgo : public AlgorithmBase
              Datatypes::DenseColumnMatrixHandle x0, 
              Datatypes::DenseColumnMatrixHandle& x) const;
 
+    bool run(Datatypes::SparseRowMatrixHandle A,
+             Datatypes::DenseMatrixHandle b,
+             Datatypes::DenseMatrixHandle x0,
+             Datatypes::DenseMatrixHandle& x) const;
+
     AlgorithmOutput run(const AlgorithmInput& input) const;
+
+  private:
+    boost::shared_ptr<PreconditionerCache> preconditioners_;
 };
 
 
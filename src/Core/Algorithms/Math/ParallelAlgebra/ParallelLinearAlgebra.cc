@@ -40,6 +40,7 @@
 #include <Core/Datatypes/SparseRowMatrix.h>
 #include <Core/Datatypes/MatrixTypeConversions.h>
 #include <Core/Algorithms/Math/ParallelAlgebra/ParallelLinearAlgebra.h>
+#include <Core/Algorithms/Math/ParallelAlgebra/SlicedEllpackMatrix.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Thread/Parallel.h>
 
@@ -76,6 +77,7 @@ ParallelLinearAlgebra::ParallelLinearAlgebra(ParallelLinearAlgebraSharedData& da
   reduce_[1] = data.reduceBuffer2();
 
   reduce_buffer_ = 0;
+  pending_buffer_ = 0;
 }
 
 void ParallelLinearAlgebra::wait()
@@ -139,10 +141,20 @@ bool ParallelLinearAlgebra::add_matrix(SparseRowMatrixHandle mat, ParallelMatrix
   M.m_ = mat->nrows();
   M.n_ = mat->ncols();
   M.nnz_ = mat->nonZeros();
+  M.id_ = mat->id();
+  M.generation_ = mat->generation();
+  M.sliced_.reset();
 
   return (true);
 }
 
+void ParallelLinearAlgebra::build_sliced_ellpack(ParallelMatrix& M)
+{
+  // Each thread converts its own rows, so the copy is also placed in memory
+  // close to the thread that uses it
+  M.sliced_.reset(new SlicedEllpackMatrix(M.rows_, M.columns_, M.data_, start_, end_, M.n_));
+}
+
 /// @todo: refactor duplication
 
 void ParallelLinearAlgebra::mult(const ParallelVector& a, const ParallelVector& b, ParallelVector& r)
@@ -629,6 +641,12 @@ void ParallelLinearAlgebra::mult(const ParallelMatrix& a, const ParallelVector&
 {
   wait();
 
+  if (a.sliced_)
+  {
+    a.sliced_->multiply(b.data_, r.data_);
+    return;
+  }
+
   double* idata = b.data_;
   double* odata = r.data_;
 
@@ -649,6 +667,61 @@ void ParallelLinearAlgebra::mult(const ParallelMatrix& a, const ParallelVector&
   }
 }
 
+double ParallelLinearAlgebra::spmv_dot(const ParallelMatrix& a, const ParallelVector& b, ParallelVector& r)
+{
+  mult(a, b, r);
+
+  const double* b_ptr = b.data_;
+  const double* r_ptr = r.data_;
+  double val = 0.0;
+  for (size_t i=start_; i<end_; i++) val += b_ptr[i]*r_ptr[i];
+  return (reduce_sum(val));
+}
+
+double ParallelLinearAlgebra::axpy_dot(double s, const ParallelVector& a, ParallelVector& r)
+{
+  const double* a_ptr = a.data_;
+  double* r_ptr = r.data_;
+  double val = 0.0;
+  for (size_t i=start_; i<end_; i++)
+  {
+    r_ptr[i] += s*a_ptr[i];
+    val += r_ptr[i]*r_ptr[i];
+  }
+  return (reduce_sum(val));
+}
+
+void ParallelLinearAlgebra::axpy2(double s, const ParallelVector& p, ParallelVector& x, const ParallelVector& q, ParallelVector& r)
+{
+  const double* p_ptr = p.data_;
+  const double* q_ptr = q.data_;
+  double* x_ptr = x.data_;
+  double* r_ptr = r.data_;
+  for (size_t i=start_; i<end_; i++)
+  {
+    x_ptr[i] += s*p_ptr[i];
+    r_ptr[i] -= s*q_ptr[i];
+  }
+}
+
+void ParallelLinearAlgebra::dot2(const ParallelVector& a, const ParallelVector& b,
+  const ParallelVector& c, const ParallelVector& d, double& ab, double& cd)
+{
+  const double* a_ptr = a.data_;
+  const double* b_ptr = b.data_;
+  const double* c_ptr = c.data_;
+  const double* d_ptr = d.data_;
+  double val[2] = { 0.0, 0.0 };
+  for (size_t i=start_; i<end_; i++)
+  {
+    val[0] += a_ptr[i]*b_ptr[i];
+    val[1] += c_ptr[i]*d_ptr[i];
+  }
+  reduce_sum(val, 2);
+  ab = val[0];
+  cd = val[1];
+}
+
 void ParallelLinearAlgebra::mult_trans(ParallelMatrix& a, ParallelVector& b, ParallelVector& r)
 {
   wait();
@@ -723,29 +796,54 @@ void ParallelLinearAlgebra::absdiag(const ParallelMatrix& a, ParallelVector& r)
 double ParallelLinearAlgebra::reduce_sum(double val)
 {
   int buffer = reduce_buffer_;
-  reduce_[buffer][proc_] = val;
+  reduce_[buffer][proc_*REDUCE_STRIDE] = val;
   if (reduce_buffer_)
     reduce_buffer_ = 0;
   else
     reduce_buffer_ = 1;
   wait();
 
-  double ret = 0.0; for (int j=0; j<nproc_;j++) ret += reduce_[buffer][j];
+  double ret = 0.0; for (int j=0; j<nproc_;j++) ret += reduce_[buffer][j*REDUCE_STRIDE];
   return (ret);
 }
 
+void ParallelLinearAlgebra::reduce_begin(const double* values, int count)
+{
+  pending_buffer_ = reduce_buffer_;
+  double* slot = reduce_[pending_buffer_] + proc_*REDUCE_STRIDE;
+  for (int k = 0; k < count; k++) slot[k] = values[k];
+  reduce_buffer_ = reduce_buffer_ ? 0 : 1;
+}
+
+void ParallelLinearAlgebra::reduce_end(double* values, int count)
+{
+  const double* buffer = reduce_[pending_buffer_];
+  for (int k = 0; k < count; k++)
+  {
+    double ret = 0.0; for (int j=0; j<nproc_;j++) ret += buffer[j*REDUCE_STRIDE+k];
+    values[k] = ret;
+  }
+}
+
+void ParallelLinearAlgebra::reduce_sum(double* values, int count)
+{
+  reduce_begin(values, count);
+  wait();
+  reduce_end(values, count);
+}
+
 /// @todo: std::max_element
 double ParallelLinearAlgebra::reduce_max(double val)
 {
   int buffer = reduce_buffer_;
-  reduce_[buffer][proc_] = val;
+  reduce_[buffer][proc_*REDUCE_STRIDE] = val;
   if (reduce_buffer_)
     reduce_buffer_ = 0;
   else
     reduce_buffer_ = 1;
   wait();
 
-  double ret = -(DBL_MAX); for (int j=0; j<nproc_;j++) if (reduce_[buffer][j] > ret) ret = reduce_[buffer][j];
+  double ret = -(DBL_MAX); for (int j=0; j<nproc_;j++) if (reduce_[buffer][j*REDUCE_STRIDE] > ret) ret = reduce_[buffer][j*REDUCE_STRIDE];
   return (ret);
 }
 
@@ -753,14 +851,14 @@ double ParallelLinearAlgebra::reduce_max(double val)
 double ParallelLinearAlgebra::reduce_min(double val)
 {
   int buffer = reduce_buffer_;
-  reduce_[buffer][proc_] = val;
+  reduce_[buffer][proc_*REDUCE_STRIDE] = val;
   if (reduce_buffer_)
     reduce_buffer_ = 0;
   else
     reduce_buffer_ = 1;
   wait();
 
-  double ret = DBL_MAX; for (int j=0; j<nproc_;j++) if (reduce_[buffer][j] < ret) ret = reduce_[buffer][j];
+  double ret = DBL_MAX; for (int j=0; j<nproc_;j++) if (reduce_[buffer][j*REDUCE_STRIDE] < ret) ret = reduce_[buffer][j*REDUCE_STRIDE];
   return (ret);
 }
 
@@ -805,8 +903,8 @@ ParallelLinearAlgebraSharedData::ParallelLinearAlgebraSharedData(const SolverInp
   imatrices_(inputs),
   barrier_("Parallel Linear Algebra", numProcs),
   numProcs_(numProcs),
-  reduce1_(numProcs),
-  reduce2_(numProcs)
+  reduce1_(numProcs*REDUCE_STRIDE),
+  reduce2_(numProcs*REDUCE_STRIDE)
 {
   if (inputs.b->nrows() != size_
     || inputs.x->nrows() != size_
@@ -36,6 +36,7 @@
 #include <vector>
 #include <list>
 #include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 #include <Core/Datatypes/MatrixFwd.h>
 #include <Core/Thread/Barrier.h>
 #include <Core/Datatypes/Legacy/Base/Types.h>
@@ -47,6 +48,7 @@ namespace Algorithms {
 namespace Math {
 
   class ParallelLinearAlgebra;
+  class SlicedEllpackMatrix;
   
   struct SCISHARE SolverInputs
   {
@@ -64,6 +66,10 @@ namespace Math {
     }
   };
 
+  // Each thread owns a cache line of the reduction buffers: room for several
+  // values reduced together, and no false sharing between threads
+  const int REDUCE_STRIDE = 8;
+
   class SCISHARE ParallelLinearAlgebraSharedData : boost::noncopyable
   {
   public:
@@ -145,6 +151,13 @@ public:
       size_t   m_;
       size_t   n_;
       size_t   nnz_;
+
+      // id() and generation() of the linked matrix, see SparseRowMatrix
+      int      id_ = -1;
+      unsigned int generation_ = 0;
+
+      // Optional SELL-C-sigma copy of this thread's rows, used by mult()
+      boost::shared_ptr<SlicedEllpackMatrix> sliced_;
   };
       
   // Constructor
@@ -153,6 +166,9 @@ public:
   bool add_vector(Datatypes::DenseColumnMatrixHandle mat, ParallelVector& V);
   bool new_vector(ParallelVector& V);
   bool add_matrix(Datatypes::SparseRowMatrixHandle mat, ParallelMatrix& M);
+  // Makes mult(M,...) use a SIMD friendly copy of the local rows; worth it when
+  // the same matrix is multiplied many times
+  void build_sliced_ellpack(ParallelMatrix& M);
 
   void mult(const ParallelVector& a, const ParallelVector& b, ParallelVector& r);
   void sub(const ParallelVector& a, const ParallelVector& b, ParallelVector& r);
@@ -186,11 +202,36 @@ public:
   void mult(const ParallelMatrix& a, const ParallelVector& b, ParallelVector& r);
   
   void absdiag(const ParallelMatrix& a, ParallelVector& r);
+
+  // Fused operations: one sweep over the vectors and at most one reduction,
+  // instead of a pass and a barrier for each primitive
+  // r = a*b, returns dot(b,r)
+  double spmv_dot(const ParallelMatrix& a, const ParallelVector& b, ParallelVector& r);
+  // r = s*a + r, returns dot(r,r)
+  double axpy_dot(double s, const ParallelVector& a, ParallelVector& r);
+  // x = s*p + x and r = -s*q + r, no synchronization
+  void axpy2(double s, const ParallelVector& p, ParallelVector& x, const ParallelVector& q, ParallelVector& r);
+  // ab = dot(a,b), cd = dot(c,d)
+  void dot2(const ParallelVector& a, const ParallelVector& b,
+    const ParallelVector& c, const ParallelVector& d, double& ab, double& cd);
+
+  // Sums count (<= REDUCE_STRIDE) values over all threads
+  void reduce_sum(double* values, int count);
+  // Split form of reduce_sum: reduce_begin publishes the partial sums of this thread
+  // and returns at once, reduce_end collects the totals. A barrier (wait() or a matrix
+  // product) has to happen in between, and no other reduction, so the reduction can
+  // ride on the barrier of work that needs one anyway.
+  void reduce_begin(const double* values, int count);
+  void reduce_end(double* values, int count);
   
   void ones(ParallelVector& r);
     
   int  proc() { return proc_; }
   int  nproc() { return nproc_; }
+
+  // Range of vector entries / matrix rows owned by this thread
+  size_t start() const { return start_; }
+  size_t end() const { return end_; }
     
   bool first() { return proc_ == 0; }
   void wait();
@@ -213,6 +254,7 @@ private:
     
   double* reduce_[2];
   int     reduce_buffer_;
+  int     pending_buffer_;
 
  
 };
@@ -0,0 +1,259 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Algorithms/Math/ParallelAlgebra/SlicedEllpackMatrix.h>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCIRUN_SELL_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Algorithms::Math;
+
+namespace
+{
+  const size_t C = SlicedEllpackMatrix::ChunkHeight;
+
+  struct SlicedData
+  {
+    size_t numChunks;
+    const size_t* offsets;
+    const double* values;
+    const index_type* slotRows;
+  };
+
+  template <typename Index>
+  void multiplyScalar(const SlicedData& s, const Index* columns, const double* x, double* y)
+  {
+    for (size_t c = 0; c < s.numChunks; ++c)
+    {
+      double sum[C] = {};
+      const double* v = s.values + s.offsets[c];
+      const Index* col = columns + s.offsets[c];
+      const size_t length = (s.offsets[c + 1] - s.offsets[c]) / C;
+      for (size_t k = 0; k < length; ++k, v += C, col += C)
+        for (size_t l = 0; l < C; ++l)
+          sum[l] += v[l] * x[col[l]];
+
+      const index_type* rows = s.slotRows + c*C;
+      for (size_t l = 0; l < C; ++l)
+        if (rows[l] >= 0)
+          y[rows[l]] = sum[l];
+    }
+  }
+
+#ifdef SCIRUN_SELL_X86_KERNELS
+  __attribute__((target("avx2,fma")))
+  void multiplyAVX2(const SlicedData& s, const boost::uint32_t* columns, const double* x, double* y)
+  {
+    for (size_t c = 0; c < s.numChunks; ++c)
+    {
+      __m256d sum0 = _mm256_setzero_pd();
+      __m256d sum1 = _mm256_setzero_pd();
+      const double* v = s.values + s.offsets[c];
+      const boost::uint32_t* col = columns + s.offsets[c];
+      const size_t length = (s.offsets[c + 1] - s.offsets[c]) / C;
+      for (size_t k = 0; k < length; ++k, v += C, col += C)
+      {
+        const __m128i index0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col));
+        const __m128i index1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col + 4));
+        sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(v), _mm256_i32gather_pd(x, index0, 8), sum0);
+        sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(v + 4), _mm256_i32gather_pd(x, index1, 8), sum1);
+      }
+
+      double sum[C];
+      _mm256_storeu_pd(sum, sum0);
+      _mm256_storeu_pd(sum + 4, sum1);
+      const index_type* rows = s.slotRows + c*C;
+      for (size_t l = 0; l < C; ++l)
+        if (rows[l] >= 0)
+          y[rows[l]] = sum[l];
+    }
+  }
+
+  __attribute__((target("avx512f")))
+  void multiplyAVX512(const SlicedData& s, const boost::uint32_t* columns, const double* x, double* y)
+  {
+    for (size_t c = 0; c < s.numChunks; ++c)
+    {
+      __m512d sum0 = _mm512_setzero_pd();
+      const double* v = s.values + s.offsets[c];
+      const boost::uint32_t* col = columns + s.offsets[c];
+      const size_t length = (s.offsets[c + 1] - s.offsets[c]) / C;
+      for (size_t k = 0; k < length; ++k, v += C, col += C)
+      {
+        const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(col));
+        sum0 = _mm512_fmadd_pd(_mm512_loadu_pd(v), _mm512_i32gather_pd(index, x, 8), sum0);
+      }
+
+      double sum[C];
+      _mm512_storeu_pd(sum, sum0);
+      const index_type* rows = s.slotRows + c*C;
+      for (size_t l = 0; l < C; ++l)
+        if (rows[l] >= 0)
+          y[rows[l]] = sum[l];
+    }
+  }
+#endif
+
+  SlicedEllpackMatrix::Kernel detectKernel()
+  {
+#ifdef SCIRUN_SELL_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+      return SlicedEllpackMatrix::Kernel::AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      return SlicedEllpackMatrix::Kernel::AVX2;
+#endif
+    return SlicedEllpackMatrix::Kernel::Scalar;
+  }
+}
+
+SlicedEllpackMatrix::SlicedEllpackMatrix(const index_type* rows, const index_type* columns, const double* values,
+  size_t rowBegin, size_t rowEnd, size_t numColumns, size_t sortWindow) :
+  numRows_(rowEnd > rowBegin ? rowEnd - rowBegin : 0),
+  numChunks_((numRows_ + C - 1) / C)
+{
+  sortWindow = std::max(sortWindow, size_t(1));
+
+  // Sort rows by decreasing length within each window, so chunks need little padding
+  std::vector<index_type> order(numChunks_*C, -1);
+  std::iota(order.begin(), order.begin() + numRows_, static_cast<index_type>(rowBegin));
+  auto rowLength = [rows](index_type r) { return rows[r + 1] - rows[r]; };
+  for (size_t w = 0; w < numRows_; w += sortWindow)
+  {
+    auto first = order.begin() + w;
+    auto last = order.begin() + std::min(w + sortWindow, numRows_);
+    std::stable_sort(first, last, [&](index_type a, index_type b) { return rowLength(a) > rowLength(b); });
+  }
+
+  chunkOffsets_.resize(numChunks_ + 1, 0);
+  for (size_t c = 0; c < numChunks_; ++c)
+  {
+    index_type longest = 0;
+    for (size_t l = 0; l < C; ++l)
+      if (order[c*C + l] >= 0)
+        longest = std::max(longest, rowLength(order[c*C + l]));
+    chunkOffsets_[c + 1] = chunkOffsets_[c] + longest*C;
+  }
+
+  const size_t stored = chunkOffsets_[numChunks_];
+  const bool compress = numColumns < static_cast<size_t>(std::numeric_limits<int>::max());
+  values_.assign(stored, 0.0);
+  if (compress)
+    columns32_.assign(stored, 0);
+  else
+    columns64_.assign(stored, 0);
+
+  for (size_t c = 0; c < numChunks_; ++c)
+  {
+    for (size_t l = 0; l < C; ++l)
+    {
+      const index_type row = order[c*C + l];
+      if (row < 0)
+        continue;
+      const index_type begin = rows[row];
+      const index_type end = rows[row + 1];
+      // Padding repeats the last column of the row, so it reads a cached entry of x
+      const index_type pad = end > begin ? columns[end - 1] : 0;
+      const size_t length = (chunkOffsets_[c + 1] - chunkOffsets_[c]) / C;
+      for (size_t k = 0; k < length; ++k)
+      {
+        const size_t slot = chunkOffsets_[c] + k*C + l;
+        const index_type j = begin + static_cast<index_type>(k);
+        const bool inRow = j < end;
+        values_[slot] = inRow ? values[j] : 0.0;
+        const index_type column = inRow ? columns[j] : pad;
+        if (compress)
+          columns32_[slot] = static_cast<boost::uint32_t>(column);
+        else
+          columns64_[slot] = column;
+      }
+    }
+  }
+
+  slotRows_.swap(order);
+}
+
+void SlicedEllpackMatrix::multiply(const double* x, double* y) const
+{
+  multiply(x, y, bestKernel());
+}
+
+void SlicedEllpackMatrix::multiply(const double* x, double* y, Kernel kernel) const
+{
+  if (numChunks_ == 0)
+    return;
+
+  SlicedData s = { numChunks_, &chunkOffsets_[0], values_.empty() ? nullptr : &values_[0], &slotRows_[0] };
+  if (columns32_.empty())
+  {
+    multiplyScalar(s, columns64_.empty() ? nullptr : &columns64_[0], x, y);
+    return;
+  }
+
+  const boost::uint32_t* columns = &columns32_[0];
+#ifdef SCIRUN_SELL_X86_KERNELS
+  if (kernel == Kernel::AVX512 && supports(Kernel::AVX512))
+  {
+    multiplyAVX512(s, columns, x, y);
+    return;
+  }
+  if (kernel == Kernel::AVX2 && supports(Kernel::AVX2))
+  {
+    multiplyAVX2(s, columns, x, y);
+    return;
+  }
+#endif
+  multiplyScalar(s, columns, x, y);
+}
+
+SlicedEllpackMatrix::Kernel SlicedEllpackMatrix::bestKernel()
+{
+  static const Kernel best = detectKernel();
+  return best;
+}
+
+bool SlicedEllpackMatrix::supports(Kernel kernel)
+{
+  return static_cast<int>(kernel) <= static_cast<int>(bestKernel());
+}
+
+std::string SlicedEllpackMatrix::kernelName(Kernel kernel)
+{
+  switch (kernel)
+  {
+  case Kernel::AVX512: return "AVX-512";
+  case Kernel::AVX2: return "AVX2";
+  default: return "scalar";
+  }
+}
@@ -0,0 +1,88 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_ALGORITHMS_MATH_PARALLELALGEBRA_SLICEDELLPACKMATRIX_H
+#define CORE_ALGORITHMS_MATH_PARALLELALGEBRA_SLICEDELLPACKMATRIX_H
+
+#include <vector>
+#include <string>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <Core/Datatypes/Legacy/Base/Types.h>
+#include <Core/Algorithms/Math/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Algorithms {
+namespace Math {
+
+  // Copy of a range of rows of a CSR matrix in SELL-C-sigma format: rows are sorted
+  // by length within windows of sigma rows, then grouped in chunks of C rows that are
+  // stored column by column and padded to the longest row of the chunk. This lets a
+  // SIMD lane handle one row, so the product needs no horizontal reductions.
+  // Column indices are stored with 32 bits whenever the matrix has fewer than 2^31
+  // columns, halving the index traffic of the product.
+  class SCISHARE SlicedEllpackMatrix : boost::noncopyable
+  {
+  public:
+    static const size_t ChunkHeight = 8;
+    static const size_t DefaultSortWindow = 128;
+
+    enum class Kernel { Scalar, AVX2, AVX512 };
+
+    SlicedEllpackMatrix(const index_type* rows, const index_type* columns, const double* values,
+      size_t rowBegin, size_t rowEnd, size_t numColumns, size_t sortWindow = DefaultSortWindow);
+
+    // y[i] = (A*x)[i] for the rows i in [rowBegin, rowEnd); other entries of y are not touched
+    void multiply(const double* x, double* y) const;
+    void multiply(const double* x, double* y, Kernel kernel) const;
+
+    size_t numRows() const { return numRows_; }
+    // Stored entries including padding
+    size_t storedEntries() const { return values_.size(); }
+    bool compressedIndices() const { return !columns32_.empty() || values_.empty(); }
+
+    // Fastest kernel supported by the CPU we are running on, detected once
+    static Kernel bestKernel();
+    static bool supports(Kernel kernel);
+    static std::string kernelName(Kernel kernel);
+
+  private:
+    size_t numRows_;
+    size_t numChunks_;
+    std::vector<size_t> chunkOffsets_;
+    std::vector<double> values_;
+    std::vector<boost::uint32_t> columns32_;
+    std::vector<index_type> columns64_;
+    // Global row of each chunk slot, -1 for the padding slots of the last chunk
+    std::vector<index_type> slotRows_;
+  };
+
+}}}}
+
+#endif
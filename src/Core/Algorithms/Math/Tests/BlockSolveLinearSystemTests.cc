@@ -0,0 +1,190 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+
+ The MIT License
+
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <Core/Algorithms/Math/LinearSystem/SolveLinearSystemAlgo.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun;
+
+namespace
+{
+  // 7-point Laplacian on an n^3 grid with Dirichlet boundary and a varying diagonal
+  SparseRowMatrixHandle laplacian3D(int n)
+  {
+    const int size = n*n*n;
+    std::vector<SparseRowMatrix::Triplet> entries;
+    auto index = [n](int i, int j, int k) { return i + n*(j + n*k); };
+    for (int k = 0; k < n; k++)
+      for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+        {
+          const int row = index(i, j, k);
+          entries.push_back(SparseRowMatrix::Triplet(row, row, 6.0 + 2.0 * (row % 7)));
+          if (i > 0) entries.push_back(SparseRowMatrix::Triplet(row, index(i-1, j, k), -1.0));
+          if (i < n-1) entries.push_back(SparseRowMatrix::Triplet(row, index(i+1, j, k), -1.0));
+          if (j > 0) entries.push_back(SparseRowMatrix::Triplet(row, index(i, j-1, k), -1.0));
+          if (j < n-1) entries.push_back(SparseRowMatrix::Triplet(row, index(i, j+1, k), -1.0));
+          if (k > 0) entries.push_back(SparseRowMatrix::Triplet(row, index(i, j, k-1), -1.0));
+          if (k < n-1) entries.push_back(SparseRowMatrix::Triplet(row, index(i, j, k+1), -1.0));
+        }
+    auto A = boost::make_shared<SparseRowMatrix>(size, size);
+    A->setFromTriplets(entries.begin(), entries.end());
+    A->makeCompressed();
+    return A;
+  }
+
+  // Columns of very different scale and smoothness, so they converge at different iterations
+  DenseMatrixHandle rightHandSides(int size, int columns)
+  {
+    auto B = boost::make_shared<DenseMatrix>(size, columns);
+    for (int j = 0; j < columns; j++)
+      for (int i = 0; i < size; i++)
+        (*B)(i, j) = std::pow(10.0, j % 4) * std::sin(0.01 * (j + 1) * i) + (i % (j + 2));
+    return B;
+  }
+
+  double worstRelativeResidual(const SparseRowMatrix& A, const DenseMatrix& B, const DenseMatrix& X)
+  {
+    DenseMatrix R = B - A * X;
+    double worst = 0;
+    for (int j = 0; j < B.ncols(); j++)
+      worst = std::max(worst, R.col(j).norm() / B.col(j).norm());
+    return worst;
+  }
+
+  void configure(SolveLinearSystemAlgo& algo, const std::string& method, const std::string& preconditioner)
+  {
+    algo.set(Variables::MaxIterations, 500);
+    algo.set(Variables::TargetError, 1e-8);
+    algo.setOption(Variables::Method, method);
+    algo.setOption(Variables::Preconditioner, preconditioner);
+    algo.setUpdaterFunc([](double) {});
+  }
+}
+
+class BlockSolveLinearSystemTests : public ::testing::TestWithParam<const char*>
+{
+};
+
+TEST_P(BlockSolveLinearSystemTests, SolvesEveryColumn)
+{
+  auto A = laplacian3D(10);
+  auto B = rightHandSides(A->nrows(), 11);
+
+  SolveLinearSystemAlgo algo;
+  configure(algo, "cg", GetParam());
+  algo.set(Parameters::BlockSize, 4);
+
+  DenseMatrixHandle X;
+  ASSERT_TRUE(algo.run(A, B, DenseMatrixHandle(), X));
+  ASSERT_TRUE(X != nullptr);
+  EXPECT_EQ(B->nrows(), X->nrows());
+  EXPECT_EQ(B->ncols(), X->ncols());
+  EXPECT_LT(worstRelativeResidual(*A, *B, *X), 1e-7);
+}
+
+TEST_P(BlockSolveLinearSystemTests, MatchesSingleColumnSolves)
+{
+  auto A = laplacian3D(8);
+  auto B = rightHandSides(A->nrows(), 3);
+
+  SolveLinearSystemAlgo algo;
+  configure(algo, "cg", GetParam());
+
+  DenseMatrixHandle X;
+  ASSERT_TRUE(algo.run(A, B, DenseMatrixHandle(), X));
+
+  for (int j = 0; j < B->ncols(); j++)
+  {
+    auto b = boost::make_shared<DenseColumnMatrix>(B->col(j));
+    DenseColumnMatrixHandle x;
+    ASSERT_TRUE(algo.run(A, b, DenseColumnMatrixHandle(), x));
+    EXPECT_LT((X->col(j) - *x).norm() / x->norm(), 1e-6) << j;
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(
+  SolveLinearSystemBlockCG,
+  BlockSolveLinearSystemTests,
+  ::testing::Values("None", "Jacobi", "ILU0", "AMG"));
+
+TEST(BlockSolveLinearSystemTests, HandlesDependentAndZeroColumns)
+{
+  auto A = laplacian3D(6);
+  auto B = rightHandSides(A->nrows(), 4);
+  B->col(1) = 3.0 * B->col(0);
+  B->col(2).setZero();
+
+  SolveLinearSystemAlgo algo;
+  configure(algo, "cg", "Jacobi");
+
+  DenseMatrixHandle X;
+  ASSERT_TRUE(algo.run(A, B, DenseMatrixHandle(), X));
+  EXPECT_EQ(0.0, X->col(2).norm());
+  EXPECT_LT((X->col(1) - 3.0 * X->col(0)).norm() / X->col(1).norm(), 1e-6);
+  DenseMatrix R = *B - *A * *X;
+  EXPECT_LT(R.col(3).norm() / B->col(3).norm(), 1e-7);
+}
+
+TEST(BlockSolveLinearSystemTests, OtherMethodsSolveColumnByColumn)
+{
+  auto A = laplacian3D(6);
+  auto B = rightHandSides(A->nrows(), 3);
+
+  for (auto method : { "bicg", "minres" })
+  {
+    SolveLinearSystemAlgo algo;
+    configure(algo, method, "Jacobi");
+
+    DenseMatrixHandle X;
+    ASSERT_TRUE(algo.run(A, B, DenseMatrixHandle(), X));
+    EXPECT_LT(worstRelativeResidual(*A, *B, *X), 1e-7) << method;
+  }
+}
+
+TEST(BlockSolveLinearSystemTests, ThrowsForMismatchedInitialGuess)
+{
+  auto A = laplacian3D(4);
+  auto B = rightHandSides(A->nrows(), 3);
+  auto X0 = boost::make_shared<DenseMatrix>(A->nrows(), 2);
+  X0->setZero();
+
+  SolveLinearSystemAlgo algo;
+  configure(algo, "cg", "None");
+
+  DenseMatrixHandle X;
+  EXPECT_THROW(algo.run(A, B, X0, X), AlgorithmInputException);
+}
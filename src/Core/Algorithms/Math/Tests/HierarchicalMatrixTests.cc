@@ -0,0 +1,163 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Algorithms/Math/HierarchicalMatrix.h>
+#include <Core/GeometryPrimitives/PointVectorOperators.h>
+#include <cmath>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  // Roughly uniform points on a sphere (spiral construction)
+  std::vector<Point> spherePoints(int n, double radius)
+  {
+    std::vector<Point> points;
+    const double golden = M_PI * (3.0 - std::sqrt(5.0));
+    for (int i = 0; i < n; i++)
+    {
+      const double z = 1.0 - 2.0 * (i + 0.5) / n;
+      const double r = std::sqrt(1.0 - z * z);
+      points.push_back(Point(radius * r * std::cos(golden * i), radius * r * std::sin(golden * i), radius * z));
+    }
+    return points;
+  }
+
+  std::vector<BBox> boxes(const std::vector<Point>& points)
+  {
+    std::vector<BBox> result;
+    for (const auto& p : points)
+      result.push_back(BBox(p, p));
+    return result;
+  }
+
+  // Regularized 1/r kernel, smooth away from the diagonal
+  HierarchicalMatrix::BlockFunction kernel(const std::vector<Point>& x, const std::vector<Point>& y)
+  {
+    return [&x, &y](const std::vector<index_type>& rows, const std::vector<index_type>& cols, DenseMatrix& block)
+    {
+      for (size_t r = 0; r < rows.size(); r++)
+        for (size_t c = 0; c < cols.size(); c++)
+          block(r, c) += 1.0 / ((x[rows[r]] - y[cols[c]]).length() + 0.01);
+    };
+  }
+
+  DenseMatrix dense(const std::vector<Point>& x, const std::vector<Point>& y)
+  {
+    DenseMatrix A(x.size(), y.size());
+    for (size_t r = 0; r < x.size(); r++)
+      for (size_t c = 0; c < y.size(); c++)
+        A(r, c) = 1.0 / ((x[r] - y[c]).length() + 0.01);
+    return A;
+  }
+}
+
+TEST(HierarchicalMatrixTests, SeparatedSurfacesCompressWell)
+{
+  auto inner = spherePoints(3200, 1.0);
+  auto outer = spherePoints(4800, 2.5);
+  HierarchicalMatrix H(boxes(inner), boxes(outer), kernel(inner, outer));
+
+  EXPECT_EQ(inner.size(), H.rows());
+  EXPECT_EQ(outer.size(), H.cols());
+  EXPECT_EQ(H.numBlocks(), H.numLowRankBlocks());
+  EXPECT_LT(H.storedEntries(), H.rows() * H.cols() / 3);
+
+  Eigen::VectorXd x(outer.size()), y(inner.size());
+  for (size_t k = 0; k < outer.size(); k++)
+    x(k) = std::sin(0.1 * k);
+  H.multiply(x.data(), y.data());
+
+  // Product with the full matrix, without storing it
+  Eigen::VectorXd expected = Eigen::VectorXd::Zero(inner.size());
+  for (size_t r = 0; r < inner.size(); r++)
+    for (size_t c = 0; c < outer.size(); c++)
+      expected(r) += x(c) / ((inner[r] - outer[c]).length() + 0.01);
+  EXPECT_LT((y - expected).norm(), 1e-5 * expected.norm());
+}
+
+TEST(HierarchicalMatrixTests, SelfInteractionMatchesDense)
+{
+  auto points = spherePoints(1000, 1.0);
+  HierarchicalMatrix::Parameters parameters;
+  parameters.leafSize = 16;
+  parameters.tolerance = 1e-8;
+  HierarchicalMatrix H(boxes(points), boxes(points), kernel(points, points), parameters);
+  const DenseMatrix A = dense(points, points);
+
+  EXPECT_GT(H.numLowRankBlocks(), 0u);
+  EXPECT_LT(H.storedEntries(), A.size());
+
+  DenseMatrix expanded = DenseMatrix::Zero(A.rows(), A.cols());
+  H.addTo(expanded);
+  EXPECT_LT((expanded - A).norm(), 1e-6 * A.norm());
+
+  // Enough columns for the product to be split by column
+  DenseMatrix X(points.size(), 12);
+  for (int i = 0; i < X.rows(); i++)
+    for (int j = 0; j < X.cols(); j++)
+      X(i, j) = std::cos(0.01 * i * (j + 1));
+  const DenseMatrix Y = H.multiply(X);
+  const DenseMatrix expected = A * X;
+  EXPECT_LT((Y - expected).norm(), 1e-6 * expected.norm());
+}
+
+TEST(HierarchicalMatrixTests, TransposeProductMatchesDense)
+{
+  auto inner = spherePoints(600, 1.0);
+  auto outer = spherePoints(900, 1.5);
+  HierarchicalMatrix::Parameters parameters;
+  parameters.leafSize = 16;
+  parameters.tolerance = 1e-8;
+  HierarchicalMatrix H(boxes(inner), boxes(outer), kernel(inner, outer), parameters);
+  const DenseMatrix A = dense(inner, outer);
+  EXPECT_GT(H.numLowRankBlocks(), 0u);
+
+  DenseMatrix X(inner.size(), 3);
+  for (int i = 0; i < X.rows(); i++)
+    for (int j = 0; j < X.cols(); j++)
+      X(i, j) = std::sin(0.02 * i + j);
+  const DenseMatrix Y = H.transposeMultiply(X);
+  const DenseMatrix expected = A.transpose() * X;
+  ASSERT_EQ(outer.size(), static_cast<size_t>(Y.rows()));
+  EXPECT_LT((Y - expected).norm(), 1e-6 * expected.norm());
+}
+
+TEST(HierarchicalMatrixTests, EmptyMatrix)
+{
+  std::vector<Point> none;
+  auto points = spherePoints(10, 1.0);
+  HierarchicalMatrix H(boxes(none), boxes(points), kernel(none, points));
+  EXPECT_EQ(0u, H.rows());
+  EXPECT_EQ(10u, H.cols());
+  EXPECT_EQ(0u, H.numBlocks());
+}
@@ -976,3 +976,90 @@ TEST(ParallelArithmeticTests, CanComputeDotProductMulti)
   EXPECT_EQ(-9 , v23);
   EXPECT_EQ(9 , v13);
 }
+
+TEST(ParallelArithmeticTests, FusedOperationsMatchPrimitives)
+{
+  ParallelLinearAlgebraSharedData data(getDummySystem(),1);
+  ParallelLinearAlgebra pla(data,0);
+
+  ParallelLinearAlgebra::ParallelMatrix m;
+  auto mat = matrix1();
+  pla.add_matrix(mat,m);
+
+  ParallelLinearAlgebra::ParallelVector v1, v2, v3, r;
+  auto vec1 = vector1();
+  auto vec2 = vector2();
+  auto vec3 = vector3();
+  DenseColumnMatrixHandle result(boost::make_shared<DenseColumnMatrix>(size));
+  pla.add_vector(vec1,v1);
+  pla.add_vector(vec2,v2);
+  pla.add_vector(vec3,v3);
+  pla.add_vector(result,r);
+
+  // A*v1 = (1, -4, 0, ..., -2)
+  EXPECT_EQ(1*1 + 2*-4 + -1*-2, pla.spmv_dot(m,v1,r));
+  EXPECT_EQ(-4, (*result)[1]);
+
+  double ab, cd;
+  pla.dot2(v1,v2,v2,v3,ab,cd);
+  EXPECT_EQ(-22, ab);
+  EXPECT_EQ(-9, cd);
+
+  // v3 += 2*v1 = (2, 5, 8, ..., -9)
+  EXPECT_EQ(4 + 25 + 64 + 81, pla.axpy_dot(2,v1,v3));
+  EXPECT_EQ(5, (*vec3)[1]);
+
+  // v2 += 2*v1, v3 -= 2*v1
+  pla.axpy2(2,v1,v2,v1,v3);
+  EXPECT_EQ(2, (*vec2)[1]);
+  EXPECT_EQ(1, (*vec2)[0]);
+  EXPECT_EQ(1, (*vec3)[1]);
+  EXPECT_EQ(-7, (*vec3)[size-1]);
+}
+
+struct splitReduce
+{
+  splitReduce(ParallelLinearAlgebraSharedData& data, int proc) : data_(data), proc_(proc) {}
+
+  ParallelLinearAlgebraSharedData& data_;
+  int proc_;
+  double first_[2];
+  double second_[2];
+
+  void operator()()
+  {
+    ParallelLinearAlgebra pla(data_, proc_);
+
+    first_[0] = 1; first_[1] = proc_;
+    pla.reduce_begin(first_, 2);
+    pla.wait();
+    pla.reduce_end(first_, 2);
+
+    // no barrier between collecting one reduction and starting the next
+    second_[0] = 10; second_[1] = 10*proc_;
+    pla.reduce_begin(second_, 2);
+    pla.wait();
+    pla.reduce_end(second_, 2);
+  }
+};
+
+TEST(ParallelArithmeticTests, CanSplitReductionAroundBarrierMulti)
+{
+  ParallelLinearAlgebraSharedData data(getDummySystem(), 2);
+
+  splitReduce reduce_0(data, 0);
+  splitReduce reduce_1(data, 1);
+
+  boost::thread t1 = boost::thread(boost::ref(reduce_0));
+  boost::thread t2 = boost::thread(boost::ref(reduce_1));
+  t1.join();
+  t2.join();
+
+  for (auto* reduce : { &reduce_0, &reduce_1 })
+  {
+    EXPECT_EQ(2, reduce->first_[0]);
+    EXPECT_EQ(1, reduce->first_[1]);
+    EXPECT_EQ(20, reduce->second_[0]);
+    EXPECT_EQ(10, reduce->second_[1]);
+  }
+}
@@ -0,0 +1,264 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+
+ The MIT License
+
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <Core/Algorithms/Math/LinearSystem/SolveLinearSystemAlgo.h>
+#include <Core/Algorithms/Math/LinearSystem/Preconditioners.h>
+#include <Core/Algorithms/Math/ParallelAlgebra/ParallelLinearAlgebra.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Thread/Parallel.h>
+
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Thread;
+using namespace SCIRun;
+
+namespace
+{
+  // 7-point Laplacian on an n^3 grid with Dirichlet boundary, plus a varying
+  // reaction term so that the diagonal is not constant
+  SparseRowMatrixHandle laplacian3D(int n)
+  {
+    const int size = n*n*n;
+    std::vector<SparseRowMatrix::Triplet> entries;
+    auto index = [n](int i, int j, int k) { return i + n*(j + n*k); };
+    for (int k = 0; k < n; k++)
+      for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+        {
+          const int row = index(i, j, k);
+          entries.push_back(SparseRowMatrix::Triplet(row, row, 6.0 + 2.0 * (row % 7)));
+          if (i > 0) entries.push_back(SparseRowMatrix::Triplet(row, index(i-1, j, k), -1.0));
+          if (i < n-1) entries.push_back(SparseRowMatrix::Triplet(row, index(i+1, j, k), -1.0));
+          if (j > 0) entries.push_back(SparseRowMatrix::Triplet(row, index(i, j-1, k), -1.0));
+          if (j < n-1) entries.push_back(SparseRowMatrix::Triplet(row, index(i, j+1, k), -1.0));
+          if (k > 0) entries.push_back(SparseRowMatrix::Triplet(row, index(i, j, k-1), -1.0));
+          if (k < n-1) entries.push_back(SparseRowMatrix::Triplet(row, index(i, j, k+1), -1.0));
+        }
+    auto A = boost::make_shared<SparseRowMatrix>(size, size);
+    A->setFromTriplets(entries.begin(), entries.end());
+    A->makeCompressed();
+    return A;
+  }
+
+  DenseColumnMatrixHandle rhs(int size)
+  {
+    auto b = boost::make_shared<DenseColumnMatrix>(size);
+    for (int i = 0; i < size; i++)
+      (*b)[i] = 1.0 + (i % 5);
+    return b;
+  }
+
+  double relativeResidual(const SparseRowMatrix& A, const DenseColumnMatrix& b, const DenseColumnMatrix& x)
+  {
+    DenseColumnMatrix r = b - A * x;
+    return r.norm() / b.norm();
+  }
+
+  double solve(const std::string& method, const std::string& preconditioner, int maxIterations, SparseRowMatrixHandle A, DenseColumnMatrixHandle b)
+  {
+    SolveLinearSystemAlgo algo;
+    algo.set(Variables::MaxIterations, maxIterations);
+    algo.set(Variables::TargetError, 1e-10);
+    algo.setOption(Variables::Method, method);
+    algo.setOption(Variables::Preconditioner, preconditioner);
+    algo.setUpdaterFunc([](double) {});
+
+    DenseColumnMatrixHandle x;
+    EXPECT_TRUE(algo.run(A, b, DenseColumnMatrixHandle(), x));
+    return relativeResidual(*A, *b, *x);
+  }
+}
+
+class PreconditionerTests : public ::testing::TestWithParam<const char*>
+{
+};
+
+TEST_P(PreconditionerTests, ConvergesFasterThanUnpreconditionedCG)
+{
+  auto A = laplacian3D(14);
+  auto b = rhs(A->nrows());
+
+  const int iterations = 12;
+  auto plain = solve("cg", "None", iterations, A, b);
+  auto preconditioned = solve("cg", GetParam(), iterations, A, b);
+
+  EXPECT_LT(preconditioned, plain);
+}
+
+TEST_P(PreconditionerTests, SolvesPoissonProblemWithEachMethod)
+{
+  auto A = laplacian3D(10);
+  auto b = rhs(A->nrows());
+
+  for (auto method : { "cg", "pipecg", "bicg", "minres" })
+    EXPECT_LT(solve(method, GetParam(), 500, A, b), 1e-6) << method;
+}
+
+TEST(PipelinedCGTests, ReturnsTheSameBestIterateAsCG)
+{
+  auto A = laplacian3D(8);
+  auto b = rhs(A->nrows());
+
+  // Both solvers return the iterate with the smallest residual seen, which is
+  // not always the last one when they stop at the iteration limit
+  for (int iterations = 1; iterations < 16; iterations++)
+  {
+    auto cg = solve("cg", "Jacobi", iterations, A, b);
+    auto pipecg = solve("pipecg", "Jacobi", iterations, A, b);
+    EXPECT_NEAR(cg, pipecg, 1e-8 * cg) << iterations;
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(
+  SolveLinearSystemPreconditioners,
+  PreconditionerTests,
+  ::testing::Values("Jacobi", "SymmetricGaussSeidel", "ILU0", "AMG"));
+
+TEST(PreconditionerCacheTests, ReusesPreconditionerUntilMatrixChanges)
+{
+  auto A = laplacian3D(6);
+  SolverInputs system;
+  system.A = A;
+  system.b = rhs(A->nrows());
+  system.x = rhs(A->nrows());
+  system.x0 = rhs(A->nrows());
+
+  PreconditionerCache cache;
+  auto preconditioner = cache.get("ILU0");
+  EXPECT_EQ(preconditioner, cache.get("ILU0"));
+
+  ParallelLinearAlgebraSharedData data(system, 1);
+  ParallelLinearAlgebra pla(data, 0);
+  ParallelLinearAlgebra::ParallelMatrix M;
+  ASSERT_TRUE(pla.add_matrix(A, M));
+
+  preconditioner->setup(pla, M);
+  preconditioner->setup(pla, M);
+  EXPECT_EQ(1, preconditioner->numBuilds());
+
+  A->valuePtr()[0] = 7.0;
+  A->markModified();
+  ASSERT_TRUE(pla.add_matrix(A, M));
+  preconditioner->setup(pla, M);
+  EXPECT_EQ(2, preconditioner->numBuilds());
+
+  // a copy of the matrix is a different matrix
+  auto copy = boost::make_shared<SparseRowMatrix>(*A);
+  ASSERT_TRUE(pla.add_matrix(copy, M));
+  preconditioner->setup(pla, M);
+  EXPECT_EQ(3, preconditioner->numBuilds());
+
+  // writes through the Eigen interface do not bump the generation
+  copy->coeffRef(1, 1) = 9.0;
+  preconditioner->setup(pla, M);
+  EXPECT_EQ(4, preconditioner->numBuilds());
+  preconditioner->setup(pla, M);
+  EXPECT_EQ(4, preconditioner->numBuilds());
+
+  copy->valuePtr()[0] = 8.0;
+  preconditioner->setup(pla, M);
+  EXPECT_EQ(5, preconditioner->numBuilds());
+}
+
+TEST(PreconditionerApplyTests, ILU0IsExactForTridiagonalMatrix)
+{
+  const int size = 50;
+  std::vector<SparseRowMatrix::Triplet> entries;
+  for (int i = 0; i < size; i++)
+  {
+    entries.push_back(SparseRowMatrix::Triplet(i, i, 4.0));
+    if (i > 0) entries.push_back(SparseRowMatrix::Triplet(i, i-1, -1.0));
+    if (i < size-1) entries.push_back(SparseRowMatrix::Triplet(i, i+1, -2.0));
+  }
+  auto A = boost::make_shared<SparseRowMatrix>(size, size);
+  A->setFromTriplets(entries.begin(), entries.end());
+  A->makeCompressed();
+
+  SolverInputs system;
+  system.A = A;
+  system.b = rhs(size);
+  system.x = boost::make_shared<DenseColumnMatrix>(size);
+  system.x0 = rhs(size);
+
+  ParallelLinearAlgebraSharedData data(system, 1);
+  ParallelLinearAlgebra pla(data, 0);
+  ParallelLinearAlgebra::ParallelMatrix M;
+  ParallelLinearAlgebra::ParallelVector r, z;
+  ASSERT_TRUE(pla.add_matrix(A, M));
+  ASSERT_TRUE(pla.add_vector(system.b, r));
+  ASSERT_TRUE(pla.add_vector(system.x, z));
+
+  auto ilu = makePreconditioner("ILU0");
+  ilu->setup(pla, M);
+
+  // no fill-in for a tridiagonal matrix, so M^-1 = A^-1
+  ilu->apply(pla, r, z);
+  EXPECT_LT(relativeResidual(*A, *system.b, *system.x), 1e-12);
+
+  ilu->applyTranspose(pla, r, z);
+  DenseColumnMatrix residual = *system.b - SparseRowMatrix(A->transpose()) * *system.x;
+  EXPECT_LT(residual.norm() / system.b->norm(), 1e-12);
+}
+
+TEST(PreconditionerApplyTests, AMGBuiltOnSeveralThreadsReducesTheResidual)
+{
+  auto A = laplacian3D(12);
+  const int size = A->nrows();
+
+  // Each thread aggregates its own rows, so the hierarchy depends on the number
+  // of threads, but the V-cycle should work about as well
+  for (int nproc : { 1, 3 })
+  {
+    SolverInputs system;
+    system.A = A;
+    system.b = rhs(size);
+    system.x = boost::make_shared<DenseColumnMatrix>(size);
+    system.x0 = rhs(size);
+
+    ParallelLinearAlgebraSharedData data(system, nproc);
+    auto amg = makePreconditioner("AMG");
+    Parallel::RunTasks([&](int proc)
+    {
+      ParallelLinearAlgebra pla(data, proc);
+      ParallelLinearAlgebra::ParallelMatrix M;
+      ParallelLinearAlgebra::ParallelVector r, z;
+      pla.add_matrix(A, M);
+      pla.add_vector(system.b, r);
+      pla.add_vector(system.x, z);
+      amg->setup(pla, M);
+      amg->apply(pla, r, z);
+    }, nproc);
+
+    EXPECT_LT(relativeResidual(*A, *system.b, *system.x), 0.5) << nproc;
+  }
+}
@@ -0,0 +1,187 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+
+ The MIT License
+
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+#include <Core/Algorithms/Math/ParallelAlgebra/SlicedEllpackMatrix.h>
+#include <Core/Algorithms/Math/ParallelAlgebra/ParallelLinearAlgebra.h>
+#include <Core/Algorithms/Math/LinearSystem/SolveLinearSystemAlgo.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Datatypes/DenseColumnMatrix.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun;
+
+namespace
+{
+  // Rows of very different lengths, including empty ones, so chunks need padding
+  SparseRowMatrixHandle irregularMatrix(int rows, int columns)
+  {
+    std::vector<SparseRowMatrix::Triplet> entries;
+    for (int i = 0; i < rows; i++)
+    {
+      const int length = (i % 11 == 0) ? 0 : 1 + (i * 7) % 23;
+      for (int k = 0; k < length; k++)
+        entries.push_back(SparseRowMatrix::Triplet(i, (i * 13 + k * 97) % columns, 1.0 + 0.01 * i - 0.5 * k));
+    }
+    auto A = boost::make_shared<SparseRowMatrix>(rows, columns);
+    A->setFromTriplets(entries.begin(), entries.end());
+    A->makeCompressed();
+    return A;
+  }
+
+  DenseColumnMatrix testVector(int size)
+  {
+    DenseColumnMatrix x(size);
+    for (int i = 0; i < size; i++)
+      x[i] = std::cos(0.1 * i);
+    return x;
+  }
+
+  std::vector<SlicedEllpackMatrix::Kernel> supportedKernels()
+  {
+    std::vector<SlicedEllpackMatrix::Kernel> kernels;
+    for (auto k : { SlicedEllpackMatrix::Kernel::Scalar, SlicedEllpackMatrix::Kernel::AVX2, SlicedEllpackMatrix::Kernel::AVX512 })
+      if (SlicedEllpackMatrix::supports(k))
+        kernels.push_back(k);
+    return kernels;
+  }
+}
+
+TEST(SlicedEllpackMatrixTests, MatchesCSRProductWithEveryKernel)
+{
+  auto A = irregularMatrix(1003, 950);
+  auto x = testVector(950);
+  DenseColumnMatrix expected = *A * x;
+
+  SlicedEllpackMatrix sliced(A->outerIndexPtr(), A->innerIndexPtr(), A->valuePtr(), 0, A->nrows(), A->ncols());
+  EXPECT_TRUE(sliced.compressedIndices());
+  EXPECT_GE(sliced.storedEntries(), static_cast<size_t>(A->nonZeros()));
+
+  for (auto kernel : supportedKernels())
+  {
+    DenseColumnMatrix y(A->nrows());
+    y.setConstant(-99);
+    sliced.multiply(x.data(), y.data(), kernel);
+    EXPECT_LT((y - expected).norm(), 1e-12 * expected.norm()) << SlicedEllpackMatrix::kernelName(kernel);
+  }
+}
+
+TEST(SlicedEllpackMatrixTests, OnlyWritesOwnRows)
+{
+  auto A = irregularMatrix(500, 500);
+  auto x = testVector(500);
+  DenseColumnMatrix expected = *A * x;
+
+  const size_t begin = 123, end = 377;
+  SlicedEllpackMatrix sliced(A->outerIndexPtr(), A->innerIndexPtr(), A->valuePtr(), begin, end, A->ncols(), 16);
+  EXPECT_EQ(end - begin, sliced.numRows());
+
+  DenseColumnMatrix y(A->nrows());
+  y.setConstant(-99);
+  sliced.multiply(x.data(), y.data());
+  for (size_t i = 0; i < 500; i++)
+  {
+    if (i < begin || i >= end)
+      EXPECT_EQ(-99, y[i]) << i;
+    else
+      EXPECT_NEAR(expected[i], y[i], 1e-12) << i;
+  }
+}
+
+TEST(SlicedEllpackMatrixTests, Uses64BitIndicesForHugeColumnCounts)
+{
+  auto A = irregularMatrix(100, 100);
+  auto x = testVector(100);
+  DenseColumnMatrix expected = *A * x;
+
+  // Only the column count decides the index width
+  SlicedEllpackMatrix sliced(A->outerIndexPtr(), A->innerIndexPtr(), A->valuePtr(), 0, 100, size_t(1) << 31);
+  EXPECT_FALSE(sliced.compressedIndices());
+
+  DenseColumnMatrix y(100);
+  sliced.multiply(x.data(), y.data());
+  EXPECT_LT((y - expected).norm(), 1e-12 * expected.norm());
+}
+
+TEST(SlicedEllpackMatrixTests, ParallelLinearAlgebraMultUsesSlicedCopy)
+{
+  auto A = irregularMatrix(300, 300);
+  SolverInputs system;
+  system.A = A;
+  system.b = boost::make_shared<DenseColumnMatrix>(testVector(300));
+  system.x = boost::make_shared<DenseColumnMatrix>(300);
+  system.x0 = system.b;
+
+  ParallelLinearAlgebraSharedData data(system, 1);
+  ParallelLinearAlgebra PLA(data, 0);
+  ParallelLinearAlgebra::ParallelMatrix M;
+  ParallelLinearAlgebra::ParallelVector b, x;
+  ASSERT_TRUE(PLA.add_matrix(A, M));
+  ASSERT_TRUE(PLA.add_vector(system.b, b));
+  ASSERT_TRUE(PLA.add_vector(system.x, x));
+
+  PLA.build_sliced_ellpack(M);
+  ASSERT_TRUE(M.sliced_ != nullptr);
+  PLA.mult(M, b, x);
+
+  DenseColumnMatrix expected = *A * *system.b;
+  EXPECT_LT((*system.x - expected).norm(), 1e-12 * expected.norm());
+}
+
+TEST(SlicedEllpackMatrixTests, SolverGivesSameSolutionWithEitherFormat)
+{
+  const int n = 400;
+  std::vector<SparseRowMatrix::Triplet> entries;
+  for (int i = 0; i < n; i++)
+  {
+    entries.push_back(SparseRowMatrix::Triplet(i, i, 4.0 + (i % 3)));
+    if (i > 0) entries.push_back(SparseRowMatrix::Triplet(i, i-1, -1.0));
+    if (i < n-1) entries.push_back(SparseRowMatrix::Triplet(i, i+1, -1.0));
+    if (i >= 20) entries.push_back(SparseRowMatrix::Triplet(i, i-20, -1.0));
+    if (i < n-20) entries.push_back(SparseRowMatrix::Triplet(i, i+20, -1.0));
+  }
+  auto A = boost::make_shared<SparseRowMatrix>(n, n);
+  A->setFromTriplets(entries.begin(), entries.end());
+  A->makeCompressed();
+  auto b = boost::make_shared<DenseColumnMatrix>(testVector(n));
+
+  DenseColumnMatrixHandle csr, sell;
+  for (auto format : { "CSR", "SELL" })
+  {
+    SolveLinearSystemAlgo algo;
+    algo.set(Variables::TargetError, 1e-10);
+    algo.setOption(Variables::Method, "cg");
+    algo.setOption(Parameters::SparseFormat, format);
+    algo.setUpdaterFunc([](double) {});
+    ASSERT_TRUE(algo.run(A, b, DenseColumnMatrixHandle(), std::string(format) == "CSR" ? csr : sell));
+  }
+  EXPECT_LT((*csr - *sell).norm(), 1e-8 * csr->norm());
+}
@@ -35,9 +35,11 @@
 #include <Core/Algorithms/Factory/HardCodedAlgorithmFactory.h>
 #include <Dataflow/State/SimpleMapModuleState.h>
 #include <Dataflow/Network/ModuleReexecutionStrategies.h>
+#include <Dataflow/Network/ModuleOutputCache.h>
 #include <Dataflow/Engine/Scheduler/DesktopExecutionStrategyFactory.h>
 #include <Core/Command/GlobalCommandBuilderFromCommandLine.h>
 #include <Core/Logging/Log.h>
+#include <Core/Logging/Profiler.h>
 #include <Core/Logging/ApplicationHelper.h>
 #include <Core/IEPlugin/IEPluginInit.h>
 #include <Core/Utils/Exception.h>
@@ -160,6 +162,23 @@ void Application::readCommandLine(int argc, const char* argv[])
     auto maxCoresOption = private_->parameters_->developerParameters()->maxCores();
     if (maxCoresOption)
       Thread::Parallel::SetMaximumCores(*maxCoresOption);
+
+    auto outputCacheOption = private_->parameters_->developerParameters()->outputCacheDirectory();
+    if (outputCacheOption)
+    {
+      ModuleOutputCache::Settings settings;
+      settings.enabled = true;
+      settings.directory = *outputCacheOption;
+      ModuleOutputCache::Instance().configure(settings);
+    }
+
+    auto profileOption = private_->parameters_->developerParameters()->profileFile();
+    if (profileOption)
+    {
+      // headless runs leave through exit(), so the trace is written on the way out
+      Profiler::Instance().start(*profileOption);
+      std::atexit([] { Profiler::Instance().stop(); });
+    }
       
     LogSettings::Instance().setVerbose(parameters()->verboseMode());
   }
@@ -68,6 +68,8 @@ public:
       //("frameInitLimit", po::value<int>(), "ViewScene frame init limit--increase if renderer fails")
       ("guiExpandFactor", po::value<double>(), "Expansion factor for high resolution displays")
       ("max-cores", po::value<unsigned int>(), "Limit the number of cores used by multithreaded algorithms")
+      ("output-cache", po::value<std::string>(), "Reuse outputs of memoizable modules, cached in the given directory")
+      ("profile", po::value<std::string>(), "Record a Chrome trace of module executions to the given file, or flame graph stacks if it ends in .folded")
       ("list-modules", "print list of available modules")
       ;
 
@@ -117,9 +119,12 @@ public:
     const boost::optional<int>& frameInitLimit,
     const boost::optional<int>& regressionTimeout,
     const boost::optional<unsigned int>& maxCores,
-    const boost::optional<double>& guiExpandFactor
+    const boost::optional<double>& guiExpandFactor,
+    const boost::optional<std::string>& outputCacheDirectory,
+    const boost::optional<std::string>& profileFile
     ) : threadMode_(threadMode), reexecuteMode_(reexecuteMode), frameInitLimit_(frameInitLimit),
-    regressionTimeout_(regressionTimeout), maxCores_(maxCores), guiExpandFactor_(guiExpandFactor)
+    regressionTimeout_(regressionTimeout), maxCores_(maxCores), guiExpandFactor_(guiExpandFactor),
+    outputCacheDirectory_(outputCacheDirectory), profileFile_(profileFile)
   {}
   boost::optional<int> regressionTimeoutSeconds() const override
   {
@@ -145,8 +150,16 @@ public:
   {
     return guiExpandFactor_;
   }
+  boost::optional<std::string> outputCacheDirectory() const override
+  {
+    return outputCacheDirectory_;
+  }
+  boost::optional<std::string> profileFile() const override
+  {
+    return profileFile_;
+  }
 private:
-  boost::optional<std::string> threadMode_, reexecuteMode_;
+  boost::optional<std::string> threadMode_, reexecuteMode_, outputCacheDirectory_, profileFile_;
   boost::optional<int> frameInitLimit_, regressionTimeout_;
   boost::optional<unsigned int> maxCores_;
   boost::optional<double> guiExpandFactor_;
@@ -342,7 +355,9 @@ ApplicationParametersHandle CommandLineParser::parse(int argc, const char* argv[
         parseOptionalArg<int>(parsed, "frameInitLimit"),
         parseOptionalArg<int>(parsed, "regression"),
         parseOptionalArg<unsigned int>(parsed, "max-cores"),
-        parseOptionalArg<double>(parsed, "guiExpandFactor")
+        parseOptionalArg<double>(parsed, "guiExpandFactor"),
+        parseOptionalArg<std::string>(parsed, "output-cache"),
+        parseOptionalArg<std::string>(parsed, "profile")
       ),
       ApplicationParametersImpl::Flags(
         parsed.count("help") != 0,
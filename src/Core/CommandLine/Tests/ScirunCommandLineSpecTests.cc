@@ -57,6 +57,11 @@ TEST(ScirunCommandLineSpecTest, CanReadBasicOptions)
     "  --guiExpandFactor arg   Expansion factor for high resolution displays\n"
     "  --max-cores arg         Limit the number of cores used by multithreaded \n"
     "                          algorithms\n"
+    "  --output-cache arg      Reuse outputs of memoizable modules, cached in the \n"
+    "                          given directory\n"
+    "  --profile arg           Record a Chrome trace of module executions to the \n"
+    "                          given file, or flame graph stacks if it ends in \n"
+    "                          .folded\n"
     "  --list-modules          print list of available modules\n";
 
   EXPECT_EQ(expectedHelp, parser.describe());
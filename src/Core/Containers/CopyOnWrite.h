@@ -0,0 +1,103 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+///
+///@file   CopyOnWrite.h
+///@brief  Holder for data that is shared between copies until one of them
+///        is modified.
+///
+/// Copying a CopyOnWrite only copies a reference to the data. Read access
+/// through get() never copies. Write access through mutate() first makes a
+/// private copy if any other holder still refers to the same data. Fields use
+/// this for their values, so that a clone of a field shares them with the
+/// original until either one is changed.
+///
+/// A holder is not safe to unshare from several threads at once. Code that
+/// writes to a holder in parallel calls mutate() once before the threads
+/// start.
+///
+
+#ifndef CORE_CONTAINERS_COPYONWRITE_H
+#define CORE_CONTAINERS_COPYONWRITE_H 1
+
+#include <utility>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <Core/Persistent/Persistent.h>
+
+namespace SCIRun {
+
+template <class T>
+class CopyOnWrite
+{
+public:
+  typedef T data_type;
+
+  CopyOnWrite() : data_(boost::make_shared<T>()) {}
+  CopyOnWrite(const T& data) : data_(boost::make_shared<T>(data)) {}
+
+  /// Read access, never copies the data
+  const T& get() const { return *data_; }
+
+  /// Read access to the elements of containers
+  template <class I>
+  auto operator[](const I& i) const -> decltype(std::declval<const T&>()[i]) { return get()[i]; }
+  template <class... I>
+  auto operator()(const I&... i) const -> decltype(std::declval<const T&>()(i...)) { return get()(i...); }
+
+  /// Write access. The reference is valid until this holder is copied or
+  /// assigned to.
+  T& mutate()
+  {
+    if (!data_.unique())
+      data_ = boost::make_shared<T>(*data_);
+    return *data_;
+  }
+
+  /// Whether another holder still refers to the same data
+  bool shared() const { return !data_.unique(); }
+
+  /// Replace the data without copying the old data first
+  void reset(const T& data = T()) { data_ = boost::make_shared<T>(data); }
+
+private:
+  boost::shared_ptr<T> data_;
+};
+
+template <class T>
+void Pio(Piostream& stream, CopyOnWrite<T>& data)
+{
+  if (stream.reading())
+    Pio(stream, data.mutate());
+  else
+    Pio(stream, const_cast<T&>(data.get()));
+}
+
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+///
+///@file   CopyOnWriteVector.h
+///@brief  std::vector whose storage is shared between copies until one
+///        of them is modified.
+///
+/// A CopyOnWrite holder for a std::vector, with the const part of the vector
+/// interface and the few modifiers that meshes use. Meshes keep their points
+/// and connectivity in these, so that a copy of a mesh whose nodes are moved
+/// does not duplicate its elements, and a copy whose elements are changed
+/// does not duplicate its nodes.
+///
+
+#ifndef CORE_CONTAINERS_COPYONWRITEVECTOR_H
+#define CORE_CONTAINERS_COPYONWRITEVECTOR_H 1
+
+#include <vector>
+#include <Core/Containers/CopyOnWrite.h>
+#include <Core/Persistent/PersistentSTL.h>
+
+namespace SCIRun {
+
+template <class T>
+class CopyOnWriteVector : public CopyOnWrite<std::vector<T> >
+{
+public:
+  typedef CopyOnWrite<std::vector<T> >            base_type;
+  typedef std::vector<T>                          vector_type;
+  typedef typename vector_type::value_type        value_type;
+  typedef typename vector_type::size_type         size_type;
+  typedef typename vector_type::const_reference   const_reference;
+  typedef typename vector_type::const_iterator    const_iterator;
+
+  using base_type::get;
+  using base_type::mutate;
+  using base_type::shared;
+
+  CopyOnWriteVector() {}
+  explicit CopyOnWriteVector(size_type n) : base_type(vector_type(n)) {}
+  CopyOnWriteVector(const vector_type& data) : base_type(data) {}
+
+  /// Read access, never copies the storage
+  const_reference operator[](size_type i) const { return get()[i]; }
+  const_reference front() const { return get().front(); }
+  const_reference back() const { return get().back(); }
+  const_iterator begin() const { return get().begin(); }
+  const_iterator end() const { return get().end(); }
+  size_type size() const { return get().size(); }
+  size_type capacity() const { return get().capacity(); }
+  bool empty() const { return get().empty(); }
+
+  void resize(size_type n) { if (n != size()) mutate().resize(n); }
+  void reserve(size_type n) { if (n > capacity()) mutate().reserve(n); }
+  void push_back(const value_type& v) { mutate().push_back(v); }
+
+  /// Drop the data without copying it first
+  void clear() { if (shared()) base_type::reset(); else mutate().clear(); }
+};
+
+inline void Pio_index(Piostream& stream, CopyOnWriteVector<index_type>& data)
+{
+  if (stream.reading())
+    Pio_index(stream, data.mutate());
+  else
+    Pio_index(stream, const_cast<std::vector<index_type>&>(data.get()));
+}
+
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Containers/CopyOnWriteVector.h>
+#include <Core/Containers/Array2.h>
+
+using namespace SCIRun;
+
+TEST(CopyOnWriteVectorTest, CopiesShareStorage)
+{
+  CopyOnWriteVector<int> a(5);
+  EXPECT_FALSE(a.shared());
+
+  CopyOnWriteVector<int> b = a;
+  EXPECT_TRUE(a.shared());
+  EXPECT_TRUE(b.shared());
+  EXPECT_EQ(&a[0], &b[0]);
+}
+
+TEST(CopyOnWriteVectorTest, MutateCopiesOnlySharedStorage)
+{
+  CopyOnWriteVector<int> a(3);
+  a.mutate()[0] = 1;
+  const int* storage = &a[0];
+  a.mutate()[1] = 2;
+  EXPECT_EQ(storage, &a[0]);
+
+  CopyOnWriteVector<int> b = a;
+  b.mutate()[2] = 3;
+  EXPECT_NE(&a[0], &b[0]);
+  EXPECT_FALSE(a.shared());
+  EXPECT_FALSE(b.shared());
+
+  EXPECT_EQ(std::vector<int>({ 1, 2, 0 }), a.get());
+  EXPECT_EQ(std::vector<int>({ 1, 2, 3 }), b.get());
+}
+
+TEST(CopyOnWriteVectorTest, GrowingACopyLeavesTheOriginal)
+{
+  CopyOnWriteVector<int> a;
+  a.push_back(7);
+  CopyOnWriteVector<int> b = a;
+  b.push_back(a[0]);
+  b.resize(4);
+
+  EXPECT_EQ(1u, a.size());
+  EXPECT_EQ(std::vector<int>({ 7, 7, 0, 0 }), b.get());
+}
+
+TEST(CopyOnWriteVectorTest, ClearDoesNotCopy)
+{
+  CopyOnWriteVector<int> a(std::vector<int>({ 1, 2, 3 }));
+  CopyOnWriteVector<int> b = a;
+  b.clear();
+  EXPECT_TRUE(b.empty());
+  EXPECT_FALSE(a.shared());
+  EXPECT_EQ(3u, a.size());
+}
+
+TEST(CopyOnWriteVectorTest, HolderSharesAnyTypeUntilWritten)
+{
+  CopyOnWrite<Array2<double> > a(Array2<double>(2, 3));
+  a.mutate()(1, 2) = 4.0;
+  CopyOnWrite<Array2<double> > b = a;
+  EXPECT_EQ(&a.get()(0, 0), &b.get()(0, 0));
+
+  b.mutate()(1, 2) = 5.0;
+  EXPECT_FALSE(a.shared());
+  EXPECT_EQ(4.0, a.get()(1, 2));
+  EXPECT_EQ(5.0, b.get()(1, 2));
+}
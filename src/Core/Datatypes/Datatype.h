@@ -58,6 +58,9 @@ namespace Datatypes {
     virtual Datatype* clone() const = 0;
 
     virtual std::string dynamic_type_name() const = 0;
+
+    /// Approximate memory held by the data, as reported by the profiler; 0 if unknown.
+    virtual size_t sizeInBytes() const { return 0; }
   };
 
 }}}
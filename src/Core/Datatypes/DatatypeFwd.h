@@ -52,11 +52,13 @@ namespace Datatypes {
   class GeometryObject;
   class ColorMap;
   class Bundle;
+  class MatrixStream;
 
   typedef SharedPointer<String> StringHandle;
   typedef SharedPointer<GeometryObject> GeometryBaseHandle;
   typedef SharedPointer<ColorMap> ColorMapHandle;
   typedef SharedPointer<Bundle> BundleHandle;
+  typedef SharedPointer<MatrixStream> MatrixStreamHandle;
 }}
 
   class Field;
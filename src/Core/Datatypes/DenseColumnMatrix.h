@@ -75,6 +75,7 @@ namespace Datatypes {
 
     virtual size_t nrows() const override { return this->rows(); }
     virtual size_t ncols() const override { return this->cols(); }
+    virtual size_t sizeInBytes() const override { return this->size() * sizeof(T); }
     virtual T get(int i, int j) const override
     {
       return (*this)(i,j);
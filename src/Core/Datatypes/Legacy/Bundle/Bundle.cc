@@ -593,6 +593,15 @@ size_t Bundle::size() const
   return bundle_.size();
 }
 
+size_t Bundle::sizeInBytes() const
+{
+  size_t bytes = 0;
+  for (const auto& entry : bundle_)
+    if (entry.second)
+      bytes += entry.second->sizeInBytes();
+  return bytes;
+}
+
 void Bundle::set(const std::string& name, DatatypeHandle data)
 {
   bundle_[name] = data;
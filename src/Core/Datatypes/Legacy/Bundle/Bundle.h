@@ -50,6 +50,7 @@ class SCISHARE Bundle : public Datatype
 
     bool empty() const;
     size_t size() const;
+    virtual size_t sizeInBytes() const override;
 
     DatatypeHandle get(const std::string& name) const;
     void set(const std::string& name, DatatypeHandle data);
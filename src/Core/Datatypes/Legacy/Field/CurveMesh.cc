@@ -97,7 +97,8 @@ public:
                          VMesh::Edge::index_type);
 
 
-  virtual VMesh::index_type* get_elems_pointer() const;
+  virtual VMesh::index_type* mutable_elems_pointer();
+  virtual const VMesh::index_type* get_elems_pointer() const;
 };
 
 
@@ -281,10 +282,19 @@ VCurveMesh<MESH>::set_nodes(VMesh::Node::array_type& nodes,
 template <class MESH>
 VMesh::index_type*
 VCurveMesh<MESH>::
+mutable_elems_pointer()
+{
+  if (this->mesh_->edges_.size() == 0) return (0);
+  return (&(this->mesh_->edges_.mutate()[0]));
+}
+
+template <class MESH>
+const VMesh::index_type*
+VCurveMesh<MESH>::
 get_elems_pointer() const
 {
   if (this->mesh_->edges_.size() == 0) return (0);
-   return (&(this->mesh_->edges_[0]));
+  return (&(this->mesh_->edges_[0]));
 }
 
 } // end namespace
@@ -30,6 +30,8 @@
 
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/GeometryPrimitives/Tensor.h>
 #include <Core/Datatypes/Legacy/Base/PropertyManager.h>
 #include <Core/Utils/Legacy/Debug.h>
 #include <Core/Thread/Mutex.h>
@@ -53,6 +55,42 @@ Field::~Field()
   DEBUG_DESTRUCTOR("Field")  
 }
 
+namespace
+{
+  size_t valueSize(VField* field)
+  {
+    if (field->is_vector())
+      return sizeof(Core::Geometry::Vector);
+    if (field->is_tensor())
+      return sizeof(Core::Geometry::Tensor);
+    if (field->is_char() || field->is_unsigned_char())
+      return 1;
+    if (field->is_short() || field->is_unsigned_short())
+      return 2;
+    if (field->is_int() || field->is_unsigned_int() || field->is_float())
+      return 4;
+    if (field->is_complex_double())
+      return 2 * sizeof(double);
+    return sizeof(double);
+  }
+}
+
+size_t Field::sizeInBytes() const
+{
+  size_t bytes = 0;
+  auto mesh = vmesh();
+  if (mesh && !mesh->is_regularmesh())
+  {
+    bytes += mesh->num_nodes() * sizeof(Core::Geometry::Point);
+    if (mesh->is_unstructuredmesh())
+      bytes += mesh->num_elems() * mesh->num_nodes_per_elem() * sizeof(VMesh::index_type);
+  }
+  auto field = vfield();
+  if (field)
+    bytes += field->num_values() * valueSize(field);
+  return bytes;
+}
+
 const int FIELD_VERSION = 3;
 
 void 
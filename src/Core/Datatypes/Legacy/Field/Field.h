@@ -59,6 +59,9 @@ class SCISHARE Field : public Core::Datatypes::Datatype, public Core::Datatypes:
     virtual VMesh* vmesh()   const = 0;
     virtual VField* vfield() const = 0;
 
+    /// Points and connectivity of the mesh plus the field values; regular meshes store neither.
+    virtual size_t sizeInBytes() const override;
+
 #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
     /// Detach the mesh from the field, if needed make a new copy of it.
     // NOTE: IF THIS FUNCTION IS CALLED IN LEGACY CODE, IT MUST BE CONVERTED TO A deep_clone CALL ON THE FIELD OBJECT
@@ -52,6 +52,17 @@
 
 namespace SCIRun {
 
+/// The field values are held as the container that VFData works on, in a
+/// CopyOnWrite so that clones of a field share them until either is changed.
+template <class FData>
+struct FDataStorage { typedef FData type; };
+
+template <class T, class MESH>
+struct FDataStorage<FData2d<T,MESH> > { typedef Array2<T> type; };
+
+template <class T, class MESH>
+struct FDataStorage<FData3d<T,MESH> > { typedef Array3<T> type; };
+
 template <class Mesh, class Basis, class FData>
 class GenericField: public Field 
 {
@@ -77,9 +88,11 @@ public:
 
   /// Clone the field data, but not the mesh.
   /// Use mesh_detach() first to clone the complete field
+  /// The data is only copied once either field changes it.
   virtual GenericField<Mesh, Basis, FData> *clone() const;
 
-  /// Clone everything, field data and mesh.
+  /// Clone everything, field data and mesh. As with clone(), the arrays are
+  /// only copied once they are changed.
   virtual GenericField<Mesh, Basis, FData> *deep_clone() const;
 
   /// Obtain a Handle to the Mesh
@@ -133,8 +146,8 @@ protected:
 
   /// A (generic) mesh.
   mesh_handle_type             mesh_;
-  /// Data container.
-  fdata_type                   fdata_;
+  /// Data container, shared with clones of this field until either changes it.
+  CopyOnWrite<typename FDataStorage<FData>::type> fdata_;
   Basis                        basis_;
   
   VField*                      vfield_;
@@ -276,7 +289,6 @@ template <class Mesh, class Basis, class FData>
 GenericField<Mesh, Basis, FData>::GenericField() : 
   Field(),
   mesh_(mesh_handle_type(new mesh_type())),
-  fdata_(0),
   vfield_(0),
   basis_order_(0),
   mesh_dimensionality_(-1)
@@ -316,7 +328,6 @@ template <class Mesh, class Basis, class FData>
 GenericField<Mesh, Basis, FData>::GenericField(mesh_handle_type mesh) : 
   Field(),
   mesh_(mesh),
-  fdata_(0),
   vfield_(0),
   basis_order_(0),
   mesh_dimensionality_(-1)
@@ -468,20 +479,6 @@ GenericField<Mesh, Basis, FData>::get_type_description(td_info_e td) const
   };
 }
 
-/// These ended up here, due to the problem with the include order in get_typedescription.
-/// Once we have dismanteled that system this can go back to VFData
-template<class T, class MESH>
-inline VFData* CreateVFData(FData2d<T,MESH>& fdata, std::vector<T>& lfdata, std::vector<std::vector<T> >& hfdata)
-{
-  return (CreateVFData(static_cast<Array2<T>& >(fdata),lfdata,hfdata));
-}
-
-template<class T, class MESH>
-inline VFData* CreateVFData(FData3d<T,MESH>& fdata, std::vector<T>& lfdata, std::vector<std::vector<T> >& hfdata)
-{
-  return (CreateVFData(static_cast<Array3<T>& >(fdata),lfdata,hfdata));
-}
-
 } // end namespace SCIRun
 
 
@@ -35,6 +35,7 @@
 #include <Core/Datatypes/Legacy/Field/MeshSupport.h>
 
 #include <Core/Containers/StackVector.h>
+#include <Core/Containers/CopyOnWriteVector.h>
 
 #include <Core/GeometryPrimitives/SearchGridT.h>
 #include <Core/GeometryPrimitives/BBox.h>
@@ -52,6 +53,7 @@
 #include <Core/Datatypes/Legacy/Field/FieldIterator.h>
 #include <Core/Datatypes/Legacy/Field/FieldRNG.h>
 #include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/SortedTopologyBuilder.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Mesh/VirtualMeshFacade.h>
 
@@ -714,7 +716,7 @@ public:
   void get_point(Core::Geometry::Point &result, typename Node::index_type index) const
   { result = points_[index]; }
   void set_point(const Core::Geometry::Point &point, typename Node::index_type index)
-  { points_[index] = point; }
+  { points_.mutate()[index] = point; }
   void get_random_point(Core::Geometry::Point &p, typename Elem::index_type i, FieldRNG &r) const;
 
   /// Normals for visualizations
@@ -1544,8 +1546,10 @@ public:
 				    const Core::Geometry::Point &p3, const Core::Geometry::Point &p4, const Core::Geometry::Point &p5,
 				    const Core::Geometry::Point &p6, const Core::Geometry::Point &p7);
 
-  /// must detach, if altering points!
-  std::vector<Core::Geometry::Point>& get_points() { return points_; }
+  /// The points are shared with copies of this mesh until either one
+  /// changes them, which only mutable_points() may do.
+  const std::vector<Core::Geometry::Point>& get_points() const { return points_.get(); }
+  std::vector<Core::Geometry::Point>& mutable_points() { return points_.mutate(); }
 
   int compute_checksum();
 
@@ -1655,25 +1659,25 @@ protected:
     {
       PEdgeNode e(n0, n1);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(edge_table_.find(e))).second));
+                                            find_edge(e)));
     }
     if (n1 != n2)
     {
       PEdgeNode e(n1, n2);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(edge_table_.find(e))).second));
+                                            find_edge(e)));
     }
     if (n2 != n3)
     {
       PEdgeNode e(n2, n3);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(edge_table_.find(e))).second));
+                                            find_edge(e)));
     }
     if (n3 != n0)
     {
       PEdgeNode e(n3, n0);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(edge_table_.find(e))).second));
+                                            find_edge(e)));
     }
   }
 
@@ -1690,31 +1694,31 @@ protected:
 
     int i = 0;
     n1 = cells_[off    ]; n2 = cells_[off + 1];
-    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(edge_table_.find(e)->second); }
+    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(find_edge(e)); }
     n1 = cells_[off + 1]; n2 = cells_[off + 2];
-    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(edge_table_.find(e)->second); }
+    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(find_edge(e)); }
     n1 = cells_[off + 2]; n2 = cells_[off + 3];
-    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(edge_table_.find(e)->second); }
+    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(find_edge(e)); }
     n1 = cells_[off + 3]; n2 = cells_[off   ];
-    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(edge_table_.find(e)->second); }
+    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(find_edge(e)); }
 
     n1 = cells_[off + 4]; n2 = cells_[off + 5];
-    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(edge_table_.find(e)->second); }
+    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(find_edge(e)); }
     n1 = cells_[off + 5]; n2 = cells_[off + 6];
-    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(edge_table_.find(e)->second); }
+    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(find_edge(e)); }
     n1 = cells_[off + 6]; n2 = cells_[off + 7];
-    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(edge_table_.find(e)->second); }
+    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(find_edge(e)); }
     n1 = cells_[off + 7]; n2 = cells_[off + 4];
-    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(edge_table_.find(e)->second); }
+    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(find_edge(e)); }
 
     n1 = cells_[off    ]; n2 = cells_[off + 4];
-    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(edge_table_.find(e)->second); }
+    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(find_edge(e)); }
     n1 = cells_[off + 5]; n2 = cells_[off + 1];
-    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(edge_table_.find(e)->second); }
+    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(find_edge(e)); }
     n1 = cells_[off + 2]; n2 = cells_[off + 6];
-    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(edge_table_.find(e)->second); }
+    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(find_edge(e)); }
     n1 = cells_[off + 7]; n2 = cells_[off + 3];
-    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(edge_table_.find(e)->second); }
+    if (n1 != n2) { PEdgeNode e(n1,n2); array[i++] = static_cast<typename ARRAY::value_type>(find_edge(e)); }
   }
 
   template<class ARRAY, class INDEX>
@@ -1744,7 +1748,7 @@ protected:
     {
       PFaceNode f(n1,n2,n3,n4);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(face_table_.find(f))).second));
+                                            find_face(f)));
     }
     n1 = cells_[off + 7]; n2 = cells_[off + 6];
     n3 = cells_[off + 5]; n4 = cells_[off + 4];
@@ -1752,7 +1756,7 @@ protected:
     {
       PFaceNode f(n1,n2,n3,n4);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(face_table_.find(f))).second));
+                                            find_face(f)));
     }
     n1 = cells_[off    ]; n2 = cells_[off + 4];
     n3 = cells_[off + 5]; n4 = cells_[off + 1];
@@ -1760,7 +1764,7 @@ protected:
     {
       PFaceNode f(n1,n2,n3,n4);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(face_table_.find(f))).second));
+                                            find_face(f)));
     }
     n1 = cells_[off + 2]; n2 = cells_[off + 6];
     n3 = cells_[off + 7]; n4 = cells_[off + 3];
@@ -1768,7 +1772,7 @@ protected:
     {
       PFaceNode f(n1,n2,n3,n4);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(face_table_.find(f))).second));
+                                            find_face(f)));
     }
     n1 = cells_[off + 3]; n2 = cells_[off + 7];
     n3 = cells_[off + 4]; n4 = cells_[off    ];
@@ -1776,7 +1780,7 @@ protected:
     {
       PFaceNode f(n1,n2,n3,n4);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(face_table_.find(f))).second));
+                                            find_face(f)));
     }
     n1 = cells_[off + 1]; n2 = cells_[off + 5];
     n3 = cells_[off + 6]; n4 = cells_[off + 2];
@@ -1784,7 +1788,7 @@ protected:
     {
       PFaceNode f(n1,n2,n3,n4);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(face_table_.find(f))).second));
+                                            find_face(f)));
     }
   }
 
@@ -1822,19 +1826,19 @@ protected:
       const int *offset = HexVolEdgePerNodeTable[node_index];
 
       PEdgeNode e(cells_[cell_index+offset[0]],cells_[cell_index+offset[1]]);
-      typename edge_nt::const_iterator iter = edge_table_.find(e);
-      if (((edges_[iter->second].cells_[0])&(~0xf))==(cell_index<<1) )
-        array.push_back(typename ARRAY::value_type(iter->second));
+      index_type eidx = find_edge(e);
+      if (((edges_[eidx].cells_[0])&(~0xf))==(cell_index<<1) )
+        array.push_back(typename ARRAY::value_type(eidx));
 
       PEdgeNode e1(cells_[cell_index+offset[2]],cells_[cell_index+offset[3]]);
-      iter = edge_table_.find(e1);
-      if (((edges_[iter->second].cells_[0])&(~0xf))==(cell_index<<1) )
-        array.push_back(typename ARRAY::value_type(iter->second));
+      eidx = find_edge(e1);
+      if (((edges_[eidx].cells_[0])&(~0xf))==(cell_index<<1) )
+        array.push_back(typename ARRAY::value_type(eidx));
 
       PEdgeNode e2(cells_[cell_index+offset[4]],cells_[cell_index+offset[5]]);
-      iter = edge_table_.find(e2);
-      if (((edges_[iter->second].cells_[0])&(~0xf))==(cell_index<<1) )
-        array.push_back(typename ARRAY::value_type(iter->second));
+      eidx = find_edge(e2);
+      if (((edges_[eidx].cells_[0])&(~0xf))==(cell_index<<1) )
+        array.push_back(typename ARRAY::value_type(eidx));
     }
   }
 
@@ -1856,16 +1860,16 @@ protected:
       const int* off = HexVolFacePerEdgeTable[face_index];
 
       typename Node::index_type n1, n2, n3, n4;
-      typename face_nt::const_iterator fiter;
+      index_type fidx;
 
       n1 = cells_[cell_index+off[0]]; n2 = cells_[cell_index+off[1]];
       n3 = cells_[cell_index+off[2]]; n4 = cells_[cell_index+off[3]];
 
       if (order_face_nodes(n1,n2,n3,n4))
       {
-        fiter = face_table_.find(PFaceNode(n1,n2,n3,n4));
-        if (((faces_[fiter->second].cells_[0])&(~0x7)) == cell_index)
-          array.push_back(typename ARRAY::value_type(fiter->second));
+        fidx = find_face(PFaceNode(n1,n2,n3,n4));
+        if (((faces_[fidx].cells_[0])&(~0x7)) == cell_index)
+          array.push_back(typename ARRAY::value_type(fidx));
       }
 
       n1 = cells_[cell_index+off[4]]; n2 = cells_[cell_index+off[5]];
@@ -1873,9 +1877,9 @@ protected:
 
       if (order_face_nodes(n1,n2,n3,n4))
       {
-        fiter = face_table_.find(PFaceNode(n1,n2,n3,n4));
-        if (((faces_[fiter->second].cells_[0])&(~0x7)) == cell_index)
-          array.push_back(typename ARRAY::value_type(fiter->second));
+        fidx = find_face(PFaceNode(n1,n2,n3,n4));
+        if (((faces_[fidx].cells_[0])&(~0x7)) == cell_index)
+          array.push_back(typename ARRAY::value_type(fidx));
       }
     }
   }
@@ -1908,9 +1912,9 @@ protected:
 
       if (order_face_nodes(n1,n2,n3,n4))
       {
-        typename face_nt::const_iterator iter = face_table_.find(PFaceNode(n1,n2,n3,n4));
-        if (((faces_[iter->second].cells_[0])&(~0x7))==cell_index)
-          array.push_back(typename ARRAY::value_type(iter->second));
+        index_type fidx = find_face(PFaceNode(n1,n2,n3,n4));
+        if (((faces_[fidx].cells_[0])&(~0x7))==cell_index)
+          array.push_back(typename ARRAY::value_type(fidx));
       }
 
       n1 = cells_[cell_index+offset[4]]; n2 = cells_[cell_index+offset[5]];
@@ -1918,9 +1922,9 @@ protected:
 
       if (order_face_nodes(n1,n2,n3,n4))
       {
-        typename face_nt::const_iterator iter = face_table_.find(PFaceNode(n1,n2,n3,n4));
-        if (((faces_[iter->second].cells_[0])&(~0x7))==cell_index)
-          array.push_back(typename ARRAY::value_type(iter->second));
+        index_type fidx = find_face(PFaceNode(n1,n2,n3,n4));
+        if (((faces_[fidx].cells_[0])&(~0x7))==cell_index)
+          array.push_back(typename ARRAY::value_type(fidx));
       }
 
       n1 = cells_[cell_index+offset[8]]; n2 = cells_[cell_index+offset[9]];
@@ -1928,9 +1932,9 @@ protected:
 
       if (order_face_nodes(n1,n2,n3,n4))
       {
-        typename face_nt::const_iterator iter = face_table_.find(PFaceNode(n1,n2,n3,n4));
-        if (((faces_[iter->second].cells_[0])&(~0x7))==cell_index)
-          array.push_back(typename ARRAY::value_type(iter->second));
+        index_type fidx = find_face(PFaceNode(n1,n2,n3,n4));
+        if (((faces_[fidx].cells_[0])&(~0x7))==cell_index)
+          array.push_back(typename ARRAY::value_type(fidx));
       }
     }
   }
@@ -1984,12 +1988,9 @@ protected:
     typename Node::index_type n4(array[3]);
 
     if(!(order_face_nodes(n1,n2,n3,n4))) return (false);
-    PFaceNode f(n1, n2, n3, n4);
-    typename face_nt::const_iterator fiter = face_table_.find(f);
-    if (fiter == face_table_.end()) {
-      return (false);
-    }
-    idx = INDEX((*fiter).second);
+    index_type fidx = find_face(PFaceNode(n1, n2, n3, n4));
+    if (fidx == MESH_NO_NEIGHBOR) return (false);
+    idx = INDEX(fidx);
     return (true);
   }
 
@@ -2002,20 +2003,18 @@ protected:
     typename Node::index_type n1(array[0]);
     typename Node::index_type n2(array[1]);
 
-    PEdgeNode f(n1, n2);
-    typename edge_nt::const_iterator fiter = edge_table_.find(f);
-    if (fiter == edge_table_.end()) {
-      return (false);
-    }
-    idx = INDEX((*fiter).second);
+    index_type eidx = find_edge(PEdgeNode(n1, n2));
+    if (eidx == MESH_NO_NEIGHBOR) return (false);
+    idx = INDEX(eidx);
     return (true);
   }
 
   template <class ARRAY, class INDEX>
   inline void set_nodes_by_elem(ARRAY &array, INDEX idx)
   {
+    std::vector<under_type>& cells = cells_.mutate();
     for (index_type n = 0; n < 8; ++n)
-      cells_[idx * 8 + n] = static_cast<index_type>(array[n]);
+      cells[idx * 8 + n] = static_cast<index_type>(array[n]);
   }
 
 
@@ -2481,9 +2480,9 @@ protected:
   }
 
   /// all the nodes.
-  std::vector<Core::Geometry::Point>        points_;
+  CopyOnWriteVector<Core::Geometry::Point>        points_;
   /// each 8 indecies make up a Hex
-  std::vector<under_type>   cells_;
+  CopyOnWriteVector<under_type> cells_;
 
   /// Face information.
   class PFaceCell {
@@ -2590,14 +2589,6 @@ protected:
     }
   };
 
-  class PFace : public PFaceNode, public PFaceCell
-  {
-    public:
-      PFace(typename Node::index_type n1, typename Node::index_type n2,
-          typename Node::index_type n3, typename Node::index_type n4) :
-        PFaceNode(n1,n2,n3,n4) {}
-  };
-
   /// Edge information.
   class PEdgeNode {
     public:
@@ -2651,117 +2642,6 @@ protected:
     bool shared() const { return cells_.size() > 1; }
   };
 
-  /// Edge information.
-  class PEdge : public PEdgeNode, public PEdgeCell
-  {
-    public:
-      PEdge(typename Node::index_type n1,typename Node::index_type n2) :
-        PEdgeNode(n1,n2) {}
-  };
-
-  /// hash the egde's node_indecies such that edges with the same nodes
-  ///  hash to the same value. nodes are sorted on edge construction.
-  static const int sz_int = sizeof(int) * 8; // in bits
-  struct FaceHash
-  {
-    /// These are needed by the hash_map particularly
-    // ANSI C++ allows us to initialize these variables in the
-    // declaration.  However there may be compilers which will complain
-    // about it.
-    static const size_t bucket_size = 4;
-    static const size_t min_buckets = 8;
-
-    /// These are for our own use (making the hash function.
-    static const int sz_quarter_int = (int)(sz_int / 4);
-    static const int top4_mask = -(1 << sz_quarter_int << sz_quarter_int << sz_quarter_int);
-    static const int up4_mask = top4_mask ^ -(1 << sz_quarter_int << sz_quarter_int);
-    static const int mid4_mask =  top4_mask ^ -(1 << sz_quarter_int);
-    static const int low4_mask = ~(top4_mask | mid4_mask);
-
-    /// This is the hash function
-    template <class PFACE>
-    size_t operator()(const PFACE &f) const
-    {
-      if (f.nodes_[2] == f.nodes_[3])
-      {
-        if (f.nodes_[1] < f.nodes_[2])
-        {
-          return ((f.nodes_[0] << sz_quarter_int << sz_quarter_int <<sz_quarter_int) |
-                (up4_mask & (f.nodes_[1] << sz_quarter_int << sz_quarter_int)) |
-                (mid4_mask & (f.nodes_[2] << sz_quarter_int)) |
-                (low4_mask & f.nodes_[3]));
-        }
-        else
-        {
-          return ((f.nodes_[0] << sz_quarter_int << sz_quarter_int <<sz_quarter_int) |
-                (up4_mask & (f.nodes_[2] << sz_quarter_int << sz_quarter_int)) |
-                (mid4_mask & (f.nodes_[1] << sz_quarter_int)) |
-                (low4_mask & f.nodes_[1]));
-        }
-      }
-      else
-      {
-        if (f.nodes_[1] < f.nodes_[3] )
-        {
-          return ((f.nodes_[0] << sz_quarter_int << sz_quarter_int <<sz_quarter_int) |
-                (up4_mask & (f.nodes_[1] << sz_quarter_int << sz_quarter_int)) |
-                (mid4_mask & (f.nodes_[2] << sz_quarter_int)) |
-                (low4_mask & f.nodes_[3]));
-        }
-        else
-        {
-          return ((f.nodes_[0] << sz_quarter_int << sz_quarter_int <<sz_quarter_int) |
-                (up4_mask & (f.nodes_[3] << sz_quarter_int << sz_quarter_int)) |
-                (mid4_mask & (f.nodes_[2] << sz_quarter_int)) |
-                (low4_mask & f.nodes_[1]));
-        }
-      }
-    }
-
-    /// This should return less than rather than equal to.
-    template <class PFACE>
-    bool operator()(const PFACE &f1, const PFACE& f2) const {
-      return f1 < f2;
-    }
-  };
-
-  /*/ hash the egde's node_indecies such that edges with the same nodes
-   *  hash to the same value. nodes are sorted on edge construction. */
-  struct EdgeHash {
-    /// These are needed by the hash_map particularly
-    // ANSI C++ allows us to initialize these variables in the
-    // declaration.  However there may be compilers which will complain
-    // about it.
-    static const size_t bucket_size = 4;
-    static const size_t min_buckets = 8;
-
-    /// These are for our own use (making the hash function.
-    static const int sz_int = sizeof(int) * 8; // in bits
-    static const int sz_half_int = sizeof(int) << 2; // in bits
-    static const int up_mask = -(1 << sz_half_int);
-    static const int low_mask = (~((int)0) ^ up_mask);
-
-    /// This is the hash function
-    template<class PEDGE>
-    size_t operator()(const PEDGE &e) const
-    {
-      return (e.nodes_[0] << sz_half_int) |
-	(low_mask & e.nodes_[1]);
-    }
-
-    ///  This should return less than rather than equal to.
-    template<class PEDGE>
-    bool operator()(const PEDGE &e1, const PEDGE &e2) const
-    {
-      return e1 < e2;
-    }
-  };
-
-  using face_ht = boost::unordered_map<PFace, typename Face::index_type, FaceHash>;
-  using face_nt = boost::unordered_map<PFaceNode, typename Face::index_type, FaceHash>;
-  using edge_ht = boost::unordered_map<PEdge, typename Edge::index_type, EdgeHash>;
-  using edge_nt = boost::unordered_map<PEdgeNode, typename Edge::index_type, EdgeHash>;
-
   typedef std::vector<PFaceCell> face_ct;
   typedef std::vector<PEdgeCell> edge_ct;
 
@@ -2769,20 +2649,46 @@ protected:
   ///  nodes or cells change.
 
   face_ct faces_;
-  face_nt face_table_;
+  /// sorted face keys, 4 per face in face order (see face_key)
+  std::vector<index_type> face_keys_;
   /// container for edge storage. Must be computed each time
   ///  nodes or cells change.
   edge_ct edges_;
-  edge_nt edge_table_;
+  /// sorted edge keys, 2 per edge in edge order
+  std::vector<index_type> edge_keys_;
 
-  inline
-  void hash_edge(typename Node::index_type n1, typename Node::index_type n2,
-                 index_type combind_index, edge_ht &table) const;
+  /// Key of a face whose nodes went through order_face_nodes. The face may
+  /// be listed in either orientation, so the neighbors of the first node are
+  /// put in increasing order. A triangle has its last node repeated.
+  static inline void face_key(const typename Node::index_type* n, index_type* key)
+  {
+    const index_type n1 = n[1], n2 = n[2], n3 = n[3];
+    key[0] = n[0];
+    if (n2 == n3)
+    {
+      key[1] = std::min(n1, n2);
+      key[2] = key[3] = std::max(n1, n2);
+    }
+    else
+    {
+      key[1] = std::min(n1, n3);
+      key[2] = n2;
+      key[3] = std::max(n1, n3);
+    }
+  }
+
+  inline index_type find_face(const PFaceNode& f) const
+  {
+    index_type key[4];
+    face_key(f.nodes_, key);
+    return (SortedTopologyBuilder<4>::find(face_keys_, key));
+  }
 
-  inline
-  void hash_face(typename Node::index_type n1, typename Node::index_type n2,
-                 typename Node::index_type n3, typename Node::index_type n4,
-                 index_type combined_index, face_ht &table) const;
+  inline index_type find_edge(const PEdgeNode& e) const
+  {
+    const index_type key[2] = { e.nodes_[0], e.nodes_[1] };
+    return (SortedTopologyBuilder<2>::find(edge_keys_, key));
+  }
 
   template <class INDEX>
   bool order_face_nodes(INDEX& n1, INDEX& n2, INDEX& n3, INDEX& n4) const
@@ -2898,9 +2804,9 @@ HexVolMesh<Basis>::HexVolMesh() :
   points_(0),
   cells_(0),
   faces_(0),
-  face_table_(),
+  face_keys_(),
   edges_(0),
-  edge_table_(),
+  edge_keys_(),
   synchronize_lock_("HexVolMesh Lock"),
   synchronize_cond_("HexVolMesh condition variable"),
   synchronized_(Mesh::NODES_E | Mesh::CELLS_E),
@@ -2920,9 +2826,9 @@ HexVolMesh<Basis>::HexVolMesh(const HexVolMesh &copy) :
   points_(0),
   cells_(0),
   faces_(0),
-  face_table_(),
+  face_keys_(),
   edges_(0),
-  edge_table_(),
+  edge_keys_(),
   synchronize_lock_("HexVolMesh Lock"),
   synchronize_cond_("HexVolMesh condition variable"),
   synchronized_(Mesh::NODES_E | Mesh::CELLS_E),
@@ -2972,7 +2878,7 @@ HexVolMesh<Basis>::fill_points(Iter begin, Iter end, Functor fill_ftor)
   synchronize_lock_.lock();
   Iter iter = begin;
   points_.resize(end - begin); // resize to the new size
-  std::vector<Core::Geometry::Point>::iterator piter = points_.begin();
+  std::vector<Core::Geometry::Point>::iterator piter = points_.mutate().begin();
   while (iter != end)
   {
     *piter = fill_ftor(*iter);
@@ -2989,7 +2895,7 @@ HexVolMesh<Basis>::fill_cells(Iter begin, Iter end, Functor fill_ftor)
   synchronize_lock_.lock();
   Iter iter = begin;
   cells_.resize((end - begin) * 8); // resize to the new size
-  std::vector<under_type>::iterator citer = cells_.begin();
+  std::vector<under_type>::iterator citer = cells_.mutate().begin();
   while (iter != end)
   {
     index_type *nodes = fill_ftor(*iter); // returns an array of length 8
@@ -3176,8 +3082,8 @@ HexVolMesh<Basis>::transform(const Core::Geometry::Transform &t)
 {
   synchronize_lock_.lock();
 
-  std::vector<Core::Geometry::Point>::iterator itr = points_.begin();
-  std::vector<Core::Geometry::Point>::iterator eitr = points_.end();
+  std::vector<Core::Geometry::Point>::iterator itr = points_.mutate().begin();
+  std::vector<Core::Geometry::Point>::iterator eitr = points_.mutate().end();
   while (itr != eitr)
   {
     *itr = t.project(*itr);
@@ -3211,184 +3117,136 @@ HexVolMesh<Basis>::transform(const Core::Geometry::Transform &t)
   synchronize_lock_.unlock();
 }
 
-template <class Basis>
-void
-HexVolMesh<Basis>::hash_face(typename Node::index_type n1,
-                             typename Node::index_type n2,
-                             typename Node::index_type n3,
-                             typename Node::index_type n4,
-                             index_type combined_index,
-                             face_ht &table) const
-{
-  // Reorder nodes while maintaining CCW or CW orientation
-  // Check for degenerate faces, if faces has degeneracy it
-  // will be ignored (e.g. nodes on opposite corners are equal,
-  // or more then two nodes are equal)
-
-  if (!(order_face_nodes(n1,n2,n3,n4))) return;
-  PFace f(n1, n2, n3, n4);
-
-
-  typename face_ht::iterator iter = table.find(f);
-
-  if (iter == table.end())
-  {
-    f.cells_[0] = combined_index;
-    table[f] = 0; // insert for the first time
-  }
-  else
-  {
-    PFace f = (*iter).first;
-    if (f.cells_[1] != MESH_NO_NEIGHBOR)
-    {
-      //TODO: inject new logger
-      /*
-      std::cerr << "HexVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>3) << ", #" << (f.cells_[1]>>3) << ", and #" << (combined_index>>3)
-           << " are illegally adjacent." << std::endl;*/
-    }
-    else if ((f.cells_[0]>>3) == (combined_index>>3))
-    {
-      //TODO: inject new logger
-      /*
-      std::cerr << "HexVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>3) << ", #" << (f.cells_[1]>>3) << ", and #" << (combined_index>>3)
-           << " are the same." << std::endl;
-           */
-    }
-    else
-    {
-      f.cells_[1] = combined_index; // add this cell
-      table.erase(iter);
-      table[f] = 0;
-    }
-  }
-}
-
 template <class Basis>
 void
 HexVolMesh<Basis>::compute_faces()
 {
-  face_table_.clear();
-
-  typename Cell::iterator ci, cie;
-  begin(ci); end(cie);
-  typename Node::array_type arr(8);
+  // 6 faces -- each is entered CCW from outside looking in
+  static const int face_nodes[6][4] = { {0,1,2,3}, {7,6,5,4}, {0,4,5,1},
+                                        {2,6,7,3}, {3,7,4,0}, {1,5,6,2} };
+  typedef SortedTopologyBuilder<4> builder_type;
 
-  face_ht table;
-
-  while (ci != cie)
-  {
-    get_nodes(arr, *ci);
-    // 6 faces -- each is entered CCW from outside looking in
-    index_type cell_index = (*ci)<<3;
-    hash_face(arr[0], arr[1], arr[2], arr[3], cell_index, table);
-    hash_face(arr[7], arr[6], arr[5], arr[4], cell_index + 1, table);
-    hash_face(arr[0], arr[4], arr[5], arr[1], cell_index + 2, table);
-    hash_face(arr[2], arr[6], arr[7], arr[3], cell_index + 3, table);
-    hash_face(arr[3], arr[7], arr[4], arr[0], cell_index + 4, table);
-    hash_face(arr[1], arr[5], arr[6], arr[2], cell_index + 5, table);
+  const size_type num_cells = static_cast<size_type>(cells_.size() >> 3);
+  const under_type* cells = cells_.empty() ? 0 : &cells_[0];
 
-    ++ci;
-  }
-
-  faces_.resize(table.size());
-  boundary_faces_.resize(cells_.size()>>3);
+  builder_type builder;
+  builder.build(num_cells, 6, static_cast<size_type>(points_.size()),
+    [this, cells](index_type c, builder_type::Record* rec)
+    {
+      const under_type* cell = cells + 8*c;
+      for (int f = 0; f < 6; f++)
+      {
+        // Reorder nodes while maintaining CCW or CW orientation
+        // Check for degenerate faces, if faces has degeneracy it
+        // will be ignored (e.g. nodes on opposite corners are equal,
+        // or more then two nodes are equal)
+        typename Node::index_type n[4] = {
+          typename Node::index_type(cell[face_nodes[f][0]]),
+          typename Node::index_type(cell[face_nodes[f][1]]),
+          typename Node::index_type(cell[face_nodes[f][2]]),
+          typename Node::index_type(cell[face_nodes[f][3]]) };
+        if (order_face_nodes(n[0],n[1],n[2],n[3]))
+        {
+          face_key(n, rec[f].key);
+          rec[f].code = (c << 3) + f;
+        }
+        else
+        {
+          rec[f].code = -1;
+        }
+      }
+    });
 
-  typename face_ht::iterator ht_iter = table.begin();
-  typename face_ht::iterator ht_iter_end = table.end();
+  // A face is shared by at most two distinct cells; further occurrences
+  // indicate a broken mesh and are ignored.
+  const size_type num_faces = builder.size();
+  faces_.clear();
+  faces_.resize(num_faces);
+  Core::Thread::Parallel::For(0, num_faces, 1 << 14,
+    [this, &builder](size_t begin, size_t end)
+    {
+      for (size_t u = begin; u < end; u++)
+      {
+        const builder_type::Record* rec = builder.begin(u);
+        const builder_type::Record* rec_end = builder.end(u);
+        PFaceCell& face = faces_[u];
+        face.cells_[0] = rec->code;
+        for (++rec; rec != rec_end; ++rec)
+        {
+          if ((rec->code >> 3) != (face.cells_[0] >> 3))
+          {
+            face.cells_[1] = rec->code;
+            break;
+          }
+        }
+      }
+    });
 
-  index_type uidx = 0;
-  while (ht_iter != ht_iter_end)
+  boundary_faces_.assign(num_cells, 0);
+  for (index_type u = 0; u < num_faces; u++)
   {
-    const PFace& pface = (*ht_iter).first;
-    faces_[uidx].cells_[0] = pface.cells_[0];
-    faces_[uidx].cells_[1] = pface.cells_[1];
-    face_table_[PFaceNode(pface.nodes_[0],pface.nodes_[1],pface.nodes_[2],pface.nodes_[3])] = uidx;
-
-    if (pface.cells_[1] == -1)
+    if (faces_[u].cells_[1] == MESH_NO_NEIGHBOR)
     {
-      index_type cell = (pface.cells_[0]) >> 3;
-      index_type face = (pface.cells_[0]) & 0x7;
+      index_type cell = (faces_[u].cells_[0]) >> 3;
+      index_type face = (faces_[u].cells_[0]) & 0x7;
       boundary_faces_[cell] |= 1 << face;
     }
-
-    ++ht_iter; uidx++;
   }
 
+  builder.swap_keys(face_keys_);
+
   synchronize_lock_.lock();
   synchronized_ |= Mesh::FACES_E;
   synchronize_lock_.unlock();
 }
 
-template <class Basis>
-void
-HexVolMesh<Basis>::hash_edge(typename Node::index_type n1,
-                             typename Node::index_type n2,
-                             index_type combined_index,
-                             edge_ht &table) const
-{
-  if (n1 == n2) return;
-  PEdge e(n1, n2);
-  typename edge_ht::iterator iter = table.find(e);
-  if (iter == table.end())
-  {
-    e.cells_.push_back(combined_index); // add this cell
-    table[e] = 0; // insert for the first time
-  }
-  else
-  {
-    PEdge e = (*iter).first;
-    e.cells_.push_back(combined_index); // add this cell
-    table.erase(iter);
-    table[e] = 0;
-  }
-}
-
 template <class Basis>
 void
 HexVolMesh<Basis>::compute_edges()
 {
-  typename Cell::iterator ci, cie;
-  begin(ci); end(cie);
-  edge_ht table;
-  typename Node::array_type arr;
-  while (ci != cie)
-  {
-    get_nodes(arr, *ci);
-    index_type cell_index = (*ci)<<4;
-    hash_edge(arr[0], arr[1], cell_index  , table);
-    hash_edge(arr[1], arr[2], cell_index+1, table);
-    hash_edge(arr[2], arr[3], cell_index+2, table);
-    hash_edge(arr[3], arr[0], cell_index+3, table);
-
-    hash_edge(arr[4], arr[5], cell_index+4, table);
-    hash_edge(arr[5], arr[6], cell_index+5, table);
-    hash_edge(arr[6], arr[7], cell_index+6, table);
-    hash_edge(arr[7], arr[4], cell_index+7, table);
-
-    hash_edge(arr[0], arr[4], cell_index+8, table);
-    hash_edge(arr[5], arr[1], cell_index+9, table);
-    hash_edge(arr[2], arr[6], cell_index+10,table);
-    hash_edge(arr[7], arr[3], cell_index+11,table);
-    ++ci;
-  }
+  static const int edge_nodes[12][2] = { {0,1}, {1,2}, {2,3}, {3,0},
+                                         {4,5}, {5,6}, {6,7}, {7,4},
+                                         {0,4}, {5,1}, {2,6}, {7,3} };
+  typedef SortedTopologyBuilder<2> builder_type;
 
-  // dump edges into the edges_ container.
+  const size_type num_cells = static_cast<size_type>(cells_.size() >> 3);
+  const under_type* cells = cells_.empty() ? 0 : &cells_[0];
 
-  edges_.resize(table.size());
+  builder_type builder;
+  builder.build(num_cells, 12, static_cast<size_type>(points_.size()),
+    [cells](index_type c, builder_type::Record* rec)
+    {
+      const under_type* cell = cells + 8*c;
+      for (int e = 0; e < 12; e++)
+      {
+        rec[e].key[0] = cell[edge_nodes[e][0]];
+        rec[e].key[1] = cell[edge_nodes[e][1]];
+        builder_type::sort_key(rec[e].key);
+        // Collapsed edges of degenerate hexes are not edges
+        rec[e].code = (rec[e].key[0] == rec[e].key[1]) ? -1 : (c << 4) + e;
+      }
+    });
 
-  typename edge_ht::iterator ht_iter = table.begin();
-  typename edge_ht::iterator ht_iter_end = table.end();
+  // dump edges into the edges_ container.
+  const size_type num_edges = builder.size();
+  edges_.clear();
+  edges_.resize(num_edges);
+  Core::Thread::Parallel::For(0, num_edges, 1 << 14,
+    [this, &builder](size_t begin, size_t end)
+    {
+      for (size_t u = begin; u < end; u++)
+      {
+        std::vector<index_type>& cells = edges_[u].cells_;
+        cells.reserve(builder.count(u));
+        for (const builder_type::Record* rec = builder.begin(u);
+             rec != builder.end(u); ++rec)
+        {
+          cells.push_back(rec->code);
+        }
+      }
+    });
 
-  index_type uidx = 0;
-  while (ht_iter != ht_iter_end)
-  {
-    const PEdge& pedge = (*ht_iter).first;
-    edges_[uidx].cells_ = pedge.cells_;
-    edge_table_[PEdgeNode(pedge.nodes_[0],pedge.nodes_[1])] = uidx;
-    ++ht_iter; uidx++;
-  }
+  builder.swap_keys(edge_keys_);
 
   synchronize_lock_.lock();
   synchronized_ |= Mesh::EDGES_E;
@@ -3505,8 +3363,10 @@ HexVolMesh<Basis>::synchronize(mask_type sync)
     boost::thread syncthread(syncclass);
   }
 
-  // Wait until threads are done
-  while ((synchronized_ & sync) != sync)
+  // Wait until threads are done. The compute functions mark their table
+  // before the thread is finished with the lock, so wait for the threads
+  // to clear their synchronizing_ bits as well.
+  while (((synchronized_ & sync) != sync) || (synchronizing_ & sync))
   {
     synchronize_cond_.wait(lock);
   }
@@ -3533,9 +3393,9 @@ HexVolMesh<Basis>::clear_synchronization()
   // Free memory where possible
   node_neighbors_.clear();
   edges_.clear();
-  edge_table_.clear();
+  edge_keys_.clear();
   faces_.clear();
-  face_table_.clear();
+  face_keys_.clear();
   boundary_faces_.clear();
 
   node_grid_.reset();
@@ -3665,12 +3525,9 @@ HexVolMesh<Basis>::get_face(typename Face::index_type &face,
   ASSERTMSG(synchronized_ & Mesh::FACES_E,
             "Must call synchronize FACES_E on HexVolMesh first");
   if(!(order_face_nodes(n1,n2,n3,n4))) return (false);
-  PFaceNode f(n1, n2, n3, n4);
-  typename face_nt::const_iterator fiter = face_table_.find(f);
-  if (fiter == face_table_.end()) {
-    return false;
-  }
-  face = (*fiter).second;
+  index_type fidx = find_face(PFaceNode(n1, n2, n3, n4));
+  if (fidx == MESH_NO_NEIGHBOR) return false;
+  face = fidx;
   return true;
 }
 
@@ -2069,7 +2069,7 @@ public:
 
   private:
     VMesh::Face::index_type  index_;
-    const Array2<Point>&      points_;
+    const CopyOnWrite<Array2<Point> >&      points_;
     VMesh::Node::array_type  nodes_;
   };
 
@@ -2138,7 +2138,8 @@ public:
 
   virtual void set_point(const Point &p, VMesh::Node::index_type i);
 
-  virtual Point* get_points_pointer() const;
+  virtual const Point* get_points_pointer() const;
+  virtual Point* mutable_points_pointer();
 
   virtual void get_random_point(Point &p,
                                 VMesh::Elem::index_type i,
@@ -2246,7 +2247,7 @@ protected:
   }
 
 
-  Array2<Point>&     points_;
+  CopyOnWrite<Array2<Point> >&     points_;
 };
 
 /// Functions for creating the virtual interface for specific mesh types
@@ -2605,18 +2606,27 @@ void
 VStructQuadSurfMesh<MESH>::
 set_point(const Point &point, VMesh::Node::index_type idx)
 {
-  points_[idx] = point;
+  points_.mutate()[idx] = point;
 }
 
 template <class MESH>
-Point*
+const Point*
 VStructQuadSurfMesh<MESH>::
 get_points_pointer() const
 {
-  if (points_.size() == 0) return (0);
+  if (points_.get().size() == 0) return (0);
   return (&(points_[0]));
 }
 
+template <class MESH>
+Point*
+VStructQuadSurfMesh<MESH>::
+mutable_points_pointer()
+{
+  if (points_.get().size() == 0) return (0);
+  return (&(points_.mutate()[0]));
+}
+
 template <class Basis>
 double
 VStructQuadSurfMesh<Basis>::
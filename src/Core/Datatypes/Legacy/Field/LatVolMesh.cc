@@ -2941,7 +2941,7 @@ public:
 
   private:
     VMesh::Cell::index_type  index_;
-    const Array3<Point>&     points_;
+    const CopyOnWrite<Array3<Point> >&     points_;
     VMesh::Node::array_type  nodes_;
   };
   
@@ -3013,7 +3013,8 @@ public:
 
   virtual void set_point(const Point &p, VMesh::Node::index_type i);
 
-  virtual Point* get_points_pointer() const;
+  virtual const Point* get_points_pointer() const;
+  virtual Point* mutable_points_pointer();
   
   virtual void get_random_point(Point &p,
 				VMesh::Elem::index_type i,
@@ -3120,7 +3121,7 @@ protected:
     InverseMatrix3x3(J,Ji);
   }
 
-  Array3<Point>&     points_;
+  CopyOnWrite<Array3<Point> >&     points_;
 };
 
 
@@ -3509,17 +3510,25 @@ template <class MESH>
 void 
 VStructHexVolMesh<MESH>::set_point(const Point &point, VMesh::Node::index_type idx)
 {
-  points_[idx] = point;
+  points_.mutate()[idx] = point;
 }
 
 template <class MESH>
-Point*
+const Point*
 VStructHexVolMesh<MESH>::get_points_pointer() const
 {
-  if (points_.size() == 0) return (0);
+  if (points_.get().size() == 0) return (0);
   return (&(points_[0]));
 }
 
+template <class MESH>
+Point*
+VStructHexVolMesh<MESH>::mutable_points_pointer()
+{
+  if (points_.get().size() == 0) return (0);
+  return (&(points_.mutate()[0]));
+}
+
 template <class MESH>
 double 
 VStructHexVolMesh<MESH>::det_jacobian(const VMesh::coords_type& coords,
@@ -88,6 +88,18 @@ public:
   virtual bool synchronize(mask_type) { return false; }
   virtual bool unsynchronize(mask_type) { return false; }
 
+  /// Search structure built for NODE_LOCATE_E and ELEM_LOCATE_E. The search
+  /// grid works best for meshes with evenly sized elements, the bounding
+  /// volume hierarchy adapts to strongly graded meshes. Meshes that only
+  /// implement the grid ignore this setting.
+  enum LocateAccelerator
+  {
+    GRID_LOCATE_E = 0,
+    BVH_LOCATE_E = 1
+  };
+
+  virtual void set_locate_accelerator(LocateAccelerator) {}
+
   virtual int basis_order();
 
   /// Persistent I/O.
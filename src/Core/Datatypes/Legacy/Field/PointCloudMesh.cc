@@ -91,7 +91,8 @@ public:
 
   virtual void set_point(const Point &point, VMesh::Node::index_type i);
 
-  virtual Point* get_points_pointer() const;
+  virtual const Point* get_points_pointer() const;
+  virtual Point* mutable_points_pointer();
 
   virtual void add_node(const Point &point,VMesh::Node::index_type &i);
   virtual void add_elem(const VMesh::Node::array_type &nodes,
@@ -186,7 +187,8 @@ public:
                                      VMesh::MultiElemGradient& eg,
                                      int basis_order) const;
 
-  virtual VMesh::index_type* get_elems_pointer() const;
+  virtual VMesh::index_type* mutable_elems_pointer();
+  virtual const VMesh::index_type* get_elems_pointer() const;
 
 };
 
@@ -390,11 +392,11 @@ template <class MESH>
 void
 VPointCloudMesh<MESH>::set_point(const Point &point, VMesh::Node::index_type i)
 {
-  this->mesh_->points_[i] = point;
+  this->mesh_->points_.mutate()[i] = point;
 }
 
 template <class MESH>
-Point*
+const Point*
 VPointCloudMesh<MESH>::get_points_pointer() const
 {
   if (this->mesh_->points_.empty())
@@ -403,6 +405,16 @@ VPointCloudMesh<MESH>::get_points_pointer() const
   return(&(this->mesh_->points_[0]));
 }
 
+template <class MESH>
+Point*
+VPointCloudMesh<MESH>::mutable_points_pointer()
+{
+  if (this->mesh_->points_.empty())
+    return 0;
+
+  return(&(this->mesh_->points_.mutate()[0]));
+}
+
 
 template <class MESH>
 void
@@ -736,6 +748,14 @@ get_mgradient_weights(const std::vector<VMesh::coords_type>& coords,
 template <class MESH>
 VMesh::index_type*
 VPointCloudMesh<MESH>::
+mutable_elems_pointer()
+{
+  return (0);
+}
+
+template <class MESH>
+const VMesh::index_type*
+VPointCloudMesh<MESH>::
 get_elems_pointer() const
 {
   return (0);
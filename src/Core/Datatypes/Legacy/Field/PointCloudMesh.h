@@ -36,6 +36,7 @@
 #include <Core/Persistent/PersistentSTL.h>
 #include <Core/GeometryPrimitives/SearchGridT.h>
 #include <Core/Containers/StackVector.h>
+#include <Core/Containers/CopyOnWriteVector.h>
 
 #include <Core/GeometryPrimitives/Transform.h>
 #include <Core/GeometryPrimitives/BBox.h>
@@ -437,7 +438,7 @@ public:
   void get_point(Core::Geometry::Point &p, typename Node::index_type i) const
     { get_center(p,i); }
   void set_point(const Core::Geometry::Point &p, typename Node::index_type i)
-    { points_[i] = p; }
+    { points_.mutate()[i] = p; }
   void get_random_point(Core::Geometry::Point &p, const typename Elem::index_type i,
                         FieldRNG& /*rng*/) const
     { get_center(p, i); }
@@ -1271,7 +1272,7 @@ protected:
 
 
   /// the nodes
-  std::vector<Core::Geometry::Point> points_;
+  CopyOnWriteVector<Core::Geometry::Point> points_;
 
   /// basis fns
   Basis         basis_;
@@ -1400,8 +1401,8 @@ PointCloudMesh<Basis>::transform(const Core::Geometry::Transform &t)
 {
   synchronize_lock_.lock();
 
-  std::vector<Core::Geometry::Point>::iterator itr = points_.begin();
-  std::vector<Core::Geometry::Point>::iterator eitr = points_.end();
+  std::vector<Core::Geometry::Point>::iterator itr = points_.mutate().begin();
+  std::vector<Core::Geometry::Point>::iterator eitr = points_.mutate().end();
   while (itr != eitr)
   {
     *itr = t.project(*itr);
@@ -134,7 +134,8 @@ public:
                          VMesh::Cell::index_type);
 
 
-  virtual VMesh::index_type* get_elems_pointer() const;
+  virtual VMesh::index_type* mutable_elems_pointer();
+  virtual const VMesh::index_type* get_elems_pointer() const;
 };
 
 /// Functions for creating the virtual interface for specific mesh types
@@ -452,10 +453,19 @@ VPrismVolMesh<MESH>::set_nodes(VMesh::Node::array_type& nodes,
 template <class MESH>
 VMesh::index_type*
 VPrismVolMesh<MESH>::
+mutable_elems_pointer()
+{
+  if (this->mesh_->cells_.size() == 0) return (0);
+  return (&(this->mesh_->cells_.mutate()[0]));
+}
+
+template <class MESH>
+const VMesh::index_type*
+VPrismVolMesh<MESH>::
 get_elems_pointer() const
 {
   if (this->mesh_->cells_.size() == 0) return (0);
-   return (&(this->mesh_->cells_[0]));
+  return (&(this->mesh_->cells_[0]));
 }
 
 }
@@ -35,6 +35,7 @@
 #include <Core/Datatypes/Legacy/Field/MeshSupport.h>
 
 #include <Core/Containers/StackVector.h>
+#include <Core/Containers/CopyOnWriteVector.h>
 #include <Core/Persistent/PersistentSTL.h>
 
 #include <Core/GeometryPrimitives/SearchGridT.h>
@@ -52,6 +53,7 @@
 #include <Core/Datatypes/Legacy/Field/FieldIterator.h>
 #include <Core/Datatypes/Legacy/Field/FieldRNG.h>
 #include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/SortedTopologyBuilder.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 
 #include <Core/Utils/Legacy/CheckSum.h>
@@ -649,7 +651,7 @@ public:
   void get_point(Core::Geometry::Point &result, typename Node::index_type index) const
     { result = points_[index]; }
   void set_point(const Core::Geometry::Point &point, typename Node::index_type index)
-    { points_[index] = point; }
+    { points_.mutate()[index] = point; }
   void get_random_point(Core::Geometry::Point &p, typename Elem::index_type i, FieldRNG &r) const;
 
   /// Function for getting node normals
@@ -1434,8 +1436,10 @@ public:
 				      const Core::Geometry::Point &p2, const Core::Geometry::Point &p3,
 				      const Core::Geometry::Point &p4, const Core::Geometry::Point &p5);
 
-  /// must detach, if altering points!
-  std::vector<Core::Geometry::Point>& get_points() { return points_; }
+  /// The points are shared with copies of this mesh until either one
+  /// changes them, which only mutable_points() may do.
+  const std::vector<Core::Geometry::Point>& get_points() const { return points_.get(); }
+  std::vector<Core::Geometry::Point>& mutable_points() { return points_.mutate(); }
 
   int compute_checksum();
 
@@ -1527,13 +1531,13 @@ protected:
     {
       PEdge e(f.nodes_[0], f.nodes_[1]);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(edge_table_.find(e))).second));
+                                            find_edge(e)));
     }
     if (f.nodes_[1] != f.nodes_[2])
     {
       PEdge e(f.nodes_[1], f.nodes_[2]);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(edge_table_.find(e))).second));
+                                            find_edge(e)));
     }
 
     if( static_cast<typename ARRAY::value_type>(f.nodes_[3]) ==
@@ -1543,7 +1547,7 @@ protected:
       {
         PEdge e(f.nodes_[2], f.nodes_[0]);
         array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(edge_table_.find(e))).second));
+                                            find_edge(e)));
       }
     }
     else
@@ -1552,13 +1556,13 @@ protected:
       {
         PEdge e(f.nodes_[2], f.nodes_[3]);
         array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(edge_table_.find(e))).second));
+                                            find_edge(e)));
       }
       if (f.nodes_[3] != f.nodes_[0])
       {
         PEdge e(f.nodes_[3], f.nodes_[0]);
         array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(edge_table_.find(e))).second));
+                                            find_edge(e)));
       }
     }
   }
@@ -1579,57 +1583,57 @@ protected:
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
     n1 = cells_[off + 1]; n2 = cells_[off + 2];
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
     n1 = cells_[off + 2]; n2 = cells_[off    ];
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
 
     n1 = cells_[off + 3]; n2 = cells_[off + 4];
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
     n1 = cells_[off + 4]; n2 = cells_[off + 5];
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
     n1 = cells_[off + 5]; n2 = cells_[off + 3];
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
 
     n1 = cells_[off    ]; n2 = cells_[off + 3];
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
     n1 = cells_[off + 4]; n2 = cells_[off + 1];
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
     n1 = cells_[off + 2]; n2 = cells_[off + 5];
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
   }
 
@@ -1660,7 +1664,7 @@ protected:
     {
       PFace f(n1,n2,n3,n4);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(face_table_.find(f))).second));
+                                            find_face(f)));
     }
     n1 = cells_[off + 5]; n2 = cells_[off + 4];
     n3 = cells_[off + 3];
@@ -1668,7 +1672,7 @@ protected:
     {
       PFace f(n1,n2,n3,n4);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(face_table_.find(f))).second));
+                                            find_face(f)));
     }
     n1 = cells_[off    ]; n2 = cells_[off + 3];
     n3 = cells_[off + 4]; n4 = cells_[off + 1];
@@ -1676,7 +1680,7 @@ protected:
     {
       PFace f(n1,n2,n3,n4);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(face_table_.find(f))).second));
+                                            find_face(f)));
     }
     n1 = cells_[off + 1]; n2 = cells_[off + 4];
     n3 = cells_[off + 5]; n4 = cells_[off + 2];
@@ -1684,7 +1688,7 @@ protected:
     {
       PFace f(n1,n2,n3,n4);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(face_table_.find(f))).second));
+                                            find_face(f)));
     }
     n1 = cells_[off + 2]; n2 = cells_[off + 5];
     n3 = cells_[off + 3]; n4 = cells_[off    ];
@@ -1692,7 +1696,7 @@ protected:
     {
       PFace f(n1,n2,n3,n4);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(face_table_.find(f))).second));
+                                            find_face(f)));
     }
   }
 
@@ -1712,16 +1716,16 @@ protected:
     for (size_t n = 0; n < neighbors.size(); n++)
     {
       // Get the edge information for the current edge
-      typename edge_ht::const_iterator iter =
-                  edge_table_.find(PEdge(
+      index_type eidx = find_edge(PEdge(
                     static_cast<typename Node::index_type>(idx),neighbors[n]));
-      ASSERTMSG(iter != edge_table_.end(),
-                "Edge not found in PrismVolMesh::edge_table_");
+      ASSERTMSG(eidx != MESH_NO_NEIGHBOR,
+                "Edge not found in PrismVolMesh::edge_keys_");
       // Insert all cells that share this edge into
       // the unique set of cell indices
-      for (size_t c = 0; c < (iter->first).cells_.size(); c++)
+      const PEdge& e = edges_[eidx];
+      for (size_t c = 0; c < e.cells_.size(); c++)
         unique_cells.insert(static_cast<typename ARRAY::value_type>(
-                                                    (iter->first).cells_[c]));
+                                                    e.cells_[c]));
     }
 
     // Copy the unique set of cells to our Cells array return argument
@@ -1759,8 +1763,9 @@ protected:
   template <class ARRAY, class INDEX>
   inline void set_nodes_by_elem(ARRAY &array, INDEX idx)
   {
+    std::vector<under_type>& cells = cells_.mutate();
     for (index_type n = 0; n < 6; ++n)
-      cells_[idx * 6 + n] = static_cast<index_type>(array[n]);
+      cells[idx * 6 + n] = static_cast<index_type>(array[n]);
   }
 
   template <class INDEX1, class INDEX2>
@@ -2213,9 +2218,9 @@ protected:
   }
 
   /// all the nodes.
-  std::vector<Core::Geometry::Point>        points_;
+  CopyOnWriteVector<Core::Geometry::Point>        points_;
   /// each 6 indecies make up a Prism
-  std::vector<under_type>   cells_;
+  CopyOnWriteVector<under_type> cells_;
 
   /// Face information.
   struct PFace {
@@ -2412,100 +2417,58 @@ protected:
     }
   };
 
-  /// hash the egde's node_indecies such that edges with the same nodes
-  ///  hash to the same value. nodes are sorted on edge construction.
-  static const int sz_int = sizeof(int) * 8; // in bits
-  struct FaceHash
-  {
-    /// These are needed by the hash_map particularly
-    // ANSI C++ allows us to initialize these variables in the
-    // declaration.  However there may be compilers which will complain
-    // about it.
-    static const size_t bucket_size = 4;
-    static const size_t min_buckets = 8;
-
-    /// These are for our own use (making the hash function.
-    static const int sz_quarter_int = (int)(sz_int / 4);
-    static const int top4_mask = -(1 << sz_quarter_int << sz_quarter_int << sz_quarter_int);
-    static const int up4_mask = top4_mask ^ -(1 << sz_quarter_int << sz_quarter_int);
-    static const int mid4_mask =  top4_mask ^ -(1 << sz_quarter_int);
-    static const int low4_mask = ~(top4_mask | mid4_mask);
-
-    /// This is the hash function
-    size_t operator()(const PFace &f) const {
-      if (f.nodes_[1] < f.nodes_[3] )
-      {
-        return ((f.nodes_[0] << sz_quarter_int << sz_quarter_int <<sz_quarter_int) |
-              (up4_mask & (f.nodes_[1] << sz_quarter_int << sz_quarter_int)) |
-              (mid4_mask & (f.nodes_[2] << sz_quarter_int)) |
-              (low4_mask & f.nodes_[3]));
-      }
-      else
-      {
-        return ((f.nodes_[0] << sz_quarter_int << sz_quarter_int <<sz_quarter_int) |
-              (up4_mask & (f.nodes_[3] << sz_quarter_int << sz_quarter_int)) |
-              (mid4_mask & (f.nodes_[2] << sz_quarter_int)) |
-              (low4_mask & f.nodes_[1]));
-      }
-    }
-    /// This should return less than rather than equal to.
-    bool operator()(const PFace &f1, const PFace& f2) const {
-      return f1 < f2;
-    }
-  };
-
-  friend struct FaceHash; // needed by the gcc-2.95.3 compiler
-
-  /// hash the egde's node_indecies such that edges with the same nodes
-  ///  hash to the same value. nodes are sorted on edge construction.
-  struct EdgeHash {
-    /// These are needed by the hash_map particularly
-    // ANSI C++ allows us to initialize these variables in the
-    // declaration.  However there may be compilers which will complain
-    // about it.
-    static const size_t bucket_size = 4;
-    static const size_t min_buckets = 8;
-
-    /// These are for our own use (making the hash function.
-    static const int sz_int = sizeof(int) * 8; // in bits
-    static const int sz_half_int = sizeof(int) << 2; // in bits
-    static const int up_mask = -(1 << sz_half_int);
-    static const int low_mask = (~((int)0) ^ up_mask);
-
-    /// This is the hash function
-    size_t operator()(const PEdge &e) const
-    {
-      return (e.nodes_[0] << sz_half_int) |
-	(low_mask & e.nodes_[1]);
-    }
-
-    ///  This should return less than rather than equal to.
-    bool operator()(const PEdge &e1, const PEdge& e2) const
-    {
-      return e1 < e2;
-    }
-  };
-
-  using face_ht = boost::unordered_map<PFace, typename Face::index_type, FaceHash>;
-  using edge_ht = boost::unordered_map<PEdge, typename Edge::index_type, EdgeHash>;
-
   /// container for face storage. Must be computed each time
   ///  nodes or cells change.
   std::vector<PFace>            faces_;
-  face_ht                  face_table_;
+  /// sorted face keys, 4 per face in face order (see face_key)
+  std::vector<index_type>       face_keys_;
   /// container for edge storage. Must be computed each time
   ///  nodes or cells change.
   std::vector<PEdge>            edges_;
-  edge_ht                  edge_table_;
+  /// sorted edge keys, 2 per edge in edge order
+  std::vector<index_type>       edge_keys_;
 
-  inline
-  void hash_edge(typename Node::index_type n1, typename Node::index_type n2,
-                 typename Cell::index_type ci, edge_ht &table) const;
+  /// Key of a face whose nodes went through order_face_nodes. The face may
+  /// be listed in either orientation: the nodes of a triangle are sorted and
+  /// the last one is repeated, for a quad the neighbors of the first node are
+  /// put in increasing order.
+  static inline void face_key(const typename Node::index_type* n, index_type* key)
+  {
+    if (n[3] == PRISM_DUMMY_NODE_INDEX)
+    {
+      key[0] = n[0]; key[1] = n[1]; key[2] = n[2];
+      SortedTopologyBuilder<3>::sort_key(key);
+      key[3] = key[2];
+      return;
+    }
 
-  inline
-  void hash_face(typename Node::index_type n1, typename Node::index_type n2,
-                 typename Node::index_type n3, typename Node::index_type n4,
-                 index_type combined_index, face_ht &table) const;
+    const index_type n1 = n[1], n2 = n[2], n3 = n[3];
+    key[0] = n[0];
+    if (n2 == n3)
+    {
+      key[1] = std::min(n1, n2);
+      key[2] = key[3] = std::max(n1, n2);
+    }
+    else
+    {
+      key[1] = std::min(n1, n3);
+      key[2] = n2;
+      key[3] = std::max(n1, n3);
+    }
+  }
+
+  inline index_type find_face(const PFace& f) const
+  {
+    index_type key[4];
+    face_key(f.nodes_, key);
+    return (SortedTopologyBuilder<4>::find(face_keys_, key));
+  }
+
+  inline index_type find_edge(const PEdge& e) const
+  {
+    const index_type key[2] = { e.nodes_[0], e.nodes_[1] };
+    return (SortedTopologyBuilder<2>::find(edge_keys_, key));
+  }
 
   template <class INDEX>
   bool order_face_nodes(INDEX& n1, INDEX& n2, INDEX& n3, INDEX& n4) const
@@ -2623,9 +2586,9 @@ PrismVolMesh<Basis>::PrismVolMesh() :
   points_(0),
   cells_(0),
   faces_(0),
-  face_table_(),
+  face_keys_(),
   edges_(0),
-  edge_table_(),
+  edge_keys_(),
   synchronize_lock_("PrismVolMesh Lock"),
   synchronize_cond_("PrismVolMesh condition variable"),
   synchronized_(Mesh::NODES_E | Mesh::CELLS_E),
@@ -2646,9 +2609,9 @@ PrismVolMesh<Basis>::PrismVolMesh(const PrismVolMesh &copy):
   points_(0),
   cells_(0),
   faces_(0),
-  face_table_(),
+  face_keys_(),
   edges_(0),
-  edge_table_(),
+  edge_keys_(),
   synchronize_lock_("PrismVolMesh Lock"),
   synchronize_cond_("PrismVolMesh condition variable"),
   synchronized_(Mesh::NODES_E | Mesh::CELLS_E),
@@ -2696,7 +2659,7 @@ PrismVolMesh<Basis>::fill_points(Iter begin, Iter end, Functor fill_ftor)
   synchronize_lock_.lock();
   Iter iter = begin;
   points_.resize(end - begin); // resize to the new size
-  std::vector<Core::Geometry::Point>::iterator piter = points_.begin();
+  std::vector<Core::Geometry::Point>::iterator piter = points_.mutate().begin();
   while (iter != end)
   {
     *piter = fill_ftor(*iter);
@@ -2713,7 +2676,7 @@ PrismVolMesh<Basis>::fill_cells(Iter begin, Iter end, Functor fill_ftor)
   synchronize_lock_.lock();
   Iter iter = begin;
   cells_.resize((end - begin) * 6); // resize to the new size
-  std::vector<under_type>::iterator citer = cells_.begin();
+  std::vector<under_type>::iterator citer = cells_.mutate().begin();
   while (iter != end)
   {
     int *nodes = fill_ftor(*iter); // returns an array of length NNODES
@@ -2851,8 +2814,8 @@ PrismVolMesh<Basis>::transform(const Core::Geometry::Transform &t)
 {
   synchronize_lock_.lock();
 
-  std::vector<Core::Geometry::Point>::iterator itr = points_.begin();
-  std::vector<Core::Geometry::Point>::iterator eitr = points_.end();
+  std::vector<Core::Geometry::Point>::iterator itr = points_.mutate().begin();
+  std::vector<Core::Geometry::Point>::iterator eitr = points_.mutate().end();
   while (itr != eitr)
   {
     *itr = t.project(*itr);
@@ -2888,166 +2851,141 @@ PrismVolMesh<Basis>::transform(const Core::Geometry::Transform &t)
 
 template <class Basis>
 void
-PrismVolMesh<Basis>::hash_face(typename Node::index_type n1,
-			       typename Node::index_type n2,
-			       typename Node::index_type n3,
-			       typename Node::index_type n4,
-			       index_type combined_index,
-			       face_ht &table) const
+PrismVolMesh<Basis>::compute_faces()
 {
-  // Reorder nodes while maintaining CCW or CW orientation
-  // Check for degenerate faces, if faces has degeneracy it
-  // will be ignored (e.g. nodes on opposite corners are equal,
-  // or more then two nodes are equal)
+  // 5 faces -- each is entered CCW from outside looking in, the triangular
+  // faces have a dummy fourth node
+  static const int face_nodes[5][4] = { {0,1,2,-1}, {5,4,3,-1}, {1,4,5,2},
+                                        {2,5,3,0}, {0,3,4,1} };
+  typedef SortedTopologyBuilder<4> builder_type;
 
-  if (!(order_face_nodes(n1,n2,n3,n4))) return;
-  PFace f(n1, n2, n3, n4);
+  const size_type num_cells = static_cast<size_type>(cells_.size() / 6);
+  const under_type* cells = cells_.empty() ? 0 : &cells_[0];
 
-  typename face_ht::iterator iter = table.find(f);
-  if (iter == table.end())
-  {
-    f.cells_[0] = combined_index;
-    table[f] = 0; // insert for the first time
-  }
-  else
+  // Nodes of local face f of cell c, ordered like the face table expects
+  auto get_face_nodes = [this, cells](index_type c, int f,
+                                      typename Node::index_type* n)
   {
-    PFace f = (*iter).first;
-    if (f.cells_[1] != MESH_NO_NEIGHBOR)
-    {
-      //TODO: inject new logger
-      /*
-      std::cerr << "PrismVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>3) << ", #" << (f.cells_[1]>>3) << ", and #" << (combined_index >> 3)
-           << " are illegally adjacent." << std::endl;*/
-    }
-    else if ((f.cells_[0]>>3) == (combined_index>>3))
-    {
-      //TODO: inject new logger
-      /*
-      std::cerr << "PrismVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>3) << " and #" << (combined_index>>3)
-           << " are the same." << std::endl;
-           */
-    }
-    else
+    const under_type* cell = cells + 6*c;
+    for (int k = 0; k < 4; k++)
     {
-      f.cells_[1] = combined_index; // add this cell
-      table.erase(iter);
-      table[f] = 0;
+      n[k] = (face_nodes[f][k] < 0) ? PRISM_DUMMY_NODE_INDEX :
+        typename Node::index_type(cell[face_nodes[f][k]]);
     }
-  }
-}
-
-template <class Basis>
-void
-PrismVolMesh<Basis>::compute_faces()
-{
-  face_table_.clear();
-
-  typename Cell::iterator ci, cie;
-  begin(ci); end(cie);
-  typename Node::array_type arr(6);
-  while (ci != cie)
-  {
-    get_nodes(arr, *ci);
-    // 5 faces -- each is entered CCW from outside looking in
-    index_type cell_index = (*ci)<<3;
-    hash_face(arr[0], arr[1], arr[2], PRISM_DUMMY_NODE_INDEX, cell_index, face_table_);
-    hash_face(arr[5], arr[4], arr[3], PRISM_DUMMY_NODE_INDEX, cell_index + 1, face_table_);
-    hash_face(arr[1], arr[4], arr[5], arr[2], cell_index + 2, face_table_);
-    hash_face(arr[2], arr[5], arr[3], arr[0], cell_index + 3, face_table_);
-    hash_face(arr[0], arr[3], arr[4], arr[1], cell_index + 4, face_table_);
-
-    ++ci;
-  }
+    return (order_face_nodes(n[0],n[1],n[2],n[3]));
+  };
 
-  // dump edges into the edges_ container.
-  faces_.resize(face_table_.size());
-  typename std::vector<PFace>::iterator f_iter = faces_.begin();
-  typename face_ht::iterator ht_iter = face_table_.begin();
+  builder_type builder;
+  builder.build(num_cells, 5, static_cast<size_type>(points_.size()),
+    [&get_face_nodes](index_type c, builder_type::Record* rec)
+    {
+      for (int f = 0; f < 5; f++)
+      {
+        typename Node::index_type n[4];
+        if (get_face_nodes(c, f, n))
+        {
+          face_key(n, rec[f].key);
+          rec[f].code = (c << 3) + f;
+        }
+        else
+        {
+          rec[f].code = -1;
+        }
+      }
+    });
 
-  boundary_faces_.resize(cells_.size() /6);
+  // A face is shared by at most two distinct cells; further occurrences
+  // indicate a broken mesh and are ignored. The face keeps the node order
+  // of the first cell it was found in.
+  const size_type num_faces = builder.size();
+  faces_.clear();
+  faces_.resize(num_faces);
+  Core::Thread::Parallel::For(0, num_faces, 1 << 14,
+    [this, &builder, &get_face_nodes](size_t begin, size_t end)
+    {
+      for (size_t u = begin; u < end; u++)
+      {
+        const builder_type::Record* rec = builder.begin(u);
+        const builder_type::Record* rec_end = builder.end(u);
+        PFace& face = faces_[u];
+        get_face_nodes(rec->code >> 3, rec->code & 0x7, face.nodes_);
+        face.cells_[0] = rec->code;
+        for (++rec; rec != rec_end; ++rec)
+        {
+          if ((rec->code >> 3) != (face.cells_[0] >> 3))
+          {
+            face.cells_[1] = rec->code;
+            break;
+          }
+        }
+      }
+    });
 
-  index_type i = 0;
-  while (ht_iter != face_table_.end())
+  boundary_faces_.assign(num_cells, 0);
+  for (index_type u = 0; u < num_faces; u++)
   {
-    *f_iter = (*ht_iter).first;
-    (*ht_iter).second = i;
-
-    if ((*f_iter).cells_[1] == -1)
+    if (faces_[u].cells_[1] == MESH_NO_NEIGHBOR)
     {
-      index_type cell = ((*f_iter).cells_[0]) >> 3;
-      index_type face = ((*f_iter).cells_[0]) & 0x7;
+      index_type cell = (faces_[u].cells_[0]) >> 3;
+      index_type face = (faces_[u].cells_[0]) & 0x7;
       boundary_faces_[cell] |= 1 << face;
     }
-    ++f_iter; ++ht_iter; i++;
   }
 
+  builder.swap_keys(face_keys_);
+
   synchronize_lock_.lock();
   synchronized_ |= Mesh::FACES_E;
   synchronize_lock_.unlock();
 }
 
-template <class Basis>
-void
-PrismVolMesh<Basis>::hash_edge(typename Node::index_type n1,
-			       typename Node::index_type n2,
-			       typename Cell::index_type ci,
-			       edge_ht &table) const
-{
-  if (n1 == n2) return;
-  PEdge e(n1, n2);
-  typename edge_ht::iterator iter = table.find(e);
-  if (iter == table.end())
-  {
-    e.cells_.push_back(ci); // add this cell
-    table[e] = 0; // insert for the first time
-  }
-  else
-  {
-    PEdge e = (*iter).first;
-    e.cells_.push_back(ci); // add this cell
-    table.erase(iter);
-    table[e] = 0;
-  }
-}
-
 template <class Basis>
 void
 PrismVolMesh<Basis>::compute_edges()
 {
-  typename Cell::iterator ci, cie;
-  begin(ci); end(cie);
-  typename Node::array_type arr;
-  while (ci != cie)
-  {
-    get_nodes(arr, *ci);
-    hash_edge(arr[0], arr[1], *ci, edge_table_);
-    hash_edge(arr[1], arr[2], *ci, edge_table_);
-    hash_edge(arr[2], arr[0], *ci, edge_table_);
+  static const int edge_nodes[9][2] = { {0,1}, {1,2}, {2,0},
+                                        {3,4}, {4,5}, {5,3},
+                                        {0,3}, {4,1}, {2,5} };
+  typedef SortedTopologyBuilder<2> builder_type;
 
-    hash_edge(arr[3], arr[4], *ci, edge_table_);
-    hash_edge(arr[4], arr[5], *ci, edge_table_);
-    hash_edge(arr[5], arr[3], *ci, edge_table_);
+  const size_type num_cells = static_cast<size_type>(cells_.size() / 6);
+  const under_type* cells = cells_.empty() ? 0 : &cells_[0];
 
-    hash_edge(arr[0], arr[3], *ci, edge_table_);
-    hash_edge(arr[4], arr[1], *ci, edge_table_);
-    hash_edge(arr[2], arr[5], *ci, edge_table_);
-    ++ci;
-  }
+  builder_type builder;
+  builder.build(num_cells, 9, static_cast<size_type>(points_.size()),
+    [cells](index_type c, builder_type::Record* rec)
+    {
+      const under_type* cell = cells + 6*c;
+      for (int e = 0; e < 9; e++)
+      {
+        rec[e].key[0] = cell[edge_nodes[e][0]];
+        rec[e].key[1] = cell[edge_nodes[e][1]];
+        builder_type::sort_key(rec[e].key);
+        // Collapsed edges of degenerate prisms are not edges
+        rec[e].code = (rec[e].key[0] == rec[e].key[1]) ? -1 : c;
+      }
+    });
 
   // dump edges into the edges_ container.
+  const size_type num_edges = builder.size();
+  edges_.clear();
+  edges_.resize(num_edges);
+  Core::Thread::Parallel::For(0, num_edges, 1 << 14,
+    [this, &builder](size_t begin, size_t end)
+    {
+      for (size_t u = begin; u < end; u++)
+      {
+        const builder_type::Record* rec = builder.begin(u);
+        PEdge& edge = edges_[u];
+        edge.nodes_[0] = rec->key[0];
+        edge.nodes_[1] = rec->key[1];
+        edge.cells_.reserve(builder.count(u));
+        for (; rec != builder.end(u); ++rec)
+          edge.cells_.push_back(rec->code);
+      }
+    });
 
-  edges_.resize(edge_table_.size());
-
-  typename std::vector<PEdge>::iterator e_iter = edges_.begin();
-  typename edge_ht::iterator ht_iter = edge_table_.begin();
-  while (ht_iter != edge_table_.end()) {
-    *e_iter = (*ht_iter).first;
-    (*ht_iter).second = static_cast<typename Edge::index_type>(
-                                                      e_iter - edges_.begin());
-    ++e_iter; ++ht_iter;
-  }
+  builder.swap_keys(edge_keys_);
 
   synchronize_lock_.lock();
   synchronized_ |= Mesh::EDGES_E;
@@ -3165,8 +3103,10 @@ PrismVolMesh<Basis>::synchronize(mask_type sync)
     boost::thread syncthread(syncclass);
   }
 
-  // Wait until threads are done
-  while ((synchronized_ & sync) != sync)
+  // Wait until threads are done. The compute functions mark their table
+  // before the thread is finished with the lock, so wait for the threads
+  // to clear their synchronizing_ bits as well.
+  while (((synchronized_ & sync) != sync) || (synchronizing_ & sync))
   {
     synchronize_cond_.wait(lock);
   }
@@ -3193,9 +3133,9 @@ PrismVolMesh<Basis>::clear_synchronization()
   // Free memory where possible
   node_neighbors_.clear();
   edges_.clear();
-  edge_table_.clear();
+  edge_keys_.clear();
   faces_.clear();
-  face_table_.clear();
+  face_keys_.clear();
   boundary_faces_.clear();
 
   node_grid_.reset();
@@ -3326,12 +3266,9 @@ PrismVolMesh<Basis>::get_face(typename Face::index_type &face,
   ASSERTMSG(synchronized_ & Mesh::FACES_E,
             "Must call synchronize FACES_E on PrismVolMesh first");
   if(!(order_face_nodes(n1,n2,n3,n4))) return (false);
-  PFace f(n1, n2, n3, n4);
-  typename face_ht::const_iterator fiter = face_table_.find(f);
-  if (fiter == face_table_.end()) {
-    return false;
-  }
-  face = (*fiter).second;
+  index_type fidx = find_face(PFace(n1, n2, n3, n4));
+  if (fidx == MESH_NO_NEIGHBOR) return false;
+  face = fidx;
   return true;
 }
 
@@ -111,7 +111,8 @@ public:
   virtual void set_nodes(VMesh::Node::array_type&,
                          VMesh::Face::index_type);  
 
-  virtual VMesh::index_type* get_elems_pointer() const;                          
+  virtual VMesh::index_type* mutable_elems_pointer();
+  virtual const VMesh::index_type* get_elems_pointer() const;
 };
 
 
@@ -371,10 +372,19 @@ VQuadSurfMesh<MESH>::set_nodes(VMesh::Node::array_type& nodes,
 template <class MESH>
 VMesh::index_type*
 VQuadSurfMesh<MESH>::
+mutable_elems_pointer()
+{
+  if (this->mesh_->faces_.size() == 0) return (0);
+  return (&(this->mesh_->faces_.mutate()[0]));
+}
+
+template <class MESH>
+const VMesh::index_type*
+VQuadSurfMesh<MESH>::
 get_elems_pointer() const
 {
   if (this->mesh_->faces_.size() == 0) return (0);
-   return (&(this->mesh_->faces_[0]));
+  return (&(this->mesh_->faces_[0]));
 }
 
 
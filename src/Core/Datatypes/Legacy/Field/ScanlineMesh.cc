@@ -1617,7 +1617,7 @@ public:
 
   private:
     VMesh::Cell::index_type  index_;
-    const std::vector<Point>&     points_;
+    const CopyOnWriteVector<Point>& points_;
     VMesh::Node::array_type  nodes_;
   };
 
@@ -1662,7 +1662,8 @@ public:
 
   virtual void set_point(const Point &point, VMesh::Node::index_type i);
   
-  virtual Point* get_points_pointer() const;
+  virtual const Point* get_points_pointer() const;
+  virtual Point* mutable_points_pointer();
   
   virtual void get_random_point(Point &p,
 				VMesh::Elem::index_type i,
@@ -1756,7 +1757,7 @@ protected:
     this->mesh_->inverse_jacobian(coords, typename MESH::Elem::index_type(idx),Ji);
   }
 
-  std::vector<Point>&        points_;
+  CopyOnWriteVector<Point>&  points_;
 };
 
 
@@ -1999,11 +2000,11 @@ template <class MESH>
 void 
 VStructCurveMesh<MESH>::set_point(const Point &point, VMesh::Node::index_type i)
 {
-  points_[i] = point;
+  points_.mutate()[i] = point;
 }
 
 template <class MESH>
-Point*
+const Point*
 VStructCurveMesh<MESH>::
 get_points_pointer() const
 {
@@ -2011,6 +2012,15 @@ get_points_pointer() const
   return (&(points_[0]));
 }
 
+template <class MESH>
+Point*
+VStructCurveMesh<MESH>::
+mutable_points_pointer()
+{
+  if (points_.size() == 0) return (0);
+  return (&(points_.mutate()[0]));
+}
+
 
 template <class MESH>
 void 
@@ -0,0 +1,256 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef CORE_DATATYPES_SORTEDTOPOLOGYBUILDER_H
+#define CORE_DATATYPES_SORTEDTOPOLOGYBUILDER_H 1
+
+#include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Thread/Parallel.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace SCIRun {
+
+/// Builds the unique faces or edges of an unstructured mesh without a hash
+/// table. Every element emits one record per local face (or edge) holding the
+/// sorted node tuple of that face and the combined element/local index the
+/// mesh uses to refer back to it. The records are radix sorted on the node
+/// tuple in parallel, after which all occurrences of the same face sit next to
+/// each other and a single linear pass finds the unique ones.
+///
+/// The radix sort is stable and the records are emitted in element order, so
+/// the occurrences of a face are listed in increasing element order and the
+/// unique faces come out sorted by node tuple. The latter makes the key array
+/// usable as a compact lookup index through find().
+template <int N>
+class SortedTopologyBuilder
+{
+public:
+  typedef Mesh::index_type index_type;
+  typedef Mesh::size_type  size_type;
+
+  struct Record
+  {
+    index_type key[N];
+    index_type code;
+  };
+
+  /// emit(elem, records) fills records_per_elem records for element elem.
+  /// Records whose code is negative (e.g. collapsed edges) are dropped.
+  template <class EMIT>
+  void build(size_type num_elems, int records_per_elem,
+             size_type num_nodes, EMIT emit)
+  {
+    records_.resize(static_cast<size_t>(num_elems) * records_per_elem);
+    Record* records = records_.empty() ? 0 : &records_[0];
+    Core::Thread::Parallel::For(0, num_elems, grain_size,
+      [&](size_t begin, size_t end)
+      {
+        for (size_t e = begin; e < end; ++e)
+          emit(static_cast<index_type>(e), records + e * records_per_elem);
+      });
+
+    records_.erase(std::remove_if(records_.begin(), records_.end(),
+      [](const Record& r) { return (r.code < 0); }), records_.end());
+
+    sort(num_nodes);
+
+    offsets_.clear();
+    offsets_.reserve(records_.size() / records_per_elem + 2);
+    for (size_t j = 0; j < records_.size(); ++j)
+    {
+      if (j == 0 || !same_key(records_[j-1], records_[j]))
+        offsets_.push_back(static_cast<index_type>(j));
+    }
+    offsets_.push_back(static_cast<index_type>(records_.size()));
+
+    keys_.resize((offsets_.size() - 1) * N);
+    for (size_t u = 0; u + 1 < offsets_.size(); ++u)
+      for (int k = 0; k < N; ++k)
+        keys_[u*N + k] = records_[offsets_[u]].key[k];
+  }
+
+  /// Number of unique faces/edges
+  inline size_type size() const
+    { return (offsets_.empty() ? 0 : static_cast<size_type>(offsets_.size() - 1)); }
+
+  /// Occurrences of unique face/edge idx, in increasing element order
+  inline const Record* begin(index_type idx) const
+    { return (&records_[0] + offsets_[idx]); }
+  inline const Record* end(index_type idx) const
+    { return (&records_[0] + offsets_[idx+1]); }
+  inline size_type count(index_type idx) const
+    { return (offsets_[idx+1] - offsets_[idx]); }
+
+  /// Hand the sorted unique node tuples (N per face/edge) over to the mesh
+  inline void swap_keys(std::vector<index_type>& keys) { keys.swap(keys_); }
+
+  /// Release the intermediate record storage
+  inline void clear()
+  {
+    std::vector<Record>().swap(records_);
+    std::vector<index_type>().swap(offsets_);
+    std::vector<index_type>().swap(keys_);
+  }
+
+  /// Sort a node tuple in place, which turns it into a lookup key.
+  static inline void sort_key(index_type* key)
+  {
+    for (int i = 1; i < N; ++i)
+    {
+      const index_type v = key[i];
+      int j = i - 1;
+      while (j >= 0 && key[j] > v) { key[j+1] = key[j]; --j; }
+      key[j+1] = v;
+    }
+  }
+
+  /// Binary search a sorted key in a key array produced by build(). Returns
+  /// the index of the face/edge or -1 if it does not exist.
+  static inline index_type find(const std::vector<index_type>& keys,
+                                const index_type* key)
+  {
+    index_type lo = 0;
+    index_type hi = static_cast<index_type>(keys.size() / N);
+    while (lo < hi)
+    {
+      const index_type mid = lo + ((hi - lo) >> 1);
+      const index_type* k = &keys[mid*N];
+      int c = 0;
+      for (int i = 0; i < N && c == 0; ++i)
+        c = (k[i] < key[i]) ? -1 : ((k[i] > key[i]) ? 1 : 0);
+      if (c == 0) return (mid);
+      if (c < 0) lo = mid + 1; else hi = mid;
+    }
+    return (-1);
+  }
+
+private:
+  static const size_t grain_size = 1 << 14;
+  static const int radix_bits = 11;
+  static const size_t radix_size = size_t(1) << radix_bits;
+
+  static inline bool same_key(const Record& a, const Record& b)
+  {
+    for (int k = 0; k < N; ++k) if (a.key[k] != b.key[k]) return (false);
+    return (true);
+  }
+
+  /// End of record chunk c, chunk c covers [c*grain_size, chunk_end(c, n))
+  static inline size_t chunk_end(size_t c, size_t n)
+    { return (std::min(n, (c + 1) * grain_size)); }
+
+  /// Parallel LSD radix sort over the key components, least significant
+  /// component first. Only as many digits as the node count requires are
+  /// processed. The histogram and scatter passes both work on the same fixed
+  /// record chunks, each chunk owning one histogram, so the scatter offsets
+  /// always match the records they were counted from.
+  void sort(size_type num_nodes)
+  {
+    const size_t n = records_.size();
+    if (n < 2) return;
+
+    if (n < grain_size)
+    {
+      std::stable_sort(records_.begin(), records_.end(),
+        [](const Record& a, const Record& b)
+        {
+          for (int k = 0; k < N; ++k)
+            if (a.key[k] != b.key[k]) return (a.key[k] < b.key[k]);
+          return (false);
+        });
+      return;
+    }
+
+    int bits = 1;
+    while (bits < 63 && (index_type(1) << bits) < num_nodes) ++bits;
+    const int passes = (bits + radix_bits - 1) / radix_bits;
+
+    const size_t chunks = (n + grain_size - 1) / grain_size;
+    std::vector<size_t> hist(chunks * radix_size);
+    std::vector<Record> buffer(n);
+    Record* src = &records_[0];
+    Record* dst = &buffer[0];
+
+    for (int k = N - 1; k >= 0; --k)
+    {
+      for (int p = 0; p < passes; ++p)
+      {
+        const int shift = p * radix_bits;
+        std::fill(hist.begin(), hist.end(), 0);
+
+        Core::Thread::Parallel::For(0, chunks, 1,
+          [&](size_t cbegin, size_t cend)
+          {
+            for (size_t c = cbegin; c < cend; ++c)
+            {
+              size_t* h = &hist[c * radix_size];
+              const size_t end = chunk_end(c, n);
+              for (size_t j = c * grain_size; j < end; ++j)
+                h[(src[j].key[k] >> shift) & (radix_size - 1)]++;
+            }
+          });
+
+        size_t sum = 0;
+        for (size_t d = 0; d < radix_size; ++d)
+          for (size_t c = 0; c < chunks; ++c)
+          {
+            const size_t v = hist[c*radix_size + d];
+            hist[c*radix_size + d] = sum;
+            sum += v;
+          }
+
+        Core::Thread::Parallel::For(0, chunks, 1,
+          [&](size_t cbegin, size_t cend)
+          {
+            for (size_t c = cbegin; c < cend; ++c)
+            {
+              size_t* h = &hist[c * radix_size];
+              const size_t end = chunk_end(c, n);
+              for (size_t j = c * grain_size; j < end; ++j)
+                dst[h[(src[j].key[k] >> shift) & (radix_size - 1)]++] = src[j];
+            }
+          });
+
+        std::swap(src, dst);
+      }
+    }
+
+    if (src != &records_[0]) records_.swap(buffer);
+  }
+
+  std::vector<Record>     records_;
+  std::vector<index_type> offsets_;
+  std::vector<index_type> keys_;
+};
+
+} // end namespace SCIRun
+
+#endif
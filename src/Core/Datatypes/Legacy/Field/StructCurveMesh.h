@@ -53,6 +53,7 @@
 #include <Core/GeometryPrimitives/CompGeom.h>
 
 #include <Core/Containers/Array2.h>
+#include <Core/Containers/CopyOnWriteVector.h>
 #include <Core/Datatypes/Legacy/Field/ScanlineMesh.h>
 
 #include <Core/Datatypes/Legacy/Field/share.h>
@@ -222,7 +223,7 @@ public:
   void get_point(Core::Geometry::Point &p, typename ScanlineMesh<Basis>::Node::index_type i) const
   { get_center(p,i); }
   void set_point(const Core::Geometry::Point &p, typename ScanlineMesh<Basis>::Node::index_type i)
-  { points_[i] = p; }
+  { points_.mutate()[i] = p; }
 
   void get_random_point(Core::Geometry::Point &p,
                         const typename ScanlineMesh<Basis>::Elem::index_type idx,
@@ -804,7 +805,9 @@ public:
   /// This function returns a handle for the virtual interface.
   static MeshHandle structcurve_maker(size_type x) { return boost::make_shared<StructCurveMesh<Basis>>(x);}
 
-  std::vector<Core::Geometry::Point>& get_points() { return (points_); }
+  /// The points are shared with copies of this mesh until either one
+  /// changes them through mutate().
+  CopyOnWriteVector<Core::Geometry::Point>& get_points() { return (points_); }
 
   virtual bool synchronize(mask_type sync);
   virtual bool unsynchronize(mask_type sync);
@@ -820,7 +823,7 @@ private:
 
   void compute_epsilon();
 
-  std::vector<Core::Geometry::Point> points_;
+  CopyOnWriteVector<Core::Geometry::Point> points_;
   mutable Core::Thread::Mutex synchronize_lock_;
   mask_type     synchronized_;  
   double        epsilon_;
@@ -953,7 +956,7 @@ StructCurveMesh<Basis>::transform(const Core::Geometry::Transform &t)
 
   while (i != ie) 
   {
-    points_[*i] = t.project(points_[*i]);
+    points_.mutate()[*i] = t.project(points_[*i]);
 
     ++i;
   }
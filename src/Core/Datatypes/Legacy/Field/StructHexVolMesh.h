@@ -54,6 +54,7 @@
 
 #include <Core/Thread/Mutex.h>
 #include <Core/Containers/Array3.h>
+#include <Core/Containers/CopyOnWrite.h>
 #include <Core/GeometryPrimitives/SearchGridT.h>
 
 #include <Core/GeometryPrimitives/Point.h>
@@ -223,7 +224,7 @@ public:
     LatVolMesh<Basis>::nj_ = dims[1];
     LatVolMesh<Basis>::nk_ = dims[2];
 
-    points_.resize(dims[2], dims[1], dims[0]);
+    points_.mutate().resize(dims[2], dims[1], dims[0]);
 
     /// Create a new virtual interface for this copy
     /// all pointers have changed hence create a new
@@ -798,7 +799,9 @@ public:
     return boost::make_shared<StructHexVolMesh<Basis>>(x,y,z);
   }
 
-  Array3<Core::Geometry::Point>& get_points() { return (points_); }
+  /// The points are shared with copies of this mesh until either one
+  /// changes them through mutate().
+  CopyOnWrite<Array3<Core::Geometry::Point> >& get_points() { return (points_); }
 
   bool inside(typename LatVolMesh<Basis>::Elem::index_type idx,
               const Core::Geometry::Point &p) const
@@ -1065,7 +1068,7 @@ private:
   { return points_(idx.k_, idx.j_, idx.i_); }
 
 
-  Array3<Core::Geometry::Point> points_;
+  CopyOnWrite<Array3<Core::Geometry::Point> > points_;
 
   boost::shared_ptr<SearchGridT<typename LatVolMesh<Basis>::Node::index_type> >  node_grid_;
   boost::shared_ptr<SearchGridT<typename LatVolMesh<Basis>::Elem::index_type> >  elem_grid_;
@@ -1103,7 +1106,7 @@ StructHexVolMesh<Basis>::StructHexVolMesh(size_type i,
                                           size_type j,
                                           size_type k) :
   LatVolMesh<Basis>(i, j, k, Core::Geometry::Point(0.0, 0.0, 0.0), Core::Geometry::Point(1.0, 1.0, 1.0)),
-  points_(k, j, i),
+  points_(Array3<Core::Geometry::Point>(k, j, i)),
   synchronize_lock_("Synchronize lock"),
   synchronized_(Mesh::ALL_ELEMENTS_E),
   epsilon_(0.0),
@@ -1192,7 +1195,7 @@ StructHexVolMesh<Basis>::transform(const Core::Geometry::Transform &t)
 
   while (i != ie)
   {
-    points_((*i).k_,(*i).j_,(*i).i_) =
+    points_.mutate()((*i).k_,(*i).j_,(*i).i_) =
       t.project(points_((*i).k_,(*i).j_,(*i).i_));
 
     ++i;
@@ -1587,7 +1590,7 @@ void
 StructHexVolMesh<Basis>::set_point(const Core::Geometry::Point &p,
 				   const typename LatVolMesh<Basis>::Node::index_type &idx)
 {
-  points_(idx.k_, idx.j_, idx.i_) = p;
+  points_.mutate()(idx.k_, idx.j_, idx.i_) = p;
 }
 
 template<class Basis>
@@ -1889,11 +1892,12 @@ StructHexVolMesh<Basis>::io(Piostream& stream)
     size_type dim2 = tpoints.dim2();
     size_type dim3 = tpoints.dim3();
 
-    points_.resize(dim3,dim2,dim1);
+    Array3<Core::Geometry::Point>& points = points_.mutate();
+    points.resize(dim3,dim2,dim1);
     for (size_type i=0; i<dim1; i++)
       for (size_type j=0; j<dim2; j++)
         for (size_type k=0; k<dim3; k++)
-           points_(k,j,i) = tpoints(i,j,k);
+           points(k,j,i) = tpoints(i,j,k);
   }
   else
   {
@@ -53,6 +53,7 @@
 #include <Core/GeometryPrimitives/CompGeom.h>
 
 #include <Core/Containers/Array2.h>
+#include <Core/Containers/CopyOnWrite.h>
 #include <Core/GeometryPrimitives/SearchGridT.h>
 #include <Core/Thread/Mutex.h>
 
@@ -122,7 +123,7 @@ public:
     ImageMesh<Basis>::ni_ = dims[0];
     ImageMesh<Basis>::nj_ = dims[1];
 
-    points_.resize(dims[1], dims[0]);
+    points_.mutate().resize(dims[1], dims[0]);
     normals_.resize(dims[1], dims[0]);
 
     /// Create a new virtual interface for this copy
@@ -974,7 +975,9 @@ public:
   /// This function returns a handle for the virtual interface.
   static MeshHandle structquadsurf_maker(size_type x ,size_type y) { return boost::make_shared<StructQuadSurfMesh<Basis>>(x,y); }
 
-  Array2<Core::Geometry::Point>& get_points() { return (points_); }
+  /// The points are shared with copies of this mesh until either one
+  /// changes them through mutate().
+  CopyOnWrite<Array2<Core::Geometry::Point> >& get_points() { return (points_); }
 
 
 
@@ -1005,7 +1008,7 @@ protected:
   index_type next(index_type i) { return ((i%4)==3) ? (i-3) : (i+1); }
   index_type prev(index_type i) { return ((i%4)==0) ? (i+3) : (i-1); }
 
-  Array2<Core::Geometry::Point>  points_;
+  CopyOnWrite<Array2<Core::Geometry::Point> > points_;
   Array2<Core::Geometry::Vector> normals_; /// normalized per node
 
   boost::shared_ptr<SearchGridT<typename ImageMesh<Basis>::Node::index_type > > node_grid_;
@@ -1044,7 +1047,7 @@ StructQuadSurfMesh<Basis>::StructQuadSurfMesh()
 template <class Basis>
 StructQuadSurfMesh<Basis>::StructQuadSurfMesh(size_type x, size_type y)
   : ImageMesh<Basis>(x, y, Core::Geometry::Point(0.0, 0.0, 0.0), Core::Geometry::Point(1.0, 1.0, 1.0)),
-    points_( y,x),
+    points_(Array2<Core::Geometry::Point>(y,x)),
     normals_( y,x),
     synchronize_lock_("StructQuadSurfMesh Normals Lock"),
     synchronized_(Mesh::ALL_ELEMENTS_E),
@@ -1130,7 +1133,7 @@ StructQuadSurfMesh<Basis>::transform(const Core::Geometry::Transform &t)
 
   while (i != ie) 
   {
-    points_((*i).j_,(*i).i_) = t.project(points_((*i).j_,(*i).i_));
+    points_.mutate()((*i).j_,(*i).i_) = t.project(points_((*i).j_,(*i).i_));
     ++i;
   }
 
@@ -1322,7 +1325,7 @@ void
 StructQuadSurfMesh<Basis>::set_point(const Core::Geometry::Point &point,
 				     const typename ImageMesh<Basis>::Node::index_type &index)
 {
-  points_(index.j_, index.i_) = point;
+  points_.mutate()(index.j_, index.i_) = point;
 }
 
 
@@ -1529,14 +1532,14 @@ template <class Basis>
 void
 StructQuadSurfMesh<Basis>::compute_normals()
 {
-  normals_.resize(points_.dim1(), points_.dim2()); /// 1 per node
+  normals_.resize(points_.get().dim1(), points_.get().dim2()); /// 1 per node
 
   /// build table of faces that touch each node
   Array2< std::vector<typename ImageMesh<Basis>::Face::index_type> >
-    node_in_faces(points_.dim1(), points_.dim2());
+    node_in_faces(points_.get().dim1(), points_.get().dim2());
 
   /// face normals (not normalized) so that magnitude is also the area.
-  Array2<Core::Geometry::Vector> face_normals((points_.dim1()-1),(points_.dim2()-1));
+  Array2<Core::Geometry::Vector> face_normals((points_.get().dim1()-1),(points_.get().dim2()-1));
 
   /// Computing normal per face.
   typename ImageMesh<Basis>::Node::array_type nodes(4);
@@ -1610,10 +1613,11 @@ StructQuadSurfMesh<Basis>::io(Piostream& stream)
     size_t dim1 = tpoints.dim1();
     size_t dim2 = tpoints.dim2();
     
-    points_.resize(dim2,dim1);
+    Array2<Core::Geometry::Point>& points = points_.mutate();
+    points.resize(dim2,dim1);
     for (size_t i=0; i<dim1; i++)
       for (size_t j=0; j<dim2; j++)
-           points_(j,i) = tpoints(i,j);
+           points(j,i) = tpoints(i,j);
   }
   else
   {
@@ -32,12 +32,18 @@
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Datatypes/Legacy/Field/TetVolMesh.h>
+#include <Core/Datatypes/Legacy/Field/SortedTopologyBuilder.h>
+#include <Core/Basis/TetLinearLgn.h>
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <set>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Basis;
 using namespace SCIRun::TestUtils;
 
 TEST(TetVolMeshTest, CheckMeshIteratorTetVolMesh)
@@ -70,3 +76,303 @@ TEST(TetVolMeshTest, CheckMeshIteratorTetVolMesh)
 }
 
 
+
+TEST(TetVolMeshTest, NodeSpanMatchesPerNodeAccess)
+{
+  FieldHandle tetmesh = CubeTetVolLinearBasis(NONE_E);
+  VMesh* mesh = tetmesh->vmesh();
+
+  VMesh::PointSpan points = mesh->node_span();
+  ASSERT_EQ(mesh->num_nodes(), points.size());
+  for (VMesh::Node::index_type idx = 0; idx < mesh->num_nodes(); ++idx)
+  {
+    EXPECT_EQ(mesh->get_point(idx), points[idx]);
+  }
+}
+
+TEST(TetVolMeshTest, ElemConnectivitySpanMatchesGetNodes)
+{
+  FieldHandle tetmesh = CubeTetVolLinearBasis(NONE_E);
+  VMesh* mesh = tetmesh->vmesh();
+
+  VMesh::IndexSpan cells = mesh->elem_connectivity_span();
+  ASSERT_EQ(mesh->num_elems()*4, cells.size());
+
+  VMesh::Node::array_type nodes;
+  for (VMesh::Elem::index_type idx = 0; idx < mesh->num_elems(); ++idx)
+  {
+    mesh->get_nodes(nodes, idx);
+    for (int j = 0; j < 4; ++j)
+      EXPECT_EQ(nodes[j], cells[4*idx + j]);
+  }
+}
+
+TEST(TetVolMeshTest, BulkPointAccessFillsStructureOfArrays)
+{
+  FieldHandle tetmesh = CubeTetVolLinearBasis(NONE_E);
+  VMesh* mesh = tetmesh->vmesh();
+
+  VMesh::NodeCoordinates coords;
+  mesh->get_node_coordinates(coords);
+  ASSERT_EQ(mesh->num_nodes(), coords.size());
+  EXPECT_EQ(0u, reinterpret_cast<size_t>(coords.x.data()) % 64);
+
+  std::vector<Point> points(mesh->num_nodes());
+  mesh->get_points(VMesh::Node::index_type(0),
+    VMesh::Node::index_type(mesh->num_nodes()), &points[0]);
+
+  for (VMesh::Node::index_type idx = 0; idx < mesh->num_nodes(); ++idx)
+  {
+    const Point p = mesh->get_point(idx);
+    EXPECT_EQ(p, points[idx]);
+    EXPECT_EQ(p.x(), coords.x[idx]);
+    EXPECT_EQ(p.y(), coords.y[idx]);
+    EXPECT_EQ(p.z(), coords.z[idx]);
+  }
+}
+
+TEST(TetVolMeshTest, RegularMeshHasNoNodeSpanButSupportsBulkAccess)
+{
+  FieldHandle latvol = CreateEmptyLatVol(3, 4, 5);
+  VMesh* mesh = latvol->vmesh();
+
+  EXPECT_TRUE(mesh->node_span().empty());
+  EXPECT_TRUE(mesh->elem_connectivity_span().empty());
+
+  std::vector<Point> points(mesh->num_nodes());
+  mesh->get_points(VMesh::Node::index_type(0),
+    VMesh::Node::index_type(mesh->num_nodes()), &points[0]);
+  for (VMesh::Node::index_type idx = 0; idx < mesh->num_nodes(); ++idx)
+  {
+    EXPECT_EQ(mesh->get_point(idx), points[idx]);
+  }
+}
+
+namespace
+{
+  std::vector<index_type> Sorted(const VMesh::Node::array_type& nodes)
+  {
+    std::vector<index_type> key(nodes.begin(), nodes.end());
+    std::sort(key.begin(), key.end());
+    return key;
+  }
+}
+
+TEST(TetVolMeshTest, FacesAndEdgesAreUniqueAndConsistentWithCells)
+{
+  // Large enough for the topology builder to take its radix sort path
+  FieldHandle field = TetBlockTetVolConstantBasis(10);
+  VMesh* mesh = field->vmesh();
+  mesh->synchronize(Mesh::EDGES_E | Mesh::FACES_E);
+
+  std::set<std::vector<index_type> > faces, edges;
+  VMesh::Node::array_type nodes, fnodes;
+  for (VMesh::Elem::index_type c = 0; c < mesh->num_elems(); ++c)
+  {
+    mesh->get_nodes(nodes, c);
+    for (int i = 0; i < 4; i++)
+    {
+      VMesh::Node::array_type f;
+      for (int j = 0; j < 4; j++) if (j != i) f.push_back(nodes[j]);
+      faces.insert(Sorted(f));
+      for (int j = i+1; j < 4; j++)
+      {
+        VMesh::Node::array_type e(2);
+        e[0] = nodes[i]; e[1] = nodes[j];
+        edges.insert(Sorted(e));
+      }
+    }
+  }
+  ASSERT_EQ(faces.size(), mesh->num_faces());
+  ASSERT_EQ(edges.size(), mesh->num_edges());
+
+  std::set<std::vector<index_type> > found;
+  for (VMesh::Face::index_type f = 0; f < mesh->num_faces(); ++f)
+  {
+    mesh->get_nodes(fnodes, f);
+    found.insert(Sorted(fnodes));
+  }
+  EXPECT_EQ(faces, found);
+
+  size_type boundary = 0;
+  VMesh::Face::array_type cfaces;
+  VMesh::Elem::array_type elems;
+  for (VMesh::Elem::index_type c = 0; c < mesh->num_elems(); ++c)
+  {
+    mesh->get_faces(cfaces, c);
+    ASSERT_EQ(4u, cfaces.size());
+    for (size_t i = 0; i < cfaces.size(); i++)
+    {
+      mesh->get_elems(elems, cfaces[i]);
+      EXPECT_NE(elems.end(), std::find(elems.begin(), elems.end(), c));
+      VMesh::Elem::index_type nbr;
+      if (!mesh->get_neighbor(nbr, c, VMesh::DElem::index_type(cfaces[i]))) boundary++;
+    }
+  }
+  // 6 sides of 10x10 squares, each split into two triangles
+  EXPECT_EQ(6*10*10*2, boundary);
+}
+
+TEST(TetVolMeshTest, InsertNodeAfterSynchronizeKeepsFacesConsistent)
+{
+  typedef TetVolMesh<TetLinearLgn<Point> > TVMesh;
+  TVMesh mesh;
+  mesh.add_point(Point(0, 0, 0));
+  mesh.add_point(Point(1, 0, 0));
+  mesh.add_point(Point(0, 1, 0));
+  mesh.add_point(Point(0, 0, 1));
+  mesh.add_point(Point(1, 1, 1));
+  mesh.add_tet(0, 1, 2, 3);
+  mesh.add_tet(1, 2, 3, 4);
+  mesh.synchronize(Mesh::EDGES_E | Mesh::FACES_E);
+
+  // Splitting a tet edits the face and edge tables in place
+  TVMesh::Elem::array_type newelems;
+  TVMesh::Node::index_type newnode;
+  ASSERT_TRUE(mesh.insert_node_in_elem(newelems, newnode, TVMesh::Elem::index_type(0),
+    Point(0.2, 0.2, 0.2)));
+  ASSERT_EQ(4u, newelems.size());
+
+  TVMesh::Face::array_type faces;
+  TVMesh::Elem::array_type elems;
+  for (size_t i = 0; i < newelems.size(); i++)
+  {
+    mesh.get_faces(faces, newelems[i]);
+    ASSERT_EQ(4u, faces.size());
+    for (size_t j = 0; j < faces.size(); j++)
+    {
+      mesh.get_elems(elems, faces[j]);
+      EXPECT_NE(elems.end(), std::find(elems.begin(), elems.end(), newelems[i]));
+    }
+  }
+}
+
+TEST(TetVolMeshTest, BVHLocateMatchesSearchGrid)
+{
+  FieldHandle gridField = TetBlockTetVolConstantBasis(6);
+  FieldHandle bvhField = TetBlockTetVolConstantBasis(6);
+  VMesh* grid = gridField->vmesh();
+  VMesh* bvh = bvhField->vmesh();
+  bvh->set_locate_accelerator(Mesh::BVH_LOCATE_E);
+  grid->synchronize(Mesh::LOCATE_E | Mesh::FACES_E);
+  bvh->synchronize(Mesh::LOCATE_E | Mesh::FACES_E);
+
+  // Points inside, on the boundary and outside of the block
+  std::vector<Point> points;
+  for (int i = 0; i < 400; i++)
+    points.push_back(Point(0.037*i - 2.0, 0.021*i - 1.5, 7.5 - 0.029*i));
+
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    VMesh::Elem::index_type e1 = 0, e2 = 0;
+    const bool in1 = grid->locate(e1, points[i]);
+    const bool in2 = bvh->locate(e2, points[i]);
+    // A point on a shared face may be reported in either tet
+    ASSERT_EQ(in1, in2);
+
+    double d1, d2;
+    Point r1, r2;
+    EXPECT_TRUE(grid->find_closest_elem(d1, r1, e1, points[i]));
+    EXPECT_TRUE(bvh->find_closest_elem(d2, r2, e2, points[i]));
+    EXPECT_NEAR(d1, d2, 1e-12);
+
+    VMesh::Node::index_type n1, n2;
+    EXPECT_TRUE(grid->find_closest_node(d1, r1, n1, points[i]));
+    EXPECT_TRUE(bvh->find_closest_node(d2, r2, n2, points[i]));
+    EXPECT_NEAR(d1, d2, 1e-12);
+  }
+
+  std::vector<VMesh::Elem::index_type> elems1, elems2;
+  grid->mlocate(elems1, points);
+  bvh->mlocate(elems2, points);
+  ASSERT_EQ(elems1.size(), elems2.size());
+  for (size_t i = 0; i < elems1.size(); i++)
+    EXPECT_EQ(elems1[i] < 0, elems2[i] < 0);
+}
+
+TEST(TetVolMeshTest, DeepCloneSharesElementsUntilTheyChange)
+{
+  FieldHandle original = CubeTetVolLinearBasis(NONE_E);
+  FieldHandle copy(original->deep_clone());
+  VMesh* omesh = original->vmesh();
+  VMesh* cmesh = copy->vmesh();
+  ASSERT_NE(omesh, cmesh);
+  EXPECT_EQ(omesh->get_elems_pointer(), cmesh->get_elems_pointer());
+  EXPECT_EQ(omesh->get_points_pointer(), cmesh->get_points_pointer());
+
+  // moving nodes only copies the nodes
+  const Point p0 = omesh->get_point(VMesh::Node::index_type(0));
+  cmesh->set_point(Point(5, 5, 5), VMesh::Node::index_type(0));
+  EXPECT_EQ(p0, omesh->get_point(VMesh::Node::index_type(0)));
+  EXPECT_NE(omesh->get_points_pointer(), cmesh->get_points_pointer());
+  EXPECT_EQ(omesh->get_elems_pointer(), cmesh->get_elems_pointer());
+
+  VMesh::Node::array_type nodes, flipped;
+  omesh->get_nodes(nodes, VMesh::Elem::index_type(0));
+  flipped = nodes;
+  std::swap(flipped[0], flipped[1]);
+  cmesh->set_nodes(flipped, VMesh::Elem::index_type(0));
+  EXPECT_NE(omesh->get_elems_pointer(), cmesh->get_elems_pointer());
+
+  VMesh::Node::array_type result;
+  omesh->get_nodes(result, VMesh::Elem::index_type(0));
+  EXPECT_EQ(nodes, result);
+  cmesh->get_nodes(result, VMesh::Elem::index_type(0));
+  EXPECT_EQ(flipped, result);
+}
+
+TEST(TetVolMeshTest, CloneSharesValuesUntilTheyChange)
+{
+  FieldHandle original = CubeTetVolLinearBasis(DOUBLE_E);
+  FieldHandle copy(original->clone());
+  VField* ofield = original->vfield();
+  VField* cfield = copy->vfield();
+  EXPECT_EQ(ofield->get_values_pointer(), cfield->get_values_pointer());
+
+  double before, after;
+  ofield->get_value(before, VMesh::index_type(0));
+  cfield->set_value(before + 1.0, VMesh::index_type(0));
+  EXPECT_NE(ofield->get_values_pointer(), cfield->get_values_pointer());
+
+  ofield->get_value(after, VMesh::index_type(0));
+  EXPECT_EQ(before, after);
+  cfield->get_value(after, VMesh::index_type(0));
+  EXPECT_EQ(before + 1.0, after);
+}
+
+TEST(SortedTopologyBuilderTest, RadixSortDoesNotDependOnCoreCount)
+{
+  // more records than one sort chunk, so the parallel radix sort is used
+  const Mesh::size_type num_elems = 100000, num_nodes = 5000;
+  auto emit = [](Mesh::index_type e, SortedTopologyBuilder<2>::Record* r)
+  {
+    r->key[0] = (e * 7919) % num_nodes;
+    r->key[1] = (e * 104729 + 13) % num_nodes;
+    SortedTopologyBuilder<2>::sort_key(r->key);
+    r->code = e;
+  };
+
+  std::vector<Mesh::index_type> expected;
+  for (unsigned int cores : { 1u, 0u })
+  {
+    Core::Thread::Parallel::SetMaximumCores(cores);
+    SortedTopologyBuilder<2> builder;
+    builder.build(num_elems, 1, num_nodes, emit);
+
+    size_t total = 0;
+    for (Mesh::index_type u = 0; u < builder.size(); ++u)
+    {
+      total += builder.count(u);
+      for (auto r = builder.begin(u) + 1; r < builder.end(u); ++r)
+        EXPECT_LT((r-1)->code, r->code);
+    }
+    EXPECT_EQ(static_cast<size_t>(num_elems), total);
+
+    std::vector<Mesh::index_type> keys;
+    builder.swap_keys(keys);
+    for (size_t u = 1; u < keys.size() / 2; ++u)
+      EXPECT_TRUE(std::lexicographical_compare(&keys[2*u-2], &keys[2*u], &keys[2*u], &keys[2*u+2]));
+    if (expected.empty()) expected = keys;
+    EXPECT_EQ(expected, keys);
+  }
+}
@@ -29,10 +29,13 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <boost/assign.hpp>
-#include <Core/Datatypes/Mesh/MeshFactory.h>
-#include <Core/Datatypes/Mesh/FieldInformation.h>
-#include <Core/Datatypes/Mesh/TriSurfMesh.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/FieldInformation.h>
+#include <Core/Datatypes/Legacy/Field/TriSurfMesh.h>
 
+using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Geometry;
 using ::testing::_;
@@ -246,4 +249,92 @@ TEST_F(LatticeVolumeMeshTests, CubeIterationTest)
       ostr.str());
   }
 }
-#endif
\ No newline at end of file
+#endif
+
+namespace
+{
+  // Surface of the unit cube with n x n quads, each split in two triangles,
+  // per side
+  FieldHandle SubdividedCubeTriSurf(int n)
+  {
+    FieldInformation fi("TriSurfMesh", 0, "double");
+    FieldHandle field = CreateField(fi);
+    VMesh* mesh = field->vmesh();
+    for (int side = 0; side < 6; side++)
+    {
+      const int axis = side / 2;
+      const double c = side % 2;
+      const index_type base = mesh->num_nodes();
+      for (int j = 0; j <= n; j++)
+        for (int i = 0; i <= n; i++)
+        {
+          double x[3];
+          x[axis] = c;
+          x[(axis+1)%3] = static_cast<double>(i)/n;
+          x[(axis+2)%3] = static_cast<double>(j)/n;
+          mesh->add_point(Point(x[0], x[1], x[2]));
+        }
+      for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+        {
+          const index_type n0 = base + j*(n+1) + i;
+          VMesh::Node::array_type tri(3);
+          tri[0] = n0; tri[1] = n0+1; tri[2] = n0+n+2;
+          mesh->add_elem(tri);
+          tri[1] = n0+n+2; tri[2] = n0+n+1;
+          mesh->add_elem(tri);
+        }
+    }
+    field->vfield()->resize_values();
+    return field;
+  }
+}
+
+TEST(TriSurfMeshTest, BVHLocateMatchesSearchGrid)
+{
+  FieldHandle gridField = SubdividedCubeTriSurf(8);
+  FieldHandle bvhField = SubdividedCubeTriSurf(8);
+  VMesh* grid = gridField->vmesh();
+  VMesh* bvh = bvhField->vmesh();
+  bvh->set_locate_accelerator(Mesh::BVH_LOCATE_E);
+  grid->synchronize(Mesh::LOCATE_E | Mesh::FIND_CLOSEST_E);
+  bvh->synchronize(Mesh::LOCATE_E | Mesh::FIND_CLOSEST_E);
+
+  // Points on the surface, inside and outside of the cube
+  std::vector<Point> points;
+  for (int i = 0; i < 300; i++)
+  {
+    points.push_back(Point(0.0071*i - 0.6, 0.0043*i - 0.2, 1.1 - 0.0057*i));
+    points.push_back(Point(0.0031*i, 0.0029*i + 0.05, 1.0));
+  }
+
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    VMesh::Elem::index_type e1 = 0, e2 = 0;
+    ASSERT_EQ(grid->locate(e1, points[i]), bvh->locate(e2, points[i]));
+
+    double d1, d2;
+    Point r1, r2;
+    EXPECT_TRUE(grid->find_closest_elem(d1, r1, e1, points[i]));
+    EXPECT_TRUE(bvh->find_closest_elem(d2, r2, e2, points[i]));
+    EXPECT_NEAR(d1, d2, 1e-12);
+
+    VMesh::Node::index_type n1, n2;
+    EXPECT_TRUE(grid->find_closest_node(d1, r1, n1, points[i]));
+    EXPECT_TRUE(bvh->find_closest_node(d2, r2, n2, points[i]));
+    EXPECT_NEAR(d1, d2, 1e-12);
+  }
+
+  std::vector<VMesh::Elem::index_type> elems1, elems2;
+  grid->mlocate(elems1, points);
+  bvh->mlocate(elems2, points);
+  ASSERT_EQ(elems1.size(), elems2.size());
+  for (size_t i = 0; i < elems1.size(); i++)
+    EXPECT_EQ(elems1[i] < 0, elems2[i] < 0);
+
+  // Guesses from the caller are only a starting point
+  std::vector<VMesh::Elem::index_type> guessed(points.size(), 5);
+  bvh->mlocate(guessed, points);
+  for (size_t i = 0; i < elems1.size(); i++)
+    EXPECT_EQ(elems1[i] < 0, guessed[i] < 0);
+}
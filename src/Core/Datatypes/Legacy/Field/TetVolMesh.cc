@@ -145,7 +145,8 @@ public:
                                      VMesh::Elem::index_type  elem,
                                      Point& point);
 
-  virtual VMesh::index_type* get_elems_pointer() const;
+  virtual VMesh::index_type* mutable_elems_pointer();
+  virtual const VMesh::index_type* get_elems_pointer() const;
   
   virtual double inscribed_circumscribed_radius_metric(VMesh::Elem::index_type idx) const;
 };
@@ -503,10 +504,19 @@ VTetVolMesh<MESH>::get_delems(VMesh::DElem::array_type &delems,
 template <class MESH>
 VMesh::index_type*
 VTetVolMesh<MESH>::
+mutable_elems_pointer()
+{
+  if (this->mesh_->cells_.size() == 0) return (0);
+  return (&(this->mesh_->cells_.mutate()[0]));
+}
+
+template <class MESH>
+const VMesh::index_type*
+VTetVolMesh<MESH>::
 get_elems_pointer() const
 {
   if (this->mesh_->cells_.size() == 0) return (0);
-   return (&(this->mesh_->cells_[0]));
+  return (&(this->mesh_->cells_[0]));
 }
 
 
@@ -35,9 +35,11 @@
 #include <Core/Datatypes/Legacy/Field/MeshSupport.h>
 
 #include <Core/Containers/StackVector.h>
+#include <Core/Containers/CopyOnWriteVector.h>
 #include <Core/Persistent/PersistentSTL.h>
 
 #include <Core/GeometryPrimitives/SearchGridT.h>
+#include <Core/GeometryPrimitives/SearchBVH.h>
 #include <Core/GeometryPrimitives/BBox.h>
 #include <Core/GeometryPrimitives/CompGeom.h>
 #include <Core/GeometryPrimitives/Point.h>
@@ -52,6 +54,7 @@
 #include <Core/Datatypes/Legacy/Field/FieldIterator.h>
 #include <Core/Datatypes/Legacy/Field/FieldRNG.h>
 #include <Core/Datatypes/Legacy/Field/Mesh.h>
+#include <Core/Datatypes/Legacy/Field/SortedTopologyBuilder.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Mesh/VirtualMeshFacade.h>
 #include <Core/Math/MiscMath.h>
@@ -411,6 +414,7 @@ public:
   virtual bool synchronize(mask_type mask) override;
   virtual bool unsynchronize(mask_type mask) override;
   bool clear_synchronization();
+  virtual void set_locate_accelerator(LocateAccelerator accelerator) override;
 
   /// Get the basis class.
   Basis& get_basis() { return basis_; }
@@ -648,7 +652,7 @@ public:
   void get_point(Core::Geometry::Point &result, typename Node::index_type index) const
   { result = points_[index]; }
   void set_point(const Core::Geometry::Point &point, typename Node::index_type index)
-  { points_[index] = point; }
+  { points_.mutate()[index] = point; }
   void get_random_point(Core::Geometry::Point &p, typename Elem::index_type i, FieldRNG &r) const;
 
   /// Normals for visualizations
@@ -918,6 +922,17 @@ public:
     ASSERTMSG(synchronized_ & Mesh::NODE_LOCATE_E,
 	      "TetVolMesh::find_closest_node requires synchronize(NODE_LOCATE_E).");
 
+    if (node_bvh_)
+    {
+      double dmin = maxdist;
+      const index_type idx = bvh_closest_node(p, dmin);
+      if (idx < 0) return (false);
+      node = INDEX(idx);
+      result = points_[idx];
+      pdist = sqrt(dmin);
+      return (true);
+    }
+
     // get grid sizes
     const size_type ni = node_grid_->get_ni()-1;
     const size_type nj = node_grid_->get_nj()-1;
@@ -1007,6 +1022,18 @@ public:
     ASSERTMSG(synchronized_ & Mesh::NODE_LOCATE_E,
         "TetVolMesh::find_closest_node requires synchronize(NODE_LOCATE_E).")
 
+    if (node_bvh_)
+    {
+      const double maxdist2 = maxdist*maxdist;
+      const Core::Geometry::Vector r(maxdist, maxdist, maxdist);
+      node_bvh_->lookup(Core::Geometry::BBox(p - r, p + r), [&](index_type ni)
+      {
+        if ((p - points_[ni]).length2() < maxdist2) nodes.push_back(ni);
+        return (false);
+      });
+      return (nodes.size() > 0);
+    }
+
     // get grid sizes
     const size_type ni = node_grid_->get_ni()-1;
     const size_type nj = node_grid_->get_nj()-1;
@@ -1079,6 +1106,23 @@ public:
     ASSERTMSG(synchronized_ & Mesh::NODE_LOCATE_E,
         "TetVolMesh::find_closest_node requires synchronize(NODE_LOCATE_E).")
 
+    if (node_bvh_)
+    {
+      const double maxdist2 = maxdist*maxdist;
+      const Core::Geometry::Vector r(maxdist, maxdist, maxdist);
+      node_bvh_->lookup(Core::Geometry::BBox(p - r, p + r), [&](index_type ni)
+      {
+        const double dist = (p - points_[ni]).length2();
+        if (dist < maxdist2)
+        {
+          nodes.push_back(ni);
+          distances.push_back(dist);
+        }
+        return (false);
+      });
+      return (nodes.size() > 0);
+    }
+
     // get grid sizes
     const size_type ni = node_grid_->get_ni()-1;
     const size_type nj = node_grid_->get_nj()-1;
@@ -1188,6 +1232,29 @@ public:
     ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
               "TetVolMesh: need to synchronize ELEM_LOCATE_E first");
 
+    if (elem_bvh_)
+    {
+      index_type idx;
+      if (bvh_locate_elem(idx, p))
+      {
+        pdist = 0.0;
+        result = p;
+        elem = static_cast<INDEX>(idx);
+        ElemData ed(*this, elem);
+        basis_.get_coords(coords, p, ed);
+        return (true);
+      }
+
+      double dmin = maxdist;
+      idx = bvh_closest_boundary(p, dmin, result);
+      if (idx < 0) return (false);
+      elem = INDEX(idx);
+      ElemData ed(*this, elem);
+      basis_.get_coords(coords, result, ed);
+      pdist = sqrt(dmin);
+      return (true);
+    }
+
     // First check are we inside an element
     SearchGridT<index_type>::iterator it, eit;
     if (elem_grid_->lookup(it, eit, p))
@@ -1493,8 +1560,10 @@ public:
 			   typename Elem::index_type ci,
 			   const Core::Geometry::Point &p);
 
-  /// must detach, if altering points!
-  std::vector<Core::Geometry::Point>& get_points() { return points_; }
+  /// The points are shared with copies of this mesh until either one
+  /// changes them, which only mutable_points() may do.
+  const std::vector<Core::Geometry::Point>& get_points() const { return points_.get(); }
+  std::vector<Core::Geometry::Point>& mutable_points() { return points_.mutate(); }
 
   int compute_checksum();
 
@@ -1593,19 +1662,19 @@ protected:
     {
       PEdgeNode e(n0, n1);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(edge_table_.find(e))).second));
+                                            find_edge(e)));
     }
     if (n1 != n2)
     {
       PEdgeNode e(n1, n2);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(edge_table_.find(e))).second));
+                                            find_edge(e)));
     }
     if (n2 != n0)
     {
       PEdgeNode e(n2, n0);
       array.push_back(static_cast<typename ARRAY::value_type>(
-                                            (*(edge_table_.find(e))).second));
+                                            find_edge(e)));
     }
  }
 
@@ -1630,37 +1699,37 @@ protected:
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
     n1 = cells_[off + 1]; n2 = cells_[off + 2];
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
     n1 = cells_[off + 2]; n2 = cells_[off    ];
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
     n1 = cells_[off    ]; n2 = cells_[off + 3];
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
     n1 = cells_[off + 1]; n2 = cells_[off + 3];
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
     n1 = cells_[off + 2]; n2 = cells_[off + 3];
     if (n1 != n2)
     {
       PEdge e(n1,n2);
-      array[i++] = (static_cast<T>((*(edge_table_.find(e))).second));
+      array[i++] = (static_cast<T>(find_edge(e)));
     }
   }
 
@@ -1691,13 +1760,13 @@ protected:
     PFaceNode f3(n0, n1, n2);
 
     array[0] = static_cast<typename ARRAY::value_type>(
-                                          (*(face_table_.find(f0))).second);
+                                          find_face(f0));
     array[1] = static_cast<typename ARRAY::value_type>(
-                                          (*(face_table_.find(f1))).second);
+                                          find_face(f1));
     array[2] = static_cast<typename ARRAY::value_type>(
-                                          (*(face_table_.find(f2))).second);
+                                          find_face(f2));
     array[3] = static_cast<typename ARRAY::value_type>(
-                                          (*(face_table_.find(f3))).second);
+                                          find_face(f3));
   }
 
   template<class ARRAY, class INDEX>
@@ -1734,19 +1803,19 @@ protected:
       const int *offset = TetVolEdgePerNodeTable[node_index];
 
       PEdgeNode e(cells_[cell_index+offset[0]],cells_[cell_index+offset[1]]);
-      typename edge_nt::const_iterator iter = edge_table_.find(e);
-      if (((edges_[iter->second].cells_[0])&(~0x7))==(cell_index<<1) )
-        array.push_back(typename ARRAY::value_type(iter->second));
+      index_type eidx = find_edge(e);
+      if (((edges_[eidx].cells_[0])&(~0x7))==(cell_index<<1) )
+        array.push_back(typename ARRAY::value_type(eidx));
 
       PEdgeNode e1(cells_[cell_index+offset[2]],cells_[cell_index+offset[3]]);
-      iter = edge_table_.find(e1);
-      if (((edges_[iter->second].cells_[0])&(~0x7))==(cell_index<<1) )
-        array.push_back(typename ARRAY::value_type(iter->second));
+      eidx = find_edge(e1);
+      if (((edges_[eidx].cells_[0])&(~0x7))==(cell_index<<1) )
+        array.push_back(typename ARRAY::value_type(eidx));
 
       PEdgeNode e2(cells_[cell_index+offset[4]],cells_[cell_index+offset[5]]);
-      iter = edge_table_.find(e2);
-      if (((edges_[iter->second].cells_[0])&(~0x7))==(cell_index<<1) )
-        array.push_back(typename ARRAY::value_type(iter->second));
+      eidx = find_edge(e2);
+      if (((edges_[eidx].cells_[0])&(~0x7))==(cell_index<<1) )
+        array.push_back(typename ARRAY::value_type(eidx));
     }
   }
 
@@ -1768,21 +1837,21 @@ protected:
       const int* off = TetVolFacePerEdgeTable[face_index];
 
       typename Node::index_type n1, n2, n3;
-      typename face_nt::const_iterator fiter;
+      index_type fidx;
 
       n1 = cells_[cell_index+off[0]]; n2 = cells_[cell_index+off[1]];
       n3 = cells_[cell_index+off[2]];
 
-      fiter = face_table_.find(PFaceNode(n1,n2,n3));
-      if (((faces_[fiter->second].cells_[0])&(~0x3)) == cell_index)
-        array.push_back(typename ARRAY::value_type(fiter->second));
+      fidx = find_face(PFaceNode(n1,n2,n3));
+      if (((faces_[fidx].cells_[0])&(~0x3)) == cell_index)
+        array.push_back(typename ARRAY::value_type(fidx));
 
       n1 = cells_[cell_index+off[3]]; n2 = cells_[cell_index+off[4]];
       n3 = cells_[cell_index+off[5]];
 
-      fiter = face_table_.find(PFaceNode(n1,n2,n3));
-      if (((faces_[fiter->second].cells_[0])&(~0x3)) == cell_index)
-        array.push_back(typename ARRAY::value_type(fiter->second));
+      fidx = find_face(PFaceNode(n1,n2,n3));
+      if (((faces_[fidx].cells_[0])&(~0x3)) == cell_index)
+        array.push_back(typename ARRAY::value_type(fidx));
     }
   }
 
@@ -1812,21 +1881,21 @@ protected:
       PFaceNode e(cells_[cell_index+offset[0]],
                   cells_[cell_index+offset[1]],cells_[cell_index+offset[2]]);
 
-      typename face_nt::const_iterator iter = face_table_.find(e);
-      if (((faces_[iter->second].cells_[0])&(~0x3))==cell_index)
-        array.push_back(typename ARRAY::value_type(iter->second));
+      index_type fidx = find_face(e);
+      if (((faces_[fidx].cells_[0])&(~0x3))==cell_index)
+        array.push_back(typename ARRAY::value_type(fidx));
 
       PFaceNode e1(cells_[cell_index+offset[3]],cells_[cell_index+offset[4]],
         cells_[cell_index+offset[5]]);
-      iter = face_table_.find(e1);
-      if (((faces_[iter->second].cells_[0])&(~0x3))==cell_index )
-        array.push_back(typename ARRAY::value_type(iter->second));
+      fidx = find_face(e1);
+      if (((faces_[fidx].cells_[0])&(~0x3))==cell_index )
+        array.push_back(typename ARRAY::value_type(fidx));
 
       PFaceNode e2(cells_[cell_index+offset[6]],cells_[cell_index+offset[7]],
         cells_[cell_index+offset[8]]);
-      iter = face_table_.find(e2);
-      if (((faces_[iter->second].cells_[0])&(~0x3))==cell_index )
-        array.push_back(typename ARRAY::value_type(iter->second));
+      fidx = find_face(e2);
+      if (((faces_[fidx].cells_[0])&(~0x3))==cell_index )
+        array.push_back(typename ARRAY::value_type(fidx));
     }
   }
 
@@ -1860,8 +1929,9 @@ protected:
   template <class ARRAY, class INDEX>
   inline void set_nodes_by_elem(ARRAY &array, INDEX idx)
   {
+    std::vector<under_type>& cells = cells_.mutate();
     for (index_type n = 0; n < 4; ++n)
-      cells_[idx * 4 + n] = static_cast<index_type>(array[n]);
+      cells[idx * 4 + n] = static_cast<index_type>(array[n]);
   }
 
   template <class INDEX1, class INDEX2>
@@ -1967,6 +2037,13 @@ protected:
     ASSERTMSG(synchronized_ & Mesh::NODE_LOCATE_E,
               "TetVolMesh::locate_node requires synchronize(NODE_LOCATE_E).")
 
+    if (node_bvh_)
+    {
+      double dmin = DBL_MAX;
+      node = INDEX(bvh_closest_node(p, dmin));
+      return (true);
+    }
+
     // get grid sizes
     const size_type ni = node_grid_->get_ni()-1;
     const size_type nj = node_grid_->get_nj()-1;
@@ -2116,6 +2193,14 @@ protected:
     ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
                 "TetVolMesh: need to synchronize ELEM_LOCATE_E first");
 
+    if (elem_bvh_)
+    {
+      index_type idx;
+      if (!bvh_locate_elem(idx, p)) return (false);
+      elem = static_cast<INDEX>(idx);
+      return (true);
+    }
+
     typename SearchGridT<index_type>::iterator it, eit;
     if (elem_grid_->lookup(it, eit, p))
     {
@@ -2141,6 +2226,20 @@ protected:
               "TetVolMesh::locate_elems requires synchronize(ELEM_LOCATE_E).")
 
     array.clear();
+    if (elem_bvh_)
+    {
+      const size_type sz = static_cast<size_type>(cells_.size() >> 2);
+      elem_bvh_->lookup(b, [&](index_type ci)
+      {
+        if (ci >= sz) return (false);
+        size_t p=0;
+        for (;p<array.size();p++) if (array[p] == typename ARRAY::value_type(ci)) break;
+        if (p == array.size()) array.push_back(typename ARRAY::value_type(ci));
+        return (false);
+      });
+      return (array.size() > 0);
+    }
+
     index_type is,js,ks;
     index_type ie,je,ke;
     elem_grid_->locate_clamp(is,js,ks,b.get_min());
@@ -2189,6 +2288,16 @@ protected:
     ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
                 "TetVolMesh: need to synchronize ELEM_LOCATE_E first");
 
+    if (elem_bvh_)
+    {
+      index_type idx;
+      if (!bvh_locate_elem(idx, p)) return (false);
+      elem = static_cast<INDEX>(idx);
+      ElemData ed(*this, elem);
+      basis_.get_coords(coords, p, ed);
+      return (true);
+    }
+
     typename SearchGridT<index_type>::iterator it, eit;
     if (elem_grid_->lookup(it, eit, p))
     {
@@ -2270,6 +2379,13 @@ protected:
   void insert_node_into_grid(typename Node::index_type ci);
   void remove_node_from_grid(typename Node::index_type ci);
 
+  /// Lookups in node_bvh_ and elem_bvh_, the counterparts of the search grid
+  /// loops in the locate and find_closest functions
+  bool bvh_locate_elem(index_type& elem, const Core::Geometry::Point& p) const;
+  index_type bvh_closest_node(const Core::Geometry::Point& p, double& dmin2) const;
+  index_type bvh_closest_boundary(const Core::Geometry::Point& p, double& dmin2,
+                                  Core::Geometry::Point& result) const;
+
   const Core::Geometry::Point &point(typename Node::index_type i) { return points_[i]; }
 
   template<class INDEX>
@@ -2327,10 +2443,11 @@ protected:
   }
 
   /// all the nodes.
-  std::vector<Core::Geometry::Point>         points_;
+  CopyOnWriteVector<Core::Geometry::Point>         points_;
 
   /// each 4 indicies make up a tet
-  std::vector<under_type>    cells_;
+  /// shared between copies of the mesh until modified
+  CopyOnWriteVector<under_type> cells_;
 
   /// Face information.
   class PFaceCell {
@@ -2550,9 +2667,7 @@ protected:
     }
   };
 
-  using face_ht = boost::unordered_map<PFace, typename Face::index_type, FaceHash>;
   using face_nt = boost::unordered_map<PFaceNode, typename Face::index_type, FaceHash>;
-  using edge_ht = boost::unordered_map<PEdge, typename Edge::index_type, EdgeHash>;
   using edge_nt = boost::unordered_map<PEdgeNode, typename Edge::index_type, EdgeHash>;
 
   typedef std::vector<PFaceCell> face_ct;
@@ -2563,22 +2678,52 @@ protected:
   /// container for face storage. Must be computed each time
   ///  nodes or cells change.
   face_ct faces_;
+  /// sorted node triples of all faces, face i has key face_keys_[3*i..3*i+2]
+  std::vector<index_type> face_keys_;
+  /// hash index of the faces, only built once the mesh is edited in place
   face_nt face_table_;
   /// container for edge storage. Must be computed each time
   ///  nodes or cells change.
   edge_ct edges_;
+  /// sorted node pairs of all edges, edge i has key edge_keys_[2*i..2*i+1]
+  std::vector<index_type> edge_keys_;
+  /// hash index of the edges, only built once the mesh is edited in place
   edge_nt edge_table_;
 
+  /// Look up a face or edge by its nodes. Returns MESH_NO_NEIGHBOR if the
+  /// face or edge does not exist.
+  inline index_type find_face(const PFaceNode& f) const
+  {
+    if (face_keys_.empty())
+    {
+      typename face_nt::const_iterator iter = face_table_.find(f);
+      return (iter == face_table_.end() ? MESH_NO_NEIGHBOR : index_type(iter->second));
+    }
+    const index_type key[3] = { f.nodes_[0], f.nodes_[1], f.nodes_[2] };
+    return (SortedTopologyBuilder<3>::find(face_keys_, key));
+  }
+
+  inline index_type find_edge(const PEdgeNode& e) const
+  {
+    if (edge_keys_.empty())
+    {
+      typename edge_nt::const_iterator iter = edge_table_.find(e);
+      return (iter == edge_table_.end() ? MESH_NO_NEIGHBOR : index_type(iter->second));
+    }
+    const index_type key[2] = { e.nodes_[0], e.nodes_[1] };
+    return (SortedTopologyBuilder<2>::find(edge_keys_, key));
+  }
+
+  /// The sorted key arrays cannot absorb in place edits, hence the first
+  /// edit moves the lookup over to the hash tables.
+  void build_face_table();
+  void build_edge_table();
+
   inline void remove_edge(typename Node::index_type n1,
 			  typename Node::index_type n2,
 			  typename Cell::index_type ci,
 			  bool table_only = false);
 
-  inline void hash_edge(typename Node::index_type n1,
-                        typename Node::index_type n2,
-                        index_type combined_index,
-                        edge_ht& table);
-
   inline void add_edge(typename Node::index_type n1,
                         typename Node::index_type n2,
                         index_type combined_index);
@@ -2588,10 +2733,6 @@ protected:
                           typename Node::index_type n3,
                           typename Cell::index_type ci,
                           bool table_only = false);
-  inline void hash_face(typename Node::index_type n1,
-                        typename Node::index_type n2,
-                        typename Node::index_type n3,
-                        index_type ci, face_ht& table);
   inline void add_face(typename Node::index_type n1,
                        typename Node::index_type n2,
                        typename Node::index_type n3,
@@ -2608,6 +2749,12 @@ protected:
   boost::shared_ptr<SearchGridT<index_type> >  node_grid_;
   boost::shared_ptr<SearchGridT<index_type> >  elem_grid_;
 
+  /// With BVH_LOCATE_E these trees replace the grids above, they hold the
+  /// bounding boxes of the nodes and of the tets respectively.
+  Mesh::LocateAccelerator                      locate_accelerator_;
+  boost::shared_ptr<SearchBVH>                 node_bvh_;
+  boost::shared_ptr<SearchBVH>                 elem_bvh_;
+
   // Lock and Condition Variable for hand shaking
   mutable Core::Thread::Mutex                 synchronize_lock_;
   Core::Thread::ConditionVariable             synchronize_cond_;
@@ -2661,9 +2808,12 @@ TetVolMesh<Basis>::TetVolMesh() :
   points_(0),
   cells_(0),
   faces_(0),
+  face_keys_(0),
   face_table_(),
   edges_(0),
+  edge_keys_(0),
   edge_table_(),
+  locate_accelerator_(Mesh::GRID_LOCATE_E),
   synchronize_lock_("TetVolMesh lock"),
   synchronize_cond_("TetVolMesh condition variable"),
   synchronized_(Mesh::NODES_E | Mesh::CELLS_E),
@@ -2683,9 +2833,12 @@ TetVolMesh<Basis>::TetVolMesh(const TetVolMesh &copy) :
   points_(0),
   cells_(0),
   faces_(0),
+  face_keys_(0),
   face_table_(),
   edges_(0),
+  edge_keys_(0),
   edge_table_(),
+  locate_accelerator_(Mesh::GRID_LOCATE_E),
   synchronize_lock_("TetVolMesh lock"),
   synchronize_cond_("TetVolMesh condition variable"),
   synchronized_(Mesh::NODES_E | Mesh::CELLS_E),
@@ -2703,6 +2856,7 @@ TetVolMesh<Basis>::TetVolMesh(const TetVolMesh &copy) :
 
   points_ = copy.points_;
   cells_ = copy.cells_;
+  locate_accelerator_ = copy.locate_accelerator_;
 
   // Epsilon does not require much space, hence copy those
   synchronized_ |= copy.synchronized_ & Mesh::BOUNDING_BOX_E;
@@ -2733,7 +2887,7 @@ TetVolMesh<Basis>::fill_points(Iter begin, Iter end, Functor fill_ftor)
   synchronize_lock_.lock();
   Iter iter = begin;
   points_.resize(end - begin); // resize to the new size
-  std::vector<Core::Geometry::Point>::iterator piter = points_.begin();
+  std::vector<Core::Geometry::Point>::iterator piter = points_.mutate().begin();
   while (iter != end)
   {
     *piter = fill_ftor(*iter);
@@ -2750,7 +2904,7 @@ TetVolMesh<Basis>::fill_cells(Iter begin, Iter end, Functor fill_ftor)
   synchronize_lock_.lock();
   Iter iter = begin;
   cells_.resize((end - begin) * 4); // resize to the new size
-  std::vector<under_type>::iterator citer = cells_.begin();
+  std::vector<under_type>::iterator citer = cells_.mutate().begin();
   while (iter != end)
   {
     index_type *nodes = fill_ftor(*iter); // returns an array of length 4
@@ -2869,8 +3023,8 @@ TetVolMesh<Basis>::transform(const Core::Geometry::Transform &t)
 {
   synchronize_lock_.lock();
 
-  std::vector<Core::Geometry::Point>::iterator itr = points_.begin();
-  std::vector<Core::Geometry::Point>::iterator eitr = points_.end();
+  std::vector<Core::Geometry::Point>::iterator itr = points_.mutate().begin();
+  std::vector<Core::Geometry::Point>::iterator eitr = points_.mutate().end();
   while (itr != eitr)
   {
     *itr = t.project(*itr);
@@ -2902,6 +3056,10 @@ TetVolMesh<Basis>::transform(const Core::Geometry::Transform &t)
   if (node_grid_) { node_grid_->transform(t); }
   if (elem_grid_) { elem_grid_->transform(t); }
 
+  // The boxes in a tree do not transform, rebuild on the next synchronize
+  if (node_bvh_) { node_bvh_.reset(); synchronized_ &= ~(Mesh::NODE_LOCATE_E); }
+  if (elem_bvh_) { elem_bvh_.reset(); synchronized_ &= ~(Mesh::ELEM_LOCATE_E); }
+
   synchronize_lock_.unlock();
 }
 
@@ -2913,6 +3071,7 @@ TetVolMesh<Basis>::remove_face(typename Node::index_type n1,
 			       typename Cell::index_type ci,
 			       bool /*table_only*/)
 {
+  if (!face_keys_.empty()) build_face_table();
   PFaceNode f(n1, n2, n3);
   typename face_nt::iterator iter = face_table_.find(f);
 
@@ -2949,103 +3108,85 @@ TetVolMesh<Basis>::remove_face(typename Node::index_type n1,
   }
 }
 
-template <class Basis>
-void
-TetVolMesh<Basis>::hash_face(typename Node::index_type n1,
-                             typename Node::index_type n2,
-                             typename Node::index_type n3,
-                             index_type combined_index,
-                             face_ht& table)
-{
-  PFace f(n1, n2, n3);
-
-  typename face_ht::iterator iter = table.find(f);
-  if (iter == table.end())
-  {
-    f.cells_[0] = combined_index;
-    table[f] = 0; // insert for the first time
-  }
-  else
-  {
-    PFace f = (*iter).first;
-    if (f.cells_[1] != MESH_NO_NEIGHBOR)
-    {
-      //TODO: inject new logger
-      /*
-      std::cerr << "TetVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>2) << ", #" << (f.cells_[1]>>2) << ", and #"
-           << (combined_index>>2) << " are illegally adjacent." << std::endl;
-           */
-    }
-    else if ((f.cells_[0]>>2) == (combined_index>>2))
-    {
-      //TODO: inject new logger
-      /*
-      std::cerr << "TetVolMesh - This Mesh has problems: Cells #"
-           << (f.cells_[0]>>2) << " and #" << (combined_index>>2)
-           << " are the same." << std::endl;*/
-    }
-    else
-    {
-      f.cells_[1] = combined_index; // add this cell
-      table.erase(iter);
-      table[f] = 0;
-    }
-  }
-}
-
 template <class Basis>
 void
 TetVolMesh<Basis>::compute_faces()
 {
-  typename Cell::iterator ci, cie;
-  begin(ci); end(cie);
-  typename Node::array_type arr(4);
+  // 4 faces -- each is entered CCW from outside looking in
+  static const int face_nodes[4][3] = { {0,2,1}, {1,2,3}, {0,1,3}, {0,3,2} };
+  typedef SortedTopologyBuilder<3> builder_type;
 
-  face_ht table;
-
-  while (ci != cie)
-  {
-    get_nodes(arr, *ci);
-    // 4 faces -- each is entered CCW from outside looking in
+  const size_type num_cells = static_cast<size_type>(cells_.size() >> 2);
+  const under_type* cells = cells_.empty() ? 0 : &cells_[0];
 
-    index_type cell_index = (*ci)<<2;
-    hash_face(arr[0], arr[2], arr[1], cell_index, table);
-    hash_face(arr[1], arr[2], arr[3], cell_index + 1, table);
-    hash_face(arr[0], arr[1], arr[3], cell_index + 2, table);
-    hash_face(arr[0], arr[3], arr[2], cell_index + 3, table);
-    ++ci;
-  }
-
-  faces_.resize(table.size());
-
-  typename face_ht::iterator ht_iter = table.begin();
-  typename face_ht::iterator ht_iter_end = table.end();
+  builder_type builder;
+  builder.build(num_cells, 4, static_cast<size_type>(points_.size()),
+    [cells](index_type c, builder_type::Record* rec)
+    {
+      const under_type* cell = cells + 4*c;
+      for (int f = 0; f < 4; f++)
+      {
+        for (int k = 0; k < 3; k++) rec[f].key[k] = cell[face_nodes[f][k]];
+        builder_type::sort_key(rec[f].key);
+        rec[f].code = (c << 2) + f;
+      }
+    });
 
-  boundary_faces_.resize(cells_.size() >> 2);
+  // A face is shared by at most two distinct cells; further occurrences
+  // indicate a broken mesh and are ignored.
+  const size_type num_faces = builder.size();
+  faces_.clear();
+  faces_.resize(num_faces);
+  Core::Thread::Parallel::For(0, num_faces, 1 << 14,
+    [this, &builder](size_t begin, size_t end)
+    {
+      for (size_t u = begin; u < end; u++)
+      {
+        const builder_type::Record* rec = builder.begin(u);
+        const builder_type::Record* rec_end = builder.end(u);
+        PFaceCell& face = faces_[u];
+        face.cells_[0] = rec->code;
+        for (++rec; rec != rec_end; ++rec)
+        {
+          if ((rec->code >> 2) != (face.cells_[0] >> 2))
+          {
+            face.cells_[1] = rec->code;
+            break;
+          }
+        }
+      }
+    });
 
-  index_type uidx = 0;
-  while (ht_iter != ht_iter_end)
+  boundary_faces_.assign(num_cells, 0);
+  for (index_type u = 0; u < num_faces; u++)
   {
-    const PFace& pface = (*ht_iter).first;
-    faces_[uidx].cells_[0] = pface.cells_[0];
-    faces_[uidx].cells_[1] = pface.cells_[1];
-    face_table_[PFaceNode(pface.nodes_[0],pface.nodes_[1],pface.nodes_[2])] = uidx;
-
-    if (pface.cells_[1] == -1)
+    if (faces_[u].cells_[1] == MESH_NO_NEIGHBOR)
     {
-      index_type cell = (pface.cells_[0]) >> 2;
-      index_type face = (pface.cells_[0]) & 0x3;
+      index_type cell = (faces_[u].cells_[0]) >> 2;
+      index_type face = (faces_[u].cells_[0]) & 0x3;
       boundary_faces_[cell] |= 1 << face;
     }
-    ++ht_iter; uidx++;
   }
 
+  builder.swap_keys(face_keys_);
+  face_table_.clear();
+
   synchronize_lock_.lock();
   synchronized_ |= Mesh::FACES_E;
   synchronize_lock_.unlock();
+}
 
-
+template <class Basis>
+void
+TetVolMesh<Basis>::build_face_table()
+{
+  const size_type num_faces = static_cast<size_type>(face_keys_.size() / 3);
+  for (index_type u = 0; u < num_faces; u++)
+  {
+    face_table_[PFaceNode(face_keys_[3*u], face_keys_[3*u+1],
+                          face_keys_[3*u+2])] = u;
+  }
+  std::vector<index_type>().swap(face_keys_);
 }
 
 
@@ -3056,6 +3197,7 @@ TetVolMesh<Basis>::add_face(typename Node::index_type n1,
                             typename Node::index_type n3,
                             index_type combined_index)
 {
+  if (!face_keys_.empty()) build_face_table();
 
   PFaceNode e(n1,n2,n3);
   typename face_nt::iterator nt_iter = face_table_.find(e);
@@ -3083,77 +3225,75 @@ TetVolMesh<Basis>::add_face(typename Node::index_type n1,
   }
 }
 
-template <class Basis>
-void
-TetVolMesh<Basis>::hash_edge(typename Node::index_type n1,
-                             typename Node::index_type n2,
-                             index_type combined_index,
-                             edge_ht& table)
-{
-  if (n1 == n2) return;
-  PEdge e(n1, n2);
-  typename edge_ht::iterator iter = table.find(e);
-
-  if (iter == table.end())
-  {
-    e.cells_.push_back(combined_index); // add this cell
-    table[e] = 0; // insert for the first time
-  }
-  else
-  {
-    PEdge e = (*iter).first;
-    e.cells_.push_back(combined_index); // add this cell
-    table.erase(iter);
-    table[e] = 0;
-  }
-}
-
 template <class Basis>
 void
 TetVolMesh<Basis>::compute_edges()
 {
-  typename Cell::iterator ci, cie;
-  begin(ci); end(cie);
-  edge_ht table;
+  static const int edge_nodes[6][2] = { {0,1}, {1,2}, {2,0}, {3,0}, {3,1}, {3,2} };
+  typedef SortedTopologyBuilder<2> builder_type;
 
-  typename Node::array_type arr;
-  while (ci != cie)
-  {
-    get_nodes(arr, *ci);
-    index_type cell_index = (*ci)<<3;
-    hash_edge(arr[0], arr[1], cell_index  ,table);
-    hash_edge(arr[1], arr[2], cell_index+1,table);
-    hash_edge(arr[2], arr[0], cell_index+2,table);
-    hash_edge(arr[3], arr[0], cell_index+3,table);
-    hash_edge(arr[3], arr[1], cell_index+4,table);
-    hash_edge(arr[3], arr[2], cell_index+5,table);
-    ++ci;
-  }
+  const size_type num_cells = static_cast<size_type>(cells_.size() >> 2);
+  const under_type* cells = cells_.empty() ? 0 : &cells_[0];
 
-  edges_.resize(table.size());
+  builder_type builder;
+  builder.build(num_cells, 6, static_cast<size_type>(points_.size()),
+    [cells](index_type c, builder_type::Record* rec)
+    {
+      const under_type* cell = cells + 4*c;
+      for (int e = 0; e < 6; e++)
+      {
+        rec[e].key[0] = cell[edge_nodes[e][0]];
+        rec[e].key[1] = cell[edge_nodes[e][1]];
+        builder_type::sort_key(rec[e].key);
+        // Collapsed edges of degenerate tets are not edges
+        rec[e].code = (rec[e].key[0] == rec[e].key[1]) ? -1 : (c << 3) + e;
+      }
+    });
 
-  typename edge_ht::iterator ht_iter = table.begin();
-  typename edge_ht::iterator ht_iter_end = table.end();
+  const size_type num_edges = builder.size();
+  edges_.clear();
+  edges_.resize(num_edges);
+  Core::Thread::Parallel::For(0, num_edges, 1 << 14,
+    [this, &builder](size_t begin, size_t end)
+    {
+      for (size_t u = begin; u < end; u++)
+      {
+        std::vector<index_type>& cells = edges_[u].cells_;
+        cells.reserve(builder.count(u));
+        for (const builder_type::Record* rec = builder.begin(u);
+             rec != builder.end(u); ++rec)
+        {
+          cells.push_back(rec->code);
+        }
+      }
+    });
 
-  index_type uidx = 0;
-  while (ht_iter != ht_iter_end)
-  {
-    const PEdge& pedge = (*ht_iter).first;
-    edges_[uidx].cells_ = pedge.cells_;
-    edge_table_[PEdgeNode(pedge.nodes_[0],pedge.nodes_[1])] = uidx;
-    ++ht_iter; uidx++;
-  }
+  builder.swap_keys(edge_keys_);
+  edge_table_.clear();
 
   synchronize_lock_.lock();
   synchronized_ |= Mesh::EDGES_E;
   synchronize_lock_.unlock();
 }
 
+template <class Basis>
+void
+TetVolMesh<Basis>::build_edge_table()
+{
+  const size_type num_edges = static_cast<size_type>(edge_keys_.size() / 2);
+  for (index_type u = 0; u < num_edges; u++)
+  {
+    edge_table_[PEdgeNode(edge_keys_[2*u], edge_keys_[2*u+1])] = u;
+  }
+  std::vector<index_type>().swap(edge_keys_);
+}
+
 template <class Basis>
 void
 TetVolMesh<Basis>::add_edge(typename Node::index_type n1,
                             typename Node::index_type n2, index_type combined_index)
 {
+  if (!edge_keys_.empty()) build_edge_table();
   PEdgeNode e(n1,n2);
   typename edge_nt::iterator ht_iter = edge_table_.find(e);
   if (ht_iter == edge_table_.end())
@@ -3280,8 +3420,10 @@ TetVolMesh<Basis>::synchronize(mask_type sync)
     boost::thread syncthread(syncclass);
   }
 
-  // Wait until threads are done
-  while ((synchronized_ & sync) != sync)
+  // Wait until threads are done. The compute functions mark their table
+  // before the thread is finished with the lock, so wait for the threads
+  // to clear their synchronizing_ bits as well.
+  while (((synchronized_ & sync) != sync) || (synchronizing_ & sync))
   {
     synchronize_cond_.wait(lock);
   }
@@ -3308,20 +3450,43 @@ TetVolMesh<Basis>::clear_synchronization()
   // Free memory where possible
 
   faces_.clear();
+  face_keys_.clear();
   face_table_.clear();
   edges_.clear();
+  edge_keys_.clear();
   edge_table_.clear();
   node_neighbors_.clear();
   boundary_faces_.clear();
 
   node_grid_.reset();
   elem_grid_.reset();
+  node_bvh_.reset();
+  elem_bvh_.reset();
 
   synchronize_lock_.unlock();
 
   return (true);
 }
 
+template <class Basis>
+void
+TetVolMesh<Basis>::set_locate_accelerator(LocateAccelerator accelerator)
+{
+  synchronize_lock_.lock();
+  if (accelerator != locate_accelerator_)
+  {
+    // Drop the current search structure, the next synchronize call builds
+    // the new one
+    locate_accelerator_ = accelerator;
+    synchronized_ &= ~(Mesh::NODE_LOCATE_E|Mesh::ELEM_LOCATE_E);
+    node_grid_.reset();
+    elem_grid_.reset();
+    node_bvh_.reset();
+    elem_bvh_.reset();
+  }
+  synchronize_lock_.unlock();
+}
+
 template <class Basis>
 void
 TetVolMesh<Basis>::begin(typename TetVolMesh::Node::iterator &itr) const
@@ -3452,6 +3617,7 @@ TetVolMesh<Basis>::remove_edge(typename Node::index_type n1,
 			       typename Cell::index_type ci,
              bool table_only)
 {
+  if (!edge_keys_.empty()) build_edge_table();
   PEdgeNode e(n1, n2);
   typename edge_nt::iterator iter = edge_table_.find(e);
 
@@ -3662,8 +3828,9 @@ TetVolMesh<Basis>::set_nodes(typename Node::array_type &array,
 
   delete_cell_syncinfo(idx);
 
+  std::vector<under_type>& cells = cells_.mutate();
   for (index_type n = 0; n < 4; ++n)
-    cells_[idx * 4 + n] = array[n];
+    cells[idx * 4 + n] = array[n];
 
   create_cell_syncinfo(idx);
 }
@@ -3734,7 +3901,8 @@ TetVolMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
   box.extend(points_[cells_[idx+2]]);
   box.extend(points_[cells_[idx+3]]);
   box.extend(epsilon_);
-  elem_grid_->insert(ci, box);
+  if (elem_bvh_) elem_bvh_->insert(ci, box);
+  else elem_grid_->insert(ci, box);
 }
 
 
@@ -3749,7 +3917,8 @@ TetVolMesh<Basis>::remove_elem_from_grid(typename Elem::index_type ci)
   box.extend(points_[cells_[idx+2]]);
   box.extend(points_[cells_[idx+3]]);
   box.extend(epsilon_);
-  elem_grid_->remove(ci, box);
+  if (elem_bvh_) elem_bvh_->remove(ci);
+  else elem_grid_->remove(ci, box);
 }
 
 template <class Basis>
@@ -3758,21 +3927,103 @@ TetVolMesh<Basis>::insert_node_into_grid(typename Node::index_type ni)
 {
   /// @todo:  This can crash if you insert a new cell outside of the grid.
   // Need to recompute grid at that point.
-  node_grid_->insert(ni,points_[ni]);
+  if (node_bvh_) node_bvh_->insert(ni, points_[ni]);
+  else node_grid_->insert(ni,points_[ni]);
 }
 
 template <class Basis>
 void
 TetVolMesh<Basis>::remove_node_from_grid(typename Node::index_type ni)
 {
-  node_grid_->remove(ni,points_[ni]);
+  if (node_bvh_) node_bvh_->remove(ni);
+  else node_grid_->remove(ni,points_[ni]);
+}
+
+template <class Basis>
+bool
+TetVolMesh<Basis>::bvh_locate_elem(index_type& elem, const Core::Geometry::Point& p) const
+{
+  // Tets removed after the tree was built may still be listed in it
+  const size_type sz = static_cast<size_type>(cells_.size() >> 2);
+  return (elem_bvh_->lookup(p, [&](index_type ci)
+  {
+    if (ci < sz && inside(typename Elem::index_type(ci), p))
+    {
+      elem = ci;
+      return (true);
+    }
+    return (false);
+  }));
+}
+
+template <class Basis>
+index_type
+TetVolMesh<Basis>::bvh_closest_node(const Core::Geometry::Point& p, double& dmin2) const
+{
+  return (node_bvh_->closest(p, dmin2, [&](index_type ni, double)
+  {
+    return ((p - points_[ni]).length2());
+  }));
+}
+
+template <class Basis>
+index_type
+TetVolMesh<Basis>::bvh_closest_boundary(const Core::Geometry::Point& p,
+                                        double& dmin2,
+                                        Core::Geometry::Point& result) const
+{
+  // Same face ordering as the boundary_faces_ bits
+  static const int face_nodes[4][3] = { {0, 2, 1}, {1, 2, 3}, {0, 1, 3}, {0, 3, 2} };
+  const size_type sz = static_cast<size_type>(cells_.size() >> 2);
+
+  return (elem_bvh_->closest(p, dmin2, [&](index_type cidx, double dmin)
+  {
+    double best = DBL_MAX;
+    if (cidx >= sz) return (best);
+    const unsigned char b = boundary_faces_[cidx];
+    const index_type idx = cidx*4;
+    for (int f = 0; f < 4; f++)
+    {
+      if (!(b & (1 << f))) continue;
+      Core::Geometry::Point r;
+      closest_point_on_tri(r, p,
+                           points_[cells_[idx+face_nodes[f][0]]],
+                           points_[cells_[idx+face_nodes[f][1]]],
+                           points_[cells_[idx+face_nodes[f][2]]]);
+      const double dtmp = (p - r).length2();
+      if (dtmp < best && dtmp < dmin)
+      {
+        best = dtmp;
+        result = r;
+      }
+    }
+    return (best);
+  }));
 }
 
 template <class Basis>
 void
 TetVolMesh<Basis>::compute_elem_grid()
 {
-  if (bbox_.valid())
+  if (locate_accelerator_ == Mesh::BVH_LOCATE_E)
+  {
+    elem_grid_.reset();
+    elem_bvh_.reset(new SearchBVH);
+    elem_bvh_->build(static_cast<size_type>(cells_.size() >> 2),
+      [this](index_type ci, Core::Geometry::Point& pmin, Core::Geometry::Point& pmax)
+      {
+        const index_type idx = ci*4;
+        Core::Geometry::BBox box;
+        box.extend(points_[cells_[idx]]);
+        box.extend(points_[cells_[idx+1]]);
+        box.extend(points_[cells_[idx+2]]);
+        box.extend(points_[cells_[idx+3]]);
+        box.extend(epsilon_);
+        pmin = box.get_min();
+        pmax = box.get_max();
+      });
+  }
+  else if (bbox_.valid())
   {
     // Cubed root of number of cells to get a subdivision ballpark.
 
@@ -3809,7 +4060,13 @@ void
 TetVolMesh<Basis>::compute_node_grid()
 {
   ASSERTMSG(bbox_.valid(),"TetVolMesh BBox not valid");
-  if (bbox_.valid())
+  if (locate_accelerator_ == Mesh::BVH_LOCATE_E)
+  {
+    node_grid_.reset();
+    node_bvh_.reset(new SearchBVH);
+    node_bvh_->build(points_.get());
+  }
+  else if (bbox_.valid())
   {
     // Cubed root of number of cells to get a subdivision ballpark.
 
@@ -3971,18 +4228,19 @@ TetVolMesh<Basis>::mod_tet_pos(typename TetVolMesh<Basis>::Elem::index_type ci,
   const Core::Geometry::Point &p2 = point(c);
   const Core::Geometry::Point &p3 = point(d);
 
+  std::vector<under_type>& cells = cells_.mutate();
   if (Dot(Cross(p1-p0,p2-p0),p3-p0) >= 0.0)
   {
-    cells_[ci*4+0] = a;
-    cells_[ci*4+1] = b;
+    cells[ci*4+0] = a;
+    cells[ci*4+1] = b;
   }
   else
   {
-    cells_[ci*4+0] = b;
-    cells_[ci*4+1] = a;
+    cells[ci*4+0] = b;
+    cells[ci*4+1] = a;
   }
-  cells_[ci*4+2] = c;
-  cells_[ci*4+3] = d;
+  cells[ci*4+2] = c;
+  cells[ci*4+3] = d;
 }
 
 template <class Basis>
@@ -3996,10 +4254,11 @@ TetVolMesh<Basis>::delete_cells(std::set<index_type> &to_delete)
     // erase the correct cell
     typename TetVolMesh<Basis>::Cell::index_type ci = *iter++;
     index_type ind = ci * 4;
-    std::vector<index_type>::iterator cb = cells_.begin() + ind;
+    std::vector<under_type>& cells = cells_.mutate();
+    std::vector<index_type>::iterator cb = cells.begin() + ind;
     std::vector<index_type>::iterator ce = cb;
     ce+=4;
-    cells_.erase(cb, ce);
+    cells.erase(cb, ce);
   }
 
   synchronized_ &= ~Mesh::LOCATE_E;
@@ -4026,8 +4285,8 @@ TetVolMesh<Basis>::delete_nodes(std::set<index_type> &to_delete)
   while (iter != to_delete.rend())
   {
     typename TetVolMesh::Node::index_type n = *iter++;
-    std::vector<Core::Geometry::Point>::iterator pit = points_.begin() + n;
-    points_.erase(pit);
+    std::vector<Core::Geometry::Point>::iterator pit = points_.mutate().begin() + n;
+    points_.mutate().erase(pit);
   }
   synchronized_ &= ~Mesh::LOCATE_E;
   synchronized_ &= ~Mesh::NODE_NEIGHBORS_E;
@@ -4299,9 +4558,8 @@ TetVolMesh<Basis>::insert_node_in_elem(typename Elem::array_type &tets,
       etmp = PEdgeNode(cells_[ci*4 + 2], cells_[ci*4 + 3]);
     }
 
-    typename edge_nt::iterator iter = edge_table_.find(etmp);
-    PEdgeNode e = iter->first;
-    const std::vector<index_type>& cells = edges_[iter->second].cells_;
+    const PEdgeNode& e = etmp;
+    const std::vector<index_type> cells = edges_[find_edge(etmp)].cells_;
 
     pi = add_point(p);
     tets.clear();
@@ -4337,9 +4595,8 @@ TetVolMesh<Basis>::insert_node_in_elem(typename Elem::array_type &tets,
       ftmp = PFaceNode(cells_[ci*4 + 1], cells_[ci*4 + 2], cells_[ci*4 + 3]);
     }
 
-    typename face_nt::iterator iter = face_table_.find(ftmp);
-    const PFaceNode& n = iter->first;
-    const PFaceCell& f = faces_[iter->second];
+    const PFaceNode& n = ftmp;
+    const PFaceCell f = faces_[find_face(ftmp)];
     typename Cell::index_type nbr_tet =
       (ci == (f.cells_[0])>>2) ? ((f.cells_[1])>>2) : ((f.cells_[0])>>2);
 
@@ -4368,9 +4625,8 @@ TetVolMesh<Basis>::orient(typename Cell::index_type ci)
   const double sgn = Dot(Cross(p1-p0,p2-p0),p3-p0);
   if (sgn < 0.0)
   {
-    typename Node::index_type tmp = cells_[ci*4+0];
-    cells_[ci*4+0] = cells_[ci*4+1];
-    cells_[ci*4+1] = tmp;
+    std::vector<under_type>& cells = cells_.mutate();
+    std::swap(cells[ci*4+0], cells[ci*4+1]);
   }
 }
 
@@ -120,7 +120,8 @@ public:
                                      VMesh::Elem::index_type  elem,
                                      Point& point);
 
-  virtual VMesh::index_type* get_elems_pointer() const;
+  virtual VMesh::index_type* mutable_elems_pointer();
+  virtual const VMesh::index_type* get_elems_pointer() const;
   virtual boost::shared_ptr<SearchGridT<typename SCIRun::index_type> > get_elem_search_grid() { return this->mesh_->elem_grid_; }
   virtual boost::shared_ptr<SearchGridT<typename SCIRun::index_type> > get_node_search_grid() { return this->mesh_->node_grid_; }
 
@@ -386,10 +387,19 @@ VTriSurfMesh<MESH>::set_nodes(VMesh::Node::array_type& nodes,
 template <class MESH>
 VMesh::index_type*
 VTriSurfMesh<MESH>::
+mutable_elems_pointer()
+{
+  if (this->mesh_->faces_.size() == 0) return (0);
+  return (&(this->mesh_->faces_.mutate()[0]));
+}
+
+template <class MESH>
+const VMesh::index_type*
+VTriSurfMesh<MESH>::
 get_elems_pointer() const
 {
   if (this->mesh_->faces_.size() == 0) return (0);
-   return (&(this->mesh_->faces_[0]));
+  return (&(this->mesh_->faces_[0]));
 }
 
 /// @todo: Fix this function so it does not need the vector conversion
@@ -34,6 +34,7 @@
 #include <Core/Datatypes/Legacy/Field/MeshSupport.h>
 
 #include <Core/Containers/StackVector.h>
+#include <Core/Containers/CopyOnWriteVector.h>
 
 #include <Core/GeometryPrimitives/Transform.h>
 #include <Core/GeometryPrimitives/Point.h>
@@ -42,6 +43,7 @@
 #include <Core/GeometryPrimitives/CompGeom.h>
 #include <Core/Containers/StackVector.h>
 #include <Core/GeometryPrimitives/SearchGridT.h>
+#include <Core/GeometryPrimitives/SearchBVH.h>
 #include <Core/Datatypes/Mesh/VirtualMeshFacade.h>
 
 #include <Core/Basis/Locate.h>
@@ -50,6 +52,7 @@
 #include <Core/Basis/TriCubicHmt.h>
 
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/SortedTopologyBuilder.h>
 #include <Core/Datatypes/Legacy/Field/FieldIterator.h>
 #include <Core/Datatypes/Legacy/Field/FieldRNG.h>
 #include <Core/Datatypes/Legacy/Base/Types.h>
@@ -348,6 +351,7 @@ public:
   virtual bool synchronize(mask_type mask);
   virtual bool unsynchronize(mask_type mask);
   bool clear_synchronization();
+  virtual void set_locate_accelerator(LocateAccelerator accelerator);
 
   /// Get the basis class.
   Basis& get_basis() { return basis_; }
@@ -551,7 +555,7 @@ public:
   void get_point(Core::Geometry::Point &result, typename Node::index_type index) const
     { result = points_[index]; }
   void set_point(const Core::Geometry::Point &point, typename Node::index_type index)
-    { points_[index] = point; }
+    { points_.mutate()[index] = point; }
 
   void get_random_point(Core::Geometry::Point &, typename Elem::index_type, FieldRNG &rng) const;
 
@@ -785,6 +789,17 @@ public:
     ASSERTMSG(synchronized_ & Mesh::NODE_LOCATE_E,
         "TriSurfMesh::find_closest_node requires synchronize(NODE_LOCATE_E).")
 
+    if (node_bvh_)
+    {
+      double dmin = maxdist;
+      const index_type idx = bvh_closest_node(p, dmin);
+      if (idx < 0) return (false);
+      node = INDEX(idx);
+      result = points_[idx];
+      pdist = sqrt(dmin);
+      return (true);
+    }
+
     // get grid sizes
     const size_type ni = node_grid_->get_ni()-1;
     const size_type nj = node_grid_->get_nj()-1;
@@ -877,6 +892,18 @@ public:
     ASSERTMSG(synchronized_ & Mesh::NODE_LOCATE_E,
         "TriSurfMesh::find_closest_node requires synchronize(NODE_LOCATE_E).")
 
+    if (node_bvh_)
+    {
+      const double maxdist2 = maxdist*maxdist;
+      const Core::Geometry::Vector r(maxdist, maxdist, maxdist);
+      node_bvh_->lookup(Core::Geometry::BBox(p - r, p + r), [&](index_type ni)
+      {
+        if ((p - points_[ni]).length2() < maxdist2) nodes.push_back(ni);
+        return (false);
+      });
+      return (nodes.size() > 0);
+    }
+
     // get grid sizes
     const size_type ni = node_grid_->get_ni()-1;
     const size_type nj = node_grid_->get_nj()-1;
@@ -948,6 +975,23 @@ public:
     ASSERTMSG(synchronized_ & Mesh::NODE_LOCATE_E,
         "TriSurfMesh::find_closest_node requires synchronize(NODE_LOCATE_E).")
 
+    if (node_bvh_)
+    {
+      const double maxdist2 = maxdist*maxdist;
+      const Core::Geometry::Vector r(maxdist, maxdist, maxdist);
+      node_bvh_->lookup(Core::Geometry::BBox(p - r, p + r), [&](index_type ni)
+      {
+        const double dist = (p - points_[ni]).length2();
+        if (dist < maxdist2)
+        {
+          nodes.push_back(ni);
+          distances.push_back(dist);
+        }
+        return (false);
+      });
+      return (nodes.size() > 0);
+    }
+
     // get grid sizes
     const size_type ni = node_grid_->get_ni()-1;
     const size_type nj = node_grid_->get_nj()-1;
@@ -1059,6 +1103,122 @@ public:
     ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
         "TriSurfMesh::find_closest_elem requires synchronize(ELEM_LOCATE_E).")
 
+    double dmin = maxdist;
+    double dmean = maxdist;
+    bool found_one = false;
+    double perturb= epsilon_*100; //value to move to find new point.
+
+    /// Test whether face fi is closer than the closest face so far, faces
+    /// at about the same distance are told apart by the distance to a point
+    /// moved slightly into the face. Returns true when p lies on fi.
+    auto test_face = [&](index_type fi) -> bool
+    {
+      Core::Geometry::Point r, r_pert;
+      index_type idx = fi * 3;
+
+      closest_point_on_tri(r, p, points_[faces_[idx]], points_[faces_[idx+1]], points_[faces_[idx+2]]);
+      double dtmp = (p - r).length2();
+
+
+      //test triangle size for scaling
+      Core::Geometry::Vector v1= Core::Geometry::Vector(points_[faces_[idx+1]]-points_[faces_[idx  ]]); v1.normalize();
+      Core::Geometry::Vector v2= Core::Geometry::Vector(points_[faces_[idx+2]]-points_[faces_[idx  ]]); v2.normalize();
+
+      Core::Geometry::Vector n=Cross(v1,v2); n.normalize();
+      Core::Geometry::Vector pr=Core::Geometry::Vector(r-p); pr.normalize();
+
+      if (std::abs(Dot(pr,n))>1-perturb)
+      {
+        r_pert=r;
+      }
+      else
+      {
+
+        Core::Geometry::Vector pp=Cross(n,pr); pp.normalize();
+        Core::Geometry::Vector vect=Cross(pp,n); vect.normalize();
+
+        r_pert=Core::Geometry::Point(r+vect*perturb);
+      }
+
+      double dtmp2=(p-r_pert).length2();
+
+      //check for closest face and check within precision
+      if (dtmp-dmin <= epsilon_)
+      {
+        if (dtmp-dmin < - epsilon_)
+        {
+          found_one = true;
+          result = r;
+          face = INDEX(fi);
+          dmin = dtmp;
+          dmean =dtmp2;
+
+          if (dmin < epsilon2_)
+          {
+
+            pdist = sqrt(dmin);
+            pdist = sqrt(dmean);
+
+            ElemData ed(*this,face);
+            basis_.get_coords(coords,result,ed);
+            return (true);
+          }
+        }
+        else if (dtmp2-dmean < - epsilon_ )
+        {
+          found_one = true;
+          result = r;
+          face = INDEX(fi);
+          if (dmin>=dtmp) dmin=dtmp;
+          dmean =dtmp2;
+        }
+        else if (dtmp<dmin  && std::abs(dtmp2-dmean) < epsilon_ )
+        {
+          found_one = true;
+          result = r;
+          face = INDEX(fi);
+          dmin = dtmp;
+          dmean =dtmp2;
+          if (dmin < epsilon2_)
+          {
+
+            pdist = sqrt(dmin);
+            pdist = sqrt(dmean);
+
+            ElemData ed(*this,face);
+            basis_.get_coords(coords,result,ed);
+          }
+        }
+        else if (dtmp2 < dmean && dtmp-dmin > - epsilon_)
+        {
+          found_one = true;
+          result = r;
+          face = INDEX(fi);
+          dmean =dtmp2;
+        }
+      }
+
+      return (false);
+    };
+
+    if (elem_bvh_)
+    {
+      // The closest face bounds the search, all faces at about that
+      // distance go through the same test as in the grid search
+      Core::Geometry::Point r;
+      double d2 = maxdist;
+      if (bvh_closest_face(p, d2, r) < 0) return (false);
+      const double radius = sqrt(d2 + 2.0*epsilon_) + epsilon_;
+      const Core::Geometry::Vector v(radius, radius, radius);
+      if (elem_bvh_->lookup(Core::Geometry::BBox(p - v, p + v), [&](index_type fi)
+        { return (fi < sz && test_face(fi)); })) return (true);
+
+      ElemData ed(*this,face);
+      basis_.get_coords(coords,result,ed);
+      pdist = sqrt(dmin);
+      return (found_one);
+    }
+
     // get grid sizes
     const size_type ni = elem_grid_->get_ni()-1;
     const size_type nj = elem_grid_->get_nj()-1;
@@ -1084,11 +1244,7 @@ public:
 
     ei = bi; ej = bj; ek = bk;
 
-    double dmin = maxdist;
-    double dmean = maxdist;
     bool found = true;
-    bool found_one = false;
-    double perturb= epsilon_*100; //value to move to find new point.
 
     do
     {
@@ -1114,92 +1270,7 @@ public:
 
                 while (it != eit)
                 {
-                  Core::Geometry::Point r, r_pert;
-                  index_type idx = (*it) * 3;
-                  
-                  closest_point_on_tri(r, p, points_[faces_[idx]], points_[faces_[idx+1]], points_[faces_[idx+2]]);
-                  double dtmp = (p - r).length2();
-                  
-                  
-                  //test triangle size for scaling
-                  Core::Geometry::Vector v1= Core::Geometry::Vector(points_[faces_[idx+1]]-points_[faces_[idx  ]]); v1.normalize();
-                  Core::Geometry::Vector v2= Core::Geometry::Vector(points_[faces_[idx+2]]-points_[faces_[idx  ]]); v2.normalize();
-                  
-                  Core::Geometry::Vector n=Cross(v1,v2); n.normalize();
-                  Core::Geometry::Vector pr=Core::Geometry::Vector(r-p); pr.normalize();
-                  
-                  if (std::abs(Dot(pr,n))>1-perturb)
-                  {
-                    r_pert=r;
-                  }
-                  else
-                  {
-                      
-                    Core::Geometry::Vector pp=Cross(n,pr); pp.normalize();
-                    Core::Geometry::Vector vect=Cross(pp,n); vect.normalize();
-                    
-                    r_pert=Core::Geometry::Point(r+vect*perturb);
-                  }
-                  
-                  double dtmp2=(p-r_pert).length2();
-
-                  //check for closest face and check within precision
-                  if (dtmp-dmin <= epsilon_)
-                  {
-                    if (dtmp-dmin < - epsilon_)
-                    {
-                      found_one = true;
-                      result = r;
-                      face = INDEX(*it);
-                      dmin = dtmp;
-                      dmean =dtmp2;
-                      
-                      if (dmin < epsilon2_)
-                      {
-                        
-                        pdist = sqrt(dmin);
-                        pdist = sqrt(dmean);
-                            
-                        ElemData ed(*this,face);
-                        basis_.get_coords(coords,result,ed);
-                        return (true);
-                      }
-                    }
-                    else if (dtmp2-dmean < - epsilon_ )
-                    {
-                      found_one = true;
-                      result = r;
-                      face = INDEX(*it);
-                      if (dmin>=dtmp) dmin=dtmp;
-                      dmean =dtmp2;
-                    }
-                    else if (dtmp<dmin  && std::abs(dtmp2-dmean) < epsilon_ )
-                    {
-                      found_one = true;
-                      result = r;
-                      face = INDEX(*it);
-                      dmin = dtmp;
-                      dmean =dtmp2;
-                      if (dmin < epsilon2_)
-                      {
-                        
-                        pdist = sqrt(dmin);
-                        pdist = sqrt(dmean);
-                        
-                        ElemData ed(*this,face);
-                        basis_.get_coords(coords,result,ed);
-                      }
-                    }
-                    else if (dtmp2 < dmean && dtmp-dmin > - epsilon_)
-                    {
-                      found_one = true;
-                      result = r;
-                      face = INDEX(*it);
-                      dmean =dtmp2;
-                    }
-                  }
-                  
-
+                  if (test_face(*it)) return (true);
                   ++it;
                 }
               }
@@ -1282,6 +1353,31 @@ public:
     ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
         "TriSurfMesh::find_closest_elems requires synchronize(ELEM_LOCATE_E).")
 
+    if (elem_bvh_)
+    {
+      // Find the closest distance first, then collect all faces at that
+      // distance
+      double dmin = DBL_MAX;
+      if (bvh_closest_face(p, dmin, result) < 0) return (false);
+      const double radius = sqrt(dmin + epsilon2_) + epsilon_;
+      const Core::Geometry::Vector v(radius, radius, radius);
+      elem_bvh_->lookup(Core::Geometry::BBox(p - v, p + v), [&](index_type fi)
+      {
+        if (fi >= sz) return (false);
+        Core::Geometry::Point rtmp;
+        const index_type idx = fi*3;
+        closest_point_on_tri(rtmp, p,
+                             points_[faces_[idx  ]],
+                             points_[faces_[idx+1]],
+                             points_[faces_[idx+2]]);
+        if ((p - rtmp).length2() < dmin + epsilon2_)
+          elems.push_back(typename ARRAY::value_type(fi));
+        return (false);
+      });
+      pdist = sqrt(dmin);
+      return (true);
+    }
+
     // get grid sizes
     const size_type ni = elem_grid_->get_ni()-1;
     const size_type nj = elem_grid_->get_nj()-1;
@@ -1621,8 +1717,9 @@ protected:
   template <class ARRAY, class INDEX>
   inline void set_nodes_by_elem(ARRAY &array, INDEX idx)
   {
+    std::vector<index_type>& faces = faces_.mutate();
     for (index_type n = 0; n < 3; ++n)
-      faces_[idx * 3 + n] = static_cast<index_type>(array[n]);
+      faces[idx * 3 + n] = static_cast<index_type>(array[n]);
   }
 
 
@@ -1748,6 +1845,13 @@ protected:
     ASSERTMSG(synchronized_ & Mesh::NODE_LOCATE_E,
               "TriSurfMesh::locate_node requires synchronize(NODE_LOCATE_E).")
 
+    if (node_bvh_)
+    {
+      double dmin = DBL_MAX;
+      node = INDEX(bvh_closest_node(p, dmin));
+      return (true);
+    }
+
     // get grid sizes
     const size_type ni = node_grid_->get_ni()-1;
     const size_type nj = node_grid_->get_nj()-1;
@@ -1876,6 +1980,14 @@ protected:
     ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
               "TriSurfMesh::locate_elem requires synchronize(ELEM_LOCATE_E).")
 
+    if (elem_bvh_)
+    {
+      index_type idx;
+      if (!bvh_locate_elem(idx, p)) return (false);
+      elem = static_cast<INDEX>(idx);
+      return (true);
+    }
+
     typename SearchGridT<index_type>::iterator it, eit;
     if (elem_grid_->lookup(it, eit, p))
     {
@@ -1900,6 +2012,20 @@ protected:
               "TriSurfMesh::locate_elems requires synchronize(ELEM_LOCATE_E).")
 
     array.clear();
+    if (elem_bvh_)
+    {
+      const size_type sz = static_cast<size_type>(faces_.size() / 3);
+      elem_bvh_->lookup(b, [&](index_type fi)
+      {
+        if (fi >= sz) return (false);
+        size_t p=0;
+        for (;p<array.size();p++) if (array[p] == typename ARRAY::value_type(fi)) break;
+        if (p == array.size()) array.push_back(typename ARRAY::value_type(fi));
+        return (false);
+      });
+      return (array.size() > 0);
+    }
+
     index_type is,js,ks;
     index_type ie,je,ke;
     elem_grid_->locate_clamp(is,js,ks,b.get_min());
@@ -1946,6 +2072,16 @@ protected:
     ASSERTMSG(synchronized_ & Mesh::ELEM_LOCATE_E,
               "TriSurfMesh::locate_node requires synchronize(ELEM_LOCATE_E).")
 
+    if (elem_bvh_)
+    {
+      index_type idx;
+      if (!bvh_locate_elem(idx, p)) return (false);
+      elem = static_cast<INDEX>(idx);
+      ElemData ed(*this, elem);
+      basis_.get_coords(coords, p, ed);
+      return (true);
+    }
+
     typename SearchGridT<index_type>::iterator it, eit;
     if (elem_grid_->lookup(it, eit, p))
     {
@@ -2006,6 +2142,8 @@ protected:
   void compute_edges();
   // Fixes bug #887 (gforge)
   void compute_edges_bugfix();
+  // Fills edges_ and halfedge_to_edge_, and optionally edge_on_node_
+  void build_edges(bool fill_edge_on_node);
   void compute_edge_neighbors();
 
   void compute_node_grid();
@@ -2019,6 +2157,13 @@ protected:
   void insert_node_into_grid(typename Node::index_type ci);
   void remove_node_from_grid(typename Node::index_type ci);
 
+  /// Lookups in node_bvh_ and elem_bvh_, the counterparts of the search grid
+  /// loops in the locate and find_closest functions
+  bool bvh_locate_elem(index_type& elem, const Core::Geometry::Point& p) const;
+  index_type bvh_closest_node(const Core::Geometry::Point& p, double& dmin2) const;
+  index_type bvh_closest_face(const Core::Geometry::Point& p, double& dmin2,
+                              Core::Geometry::Point& result) const;
+
   void debug_test_edge_neighbors();
 
   bool inside3_p(index_type face_times_three, const Core::Geometry::Point &p) const;
@@ -2027,10 +2172,10 @@ protected:
   static index_type prev(index_type i) { return ((i%3)==0) ? (i+2) : (i-1); }
 
   /// Actual parameters
-  std::vector<Core::Geometry::Point>         points_;              // Location of vertices
+  CopyOnWriteVector<Core::Geometry::Point>         points_;              // Location of vertices
   std::vector<std::vector<index_type> >    edges_;               // edges->halfedge map
   std::vector<index_type>    halfedge_to_edge_;    // halfedge->edge map
-  std::vector<index_type>    faces_;               // Connectivity of this mesh
+  CopyOnWriteVector<index_type> faces_;            // Connectivity of this mesh
   std::vector<index_type>    edge_neighbors_;      // Neighbor connectivity
   std::vector<Core::Geometry::Vector>        normals_;             // normalized per node normal.
   std::vector<std::vector<index_type> > node_neighbors_; // Node neighbor connectivity
@@ -2039,6 +2184,12 @@ protected:
   boost::shared_ptr<SearchGridT<index_type> > node_grid_; // Lookup table for nodes
   boost::shared_ptr<SearchGridT<index_type> > elem_grid_; // Lookup table for elements
 
+  /// With BVH_LOCATE_E these trees replace the grids above, they hold the
+  /// bounding boxes of the nodes and of the triangles respectively.
+  Mesh::LocateAccelerator               locate_accelerator_;
+  boost::shared_ptr<SearchBVH>          node_bvh_;
+  boost::shared_ptr<SearchBVH>          elem_bvh_;
+
   // Lock and Condition Variable for hand shaking
   mutable Core::Thread::Mutex         synchronize_lock_;
   Core::Thread::ConditionVariable     synchronize_cond_;
@@ -2066,7 +2217,6 @@ protected:
   };
 
   using EdgeMapType = boost::unordered_map<std::pair<index_type, index_type>, index_type, edgehash>;
-  using EdgeMapType2 = boost::unordered_map<std::pair<index_type, index_type>, std::vector<index_type>, edgehash>;
 };
 
 
@@ -2110,6 +2260,7 @@ TriSurfMesh<Basis>::TriSurfMesh()
     faces_(0),
     edge_neighbors_(0),
     node_neighbors_(0),
+    locate_accelerator_(Mesh::GRID_LOCATE_E),
     synchronize_lock_("TriSurfMesh lock"),
     synchronize_cond_("TriSurfMesh condition variable"),
     synchronized_(Mesh::NODES_E | Mesh::FACES_E | Mesh::CELLS_E),
@@ -2134,6 +2285,7 @@ TriSurfMesh<Basis>::TriSurfMesh(const TriSurfMesh &copy)
     edge_neighbors_(0),
     normals_(0),
     node_neighbors_(0),
+    locate_accelerator_(Mesh::GRID_LOCATE_E),
     synchronize_lock_("TriSurfMesh lock"),
     synchronize_cond_("TriSurfMesh condition variable"),
     synchronized_(Mesh::NODES_E | Mesh::FACES_E | Mesh::CELLS_E),
@@ -2149,6 +2301,7 @@ TriSurfMesh<Basis>::TriSurfMesh(const TriSurfMesh &copy)
   copy.synchronize_lock_.lock();
 
   points_ = copy.points_;
+  locate_accelerator_ = copy.locate_accelerator_;
 
   edges_ = copy.edges_;
   halfedge_to_edge_ = copy.halfedge_to_edge_;
@@ -2233,8 +2386,8 @@ void
 TriSurfMesh<Basis>::transform(const Core::Geometry::Transform &t)
 {
   synchronize_lock_.lock();
-  std::vector<Core::Geometry::Point>::iterator itr = points_.begin();
-  std::vector<Core::Geometry::Point>::iterator eitr = points_.end();
+  std::vector<Core::Geometry::Point>::iterator itr = points_.mutate().begin();
+  std::vector<Core::Geometry::Point>::iterator eitr = points_.mutate().end();
   while (itr != eitr)
   {
     *itr = t.project(*itr);
@@ -2265,6 +2418,10 @@ TriSurfMesh<Basis>::transform(const Core::Geometry::Transform &t)
   if (node_grid_) { node_grid_->transform(t); }
   if (elem_grid_) { elem_grid_->transform(t); }
 
+  // The boxes in a tree do not transform, rebuild on the next synchronize
+  if (node_bvh_) { node_bvh_.reset(); synchronized_ &= ~(Mesh::NODE_LOCATE_E); }
+  if (elem_bvh_) { elem_bvh_.reset(); synchronized_ &= ~(Mesh::ELEM_LOCATE_E); }
+
   synchronize_lock_.unlock();
 }
 
@@ -2537,8 +2694,10 @@ TriSurfMesh<Basis>::synchronize(mask_type sync)
     boost::thread syncthread(syncclass);
   }
 
-  // Wait until threads are done
-  while ((synchronized_ & sync) != sync)
+  // Wait until threads are done. The compute functions mark their table
+  // before the thread is finished with the lock, so wait for the threads
+  // to clear their synchronizing_ bits as well.
+  while (((synchronized_ & sync) != sync) || (synchronizing_ & sync))
   {
     synchronize_cond_.wait(lock);
   }
@@ -2569,11 +2728,32 @@ TriSurfMesh<Basis>::clear_synchronization()
   edges_.clear();
   node_grid_.reset();
   elem_grid_.reset();
+  node_bvh_.reset();
+  elem_bvh_.reset();
 
   synchronize_lock_.unlock();
   return (true);
 }
 
+template <class Basis>
+void
+TriSurfMesh<Basis>::set_locate_accelerator(LocateAccelerator accelerator)
+{
+  synchronize_lock_.lock();
+  if (accelerator != locate_accelerator_)
+  {
+    // Drop the current search structure, the next synchronize call builds
+    // the new one
+    locate_accelerator_ = accelerator;
+    synchronized_ &= ~(Mesh::NODE_LOCATE_E|Mesh::ELEM_LOCATE_E);
+    node_grid_.reset();
+    elem_grid_.reset();
+    node_bvh_.reset();
+    elem_bvh_.reset();
+  }
+  synchronize_lock_.unlock();
+}
+
 
 
 template <class Basis>
@@ -2660,7 +2840,7 @@ TriSurfMesh<Basis>::insert_node(typename Face::index_type face, const Core::Geom
   faces_.push_back(pi);
 
   // must do last
-  faces_[f0+2] = pi;
+  faces_.mutate()[f0+2] = pi;
 
   if (do_neighbors)
   {
@@ -2769,7 +2949,7 @@ TriSurfMesh<Basis>::insert_node_in_edge_aux(typename Face::array_type &tris,
 
   // f0
   tris.push_back(halfedge / 3);
-  faces_[next(halfedge)] = ni;
+  faces_.mutate()[next(halfedge)] = ni;
   edge_neighbors_[halfedge] = (nbr!=MESH_NO_NEIGHBOR)?f3:MESH_NO_NEIGHBOR;
   edge_neighbors_[next(halfedge)] = prev(f1);
   edge_neighbors_[prev(halfedge)] = edge_neighbors_[prev(halfedge)];
@@ -2794,7 +2974,7 @@ TriSurfMesh<Basis>::insert_node_in_edge_aux(typename Face::array_type &tris,
 
     // f2
     tris.push_back(nbr / 3);
-    faces_[next(nbr)] = ni;
+    faces_.mutate()[next(nbr)] = ni;
     edge_neighbors_[nbr] = f1;
     edge_neighbors_[next(nbr)] = f3+2;
   }
@@ -2862,7 +3042,7 @@ TriSurfMesh<Basis>::insert_node_in_face_aux(typename Face::array_type &tris,
 
   // Must do last
   tris.push_back(face);
-  faces_[f0+2] = ni;
+  faces_.mutate()[f0+2] = ni;
   edge_neighbors_[f0+1] = f1+2;
   edge_neighbors_[f0+2] = f2+1;
 
@@ -2959,9 +3139,10 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::collapse_edges(const std::vector<index_type> &nodemap)
 {
-  for (size_t i = 0; i < faces_.size(); i++)
+  std::vector<index_type>& faces = faces_.mutate();
+  for (size_t i = 0; i < faces.size(); i++)
   {
-    faces_[i] = nodemap[faces_[i]];
+    faces[i] = nodemap[faces[i]];
   }
 }
 
@@ -2970,7 +3151,7 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::remove_obvious_degenerate_triangles()
 {
-  std::vector<index_type> oldfaces = faces_;
+  const CopyOnWriteVector<index_type> oldfaces = faces_;
   faces_.clear();
   for (size_t i = 0; i< oldfaces.size(); i+=3)
   {
@@ -3044,9 +3225,9 @@ TriSurfMesh<Basis>::bisect_element(const typename Face::index_type face)
   faces_.push_back(nodes[5]);
   faces_.push_back(nodes[4]);
 
-  faces_[f0+0] = nodes[3];
-  faces_[f0+1] = nodes[4];
-  faces_[f0+2] = nodes[5];
+  faces_.mutate()[f0+0] = nodes[3];
+  faces_.mutate()[f0+1] = nodes[4];
+  faces_.mutate()[f0+2] = nodes[5];
 
 
   if (do_neighbors)
@@ -3101,7 +3282,7 @@ TriSurfMesh<Basis>::bisect_element(const typename Face::index_type face)
     edge_neighbors_.push_back(pnbr);
     edge_neighbors_.push_back(edge_neighbors_[pnbr]);
     edge_neighbors_[edge_neighbors_.back()] = f4+2;
-    faces_[nbr] = nodes[3];
+    faces_.mutate()[nbr] = nodes[3];
     edge_neighbors_[pnbr] = f4+1;
     if (do_normals)
     {
@@ -3125,7 +3306,7 @@ TriSurfMesh<Basis>::bisect_element(const typename Face::index_type face)
     edge_neighbors_.push_back(pnbr);
     edge_neighbors_.push_back(edge_neighbors_[pnbr]);
     edge_neighbors_[edge_neighbors_.back()] = f5+2;
-    faces_[nbr] = nodes[4];
+    faces_.mutate()[nbr] = nodes[4];
     edge_neighbors_[pnbr] = f5+1;
     if (do_normals)
     {
@@ -3149,7 +3330,7 @@ TriSurfMesh<Basis>::bisect_element(const typename Face::index_type face)
     edge_neighbors_.push_back(pnbr);
     edge_neighbors_.push_back(edge_neighbors_[pnbr]);
     edge_neighbors_[edge_neighbors_.back()] = f6+2;
-    faces_[nbr] = nodes[5];
+    faces_.mutate()[nbr] = nodes[5];
     edge_neighbors_[pnbr] = f6+1;
     if (do_normals)
     {
@@ -3187,45 +3368,66 @@ TriSurfMesh<Basis>::compute_node_neighbors()
 
 template <class Basis>
 void
-TriSurfMesh<Basis>::compute_edges()
+TriSurfMesh<Basis>::build_edges(bool fill_edge_on_node)
 {
-  EdgeMapType2 edge_map;
-
-  size_type num_faces = static_cast<index_type>(faces_.size())/3;
-  for (index_type i=0; i < num_faces; i++)
-  {
-    index_type n0 = faces_[3*i];
-    index_type n1 = faces_[3*i+1];
-    index_type n2 = faces_[3*i+2];
+  typedef SortedTopologyBuilder<2> builder_type;
 
-    if (n0 > n1) edge_map[std::pair<index_type, index_type>(n1,n0)].push_back(i<<2);
-    else  edge_map[std::pair<index_type, index_type>(n0,n1)].push_back(i<<2);
+  const size_type num_faces = static_cast<size_type>(faces_.size()/3);
+  const index_type* faces = faces_.empty() ? 0 : &faces_[0];
 
-    if (n1 > n2) edge_map[std::pair<index_type, index_type>(n2,n1)].push_back((i<<2)+1);
-    else  edge_map[std::pair<index_type, index_type>(n1,n2)].push_back((i<<2)+1);
-
-    if (n2 > n0) edge_map[std::pair<index_type, index_type>(n0,n2)].push_back((i<<2)+2);
-    else  edge_map[std::pair<index_type, index_type>(n2,n0)].push_back((i<<2)+2);
-  }
+  builder_type builder;
+  builder.build(num_faces, 3, static_cast<size_type>(points_.size()),
+    [faces](index_type i, builder_type::Record* rec)
+    {
+      const index_type* face = faces + 3*i;
+      for (int j = 0; j < 3; j++)
+      {
+        rec[j].key[0] = face[j];
+        rec[j].key[1] = face[(j+1)%3];
+        builder_type::sort_key(rec[j].key);
+        rec[j].code = (i<<2) + j;
+      }
+    });
 
-  typename EdgeMapType2::iterator itr;
+  const size_type num_edges = builder.size();
   edges_.clear();
-  edges_.resize(edge_map.size());
+  edges_.resize(num_edges);
   halfedge_to_edge_.resize(faces_.size());
+  Core::Thread::Parallel::For(0, num_edges, 1 << 14,
+    [this, &builder](size_t begin, size_t end)
+    {
+      for (size_t k = begin; k < end; k++)
+      {
+        std::vector<index_type>& hedges = edges_[k];
+        hedges.reserve(builder.count(k));
+        for (const builder_type::Record* rec = builder.begin(k);
+             rec != builder.end(k); ++rec)
+        {
+          index_type h = rec->code;
+          hedges.push_back(h);
+          halfedge_to_edge_[(h>>2)*3 + (h&0x3)] = static_cast<index_type>(k);
+        }
+      }
+    });
 
-  size_t k=0;
-  for (itr = edge_map.begin(); itr != edge_map.end(); ++itr)
+  if (fill_edge_on_node)
   {
-    const std::vector<index_type >& hedges = (*itr).second;
-    for (size_t j=0; j<hedges.size(); j++)
+    edge_on_node_.clear();
+    edge_on_node_.resize(points_.size());
+    for (index_type k = 0; k < num_edges; k++)
     {
-      index_type h = hedges[j];
-      edges_[k].push_back(h);
-      halfedge_to_edge_[(h>>2)*3 + (h&0x3)] = k;
-
+      const builder_type::Record* rec = builder.begin(k);
+      edge_on_node_[rec->key[0]].push_back(k);
+      edge_on_node_[rec->key[1]].push_back(k);
     }
-    k++;
   }
+}
+
+template <class Basis>
+void
+TriSurfMesh<Basis>::compute_edges()
+{
+  build_edges(false);
 
   synchronize_lock_.lock();
   synchronized_ |= (Mesh::EDGES_E);
@@ -3237,46 +3439,7 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::compute_edges_bugfix()
 {
-  EdgeMapType2 edge_map;
-
-  size_type num_faces = static_cast<index_type>(faces_.size())/3;
-  for (index_type i=0; i < num_faces; i++)
-  {
-    index_type n0 = faces_[3*i];
-    index_type n1 = faces_[3*i+1];
-    index_type n2 = faces_[3*i+2];
-
-    if (n0 > n1) edge_map[std::pair<index_type, index_type>(n1,n0)].push_back(i<<2);
-    else  edge_map[std::pair<index_type, index_type>(n0,n1)].push_back(i<<2);
-
-    if (n1 > n2) edge_map[std::pair<index_type, index_type>(n2,n1)].push_back((i<<2)+1);
-    else  edge_map[std::pair<index_type, index_type>(n1,n2)].push_back((i<<2)+1);
-
-    if (n2 > n0) edge_map[std::pair<index_type, index_type>(n0,n2)].push_back((i<<2)+2);
-    else  edge_map[std::pair<index_type, index_type>(n2,n0)].push_back((i<<2)+2);
-  }
-
-  typename EdgeMapType2::iterator itr;
-  edges_.clear();
-  edges_.resize(edge_map.size());
-  halfedge_to_edge_.resize(faces_.size());
-  edge_on_node_.clear();
-  edge_on_node_.resize(points_.size());
-
-  size_t k=0;
-  for (itr = edge_map.begin(); itr != edge_map.end(); ++itr)
-  {
-    const std::vector<index_type >& hedges = (*itr).second;
-    for (size_t j=0; j<hedges.size(); j++)
-    {
-      index_type h = hedges[j];
-      edges_[k].push_back(h);
-      halfedge_to_edge_[(h>>2)*3 + (h&0x3)] = k;
-    }
-    edge_on_node_[(*itr).first.first].push_back(k);
-    edge_on_node_[(*itr).first.second].push_back(k);
-    k++;
-  }
+  build_edges(true);
 
   synchronize_lock_.lock();
   synchronized_ |= (Mesh::EDGES_E);
@@ -3340,13 +3503,13 @@ TriSurfMesh<Basis>::swap_shared_edge(typename Face::index_type f1,
   index_type s2 = *iter;
 
   synchronize_lock_.lock();
-  faces_[face1] = s1;
-  faces_[face1 + 1] = not_shar[0];
-  faces_[face1 + 2] = s2;
+  faces_.mutate()[face1] = s1;
+  faces_.mutate()[face1 + 1] = not_shar[0];
+  faces_.mutate()[face1 + 2] = s2;
 
-  faces_[face2] = s2;
-  faces_[face2 + 1] = not_shar[1];
-  faces_[face2 + 2] = s1;
+  faces_.mutate()[face2] = s2;
+  faces_.mutate()[face2 + 1] = not_shar[1];
+  faces_.mutate()[face2 + 2] = s1;
 
   synchronized_ &= ~Mesh::ELEM_NEIGHBORS_E;
   synchronized_ &= ~Mesh::NODE_NEIGHBORS_E;
@@ -3379,8 +3542,9 @@ TriSurfMesh<Basis>::remove_orphan_nodes()
   while (orph_iter != onodes.rend())
   {
     index_type i = *orph_iter++;
-    std::vector<index_type>::iterator iter = faces_.begin();
-    while (iter != faces_.end())
+    std::vector<index_type>& faces = faces_.mutate();
+    std::vector<index_type>::iterator iter = faces.begin();
+    while (iter != faces.end())
     {
       index_type &node = *iter++;
       if (node > i)
@@ -3388,9 +3552,9 @@ TriSurfMesh<Basis>::remove_orphan_nodes()
         node--;
       }
     }
-    std::vector<Core::Geometry::Point>::iterator niter = points_.begin();
+    std::vector<Core::Geometry::Point>::iterator niter = points_.mutate().begin();
     niter += i;
-    points_.erase(niter);
+    points_.mutate().erase(niter);
   }
 
   synchronized_ &= ~Mesh::ELEM_NEIGHBORS_E;
@@ -3406,11 +3570,12 @@ TriSurfMesh<Basis>::remove_face(typename Face::index_type f)
   bool rval = true;
 
   synchronize_lock_.lock();
-  std::vector<under_type>::iterator fb = faces_.begin() + f*3;
+  std::vector<under_type>& faces = faces_.mutate();
+  std::vector<under_type>::iterator fb = faces.begin() + f*3;
   std::vector<under_type>::iterator fe = fb + 3;
 
-  if (fe <= faces_.end())
-    faces_.erase(fb, fe);
+  if (fe <= faces.end())
+    faces.erase(fb, fe);
   else {
     rval = false;
   }
@@ -3468,8 +3633,8 @@ TriSurfMesh<Basis>::flip_face(typename Face::index_type face)
 {
   const index_type base = face * 3;
   index_type tmp = faces_[base + 1];
-  faces_[base + 1] = faces_[base + 2];
-  faces_[base + 2] = tmp;
+  faces_.mutate()[base + 1] = faces_[base + 2];
+  faces_.mutate()[base + 2] = tmp;
 
   synchronized_ &= ~(Mesh::EDGES_E);
   synchronized_ &= ~Mesh::ELEM_NEIGHBORS_E;
@@ -3597,7 +3762,8 @@ TriSurfMesh<Basis>::insert_elem_into_grid(typename Elem::index_type ci)
   box.extend(points_[faces_[idx+1]]);
   box.extend(points_[faces_[idx+2]]);
   box.extend(epsilon_);
-  elem_grid_->insert(ci, box);
+  if (elem_bvh_) elem_bvh_->insert(ci, box);
+  else elem_grid_->insert(ci, box);
 }
 
 
@@ -3611,7 +3777,8 @@ TriSurfMesh<Basis>::remove_elem_from_grid(typename Elem::index_type ci)
   box.extend(points_[faces_[idx+1]]);
   box.extend(points_[faces_[idx+2]]);
   box.extend(epsilon_);
-  elem_grid_->remove(ci, box);
+  if (elem_bvh_) elem_bvh_->remove(ci);
+  else elem_grid_->remove(ci, box);
 }
 
 
@@ -3621,7 +3788,8 @@ TriSurfMesh<Basis>::insert_node_into_grid(typename Node::index_type ni)
 {
   /// @todo:  This can crash if you insert a new cell outside of the grid.
   // Need to recompute grid at that point.
-  node_grid_->insert(ni,points_[ni]);
+  if (node_bvh_) node_bvh_->insert(ni, points_[ni]);
+  else node_grid_->insert(ni,points_[ni]);
 }
 
 
@@ -3629,7 +3797,58 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::remove_node_from_grid(typename Node::index_type ni)
 {
-  node_grid_->remove(ni,points_[ni]);
+  if (node_bvh_) node_bvh_->remove(ni);
+  else node_grid_->remove(ni,points_[ni]);
+}
+
+
+template <class Basis>
+bool
+TriSurfMesh<Basis>::bvh_locate_elem(index_type& elem, const Core::Geometry::Point& p) const
+{
+  // Triangles removed after the tree was built may still be listed in it
+  const size_type sz = static_cast<size_type>(faces_.size() / 3);
+  return (elem_bvh_->lookup(p, [&](index_type fi)
+  {
+    if (fi < sz && inside3_p(fi*3, p))
+    {
+      elem = fi;
+      return (true);
+    }
+    return (false);
+  }));
+}
+
+
+template <class Basis>
+index_type
+TriSurfMesh<Basis>::bvh_closest_node(const Core::Geometry::Point& p, double& dmin2) const
+{
+  return (node_bvh_->closest(p, dmin2, [&](index_type ni, double)
+  {
+    return ((p - points_[ni]).length2());
+  }));
+}
+
+
+template <class Basis>
+index_type
+TriSurfMesh<Basis>::bvh_closest_face(const Core::Geometry::Point& p,
+                                     double& dmin2,
+                                     Core::Geometry::Point& result) const
+{
+  const size_type sz = static_cast<size_type>(faces_.size() / 3);
+  return (elem_bvh_->closest(p, dmin2, [&](index_type fi, double dmin)
+  {
+    if (fi >= sz) return (DBL_MAX);
+    const index_type idx = fi*3;
+    Core::Geometry::Point r;
+    closest_point_on_tri(r, p, points_[faces_[idx]],
+                         points_[faces_[idx+1]], points_[faces_[idx+2]]);
+    const double dtmp = (p - r).length2();
+    if (dtmp < dmin) result = r;
+    return (dtmp);
+  }));
 }
 
 
@@ -3637,7 +3856,24 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::compute_elem_grid()
 {
-  if (bbox_.valid())
+  if (locate_accelerator_ == Mesh::BVH_LOCATE_E)
+  {
+    elem_grid_.reset();
+    elem_bvh_.reset(new SearchBVH);
+    elem_bvh_->build(static_cast<size_type>(faces_.size() / 3),
+      [this](index_type fi, Core::Geometry::Point& pmin, Core::Geometry::Point& pmax)
+      {
+        const index_type idx = fi*3;
+        Core::Geometry::BBox box;
+        box.extend(points_[faces_[idx]]);
+        box.extend(points_[faces_[idx+1]]);
+        box.extend(points_[faces_[idx+2]]);
+        box.extend(epsilon_);
+        pmin = box.get_min();
+        pmax = box.get_max();
+      });
+  }
+  else if (bbox_.valid())
   {
     // Cubed root of number of cells to get a subdivision ballpark.
 
@@ -3674,7 +3910,13 @@ template <class Basis>
 void
 TriSurfMesh<Basis>::compute_node_grid()
 {
-  if (bbox_.valid())
+  if (locate_accelerator_ == Mesh::BVH_LOCATE_E)
+  {
+    node_grid_.reset();
+    node_bvh_.reset(new SearchBVH);
+    node_bvh_->build(points_.get());
+  }
+  else if (bbox_.valid())
   {
     // Cubed root of number of cells to get a subdivision ballpark.
 
@@ -113,18 +113,30 @@ VFData::efdata_size() const
   ASSERTFAIL("VFData interface has no virtual function implementation for efdata_size");
 }
 
-void*
+const void*
 VFData::fdata_pointer() const
 {
   ASSERTFAIL("VFData interface has no virtual function implementation for fdata_pointer");
 }
 
-void*
+const void*
 VFData::efdata_pointer() const
 {
   ASSERTFAIL("VFData interface has no virtual function implementation for efdata_pointer");
 }
 
+void*
+VFData::mutable_fdata_pointer()
+{
+  ASSERTFAIL("VFData interface has no virtual function implementation for mutable_fdata_pointer");
+}
+
+void*
+VFData::mutable_efdata_pointer()
+{
+  ASSERTFAIL("VFData interface has no virtual function implementation for mutable_efdata_pointer");
+}
+
 void
 VFData::resize_fdata(VMesh::dimension_type )
 {
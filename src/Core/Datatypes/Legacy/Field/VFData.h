@@ -34,6 +34,7 @@
 #include <Core/GeometryPrimitives/Tensor.h>
 #include <Core/Containers/Array2.h>
 #include <Core/Containers/Array3.h>
+#include <Core/Containers/CopyOnWrite.h>
 #include <Core/Datatypes/Legacy/Field/Mesh.h>
 #include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Legacy/Field/CastFData.h>
@@ -71,9 +72,9 @@
   virtual void mgradient(std::vector<StackVector<type,3> > &val, VMesh::MultiElemGradient &interp, type defval = (static_cast<type>(0))) const; \
 
 #define VFDATA_FUNCTION_DECLARATION(type) \
-  SCISHARE VFData* CreateVFData(std::vector<type>& fdata, std::vector<type>& lfdata, std::vector<std::vector<type> >& hfdata); \
-  SCISHARE VFData* CreateVFData(Array2<type>& fdata, std::vector<type>& lfdata, std::vector<std::vector<type> >& hfdata); \
-  SCISHARE VFData* CreateVFData(Array3<type>& fdata, std::vector<type>& lfdata, std::vector<std::vector<type> >& hfdata);
+  SCISHARE VFData* CreateVFData(CopyOnWrite<std::vector<type> >& fdata, std::vector<type>& lfdata, std::vector<std::vector<type> >& hfdata); \
+  SCISHARE VFData* CreateVFData(CopyOnWrite<Array2<type> >& fdata, std::vector<type>& lfdata, std::vector<std::vector<type> >& hfdata); \
+  SCISHARE VFData* CreateVFData(CopyOnWrite<Array3<type> >& fdata, std::vector<type>& lfdata, std::vector<std::vector<type> >& hfdata);
 
 
 namespace SCIRun {
@@ -93,8 +94,13 @@ public:
   virtual void resize_fdata(VMesh::dimension_type dim);
   virtual void resize_efdata(VMesh::dimension_type dim);
 
-  virtual void* fdata_pointer() const;
-  virtual void* efdata_pointer() const;
+  /// The values may be shared with clones of the field, so the plain
+  /// pointers are read-only. The mutable ones make the values private to
+  /// this field first.
+  virtual const void* fdata_pointer() const;
+  virtual const void* efdata_pointer() const;
+  virtual void* mutable_fdata_pointer();
+  virtual void* mutable_efdata_pointer();
 
   VFDATA_ACCESS_DECLARATION(char)
   VFDATA_ACCESS_DECLARATION(unsigned char)
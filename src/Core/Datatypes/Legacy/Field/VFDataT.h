@@ -79,7 +79,7 @@ void VFDataT<FDATA,EFDATA,HFDATA>::get_values(type *ptr, VMesh::size_type sz, VM
 \
 template<class FDATA, class EFDATA, class HFDATA> \
 void VFDataT<FDATA,EFDATA,HFDATA>::set_values(const type *ptr, VMesh::size_type sz, VMesh::size_type offset) \
-{ if (static_cast<size_type>(fdata_.size()) < sz+offset) sz = static_cast<size_type>(fdata_.size())-offset; for (size_type i=0; i< sz; i++) fdata_[i+offset] =  CastFData<typename FDATA::value_type>(ptr[i]); } \
+{ if (static_cast<size_type>(fdata_.size()) < sz+offset) sz = static_cast<size_type>(fdata_.size())-offset; FDATA& fdata = fdata_.mutate(); for (size_type i=0; i< sz; i++) fdata[i+offset] =  CastFData<typename FDATA::value_type>(ptr[i]); } \
 \
 template<class FDATA, class EFDATA, class HFDATA> \
 void VFDataT<FDATA,EFDATA,HFDATA>::get_evalues(type *ptr, VMesh::size_type sz, VMesh::size_type offset) const \
@@ -94,7 +94,7 @@ void VFDataT<FDATA,EFDATA,HFDATA>::set_all_values(const type &val) \
 { typename FDATA::value_type tval =  CastFData<typename FDATA::value_type>(val); \
   size_type sz1 = static_cast<size_type>(fdata_.size()); \
   size_type sz2 = static_cast<size_type>(efdata_.size()); \
-  for (size_type i=0; i < sz1; i++) fdata_[i] = tval; \
+  if (sz1 > 0) { FDATA& fdata = fdata_.mutate(); for (size_type i=0; i < sz1; i++) fdata[i] = tval; } \
   for (size_type i=0; i < sz2; i++) efdata_[i] = tval; \
 } \
 template<class FDATA, class EFDATA, class HFDATA> \
@@ -148,38 +148,61 @@ void VFDataT<FDATA,EFDATA,HFDATA>::mgradient(std::vector<StackVector<type,3> > &
 { mgradientT<type>(vals,interp,defval); } 
 
 #define VFDATA_FUNCTION_SCALAR_DEFINITION(type) \
-VFData* CreateVFData(std::vector<type>& fdata,std::vector<type>& efdata,std::vector<std::vector<type> >& hfdata) \
+VFData* CreateVFData(CopyOnWrite<std::vector<type> >& fdata,std::vector<type>& efdata,std::vector<std::vector<type> >& hfdata) \
 { return new VFDataScalarT<std::vector<type>,std::vector<type>,std::vector<std::vector<type> > >(fdata,efdata,hfdata); } \
 \
-VFData* CreateVFData(Array2<type>& fdata,std::vector<type>& efdata,std::vector<std::vector<type> >& hfdata) \
+VFData* CreateVFData(CopyOnWrite<Array2<type> >& fdata,std::vector<type>& efdata,std::vector<std::vector<type> >& hfdata) \
 { return new VFDataScalarT<Array2<type>,std::vector<type>,std::vector<std::vector<type> > >(fdata,efdata,hfdata); } \
 \
-VFData* CreateVFData(Array3<type>& fdata,std::vector<type>& efdata, std::vector<std::vector<type> >& hfdata) \
+VFData* CreateVFData(CopyOnWrite<Array3<type> >& fdata,std::vector<type>& efdata, std::vector<std::vector<type> >& hfdata) \
 { return new VFDataScalarT<Array3<type>,std::vector<type>,std::vector<std::vector<type> > >(fdata,efdata,hfdata); }
 
 #define VFDATA_FUNCTION_VECTOR_DEFINITION(type) \
-VFData* CreateVFData(std::vector<type>& fdata,std::vector<type>& efdata,std::vector<std::vector<type> >& hfdata) \
+VFData* CreateVFData(CopyOnWrite<std::vector<type> >& fdata,std::vector<type>& efdata,std::vector<std::vector<type> >& hfdata) \
 { return new VFDataVectorT<std::vector<type>,std::vector<type>,std::vector<std::vector<type> > >(fdata,efdata,hfdata); } \
 \
-VFData* CreateVFData(Array2<type>& fdata,std::vector<type>& efdata,std::vector<std::vector<type> >& hfdata) \
+VFData* CreateVFData(CopyOnWrite<Array2<type> >& fdata,std::vector<type>& efdata,std::vector<std::vector<type> >& hfdata) \
 { return new VFDataVectorT<Array2<type>,std::vector<type>,std::vector<std::vector<type> > >(fdata,efdata,hfdata); } \
 \
-VFData* CreateVFData(Array3<type>& fdata,std::vector<type>& efdata, std::vector<std::vector<type> >& hfdata) \
+VFData* CreateVFData(CopyOnWrite<Array3<type> >& fdata,std::vector<type>& efdata, std::vector<std::vector<type> >& hfdata) \
 { return new VFDataVectorT<Array3<type>,std::vector<type>,std::vector<std::vector<type> > >(fdata,efdata,hfdata); }
 
 #define VFDATA_FUNCTION_TENSOR_DEFINITION(type) \
-VFData* CreateVFData(std::vector<type>& fdata,std::vector<type>& efdata,std::vector<std::vector<type> >& hfdata) \
+VFData* CreateVFData(CopyOnWrite<std::vector<type> >& fdata,std::vector<type>& efdata,std::vector<std::vector<type> >& hfdata) \
 { return new VFDataTensorT<std::vector<type>,std::vector<type>,std::vector<std::vector<type> > >(fdata,efdata,hfdata); } \
 \
-VFData* CreateVFData(Array2<type>& fdata,std::vector<type>& efdata,std::vector<std::vector<type> >& hfdata) \
+VFData* CreateVFData(CopyOnWrite<Array2<type> >& fdata,std::vector<type>& efdata,std::vector<std::vector<type> >& hfdata) \
 { return new VFDataTensorT<Array2<type>,std::vector<type>,std::vector<std::vector<type> > >(fdata,efdata,hfdata); } \
 \
-VFData* CreateVFData(Array3<type>& fdata,std::vector<type>& efdata, std::vector<std::vector<type> >& hfdata) \
+VFData* CreateVFData(CopyOnWrite<Array3<type> >& fdata,std::vector<type>& efdata, std::vector<std::vector<type> >& hfdata) \
 { return new VFDataTensorT<Array3<type>,std::vector<type>,std::vector<std::vector<type> > >(fdata,efdata,hfdata); }
 
 
 namespace SCIRun {
 
+/// Values of a field as seen by VFDataT. The field may share them with its
+/// clones, so const access reads the shared values and non-const access
+/// makes them private to the field first.
+template<class FDATA>
+class VFDataAccess {
+public:
+  typedef typename FDATA::value_type value_type;
+
+  explicit VFDataAccess(CopyOnWrite<FDATA>& data) : data_(data) {}
+
+  const FDATA& get() const { return data_.get(); }
+  FDATA& mutate() { return data_.mutate(); }
+
+  size_t size() const { return data_.get().size(); }
+  template<class INDEX>
+  const value_type& operator[](INDEX idx) const { return data_.get()[idx]; }
+  template<class INDEX>
+  value_type& operator[](INDEX idx) { return data_.mutate()[idx]; }
+
+private:
+  CopyOnWrite<FDATA>& data_;
+};
+
 /// Implementation layer of the functions we actually need. These classes are
 /// defined here to prevent overload of the header files:
 
@@ -218,10 +241,40 @@ private:
     if (dim.size() > 2) sz3 = dim[2]; 
     fdata.resize(sz3,sz2,sz1);  
   }
+
+  template<class T>
+  bool has_size(const std::vector<T>& fdata,VMesh::dimension_type dim) const
+  {
+    VMesh::size_type sz = 1;
+    for (size_t j = 0; j < dim.size() && j < 3; j++) sz *= dim[j];
+    return (fdata.size() == static_cast<size_t>(sz));
+  }
+
+  template<class T>
+  bool has_size(const Array2<T>& fdata,VMesh::dimension_type dim) const
+  {
+    return (fdata.dim1() == static_cast<size_t>(dim.size() > 1 ? dim[1] : 1) &&
+            fdata.dim2() == static_cast<size_t>(dim.size() > 0 ? dim[0] : 1));
+  }
+
+  template<class T>
+  bool has_size(const Array3<T>& fdata,VMesh::dimension_type dim) const
+  {
+    return (fdata.dim1() == static_cast<size_t>(dim.size() > 2 ? dim[2] : 1) &&
+            fdata.dim2() == static_cast<size_t>(dim.size() > 1 ? dim[1] : 1) &&
+            fdata.dim3() == static_cast<size_t>(dim.size() > 0 ? dim[0] : 1));
+  }
+
+  template<class T>
+  void resize(VFDataAccess<T>& fdata,VMesh::dimension_type dim)
+  {
+    // Resizing a clone to the size it already has should not copy its values
+    if (!has_size(fdata.get(),dim)) resize(fdata.mutate(),dim);
+  }
   
 public:
   // constructor
-  VFDataT(FDATA& fdata, EFDATA& efdata, HFDATA& hfdata) :
+  VFDataT(CopyOnWrite<FDATA>& fdata, EFDATA& efdata, HFDATA& hfdata) :
   fdata_(fdata), efdata_(efdata), hfdata_(hfdata)
   { }
   
@@ -244,12 +297,22 @@ public:
   virtual VMesh::size_type efdata_size() const
     { return (efdata_.size()); }
 
-  virtual void* fdata_pointer() const
+  virtual const void* fdata_pointer() const
     { 
       if (fdata_.size() == 0) return (0);
       return (&(fdata_[0])); 
     }
-  virtual void* efdata_pointer() const
+  virtual const void* efdata_pointer() const
+    { 
+      if (efdata_.size() == 0) return (0);
+      return (&(efdata_[0])); 
+    }
+  virtual void* mutable_fdata_pointer()
+    { 
+      if (fdata_.size() == 0) return (0);
+      return (&(fdata_.mutate()[0])); 
+    }
+  virtual void* mutable_efdata_pointer()
     { 
       if (efdata_.size() == 0) return (0);
       return (&(efdata_[0])); 
@@ -741,7 +804,7 @@ public:
   virtual VMesh::size_type size() { return (VMesh::size_type(fdata_.size())); }
 
 protected:
-  FDATA& fdata_;
+  VFDataAccess<FDATA> fdata_;
   EFDATA& efdata_;  // Additional data for lagrangian interpolation data
   HFDATA& hfdata_;  // Additional data for hermitian interpolation data
 };
@@ -787,7 +850,7 @@ template<class FDATA, class EFDATA, class HFDATA>
 class VFDataScalarT : public VFDataT<FDATA,EFDATA,HFDATA> {
 public:
   // constructor
-  VFDataScalarT(FDATA& fdata, EFDATA& efdata, HFDATA& hfdata) :
+  VFDataScalarT(CopyOnWrite<FDATA>& fdata, EFDATA& efdata, HFDATA& hfdata) :
     VFDataT<FDATA,EFDATA,HFDATA>(fdata,efdata,hfdata)
   {}
 
@@ -862,7 +925,7 @@ template<class FDATA, class EFDATA, class HFDATA>
 class VFDataVectorT : public VFDataT<FDATA,EFDATA,HFDATA> {
 public:
   // constructor
-  VFDataVectorT(FDATA& fdata, EFDATA& efdata, HFDATA& hfdata) :
+  VFDataVectorT(CopyOnWrite<FDATA>& fdata, EFDATA& efdata, HFDATA& hfdata) :
     VFDataT<FDATA,EFDATA,HFDATA>(fdata,efdata,hfdata)
   {}
 
@@ -927,7 +990,7 @@ template<class FDATA, class EFDATA, class HFDATA>
 class VFDataTensorT : public VFDataT<FDATA,EFDATA,HFDATA> {
 public:
   // constructor
-  VFDataTensorT(FDATA& fdata, EFDATA& efdata, HFDATA& hfdata) :
+  VFDataTensorT(CopyOnWrite<FDATA>& fdata, EFDATA& efdata, HFDATA& hfdata) :
     VFDataT<FDATA,EFDATA,HFDATA>(fdata,efdata,hfdata)
   {}
   
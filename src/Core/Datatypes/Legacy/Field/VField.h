@@ -597,13 +597,19 @@ public:
     mesh_ = mesh;
   }
 
-  // Use these two functions with extra care, as they can cause segmentation
-  // errors if the type of the data is not taken into account
-  inline void* get_values_pointer()   { return (vfdata_->fdata_pointer()); }
-  inline void* get_evalues_pointer()   { return (vfdata_->efdata_pointer()); }
-
-  inline void* fdata_pointer()   { return (vfdata_->fdata_pointer()); }
-  inline void* efdata_pointer()   { return (vfdata_->efdata_pointer()); }
+  // Use these functions with extra care, as they can cause segmentation
+  // errors if the type of the data is not taken into account.
+  // The values may be shared with clones of the field, so only the mutable
+  // pointers may be written through; they make the values private first.
+  inline const void* get_values_pointer() const   { return (vfdata_->fdata_pointer()); }
+  inline const void* get_evalues_pointer() const   { return (vfdata_->efdata_pointer()); }
+  inline void* mutable_values_pointer()   { return (vfdata_->mutable_fdata_pointer()); }
+  inline void* mutable_evalues_pointer()   { return (vfdata_->mutable_efdata_pointer()); }
+
+  inline const void* fdata_pointer() const   { return (vfdata_->fdata_pointer()); }
+  inline const void* efdata_pointer() const   { return (vfdata_->efdata_pointer()); }
+  inline void* mutable_fdata_pointer()   { return (vfdata_->mutable_fdata_pointer()); }
+  inline void* mutable_efdata_pointer()   { return (vfdata_->mutable_efdata_pointer()); }
 
   inline bool is_nodata()        { return (basis_order_ == -1); }
   inline bool is_constantdata()  { return (basis_order_ == 0); }
@@ -531,15 +531,31 @@ VMesh::locate(VMesh::Elem::array_type &, const BBox &) const
 }
 
 void 
-VMesh::mlocate(std::vector<Node::index_type> &, const std::vector<Point> &) const
+VMesh::mlocate(std::vector<Node::index_type> &idx, const std::vector<Point> &point) const
 {
-  ASSERTFAIL("VMesh interface: mlocate(vector<Node::index_type>,Point) has not been implemented");
+  const bool has_guesses = (idx.size() == point.size());
+  idx.resize(point.size());
+  Node::index_type guess(0);
+  for (size_t i=0; i<point.size(); i++)
+  {
+    Node::index_type node = (has_guesses && idx[i] >= 0) ? idx[i] : guess;
+    if (locate(node,point[i])) { idx[i] = node; guess = node; }
+    else idx[i] = -1;
+  }
 }
 
 void 
-VMesh::mlocate(std::vector<Elem::index_type> &, const std::vector<Point> &) const
+VMesh::mlocate(std::vector<Elem::index_type> &idx, const std::vector<Point> &point) const
 {
-  ASSERTFAIL("VMesh interface: mlocate(std::vector<Elem::index_type>,Point) has not been implemented");
+  const bool has_guesses = (idx.size() == point.size());
+  idx.resize(point.size());
+  Elem::index_type guess(0);
+  for (size_t i=0; i<point.size(); i++)
+  {
+    Elem::index_type elem = (has_guesses && idx[i] >= 0) ? idx[i] : guess;
+    if (locate(elem,point[i])) { idx[i] = elem; guess = elem; }
+    else idx[i] = -1;
+  }
 }
 
 
@@ -645,18 +661,80 @@ VMesh::set_point(const Point&, ENode::index_type)
   ASSERTFAIL("VMesh interface: set_point(Point,ENode::index_type) has not been implemented");
 }  
 
-Point*
+const Point*
 VMesh::get_points_pointer() const
 {
   ASSERTFAIL("VMesh interface: get_points_pointer() has not been implemented");  
 }
 
-VMesh::index_type* 
+Point*
+VMesh::mutable_points_pointer()
+{
+  ASSERTFAIL("VMesh interface: mutable_points_pointer() has not been implemented");
+}
+
+const VMesh::index_type* 
 VMesh::get_elems_pointer() const
 {
   ASSERTFAIL("VMesh interface: get_elems_pointer() has not been implemented");  
 }
 
+VMesh::index_type*
+VMesh::mutable_elems_pointer()
+{
+  ASSERTFAIL("VMesh interface: mutable_elems_pointer() has not been implemented");
+}
+
+void
+VMesh::get_points(Node::index_type begin, Node::index_type end,
+                  Point* out) const
+{
+  PointSpan points = node_span();
+  if (!points.empty())
+  {
+    std::copy(points.begin() + begin, points.begin() + end, out);
+    return;
+  }
+
+  for (Node::index_type idx = begin; idx < end; ++idx, ++out)
+    get_center(*out, idx);
+}
+
+void
+VMesh::get_points(Node::index_type begin, Node::index_type end,
+                  double* x, double* y, double* z) const
+{
+  PointSpan points = node_span();
+  if (!points.empty())
+  {
+    const Point* p = points.data();
+    for (index_type idx = begin; idx < end; ++idx, ++x, ++y, ++z)
+    {
+      *x = p[idx].x(); *y = p[idx].y(); *z = p[idx].z();
+    }
+    return;
+  }
+
+  Point p;
+  for (Node::index_type idx = begin; idx < end; ++idx, ++x, ++y, ++z)
+  {
+    get_center(p, idx);
+    *x = p.x(); *y = p.y(); *z = p.z();
+  }
+}
+
+void
+VMesh::get_node_coordinates(NodeCoordinates& coords) const
+{
+  const size_type size = num_nodes();
+  coords.x.resize(size);
+  coords.y.resize(size);
+  coords.z.resize(size);
+  if (size == 0) return;
+  get_points(Node::index_type(0), Node::index_type(size),
+             &coords.x[0], &coords.y[0], &coords.z[0]);
+}
+
 void 
 VMesh::node_reserve(size_t)
 {
@@ -817,6 +895,12 @@ VMesh::synchronize(unsigned int)
   ASSERTFAIL("VMesh interface: synchronize has not yet been implemented");  
 }
 
+void
+VMesh::set_locate_accelerator(unsigned int)
+{
+  ASSERTFAIL("VMesh interface: set_locate_accelerator has not yet been implemented");
+}
+
 bool
 VMesh::unsynchronize(unsigned int)
 {
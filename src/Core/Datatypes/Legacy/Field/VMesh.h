@@ -41,6 +41,8 @@
 
 #include <Core/Utils/Legacy/Debug.h>
 
+#include <boost/align/aligned_allocator.hpp>
+
 #include <Core/Datatypes/Legacy/Field/share.h>
 
 namespace SCIRun {
@@ -578,7 +580,8 @@ public:
   /// the points are close together and previous node or element indices are
   /// tested first to see if that is the index for the next one in the array
   /// Hence in optimal cases the search is reduced to a few points for a cloud
-  /// of points
+  /// of points. When i has as many entries as point on entry, its entries
+  /// are used as the first guesses, entries of -1 are ignored.
 
   virtual void mlocate(std::vector<Node::index_type> &i,
                        const std::vector<Core::Geometry::Point> &point) const;
@@ -769,10 +772,83 @@ public:
   /// after checking the type of the underlying mesh as they allow direct
   /// access to the mesh memory
 
+  // Copies of a mesh share their points and connectivity until one of them
+  // changes them. The get_ pointers are read only and never copy; the
+  // mutable_ ones first copy data that is still shared, as the caller may
+  // write through them, so calling them is a modification of the mesh.
+
   // Only for irregular data
-  virtual Core::Geometry::Point* get_points_pointer() const;
+  virtual const Core::Geometry::Point* get_points_pointer() const;
+  virtual Core::Geometry::Point* mutable_points_pointer();
   // Only for unstructured data
-  virtual VMesh::index_type* get_elems_pointer() const;
+  virtual const VMesh::index_type* get_elems_pointer() const;
+  virtual VMesh::index_type* mutable_elems_pointer();
+
+  /// Read-only view onto a contiguous block of mesh memory. A span stays valid
+  /// until the mesh is resized or nodes/elements are added to it.
+  template <class T>
+  class Span
+  {
+  public:
+    Span() : data_(0), size_(0) {}
+    Span(const T* data, size_type size) : data_(data), size_(data ? size : 0) {}
+
+    inline const T* data() const { return (data_); }
+    inline const T* begin() const { return (data_); }
+    inline const T* end() const { return (data_ + size_); }
+    inline size_type size() const { return (size_); }
+    inline bool empty() const { return (size_ == 0); }
+    inline const T& operator[](index_type i) const { return (data_[i]); }
+
+  private:
+    const T* data_;
+    size_type size_;
+  };
+
+  typedef Span<Core::Geometry::Point> PointSpan;
+  typedef Span<index_type> IndexSpan;
+
+  /// Zero-copy access to the node locations, one Point per node. Only
+  /// irregular meshes store their nodes; for regular meshes the span is empty
+  /// and get_points() should be used instead.
+  inline PointSpan node_span() const
+  {
+    if (is_regular_) return (PointSpan());
+    return (PointSpan(get_points_pointer(), num_nodes()));
+  }
+
+  /// Zero-copy access to the element connectivity of unstructured meshes:
+  /// num_nodes_per_elem() node indices per element, stored element by element.
+  /// Empty for structured meshes and meshes without explicit elements.
+  inline IndexSpan elem_connectivity_span() const
+  {
+    if (is_structured_) return (IndexSpan());
+    return (IndexSpan(get_elems_pointer(), num_elems()*num_nodes_per_elem_));
+  }
+
+  /// Bulk version of get_point() for the nodes in [begin, end). Irregular
+  /// meshes copy straight out of their node storage; regular meshes fall
+  /// back to get_center() per node.
+  void get_points(Node::index_type begin, Node::index_type end,
+                  Core::Geometry::Point* out) const;
+  /// Same, but splits the coordinates into separate x, y and z arrays.
+  void get_points(Node::index_type begin, Node::index_type end,
+                  double* x, double* y, double* z) const;
+
+  /// Structure-of-arrays copy of the node locations for kernels that
+  /// vectorise over nodes. The arrays are cache line aligned.
+  class SCISHARE NodeCoordinates
+  {
+  public:
+    typedef std::vector<double,
+      boost::alignment::aligned_allocator<double, 64> > array_type;
+    array_type x, y, z;
+
+    inline size_type size() const { return (static_cast<size_type>(x.size())); }
+  };
+
+  /// Fill a structure-of-arrays mirror of all node locations.
+  void get_node_coordinates(NodeCoordinates& coords) const;
 
   /// Copy nodes from one mesh to another mesh
   /// Note: currently only for irregular meshes
@@ -780,8 +856,8 @@ public:
   inline void copy_nodes(VMesh* imesh, Node::index_type i,
                           Node::index_type o,Node::size_type size)
   {
-    Core::Geometry::Point* ipoint = imesh->get_points_pointer();
-    Core::Geometry::Point* opoint = get_points_pointer();
+    const Core::Geometry::Point* ipoint = imesh->get_points_pointer();
+    Core::Geometry::Point* opoint = mutable_points_pointer();
     for (index_type j=0; j<size; j++,i++,o++ ) opoint[o] = ipoint[i];
   }
 
@@ -789,8 +865,8 @@ public:
   {
     size_type size = imesh->num_nodes();
     resize_nodes(size);
-    Core::Geometry::Point* ipoint = imesh->get_points_pointer();
-    Core::Geometry::Point* opoint = get_points_pointer();
+    const Core::Geometry::Point* ipoint = imesh->get_points_pointer();
+    Core::Geometry::Point* opoint = mutable_points_pointer();
     for (index_type j=0; j<size; j++) opoint[j] = ipoint[j];
   }
 
@@ -798,8 +874,8 @@ public:
                           Elem::index_type o,Elem::size_type size,
                           Elem::size_type offset)
   {
-    VMesh::index_type* ielem = imesh->get_elems_pointer();
-    VMesh::index_type* oelem  = get_elems_pointer();
+    const VMesh::index_type* ielem = imesh->get_elems_pointer();
+    VMesh::index_type* oelem  = mutable_elems_pointer();
     index_type ii = i*num_nodes_per_elem_;
     index_type oo = o*num_nodes_per_elem_;
     size_type  ss = size*num_nodes_per_elem_;
@@ -808,8 +884,8 @@ public:
 
   inline void copy_elems(VMesh* imesh)
   {
-    VMesh::index_type* ielem = imesh->get_elems_pointer();
-    VMesh::index_type* oelem  = get_elems_pointer();
+    const VMesh::index_type* ielem = imesh->get_elems_pointer();
+    VMesh::index_type* oelem  = mutable_elems_pointer();
     size_type  ss = num_elems()*num_nodes_per_elem_;
     for (index_type j=0; j <ss; j++) oelem[j] = ielem[j];
   }
@@ -973,6 +1049,10 @@ public:
   virtual bool synchronize(unsigned int sync);
   virtual bool unsynchronize(unsigned int sync);
 
+  /// Select the search structure used by the locate tables, takes one of
+  /// Mesh::GRID_LOCATE_E or Mesh::BVH_LOCATE_E
+  virtual void set_locate_accelerator(unsigned int accelerator);
+
   // Only use this function when this is the only code that uses this mesh
   virtual bool clear_synchronization();
 
@@ -134,6 +134,7 @@ public:
 
   virtual bool synchronize(unsigned int sync);
   virtual bool unsynchronize(unsigned int sync);
+  virtual void set_locate_accelerator(unsigned int accelerator);
   virtual bool clear_synchronization();
 
   virtual Core::Geometry::BBox get_bounding_box() const;
@@ -261,6 +262,13 @@ VMeshShared<MESH>::unsynchronize(unsigned int sync)
   return(mesh_->unsynchronize(sync));
 }
 
+template<class MESH>
+void
+VMeshShared<MESH>::set_locate_accelerator(unsigned int accelerator)
+{
+  mesh_->set_locate_accelerator(static_cast<Mesh::LocateAccelerator>(accelerator));
+}
+
 template<class MESH>
 bool
 VMeshShared<MESH>::clear_synchronization()
@@ -31,6 +31,8 @@
 #define CORE_DATATYPES_VUNSTRUCTUREDMESH_H
 
 #include <Core/Datatypes/Legacy/Field/VMeshShared.h>
+#include <Core/GeometryPrimitives/SearchBVH.h>
+#include <Core/Thread/Parallel.h>
 
 /// Include needed for Windows: declares SCISHARE
 #include <Core/Datatypes/Legacy/Field/share.h>
@@ -99,7 +101,8 @@ public:
   virtual void set_point(const Core::Geometry::Point &point, VMesh::Node::index_type i);
   virtual void set_point(const Core::Geometry::Point &point, VMesh::ENode::index_type i);
   
-  virtual Core::Geometry::Point* get_points_pointer() const;
+  virtual const Core::Geometry::Point* get_points_pointer() const;
+  virtual Core::Geometry::Point* mutable_points_pointer();
   
   virtual void add_node(const Core::Geometry::Point &point,VMesh::Node::index_type &i);
   virtual void add_enode(const Core::Geometry::Point &point,VMesh::ENode::index_type &i);
@@ -355,11 +358,25 @@ void
 VUnstructuredMesh<MESH>::
 mlocate(std::vector<VMesh::Node::index_type> &idx, const std::vector<Core::Geometry::Point> &point) const
 {
+  // Visit the points along a space filling curve, so that consecutive
+  // queries land close together and the previous result is a good guess.
+  // Guesses passed in by the caller are tried first.
+  std::vector<index_type> order;
+  SearchBVH::morton_order(point, order);
+
+  const bool has_guesses = (idx.size() == point.size());
   idx.resize(point.size());
-  for (size_t i=0; i<point.size(); i++)
+  Core::Thread::Parallel::For(0, order.size(), 1024, [&](size_t begin, size_t end)
   {
-    if(!(this->mesh_->locate_node(idx[i],point[i]))) idx[i] = -1;
-  }
+    VMesh::Node::index_type guess(0);
+    for (size_t j = begin; j < end; j++)
+    {
+      const index_type i = order[j];
+      VMesh::Node::index_type node = (has_guesses && idx[i] >= 0) ? idx[i] : guess;
+      if (this->mesh_->locate_node(node, point[i])) { idx[i] = node; guess = node; }
+      else idx[i] = -1;
+    }
+  });
 }
 
 template <class MESH>
@@ -367,11 +384,24 @@ void
 VUnstructuredMesh<MESH>::
 mlocate(std::vector<VMesh::Elem::index_type> &idx, const std::vector<Core::Geometry::Point> &point) const
 {
+  // Same traversal order as for the nodes, the caller's guess or else the
+  // element found for the previous point is tried first
+  std::vector<index_type> order;
+  SearchBVH::morton_order(point, order);
+
+  const bool has_guesses = (idx.size() == point.size());
   idx.resize(point.size());
-  for (size_t i=0; i<point.size(); i++)
+  Core::Thread::Parallel::For(0, order.size(), 1024, [&](size_t begin, size_t end)
   {
-    if(!(this->mesh_->locate_elem(idx[i],point[i]))) idx[i] = -1;
-  }
+    VMesh::Elem::index_type guess(0);
+    for (size_t j = begin; j < end; j++)
+    {
+      const index_type i = order[j];
+      VMesh::Elem::index_type elem = (has_guesses && idx[i] >= 0) ? idx[i] : guess;
+      if (this->mesh_->locate_elem(elem, point[i])) { idx[i] = elem; guess = elem; }
+      else idx[i] = -1;
+    }
+  });
 }
 
 template <class MESH>
@@ -701,7 +731,7 @@ void
 VUnstructuredMesh<MESH>::
 set_point(const Core::Geometry::Point &point, VMesh::Node::index_type i)
 {
-  this->mesh_->points_[i] = point;
+  this->mesh_->points_.mutate()[i] = point;
 }
 
 template <class MESH>
@@ -724,7 +754,7 @@ set_point(const Core::Geometry::Point &point, VMesh::ENode::index_type i)
 }
 
 template <class MESH>
-Core::Geometry::Point*
+const Core::Geometry::Point*
 VUnstructuredMesh<MESH>::
 get_points_pointer() const
 {
@@ -732,6 +762,15 @@ get_points_pointer() const
    return (&(this->mesh_->points_[0]));
 }
 
+template <class MESH>
+Core::Geometry::Point*
+VUnstructuredMesh<MESH>::
+mutable_points_pointer()
+{
+  if (this->mesh_->points_.size() == 0) return (0);
+   return (&(this->mesh_->points_.mutate()[0]));
+}
+
 template <class MESH>
 void 
 VUnstructuredMesh<MESH>::
@@ -0,0 +1,98 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Datatypes/MatrixStream.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Datatypes/MatrixTypeConversions.h>
+#include <Core/Utils/Exception.h>
+
+using namespace SCIRun::Core::Datatypes;
+
+MatrixStream::MatrixStream(size_t rows, size_t cols, size_t blockSize, ColumnReader reader)
+  : rows_(rows), cols_(cols), blockSize_(blockSize), reader_(reader)
+{
+  if (0 == blockSize_)
+    THROW_INVALID_ARGUMENT("Matrix stream block size must be positive.");
+  ENSURE_NOT_NULL(reader_, "Matrix stream column reader");
+}
+
+MatrixStreamHandle MatrixStream::fromMatrix(DenseMatrixConstHandle matrix, size_t blockSize)
+{
+  ENSURE_NOT_NULL(matrix, "Matrix to stream");
+  return boost::make_shared<MatrixStream>(matrix->nrows(), matrix->ncols(), blockSize,
+    [matrix](size_t first, size_t n) { return DenseMatrix(matrix->middleCols(first, n)); });
+}
+
+DenseMatrix MatrixStream::columns(size_t firstColumn, size_t numColumns) const
+{
+  if (firstColumn + numColumns > cols_)
+    THROW_OUT_OF_RANGE("Matrix stream columns out of range.");
+  auto block = reader_(firstColumn, numColumns);
+  if (block.nrows() != rows_ || block.ncols() != numColumns)
+    THROW_INVALID_ARGUMENT("Matrix stream reader returned a block of the wrong size.");
+  return block;
+}
+
+DenseMatrix MatrixStream::block(size_t i) const
+{
+  const size_t first = i * blockSize_;
+  return columns(first, std::min(blockSize_, cols_ - std::min(first, cols_)));
+}
+
+void MatrixStream::forEachBlock(const BlockVisitor& visit) const
+{
+  for (size_t i = 0; i < numBlocks(); ++i)
+    visit(i * blockSize_, block(i));
+}
+
+MatrixStreamHandle MatrixStream::map(size_t rows, BlockOperator op) const
+{
+  auto source = *this;
+  return boost::make_shared<MatrixStream>(rows, cols_, blockSize_,
+    [source, op](size_t first, size_t n) { return op(source.columns(first, n)); });
+}
+
+MatrixStreamHandle MatrixStream::multiply(MatrixHandle lhs) const
+{
+  ENSURE_NOT_NULL(lhs, "Left operand of matrix stream product");
+  if (lhs->ncols() != rows_)
+    THROW_INVALID_ARGUMENT("Matrix stream product dimensions do not match.");
+
+  auto sparse = castMatrix::toSparse(lhs);
+  if (sparse)
+    return map(lhs->nrows(), [sparse](const DenseMatrix& block) { return DenseMatrix(*sparse * block); });
+  auto dense = convertMatrix::toDense(lhs);
+  return map(lhs->nrows(), [dense](const DenseMatrix& block) { return DenseMatrix(*dense * block); });
+}
+
+DenseMatrixHandle MatrixStream::toDense() const
+{
+  auto m = boost::make_shared<DenseMatrix>(rows_, cols_);
+  forEachBlock([&m](size_t first, const DenseMatrix& block) { m->middleCols(first, block.ncols()) = block; });
+  return m;
+}
@@ -0,0 +1,88 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_DATATYPES_MATRIXSTREAM_H
+#define CORE_DATATYPES_MATRIXSTREAM_H
+
+#include <functional>
+#include <Core/Datatypes/Datatype.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/share.h>
+
+namespace SCIRun {
+namespace Core {
+namespace Datatypes {
+
+  /// A matrix too large to hold in memory, passed between modules as a lazily evaluated
+  /// sequence of column blocks (time windows of a recording). Nothing is read or computed
+  /// until a consumer asks for a block, so a chain source -> transform -> sink holds one
+  /// block per stage regardless of the number of columns, and the consumer sets the pace.
+  class SCISHARE MatrixStream : public Datatype
+  {
+  public:
+    /// Returns columns [firstColumn, firstColumn + numColumns) as a nrows x numColumns matrix.
+    /// Readers may be called concurrently and more than once for the same columns.
+    typedef std::function<DenseMatrix(size_t firstColumn, size_t numColumns)> ColumnReader;
+    typedef std::function<DenseMatrix(const DenseMatrix& block)> BlockOperator;
+    typedef std::function<void(size_t firstColumn, const DenseMatrix& block)> BlockVisitor;
+
+    MatrixStream(size_t rows, size_t cols, size_t blockSize, ColumnReader reader);
+
+    /// Stream over a matrix already in memory; the stream shares it.
+    static MatrixStreamHandle fromMatrix(DenseMatrixConstHandle matrix, size_t blockSize);
+
+    size_t nrows() const { return rows_; }
+    size_t ncols() const { return cols_; }
+    size_t blockSize() const { return blockSize_; }
+    size_t numBlocks() const { return (cols_ + blockSize_ - 1) / blockSize_; }
+
+    DenseMatrix columns(size_t firstColumn, size_t numColumns) const;
+    DenseMatrix block(size_t i) const;
+
+    /// Visits the blocks in order, reading one at a time.
+    void forEachBlock(const BlockVisitor& visit) const;
+
+    /// Lazily applies op to every block; op maps nrows() x n blocks to rows x n.
+    MatrixStreamHandle map(size_t rows, BlockOperator op) const;
+    /// Lazy product lhs * stream, for dense or sparse lhs.
+    MatrixStreamHandle multiply(MatrixHandle lhs) const;
+
+    /// Reads the whole stream.
+    DenseMatrixHandle toDense() const;
+
+    virtual MatrixStream* clone() const override { return new MatrixStream(*this); }
+    virtual std::string dynamic_type_name() const override { return "MatrixStream"; }
+
+  private:
+    size_t rows_, cols_, blockSize_;
+    ColumnReader reader_;
+  };
+
+}}}
+
+#endif
@@ -117,6 +117,7 @@ namespace Datatypes {
     SparseRowMatrixGeneric& operator=(const Eigen::SparseMatrixBase<OtherDerived>& other)
     {
       this->EigenBase::operator=(other);
+      markModified();
       return *this;
     }
 
@@ -126,6 +127,7 @@ namespace Datatypes {
       if (this != &other)
       {
         this->EigenBase::operator=(other);
+        markModified();
       }
       return *this;
     }
@@ -139,6 +141,18 @@ namespace Datatypes {
     virtual size_t nrows() const override { return this->rows(); }
     virtual size_t ncols() const override { return this->cols(); }
 
+    /// Together with id() this identifies the contents of the matrix, so results
+    /// derived from it (e.g. a preconditioner) can be cached. Assignments and put()
+    /// update it; writes to the Eigen storage (coeffRef, valuePtr, ...) do not, so
+    /// caches also compare the contents, and markModified() only forces a rebuild.
+    unsigned int generation() const { return generation_; }
+    void markModified() { ++generation_; }
+
+    virtual size_t sizeInBytes() const override
+    {
+      return this->nonZeros() * (sizeof(T) + sizeof(index_type)) + (this->outerSize() + 1) * sizeof(index_type);
+    }
+
     typedef index_type RowsData;
     typedef index_type ColumnsData;
     typedef RowsData* RowsPtr;
@@ -188,6 +202,7 @@ namespace Datatypes {
       this->coeffRef(i,j) = val;
       //TODO: not sure this is best place for this call: it's the slowest but also the safest since this is a virtual Matrix function. Users should know to avoid calling this with known sparse matrices.
       this->makeCompressed();
+      markModified();
     }
 
     // legacy support
@@ -334,6 +349,8 @@ namespace Datatypes {
     {
       o << static_cast<const EigenBase&>(*this);
     }
+
+    unsigned int generation_ = 0;
   };
 
   template <typename T>
@@ -44,6 +44,7 @@ namespace Datatypes {
 
     const std::string& value() const { return value_; }
     virtual String* clone() const override { return new String(*this); }
+    virtual size_t sizeInBytes() const override { return value_.size(); }
 
     //! Persistent representation
     virtual void io(Piostream&) override;
@@ -0,0 +1,118 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Core/Datatypes/MatrixStream.h>
+#include <Core/Datatypes/SparseRowMatrix.h>
+#include <Core/Utils/Exception.h>
+
+using namespace SCIRun::Core;
+using namespace SCIRun::Core::Datatypes;
+
+namespace
+{
+  DenseMatrixHandle timeSeries(int rows, int cols)
+  {
+    auto m = boost::make_shared<DenseMatrix>(rows, cols);
+    for (int i = 0; i < rows; ++i)
+      for (int t = 0; t < cols; ++t)
+        (*m)(i, t) = 100 * i + t;
+    return m;
+  }
+}
+
+TEST(MatrixStreamTests, BlocksCoverAllColumns)
+{
+  auto m = timeSeries(3, 10);
+  auto stream = MatrixStream::fromMatrix(m, 4);
+
+  EXPECT_EQ(3, stream->nrows());
+  EXPECT_EQ(10, stream->ncols());
+  ASSERT_EQ(3, stream->numBlocks());
+  EXPECT_EQ(2, stream->block(2).ncols());
+
+  std::vector<size_t> firsts;
+  stream->forEachBlock([&](size_t first, const DenseMatrix& block)
+  {
+    firsts.push_back(first);
+    EXPECT_EQ(m->middleCols(first, block.ncols()), block);
+  });
+  EXPECT_EQ((std::vector<size_t>{ 0, 4, 8 }), firsts);
+  EXPECT_EQ(*m, *stream->toDense());
+}
+
+TEST(MatrixStreamTests, ReadsOnlyTheRequestedColumns)
+{
+  std::vector<std::pair<size_t, size_t>> reads;
+  MatrixStream stream(2, 1000000, 100, [&reads](size_t first, size_t n)
+  {
+    reads.emplace_back(first, n);
+    return DenseMatrix(DenseMatrix::Constant(2, n, static_cast<double>(first)));
+  });
+
+  auto block = stream.block(5000);
+  EXPECT_EQ(500000, block(1, 99));
+  ASSERT_EQ(1, reads.size());
+  EXPECT_EQ(500000, reads[0].first);
+  EXPECT_EQ(100, reads[0].second);
+
+  EXPECT_THROW(stream.columns(999950, 100), OutOfRangeException);
+}
+
+TEST(MatrixStreamTests, MultiplyIsLazyAndMatchesDenseProduct)
+{
+  auto m = timeSeries(3, 7);
+  int reads = 0;
+  auto stream = boost::make_shared<MatrixStream>(3, 7, 3, [m, &reads](size_t first, size_t n)
+  {
+    ++reads;
+    return DenseMatrix(m->middleCols(first, n));
+  });
+
+  auto dense = boost::make_shared<DenseMatrix>(DenseMatrix::Random(4, 3));
+  auto product = stream->multiply(dense);
+  EXPECT_EQ(0, reads);
+  EXPECT_EQ(4, product->nrows());
+  EXPECT_EQ(7, product->ncols());
+  EXPECT_TRUE(product->toDense()->isApprox(*dense * *m));
+  EXPECT_EQ(3, reads);
+
+  auto sparse = boost::make_shared<SparseRowMatrix>(2, 3);
+  sparse->insert(0, 2) = 2.0;
+  sparse->insert(1, 0) = -1.0;
+  sparse->makeCompressed();
+  EXPECT_TRUE(stream->multiply(sparse)->toDense()->isApprox(*sparse * *m));
+
+  EXPECT_THROW(product->multiply(dense), InvalidArgumentException);
+}
+
+TEST(MatrixStreamTests, ReaderMustReturnRequestedSize)
+{
+  MatrixStream stream(2, 10, 5, [](size_t, size_t n) { return DenseMatrix(DenseMatrix::Zero(3, n)); });
+  EXPECT_THROW(stream.block(0), InvalidArgumentException);
+}
@@ -0,0 +1,450 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <Core/GeometryPrimitives/SearchBVH.h>
+#include <Core/Thread/Parallel.h>
+
+#include <utility>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+using namespace SCIRun::Core::Thread;
+
+namespace {
+
+const int num_bins = 16;
+
+inline double half_area(const double* lo, const double* hi)
+{
+  const double dx = hi[0] - lo[0];
+  const double dy = hi[1] - lo[1];
+  const double dz = hi[2] - lo[2];
+  return (dx*dy + dy*dz + dz*dx);
+}
+
+inline void empty_box(double* lo, double* hi)
+{
+  for (int a = 0; a < 3; a++) { lo[a] = DBL_MAX; hi[a] = -DBL_MAX; }
+}
+
+inline void extend_box(double* lo, double* hi, const double* plo, const double* phi)
+{
+  for (int a = 0; a < 3; a++)
+  {
+    if (plo[a] < lo[a]) lo[a] = plo[a];
+    if (phi[a] > hi[a]) hi[a] = phi[a];
+  }
+}
+
+/// Spread the lower 10 bits of v so there are two zero bits between each
+inline unsigned int spread_bits(unsigned int v)
+{
+  v &= 0x3ff;
+  v = (v | (v << 16)) & 0x030000ff;
+  v = (v | (v <<  8)) & 0x0300f00f;
+  v = (v | (v <<  4)) & 0x030c30c3;
+  v = (v | (v <<  2)) & 0x09249249;
+  return (v);
+}
+
+}
+
+SearchBVH::SearchBVH() :
+  num_items_(0)
+{
+}
+
+
+void
+SearchBVH::build(const std::vector<Point>& points)
+{
+  build(static_cast<size_type>(points.size()),
+    [&points](index_type i, Point& pmin, Point& pmax)
+    { pmin = points[i]; pmax = points[i]; });
+}
+
+
+void
+SearchBVH::insert(index_type item, const BBox& box)
+{
+  Extra e;
+  e.item = item;
+  const Point pmin = box.get_min();
+  const Point pmax = box.get_max();
+  for (int a = 0; a < 3; a++) { e.lo[a] = pmin[a]; e.hi[a] = pmax[a]; }
+  add_extra(e);
+}
+
+
+void
+SearchBVH::insert(index_type item, const Point& point)
+{
+  Extra e;
+  e.item = item;
+  for (int a = 0; a < 3; a++) { e.lo[a] = point[a]; e.hi[a] = point[a]; }
+  add_extra(e);
+}
+
+
+void
+SearchBVH::add_extra(const Extra& e)
+{
+  extra_.push_back(e);
+  const size_type num_extra = static_cast<size_type>(extra_.size());
+  if (num_extra > min_extra && num_extra*extra_fraction > num_items_) rebuild();
+}
+
+
+void
+SearchBVH::rebuild()
+{
+  index_type max_item = -1;
+  for (index_type j = 0; j < num_items_; j++) max_item = std::max(max_item, items_[j]);
+  for (size_t j = 0; j < extra_.size(); j++) max_item = std::max(max_item, extra_[j].item);
+
+  // Slots of items that are not in the tree yet start out empty, so the
+  // boxes of the overflow list can be merged in the same way for all items
+  const size_t num_slots = 3*static_cast<size_t>(max_item + 1);
+  lo_.resize(num_slots, DBL_MAX);
+  hi_.resize(num_slots, -DBL_MAX);
+
+  std::vector<char> in_tree(max_item + 1, 0);
+  for (index_type j = 0; j < num_items_; j++) in_tree[items_[j]] = 1;
+  for (size_t j = 0; j < extra_.size(); j++)
+  {
+    const Extra& e = extra_[j];
+    extend_box(&lo_[3*e.item], &hi_[3*e.item], e.lo, e.hi);
+    if (!in_tree[e.item])
+    {
+      in_tree[e.item] = 1;
+      items_.push_back(e.item);
+    }
+  }
+  build_items();
+}
+
+
+void
+SearchBVH::remove(index_type item)
+{
+  for (size_t j = 0; j < extra_.size(); j++)
+  {
+    if (extra_[j].item == item)
+    {
+      extra_[j] = extra_.back();
+      extra_.pop_back();
+      return;
+    }
+  }
+}
+
+
+void
+SearchBVH::range_bounds(index_type begin, index_type end, double* lo, double* hi) const
+{
+  empty_box(lo, hi);
+  for (index_type j = begin; j < end; j++)
+  {
+    const index_type item = items_[j];
+    extend_box(lo, hi, &lo_[3*item], &hi_[3*item]);
+  }
+}
+
+
+void
+SearchBVH::set_slot(Node& n, int k, index_type child, index_type count,
+                    const double* lo, const double* hi)
+{
+  n.child[k] = child;
+  n.count[k] = count;
+  for (int a = 0; a < 3; a++) { n.lo[a][k] = lo[a]; n.hi[a][k] = hi[a]; }
+}
+
+
+bool
+SearchBVH::split(index_type begin, index_type end, int depth, index_type& mid)
+{
+  const index_type count = end - begin;
+  if (count <= leaf_size || depth >= max_depth) return (false);
+
+  double clo[3], chi[3];
+  empty_box(clo, chi);
+  for (index_type j = begin; j < end; j++)
+  {
+    const double* c = &centroid_[3*items_[j]];
+    extend_box(clo, chi, c, c);
+  }
+
+  // Evaluate the surface area heuristic for the bin boundaries of all
+  // three axes and keep the cheapest one
+  double best_cost = DBL_MAX;
+  int best_axis = -1;
+  int best_bin = 0;
+
+  for (int a = 0; a < 3; a++)
+  {
+    const double extent = chi[a] - clo[a];
+    if (!(extent > 0.0)) continue;
+    const double scale = num_bins / extent;
+
+    index_type bin_count[num_bins] = { 0 };
+    double bin_lo[num_bins][3], bin_hi[num_bins][3];
+    for (int b = 0; b < num_bins; b++) empty_box(bin_lo[b], bin_hi[b]);
+
+    for (index_type j = begin; j < end; j++)
+    {
+      const index_type item = items_[j];
+      int b = static_cast<int>((centroid_[3*item+a] - clo[a]) * scale);
+      if (b >= num_bins) b = num_bins - 1;
+      bin_count[b]++;
+      extend_box(bin_lo[b], bin_hi[b], &lo_[3*item], &hi_[3*item]);
+    }
+
+    // Sweep from the right to get the cost of every right hand side
+    double right_area[num_bins];
+    index_type right_count[num_bins];
+    double rlo[3], rhi[3];
+    empty_box(rlo, rhi);
+    index_type rc = 0;
+    for (int b = num_bins - 1; b > 0; b--)
+    {
+      extend_box(rlo, rhi, bin_lo[b], bin_hi[b]);
+      rc += bin_count[b];
+      right_area[b] = (rc > 0) ? half_area(rlo, rhi) : 0.0;
+      right_count[b] = rc;
+    }
+
+    double llo[3], lhi[3];
+    empty_box(llo, lhi);
+    index_type lc = 0;
+    for (int b = 1; b < num_bins; b++)
+    {
+      extend_box(llo, lhi, bin_lo[b-1], bin_hi[b-1]);
+      lc += bin_count[b-1];
+      if (lc == 0 || right_count[b] == 0) continue;
+      const double cost = half_area(llo, lhi) * lc + right_area[b] * right_count[b];
+      if (cost < best_cost)
+      {
+        best_cost = cost;
+        best_axis = a;
+        best_bin = b;
+      }
+    }
+  }
+
+  if (best_axis < 0)
+  {
+    // All centroids coincide, split the range in half to keep leaves small
+    mid = begin + count / 2;
+    return (true);
+  }
+
+  double lo[3], hi[3];
+  range_bounds(begin, end, lo, hi);
+  const double area = half_area(lo, hi);
+  // Making a leaf costs count box tests, a split one traversal step plus the
+  // area weighted tests of both children
+  if (count <= 4*leaf_size && area > 0.0 && best_cost / area + 1.0 >= count)
+    return (false);
+
+  const double scale = num_bins / (chi[best_axis] - clo[best_axis]);
+  const double* centroid = &centroid_[0];
+  const double lower = clo[best_axis];
+  index_type* split_point = std::partition(&items_[0] + begin, &items_[0] + end,
+    [centroid, best_axis, best_bin, scale, lower](index_type item)
+    {
+      int b = static_cast<int>((centroid[3*item+best_axis] - lower) * scale);
+      if (b >= num_bins) b = num_bins - 1;
+      return (b < best_bin);
+    });
+  mid = static_cast<index_type>(split_point - &items_[0]);
+  return (mid > begin && mid < end);
+}
+
+
+void
+SearchBVH::build_range(std::vector<Node>& nodes, const Task& task,
+                       int split_depth, std::vector<Task>* pending)
+{
+  std::vector<Task> stack(1, task);
+  while (!stack.empty())
+  {
+    const Task t = stack.back();
+    stack.pop_back();
+
+    if (pending && t.depth >= split_depth)
+    {
+      pending->push_back(t);
+      continue;
+    }
+
+    double lo[3], hi[3];
+    range_bounds(t.begin, t.end, lo, hi);
+
+    index_type mid;
+    if (!split(t.begin, t.end, t.depth, mid))
+    {
+      set_slot(nodes[t.node], t.slot, ~t.begin, t.end - t.begin, lo, hi);
+      continue;
+    }
+
+    const index_type child = static_cast<index_type>(nodes.size());
+    nodes.push_back(Node());
+    set_slot(nodes[t.node], t.slot, child, t.end - t.begin, lo, hi);
+
+    Task left  = { child, 0, t.begin, mid, t.depth + 1 };
+    Task right = { child, 1, mid, t.end, t.depth + 1 };
+    stack.push_back(right);
+    stack.push_back(left);
+  }
+}
+
+
+void
+SearchBVH::build_tree(size_type n)
+{
+  items_.resize(n);
+  for (index_type i = 0; i < n; i++) items_[i] = i;
+  build_items();
+}
+
+
+void
+SearchBVH::build_items()
+{
+  const size_type n = static_cast<size_type>(items_.size());
+  num_items_ = n;
+  nodes_.clear();
+  extra_.clear();
+  centroid_.resize(lo_.size());
+  for (index_type j = 0; j < n; j++)
+  {
+    const index_type i = items_[j];
+    for (int a = 0; a < 3; a++) centroid_[3*i+a] = 0.5*(lo_[3*i+a] + hi_[3*i+a]);
+  }
+  if (n == 0) return;
+
+  // Node 0 is a root holding the full range in its first slot, so every
+  // query starts with the same two box test as at any other level
+  const double empty_lo[3] = { DBL_MAX, DBL_MAX, DBL_MAX };
+  const double empty_hi[3] = { -DBL_MAX, -DBL_MAX, -DBL_MAX };
+  nodes_.resize(1);
+  set_slot(nodes_[0], 1, 0, 0, empty_lo, empty_hi);
+
+  const unsigned int num_threads = Parallel::NumCores();
+  const Task root = { 0, 0, 0, n, 0 };
+  if (num_threads < 2 || n < 4096)
+  {
+    build_range(nodes_, root, 0, 0);
+  }
+  else
+  {
+    // Build the top levels here until there are a few ranges per thread,
+    // then build the subtrees below them concurrently and splice them in
+    int split_depth = 2;
+    while ((1u << split_depth) < 4*num_threads && split_depth < 16) split_depth++;
+
+    std::vector<Task> pending;
+    build_range(nodes_, root, split_depth, &pending);
+
+    std::vector<std::vector<Node> > subtrees(pending.size());
+    Parallel::For(0, pending.size(), 1, [&](size_t begin, size_t end)
+    {
+      for (size_t j = begin; j < end; j++)
+      {
+        std::vector<Node>& nodes = subtrees[j];
+        nodes.resize(1);
+        set_slot(nodes[0], 1, 0, 0, empty_lo, empty_hi);
+        const Task t = { 0, 0, pending[j].begin, pending[j].end, pending[j].depth };
+        build_range(nodes, t, 0, 0);
+      }
+    });
+
+    for (size_t j = 0; j < pending.size(); j++)
+    {
+      const std::vector<Node>& nodes = subtrees[j];
+      // The subtree's node 0 is its local root, nodes 1.. are appended
+      const index_type offset = static_cast<index_type>(nodes_.size()) - 1;
+      for (size_t k = 1; k < nodes.size(); k++)
+      {
+        Node nd = nodes[k];
+        for (int s = 0; s < 2; s++) if (nd.child[s] > 0) nd.child[s] += offset;
+        nodes_.push_back(nd);
+      }
+
+      const Node& local_root = nodes[0];
+      index_type child = local_root.child[0];
+      if (child > 0) child += offset;
+      const double lo[3] = { local_root.lo[0][0], local_root.lo[1][0], local_root.lo[2][0] };
+      const double hi[3] = { local_root.hi[0][0], local_root.hi[1][0], local_root.hi[2][0] };
+      set_slot(nodes_[pending[j].node], pending[j].slot, child, local_root.count[0], lo, hi);
+    }
+  }
+
+  std::vector<double>().swap(centroid_);
+}
+
+
+void
+SearchBVH::morton_order(const std::vector<Point>& points,
+                        std::vector<index_type>& order)
+{
+  const size_t n = points.size();
+  order.resize(n);
+  if (n == 0) return;
+
+  double lo[3], hi[3];
+  empty_box(lo, hi);
+  for (size_t j = 0; j < n; j++)
+  {
+    const double p[3] = { points[j].x(), points[j].y(), points[j].z() };
+    extend_box(lo, hi, p, p);
+  }
+
+  double scale[3];
+  for (int a = 0; a < 3; a++)
+  {
+    const double extent = hi[a] - lo[a];
+    scale[a] = (extent > 0.0) ? 1023.0 / extent : 0.0;
+  }
+
+  std::vector<std::pair<unsigned int, index_type> > codes(n);
+  for (size_t j = 0; j < n; j++)
+  {
+    unsigned int code = 0;
+    for (int a = 0; a < 3; a++)
+    {
+      const unsigned int v = static_cast<unsigned int>((points[j][a] - lo[a]) * scale[a]);
+      code |= spread_bits(v) << a;
+    }
+    codes[j] = std::make_pair(code, static_cast<index_type>(j));
+  }
+  std::sort(codes.begin(), codes.end());
+  for (size_t j = 0; j < n; j++) order[j] = codes[j].second;
+}
@@ -0,0 +1,331 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef CORE_GEOMETRYPRIMITIVES_SEARCHBVH_H
+#define CORE_GEOMETRYPRIMITIVES_SEARCHBVH_H 1
+
+#include <Core/GeometryPrimitives/Point.h>
+#include <Core/GeometryPrimitives/BBox.h>
+#include <Core/Datatypes/Legacy/Base/Types.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+#include <Core/GeometryPrimitives/share.h>
+
+namespace SCIRun {
+
+/// Bounding volume hierarchy over a set of boxes, used as an alternative to
+/// SearchGridT for the locate tables of unstructured meshes. The tree is built
+/// with a binned surface area heuristic, so it adapts to meshes with strongly
+/// graded element sizes where a uniform grid ends up with huge or empty bins.
+///
+/// The tree is stored flattened: every node holds the boxes of its two
+/// children in structure of arrays layout, so a query tests both children
+/// with the same few vectorizable instructions before descending.
+///
+/// Items added after the build (see insert) are kept in a small overflow list
+/// that every query scans as well. Once that list grows past a fraction of
+/// the tree, the tree is rebuilt over both, so queries stay logarithmic when
+/// a mesh is grown item by item. Removing an item only affects that list;
+/// boxes in the tree stay conservative, callers test the actual element.
+class SCISHARE SearchBVH
+{
+  public:
+    typedef SCIRun::index_type index_type;
+    typedef SCIRun::size_type  size_type;
+
+    SearchBVH();
+
+    /// Build the tree over n items, box(i, min, max) gives the bounds of
+    /// item i.
+    template <class BOXFUNC>
+    void build(size_type n, BOXFUNC box)
+    {
+      lo_.resize(3*static_cast<size_t>(n));
+      hi_.resize(3*static_cast<size_t>(n));
+      for (index_type i = 0; i < n; i++)
+      {
+        Core::Geometry::Point pmin, pmax;
+        box(i, pmin, pmax);
+        for (int a = 0; a < 3; a++) { lo_[3*i+a] = pmin[a]; hi_[3*i+a] = pmax[a]; }
+      }
+      build_tree(n);
+    }
+
+    /// Build the tree over a set of points
+    void build(const std::vector<Core::Geometry::Point>& points);
+
+    /// Add an item after the tree was built. An item that is already in the
+    /// tree gets the union of both boxes.
+    void insert(index_type item, const Core::Geometry::BBox& box);
+    void insert(index_type item, const Core::Geometry::Point& point);
+    /// Remove an item that was added after the tree was built
+    void remove(index_type item);
+
+    inline size_type size() const { return (num_items_ + static_cast<size_type>(extra_.size())); }
+
+    /// Visit every item whose box contains p, in no particular order.
+    /// visit(item) returns true to stop the search, in which case lookup
+    /// returns true as well.
+    template <class VISITOR>
+    bool lookup(const Core::Geometry::Point& p, VISITOR visit) const
+    {
+      const double q[3] = { p.x(), p.y(), p.z() };
+      return (traverse(
+        [&q](const double* lo, const double* hi)
+        {
+          return (q[0] >= lo[0] && q[0] <= hi[0] &&
+                  q[1] >= lo[1] && q[1] <= hi[1] &&
+                  q[2] >= lo[2] && q[2] <= hi[2]);
+        }, visit));
+    }
+
+    /// Visit every item whose box overlaps box b
+    template <class VISITOR>
+    bool lookup(const Core::Geometry::BBox& b, VISITOR visit) const
+    {
+      const Core::Geometry::Point bmin = b.get_min();
+      const Core::Geometry::Point bmax = b.get_max();
+      const double qlo[3] = { bmin.x(), bmin.y(), bmin.z() };
+      const double qhi[3] = { bmax.x(), bmax.y(), bmax.z() };
+      return (traverse(
+        [&qlo, &qhi](const double* lo, const double* hi)
+        {
+          return (qlo[0] <= hi[0] && qhi[0] >= lo[0] &&
+                  qlo[1] <= hi[1] && qhi[1] >= lo[1] &&
+                  qlo[2] <= hi[2] && qhi[2] >= lo[2]);
+        }, visit));
+    }
+
+    /// Find the item closest to p. dist(item, dmin2) returns the squared
+    /// distance from p to the item; it may return any value >= dmin2 when
+    /// the item is further away than the best one so far. On entry dmin2
+    /// limits the search radius, on return it holds the squared distance to
+    /// the item found. Returns -1 if no item lies within the search radius.
+    template <class DISTANCE>
+    index_type closest(const Core::Geometry::Point& p, double& dmin2,
+                       DISTANCE dist) const
+    {
+      const double q[3] = { p.x(), p.y(), p.z() };
+      index_type best = -1;
+
+      for (size_t j = 0; j < extra_.size(); j++)
+      {
+        if (box_distance2(q, extra_[j].lo, extra_[j].hi) >= dmin2) continue;
+        const double d = dist(extra_[j].item, dmin2);
+        if (d < dmin2) { dmin2 = d; best = extra_[j].item; }
+      }
+      if (nodes_.empty()) return (best);
+
+      struct Entry { index_type node; double d; };
+      Entry stack[max_depth + 4];
+      int sp = 0;
+      stack[sp].node = 0; stack[sp].d = 0.0; sp++;
+
+      while (sp > 0)
+      {
+        const Entry e = stack[--sp];
+        if (e.d >= dmin2) continue;
+        const Node& n = nodes_[e.node];
+
+        double d[2];
+        for (int k = 0; k < 2; k++)
+        {
+          double s = 0.0;
+          for (int a = 0; a < 3; a++)
+          {
+            const double v = std::max(std::max(n.lo[a][k] - q[a], q[a] - n.hi[a][k]), 0.0);
+            s += v*v;
+          }
+          d[k] = s;
+        }
+
+        // Leaves are scanned right away, nearest first, so dmin2 shrinks as
+        // early as possible. Inner nodes are pushed far child first, so the
+        // near child is popped next.
+        const int near = (d[1] < d[0]) ? 1 : 0;
+        const int order[2] = { near, 1 - near };
+        for (int kk = 0; kk < 2; kk++)
+        {
+          const int k = order[kk];
+          if (n.child[k] < 0 && d[k] < dmin2 && n.count[k] > 0)
+            scan_leaf(n, k, q, dmin2, best, dist);
+        }
+        for (int kk = 1; kk >= 0; kk--)
+        {
+          const int k = order[kk];
+          if (n.child[k] >= 0 && d[k] < dmin2 && n.count[k] > 0)
+          {
+            stack[sp].node = n.child[k]; stack[sp].d = d[k]; sp++;
+          }
+        }
+      }
+      return (best);
+    }
+
+    /// Order a set of query points along a Morton (Z-order) curve, so that
+    /// queries processed in this order hit the same parts of the tree and of
+    /// the mesh one after the other.
+    static void morton_order(const std::vector<Core::Geometry::Point>& points,
+                             std::vector<index_type>& order);
+
+  private:
+    static const int max_depth = 60;
+    static const int leaf_size = 4;
+    /// The overflow list is merged into the tree when it holds more than
+    /// min_extra items and more than 1/extra_fraction of the tree
+    static const int min_extra = 64;
+    static const int extra_fraction = 8;
+
+    struct Node
+    {
+      /// Bounds of the two children, per axis
+      double lo[3][2];
+      double hi[3][2];
+      /// >= 0 : index of the child node, < 0 : leaf holding items_[~child]
+      /// up to items_[~child + count]
+      index_type child[2];
+      index_type count[2];
+    };
+
+    struct Extra
+    {
+      index_type item;
+      double lo[3];
+      double hi[3];
+    };
+
+    static inline double box_distance2(const double* q, const double* lo, const double* hi)
+    {
+      double s = 0.0;
+      for (int a = 0; a < 3; a++)
+      {
+        const double v = std::max(std::max(lo[a] - q[a], q[a] - hi[a]), 0.0);
+        s += v*v;
+      }
+      return (s);
+    }
+
+    template <class DISTANCE>
+    inline void scan_leaf(const Node& n, int k, const double* q, double& dmin2,
+                          index_type& best, DISTANCE& dist) const
+    {
+      const index_type start = ~n.child[k];
+      for (index_type j = start; j < start + n.count[k]; j++)
+      {
+        const index_type item = items_[j];
+        if (box_distance2(q, &lo_[3*item], &hi_[3*item]) >= dmin2) continue;
+        const double d = dist(item, dmin2);
+        if (d < dmin2) { dmin2 = d; best = item; }
+      }
+    }
+
+    template <class TEST, class VISITOR>
+    bool traverse(TEST test, VISITOR& visit) const
+    {
+      for (size_t j = 0; j < extra_.size(); j++)
+      {
+        if (test(extra_[j].lo, extra_[j].hi) && visit(extra_[j].item)) return (true);
+      }
+      if (nodes_.empty()) return (false);
+
+      index_type stack[max_depth + 4];
+      int sp = 0;
+      stack[sp++] = 0;
+      while (sp > 0)
+      {
+        const Node& n = nodes_[stack[--sp]];
+        for (int k = 0; k < 2; k++)
+        {
+          if (n.count[k] == 0) continue;
+          const double lo[3] = { n.lo[0][k], n.lo[1][k], n.lo[2][k] };
+          const double hi[3] = { n.hi[0][k], n.hi[1][k], n.hi[2][k] };
+          if (!test(lo, hi)) continue;
+          if (n.child[k] >= 0)
+          {
+            stack[sp++] = n.child[k];
+          }
+          else
+          {
+            const index_type start = ~n.child[k];
+            for (index_type j = start; j < start + n.count[k]; j++)
+            {
+              const index_type item = items_[j];
+              if (test(&lo_[3*item], &hi_[3*item]) && visit(item)) return (true);
+            }
+          }
+        }
+      }
+      return (false);
+    }
+
+    struct Task
+    {
+      index_type node;
+      int        slot;
+      index_type begin;
+      index_type end;
+      int        depth;
+    };
+
+    void build_tree(size_type n);
+    /// Build the tree over the items listed in items_
+    void build_items();
+    void add_extra(const Extra& e);
+    /// Build a new tree over the items in the tree and the overflow list
+    void rebuild();
+    /// Build the subtree over items_[begin,end) into nodes, which holds the
+    /// node whose slot refers to it. Ranges that should be handed to another
+    /// thread are appended to pending instead when split_depth is reached.
+    void build_range(std::vector<Node>& nodes, const Task& task,
+                     int split_depth, std::vector<Task>* pending);
+    /// Partition items_[begin,end) with the binned surface area heuristic.
+    /// Returns false when the range should become a leaf.
+    bool split(index_type begin, index_type end, int depth, index_type& mid);
+    void range_bounds(index_type begin, index_type end, double* lo, double* hi) const;
+    static void set_slot(Node& n, int k, index_type child, index_type count,
+                         const double* lo, const double* hi);
+
+    size_type                 num_items_;
+    /// Item bounds, 3 per item
+    std::vector<double>       lo_;
+    std::vector<double>       hi_;
+    /// Item centroids, used during the build only
+    std::vector<double>       centroid_;
+    /// Items in leaf order
+    std::vector<index_type>   items_;
+    std::vector<Node>         nodes_;
+    std::vector<Extra>        extra_;
+};
+
+} // namespace SCIRun
+
+#endif
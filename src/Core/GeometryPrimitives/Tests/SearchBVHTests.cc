@@ -0,0 +1,177 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <Core/GeometryPrimitives/SearchBVH.h>
+#include <Core/GeometryPrimitives/PointVectorOperators.h>
+
+#include <algorithm>
+#include <set>
+
+using namespace SCIRun;
+using namespace SCIRun::Core::Geometry;
+
+namespace
+{
+  // Points on a graded grid: spacing grows geometrically along x, the kind
+  // of distribution a uniform search grid handles poorly
+  std::vector<Point> GradedPoints(int n)
+  {
+    std::vector<Point> points;
+    double x = 0.0, h = 1e-3;
+    for (int i = 0; i < n; i++, x += h, h *= 1.2)
+      for (int j = 0; j < n; j++)
+        for (int k = 0; k < n; k++)
+          points.push_back(Point(x, 0.1*j + 0.01*i, 0.1*k));
+    return points;
+  }
+}
+
+TEST(SearchBVHTests, EmptyTreeFindsNothing)
+{
+  SearchBVH bvh;
+  bvh.build(std::vector<Point>());
+  double d2 = 1e300;
+  EXPECT_EQ(-1, bvh.closest(Point(0,0,0), d2, [](index_type, double) { return 0.0; }));
+  EXPECT_FALSE(bvh.lookup(Point(0,0,0), [](index_type) { return true; }));
+}
+
+TEST(SearchBVHTests, ClosestPointMatchesBruteForce)
+{
+  auto points = GradedPoints(12);
+  SearchBVH bvh;
+  bvh.build(points);
+  EXPECT_EQ(points.size(), static_cast<size_t>(bvh.size()));
+
+  for (int q = 0; q < 200; q++)
+  {
+    Point p(0.05*q - 1.0, 0.013*q, 1.1 - 0.007*q);
+    double best = 1e300;
+    for (const auto& pt : points)
+      best = std::min(best, (pt - p).length2());
+
+    double d2 = 1e300;
+    index_type idx = bvh.closest(p, d2,
+      [&](index_type i, double) { return (points[i] - p).length2(); });
+    ASSERT_NE(-1, idx);
+    EXPECT_DOUBLE_EQ(best, d2);
+    EXPECT_DOUBLE_EQ(best, (points[idx] - p).length2());
+  }
+}
+
+TEST(SearchBVHTests, BoxLookupMatchesBruteForce)
+{
+  auto points = GradedPoints(10);
+  SearchBVH bvh;
+  bvh.build(static_cast<size_type>(points.size()),
+    [&](index_type i, Point& pmin, Point& pmax)
+    {
+      pmin = points[i] - Vector(0.01, 0.01, 0.01);
+      pmax = points[i] + Vector(0.01, 0.01, 0.01);
+    });
+
+  BBox box(Point(0.005, 0.3, 0.25), Point(0.02, 0.55, 0.61));
+  std::set<index_type> expected, found;
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    BBox b(points[i] - Vector(0.01, 0.01, 0.01), points[i] + Vector(0.01, 0.01, 0.01));
+    if (box.overlaps(b)) expected.insert(static_cast<index_type>(i));
+  }
+  bvh.lookup(box, [&](index_type i) { found.insert(i); return false; });
+  EXPECT_FALSE(expected.empty());
+  EXPECT_EQ(expected, found);
+
+  Point p = points[37];
+  EXPECT_TRUE(bvh.lookup(p, [](index_type i) { return i == 37; }));
+}
+
+TEST(SearchBVHTests, InsertedItemsAreFound)
+{
+  auto points = GradedPoints(5);
+  SearchBVH bvh;
+  bvh.build(points);
+
+  Point extra(100, 100, 100);
+  bvh.insert(static_cast<index_type>(points.size()), extra);
+  double d2 = 1e300;
+  EXPECT_EQ(static_cast<index_type>(points.size()),
+    bvh.closest(Point(99, 99, 99), d2, [&](index_type i, double)
+    { return ((i < static_cast<index_type>(points.size()) ? points[i] : extra) - Point(99,99,99)).length2(); }));
+
+  bvh.remove(static_cast<index_type>(points.size()));
+  EXPECT_EQ(static_cast<size_type>(points.size()), bvh.size());
+}
+
+TEST(SearchBVHTests, GrowingPastTheTreeRebuildsIt)
+{
+  auto points = GradedPoints(4);
+  SearchBVH bvh;
+  bvh.build(points);
+
+  // A moved item, then enough inserts to trigger several rebuilds
+  const Point moved(-3, -3, -3);
+  bvh.insert(5, moved);
+  const size_t num_built = points.size();
+  for (int j = 0; j < 300; j++)
+  {
+    points.push_back(Point(0.5 + 0.01*j, 0.3*(j % 7), 0.2*(j % 5)));
+    bvh.insert(static_cast<index_type>(points.size() - 1), points.back());
+  }
+  EXPECT_EQ(static_cast<size_type>(points.size()), bvh.size());
+
+  std::set<index_type> found;
+  bvh.lookup(BBox(Point(-1e9, -1e9, -1e9), Point(1e9, 1e9, 1e9)),
+    [&found](index_type i) { found.insert(i); return false; });
+  EXPECT_EQ(points.size(), found.size());
+
+  // The old box of the moved item is kept as well
+  EXPECT_TRUE(bvh.lookup(points[5], [](index_type i) { return i == 5; }));
+  EXPECT_TRUE(bvh.lookup(moved, [](index_type i) { return i == 5; }));
+
+  for (size_t j = num_built; j < points.size(); j += 13)
+  {
+    const Point q = points[j] + Vector(0.001, 0.002, -0.001);
+    double d2 = 1e300;
+    const index_type idx = bvh.closest(q, d2, [&](index_type i, double)
+      { return ((i == 5 ? moved : points[i]) - q).length2(); });
+    EXPECT_EQ(static_cast<index_type>(j), idx);
+  }
+}
+
+TEST(SearchBVHTests, MortonOrderIsAPermutation)
+{
+  auto points = GradedPoints(6);
+  std::vector<index_type> order;
+  SearchBVH::morton_order(points, order);
+  ASSERT_EQ(points.size(), order.size());
+  std::vector<index_type> sorted(order);
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t i = 0; i < sorted.size(); i++)
+    EXPECT_EQ(static_cast<index_type>(i), sorted[i]);
+}
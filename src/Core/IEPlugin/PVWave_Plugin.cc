@@ -186,7 +186,7 @@ FieldHandle PVWave_reader(ProgressReporter *pr, const char *filename)
   {
     fi.make_char();
     result = CreateField(fi,mesh);
-    char* ptr = reinterpret_cast<char*>(result->vfield()->get_values_pointer());
+    char* ptr = reinterpret_cast<char*>(result->vfield()->mutable_values_pointer());
     inputfile.read(ptr,num_elems*1);
     // No byte swapping needed
   }
@@ -194,7 +194,7 @@ FieldHandle PVWave_reader(ProgressReporter *pr, const char *filename)
   {
     fi.make_short();
     result = CreateField(fi,mesh);
-    char* ptr = reinterpret_cast<char*>(result->vfield()->get_values_pointer());
+    char* ptr = reinterpret_cast<char*>(result->vfield()->mutable_values_pointer());
     inputfile.read(ptr,num_elems*2);
     if (isBigEndian())
     {
@@ -206,7 +206,7 @@ FieldHandle PVWave_reader(ProgressReporter *pr, const char *filename)
   {
     fi.make_int();
     result = CreateField(fi,mesh);
-    char* ptr = reinterpret_cast<char*>(result->vfield()->get_values_pointer());
+    char* ptr = reinterpret_cast<char*>(result->vfield()->mutable_values_pointer());
     inputfile.read(ptr,num_elems*4);
     if (isBigEndian())
     {
@@ -218,7 +218,7 @@ FieldHandle PVWave_reader(ProgressReporter *pr, const char *filename)
   {
     fi.make_float();
     result = CreateField(fi,mesh);
-    char* ptr = reinterpret_cast<char*>(result->vfield()->get_values_pointer());
+    char* ptr = reinterpret_cast<char*>(result->vfield()->mutable_values_pointer());
     inputfile.read(ptr,num_elems*4);
     if (isBigEndian())
     {
@@ -231,7 +231,7 @@ FieldHandle PVWave_reader(ProgressReporter *pr, const char *filename)
   {  
     fi.make_double();
     result = CreateField(fi,mesh);
-    char* ptr = reinterpret_cast<char*>(result->vfield()->get_values_pointer());
+    char* ptr = reinterpret_cast<char*>(result->vfield()->mutable_values_pointer());
     inputfile.read(ptr,num_elems*8);
     if (isBigEndian())
     {
@@ -76,7 +76,7 @@ std::string SCIRun::defaultImportTypeForFile(const GenericIEPluginManager<NrrdDa
 template <>
 std::string SCIRun::defaultExportTypeForFile(const GenericIEPluginManager<Field>*)
 {
-  return "SCIRun Field Binary (*.fld);;SCIRun Field ASCII (*.fld)";
+  return "SCIRun Field Binary (*.fld);;SCIRun Field ASCII (*.fld);;SCIRun Field Compressed (*.fld)";
 }
 
 template <>
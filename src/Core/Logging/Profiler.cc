@@ -0,0 +1,217 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Core/Logging/Profiler.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/thread/locks.hpp>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace SCIRun::Core::Logging;
+
+CORE_SINGLETON_IMPLEMENTATION(Profiler)
+
+namespace
+{
+  long long steadyMicroseconds()
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  std::string escape(const std::string& s)
+  {
+    std::ostringstream out;
+    for (auto c : s)
+    {
+      if (c == '"' || c == '\\')
+        out << '\\' << c;
+      else if (static_cast<unsigned char>(c) < 0x20)
+        out << ' ';
+      else
+        out << c;
+    }
+    return out.str();
+  }
+}
+
+Profiler::Profiler() : enabled_(false), origin_(steadyMicroseconds())
+{
+}
+
+void Profiler::start(const std::string& filename)
+{
+  boost::lock_guard<boost::mutex> guard(lock_);
+  filename_ = filename;
+  events_.clear();
+  origin_ = steadyMicroseconds();
+  enabled_ = true;
+}
+
+bool Profiler::stop()
+{
+  enabled_ = false;
+  if (filename_.empty())
+    return true;
+
+  std::ofstream file(filename_);
+  file << (boost::ends_with(filename_, ".folded") ? foldedStacks() : chromeTrace());
+  return static_cast<bool>(file);
+}
+
+void Profiler::record(Event event)
+{
+  boost::lock_guard<boost::mutex> guard(lock_);
+  if (enabled_)
+    events_.push_back(std::move(event));
+}
+
+std::vector<Profiler::Event> Profiler::events() const
+{
+  boost::lock_guard<boost::mutex> guard(lock_);
+  return events_;
+}
+
+long long Profiler::now() const
+{
+  return steadyMicroseconds() - origin_;
+}
+
+int Profiler::currentThread()
+{
+  static std::atomic<int> threadCount(0);
+  thread_local int id = threadCount++;
+  return id;
+}
+
+long long Profiler::peakMemoryKilobytes()
+{
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return counters.PeakWorkingSetSize / 1024;
+  return 0;
+#else
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
+std::string Profiler::chromeTrace() const
+{
+  std::ostringstream out;
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const auto& e : events())
+  {
+    out << (first ? "\n" : ",\n");
+    first = false;
+    out << "{\"name\":\"" << escape(e.name) << "\",\"cat\":\"" << escape(e.category) << "\",\"ph\":\"" << e.phase
+      << "\",\"ts\":" << e.timestamp << ",\"pid\":1,\"tid\":" << e.thread;
+    if (e.phase == 'E')
+    {
+      out << ",\"args\":{\"peakMemoryDeltaKB\":" << e.peakMemoryDeltaKilobytes;
+      if (e.bytes >= 0)
+        out << ",\"bytes\":" << e.bytes;
+      out << "}";
+    }
+    out << "}";
+  }
+  out << "\n]}\n";
+  return out.str();
+}
+
+std::string Profiler::foldedStacks() const
+{
+  struct Frame
+  {
+    std::string stack;
+    long long begin, children;
+  };
+  std::map<int, std::vector<Frame>> stacks;
+  std::map<std::string, long long> selfTimes;
+
+  for (const auto& e : events())
+  {
+    auto& stack = stacks[e.thread];
+    if (e.phase == 'B')
+    {
+      auto name = e.name;
+      std::replace(name.begin(), name.end(), ';', ',');
+      stack.push_back({ stack.empty() ? name : stack.back().stack + ";" + name, e.timestamp, 0 });
+    }
+    else if (!stack.empty())
+    {
+      const auto frame = stack.back();
+      stack.pop_back();
+      const auto total = e.timestamp - frame.begin;
+      selfTimes[frame.stack] += total - frame.children;
+      if (!stack.empty())
+        stack.back().children += total;
+    }
+  }
+
+  std::ostringstream out;
+  for (const auto& s : selfTimes)
+    out << s.first << " " << s.second << "\n";
+  return out.str();
+}
+
+ScopedProfile::ScopedProfile(const char* category, const std::string& name)
+  : active_(Profiler::Instance().enabled()), category_(category), bytes_(-1), peakMemoryAtBegin_(0)
+{
+  if (!active_)
+    return;
+  name_ = name;
+  peakMemoryAtBegin_ = Profiler::peakMemoryKilobytes();
+  auto& profiler = Profiler::Instance();
+  profiler.record({ 'B', name_, category_, profiler.now(), Profiler::currentThread(), -1, 0 });
+}
+
+ScopedProfile::~ScopedProfile()
+{
+  if (!active_)
+    return;
+  auto& profiler = Profiler::Instance();
+  profiler.record({ 'E', name_, category_, profiler.now(), Profiler::currentThread(), bytes_,
+    Profiler::peakMemoryKilobytes() - peakMemoryAtBegin_ });
+}
@@ -0,0 +1,117 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CORE_LOGGING_PROFILER_H
+#define CORE_LOGGING_PROFILER_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <Core/Utils/Singleton.h>
+#include <Core/Logging/share.h>
+
+namespace SCIRun
+{
+  namespace Core
+  {
+    namespace Logging
+    {
+      /// Collects begin/end events of module executions, algorithm runs, parallel regions and
+      /// port transfers from every thread, and writes them as a Chrome trace (chrome://tracing,
+      /// ui.perfetto.dev) or as folded stacks for flame graph tools. Off by default; while off,
+      /// a ScopedProfile costs one atomic load.
+      class SCISHARE Profiler : boost::noncopyable
+      {
+        CORE_SINGLETON(Profiler)
+
+      public:
+        struct SCISHARE Event
+        {
+          /// 'B' or 'E', as in the trace format
+          char phase;
+          std::string name;
+          std::string category;
+          /// microseconds since the profiler was started
+          long long timestamp;
+          int thread;
+          /// set on end events only, -1 if unknown
+          long long bytes;
+          long long peakMemoryDeltaKilobytes;
+        };
+
+        /// Clears recorded events and starts recording; stop() writes them to filename.
+        /// A .folded extension selects folded stacks, anything else a Chrome trace.
+        void start(const std::string& filename);
+        /// Stops recording and writes the trace file, if one was given.
+        bool stop();
+        bool enabled() const { return enabled_; }
+
+        void record(Event event);
+        std::vector<Event> events() const;
+
+        std::string chromeTrace() const;
+        /// One line per distinct stack of each thread with its self time in microseconds.
+        std::string foldedStacks() const;
+
+        long long now() const;
+        /// Small sequential ids, in the order threads first record an event.
+        static int currentThread();
+        /// Peak resident set size of the process.
+        static long long peakMemoryKilobytes();
+
+      private:
+        Profiler();
+        std::atomic<bool> enabled_;
+        std::string filename_;
+        long long origin_;
+        mutable boost::mutex lock_;
+        std::vector<Event> events_;
+      };
+
+      /// Records a begin event on construction and an end event on destruction, carrying the
+      /// growth of peak memory in between and, if set, the size of the data handled.
+      class SCISHARE ScopedProfile : boost::noncopyable
+      {
+      public:
+        ScopedProfile(const char* category, const std::string& name);
+        ~ScopedProfile();
+        void setBytes(long long bytes) { bytes_ = bytes; }
+      private:
+        bool active_;
+        const char* category_;
+        std::string name_;
+        long long bytes_;
+        long long peakMemoryAtBegin_;
+      };
+    }
+  }
+}
+
+#endif
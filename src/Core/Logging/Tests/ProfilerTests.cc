@@ -0,0 +1,158 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <boost/filesystem.hpp>
+#include <Core/Logging/Profiler.h>
+
+using namespace SCIRun::Core::Logging;
+
+namespace
+{
+  void nestedScopes()
+  {
+    ScopedProfile outer("module", "Outer");
+    {
+      ScopedProfile inner("algorithm", "Inner");
+      inner.setBytes(800);
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  }
+
+  std::string contents(const boost::filesystem::path& path)
+  {
+    std::ifstream file(path.string());
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+  }
+}
+
+TEST(ProfilerTests, RecordsNothingWhenDisabled)
+{
+  auto& profiler = Profiler::Instance();
+  profiler.start("");
+  profiler.stop();
+  nestedScopes();
+  EXPECT_TRUE(profiler.events().empty());
+}
+
+TEST(ProfilerTests, RecordsNestedBeginEndPairs)
+{
+  auto& profiler = Profiler::Instance();
+  profiler.start("");
+  nestedScopes();
+  profiler.stop();
+
+  auto events = profiler.events();
+  ASSERT_EQ(4, events.size());
+  EXPECT_EQ('B', events[0].phase);
+  EXPECT_EQ("Outer", events[0].name);
+  EXPECT_EQ('B', events[1].phase);
+  EXPECT_EQ("algorithm", events[1].category);
+  EXPECT_EQ('E', events[2].phase);
+  EXPECT_EQ("Inner", events[2].name);
+  EXPECT_EQ(800, events[2].bytes);
+  EXPECT_EQ('E', events[3].phase);
+  EXPECT_EQ(-1, events[3].bytes);
+  EXPECT_GE(events[2].timestamp - events[1].timestamp, 2000);
+  EXPECT_LE(events[2].timestamp, events[3].timestamp);
+  for (const auto& e : events)
+    EXPECT_EQ(events[0].thread, e.thread);
+
+  const auto trace = profiler.chromeTrace();
+  EXPECT_NE(std::string::npos, trace.find("\"traceEvents\":["));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"Inner\",\"cat\":\"algorithm\",\"ph\":\"E\""));
+  EXPECT_NE(std::string::npos, trace.find("\"bytes\":800"));
+}
+
+TEST(ProfilerTests, FoldedStacksSplitSelfTime)
+{
+  auto& profiler = Profiler::Instance();
+  profiler.start("");
+  nestedScopes();
+  profiler.stop();
+
+  std::istringstream folded(profiler.foldedStacks());
+  std::map<std::string, long long> stacks;
+  std::string stack;
+  long long time;
+  while (folded >> stack >> time)
+    stacks[stack] = time;
+  ASSERT_EQ(2, stacks.size());
+  EXPECT_GE(stacks["Outer;Inner"], 2000);
+  EXPECT_LT(stacks["Outer"], stacks["Outer;Inner"]);
+}
+
+TEST(ProfilerTests, ThreadsAreToldApart)
+{
+  auto& profiler = Profiler::Instance();
+  profiler.start("");
+  std::thread t1(nestedScopes), t2(nestedScopes);
+  t1.join();
+  t2.join();
+  profiler.stop();
+
+  auto events = profiler.events();
+  ASSERT_EQ(8, events.size());
+  std::set<int> threads;
+  for (const auto& e : events)
+    threads.insert(e.thread);
+  EXPECT_EQ(2, threads.size());
+  const auto folded = profiler.foldedStacks();
+  EXPECT_EQ(2, std::count(folded.begin(), folded.end(), '\n'));
+}
+
+TEST(ProfilerTests, StopWritesTheFile)
+{
+  const auto dir = boost::filesystem::temp_directory_path();
+  const auto json = dir / boost::filesystem::unique_path("profile-%%%%-%%%%.json");
+  const auto folded = dir / boost::filesystem::unique_path("profile-%%%%-%%%%.folded");
+  auto& profiler = Profiler::Instance();
+
+  profiler.start(json.string());
+  nestedScopes();
+  EXPECT_TRUE(profiler.stop());
+  EXPECT_EQ(profiler.chromeTrace(), contents(json));
+
+  profiler.start(folded.string());
+  nestedScopes();
+  EXPECT_TRUE(profiler.stop());
+  EXPECT_EQ(profiler.foldedStacks(), contents(folded));
+
+  boost::filesystem::remove(json);
+  boost::filesystem::remove(folded);
+  profiler.start("");
+  profiler.stop();
+}
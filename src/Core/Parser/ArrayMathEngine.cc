@@ -1809,6 +1809,7 @@ NewArrayMathEngine::run()
     pr_->error("Could not set array size.");
     return (false);
   }
+  mprogram_->set_fused_execution(fused_execution_);
   // Run the program
   if (!(ArrayMathInterpreter::run(mprogram_,error_str)))
   {
@@ -92,9 +92,13 @@ class SCISHARE NewArrayMathEngine : public Parser, public ArrayMathInterpreter
     // THAT THE FUNCTIONS ARE GIVEN HERE
   
     // Make sure it starts with a clean definition file
-    NewArrayMathEngine() { clear(); pr_ = &def_pr_; }
+    NewArrayMathEngine() { clear(); pr_ = &def_pr_; fused_execution_ = true; }
   
     void setLogger(Core::Logging::LegacyLoggerInterface* logger) { pr_ = logger; }
+
+    // Run elementwise functions through fused lane kernels (default), or
+    // every function through the interpreter
+    void set_fused_execution(bool fused) { fused_execution_ = fused; }
   
     // Generate inputs for field data and field data properties
     bool add_input_fielddata(const std::string& name, 
@@ -214,6 +218,8 @@ class SCISHARE NewArrayMathEngine : public Parser, public ArrayMathInterpreter
     // bigger than 1, will set this variable
     // Any subsequent array that does not match the size will cause an error
     size_type array_size_;
+
+    bool fused_execution_;
     
     // Data that needs to be stored as it is needed before and after the parser is
     // done. An output needs to be set before the parser, otherwise it is optimized
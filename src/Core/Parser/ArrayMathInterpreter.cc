@@ -34,11 +34,291 @@
 #include <Core/Datatypes/Legacy/Field/VField.h>
 #include <Core/Thread/Parallel.h>
 #include <boost/bind.hpp>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Thread;
 
+namespace {
+
+int type_width(const std::string& type)
+{
+  if (type == "S") return (1);
+  if (type == "V") return (3);
+  if (type == "T") return (6);
+  return (0);
+}
+
+// A sequential function can be fused if there is a lane kernel for it and
+// all its arguments are Scalar, Vector or Tensor buffers
+bool is_fusable(ParserScriptFunctionHandle& fhandle, int& kernel, int& component)
+{
+  if (!ArrayMathFusedCode::find_kernel(
+                 fhandle->get_function()->get_function_id(),kernel,component))
+    return (false);
+
+  if (type_width(fhandle->get_output_var()->get_type()) == 0) return (false);
+
+  size_t num_input_vars = fhandle->num_input_vars();
+  for (size_t i=0; i < num_input_vars; i++)
+  {
+    ParserScriptVariableHandle ihandle = fhandle->get_input_var(i);
+    if (type_width(ihandle->get_type()) == 0) return (false);
+    if (!(ihandle->get_flags() & SCRIPT_SEQUENTIAL_VAR_E)) return (false);
+  }
+  return (true);
+}
+
+// Replace the sequential functions start up to end by fused code. Results
+// that are only used inside the run are kept in registers, the others are
+// written to their sequential buffers as the interpreter would do.
+void fuse_sequential_run(ParserProgramHandle& pprogram,
+                         ArrayMathProgramHandle& mprogram,
+                         size_t start, size_t end,
+                         const std::vector<int>& kernels,
+                         const std::vector<int>& components)
+{
+  ParserScriptFunctionHandle fhandle;
+  size_t num_sequential_functions = pprogram->num_sequential_functions();
+
+  std::set<int> read_outside;
+  for (size_t j=0; j<num_sequential_functions; j++)
+  {
+    if (j >= start && j < end) continue;
+    pprogram->get_sequential_function(j,fhandle);
+    for (size_t i=0; i < fhandle->num_input_vars(); i++)
+    {
+      ParserScriptVariableHandle ihandle = fhandle->get_input_var(i);
+      if (ihandle->get_flags() & SCRIPT_SEQUENTIAL_VAR_E)
+        read_outside.insert(ihandle->get_var_number());
+    }
+  }
+
+  std::vector<char> stored(end-start,false);
+  for (size_t j=start; j<end; j++)
+  {
+    pprogram->get_sequential_function(j,fhandle);
+    int onum = fhandle->get_output_var()->get_var_number();
+    bool read_later = false;
+    for (size_t k=j+1; k<end; k++)
+    {
+      ParserScriptFunctionHandle khandle;
+      pprogram->get_sequential_function(k,khandle);
+      for (size_t i=0; i < khandle->num_input_vars(); i++)
+        if (khandle->get_input_var(i)->get_var_number() == onum) read_later = true;
+    }
+    stored[j-start] = (read_outside.count(onum) || !read_later);
+  }
+
+  int num_proc = mprogram->get_num_proc();
+  for (int np=0; np < num_proc; np++)
+  {
+    ArrayMathFusedCodeHandle code(new ArrayMathFusedCode);
+    std::map<int,ArrayMathFusedCode::Operand> written;
+
+    for (size_t j=start; j<end; j++)
+    {
+      pprogram->get_sequential_function(j,fhandle);
+
+      ArrayMathFusedCode::Operand input[2];
+      size_t num_input_vars = fhandle->num_input_vars();
+      for (size_t i=0; i < num_input_vars; i++)
+      {
+        ParserScriptVariableHandle ihandle = fhandle->get_input_var(i);
+        int inum = ihandle->get_var_number();
+        std::map<int,ArrayMathFusedCode::Operand>::iterator it = written.find(inum);
+        if (it != written.end())
+        {
+          input[i] = it->second;
+        }
+        else
+        {
+          int p = (ihandle->get_flags() & SCRIPT_CONST_VAR_E) ? 0 : np;
+          input[i].data = mprogram->get_sequential_variable(inum,p)->get_data();
+          input[i].width = type_width(ihandle->get_type());
+        }
+      }
+
+      ParserScriptVariableHandle ohandle = fhandle->get_output_var();
+      int onum = ohandle->get_var_number();
+      ArrayMathFusedCode::Operand output;
+      output.width = type_width(ohandle->get_type());
+      if (stored[j-start])
+        output.data = mprogram->get_sequential_variable(onum,np)->get_data();
+      else
+        output.reg = code->add_register(output.width);
+      written[onum] = output;
+
+      code->add_instruction(kernels[j],components[j],output,input[0],input[1]);
+    }
+
+    mprogram->set_sequential_fused_code(start,np,code);
+  }
+}
+
+// Find the runs of sequential functions that have lane kernels
+void fuse_sequential_functions(ParserProgramHandle& pprogram,
+                               ArrayMathProgramHandle& mprogram)
+{
+  ParserScriptFunctionHandle fhandle;
+  size_t num_sequential_functions = pprogram->num_sequential_functions();
+
+  std::vector<int> kernels(num_sequential_functions,-1);
+  std::vector<int> components(num_sequential_functions,0);
+  for (size_t j=0; j<num_sequential_functions; j++)
+  {
+    pprogram->get_sequential_function(j,fhandle);
+    if (!is_fusable(fhandle,kernels[j],components[j])) kernels[j] = -1;
+  }
+
+  size_t start = 0;
+  while (start < num_sequential_functions)
+  {
+    if (kernels[start] < 0) { start++; continue; }
+
+    size_t end = start;
+    while (end < num_sequential_functions && kernels[end] >= 0) end++;
+
+    // A single function does not have intermediates to keep in registers
+    if (end-start > 1)
+      fuse_sequential_run(pprogram,mprogram,start,end,kernels,components);
+    start = end;
+  }
+}
+
+// Lane kernels, each processes the entries of one lane group. N is the
+// number of entries when it is known at compile time, otherwise n is used.
+// W is the number of doubles per entry of the output, inputs either have the
+// same width or a single value per entry that applies to all components.
+
+typedef ArrayMathFusedCode::LaneKernel LaneKernel;
+
+struct AddOp  { static double apply(double x, double y) { return (x+y); } };
+struct SubOp  { static double apply(double x, double y) { return (x-y); } };
+struct MultOp { static double apply(double x, double y) { return (x*y); } };
+struct DivOp  { static double apply(double x, double y) { return (x/y); } };
+
+const double log2_scale = 1.0/log(2.0);
+const double log10_scale = 1.0/log(10.0);
+
+struct NegOp   { static double apply(double x) { return (-x); } };
+struct AbsOp   { static double apply(double x) { return (x < 0 ? -x : x); } };
+struct SqrtOp  { static double apply(double x) { return (::sqrt(x)); } };
+struct CbrtOp  { static double apply(double x) { return (::pow(x,1.0/3.0)); } };
+struct ExpOp   { static double apply(double x) { return (::exp(x)); } };
+struct LogOp   { static double apply(double x) { return (::log(x)); } };
+struct Log2Op  { static double apply(double x) { return (::log(x)*log2_scale); } };
+struct Log10Op { static double apply(double x) { return (::log(x)*log10_scale); } };
+struct SinOp   { static double apply(double x) { return (::sin(x)); } };
+struct CosOp   { static double apply(double x) { return (::cos(x)); } };
+struct TanOp   { static double apply(double x) { return (::tan(x)); } };
+
+template<class OP, int W, int WA, int WB, int N>
+void lane_binary(double* out, const double* a, const double* b, int n)
+{
+  const int count = (N > 0) ? N : n;
+  if (WA == WB)
+  {
+    for (int k=0; k<count*W; k++) out[k] = OP::apply(a[k],b[k]);
+  }
+  else if (WB == 1)
+  {
+    for (int l=0; l<count; l++)
+      for (int c=0; c<W; c++) out[l*W+c] = OP::apply(a[l*W+c],b[l]);
+  }
+  else
+  {
+    for (int l=0; l<count; l++)
+      for (int c=0; c<W; c++) out[l*W+c] = OP::apply(a[l],b[l*W+c]);
+  }
+}
+
+// Same as the interpreter, a division by a scalar scales by its inverse
+template<int W, int N>
+void lane_scale(double* out, const double* a, const double* b, int n)
+{
+  const int count = (N > 0) ? N : n;
+  for (int l=0; l<count; l++)
+  {
+    const double val = 1.0/b[l];
+    for (int c=0; c<W; c++) out[l*W+c] = a[l*W+c]*val;
+  }
+}
+
+template<class OP, int W, int N>
+void lane_unary(double* out, const double* a, const double*, int n)
+{
+  const int count = (N > 0) ? N : n;
+  for (int k=0; k<count*W; k++) out[k] = OP::apply(a[k]);
+}
+
+template<int C, int N>
+void lane_component(double* out, const double* a, const double*, int n)
+{
+  const int count = (N > 0) ? N : n;
+  for (int l=0; l<count; l++) out[l] = a[3*l+C];
+}
+
+template<class OP, int N>
+LaneKernel select_binary(int w, int wa, int wb)
+{
+  if (w == 1) return (&lane_binary<OP,1,1,1,N>);
+  if (w == 3)
+  {
+    if (wa == wb) return (&lane_binary<OP,3,3,3,N>);
+    if (wb == 1) return (&lane_binary<OP,3,3,1,N>);
+    return (&lane_binary<OP,3,1,3,N>);
+  }
+  if (wa == wb) return (&lane_binary<OP,6,6,6,N>);
+  if (wb == 1) return (&lane_binary<OP,6,6,1,N>);
+  return (&lane_binary<OP,6,1,6,N>);
+}
+
+template<class OP, int N>
+LaneKernel select_unary(int w)
+{
+  if (w == 1) return (&lane_unary<OP,1,N>);
+  if (w == 3) return (&lane_unary<OP,3,N>);
+  return (&lane_unary<OP,6,N>);
+}
+
+template<int N>
+LaneKernel select_kernel(int kernel, int component, int w, int wa, int wb)
+{
+  switch (kernel)
+  {
+    case ArrayMathFusedCode::ADD_E:  return (select_binary<AddOp,N>(w,wa,wb));
+    case ArrayMathFusedCode::SUB_E:  return (select_binary<SubOp,N>(w,wa,wb));
+    case ArrayMathFusedCode::MULT_E: return (select_binary<MultOp,N>(w,wa,wb));
+    case ArrayMathFusedCode::DIV_E:
+      if (w == 1) return (&lane_binary<DivOp,1,1,1,N>);
+      if (w == 3) return (&lane_scale<3,N>);
+      return (&lane_scale<6,N>);
+    case ArrayMathFusedCode::NEG_E:   return (select_unary<NegOp,N>(w));
+    case ArrayMathFusedCode::ABS_E:   return (select_unary<AbsOp,N>(w));
+    case ArrayMathFusedCode::SQRT_E:  return (select_unary<SqrtOp,N>(w));
+    case ArrayMathFusedCode::CBRT_E:  return (select_unary<CbrtOp,N>(w));
+    case ArrayMathFusedCode::EXP_E:   return (select_unary<ExpOp,N>(w));
+    case ArrayMathFusedCode::LOG_E:   return (select_unary<LogOp,N>(w));
+    case ArrayMathFusedCode::LOG2_E:  return (select_unary<Log2Op,N>(w));
+    case ArrayMathFusedCode::LOG10_E: return (select_unary<Log10Op,N>(w));
+    case ArrayMathFusedCode::SIN_E:   return (select_unary<SinOp,N>(w));
+    case ArrayMathFusedCode::COS_E:   return (select_unary<CosOp,N>(w));
+    case ArrayMathFusedCode::TAN_E:   return (select_unary<TanOp,N>(w));
+    case ArrayMathFusedCode::COMPONENT_E:
+      if (component == 0) return (&lane_component<0,N>);
+      if (component == 1) return (&lane_component<1,N>);
+      return (&lane_component<2,N>);
+  }
+  return (0);
+}
+
+}
+
 ArrayMathFunction::ArrayMathFunction(
       ArrayMathFunctionPtr function,
       const std::string& function_id,
@@ -146,6 +426,17 @@ ArrayMathInterpreter::translate(ParserProgramHandle& pprogram,
   }
 
   // Determine how many space we need to reserve for sequential variables
+  size_type values_per_entry = 0;
+  for (size_t j=0; j<num_sequential_variables; j++)
+  {
+    pprogram->get_sequential_variable(j,vhandle);
+    std::string type = vhandle->get_type();
+    if (type == "S") { values_per_entry += 1; }
+    else if (type == "V") { values_per_entry += 3; }
+    else if (type == "T") { values_per_entry += 6; }
+  }
+  mprogram->set_buffer_size_for_cache(values_per_entry);
+
   auto buffer_size = mprogram->get_buffer_size();
   int num_proc    = mprogram->get_num_proc();
       
@@ -1188,6 +1479,8 @@ ArrayMathInterpreter::translate(ParserProgramHandle& pprogram,
     }
   }
 
+  fuse_sequential_functions(pprogram,mprogram);
+
   return (true);
 }
 
@@ -1509,11 +1802,28 @@ ArrayMathProgram::run_single(size_t& error_line)
 }
 
 
+void
+ArrayMathProgram::set_buffer_size_for_cache(size_type values_per_entry)
+{
+  if (!adaptive_buffer_size_ || values_per_entry < 1) return;
+
+  // Leave part of a 32kB L1 cache for the sources, sinks and the stack
+  const size_type l1_budget = 24*1024;
+  size_type buffer_size = l1_budget/(values_per_entry*static_cast<size_type>(sizeof(double)));
+
+  // Short buffers make the per function call overhead dominate, long ones
+  // still fit in L2 for programs with many intermediates
+  buffer_size = std::max<size_type>(64, std::min<size_type>(2048, buffer_size));
+  buffer_size_ = buffer_size & ~static_cast<size_type>(15);
+}
+
+
 bool
 ArrayMathProgram::run_sequential(size_t& error_line)
 {  
-  error_line_.resize(num_proc_,0);
-  success_.resize(num_proc_,true);
+  error_line_.assign(num_proc_,0);
+  success_.assign(num_proc_,true);
+  next_offset_ = 0;
   
   Parallel::RunTasks(boost::bind(&ArrayMathProgram::run_parallel, this, _1), num_proc_);
  
@@ -1532,41 +1842,141 @@ ArrayMathProgram::run_sequential(size_t& error_line)
 void
 ArrayMathProgram::run_parallel(int proc)
 {
-  index_type per_thread = array_size_/num_proc_;
-  index_type start = proc*per_thread;
-  index_type end   = (proc+1)*per_thread;
-  index_type offset, sz;
-  if (proc+1 == num_proc_) end = array_size_;
-  
-  offset = start;
-  success_[proc] = true;
+  const index_type end = array_size_;
+  const size_t size = sequential_functions_[proc].size();
 
-  while (offset < end)
+  while (success_[proc])
   {
-    sz = buffer_size_;
+    const index_type offset = next_offset_.fetch_add(buffer_size_);
+    if (offset >= end) break;
+
+    index_type sz = buffer_size_;
     if (offset+sz >= end) sz = end-offset;
      
-    size_t size = sequential_functions_[proc].size();
-    for (size_t j=0; j<size;j++)
-    {
-      sequential_functions_[proc][j]->set_index(offset);
-      sequential_functions_[proc][j]->set_size(sz);
-    }
     for (size_t j=0; j<size; j++)
     {
-      if(!(sequential_functions_[proc][j]->run()))
+      if (fused_execution_ && sequential_fused_code_[proc][j])
+      {
+        ArrayMathFusedCode& fc = *(sequential_fused_code_[proc][j]);
+        fc.run(sz);
+        j += fc.num_functions()-1;
+        continue;
+      }
+
+      ArrayMathProgramCode& pc = *(sequential_functions_[proc][j]);
+      pc.set_index(offset);
+      pc.set_size(sz);
+      if(!(pc.run()))
       {
         error_line_[proc] = j;
         success_[proc] = false;
+        break;
       }
     }
-    offset += sz;
   }
   
   barrier_.wait();
 }
 
 
+bool
+ArrayMathFusedCode::find_kernel(const std::string& function_id,
+                                int& kernel, int& component)
+{
+  size_t loc = function_id.find('$');
+  if (loc == std::string::npos) return (false);
+
+  const std::string name = function_id.substr(0,loc);
+  const std::string args = function_id.substr(loc+1);
+  component = 0;
+
+  if (args == "S:S" || args == "V:V" || args == "T:T" || args == "V:S" ||
+      args == "T:S" || args == "S:V" || args == "S:T")
+  {
+    if (name == "add") kernel = ADD_E;
+    else if (name == "sub") kernel = SUB_E;
+    // mult$T:T is a matrix product, mult$V:V multiplies componentwise
+    else if (name == "mult" && args != "T:T") kernel = MULT_E;
+    else if (name == "div" && (args == "S:S" || args == "V:S" || args == "T:S")) kernel = DIV_E;
+    else return (false);
+    return (true);
+  }
+
+  if (name == "neg" && (args == "S" || args == "V" || args == "T"))
+  {
+    kernel = NEG_E;
+    return (true);
+  }
+
+  if (args == "V")
+  {
+    kernel = COMPONENT_E;
+    if (name == "x") component = 0;
+    else if (name == "y") component = 1;
+    else if (name == "z") component = 2;
+    else return (false);
+    return (true);
+  }
+
+  if (args == "S")
+  {
+    if (name == "abs") kernel = ABS_E;
+    else if (name == "sqrt") kernel = SQRT_E;
+    else if (name == "cbrt") kernel = CBRT_E;
+    else if (name == "exp") kernel = EXP_E;
+    else if (name == "log" || name == "ln") kernel = LOG_E;
+    else if (name == "log2") kernel = LOG2_E;
+    else if (name == "log10") kernel = LOG10_E;
+    else if (name == "sin") kernel = SIN_E;
+    else if (name == "cos") kernel = COS_E;
+    else if (name == "tan") kernel = TAN_E;
+    else return (false);
+    return (true);
+  }
+
+  return (false);
+}
+
+void
+ArrayMathFusedCode::add_instruction(int kernel, int component,
+                                    const Operand& output,
+                                    const Operand& input1,
+                                    const Operand& input2)
+{
+  Instruction instruction;
+  instruction.group_kernel = select_kernel<LANE_WIDTH>(kernel,component,
+                                 output.width,input1.width,input2.width);
+  instruction.tail_kernel = select_kernel<0>(kernel,component,
+                                 output.width,input1.width,input2.width);
+  instruction.output = output;
+  instruction.input[0] = input1;
+  instruction.input[1] = input2;
+  instructions_.push_back(instruction);
+  num_functions_++;
+}
+
+void
+ArrayMathFusedCode::run(size_type size)
+{
+  const size_t num_instructions = instructions_.size();
+
+  for (index_type offset=0; offset<size; offset+=LANE_WIDTH)
+  {
+    const int n = static_cast<int>(std::min<size_type>(LANE_WIDTH,size-offset));
+
+    for (size_t j=0; j<num_instructions; j++)
+    {
+      const Instruction& ins = instructions_[j];
+      double* out = address(ins.output,offset);
+      const double* a = address(ins.input[0],offset);
+      const double* b = address(ins.input[1],offset);
+      if (n == LANE_WIDTH) ins.group_kernel(out,a,b,n);
+      else ins.tail_kernel(out,a,b,n);
+    }
+  }
+}
+
+
 void
 ArrayMathProgramCode::print() const
 {
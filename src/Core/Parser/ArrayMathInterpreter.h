@@ -43,6 +43,7 @@
 #include <boost/function.hpp>
 #include <boost/variant.hpp>
 #include <boost/noncopyable.hpp>
+#include <atomic>
 // Include files needed for Windows
 #include <Core/Parser/share.h>
 
@@ -254,6 +255,88 @@ class SCISHARE ArrayMathFunction : public ParserFunction {
   typedef boost::shared_ptr<ArrayMathProgramCode> ArrayMathProgramCodePtr;
 
 
+//-----------------------------------------------------------------------------
+// Fused code segment, replaces a run of consecutive elementwise sequential
+// functions. Instead of calling each function over the whole buffer, the run
+// is executed on small groups of entries at a time. Intermediates that are
+// not needed outside the run stay in a small register file and never touch
+// the sequential buffers. Each function is replaced by a lane kernel, a
+// fixed width loop without dependencies between entries that the compiler
+// turns into SIMD instructions.
+
+class SCISHARE ArrayMathFusedCode : boost::noncopyable {
+  public:
+    // Number of entries processed together by each lane kernel
+    enum { LANE_WIDTH = 64 };
+
+    enum {
+      ADD_E, SUB_E, MULT_E, DIV_E, NEG_E, ABS_E, SQRT_E, CBRT_E, EXP_E,
+      LOG_E, LOG2_E, LOG10_E, SIN_E, COS_E, TAN_E, COMPONENT_E
+    };
+
+    // Find the lane kernel for a catalogue function. Returns false if the
+    // function has no lane kernel and needs to run through the interpreter.
+    static bool find_kernel(const std::string& function_id,
+                            int& kernel, int& component);
+
+    ArrayMathFusedCode() : num_functions_(0) {}
+
+    // Each operand is either a sequential buffer (data) or a register (reg,
+    // the offset in the register file), width is the number of doubles per
+    // entry (1, 3 or 6)
+    struct Operand {
+      Operand() : data(0), reg(-1), width(1) {}
+      double* data;
+      int     reg;
+      int     width;
+    };
+
+    // Add the next function of the run, inputs that are not used by the
+    // kernel are ignored
+    void add_instruction(int kernel, int component, const Operand& output,
+                         const Operand& input1, const Operand& input2);
+
+    // Allocate a register for an intermediate result of the given width
+    int add_register(int width)
+    {
+      int reg = static_cast<int>(registers_.size());
+      registers_.resize(reg+width*LANE_WIDTH);
+      return (reg);
+    }
+
+    // Number of sequential functions this code replaces
+    size_t num_functions() const { return (num_functions_); }
+
+    // Run the fused functions over the first size entries of the buffers
+    void run(size_type size);
+
+    // A lane kernel processes n entries, the kernels for whole lane groups
+    // have the number of entries compiled in
+    typedef void (*LaneKernel)(double* out, const double* a, const double* b, int n);
+
+  private:
+    struct Instruction {
+      LaneKernel group_kernel;
+      LaneKernel tail_kernel;
+      Operand    output;
+      Operand    input[2];
+    };
+
+    inline double* address(const Operand& op, index_type offset)
+    {
+      if (op.reg >= 0) return (&(registers_[op.reg]));
+      if (!op.data) return (0);
+      return (op.data + offset*op.width);
+    }
+
+    std::vector<Instruction> instructions_;
+    std::vector<double>      registers_;
+    size_t num_functions_;
+};
+
+  typedef boost::shared_ptr<ArrayMathFusedCode> ArrayMathFusedCodeHandle;
+
+
 
 class SCISHARE ArrayMathProgramVariable 
 {
@@ -315,9 +398,12 @@ class SCISHARE ArrayMathProgramSource {
     ArrayMathProgram() : num_proc_(Core::Thread::Parallel::NumCores()), barrier_("ArrayMathProgram", num_proc_)
     {
       // Buffer size describes how many values of a sequential variable are
-      // grouped together for vectorized execution
+      // grouped together for vectorized execution. The default is adapted to
+      // the program once it is known, see set_buffer_size_for_cache.
       buffer_size_ = 128;
+      adaptive_buffer_size_ = true;
       array_size_ = 1;
+      fused_execution_ = true;
     }
     
     // Constructor that allows overloading the default optimization parameters
@@ -329,7 +415,9 @@ class SCISHARE ArrayMathProgramSource {
       // Buffer size describes how many values of a sequential variable are
       // grouped together for vectorized execution
       buffer_size_ = buffer_size;
+      adaptive_buffer_size_ = false;
       array_size_ = array_size;
+      fused_execution_ = true;
     }
   
     // Get the optimization parameters, these can only be set when creating the
@@ -340,6 +428,13 @@ class SCISHARE ArrayMathProgramSource {
     // Get the number of processors
     int get_num_proc() const { return (num_proc_); }
 
+    // Choose the buffer size so that the intermediate results of one buffer
+    // of every sequential variable, values_per_entry doubles per entry in
+    // total, stay in the L1 cache while the program runs over them. Only
+    // applies when the buffer size was not given explicitly, and has to be
+    // called before the buffers are allocated.
+    void set_buffer_size_for_cache(size_type values_per_entry);
+
     // Set the size of the array to process
     size_type get_array_size() const { return (array_size_); }
     void set_array_size(size_type array_size) { array_size_ = array_size; }
@@ -376,8 +471,12 @@ class SCISHARE ArrayMathProgramSource {
     void resize_sequential_functions(size_t sz)
       {
         sequential_functions_.resize(num_proc_);
+        sequential_fused_code_.resize(num_proc_);
         for (int np=0; np < num_proc_; np++) 
+        {
           sequential_functions_[np].resize(sz); 
+          sequential_fused_code_[np].assign(sz,ArrayMathFusedCodeHandle());
+        }
       }
 
     // Central buffer for all parameters
@@ -407,6 +506,16 @@ class SCISHARE ArrayMathProgramSource {
       { single_functions_[j] = pc; }
     void set_sequential_program_code(size_t j, size_t np, ArrayMathProgramCodePtr pc)
       { sequential_functions_[np][j] = pc; }
+
+    // Run the sequential functions j up to j+code->num_functions() as one
+    // fused code segment
+    void set_sequential_fused_code(size_t j, size_t np, ArrayMathFusedCodeHandle code)
+      { sequential_fused_code_[np][j] = code; }
+
+    // Fused code is used by default, switching it off runs every sequential
+    // function through the interpreter
+    void set_fused_execution(bool fused) { fused_execution_ = fused; }
+    bool get_fused_execution() const { return (fused_execution_); }
     
     // Code to find the pointers that are given for sources and sinks  
     bool find_source(const std::string& name,  ArrayMathProgramSource& ps);
@@ -424,6 +533,7 @@ class SCISHARE ArrayMathProgramSource {
     // General parameters that determine how many values are computed at
     // the same time and how many processors to use
     size_type buffer_size_;
+    bool adaptive_buffer_size_;
     int num_proc_;
     
     // The size of the array we are using
@@ -445,6 +555,8 @@ class SCISHARE ArrayMathProgramSource {
     std::vector<ArrayMathProgramCodePtr> const_functions_;
     std::vector<ArrayMathProgramCodePtr> single_functions_;
     std::vector<std::vector<ArrayMathProgramCodePtr> > sequential_functions_;
+    std::vector<std::vector<ArrayMathFusedCodeHandle> > sequential_fused_code_;
+    bool fused_execution_;
     
     ParserProgramHandle pprogram_;
     
@@ -454,7 +566,11 @@ class SCISHARE ArrayMathProgramSource {
 
     // Error reporting parallel code
     std::vector<size_type>  error_line_;
-    std::vector<bool>       success_;
+    std::vector<char>       success_;
+
+    // Start of the next buffer to process; threads take buffers from the
+    // array until it is exhausted, so uneven costs per entry even out
+    std::atomic<index_type> next_offset_;
 
     Core::Thread::Barrier barrier_;
 };
@@ -30,9 +30,11 @@
 #include <Core/Parser/Parser.h> 
 #include <Core/Datatypes/Legacy/Base/Types.h>
 #include <iostream>
+#include <cmath>
 #include <sci_debug.h>
 #include <boost/math/constants/constants.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
 
 using namespace SCIRun;
 
@@ -2302,6 +2304,14 @@ Parser::optimize(ParserProgramHandle program,
     ++it;
   }
   
+  // Phase 1b: Simplify the expression trees. Constant pieces are folded,
+  // constants are propagated through variables and expressions that do not
+  // contribute to any of the output variables are marked so they can be
+  // skipped altogether.
+  
+  std::vector<char> live_expressions;
+  optimize_simplify(program,live_expressions);
+  
   // Phase 2: run through the full tree and setup intermediate variables
   //  for each phase of the computation and translate constant strings and
   //  doubles as well into variables.
@@ -2311,6 +2321,9 @@ Parser::optimize(ParserProgramHandle program,
   
   for (size_t j=0; j<num_expressions; j++)
   {
+    // Skip expressions whose result is never used
+    if (!(live_expressions[j])) continue;
+    
     // Get the tree
     program->get_expression(j,thandle);
 
@@ -2658,59 +2671,68 @@ Parser::optimize(ParserProgramHandle program,
 
 
   // Phase 5: Remove duplicate expressions
+  // Every used function is looked up by its dependence string, which is the
+  // function name and the unique names of its inputs. As the inputs of a
+  // function are replaced before the function itself is looked up, duplicate
+  // sub expressions of any depth collapse onto the first one computed.
+  // Unused functions are skipped, they will not be part of the script.
+
+  std::map<std::string,ParserScriptVariableHandle> computed;
+  std::map<std::string,ParserScriptVariableHandle>::iterator cit;
+  std::string dependence;
 
   fit = functions.begin();
   fit_end = functions.end();
-
-  std::string dependence, dependence2;
   
   while (fit != fit_end)
   {
+    if (!((*fit)->get_flags() & SCRIPT_USED_VAR_E)) { ++fit; continue; }
+  
     ParserScriptVariableHandle handle = (*fit)->get_output_var();
     handle->compute_dependence();
     dependence = handle->get_dependence();
  
-    fit2 = functions.begin();
-    while (fit2 != fit)
+    cit = computed.find(dependence);
+    // Named variables are output variables, these need to stay
+    if (cit == computed.end() || !(handle->get_name().empty()))
     {
-      ParserScriptVariableHandle nhandle = (*fit2)->get_output_var();
+      computed[dependence] = handle;
+      ++fit;
+      continue;
+    }
 
-      dependence2 = nhandle->get_dependence();
-      if (dependence2 == dependence)
+    // The handle with which the ones in the script need to be replaced
+    ParserScriptVariableHandle nhandle = (*cit).second;
+    
+    // Expressions are equal
+    // Clear dependence, clear flags
+    handle->clear_dependence();
+    // Clear the used flag for this variable
+    handle->clear_flags();
+    ParserScriptFunctionHandle fhandle = handle->get_parent();
+    if (!fhandle)
+    {
+      error = "INTERNAL ERROR -  Duplicate input variable.";
+      return (false);
+    }
+    // Clear the function that computes the variable
+    fhandle->clear_flags();
+    std::list<ParserScriptFunctionHandle>::iterator hit, hit_end;
+    hit = functions.begin();
+    hit_end = functions.end();
+    while (hit != hit_end)
+    {
+      ParserScriptFunctionHandle hhandle = (*hit);
+      size_t num_input_vars = hhandle->num_input_vars();
+      for (size_t j=0; j<num_input_vars;j++)
       {
-        // The handle with which the ones in the script need to be replaced
-        // Expressions are equal
-        // Clear dependence, clear flags
-        handle->clear_dependence();
-        // Clear the used flag for this variable
-        handle->clear_flags();
-        ParserScriptFunctionHandle fhandle = handle->get_parent();
-        if (!fhandle)
+        if (hhandle->get_input_var(j) == handle)
         {
-          error = "INTERNAL ERROR -  Duplicate input variable.";
-          return (false);
-        }
-        // Clear the function that computes the variable
-        fhandle->clear_flags();
-        std::list<ParserScriptFunctionHandle>::iterator hit, hit_end;
-        hit = functions.begin();
-        hit_end = functions.end();
-        while (hit != hit_end)
-        {
-          ParserScriptFunctionHandle hhandle = (*hit);
-          size_t num_input_vars = hhandle->num_input_vars();
-          for (size_t j=0; j<num_input_vars;j++)
-          {
-            if (hhandle->get_input_var(j) == handle)
-            {
-              hhandle->set_input_var(j,nhandle);
-            }
-          }
-          ++hit;
+          hhandle->set_input_var(j,nhandle);
         }
       }
-      ++fit2;
-    }  
+      ++hit;
+    }
     ++fit;
   }
 
@@ -2908,6 +2930,295 @@ Parser::optimize_mark_used(ParserScriptFunctionHandle& fhandle)
 }
 
 
+void
+Parser::optimize_simplify(ParserProgramHandle& program,
+                          std::vector<char>& live)
+{
+  size_t num_expressions = program->num_expressions();
+  ParserTreeHandle thandle;
+
+  ParserVariableList input_variables, output_variables;
+  program->get_input_variables(input_variables);
+  program->get_output_variables(output_variables);
+  
+  // Simplify the trees in program order, so a variable that was assigned a
+  // constant can be replaced by the constant in the expressions that follow.
+  // The root of an output expression is kept, so the output variable does not
+  // turn into an alias of another variable or of a constant.
+  std::map<std::string,ParserNodeHandle> constants;
+  
+  for (size_t j=0; j<num_expressions; j++)
+  {
+    program->get_expression(j,thandle);
+    std::string varname = thandle->get_varname();
+    bool is_output = (output_variables.find(varname) != output_variables.end());
+    
+    ParserNodeHandle nhandle = thandle->get_expression_tree();
+    optimize_simplify_node(nhandle,constants,is_output);
+    thandle->set_expression_tree(nhandle);
+    
+    if (!is_output && nhandle->get_kind() == PARSER_CONSTANT_SCALAR_E)
+      constants[varname] = nhandle;
+    else
+      constants.erase(varname);
+  }
+  
+  // Run backwards through the program to find which expressions contribute
+  // to the output variables
+  std::set<std::string> needed;
+  ParserVariableList::iterator vit, vit_end;
+  vit = output_variables.begin();
+  vit_end = output_variables.end();
+  while (vit != vit_end) { needed.insert((*vit).first); ++vit; }
+  
+  live.assign(num_expressions,0);
+  for (size_t j=num_expressions; j>0; j--)
+  {
+    program->get_expression(j-1,thandle);
+    std::string varname = thandle->get_varname();
+    if (needed.find(varname) == needed.end()) continue;
+  
+    live[j-1] = 1;
+    needed.erase(varname);
+    ParserNodeHandle nhandle = thandle->get_expression_tree();
+    optimize_collect_variables(nhandle,needed);
+  }
+  
+  // Estimate the cost of each expression. Variables are identified by the key
+  // of the expression that computed them, so the same piece computed through
+  // different variables is only counted once.
+  std::map<std::string,std::pair<std::string,bool> > keys;
+  std::set<std::string> computed;
+  
+  vit = input_variables.begin();
+  vit_end = input_variables.end();
+  while (vit != vit_end) 
+  { 
+    bool sequential = ((*vit).second->get_flags() & SCRIPT_SEQUENTIAL_VAR_E) != 0;
+    keys[(*vit).first] = std::make_pair((*vit).first,sequential);
+    ++vit; 
+  }
+  
+  for (size_t j=0; j<num_expressions; j++)
+  {
+    program->get_expression(j,thandle);
+    if (!(live[j])) { thandle->set_cost(0); continue; }
+    
+    std::string key;
+    bool sequential;
+    ParserNodeHandle nhandle = thandle->get_expression_tree();
+    thandle->set_cost(optimize_cost_node(nhandle,keys,computed,key,sequential));
+    keys[thandle->get_varname()] = std::make_pair(key,sequential);
+  }
+}
+
+
+void
+Parser::optimize_simplify_node(ParserNodeHandle& nhandle,
+          std::map<std::string,ParserNodeHandle>& constants,
+          bool keep_root)
+{
+  int kind = nhandle->get_kind();
+  
+  if (kind == PARSER_VARIABLE_E)
+  {
+    if (keep_root) return;
+    std::map<std::string,ParserNodeHandle>::iterator it = constants.find(nhandle->get_value());
+    if (it != constants.end()) nhandle = (*it).second;
+    return;
+  }
+  
+  if (kind != PARSER_FUNCTION_E) return;
+
+  size_t num_args = nhandle->num_args();
+  std::vector<double> values(num_args);
+  bool all_constant = true;
+  
+  for (size_t j=0; j<num_args; j++)
+  {
+    ParserNodeHandle ahandle = nhandle->get_arg(j);
+    optimize_simplify_node(ahandle,constants,false);
+    nhandle->set_arg(j,ahandle);
+    if (!(optimize_scalar_value(ahandle,values[j]))) all_constant = false;
+  }
+  
+  ParserFunctionHandle function = nhandle->get_function();
+  if (keep_root || !function) return;
+  
+  // Fold scalar arithmetic on constants. Only functions that are known to be
+  // pure and that give the same result as the interpreter are folded.
+  const std::string& function_id = function->get_function_id();
+  if (all_constant)
+  {
+    double val = 0.0;
+    bool folded = true;
+    if (function_id == "add$S:S") val = values[0] + values[1];
+    else if (function_id == "sub$S:S") val = values[0] - values[1];
+    else if (function_id == "mult$S:S") val = values[0] * values[1];
+    else if (function_id == "div$S:S") val = values[0] / values[1];
+    else if (function_id == "neg$S") val = -values[0];
+    else if (function_id == "pow$S:S") val = ::pow(values[0],values[1]);
+    else if (function_id == "sqrt$S") val = ::sqrt(values[0]);
+    else if (function_id == "exp$S") val = ::exp(values[0]);
+    else if (function_id == "sin$S") val = ::sin(values[0]);
+    else if (function_id == "cos$S") val = ::cos(values[0]);
+    else folded = false;
+    
+    // Leave NaN and Inf to the interpreter
+    if (folded && std::isfinite(val))
+    {
+      nhandle.reset(new ParserNode(PARSER_CONSTANT_SCALAR_E,
+                            boost::lexical_cast<std::string>(val),"S"));
+      return;
+    }
+  }
+  
+  // Remove operations that return their argument unaltered: x*1, 1*x, x/1,
+  // x-0 and -(-x). Note that x+0 is not one of them, as it turns -0 into 0.
+  // This is only done for the element types, for matrices the operation may
+  // still alter the storage type.
+  std::string type = nhandle->get_type();
+  if (type != "S" && type != "V" && type != "T") return;
+  
+  std::string name = nhandle->get_value();
+  ParserNodeHandle replacement;
+  double val;
+  
+  if (num_args == 2)
+  {
+    ParserNodeHandle arg0 = nhandle->get_arg(0);
+    ParserNodeHandle arg1 = nhandle->get_arg(1);
+    if ((name == "mult" || name == "div") && 
+        optimize_scalar_value(arg1,val) && val == 1.0) replacement = arg0;
+    else if (name == "mult" && optimize_scalar_value(arg0,val) && val == 1.0) replacement = arg1;
+    else if (name == "sub" && optimize_scalar_value(arg1,val) && val == 0.0) replacement = arg0;
+  }
+  else if (num_args == 1 && name == "neg")
+  {
+    ParserNodeHandle arg0 = nhandle->get_arg(0);
+    if (arg0->get_kind() == PARSER_FUNCTION_E && arg0->get_value() == "neg" &&
+        arg0->num_args() == 1) replacement = arg0->get_arg(0);
+  }
+  
+  if (replacement && replacement->get_type() == type) nhandle = replacement;
+}
+
+
+bool
+Parser::optimize_scalar_value(ParserNodeHandle& nhandle, double& val)
+{
+  if (nhandle->get_kind() != PARSER_CONSTANT_SCALAR_E) return (false);
+  
+  std::string value = nhandle->get_value();
+  std::map<std::string,double>::iterator it = numerical_constants_.find(value);
+  if (it != numerical_constants_.end())
+  {
+    val = (*it).second;
+    return (true);
+  }
+  
+  try
+  {
+    val = boost::lexical_cast<double>(value);
+  }
+  catch (boost::bad_lexical_cast&)
+  {
+    return (false);
+  }
+  return (true);
+}
+
+
+void
+Parser::optimize_collect_variables(ParserNodeHandle& nhandle,
+                                   std::set<std::string>& names)
+{
+  int kind = nhandle->get_kind();
+  if (kind == PARSER_VARIABLE_E)
+  {
+    names.insert(nhandle->get_value());
+  }
+  else if (kind == PARSER_FUNCTION_E)
+  {
+    size_t num_args = nhandle->num_args();
+    for (size_t j=0; j<num_args; j++)
+    {
+      ParserNodeHandle ahandle = nhandle->get_arg(j);
+      optimize_collect_variables(ahandle,names);
+    }
+  }
+}
+
+
+int
+Parser::optimize_cost_node(ParserNodeHandle& nhandle,
+          std::map<std::string,std::pair<std::string,bool> >& keys,
+          std::set<std::string>& computed,
+          std::string& key,
+          bool& sequential)
+{
+  sequential = false;
+  
+  switch (nhandle->get_kind())
+  {
+    case PARSER_CONSTANT_SCALAR_E :
+      key = "#" + nhandle->get_value();
+      return (0);
+    case PARSER_CONSTANT_STRING_E :
+      key = "\"" + nhandle->get_value() + "\"";
+      return (0);
+    case PARSER_VARIABLE_E :
+      {
+        std::map<std::string,std::pair<std::string,bool> >::iterator it = 
+          keys.find(nhandle->get_value());
+        if (it == keys.end())
+        {
+          key = nhandle->get_value();
+        }
+        else
+        {
+          key = (*it).second.first;
+          sequential = (*it).second.second;
+        }
+      }
+      return (0);
+  }
+  
+  ParserFunctionHandle function = nhandle->get_function();
+  int flags = function ? function->get_flags() : 0;
+  if (flags & PARSER_SEQUENTIAL_FUNCTION_E) sequential = true;
+  
+  int cost = 0;
+  size_t num_args = nhandle->num_args();
+  std::vector<std::string> arg_keys(num_args);
+  for (size_t j=0; j<num_args; j++)
+  {
+    bool arg_sequential;
+    ParserNodeHandle ahandle = nhandle->get_arg(j);
+    cost += optimize_cost_node(ahandle,keys,computed,arg_keys[j],arg_sequential);
+    if (arg_sequential) sequential = true;
+  }
+  
+  // Use the same ordering for symmetric functions as the duplicate removal
+  if (num_args == 2 && (flags & PARSER_SYMMETRIC_FUNCTION_E) && 
+      arg_keys[1].compare(arg_keys[0]) < 0) std::swap(arg_keys[0],arg_keys[1]);
+  
+  key = (function ? function->get_function_id() : nhandle->get_value()) + "(";
+  for (size_t j=0; j<num_args; j++)
+  {
+    key += arg_keys[j];
+    if (j < (num_args-1)) key += ",";
+  }
+  key += ")";
+
+  // Functions that are not sequential are evaluated only once, and functions
+  // that were evaluated before are taken from the earlier result
+  if (!sequential) return (0);
+  if (!(computed.insert(key).second)) return (0);
+  return (cost+1);
+}
+
+
 
 bool
 Parser::optimize_process_node(ParserNodeHandle& nhandle,
@@ -3078,6 +3389,15 @@ Parser::optimize_process_node(ParserNodeHandle& nhandle,
 }
 
 
+int
+ParserProgram::get_cost()
+{
+  int cost = 0;
+  for (size_t j=0; j<expressions_.size(); j++)
+    cost += expressions_[j].second->get_cost();
+  return (cost);
+}
+
 void 
 ParserProgram::add_const_var(ParserScriptVariableHandle& handle)
 { 
@@ -33,6 +33,8 @@
 #include <Core/Thread/Mutex.h>
 #include <map>
 #include <list>
+#include <set>
+#include <vector>
 
 // Include files needed for Windows
 #include <Core/Parser/share.h>
@@ -242,7 +244,8 @@ class SCISHARE ParserTree {
       ref_cnt(0),
       varname_(varname),
       expression_(expression),
-      type_("U")
+      type_("U"),
+      cost_(0)
     {}
 
     // Retrieve the name of the variable that needs to be assigned
@@ -259,6 +262,13 @@ class SCISHARE ParserTree {
     // Retrieve final output type
     const std::string& get_type() { return (type_); } 
 
+    // Set/get the estimated cost of the expression, this is the number of
+    // functions that need to be evaluated for each element of the sequence.
+    // Pieces computed by an earlier expression or that are constant do not
+    // count. The estimate is set by the optimizer.
+    void set_cost(int cost) { cost_ = cost; }
+    int get_cost() const { return (cost_); }
+
     // For debugging
     void print() const;
 
@@ -271,6 +281,9 @@ class SCISHARE ParserTree {
 
     // Return type of the expression
     std::string type_;
+
+    // Estimated number of function evaluations per element
+    int cost_;
 };
 
 
@@ -312,6 +325,10 @@ class SCISHARE ParserProgram {
     // Retrieve the number of expressions in the program
     size_t num_expressions()  { return (expressions_.size()); }
 
+    // Estimated number of functions evaluated per element for the whole
+    // program, this is the sum of the costs of the expressions
+    int get_cost();
+
 
     // Add an input variable to the program
     void add_input_variable(const std::string& name, const std::string& type = "U", int flags = 0)
@@ -880,6 +897,33 @@ class SCISHARE Parser {
     // Sub functions for optimization
     void optimize_mark_used(ParserScriptFunctionHandle& fhandle);
 
+    // Simplify the expression trees before they are translated into a script
+    // and mark which expressions contribute to the output variables
+    void optimize_simplify(ParserProgramHandle& program,
+                           std::vector<char>& live);
+
+    // Fold constant sub trees, substitute variables that were assigned a
+    // constant and remove operations that do not alter their argument.
+    // If keep_root is set only the arguments of the node are simplified.
+    void optimize_simplify_node(ParserNodeHandle& nhandle,
+          std::map<std::string,ParserNodeHandle>& constants,
+          bool keep_root);
+
+    // Get the value of a scalar constant node
+    bool optimize_scalar_value(ParserNodeHandle& nhandle, double& val);
+
+    // Find the variable names an expression tree depends on
+    void optimize_collect_variables(ParserNodeHandle& nhandle,
+          std::set<std::string>& names);
+
+    // Compute the canonical key of a sub tree and count the functions that are
+    // evaluated per element and that were not computed before
+    int optimize_cost_node(ParserNodeHandle& nhandle,
+          std::map<std::string,std::pair<std::string,bool> >& keys,
+          std::set<std::string>& computed,
+          std::string& key,
+          bool& sequential);
+
     bool optimize_process_node(ParserNodeHandle& nhandle,
           std::list<ParserScriptVariableHandle>& variables,
           std::map<std::string,ParserScriptVariableHandle>& named_variables,
@@ -31,8 +31,10 @@
 
 #include <Core/Datatypes/Legacy/Field/Field.h>
 #include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
 #include <Core/Datatypes/Legacy/Field/FieldInformation.h>
 #include <Core/Parser/ArrayMathEngine.h>
+#include <Core/Parser/ArrayMathFunctionCatalog.h>
 
 using namespace SCIRun;
 using namespace SCIRun::Core::Geometry;
@@ -1577,6 +1579,168 @@ TEST_F(BasicParserTests, CreateFieldData_fracanisotropy)
 
 */
 
+TEST_F(BasicParserTests, CreateFieldData_ManyBuffers)
+{
+  // Large enough that every thread processes several buffers
+  FieldHandle field(CreateEmptyLatVol(41, 37, 23));
+
+  NewArrayMathEngine engine;
+  setupEngine(engine, field);
+  ASSERT_TRUE(engine.add_expressions("RESULT = X*Y - 2*Z + INDEX;"));
+  ASSERT_TRUE(engine.run());
+
+  FieldHandle ofield;
+  engine.get_field("RESULT",ofield);
+  ASSERT_THAT(ofield, NotNull());
+
+  VMesh* mesh = ofield->vmesh();
+  VField* ovfield = ofield->vfield();
+  ASSERT_EQ(41*37*23, ovfield->num_values());
+  for (VMesh::Node::index_type idx = 0; idx < mesh->num_nodes(); idx++)
+  {
+    Point p;
+    mesh->get_center(p, idx);
+    double val;
+    ovfield->get_value(val, idx);
+    ASSERT_NEAR(p.x()*p.y() - 2*p.z() + idx, val, 1e-9);
+  }
+}
+
+TEST_F(BasicParserTests, CreateFieldData_CommonSubexpressions)
+{
+  FieldHandle field(CreateEmptyLatVol(6, 5, 4));
+
+  NewArrayMathEngine engine;
+  setupEngine(engine, field);
+  // The same distance computed directly, through a variable and with the
+  // arguments of the symmetric add swapped; the unused B duplicates part of it
+  ASSERT_TRUE(engine.add_expressions(
+    "A = sqrt(X*X+Y*Y); B = X*X+Y*Y; C = 3-1; RESULT = A + sqrt(X*X+Y*Y) + C*sqrt(Y*Y+X*X) + (-(-Z))*1;"));
+  ASSERT_TRUE(engine.run());
+
+  FieldHandle ofield;
+  engine.get_field("RESULT",ofield);
+  ASSERT_THAT(ofield, NotNull());
+
+  VMesh* mesh = ofield->vmesh();
+  VField* ovfield = ofield->vfield();
+  for (VMesh::Node::index_type idx = 0; idx < mesh->num_nodes(); idx++)
+  {
+    Point p;
+    mesh->get_center(p, idx);
+    double val;
+    ovfield->get_value(val, idx);
+    ASSERT_NEAR(4*sqrt(p.x()*p.x()+p.y()*p.y()) + p.z(), val, 1e-12);
+  }
+}
+
+TEST_F(BasicParserTests, CreateFieldData_UnusedDuplicate)
+{
+  FieldHandle field(CreateEmptyLatVol(3,3,3));
+
+  NewArrayMathEngine engine;
+  setupEngine(engine, field);
+  ASSERT_TRUE(engine.add_expressions("A = X*Y+1; RESULT = X*Y+1;"));
+  ASSERT_TRUE(engine.run());
+
+  FieldHandle ofield;
+  engine.get_field("RESULT",ofield);
+  ASSERT_THAT(ofield, NotNull());
+  double min, max;
+  ofield->vfield()->minmax(min,max);
+  EXPECT_EQ(0, min);
+  EXPECT_EQ(2, max);
+}
+
+TEST(ParserOptimizeTests, FoldsConstantsAndCountsCost)
+{
+  Parser parser;
+  ParserProgramHandle program;
+  ASSERT_TRUE(parser.add_input_variable(program,"X","S",SCRIPT_SEQUENTIAL_VAR_E));
+  ASSERT_TRUE(parser.add_input_variable(program,"Y","S",SCRIPT_SEQUENTIAL_VAR_E));
+  ASSERT_TRUE(parser.add_output_variable(program,"RESULT","U"));
+
+  std::string error;
+  std::string expressions =
+    "C = 2*3; D = X*Y; E = sin(X); RESULT = X*(C-5) + sqrt(X*Y) + sqrt(D) + (-(-X));";
+  ASSERT_TRUE(parser.parse(program,expressions,error)) << error;
+  ASSERT_TRUE(parser.validate(program,ArrayMathFunctionCatalog::get_catalog(),error)) << error;
+  ASSERT_TRUE(parser.optimize(program,error)) << error;
+
+  ASSERT_EQ(4, program->num_expressions());
+  ParserTreeHandle tree;
+  // C is folded into the expression using it, E is never used
+  program->get_expression(0,tree);
+  EXPECT_EQ(PARSER_CONSTANT_SCALAR_E, tree->get_expression_tree()->get_kind());
+  EXPECT_EQ(0, tree->get_cost());
+  program->get_expression(1,tree);
+  EXPECT_EQ(1, tree->get_cost());
+  program->get_expression(2,tree);
+  EXPECT_EQ(0, tree->get_cost());
+  // X*1 and -(-X) vanish, X*Y is shared with D: one sqrt and three adds
+  program->get_expression(3,tree);
+  EXPECT_EQ(4, tree->get_cost());
+  EXPECT_EQ(5, program->get_cost());
+
+  EXPECT_EQ(5, program->num_sequential_functions());
+  EXPECT_EQ(0, program->num_const_functions());
+}
+
+TEST_F(BasicParserTests, CreateFieldData_FusedMatchesInterpreter)
+{
+  const std::string expression =
+    "V = POS*X - POS/(Y+2);"
+    "RESULT = sqrt(abs(X*Y - 2*Z)) + sin(X)*cos(Y) + log(Z+2) - x(V)*y(V) + z(-V)/3 + INDEX;";
+
+  FieldHandle fused(CreateEmptyLatVol(41, 37, 23));
+  FieldHandle interpreted(CreateEmptyLatVol(41, 37, 23));
+  FieldHandle ofused, ointerpreted;
+  {
+    NewArrayMathEngine engine;
+    setupEngine(engine, fused);
+    ASSERT_TRUE(engine.add_expressions(expression));
+    ASSERT_TRUE(engine.run());
+    engine.get_field("RESULT",ofused);
+  }
+  {
+    NewArrayMathEngine engine;
+    engine.set_fused_execution(false);
+    setupEngine(engine, interpreted);
+    ASSERT_TRUE(engine.add_expressions(expression));
+    ASSERT_TRUE(engine.run());
+    engine.get_field("RESULT",ointerpreted);
+  }
+  ASSERT_THAT(ofused, NotNull());
+  ASSERT_THAT(ointerpreted, NotNull());
+
+  VField* fvfield = ofused->vfield();
+  VField* ivfield = ointerpreted->vfield();
+  ASSERT_EQ(ivfield->num_values(), fvfield->num_values());
+  for (VMesh::Node::index_type idx = 0; idx < ofused->vmesh()->num_nodes(); idx++)
+  {
+    double fval, ival;
+    fvfield->get_value(fval, idx);
+    ivfield->get_value(ival, idx);
+    ASSERT_EQ(ival, fval);
+  }
+}
+
+TEST(ArrayMathFusedCodeTests, OnlyElementwiseFunctionsHaveLaneKernels)
+{
+  int kernel, component;
+  EXPECT_TRUE(ArrayMathFusedCode::find_kernel("add$V:S",kernel,component));
+  EXPECT_EQ(ArrayMathFusedCode::ADD_E, kernel);
+  EXPECT_TRUE(ArrayMathFusedCode::find_kernel("mult$V:V",kernel,component));
+  EXPECT_TRUE(ArrayMathFusedCode::find_kernel("z$V",kernel,component));
+  EXPECT_EQ(ArrayMathFusedCode::COMPONENT_E, kernel);
+  EXPECT_EQ(2, component);
+
+  EXPECT_FALSE(ArrayMathFusedCode::find_kernel("mult$T:T",kernel,component));
+  EXPECT_FALSE(ArrayMathFusedCode::find_kernel("cross$V:V",kernel,component));
+  EXPECT_FALSE(ArrayMathFusedCode::find_kernel("to_fielddata$S",kernel,component));
+  EXPECT_FALSE(ArrayMathFusedCode::find_kernel("select$S:S:S",kernel,component));
+}
+
 TEST(FieldHashTests, TestShiftingZero)
 {
   // copied from TetVolMesh.h, failing compilation on GCC 6.2.
@@ -447,10 +447,29 @@ auto_istream(const std::string& filename, LoggerHandle pr)
     int machine_endian = Piostream::Little;
 
     if (file_endian == machine_endian) 
+    {
+      // Read through a file mapping where possible, this falls back to
+      // stdio if the file cannot be mapped
+      if (version > 1)
+      {
+        PiostreamPtr stream(new MappedPiostream(filename, version, pr));
+        if (!stream->error()) return stream;
+      }
       return PiostreamPtr(new BinaryPiostream(filename, Piostream::Read, version, pr));
+    }
     else 
       return PiostreamPtr(new BinarySwapPiostream(filename, Piostream::Read, version,pr));
   }
+  else if (m1 == 'C' && m2 == 'H' && m3 == 'K')
+  {
+    // Compressed files are always written in the byte order of the machine
+    // that wrote them
+    if (file_endian == Piostream::Little)
+      return PiostreamPtr(new ChunkedPiostream(filename, Piostream::Read, version, pr));
+    if (pr) pr->error(filename + " was written on a machine with a different byte order.");
+    else std::cerr << filename << " was written on a machine with a different byte order." << std::endl;
+    return PiostreamPtr();
+  }
   else if (m1 == 'A' && m2 == 'S' && m3 == 'C')
   {
     return PiostreamPtr(new TextPiostream(filename, Piostream::Read, pr));
@@ -470,6 +489,7 @@ auto_ostream(const std::string& filename, const std::string& type, LoggerHandle
   //     Binary:  Return a BinaryPiostream 
   //     Fast:    Return FastPiostream
   //     Text:    Return a TextPiostream
+  //     Compressed: Return a ChunkedPiostream
   //     Default: Return BinaryPiostream 
   // NOTE: Binary will never return BinarySwap so we always write
   //       out the endianness of the machine we are on
@@ -486,6 +506,10 @@ auto_ostream(const std::string& filename, const std::string& type, LoggerHandle
   {
     stream = new FastPiostream(filename, Piostream::Write, pr);
   }
+  else if (type == "Compressed")
+  {
+    stream = new ChunkedPiostream(filename, Piostream::Write, -1, pr);
+  }
   else
   {
     stream = new BinaryPiostream(filename, Piostream::Write, -1, pr);
@@ -556,6 +580,8 @@ Piostream::readHeader( LoggerHandle pr,
   bool is_binary = false;
   if (hdr[4] == 'B' && hdr[5] == 'I' && hdr[6] == 'N' && hdr[7] == '\n')
     is_binary = true;
+  if (hdr[4] == 'C' && hdr[5] == 'H' && hdr[6] == 'K' && hdr[7] == '\n')
+    is_binary = true;
   if(version > 1 && is_binary) 
   {
     // can only be BIG or LIT
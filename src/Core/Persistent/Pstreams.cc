@@ -43,7 +43,9 @@
 ///
 
 #include <Core/Persistent/Pstreams.h>
+#include <Core/Logging/ConsoleLogger.h>
 #include <Core/Logging/LoggerInterface.h>
+#include <Core/Thread/Parallel.h>
 #include <Core/Utils/Legacy/StringUtil.h>
 
 #ifdef SCIRUN4_CODE_TO_BE_ENABLED_LATER
@@ -54,14 +56,20 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <zlib.h>
 
 #ifdef _WIN32
 #  include <io.h>
+#else
+#  include <sys/mman.h>
 #endif
 
 using namespace SCIRun::Core::Logging;
@@ -71,6 +79,13 @@ namespace SCIRun {
 // BinaryPiostream -- portable
   BinaryPiostream::BinaryPiostream(const std::string& filename, Direction dir,
     const int& v, LoggerHandle pr)
+    : BinaryPiostream(filename, dir, v, pr, "BIN")
+  {
+  }
+
+
+  BinaryPiostream::BinaryPiostream(const std::string& filename, Direction dir,
+    const int& v, LoggerHandle pr, const char* filetype)
     : Piostream(dir, v, filename, pr),
     fp_(0)
   {
@@ -127,7 +142,7 @@ namespace SCIRun {
       {
         // write out 16 bytes, but we need 17 for \0
         char hdr[17];
-        sprintf(hdr, "SCI\nBIN\n%03d\n%s", version_, endianness());
+        sprintf(hdr, "SCI\n%.3s\n%03d\n%s", filetype, version_, endianness());
 
         if (!fwrite(hdr, 1, 16, fp_))
         {
@@ -140,7 +155,7 @@ namespace SCIRun {
       {
         // write out 12 bytes, but we need 13 for \0
         char hdr[13];
-        sprintf(hdr, "SCI\nBIN\n%03d\n", version_);
+        sprintf(hdr, "SCI\n%.3s\n%03d\n", filetype, version_);
         if (!fwrite(hdr, 1, 13, fp_))
         {
           reporter_->error("Header write failed.");
@@ -2061,4 +2076,819 @@ FastPiostream::block_io(void *data, size_t s, size_t nmemb)
 }
 
 
+// MappedPiostream -- binary input through a memory mapped file
+MappedPiostream::MappedPiostream(const std::string& filename, const int& v,
+                                 LoggerHandle pr, bool prefetch)
+  : Piostream(Read, v, filename, pr),
+    data_(0),
+    size_(0),
+    pos_(0),
+    released_(0)
+{
+  if (v == -1) // no version given so use PERSISTENT_VERSION
+    version_ = PERSISTENT_VERSION;
+  else
+    version_ = v;
+
+  if (version() == 1)
+  {
+    reporter_->error("Version 1 files cannot be read through a file mapping.");
+    err = true;
+    return;
+  }
+
+  try
+  {
+    using namespace boost::interprocess;
+    file_mapping file(filename.c_str(), read_only);
+    region_.reset(new mapped_region(file, read_only));
+    region_->advise(prefetch ? mapped_region::advice_willneed :
+                               mapped_region::advice_sequential);
+  }
+  catch (boost::interprocess::interprocess_exception& e)
+  {
+    reporter_->warning("Could not map file: " + filename + " for reading: " + e.what());
+    err = true;
+    return;
+  }
+
+  data_ = static_cast<const char*>(region_->get_address());
+  size_ = region_->get_size();
+
+  // Versions > 1 have a header of size 16
+  if (size_ < 16)
+  {
+    reporter_->error("Header read failed.");
+    err = true;
+    return;
+  }
+  pos_ = 16;
+}
+
+
+MappedPiostream::~MappedPiostream()
+{
+}
+
+
+void
+MappedPiostream::reset_post_header()
+{
+  // Released pages are read from the file again when they are accessed
+  pos_ = 16;
+}
+
+
+bool
+MappedPiostream::read(void* data, size_t bytes, const char* iotype)
+{
+  if (err) return (false);
+  if (bytes > size_ - pos_)
+  {
+    err = true;
+    reporter_->error(std::string("MappedPiostream error reading ") + iotype + ".");
+    return (false);
+  }
+  memcpy(data, data_ + pos_, bytes);
+  pos_ += bytes;
+  return (true);
+}
+
+
+void
+MappedPiostream::release_consumed_pages()
+{
+  // Only hand back whole pages, and only once enough accumulated to be
+  // worth the system call
+  const size_t page_size = boost::interprocess::mapped_region::get_page_size();
+  const size_t end = (pos_ / page_size) * page_size;
+  if (end < released_ + 64*page_size) return;
+#ifndef _WIN32
+  madvise(const_cast<char*>(data_) + released_, end - released_, MADV_DONTNEED);
+#endif
+  released_ = end;
+}
+
+
+template <class T>
+inline void
+MappedPiostream::gen_io(T& data, const char *iotype)
+{
+  read(&data, sizeof(data), iotype);
+}
+
+
+void
+MappedPiostream::io(char& data)
+{
+  gen_io(data, "char");
+}
+
+
+void
+MappedPiostream::io(signed char& data)
+{
+  gen_io(data, "signed char");
+}
+
+
+void
+MappedPiostream::io(unsigned char& data)
+{
+  gen_io(data, "unsigned char");
+}
+
+
+void
+MappedPiostream::io(short& data)
+{
+  gen_io(data, "short");
+}
+
+
+void
+MappedPiostream::io(unsigned short& data)
+{
+  gen_io(data, "unsigned short");
+}
+
+
+void
+MappedPiostream::io(int& data)
+{
+  gen_io(data, "int");
+}
+
+
+void
+MappedPiostream::io(unsigned int& data)
+{
+  gen_io(data, "unsigned int");
+}
+
+
+void
+MappedPiostream::io(long& data)
+{
+  // Stored as 32 bits, see BinaryPiostream
+  int tmp = 0;
+  gen_io(tmp, "long");
+  data = tmp;
+}
+
+
+void
+MappedPiostream::io(unsigned long& data)
+{
+  // Stored as 32 bits, see BinaryPiostream
+  unsigned int tmp = 0;
+  gen_io(tmp, "unsigned long");
+  data = tmp;
+}
+
+
+void
+MappedPiostream::io(long long& data)
+{
+  gen_io(data, "long long");
+}
+
+
+void
+MappedPiostream::io(unsigned long long& data)
+{
+  gen_io(data, "unsigned long long");
+}
+
+
+void
+MappedPiostream::io(double& data)
+{
+  gen_io(data, "double");
+}
+
+
+void
+MappedPiostream::io(float& data)
+{
+  gen_io(data, "float");
+}
+
+
+void
+MappedPiostream::io(std::string& data)
+{
+  // The string is stored with its terminating zero
+  unsigned int chars = 0;
+  io(chars);
+  if (err) return;
+  if (chars > size_ - pos_)
+  {
+    err = true;
+    reporter_->error("MappedPiostream error reading string.");
+    return;
+  }
+  const char* p = data_ + pos_;
+  data = std::string(p, std::find(p, p + chars, '\0'));
+  pos_ += chars;
+}
+
+
+bool
+MappedPiostream::block_io(void *data, size_t s, size_t nmemb)
+{
+  if (err) return (false);
+  if (nmemb && s > (size_ - pos_) / nmemb)
+  {
+    err = true;
+    reporter_->error("MappedPiostream error reading block io.");
+    return (true);
+  }
+  memcpy(data, data_ + pos_, s*nmemb);
+  pos_ += s*nmemb;
+  release_consumed_pages();
+  return (true);
+}
+
+
+////
+// ChunkedPiostream -- binary stream with arrays stored as zlib compressed
+// chunks
+
+namespace
+{
+  const char chunked_index_magic[8] = { 'C','H','K','I','N','D','E','X' };
+
+  unsigned long long file_tell(FILE* fp)
+  {
+#ifdef _WIN32
+    return (static_cast<unsigned long long>(_ftelli64(fp)));
+#else
+    return (static_cast<unsigned long long>(ftello(fp)));
+#endif
+  }
+
+  bool file_seek(FILE* fp, long long offset, int whence)
+  {
+#ifdef _WIN32
+    return (_fseeki64(fp, offset, whence) == 0);
+#else
+    return (fseeko(fp, static_cast<off_t>(offset), whence) == 0);
+#endif
+  }
+
+  bool read_values(FILE* fp, unsigned long long* values, size_t n)
+  {
+    return (n == 0 || fread(values, sizeof(unsigned long long), n, fp) == n);
+  }
+
+  bool write_values(FILE* fp, const unsigned long long* values, size_t n)
+  {
+    return (n == 0 || fwrite(values, sizeof(unsigned long long), n, fp) == n);
+  }
+
+  /// Chunks handled per pass, enough to keep every core busy while bounding
+  /// the memory held in compressed buffers
+  size_t chunk_batch()
+  {
+    return (4 * std::max(1u, SCIRun::Core::Thread::Parallel::NumCores()));
+  }
+}
+
+
+size_t
+ChunkedPiostream::Block::chunk_bytes(size_t first, size_t count) const
+{
+  const unsigned long long begin = first * chunk_size;
+  if (begin >= bytes) return (0);
+  return (static_cast<size_t>(std::min(bytes, (first + count) * chunk_size) - begin));
+}
+
+
+ChunkedPiostream::ChunkedPiostream(const std::string& filename, Direction dir,
+                                   const int& v, LoggerHandle pr,
+                                   size_t chunk_size, int level)
+  : BinaryPiostream(filename, dir, v, pr, "CHK"),
+    chunk_size_(std::max<size_t>(chunk_size, 1)),
+    level_(level)
+{
+  if (!err && version() == 1)
+  {
+    reporter_->error("ChunkedPiostream cannot handle version 1 files.");
+    err = true;
+  }
+}
+
+
+ChunkedPiostream::~ChunkedPiostream()
+{
+  if (fp_ && !err && !reading()) write_index();
+}
+
+
+void
+ChunkedPiostream::write_index()
+{
+  // Table offsets, followed by where they start and a tag so that readers
+  // can find them from the end of the file
+  const unsigned long long start = file_tell(fp_);
+  const unsigned long long count = tables_.size();
+  if (!write_values(fp_, &count, 1) ||
+      !write_values(fp_, tables_.empty() ? 0 : &tables_[0], tables_.size()) ||
+      !write_values(fp_, &start, 1) ||
+      fwrite(chunked_index_magic, 1, 8, fp_) != 8)
+  {
+    err = true;
+    reporter_->error("ChunkedPiostream error writing index.");
+  }
+}
+
+
+bool
+ChunkedPiostream::block_io(void *data, size_t s, size_t nmemb)
+{
+  if (err) return (false);
+  const size_t bytes = s * nmemb;
+  if (bytes < min_chunked_bytes) return (BinaryPiostream::block_io(data, s, nmemb));
+
+  const bool ok = (reading() ? read_block(static_cast<char*>(data), bytes) :
+                               write_block(static_cast<const char*>(data), bytes));
+  if (!ok) err = true;
+  return (true);
+}
+
+
+bool
+ChunkedPiostream::write_block(const char* data, size_t bytes)
+{
+  const size_t n = (bytes + chunk_size_ - 1) / chunk_size_;
+  const unsigned long long table = file_tell(fp_);
+  const unsigned long long head[3] = { bytes, chunk_size_, n };
+  std::vector<unsigned long long> packed(n, 0);
+
+  // The compressed sizes are filled in once all chunks are written
+  if (!write_values(fp_, head, 3) || !write_values(fp_, &packed[0], n))
+  {
+    reporter_->error("ChunkedPiostream error writing block io.");
+    return (false);
+  }
+
+  const size_t batch = chunk_batch();
+  std::vector<std::vector<Bytef> > buffers(std::min(batch, n));
+  std::vector<int> status(buffers.size());
+
+  for (size_t b = 0; b < n; b += batch)
+  {
+    const size_t m = std::min(batch, n - b);
+    Core::Thread::Parallel::For(0, m, 1, [&](size_t begin, size_t end)
+    {
+      for (size_t j = begin; j < end; j++)
+      {
+        const size_t offset = (b + j) * chunk_size_;
+        const uLong len = static_cast<uLong>(std::min(chunk_size_, bytes - offset));
+        uLongf packed_len = compressBound(len);
+        buffers[j].resize(packed_len);
+        status[j] = compress2(&buffers[j][0], &packed_len,
+                              reinterpret_cast<const Bytef*>(data + offset), len, level_);
+        buffers[j].resize(packed_len);
+      }
+    });
+
+    for (size_t j = 0; j < m; j++)
+    {
+      if (status[j] != Z_OK)
+      {
+        reporter_->error("ChunkedPiostream error compressing block io.");
+        return (false);
+      }
+      if (fwrite(&buffers[j][0], 1, buffers[j].size(), fp_) != buffers[j].size())
+      {
+        reporter_->error("ChunkedPiostream error writing block io.");
+        return (false);
+      }
+      packed[b + j] = buffers[j].size();
+    }
+  }
+
+  const unsigned long long end = file_tell(fp_);
+  if (!file_seek(fp_, static_cast<long long>(table + sizeof(head)), SEEK_SET) ||
+      !write_values(fp_, &packed[0], n) ||
+      !file_seek(fp_, static_cast<long long>(end), SEEK_SET))
+  {
+    reporter_->error("ChunkedPiostream error writing block io.");
+    return (false);
+  }
+  tables_.push_back(table);
+  return (true);
+}
+
+
+bool
+ChunkedPiostream::read_table(Block& block)
+{
+  unsigned long long head[3];
+  if (!read_values(fp_, head, 3)) return (false);
+  block.bytes = head[0];
+  block.chunk_size = head[1];
+  if (block.chunk_size == 0 || head[2] != (block.bytes + block.chunk_size - 1) / block.chunk_size)
+    return (false);
+  block.packed.resize(head[2]);
+  if (!read_values(fp_, block.packed.empty() ? 0 : &block.packed[0], block.packed.size()))
+    return (false);
+  block.offset = file_tell(fp_);
+  return (true);
+}
+
+
+bool
+ChunkedPiostream::read_block(char* data, size_t bytes)
+{
+  Block block;
+  if (!read_table(block) || block.bytes != bytes)
+  {
+    reporter_->error("ChunkedPiostream error reading block io.");
+    return (false);
+  }
+  return (decompress(fp_, block, 0, block.num_chunks(), data, reporter_));
+}
+
+
+bool
+ChunkedPiostream::decompress(FILE* fp, const Block& block, size_t first, size_t count,
+                             char* data, LoggerHandle pr)
+{
+  if (first + count > block.num_chunks())
+  {
+    pr->error("ChunkedPiostream chunk range out of bounds.");
+    return (false);
+  }
+
+  unsigned long long offset = block.offset;
+  for (size_t c = 0; c < first; c++) offset += block.packed[c];
+  if (!file_seek(fp, static_cast<long long>(offset), SEEK_SET))
+  {
+    pr->error("ChunkedPiostream error reading block io.");
+    return (false);
+  }
+
+  const size_t batch = chunk_batch();
+  std::vector<Bytef> buffer;
+  std::vector<size_t> start(std::min(batch, count) + 1);
+  std::vector<int> status(start.size());
+
+  for (size_t b = first; b < first + count; b += batch)
+  {
+    const size_t m = std::min(batch, first + count - b);
+    start[0] = 0;
+    for (size_t j = 0; j < m; j++)
+    {
+      // A chunk can never be larger than what zlib produces for it, so a
+      // damaged table does not make us allocate arbitrary amounts of memory
+      const unsigned long long len = block.packed[b + j];
+      if (len > compressBound(static_cast<uLong>(block.chunk_bytes(b + j, 1))))
+      {
+        pr->error("ChunkedPiostream found a damaged chunk table.");
+        return (false);
+      }
+      start[j + 1] = start[j] + static_cast<size_t>(len);
+    }
+
+    buffer.resize(std::max<size_t>(start[m], 1));
+    if (fread(&buffer[0], 1, start[m], fp) != start[m])
+    {
+      pr->error("ChunkedPiostream error reading block io.");
+      return (false);
+    }
+
+    Core::Thread::Parallel::For(0, m, 1, [&](size_t begin, size_t end)
+    {
+      for (size_t j = begin; j < end; j++)
+      {
+        const size_t expected = block.chunk_bytes(b + j, 1);
+        uLongf len = static_cast<uLongf>(expected);
+        status[j] = uncompress(reinterpret_cast<Bytef*>(data + (b + j - first) * block.chunk_size),
+                               &len, &buffer[start[j]], static_cast<uLong>(start[j + 1] - start[j]));
+        if (status[j] == Z_OK && len != expected) status[j] = Z_DATA_ERROR;
+      }
+    });
+
+    for (size_t j = 0; j < m; j++)
+    {
+      if (status[j] != Z_OK)
+      {
+        pr->error("ChunkedPiostream error decompressing block io.");
+        return (false);
+      }
+    }
+  }
+  return (true);
+}
+
+
+bool
+ChunkedPiostream::read_index(const std::string& filename, std::vector<Block>& blocks,
+                             LoggerHandle pr)
+{
+  if (!pr) pr.reset(new ConsoleLogger());
+  blocks.clear();
+
+  ChunkedPiostream stream(filename, Read, -1, pr);
+  if (stream.error()) return (false);
+
+  FILE* fp = stream.fp_;
+  char hdr[16];
+  unsigned long long start, count;
+  char magic[8];
+  if (!file_seek(fp, 0, SEEK_SET) || fread(hdr, 1, 16, fp) != 16 ||
+      hdr[4] != 'C' || hdr[5] != 'H' || hdr[6] != 'K' ||
+      !file_seek(fp, -16, SEEK_END) || !read_values(fp, &start, 1) ||
+      fread(magic, 1, 8, fp) != 8 || memcmp(magic, chunked_index_magic, 8) != 0 ||
+      !file_seek(fp, static_cast<long long>(start), SEEK_SET) || !read_values(fp, &count, 1) ||
+      count > (file_tell(fp) + 16) / sizeof(unsigned long long))
+  {
+    pr->error("File " + filename + " has no chunk index.");
+    return (false);
+  }
+
+  std::vector<unsigned long long> tables(static_cast<size_t>(count));
+  if (!read_values(fp, tables.empty() ? 0 : &tables[0], tables.size()))
+  {
+    pr->error("ChunkedPiostream error reading index of " + filename + ".");
+    return (false);
+  }
+
+  blocks.resize(tables.size());
+  for (size_t k = 0; k < tables.size(); k++)
+  {
+    if (!file_seek(fp, static_cast<long long>(tables[k]), SEEK_SET) ||
+        !stream.read_table(blocks[k]))
+    {
+      pr->error("ChunkedPiostream error reading index of " + filename + ".");
+      blocks.clear();
+      return (false);
+    }
+  }
+  return (true);
+}
+
+
+bool
+ChunkedPiostream::read_chunks(const std::string& filename, const Block& block,
+                              size_t first, size_t count, void* data, LoggerHandle pr)
+{
+  if (!pr) pr.reset(new ConsoleLogger());
+  ChunkedPiostream stream(filename, Read, -1, pr);
+  if (stream.error()) return (false);
+  return (decompress(stream.fp_, block, first, count, static_cast<char*>(data), pr));
+}
+
+
+
+// HashPiostream -- 128 bit content hash, mixing as in MurmurHash3
+
+namespace
+{
+  const unsigned long long hash_c1 = 0x87c37b91114253d5ULL;
+  const unsigned long long hash_c2 = 0x4cf5ad432745937fULL;
+
+  inline unsigned long long rotl64(unsigned long long x, int r)
+  {
+    return ((x << r) | (x >> (64 - r)));
+  }
+
+  inline unsigned long long fmix64(unsigned long long k)
+  {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return (k);
+  }
+}
+
+
+HashPiostream::HashPiostream(LoggerHandle pr)
+  : Piostream(Write, PERSISTENT_VERSION, "", pr),
+    h1_(0x9e3779b97f4a7c15ULL),
+    h2_(0x6a09e667f3bcc908ULL),
+    bytes_(0),
+    classes_(0),
+    tail_size_(0)
+{
+}
+
+
+HashPiostream::~HashPiostream()
+{
+}
+
+
+void
+HashPiostream::reset_post_header()
+{
+}
+
+
+int
+HashPiostream::begin_class(const std::string& name, int current_version)
+{
+  ++classes_;
+  return (Piostream::begin_class(name, current_version));
+}
+
+
+inline void
+HashPiostream::mix(unsigned long long word)
+{
+  h1_ ^= rotl64(word * hash_c1, 31) * hash_c2;
+  h1_ = rotl64(h1_, 27) + h2_;
+  h1_ = h1_ * 5 + 0x52dce729;
+
+  h2_ ^= rotl64(word * hash_c2, 33) * hash_c1;
+  h2_ = rotl64(h2_, 31) + h1_;
+  h2_ = h2_ * 5 + 0x38495ab5;
+}
+
+
+void
+HashPiostream::update(const char* data, size_t bytes)
+{
+  bytes_ += bytes;
+
+  if (tail_size_ > 0)
+  {
+    const size_t fill = std::min(bytes, sizeof(tail_) - tail_size_);
+    memcpy(tail_ + tail_size_, data, fill);
+    tail_size_ += fill;
+    data += fill;
+    bytes -= fill;
+    if (tail_size_ < sizeof(tail_)) return;
+
+    unsigned long long word;
+    memcpy(&word, tail_, sizeof(word));
+    mix(word);
+    tail_size_ = 0;
+  }
+
+  const char* end = data + (bytes & ~size_t(7));
+  for (; data != end; data += 8)
+  {
+    unsigned long long word;
+    memcpy(&word, data, sizeof(word));
+    mix(word);
+  }
+
+  tail_size_ = bytes & 7;
+  memcpy(tail_, data, tail_size_);
+}
+
+
+template <class T>
+void
+HashPiostream::gen_io(T& data)
+{
+  update(reinterpret_cast<const char*>(&data), sizeof(data));
+}
+
+
+void
+HashPiostream::io(char& data)
+{
+  gen_io(data);
+}
+
+
+void
+HashPiostream::io(signed char& data)
+{
+  gen_io(data);
+}
+
+
+void
+HashPiostream::io(unsigned char& data)
+{
+  gen_io(data);
+}
+
+
+void
+HashPiostream::io(short& data)
+{
+  gen_io(data);
+}
+
+
+void
+HashPiostream::io(unsigned short& data)
+{
+  gen_io(data);
+}
+
+
+void
+HashPiostream::io(int& data)
+{
+  gen_io(data);
+}
+
+
+void
+HashPiostream::io(unsigned int& data)
+{
+  gen_io(data);
+}
+
+
+void
+HashPiostream::io(long& data)
+{
+  // long differs in size between platforms
+  long long tmp = data;
+  gen_io(tmp);
+}
+
+
+void
+HashPiostream::io(unsigned long& data)
+{
+  unsigned long long tmp = data;
+  gen_io(tmp);
+}
+
+
+void
+HashPiostream::io(long long& data)
+{
+  gen_io(data);
+}
+
+
+void
+HashPiostream::io(unsigned long long& data)
+{
+  gen_io(data);
+}
+
+
+void
+HashPiostream::io(double& data)
+{
+  gen_io(data);
+}
+
+
+void
+HashPiostream::io(float& data)
+{
+  gen_io(data);
+}
+
+
+void
+HashPiostream::io(std::string& data)
+{
+  // The length keeps consecutive strings apart
+  unsigned long long chars = data.size();
+  gen_io(chars);
+  update(data.data(), data.size());
+}
+
+
+bool
+HashPiostream::block_io(void* data, size_t s, size_t nmemb)
+{
+  update(static_cast<const char*>(data), s * nmemb);
+  return (true);
+}
+
+
+std::string
+HashPiostream::digest() const
+{
+  unsigned long long h1 = h1_, h2 = h2_;
+  if (tail_size_ > 0)
+  {
+    unsigned long long word = 0;
+    memcpy(&word, tail_, tail_size_);
+    h1 ^= rotl64(word * hash_c1, 31) * hash_c2;
+    h2 ^= rotl64(word * hash_c2, 33) * hash_c1;
+  }
+
+  h1 ^= bytes_;
+  h2 ^= bytes_;
+  h1 += h2;
+  h2 += h1;
+  h1 = fmix64(h1);
+  h2 = fmix64(h2);
+  h1 += h2;
+  h2 += h1;
+
+  char hex[33];
+  snprintf(hex, sizeof(hex), "%016llx%016llx", h1, h2);
+  return (hex);
+}
+
+
 } // End namespace SCIRun
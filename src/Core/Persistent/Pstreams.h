@@ -43,11 +43,19 @@
 #define SCI_project_Pstream_h 1
 
 #include <Core/Persistent/Persistent.h>
+#include <boost/shared_ptr.hpp>
 #include <cstdio>
 #include <iosfwd>
+#include <vector>
 
 #include <Core/Persistent/share.h>
 
+namespace boost {
+  namespace interprocess {
+    class mapped_region;
+  }
+}
+
 namespace SCIRun {
 
 class SCISHARE BinaryPiostream : public Piostream {
@@ -56,6 +64,11 @@ protected:
 
   virtual const char *endianness();
   virtual void reset_post_header();
+
+  /// Open a file whose header carries filetype (three characters) in place
+  /// of BIN, for streams that extend the binary format
+  BinaryPiostream(const std::string& filename, Direction dir, const int& v,
+                  Core::Logging::LoggerHandle pr, const char* filetype);
 private:
   template <class T> void gen_io(T&, const char *);
 
@@ -197,6 +210,192 @@ public:
 };
 
 
+/// Reads binary files that were written in the byte order of this machine
+/// through a memory mapping of the file instead of stdio. Values are copied
+/// straight out of the mapped pages, so the many small reads of the headers
+/// and of arrays that are stored element by element no longer cost a library
+/// call each, and block_io copies a whole array at once.
+///
+/// Nothing is read when the stream is opened: pages are faulted in when they
+/// are first used, with read ahead for sequential access. Setting prefetch
+/// asks the system to start reading the whole file right away instead.
+/// Pages that block_io has copied out are released again, so the mapping
+/// does not add the size of the file to the memory in use while loading.
+///
+/// The arrays of fields and meshes do not alias the mapping: they are
+/// std::vector, Array2 and Array3 (inside CopyOnWrite holders), which own
+/// their memory, so block_io copies every array once into its container.
+/// Reading a field therefore still touches the whole file before it returns.
+///
+/// Only file versions > 1 can be read, version 1 files were written in XDR
+/// format.
+class SCISHARE MappedPiostream : public Piostream {
+private:
+  boost::shared_ptr<boost::interprocess::mapped_region> region_;
+  const char* data_;
+  size_t size_;
+  size_t pos_;
+  /// Pages before this offset have been released
+  size_t released_;
+
+  template <class T> void gen_io(T&, const char *);
+  bool read(void* data, size_t bytes, const char* iotype);
+  void release_consumed_pages();
+protected:
+  virtual void reset_post_header();
+public:
+  MappedPiostream(const std::string& filename, const int& v = -1,
+                  Core::Logging::LoggerHandle pr = Core::Logging::LoggerHandle(),
+                  bool prefetch = false);
+  virtual ~MappedPiostream();
+
+  virtual void io(char&);
+  virtual void io(signed char&);
+  virtual void io(unsigned char&);
+  virtual void io(short&);
+  virtual void io(unsigned short&);
+  virtual void io(int&);
+  virtual void io(unsigned int&);
+  virtual void io(long&);
+  virtual void io(unsigned long&);
+  virtual void io(long long&);
+  virtual void io(unsigned long long&);
+  virtual void io(double&);
+  virtual void io(float&);
+  virtual void io(std::string& str);
+  virtual bool eof() { return (pos_ >= size_); }
+
+  virtual bool supports_block_io() { return true; }
+  virtual bool block_io(void*, size_t, size_t);
+};
+
+
+/// Binary stream that compresses large arrays. Everything is written as in
+/// a BinaryPiostream, except that arrays handed to block_io that are at
+/// least min_chunked_bytes long are cut into chunks of chunk_size bytes that
+/// are compressed independently with zlib. Chunks are compressed and
+/// decompressed in parallel, and since every chunk can be inflated on its
+/// own, parts of an array can be read without touching the rest.
+///
+/// Every compressed array starts with a table: the array size in bytes, the
+/// chunk size, the number of chunks and the compressed size of each chunk,
+/// followed by the chunks themselves. Sequential reading only needs these
+/// tables. When the stream is closed an index with the location of every
+/// table is appended, which read_index uses to find the arrays in a file
+/// without parsing the objects stored in it.
+///
+/// Files have CHK in place of BIN in their header, and are always written in
+/// the byte order of this machine.
+class SCISHARE ChunkedPiostream : public BinaryPiostream {
+public:
+  /// Location of one compressed array in a file
+  struct Block
+  {
+    /// Offset of the first chunk
+    unsigned long long offset;
+    /// Uncompressed size of the array
+    unsigned long long bytes;
+    unsigned long long chunk_size;
+    /// Compressed size of each chunk
+    std::vector<unsigned long long> packed;
+
+    size_t num_chunks() const { return (packed.size()); }
+    /// Uncompressed size of chunks [first, first+count)
+    size_t chunk_bytes(size_t first, size_t count) const;
+  };
+
+  static const size_t default_chunk_size = 1 << 20;
+  static const size_t min_chunked_bytes = 1 << 12;
+
+  ChunkedPiostream(const std::string& filename, Direction dir,
+                   const int& v = -1, Core::Logging::LoggerHandle pr = Core::Logging::LoggerHandle(),
+                   size_t chunk_size = default_chunk_size, int level = 1);
+  virtual ~ChunkedPiostream();
+
+  virtual bool supports_block_io() { return (true); }
+  virtual bool block_io(void*, size_t, size_t);
+
+  /// List the compressed arrays in a file, in the order they were written.
+  static bool read_index(const std::string& filename, std::vector<Block>& blocks,
+                         Core::Logging::LoggerHandle pr = Core::Logging::LoggerHandle());
+  /// Decompress chunks [first, first+count) of an array into data, which
+  /// needs to hold block.chunk_bytes(first, count) bytes.
+  static bool read_chunks(const std::string& filename, const Block& block,
+                          size_t first, size_t count, void* data,
+                          Core::Logging::LoggerHandle pr = Core::Logging::LoggerHandle());
+
+private:
+  bool write_block(const char* data, size_t bytes);
+  bool read_block(char* data, size_t bytes);
+  bool read_table(Block& block);
+  void write_index();
+
+  static bool decompress(FILE* fp, const Block& block, size_t first, size_t count,
+                         char* data, Core::Logging::LoggerHandle pr);
+
+  size_t chunk_size_;
+  int level_;
+  /// Offsets of the tables written so far
+  std::vector<unsigned long long> tables_;
+};
+
+
+/// Write only stream that stores nothing. Everything written to it is folded
+/// into a 128 bit hash, so objects can be compared by content by writing
+/// them through their usual io functions. Arrays handed to block_io are
+/// hashed a word at a time.
+///
+/// Values are hashed in the byte order of this machine. The hash is meant
+/// for detecting identical data, not for security: it is not cryptographic.
+class SCISHARE HashPiostream : public Piostream {
+public:
+  explicit HashPiostream(Core::Logging::LoggerHandle pr = Core::Logging::LoggerHandle());
+  virtual ~HashPiostream();
+
+  virtual int begin_class(const std::string& name, int current_version);
+
+  using Piostream::io;
+  virtual void io(char&);
+  virtual void io(signed char&);
+  virtual void io(unsigned char&);
+  virtual void io(short&);
+  virtual void io(unsigned short&);
+  virtual void io(int&);
+  virtual void io(unsigned int&);
+  virtual void io(long&);
+  virtual void io(unsigned long&);
+  virtual void io(long long&);
+  virtual void io(unsigned long long&);
+  virtual void io(double&);
+  virtual void io(float&);
+  virtual void io(std::string& str);
+
+  virtual bool supports_block_io() { return true; }
+  virtual bool block_io(void*, size_t, size_t);
+
+  /// Hash of everything written so far, as 32 hexadecimal digits
+  std::string digest() const;
+  /// Number of bytes hashed so far
+  unsigned long long bytes() const { return (bytes_); }
+  /// Number of objects written with begin_class. Zero means nothing with a
+  /// persistent representation was written.
+  size_t classes() const { return (classes_); }
+
+private:
+  virtual void reset_post_header();
+  template <class T> void gen_io(T&);
+  void update(const char* data, size_t bytes);
+  void mix(unsigned long long word);
+
+  unsigned long long h1_, h2_;
+  unsigned long long bytes_;
+  size_t classes_;
+  /// Bytes that do not fill a word yet
+  char tail_[8];
+  size_t tail_size_;
+};
+
+
 } // End namespace SCIRun
 
 
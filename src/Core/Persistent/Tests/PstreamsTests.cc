@@ -0,0 +1,158 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Testing/Utils/SCIRunFieldSamples.h>
+
+#include <Core/Datatypes/Legacy/Field/VMesh.h>
+#include <Core/Datatypes/Legacy/Field/Field.h>
+#include <Core/Datatypes/Legacy/Field/VField.h>
+#include <Core/Persistent/Pstreams.h>
+
+#include <gtest/gtest.h>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+
+using namespace SCIRun;
+using namespace SCIRun::TestUtils;
+
+namespace
+{
+  // Name in the temp directory, removed at the end of the test
+  class TempFile
+  {
+  public:
+    TempFile() : path_(boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path("pstream-%%%%-%%%%.fld")) {}
+    ~TempFile() { boost::filesystem::remove(path_); }
+    std::string name() const { return path_.string(); }
+    boost::uintmax_t size() const { return boost::filesystem::file_size(path_); }
+    void truncate(boost::uintmax_t size) const { boost::filesystem::resize_file(path_, size); }
+  private:
+    boost::filesystem::path path_;
+  };
+
+  // Tet mesh with distinct values on the elements
+  FieldHandle tetBlockWithValues()
+  {
+    FieldHandle field = TetBlockTetVolConstantBasis(20);
+    VMesh* mesh = field->vmesh();
+    VField* vfield = field->vfield();
+    for (VMesh::Elem::index_type c = 0; c < mesh->num_elems(); ++c)
+      vfield->set_value(0.25*c, c);
+    return field;
+  }
+
+  void write(FieldHandle field, PiostreamPtr stream)
+  {
+    ASSERT_FALSE(stream->error());
+    Pio(*stream, field);
+    EXPECT_FALSE(stream->error());
+  }
+
+  template <class Stream>
+  FieldHandle read(const TempFile& file)
+  {
+    PiostreamPtr stream = auto_istream(file.name());
+    EXPECT_TRUE(stream != nullptr);
+    if (!stream)
+      return nullptr;
+    EXPECT_TRUE(dynamic_cast<Stream*>(stream.get()) != nullptr);
+    FieldHandle field;
+    Pio(*stream, field);
+    EXPECT_FALSE(stream->error());
+    return field;
+  }
+
+  void expectSameField(FieldHandle expected, FieldHandle actual)
+  {
+    ASSERT_TRUE(actual != nullptr);
+    VMesh* mesh = expected->vmesh();
+    VMesh* imesh = actual->vmesh();
+    VField* ivfield = actual->vfield();
+    ASSERT_EQ(mesh->num_nodes(), imesh->num_nodes());
+    ASSERT_EQ(mesh->num_elems(), imesh->num_elems());
+    for (VMesh::Node::index_type n = 0; n < mesh->num_nodes(); ++n)
+      ASSERT_EQ(mesh->get_point(n), imesh->get_point(n));
+
+    VMesh::Node::array_type nodes, inodes;
+    for (VMesh::Elem::index_type c = 0; c < mesh->num_elems(); ++c)
+    {
+      mesh->get_nodes(nodes, c);
+      imesh->get_nodes(inodes, c);
+      ASSERT_EQ(nodes, inodes);
+      double val, ival;
+      expected->vfield()->get_value(val, c);
+      ivfield->get_value(ival, c);
+      ASSERT_EQ(val, ival);
+    }
+  }
+}
+
+TEST(PstreamsTests, BinaryFileIsReadThroughFileMapping)
+{
+  FieldHandle field = tetBlockWithValues();
+  TempFile file;
+  write(field, auto_ostream(file.name(), "Binary"));
+  expectSameField(field, read<MappedPiostream>(file));
+
+  // A truncated file gives an error instead of reading past the mapping
+  file.truncate(file.size() / 2);
+  PiostreamPtr stream = auto_istream(file.name());
+  ASSERT_TRUE(stream != nullptr);
+  FieldHandle truncated;
+  Pio(*stream, truncated);
+  EXPECT_TRUE(stream->error());
+}
+
+TEST(PstreamsTests, CompressedFileRoundTripsAndReadsChunks)
+{
+  FieldHandle field = tetBlockWithValues();
+  TempFile file, binary;
+  // Small chunks, so that every array is cut into many of them
+  write(field, PiostreamPtr(new ChunkedPiostream(file.name(), Piostream::Write, -1,
+    Core::Logging::LoggerHandle(), 4096)));
+  write(field, auto_ostream(binary.name(), "Binary"));
+  EXPECT_LT(file.size(), binary.size());
+
+  expectSameField(field, read<ChunkedPiostream>(file));
+
+  // Fetch part of the field values without reading the rest of the file
+  std::vector<ChunkedPiostream::Block> blocks;
+  ASSERT_TRUE(ChunkedPiostream::read_index(file.name(), blocks));
+  const size_t value_bytes = field->vmesh()->num_elems() * sizeof(double);
+  auto values = std::find_if(blocks.begin(), blocks.end(),
+    [value_bytes](const ChunkedPiostream::Block& b) { return b.bytes == value_bytes; });
+  ASSERT_TRUE(values != blocks.end());
+  ASSERT_GT(values->num_chunks(), 4u);
+
+  std::vector<double> part(values->chunk_bytes(2, 3) / sizeof(double));
+  ASSERT_TRUE(ChunkedPiostream::read_chunks(file.name(), *values, 2, 3, &part[0]));
+  const size_t first = 2 * 4096 / sizeof(double);
+  for (size_t i = 0; i < part.size(); i++)
+    ASSERT_EQ(0.25*(first + i), part[i]);
+}
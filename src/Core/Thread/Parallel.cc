@@ -27,37 +27,85 @@
  */
 
 #include <Core/Thread/Parallel.h>
+#include <Core/Thread/ThreadPool.h>
 #include <Core/Logging/Log.h>
+#include <Core/Logging/Profiler.h>
 #include <boost/thread/thread.hpp>
-#include <vector>
-#include <iostream>
+#include <algorithm>
+#include <atomic>
 
 using namespace SCIRun::Core::Thread;
 using namespace SCIRun::Core::Logging;
 
 void Parallel::RunTasks(IndexedTask task, int numProcs)
 {
-  boost::thread_group threads;
+  const auto numThreads = capByUserCoreCount(numProcs);
+  ScopedProfile profile("parallel", Profiler::Instance().enabled() ? "RunTasks x" + std::to_string(numThreads) : std::string());
+  ThreadPool::instance().runConcurrently(task, numThreads);
+}
+
+void Parallel::For(size_t begin, size_t end, size_t grain, RangeTask task)
+{
+  if (end <= begin)
+    return;
+  grain = std::max<size_t>(grain, 1);
 
-  for (int i = 0; i < capByUserCoreCount(numProcs); ++i)
+  const size_t numChunks = (end - begin + grain - 1) / grain;
+  const size_t numRunners = std::min<size_t>(NumCores(), numChunks);
+  if (numRunners <= 1)
   {
-    threads.create_thread(boost::bind(task, i));
+    for (size_t chunk = begin; chunk < end; chunk += grain)
+      task(chunk, std::min(end, chunk + grain));
+    return;
   }
 
+  ScopedProfile profile("parallel", Profiler::Instance().enabled() ? "For x" + std::to_string(numRunners) : std::string());
+
+  // Each runner claims the next unprocessed chunk, so uneven chunks balance out
+  // and an idle pool thread picks up runners queued by busy ones.
+  std::atomic<size_t> next(begin);
+  TaskGroup group;
+  auto runner = [&]()
+  {
+    while (!group.isCanceled())
+    {
+      const size_t chunk = next.fetch_add(grain);
+      if (chunk >= end)
+        return;
+      task(chunk, std::min(end, chunk + grain));
+    }
+  };
+
+  for (size_t i = 1; i < numRunners; ++i)
+    group.run(runner);
+
   try
   {
-    threads.join_all();
+    ThreadPool::ScopedConcurrencyShare share(1);
+    runner();
   }
-  catch (boost::thread_interrupted&)
+  catch (...)
   {
-    threads.interrupt_all();
+    group.cancel();
+    try
+    {
+      group.wait();
+    }
+    catch (...)
+    {
+    }
     throw;
   }
+  group.wait();
 }
 
 unsigned int Parallel::NumCores()
 {
-  return capByUserCoreCount(boost::thread::hardware_concurrency());
+  auto cores = capByUserCoreCount(boost::thread::hardware_concurrency());
+  auto share = ThreadPool::concurrencyShare();
+  if (share == 0)
+    share = ThreadPool::instance().availableCores();
+  return std::min(cores, share);
 }
 
 void Parallel::SetMaximumCores(unsigned int max)
@@ -31,6 +31,7 @@
 
 #include <boost/noncopyable.hpp>
 #include <boost/function.hpp>
+#include <cstddef>
 #include <Core/Thread/share.h>
 
 namespace SCIRun
@@ -43,7 +44,17 @@ namespace Thread
   {
   public:
     typedef boost::function<void(int)> IndexedTask;
+    typedef boost::function<void(size_t, size_t)> RangeTask;
+    /// Runs task(0) ... task(numProcs-1) concurrently on pooled threads, so tasks may
+    /// synchronize with each other through a Barrier sized numProcs.
     static void RunTasks(IndexedTask task, int numProcs);
+    /// Splits [begin, end) into chunks of at most grain indices and calls task(chunkBegin, chunkEnd)
+    /// for each, load-balanced across the thread pool. Chunks must be independent. Chunks always
+    /// start at begin + k*grain, also when the range runs on the calling thread only.
+    static void For(size_t begin, size_t end, size_t grain, RangeTask task);
+    /// Cores available to the calling thread: capped by SetMaximumCores, divided
+    /// among the tasks of any enclosing parallel region, and outside of one reduced
+    /// by the cores other callers' RunTasks currently occupy.
     static unsigned int NumCores();
     static void SetMaximumCores(unsigned int max);
   private:
@@ -31,6 +31,12 @@
 #include <fstream>
 
 #include <Core/Thread/Parallel.h>
+#include <Core/Thread/ThreadPool.h>
+#include <Core/Thread/Barrier.h>
+#include <boost/thread/thread.hpp>
+#include <atomic>
+#include <set>
+#include <stdexcept>
 #include <boost/filesystem/path.hpp>
 #include <Testing/Utils/SCIRunUnitTests.h>
 
@@ -52,6 +58,166 @@ TEST(ParallelTests, CanDoubleNumberInParallel)
   EXPECT_EQ(expectedSum * 2, std::accumulate(nums.begin(), nums.end(), 0, std::plus<int>()));
 }
 
+TEST(ParallelTests, RunTasksSupportsBarrierAcrossAllTasks)
+{
+  const int size = 4;
+  Barrier barrier("RunTasksBarrier", size);
+  std::vector<int> phase1(size, 0), seen(size, 0);
+
+  Parallel::RunTasks([&](int i)
+  {
+    phase1[i] = i + 1;
+    barrier.wait();
+    seen[i] = std::accumulate(phase1.begin(), phase1.end(), 0);
+  }, size);
+
+  for (int s : seen)
+    EXPECT_EQ(size * (size + 1) / 2, s);
+}
+
+TEST(ParallelTests, RunTasksReusesPooledThreads)
+{
+  std::set<boost::thread::id> firstRun, secondRun;
+  boost::mutex lock;
+  const int size = 4;
+  Barrier barrier("ReuseBarrier", size);
+  auto record = [&](std::set<boost::thread::id>& ids)
+  {
+    return [&](int)
+    {
+      {
+        boost::lock_guard<boost::mutex> guard(lock);
+        ids.insert(boost::this_thread::get_id());
+      }
+      barrier.wait();
+    };
+  };
+
+  Parallel::RunTasks(record(firstRun), size);
+  Parallel::RunTasks(record(secondRun), size);
+
+  EXPECT_EQ(size, firstRun.size());
+  EXPECT_EQ(firstRun, secondRun);
+}
+
+TEST(ParallelTests, RunTasksRethrowsTaskException)
+{
+  EXPECT_THROW(Parallel::RunTasks([](int i) { if (i == 1) throw std::runtime_error("task failed"); }, 2), std::runtime_error);
+}
+
+TEST(ParallelTests, NestedRunTasksDividesCores)
+{
+  const int outer = 2;
+  std::vector<unsigned int> innerCores(outer);
+  Barrier barrier("NestedBarrier", outer);
+
+  Parallel::RunTasks([&](int i)
+  {
+    innerCores[i] = Parallel::NumCores();
+    barrier.wait();
+  }, outer);
+
+  for (auto cores : innerCores)
+  {
+    EXPECT_GE(cores, 1u);
+    EXPECT_LE(cores, std::max(1u, Parallel::NumCores() / outer));
+  }
+}
+
+TEST(ParallelTests, RunTasksSharesCoresWithOtherCallers)
+{
+  const unsigned int before = Parallel::NumCores();
+  const int size = 2 * std::max(2u, boost::thread::hardware_concurrency());
+  Barrier started("SharedStart", size + 1), done("SharedDone", size + 1);
+
+  boost::thread caller([&]()
+  {
+    Parallel::RunTasks([&](int)
+    {
+      started.wait();
+      done.wait();
+    }, size);
+  });
+
+  // every core is taken by the other caller's tasks
+  started.wait();
+  EXPECT_EQ(1u, Parallel::NumCores());
+  done.wait();
+  caller.join();
+
+  // once the run is over its cores are free again
+  EXPECT_EQ(before, Parallel::NumCores());
+}
+
+TEST(ParallelTests, ForVisitsEachIndexOnce)
+{
+  const size_t size = 100003;
+  std::vector<int> visits(size, 0);
+
+  Parallel::For(0, size, 1000, [&](size_t begin, size_t end)
+  {
+    for (size_t i = begin; i < end; ++i)
+      ++visits[i];
+  });
+
+  EXPECT_EQ(size, std::count(visits.begin(), visits.end(), 1));
+}
+
+TEST(ParallelTests, ForChunksAreGrainSizedOnOneCore)
+{
+  const size_t begin = 7, end = 1030, grain = 100;
+  for (unsigned int cores : { 1u, 0u })
+  {
+    Parallel::SetMaximumCores(cores);
+    std::vector<char> starts(end, 0);
+    Parallel::For(begin, end, grain, [&](size_t b, size_t e)
+    {
+      EXPECT_EQ(0u, (b - begin) % grain);
+      EXPECT_EQ(std::min(end, b + grain), e);
+      starts[b] = 1;
+    });
+    EXPECT_EQ((end - begin + grain - 1) / grain, std::count(starts.begin(), starts.end(), 1));
+  }
+}
+
+TEST(ParallelTests, NestedForDoesNotDeadlock)
+{
+  const size_t outer = 64, inner = 1000;
+  std::vector<long long> sums(outer, 0);
+
+  Parallel::For(0, outer, 1, [&](size_t begin, size_t end)
+  {
+    for (size_t i = begin; i < end; ++i)
+    {
+      std::atomic<long long> sum(0);
+      Parallel::For(0, inner, 10, [&](size_t b, size_t e)
+      {
+        for (size_t j = b; j < e; ++j)
+          sum += j;
+      });
+      sums[i] = sum;
+    }
+  });
+
+  for (auto s : sums)
+    EXPECT_EQ(inner * (inner - 1) / 2, s);
+}
+
+TEST(ParallelTests, ForRethrowsTaskException)
+{
+  EXPECT_THROW(Parallel::For(0, 1000, 1, [](size_t begin, size_t end) { if (begin <= 500 && 500 < end) throw std::runtime_error("chunk failed"); }), std::runtime_error);
+}
+
+TEST(TaskGroupTests, RunsAllTasks)
+{
+  std::atomic<int> count(0);
+  TaskGroup group;
+  for (int i = 0; i < 1000; ++i)
+    group.run([&]() { ++count; });
+  group.wait();
+  EXPECT_EQ(1000, count);
+}
+
 /// @todo
 #if 0
 TEST(ParallelTests, CanDoubleNumberWithParallelForEach)
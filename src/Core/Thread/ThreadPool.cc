@@ -0,0 +1,530 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+
+ The MIT License
+
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ */
+
+#include <Core/Thread/ThreadPool.h>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
+using namespace SCIRun::Core::Thread;
+
+namespace
+{
+  // Per-thread bookkeeping: which pool queue belongs to this thread (0 is the
+  // shared injection queue used by threads outside the pool), and how many
+  // cores this thread may still use for nested parallel work.
+  thread_local size_t queueIndex_ = 0;
+  thread_local unsigned int concurrencyShare_ = 0;
+
+  struct QueuedTask
+  {
+    TaskGroup* group;
+    TaskGroup::Task task;
+  };
+
+  struct WorkQueue
+  {
+    boost::mutex lock;
+    std::deque<QueuedTask> tasks;
+  };
+
+  // State shared by the threads of one runConcurrently call.
+  struct ConcurrentRun
+  {
+    explicit ConcurrentRun(int numThreads) : remaining(numThreads) {}
+    int remaining;
+    std::exception_ptr error;
+    boost::mutex lock;
+    boost::condition_variable finished;
+
+    void recordError(std::exception_ptr e)
+    {
+      boost::lock_guard<boost::mutex> guard(lock);
+      if (!error)
+        error = e;
+    }
+
+    void threadFinished()
+    {
+      boost::lock_guard<boost::mutex> guard(lock);
+      if (--remaining == 0)
+        finished.notify_all();
+    }
+  };
+
+  // A parked thread reserved for co-scheduled tasks. Interruption is disabled
+  // while parked so that a late interrupt from a previous run cannot fire here.
+  struct ParkedThread
+  {
+    boost::mutex lock;
+    boost::condition_variable wake;
+    boost::function<void()> job;
+    bool stop = false;
+    boost::thread thread;
+  };
+}
+
+class ThreadPool::Impl
+{
+public:
+  Impl() : queued_(0), stopping_(false), busy_(0),
+    maxIdleParked_(std::max(1u, boost::thread::hardware_concurrency()))
+  {
+    auto hardware = std::max(2u, boost::thread::hardware_concurrency());
+    auto numWorkers = hardware - 1;
+    for (unsigned int i = 0; i <= numWorkers; ++i)
+      queues_.emplace_back(new WorkQueue);
+    for (unsigned int i = 0; i < numWorkers; ++i)
+      workers_.create_thread([this, i]() { workerLoop(i + 1); });
+  }
+
+  ~Impl()
+  {
+    {
+      boost::lock_guard<boost::mutex> guard(sleepLock_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    workers_.join_all();
+
+    boost::lock_guard<boost::mutex> guard(parkedLock_);
+    for (auto& parked : allParked_)
+    {
+      {
+        boost::lock_guard<boost::mutex> g(parked->lock);
+        parked->stop = true;
+      }
+      parked->wake.notify_one();
+      parked->thread.join();
+    }
+  }
+
+  void submit(TaskGroup* group, TaskGroup::Task task)
+  {
+    auto& queue = *queues_[queueIndex_ < queues_.size() ? queueIndex_ : 0];
+    {
+      boost::lock_guard<boost::mutex> guard(queue.lock);
+      queue.tasks.push_back({ group, task });
+    }
+    ++queued_;
+    {
+      boost::lock_guard<boost::mutex> guard(sleepLock_);
+    }
+    wake_.notify_one();
+  }
+
+  bool runPendingTask()
+  {
+    QueuedTask next;
+    if (!popTask(next))
+      return false;
+
+    std::exception_ptr error;
+    try
+    {
+      ThreadPool::ScopedConcurrencyShare share(1);
+      next.task();
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+    }
+    next.group->taskFinished(error);
+    return true;
+  }
+
+  ParkedThread* acquireParkedThread()
+  {
+    boost::lock_guard<boost::mutex> guard(parkedLock_);
+    ++busy_;
+    if (!idleParked_.empty())
+    {
+      auto parked = idleParked_.back();
+      idleParked_.pop_back();
+      return parked;
+    }
+    allParked_.emplace_back(new ParkedThread);
+    auto parked = allParked_.back().get();
+    parked->thread = boost::thread([this, parked]() { parkedLoop(parked); });
+    return parked;
+  }
+
+  void releaseParkedThread(ParkedThread* parked)
+  {
+    std::unique_ptr<ParkedThread> retired;
+    {
+      boost::lock_guard<boost::mutex> guard(parkedLock_);
+      --busy_;
+      if (idleParked_.size() < maxIdleParked_)
+      {
+        idleParked_.push_back(parked);
+        return;
+      }
+      // enough threads are parked already, let this one exit
+      auto pos = std::find_if(allParked_.begin(), allParked_.end(),
+        [parked](const std::unique_ptr<ParkedThread>& p) { return p.get() == parked; });
+      retired = std::move(*pos);
+      allParked_.erase(pos);
+    }
+    {
+      boost::lock_guard<boost::mutex> guard(retired->lock);
+      retired->stop = true;
+    }
+    retired->wake.notify_one();
+    boost::this_thread::disable_interruption noInterrupts;
+    retired->thread.join();
+  }
+
+  // Threads taken by co-scheduled tasks also count the calling threads of
+  // runs started outside of any parallel region.
+  void addCallers(int n)
+  {
+    busy_ += n;
+  }
+
+  unsigned int availableCores() const
+  {
+    const int hardware = std::max(1u, boost::thread::hardware_concurrency());
+    return static_cast<unsigned int>(std::max(1, hardware - busy_.load()));
+  }
+
+  unsigned int numWorkers() const
+  {
+    return static_cast<unsigned int>(queues_.size() - 1);
+  }
+
+private:
+  // Own queue is used LIFO for locality; other queues are stolen from FIFO.
+  bool popTask(QueuedTask& task)
+  {
+    const auto own = queueIndex_ < queues_.size() ? queueIndex_ : 0;
+    {
+      auto& queue = *queues_[own];
+      boost::lock_guard<boost::mutex> guard(queue.lock);
+      if (!queue.tasks.empty())
+      {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        --queued_;
+        return true;
+      }
+    }
+    for (size_t i = 1; i < queues_.size(); ++i)
+    {
+      auto& queue = *queues_[(own + i) % queues_.size()];
+      boost::lock_guard<boost::mutex> guard(queue.lock);
+      if (!queue.tasks.empty())
+      {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        --queued_;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void workerLoop(size_t index)
+  {
+    queueIndex_ = index;
+    concurrencyShare_ = 1;
+    for (;;)
+    {
+      if (runPendingTask())
+        continue;
+      boost::unique_lock<boost::mutex> lock(sleepLock_);
+      if (stopping_)
+        return;
+      if (queued_ == 0)
+        wake_.wait(lock);
+    }
+  }
+
+  void parkedLoop(ParkedThread* parked)
+  {
+    boost::this_thread::disable_interruption noInterrupts;
+    for (;;)
+    {
+      boost::function<void()> job;
+      {
+        boost::unique_lock<boost::mutex> lock(parked->lock);
+        while (!parked->job && !parked->stop)
+          parked->wake.wait(lock);
+        if (parked->stop)
+          return;
+        job.swap(parked->job);
+      }
+      boost::this_thread::restore_interruption interruptible(noInterrupts);
+      try
+      {
+        // discard an interrupt meant for a run that has already finished
+        boost::this_thread::interruption_point();
+      }
+      catch (boost::thread_interrupted&)
+      {
+      }
+      job();
+    }
+  }
+
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  boost::thread_group workers_;
+  std::atomic<int> queued_;
+  boost::mutex sleepLock_;
+  boost::condition_variable wake_;
+  bool stopping_;
+
+  boost::mutex parkedLock_;
+  std::atomic<int> busy_;
+  const size_t maxIdleParked_;
+  std::vector<std::unique_ptr<ParkedThread>> allParked_;
+  std::vector<ParkedThread*> idleParked_;
+};
+
+ThreadPool& ThreadPool::instance()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+ThreadPool::ThreadPool() : impl_(new Impl)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+}
+
+unsigned int ThreadPool::numWorkers() const
+{
+  return impl_->numWorkers();
+}
+
+void ThreadPool::submit(TaskGroup* group, TaskGroup::Task task)
+{
+  impl_->submit(group, task);
+}
+
+bool ThreadPool::runPendingTask()
+{
+  return impl_->runPendingTask();
+}
+
+void ThreadPool::runConcurrently(IndexedTask task, int numTasks)
+{
+  if (numTasks <= 0)
+    return;
+
+  // Outside of a parallel region the calling thread competes with other
+  // callers for the cores, inside it already owns its share.
+  const bool topLevel = concurrencyShare_ == 0;
+  const auto parentShare = topLevel ? impl_->availableCores() : concurrencyShare_;
+  const auto childShare = std::max(1u, parentShare / static_cast<unsigned int>(numTasks));
+  if (topLevel)
+    impl_->addCallers(1);
+
+  ConcurrentRun run(numTasks - 1);
+  std::vector<ParkedThread*> threads;
+  for (int i = 1; i < numTasks; ++i)
+  {
+    auto parked = impl_->acquireParkedThread();
+    threads.push_back(parked);
+    {
+      boost::lock_guard<boost::mutex> guard(parked->lock);
+      parked->job = [&run, &task, i, childShare]()
+      {
+        try
+        {
+          ScopedConcurrencyShare share(childShare);
+          task(i);
+        }
+        catch (...)
+        {
+          run.recordError(std::current_exception());
+        }
+        run.threadFinished();
+      };
+    }
+    parked->wake.notify_one();
+  }
+
+  bool interrupted = false;
+  try
+  {
+    ScopedConcurrencyShare share(childShare);
+    task(0);
+  }
+  catch (boost::thread_interrupted&)
+  {
+    interrupted = true;
+  }
+  catch (...)
+  {
+    run.recordError(std::current_exception());
+  }
+
+  {
+    boost::unique_lock<boost::mutex> lock(run.lock);
+    while (run.remaining > 0)
+    {
+      if (interrupted)
+      {
+        boost::this_thread::disable_interruption noInterrupts;
+        run.finished.wait(lock);
+        continue;
+      }
+      try
+      {
+        run.finished.wait(lock);
+      }
+      catch (boost::thread_interrupted&)
+      {
+        interrupted = true;
+        lock.unlock();
+        for (auto parked : threads)
+          parked->thread.interrupt();
+        lock.lock();
+      }
+    }
+  }
+
+  for (auto parked : threads)
+    impl_->releaseParkedThread(parked);
+  if (topLevel)
+    impl_->addCallers(-1);
+
+  if (interrupted)
+    throw boost::thread_interrupted();
+  if (run.error)
+    std::rethrow_exception(run.error);
+}
+
+unsigned int ThreadPool::availableCores() const
+{
+  return impl_->availableCores();
+}
+
+unsigned int ThreadPool::concurrencyShare()
+{
+  return concurrencyShare_;
+}
+
+ThreadPool::ScopedConcurrencyShare::ScopedConcurrencyShare(unsigned int share) : previous_(concurrencyShare_)
+{
+  concurrencyShare_ = share;
+}
+
+ThreadPool::ScopedConcurrencyShare::~ScopedConcurrencyShare()
+{
+  concurrencyShare_ = previous_;
+}
+
+TaskGroup::TaskGroup() : pending_(0), canceled_(false)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+  try
+  {
+    wait();
+  }
+  catch (...)
+  {
+  }
+}
+
+void TaskGroup::run(Task task)
+{
+  ++pending_;
+  ThreadPool::instance().submit(this, task);
+}
+
+void TaskGroup::wait()
+{
+  auto& pool = ThreadPool::instance();
+  bool interrupted = false;
+  while (pending_ > 0)
+  {
+    if (pool.runPendingTask())
+      continue;
+    boost::unique_lock<boost::mutex> lock(lock_);
+    if (pending_ == 0)
+      break;
+    if (interrupted)
+    {
+      boost::this_thread::disable_interruption noInterrupts;
+      done_.wait_for(lock, boost::chrono::milliseconds(1));
+      continue;
+    }
+    try
+    {
+      done_.wait_for(lock, boost::chrono::milliseconds(1));
+    }
+    catch (boost::thread_interrupted&)
+    {
+      interrupted = true;
+      cancel();
+    }
+  }
+
+  if (interrupted)
+    throw boost::thread_interrupted();
+
+  std::exception_ptr error;
+  {
+    boost::lock_guard<boost::mutex> guard(lock_);
+    std::swap(error, error_);
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void TaskGroup::cancel()
+{
+  canceled_ = true;
+}
+
+bool TaskGroup::isCanceled() const
+{
+  return canceled_;
+}
+
+void TaskGroup::taskFinished(std::exception_ptr error)
+{
+  boost::lock_guard<boost::mutex> guard(lock_);
+  if (error && !error_)
+  {
+    error_ = error;
+    canceled_ = true;
+  }
+  if (--pending_ == 0)
+    done_.notify_all();
+}
@@ -0,0 +1,114 @@
+/*
+ For more information, please see: http://software.sci.utah.edu
+
+ The MIT License
+
+ Copyright (c) 2015 Scientific Computing and Imaging Institute,
+ University of Utah.
+
+
+ Permission is hereby granted, free of charge, to any person obtaining a
+ copy of this software and associated documentation files (the "Software"),
+ to deal in the Software without restriction, including without limitation
+ the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ and/or sell copies of the Software, and to permit persons to whom the
+ Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included
+ in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CORE_THREAD_THREADPOOL_H
+#define CORE_THREAD_THREADPOOL_H
+
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <atomic>
+#include <exception>
+#include <Core/Thread/share.h>
+
+namespace SCIRun
+{
+namespace Core
+{
+namespace Thread
+{
+  /// A set of tasks submitted to the process-wide ThreadPool. wait() blocks until
+  /// every task has finished, executing queued tasks on the calling thread in the
+  /// meantime, and rethrows the first exception thrown by any of the tasks.
+  class SCISHARE TaskGroup : boost::noncopyable
+  {
+  public:
+    typedef boost::function<void()> Task;
+    TaskGroup();
+    ~TaskGroup();
+    void run(Task task);
+    void wait();
+    void cancel();
+    bool isCanceled() const;
+  private:
+    friend class ThreadPool;
+    void taskFinished(std::exception_ptr error);
+    std::atomic<int> pending_;
+    std::atomic<bool> canceled_;
+    std::exception_ptr error_;
+    boost::mutex lock_;
+    boost::condition_variable done_;
+  };
+
+  /// Persistent worker threads shared by all parallel algorithms. Short tasks go
+  /// through per-worker work-stealing queues (see TaskGroup); co-scheduled tasks
+  /// that synchronize with each other (Parallel::RunTasks) are handed to a cache
+  /// of parked threads that is reused between calls instead of spawning new ones.
+  /// At most one idle parked thread per core is kept; the cores they occupy are
+  /// shared by all callers, see availableCores().
+  class SCISHARE ThreadPool : boost::noncopyable
+  {
+  public:
+    typedef boost::function<void(int)> IndexedTask;
+    static ThreadPool& instance();
+    ~ThreadPool();
+
+    unsigned int numWorkers() const;
+    /// Runs task(0) ... task(numTasks-1) on distinct threads at the same time;
+    /// task(0) runs on the calling thread.
+    void runConcurrently(IndexedTask task, int numTasks);
+
+    /// Cores not taken by the co-scheduled tasks of any caller, at least 1.
+    unsigned int availableCores() const;
+
+    /// Number of cores the calling thread may use for nested parallel work, or 0
+    /// outside of any parallel region.
+    static unsigned int concurrencyShare();
+
+    class SCISHARE ScopedConcurrencyShare : boost::noncopyable
+    {
+    public:
+      explicit ScopedConcurrencyShare(unsigned int share);
+      ~ScopedConcurrencyShare();
+    private:
+      unsigned int previous_;
+    };
+  private:
+    ThreadPool();
+    friend class TaskGroup;
+    void submit(TaskGroup* group, TaskGroup::Task task);
+    bool runPendingTask();
+    class Impl;
+    boost::scoped_ptr<Impl> impl_;
+  };
+
+}}}
+
+#endif
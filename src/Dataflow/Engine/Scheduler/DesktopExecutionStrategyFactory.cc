@@ -30,6 +30,7 @@
 #include <Dataflow/Engine/Scheduler/SerialExecutionStrategy.h>
 #include <Dataflow/Engine/Scheduler/BasicParallelExecutionStrategy.h>
 #include <Dataflow/Engine/Scheduler/DynamicParallelExecutionStrategy.h>
+#include <Dataflow/Engine/Scheduler/PriorityParallelExecutionStrategy.h>
 #include <Dataflow/Engine/Scheduler/DesktopExecutionStrategyFactory.h>
 #include <Dataflow/Network/NetworkInterface.h>
 #include <Core/Logging/Log.h>
@@ -42,7 +43,8 @@ DesktopExecutionStrategyFactory::DesktopExecutionStrategyFactory(const boost::op
   threadMode_(threadMode),
   serial_(new SerialExecutionStrategy),
   parallel_(new BasicParallelExecutionStrategy),
-  dynamic_(new DynamicParallelExecutionStrategy)
+  dynamic_(new DynamicParallelExecutionStrategy),
+  priority_(new PriorityParallelExecutionStrategy)
 {
 }
 
@@ -56,6 +58,8 @@ ExecutionStrategyHandle DesktopExecutionStrategyFactory::create(ExecutionStrateg
     return parallel_;
   case ExecutionStrategy::DYNAMIC_PARALLEL:
     return dynamic_;
+  case ExecutionStrategy::PRIORITY_PARALLEL:
+    return priority_;
   default:
     THROW_INVALID_ARGUMENT("Unknown execution strategy type.");
   }
@@ -63,7 +67,7 @@ ExecutionStrategyHandle DesktopExecutionStrategyFactory::create(ExecutionStrateg
 
 ExecutionStrategyHandle DesktopExecutionStrategyFactory::createDefault() const
 {
-  const ExecutionStrategy::Type latestWorkingVersion = ExecutionStrategy::DYNAMIC_PARALLEL;
+  const ExecutionStrategy::Type latestWorkingVersion = ExecutionStrategy::PRIORITY_PARALLEL;
   if (threadMode_)
   {
     LOG_DEBUG("found thread mode: ", *threadMode_);
@@ -73,12 +77,14 @@ ExecutionStrategyHandle DesktopExecutionStrategyFactory::createDefault() const
       return create(ExecutionStrategy::BASIC_PARALLEL);
     if (*threadMode_ == "dynamicParallel")
       return create(ExecutionStrategy::DYNAMIC_PARALLEL);
+    if (*threadMode_ == "priorityParallel")
+      return create(ExecutionStrategy::PRIORITY_PARALLEL);
     else
       return create(latestWorkingVersion);
   }
   else
   {
-    LOG_TRACE("no thread mode found, using dynamic parallel"); /// @todo: update this to best working version
+    LOG_TRACE("no thread mode found, using priority parallel"); /// @todo: update this to best working version
     return create(latestWorkingVersion);
   }
 }
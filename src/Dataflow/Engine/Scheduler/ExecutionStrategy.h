@@ -50,7 +50,8 @@ namespace Engine {
     {
       SERIAL,
       BASIC_PARALLEL,
-      DYNAMIC_PARALLEL
+      DYNAMIC_PARALLEL,
+      PRIORITY_PARALLEL
       // next: pausable, then with loops
     };
 
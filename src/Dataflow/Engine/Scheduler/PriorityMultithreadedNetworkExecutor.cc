@@ -0,0 +1,255 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Dataflow/Engine/Scheduler/PriorityMultithreadedNetworkExecutor.h>
+#include <Dataflow/Engine/Scheduler/GraphNetworkAnalyzer.h>
+#include <Dataflow/Network/ModuleInterface.h>
+#include <Dataflow/Network/ModuleDescription.h>
+#include <Dataflow/Network/NetworkInterface.h>
+#include <Core/Thread/ConditionVariable.h>
+#include <Core/Thread/Parallel.h>
+#include <boost/make_shared.hpp>
+#include <boost/thread.hpp>
+#include <chrono>
+#include <queue>
+
+using namespace SCIRun::Dataflow::Engine;
+using namespace SCIRun::Dataflow::Engine::NetworkGraph;
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Core::Thread;
+
+ModuleExecutionTimeHistory::ModuleExecutionTimeHistory() : lock_("executionTimeHistory")
+{
+}
+
+void ModuleExecutionTimeHistory::record(const ModuleId& id, double seconds)
+{
+  Guard g(lock_.get());
+  auto it = seconds_.find(id.id_);
+  if (it == seconds_.end())
+    seconds_[id.id_] = seconds;
+  else
+    it->second = 0.5 * (it->second + seconds);
+}
+
+double ModuleExecutionTimeHistory::estimate(const ModuleId& id) const
+{
+  Guard g(lock_.get());
+  auto it = seconds_.find(id.id_);
+  if (it != seconds_.end())
+    return it->second;
+  if (seconds_.empty())
+    return 1.0;
+  double total = 0;
+  for (const auto& s : seconds_)
+    total += s.second;
+  return total / seconds_.size();
+}
+
+namespace
+{
+  class PriorityNetworkExecution : public WaitsForStartupInitialization, boost::noncopyable
+  {
+  public:
+    PriorityNetworkExecution(const ExecutionContext& context, const NetworkInterface* network, ModuleExecutionTimeHistoryHandle history,
+      unsigned int maxThreads, Mutex* executionLock) :
+      network_(network),
+      lookup_(&context.lookup),
+      bounds_(&context.bounds()),
+      filter_(context.addAdditionalFilter(ModuleWaitingFilter::Instance())),
+      history_(history),
+      maxThreads_(maxThreads > 0 ? maxThreads : std::max(1u, Parallel::NumCores())),
+      executionLock_(executionLock),
+      lock_("priorityExecution"),
+      readyChanged_("priorityExecution"),
+      remaining_(0)
+    {
+    }
+
+    void run()
+    {
+      Guard g(executionLock_->get());
+
+      boost::signals2::scoped_connection interruptCxn(network_->connectModuleInterrupted([this](const std::string& id) { interruptModule(id); }));
+      ScopedExecutionBoundsSignaller signaller(bounds_, [this]() { return lookup_->errorCode(); });
+
+      waitForStartupInit(*lookup_);
+
+      // cycles were ruled out by the strategy, on the unfiltered network
+      buildGraph();
+
+      boost::thread_group workers;
+      {
+        // workers wait on this lock until the pool is complete
+        Guard pool(lock_.get());
+        const auto numThreads = std::min<size_t>(maxThreads_, nodes_.size());
+        for (size_t i = 0; i < numThreads; ++i)
+          workerThreads_.push_back(workers.create_thread([this, i]() { work(i); }));
+      }
+      workers.join_all();
+    }
+
+  private:
+    struct Node
+    {
+      ModuleId id;
+      std::vector<int> downstream;
+      int waitingOn;
+      double priority;
+    };
+    typedef std::pair<double, int> ReadyNode;
+
+    void buildGraph()
+    {
+      NetworkGraphAnalyzer analyzer(*network_, filter_, true);
+      const auto& graph = analyzer.graph();
+
+      nodes_.resize(analyzer.moduleCount());
+      for (int v = 0; v < analyzer.moduleCount(); ++v)
+      {
+        nodes_[v].id = analyzer.moduleAt(v);
+        nodes_[v].waitingOn = static_cast<int>(boost::in_degree(v, graph));
+        DirectedGraph::out_edge_iterator e, e_end;
+        for (boost::tie(e, e_end) = boost::out_edges(v, graph); e != e_end; ++e)
+          nodes_[v].downstream.push_back(static_cast<int>(boost::target(*e, graph)));
+      }
+
+      // critical path length, from the sinks up
+      std::vector<Vertex> order(analyzer.topologicalBegin(), analyzer.topologicalEnd());
+      for (auto v = order.rbegin(); v != order.rend(); ++v)
+      {
+        auto& node = nodes_[*v];
+        double longestDownstream = 0;
+        for (int d : node.downstream)
+          longestDownstream = std::max(longestDownstream, nodes_[d].priority);
+        node.priority = history_->estimate(node.id) + longestDownstream;
+      }
+
+      remaining_ = nodes_.size();
+      for (size_t v = 0; v < nodes_.size(); ++v)
+        if (0 == nodes_[v].waitingOn)
+          ready_.push(ReadyNode(nodes_[v].priority, static_cast<int>(v)));
+    }
+
+    void work(size_t worker)
+    {
+      while (true)
+      {
+        int next;
+        {
+          UniqueLock lock(lock_.get());
+          while (ready_.empty() && remaining_ > 0)
+            readyChanged_.wait(lock);
+          if (0 == remaining_)
+            return;
+          next = ready_.top().second;
+          ready_.pop();
+          running_[nodes_[next].id.id_] = workerThreads_[worker];
+        }
+
+        execute(nodes_[next].id);
+
+        {
+          Guard g(lock_.get());
+          running_.erase(nodes_[next].id.id_);
+        }
+        // discard an interruption request that arrived after the module was done
+        try
+        {
+          boost::this_thread::interruption_point();
+        }
+        catch (boost::thread_interrupted&)
+        {
+        }
+
+        finished(next);
+      }
+    }
+
+    void execute(const ModuleId& id) const
+    {
+      auto module = network_->lookupModule(id);
+      if (!module || module->executionState().currentState() != ModuleExecutionState::Waiting)
+        return;
+
+      const auto start = std::chrono::steady_clock::now();
+      lookup_->lookupExecutable(id)->executeWithSignals();
+      history_->record(id, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    void finished(int node)
+    {
+      {
+        Guard g(lock_.get());
+        for (int d : nodes_[node].downstream)
+        {
+          if (0 == --nodes_[d].waitingOn)
+            ready_.push(ReadyNode(nodes_[d].priority, d));
+        }
+        --remaining_;
+      }
+      readyChanged_.conditionBroadcast();
+    }
+
+    void interruptModule(const std::string& id)
+    {
+      Guard g(lock_.get());
+      auto it = running_.find(id);
+      if (it != running_.end())
+        it->second->interrupt();
+    }
+
+    const NetworkInterface* network_;
+    const ExecutableLookup* lookup_;
+    const ExecutionBounds* bounds_;
+    ModuleFilter filter_;
+    ModuleExecutionTimeHistoryHandle history_;
+    const unsigned int maxThreads_;
+    Mutex* executionLock_;
+
+    Mutex lock_;
+    ConditionVariable readyChanged_;
+    std::vector<Node> nodes_;
+    std::priority_queue<ReadyNode> ready_;
+    size_t remaining_;
+    std::vector<boost::thread*> workerThreads_;
+    std::map<std::string, boost::thread*> running_;
+  };
+}
+
+PriorityMultithreadedNetworkExecutor::PriorityMultithreadedNetworkExecutor(const NetworkInterface& network,
+  ModuleExecutionTimeHistoryHandle history, unsigned int maxThreads) :
+  network_(network), history_(history), maxThreads_(maxThreads)
+{
+}
+
+void PriorityMultithreadedNetworkExecutor::execute(const ExecutionContext& context, ParallelModuleExecutionOrder order, Mutex& executionLock)
+{
+  auto runner = boost::make_shared<PriorityNetworkExecution>(context, &network_, history_, maxThreads_, &executionLock);
+  boost::thread execution([runner]() { runner->run(); });
+}
@@ -0,0 +1,75 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef ENGINE_SCHEDULER_PRIORITYMULTITHREADEDNETWORKEXECUTOR_H
+#define ENGINE_SCHEDULER_PRIORITYMULTITHREADEDNETWORKEXECUTOR_H
+
+#include <map>
+#include <Dataflow/Engine/Scheduler/ParallelModuleExecutionOrder.h>
+#include <Dataflow/Engine/Scheduler/SchedulerInterfaces.h>
+#include <Dataflow/Engine/Scheduler/share.h>
+
+namespace SCIRun {
+namespace Dataflow {
+namespace Engine {
+
+  // Smoothed execution time of each module over previous executions
+  class SCISHARE ModuleExecutionTimeHistory : boost::noncopyable
+  {
+  public:
+    ModuleExecutionTimeHistory();
+    void record(const Networks::ModuleId& id, double seconds);
+    // Modules that never ran are assumed to take the mean time of the others, or 1 if none did
+    double estimate(const Networks::ModuleId& id) const;
+  private:
+    mutable Core::Thread::Mutex lock_;
+    std::map<std::string, double> seconds_;
+  };
+
+  typedef boost::shared_ptr<ModuleExecutionTimeHistory> ModuleExecutionTimeHistoryHandle;
+
+  // Executes the modules of the network that pass the context filter on a bounded pool of
+  // threads. Each module keeps a count of unfinished upstream modules; when a module finishes
+  // the counts of its downstream modules are decremented and those that reach zero become
+  // ready. Ready modules are started in order of their critical path length: their own
+  // estimated execution time plus the longest estimated path downstream of them.
+  class SCISHARE PriorityMultithreadedNetworkExecutor : public NetworkExecutor<ParallelModuleExecutionOrder>
+  {
+  public:
+    // maxThreads == 0 uses one thread per core
+    PriorityMultithreadedNetworkExecutor(const Networks::NetworkInterface& network, ModuleExecutionTimeHistoryHandle history, unsigned int maxThreads = 0);
+    virtual void execute(const ExecutionContext& context, ParallelModuleExecutionOrder order, Core::Thread::Mutex& executionLock) override;
+  private:
+    const Networks::NetworkInterface& network_;
+    ModuleExecutionTimeHistoryHandle history_;
+    unsigned int maxThreads_;
+  };
+
+}}}
+
+#endif
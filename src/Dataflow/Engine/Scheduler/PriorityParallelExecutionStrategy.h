@@ -0,0 +1,55 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef ENGINE_SCHEDULER_PRIORITY_PARALLEL_EXECUTION_STRATEGY_H
+#define ENGINE_SCHEDULER_PRIORITY_PARALLEL_EXECUTION_STRATEGY_H
+
+#include <Dataflow/Engine/Scheduler/ExecutionStrategy.h>
+#include <Dataflow/Engine/Scheduler/PriorityMultithreadedNetworkExecutor.h>
+#include <Dataflow/Engine/Scheduler/share.h>
+
+namespace SCIRun {
+  namespace Dataflow {
+    namespace Engine {
+
+      // Event driven parallel execution on a bounded thread pool: ready modules are started
+      // as soon as their upstream modules finish, longest remaining path first. Module
+      // execution times are remembered across executions to estimate those paths.
+      class SCISHARE PriorityParallelExecutionStrategy : public ExecutionStrategy
+      {
+      public:
+        PriorityParallelExecutionStrategy();
+        virtual void execute(const ExecutionContext& context, Core::Thread::Mutex& executionLock) override;
+      private:
+        ModuleExecutionTimeHistoryHandle history_;
+      };
+
+    }
+  }}
+
+#endif
@@ -47,6 +47,7 @@
 #include <Dataflow/Engine/Scheduler/BoostGraphParallelScheduler.h>
 #include <Dataflow/Engine/Scheduler/BasicMultithreadedNetworkExecutor.h>
 #include <Dataflow/Engine/Scheduler/BasicParallelExecutionStrategy.h>
+#include <Dataflow/Engine/Scheduler/PriorityParallelExecutionStrategy.h>
 #include <Core/Algorithms/Factory/HardCodedAlgorithmFactory.h>
 #include <Core/Algorithms/Base/AlgorithmVariableNames.h>
 #include <Core/Logging/Log.h>
@@ -298,6 +299,64 @@ TEST_F(SchedulingWithBoostGraph, NetworkFromMatrixCalculatorMultiThreaded)
   EXPECT_EQ(186, reportOutput.get<5>());
 }
 
+TEST_F(SchedulingWithBoostGraph, NetworkFromMatrixCalculatorPriorityParallel)
+{
+  setupBasicNetwork();
+
+  PriorityParallelExecutionStrategy strategy;
+  ExecutionContext context(matrixMathNetwork, matrixMathNetwork);
+  context.preexecute();
+  Mutex m("exec");
+  strategy.execute(context, m);
+
+  /// @todo: let executor thread finish.  should be an event generated or something.
+  boost::this_thread::sleep(boost::posix_time::milliseconds(800));
+
+  ReportMatrixInfoAlgorithm::Outputs reportOutput = transient_value_cast<ReportMatrixInfoAlgorithm::Outputs>(report->get_state()->getTransientValue("ReportedInfo"));
+  EXPECT_EQ(3, reportOutput.get<1>());
+  EXPECT_EQ(3, reportOutput.get<2>());
+  EXPECT_EQ(9, reportOutput.get<3>());
+  EXPECT_EQ(22, reportOutput.get<4>());
+  EXPECT_EQ(186, reportOutput.get<5>());
+}
+
+TEST_F(SchedulingWithBoostGraph, PriorityExecutorStartsLongestPathFirst)
+{
+  setupBasicNetwork();
+
+  std::vector<std::string> started;
+  Mutex startedLock("started");
+  std::vector<boost::signals2::scoped_connection> connections;
+  for (size_t i = 0; i < matrixMathNetwork.nmodules(); ++i)
+  {
+    connections.emplace_back(matrixMathNetwork.module(i)->connectExecuteBegins([&](const ModuleId& id)
+    {
+      Guard g(startedLock.get());
+      started.push_back(id.id_);
+    }));
+  }
+
+  // one thread, so modules run strictly in priority order
+  ModuleExecutionTimeHistoryHandle history(new ModuleExecutionTimeHistory);
+  PriorityMultithreadedNetworkExecutor executor(matrixMathNetwork, history, 1);
+  ExecutionContext context(matrixMathNetwork, matrixMathNetwork);
+  context.preexecute();
+  Mutex m("exec");
+  executor.execute(context, ParallelModuleExecutionOrder(), m);
+
+  boost::this_thread::sleep(boost::posix_time::milliseconds(800));
+
+  Guard g(startedLock.get());
+  ASSERT_EQ(9u, started.size());
+  auto position = [&](const std::string& id) { return std::find(started.begin(), started.end(), id) - started.begin(); };
+  // transpose only feeds the final add, so it waits for negate and scalar multiply
+  EXPECT_GT(position("EvaluateLinearAlgebraUnary:2"), position("EvaluateLinearAlgebraUnary:3"));
+  EXPECT_GT(position("EvaluateLinearAlgebraUnary:2"), position("EvaluateLinearAlgebraUnary:4"));
+  EXPECT_GT(position("EvaluateLinearAlgebraBinary:6"), position("EvaluateLinearAlgebraUnary:2"));
+  // measured times replace the default estimate of one second
+  EXPECT_LT(history->estimate(ModuleId("EvaluateLinearAlgebraBinary:6")), 1.0);
+}
+
 TEST_F(SchedulingWithBoostGraph, SerialNetworkOrder)
 {
   setupBasicNetwork();
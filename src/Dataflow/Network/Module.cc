@@ -31,9 +31,11 @@
 #include <boost/bind.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/timer.hpp>
+#include <boost/core/demangle.hpp>
 #include <atomic>
 
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Logging/Profiler.h>
 #include <Dataflow/Network/PortManager.h>
 #include <Dataflow/Network/ModuleStateInterface.h>
 #include <Dataflow/Network/Module.h>
@@ -44,6 +46,7 @@
 // ReSharper disable once CppUnusedIncludeDirective
 #include <Dataflow/Network/DataflowInterfaces.h>
 #include <Dataflow/Network/ModuleBuilder.h>
+#include <Dataflow/Network/ModuleOutputCache.h>
 #include <Core/Logging/ConsoleLogger.h>
 #include <Core/Logging/Log.h>
 #include <Core/Thread/Mutex.h>
@@ -192,6 +195,41 @@ namespace SCIRun
         UiToggleFunc uiToggleFunc_;
 
         bool returnCode_{ false };
+
+        // outputs sent during an execution that will be memoized
+        boost::optional<ModuleOutputCache::Outputs> sentOutputs_;
+
+        boost::optional<std::string> outputCacheKey() const
+        {
+          auto& cache = ModuleOutputCache::Instance();
+          if (!module_->isMemoizable() || !cache.enabled())
+            return boost::none;
+
+          std::vector<Variable> state;
+          for (const auto& name : state_->getKeys())
+            state.push_back(state_->getValue(name));
+          ModuleOutputCache::Inputs inputs;
+          for (const auto& port : iports_.view())
+            inputs.emplace_back(port->id(), port->getData());
+
+          auto key = cache.key(info_.package_name_ + "::" + info_.module_name_, state, inputs);
+          if (!key)
+            cache.recordUncacheable();
+          return key;
+        }
+
+        bool sendCachedOutputs(const std::string& key)
+        {
+          auto outputs = ModuleOutputCache::Instance().find(key);
+          if (!outputs)
+            return false;
+          for (const auto& output : *outputs)
+          {
+            if (oports_.hasPort(output.first))
+              oports_[output.first]->sendData(output.second);
+          }
+          return true;
+        }
       };
     }
   }
@@ -387,8 +425,25 @@ bool Module::executeWithSignals() NOEXCEPT
 
   try
   {
+    ScopedProfile profile("module", id().id_);
     if (!executionDisabled())
-      execute();
+    {
+      auto cacheKey = impl_->outputCacheKey();
+      if (cacheKey && impl_->sendCachedOutputs(*cacheKey))
+      {
+        status("MODULE " + id().id_ + " reused cached outputs.");
+      }
+      else
+      {
+        if (cacheKey)
+          impl_->sentOutputs_ = ModuleOutputCache::Outputs();
+        execute();
+        // nothing sent means the module found nothing to do, which is not worth remembering
+        if (cacheKey && !impl_->sentOutputs_->empty() && !getLogger()->errorReported())
+          ModuleOutputCache::Instance().store(*cacheKey, *impl_->sentOutputs_);
+        impl_->sentOutputs_.reset();
+      }
+    }
 
     impl_->returnCode_ = true;
     getLogger()->setErrorFlag(false);
@@ -434,6 +489,7 @@ bool Module::executeWithSignals() NOEXCEPT
     error("MODULE ERROR: unhandled exception caught");
   }
   impl_->threadStopped_ = threadStopValue;
+  impl_->sentOutputs_.reset();
 
   auto executionTime = executionTimer.elapsed();
   {
@@ -493,13 +549,24 @@ void Module::setState(ModuleStateHandle state)
   copyStateToMetadata();
 }
 
-AlgorithmBase& Module::algo()
+TracedAlgorithm Module::algo()
 {
   if (!impl_->algo_)
     error("Null algorithm object, make sure AlgorithmFactory knows about this module's algorithm types.");
   ENSURE_NOT_NULL(impl_->algo_, "Null algorithm!");
 
-  return *impl_->algo_;
+  return TracedAlgorithm(*impl_->algo_);
+}
+
+AlgorithmOutput TracedAlgorithm::run(const AlgorithmInput& input) const
+{
+  if (!Profiler::Instance().enabled())
+    return algo_.run(input);
+
+  auto name = boost::core::demangle(typeid(algo_).name());
+  auto lastScope = name.rfind("::");
+  ScopedProfile profile("algorithm", lastScope == std::string::npos ? name : name.substr(lastScope + 2));
+  return algo_.run(input);
 }
 
 size_t Module::add_input_port(InputPortHandle h)
@@ -594,6 +661,8 @@ void Module::send_output_handle(const PortId& id, DatatypeHandle data)
     THROW_OUT_OF_RANGE("Output port does not exist: " + id.toString());
   }
 
+  if (impl_->sentOutputs_)
+    (*impl_->sentOutputs_)[id] = data;
   impl_->oports_[id]->sendData(data);
 }
 
@@ -37,7 +37,7 @@
 #include <Core/Datatypes/DatatypeFwd.h>
 // ReSharper disable once CppUnusedIncludeDirective
 #include <Core/Datatypes/Mesh/FieldFwd.h>
-#include <Core/Algorithms/Base/AlgorithmFwd.h>
+#include <Core/Algorithms/Base/AlgorithmBase.h>
 #include <Dataflow/Network/NetworkFwd.h>
 #include <Dataflow/Network/ModuleInterface.h>
 #include <Dataflow/Network/ModuleStateInterface.h>
@@ -51,6 +51,23 @@ namespace SCIRun {
 namespace Dataflow {
 namespace Networks {
 
+  /// What Module::algo() hands out: forwards to the module's algorithm, and traces each run
+  /// with the profiler so it shows up nested inside the module's execution.
+  class SCISHARE TracedAlgorithm
+  {
+  public:
+    explicit TracedAlgorithm(Core::Algorithms::AlgorithmBase& algo) : algo_(algo) {}
+    Core::Algorithms::AlgorithmOutput run(const Core::Algorithms::AlgorithmInput& input) const;
+    bool set(const Core::Algorithms::AlgorithmParameterName& key, const Core::Algorithms::AlgorithmParameter::Value& value) const { return algo_.set(key, value); }
+    const Core::Algorithms::AlgorithmParameter& get(const Core::Algorithms::AlgorithmParameterName& key) const { return algo_.get(key); }
+    bool setOption(const Core::Algorithms::AlgorithmParameterName& key, const std::string& value) const { return algo_.setOption(key, value); }
+    bool getOption(const Core::Algorithms::AlgorithmParameterName& key, std::string& value) const { return algo_.getOption(key, value); }
+    std::string getOption(const Core::Algorithms::AlgorithmParameterName& key) const { return algo_.getOption(key); }
+    operator Core::Algorithms::AlgorithmBase&() const { return algo_; }
+  private:
+    Core::Algorithms::AlgorithmBase& algo_;
+  };
+
   class SCISHARE Module : public ModuleInterface,
     public Core::Logging::LegacyLoggerInterface,
     public StateChangeObserver,
@@ -113,6 +130,8 @@ namespace Networks {
     std::string get_packagename() const;
     ModuleId id() const override;
     bool isDeprecated() const override { return false; }
+    // Modules whose outputs only depend on their state and inputs can reuse earlier outputs, see ModuleOutputCache
+    virtual bool isMemoizable() const { return false; }
     std::string replacementModuleName() const override { return ""; }
     ModuleReexecutionStrategyHandle getReexecutionStrategy() const override final;
     void setReexecutionStrategy(ModuleReexecutionStrategyHandle caching) override final;
@@ -157,7 +176,7 @@ namespace Networks {
     template <class T, size_t N>
     void sendOutputFromAlgorithm(const StaticPortName<T,N>& port, const Core::Algorithms::AlgorithmOutput& output);
 
-    Core::Algorithms::AlgorithmBase& algo();
+    TracedAlgorithm algo();
 
     void setStateBoolFromAlgo(const Core::Algorithms::AlgorithmParameterName& name);
     void setStateIntFromAlgo(const Core::Algorithms::AlgorithmParameterName& name);
@@ -0,0 +1,620 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Dataflow/Network/ModuleOutputCache.h>
+#include <Core/Datatypes/Datatype.h>
+#include <Core/Datatypes/Matrix.h>
+#include <Core/Persistent/Pstreams.h>
+#include <Core/Thread/Mutex.h>
+#include <Core/Logging/Log.h>
+#include <boost/filesystem.hpp>
+#include <boost/variant/apply_visitor.hpp>
+#include <boost/variant/static_visitor.hpp>
+#include <boost/weak_ptr.hpp>
+#include <list>
+#include <unordered_map>
+
+using namespace SCIRun;
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Thread;
+using namespace SCIRun::Core::Logging;
+
+CORE_SINGLETON_IMPLEMENTATION(ModuleOutputCache)
+
+namespace
+{
+  // bump when the key or the file layout changes
+  const char* cacheFormat = "SCIRun module output cache 1";
+  const char* fileExtension = ".cache";
+
+  struct ContentHash
+  {
+    std::string digest;
+    unsigned long long bytes;
+  };
+
+  // Serializes state values into a hash stream
+  class HashVariableValue : public boost::static_visitor<>
+  {
+  public:
+    explicit HashVariableValue(HashPiostream& stream) : stream_(stream) {}
+
+    void operator()(int x) const { int tag = 0; stream_.io(tag); stream_.io(x); }
+    void operator()(double x) const { int tag = 1; stream_.io(tag); stream_.io(x); }
+    void operator()(std::string x) const { int tag = 2; stream_.io(tag); stream_.io(x); }
+    void operator()(bool x) const { int tag = 3; stream_.io(tag); stream_.io(x); }
+    void operator()(const AlgoOption& x) const
+    {
+      int tag = 4;
+      stream_.io(tag);
+      std::string option = x.option_;
+      stream_.io(option);
+      unsigned long long n = x.options_.size();
+      stream_.io(n);
+      for (auto o : x.options_)
+        stream_.io(o);
+    }
+    void operator()(const Variable::List& x) const
+    {
+      int tag = 5;
+      stream_.io(tag);
+      unsigned long long n = x.size();
+      stream_.io(n);
+      for (const auto& v : x)
+      {
+        std::string name = v.name().name();
+        stream_.io(name);
+        boost::apply_visitor(*this, v.value());
+      }
+    }
+  private:
+    HashPiostream& stream_;
+  };
+
+  // Base type of everything that is read back from the cache files
+  const PersistentTypeID& datatypeTypeId()
+  {
+    static PersistentTypeID id = []()
+    {
+      // Matrix types derive from Datatype through MatrixBase, a template whose type id is
+      // only registered where it is used
+      (void)MatrixBase<double>::type_id;
+      PersistentTypeID t;
+      t.type = "Datatype";
+      return t;
+    }();
+    return id;
+  }
+}
+
+namespace SCIRun {
+namespace Dataflow {
+namespace Networks {
+
+  class ModuleOutputCacheImpl
+  {
+  public:
+    ModuleOutputCacheImpl() : lock_("ModuleOutputCache"), hashLock_("ModuleOutputCacheHashes"), prunedSize_(0) {}
+
+    boost::optional<ContentHash> contentHash(const DatatypeHandle& data);
+    void indexDirectory();
+    boost::filesystem::path entryPath(const std::string& key) const;
+    bool write(const boost::filesystem::path& file, const ModuleOutputCache::Outputs& outputs) const;
+    boost::optional<ModuleOutputCache::Outputs> read(const boost::filesystem::path& file) const;
+    void insertInMemory(const std::string& key, const ModuleOutputCache::Outputs& outputs, unsigned long long bytes);
+    void insertOnDisk(const std::string& key, unsigned long long bytes);
+    void removeFromDisk(const std::string& key);
+    void evict();
+
+    struct MemoryEntry
+    {
+      ModuleOutputCache::Outputs outputs;
+      unsigned long long bytes;
+      std::list<std::string>::iterator position;
+    };
+    struct DiskEntry
+    {
+      unsigned long long bytes;
+      std::list<std::string>::iterator position;
+    };
+    struct HashRecord
+    {
+      boost::weak_ptr<Datatype> data;
+      ContentHash hash;
+    };
+
+    mutable Mutex lock_;
+    ModuleOutputCache::Settings settings_;
+    ModuleOutputCache::Statistics stats_;
+    // most recently used first
+    std::list<std::string> memoryOrder_, diskOrder_;
+    std::unordered_map<std::string, MemoryEntry> memory_;
+    std::unordered_map<std::string, DiskEntry> disk_;
+
+    Mutex hashLock_;
+    std::unordered_map<Datatype::id_type, HashRecord> hashes_;
+    size_t prunedSize_;
+  };
+
+}}}
+
+boost::optional<ContentHash> ModuleOutputCacheImpl::contentHash(const DatatypeHandle& data)
+{
+  {
+    Guard g(hashLock_.get());
+    auto it = hashes_.find(data->id());
+    if (it != hashes_.end() && it->second.data.lock() == data)
+      return it->second.hash;
+  }
+
+  HashPiostream stream;
+  data->io(stream);
+  if (stream.error() || 0 == stream.classes())
+    return boost::none;
+
+  ContentHash hash { stream.digest(), stream.bytes() };
+  {
+    Guard g(hashLock_.get());
+    hashes_[data->id()] = HashRecord { data, hash };
+    // forget datatypes that no longer exist, now and then
+    if (hashes_.size() > 2 * prunedSize_ + 64)
+    {
+      for (auto it = hashes_.begin(); it != hashes_.end();)
+      {
+        if (it->second.data.expired())
+          it = hashes_.erase(it);
+        else
+          ++it;
+      }
+      prunedSize_ = hashes_.size();
+    }
+  }
+  return hash;
+}
+
+boost::filesystem::path ModuleOutputCacheImpl::entryPath(const std::string& key) const
+{
+  return settings_.directory / (key + fileExtension);
+}
+
+void ModuleOutputCacheImpl::indexDirectory()
+{
+  diskOrder_.clear();
+  disk_.clear();
+  if (settings_.directory.empty())
+    return;
+
+  namespace fs = boost::filesystem;
+  boost::system::error_code ec;
+  fs::create_directories(settings_.directory, ec);
+  if (ec)
+  {
+    LOG_DEBUG("Output cache directory {} cannot be created: {}", settings_.directory.string(), ec.message());
+    return;
+  }
+
+  std::vector<std::pair<std::time_t, fs::path>> files;
+  for (fs::directory_iterator it(settings_.directory, ec), end; !ec && it != end; it.increment(ec))
+  {
+    if (fs::is_regular_file(it->path()) && it->path().extension() == fileExtension)
+      files.emplace_back(fs::last_write_time(it->path()), it->path());
+  }
+  std::sort(files.begin(), files.end(), [](const std::pair<std::time_t, fs::path>& a, const std::pair<std::time_t, fs::path>& b) { return a.first > b.first; });
+
+  for (const auto& file : files)
+  {
+    diskOrder_.push_back(file.second.stem().string());
+    disk_[diskOrder_.back()] = DiskEntry { fs::file_size(file.second), std::prev(diskOrder_.end()) };
+    stats_.diskBytes += disk_[diskOrder_.back()].bytes;
+  }
+  stats_.diskEntries = disk_.size();
+  evict();
+}
+
+bool ModuleOutputCacheImpl::write(const boost::filesystem::path& file, const ModuleOutputCache::Outputs& outputs) const
+{
+  namespace fs = boost::filesystem;
+  // written under a temporary name, so other readers never see half a file
+  auto temporary = file;
+  temporary += fs::unique_path(".%%%%-%%%%-%%%%.tmp");
+  {
+    auto stream = auto_ostream(temporary.string(), "Binary");
+    if (!stream || stream->error())
+      return false;
+
+    std::string format = cacheFormat;
+    stream->io(format);
+    int count = static_cast<int>(outputs.size());
+    stream->io(count);
+    for (const auto& output : outputs)
+    {
+      std::string name = output.first.name;
+      stream->io(name);
+      unsigned long long index = output.first.id;
+      stream->io(index);
+      PersistentHandle data = output.second;
+      stream->io(data, datatypeTypeId());
+    }
+    if (stream->error())
+    {
+      stream.reset();
+      boost::system::error_code ec;
+      fs::remove(temporary, ec);
+      return false;
+    }
+  }
+  boost::system::error_code ec;
+  fs::rename(temporary, file, ec);
+  if (ec)
+    fs::remove(temporary, ec);
+  return !ec;
+}
+
+boost::optional<ModuleOutputCache::Outputs> ModuleOutputCacheImpl::read(const boost::filesystem::path& file) const
+{
+  try
+  {
+    auto stream = auto_istream(file.string());
+    if (!stream || stream->error())
+      return boost::none;
+
+    std::string format;
+    stream->io(format);
+    if (format != cacheFormat)
+      return boost::none;
+    int count = 0;
+    stream->io(count);
+
+    ModuleOutputCache::Outputs outputs;
+    for (int i = 0; i < count && !stream->error(); ++i)
+    {
+      std::string name;
+      stream->io(name);
+      unsigned long long index = 0;
+      stream->io(index);
+      PersistentHandle data;
+      stream->io(data, datatypeTypeId());
+      auto datatype = boost::dynamic_pointer_cast<Datatype>(data);
+      if (!datatype)
+        return boost::none;
+      outputs[PortId(index, name)] = datatype;
+    }
+    if (stream->error())
+      return boost::none;
+    return outputs;
+  }
+  catch (std::exception& e)
+  {
+    LOG_DEBUG("Output cache file {} cannot be read: {}", file.string(), e.what());
+    return boost::none;
+  }
+}
+
+void ModuleOutputCacheImpl::insertInMemory(const std::string& key, const ModuleOutputCache::Outputs& outputs, unsigned long long bytes)
+{
+  auto it = memory_.find(key);
+  if (it != memory_.end())
+  {
+    stats_.memoryBytes -= it->second.bytes;
+    memoryOrder_.erase(it->second.position);
+    memory_.erase(it);
+  }
+  // larger than the whole cache: kept on disk only
+  if (bytes > settings_.memoryLimitBytes)
+    return;
+  memoryOrder_.push_front(key);
+  memory_[key] = MemoryEntry { outputs, bytes, memoryOrder_.begin() };
+  stats_.memoryBytes += bytes;
+}
+
+void ModuleOutputCacheImpl::insertOnDisk(const std::string& key, unsigned long long bytes)
+{
+  auto it = disk_.find(key);
+  if (it != disk_.end())
+  {
+    stats_.diskBytes -= it->second.bytes;
+    diskOrder_.erase(it->second.position);
+    disk_.erase(it);
+  }
+  diskOrder_.push_front(key);
+  disk_[key] = DiskEntry { bytes, diskOrder_.begin() };
+  stats_.diskBytes += bytes;
+}
+
+void ModuleOutputCacheImpl::removeFromDisk(const std::string& key)
+{
+  auto it = disk_.find(key);
+  if (it == disk_.end())
+    return;
+  boost::system::error_code ec;
+  boost::filesystem::remove(entryPath(key), ec);
+  stats_.diskBytes -= it->second.bytes;
+  diskOrder_.erase(it->second.position);
+  disk_.erase(it);
+}
+
+void ModuleOutputCacheImpl::evict()
+{
+  while (stats_.memoryBytes > settings_.memoryLimitBytes && !memoryOrder_.empty())
+  {
+    auto it = memory_.find(memoryOrder_.back());
+    stats_.memoryBytes -= it->second.bytes;
+    memory_.erase(it);
+    memoryOrder_.pop_back();
+    ++stats_.memoryEvictions;
+  }
+  while (stats_.diskBytes > settings_.diskLimitBytes && !diskOrder_.empty())
+  {
+    removeFromDisk(diskOrder_.back());
+    ++stats_.diskEvictions;
+  }
+  stats_.memoryEntries = memory_.size();
+  stats_.diskEntries = disk_.size();
+}
+
+ModuleOutputCache::Settings::Settings() :
+  enabled(false),
+  memoryLimitBytes(1ull << 30),
+  diskLimitBytes(10ull << 30)
+{
+}
+
+ModuleOutputCache::Statistics::Statistics() :
+  memoryHits(0), diskHits(0), misses(0), stores(0), uncacheable(0),
+  memoryEvictions(0), diskEvictions(0), memoryEntries(0), diskEntries(0),
+  memoryBytes(0), diskBytes(0)
+{
+}
+
+double ModuleOutputCache::Statistics::hitRate() const
+{
+  const auto lookups = memoryHits + diskHits + misses;
+  return lookups > 0 ? static_cast<double>(memoryHits + diskHits) / lookups : 0.0;
+}
+
+ModuleOutputCache::ModuleOutputCache() : impl_(new ModuleOutputCacheImpl)
+{
+}
+
+ModuleOutputCache::ModuleOutputCache(const Settings& settings) : impl_(new ModuleOutputCacheImpl)
+{
+  configure(settings);
+}
+
+ModuleOutputCache::~ModuleOutputCache()
+{
+}
+
+void ModuleOutputCache::configure(const Settings& settings)
+{
+  Guard g(impl_->lock_.get());
+  const bool newDirectory = settings.directory != impl_->settings_.directory;
+  impl_->settings_ = settings;
+  if (newDirectory)
+  {
+    impl_->memoryOrder_.clear();
+    impl_->memory_.clear();
+    impl_->stats_.memoryBytes = 0;
+    impl_->stats_.diskBytes = 0;
+    impl_->indexDirectory();
+  }
+  impl_->evict();
+}
+
+ModuleOutputCache::Settings ModuleOutputCache::settings() const
+{
+  Guard g(impl_->lock_.get());
+  return impl_->settings_;
+}
+
+bool ModuleOutputCache::enabled() const
+{
+  Guard g(impl_->lock_.get());
+  return impl_->settings_.enabled;
+}
+
+boost::optional<std::string> ModuleOutputCache::key(const std::string& moduleType, const std::vector<Variable>& state, const Inputs& inputs)
+{
+  HashPiostream stream;
+  std::string text = cacheFormat;
+  stream.io(text);
+  text = moduleType;
+  stream.io(text);
+
+  HashVariableValue hashValue(stream);
+  for (const auto& var : state)
+  {
+    text = var.name().name();
+    stream.io(text);
+    boost::apply_visitor(hashValue, var.value());
+    auto data = var.getDatatype();
+    int hasData = data ? 1 : 0;
+    stream.io(hasData);
+    if (data)
+    {
+      auto hash = impl_->contentHash(data);
+      if (!hash)
+        return boost::none;
+      stream.io(hash->digest);
+    }
+  }
+
+  for (const auto& input : inputs)
+  {
+    text = input.first.name;
+    stream.io(text);
+    unsigned long long index = input.first.id;
+    stream.io(index);
+    int connected = input.second ? 1 : 0;
+    stream.io(connected);
+    if (!input.second)
+      continue;
+    int hasData = *input.second ? 1 : 0;
+    stream.io(hasData);
+    if (!*input.second)
+      continue;
+    auto hash = impl_->contentHash(*input.second);
+    if (!hash)
+      return boost::none;
+    stream.io(hash->digest);
+  }
+  return stream.digest();
+}
+
+boost::optional<ModuleOutputCache::Outputs> ModuleOutputCache::find(const std::string& key)
+{
+  boost::filesystem::path file;
+  {
+    Guard g(impl_->lock_.get());
+    auto inMemory = impl_->memory_.find(key);
+    if (inMemory != impl_->memory_.end())
+    {
+      impl_->memoryOrder_.splice(impl_->memoryOrder_.begin(), impl_->memoryOrder_, inMemory->second.position);
+      ++impl_->stats_.memoryHits;
+      return inMemory->second.outputs;
+    }
+    if (impl_->disk_.find(key) == impl_->disk_.end())
+    {
+      ++impl_->stats_.misses;
+      return boost::none;
+    }
+    file = impl_->entryPath(key);
+  }
+
+  // outside the lock, other modules keep using the cache meanwhile
+  auto outputs = impl_->read(file);
+  unsigned long long bytes = 0;
+  if (outputs)
+  {
+    for (const auto& output : *outputs)
+    {
+      auto hash = impl_->contentHash(output.second);
+      bytes += hash ? hash->bytes : 0;
+    }
+    boost::system::error_code ec;
+    boost::filesystem::last_write_time(file, std::time(nullptr), ec);
+  }
+
+  Guard g(impl_->lock_.get());
+  auto onDisk = impl_->disk_.find(key);
+  if (!outputs)
+  {
+    LOG_DEBUG("Output cache entry {} is unreadable, removing it", key);
+    impl_->removeFromDisk(key);
+    ++impl_->stats_.misses;
+    impl_->stats_.diskEntries = impl_->disk_.size();
+    return boost::none;
+  }
+  if (onDisk != impl_->disk_.end())
+    impl_->diskOrder_.splice(impl_->diskOrder_.begin(), impl_->diskOrder_, onDisk->second.position);
+  impl_->insertInMemory(key, *outputs, bytes);
+  impl_->evict();
+  ++impl_->stats_.diskHits;
+  return outputs;
+}
+
+bool ModuleOutputCache::store(const std::string& key, const Outputs& outputs)
+{
+  // hashing the outputs sizes them, and downstream modules find their input hashes ready
+  unsigned long long bytes = 0;
+  for (const auto& output : outputs)
+  {
+    if (!output.second)
+      continue;
+    auto hash = impl_->contentHash(output.second);
+    if (!hash)
+    {
+      recordUncacheable();
+      return false;
+    }
+    bytes += hash->bytes;
+  }
+
+  boost::filesystem::path file;
+  {
+    Guard g(impl_->lock_.get());
+    if (!impl_->settings_.directory.empty() && impl_->disk_.find(key) == impl_->disk_.end())
+      file = impl_->entryPath(key);
+  }
+
+  unsigned long long fileBytes = 0;
+  if (!file.empty())
+  {
+    if (impl_->write(file, outputs))
+    {
+      boost::system::error_code ec;
+      fileBytes = boost::filesystem::file_size(file, ec);
+    }
+    else
+      file.clear();
+  }
+
+  Guard g(impl_->lock_.get());
+  impl_->insertInMemory(key, outputs, bytes);
+  if (!file.empty())
+    impl_->insertOnDisk(key, fileBytes);
+  impl_->evict();
+  ++impl_->stats_.stores;
+  return true;
+}
+
+void ModuleOutputCache::recordUncacheable()
+{
+  Guard g(impl_->lock_.get());
+  ++impl_->stats_.uncacheable;
+}
+
+ModuleOutputCache::Statistics ModuleOutputCache::statistics() const
+{
+  Guard g(impl_->lock_.get());
+  return impl_->stats_;
+}
+
+void ModuleOutputCache::resetStatistics()
+{
+  Guard g(impl_->lock_.get());
+  Statistics fresh;
+  fresh.memoryEntries = impl_->stats_.memoryEntries;
+  fresh.memoryBytes = impl_->stats_.memoryBytes;
+  fresh.diskEntries = impl_->stats_.diskEntries;
+  fresh.diskBytes = impl_->stats_.diskBytes;
+  impl_->stats_ = fresh;
+}
+
+void ModuleOutputCache::clear()
+{
+  Guard g(impl_->lock_.get());
+  impl_->memoryOrder_.clear();
+  impl_->memory_.clear();
+  impl_->stats_.memoryBytes = 0;
+  while (!impl_->diskOrder_.empty())
+    impl_->removeFromDisk(impl_->diskOrder_.back());
+  impl_->evict();
+}
@@ -0,0 +1,119 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DATAFLOW_NETWORK_MODULE_OUTPUT_CACHE_H
+#define DATAFLOW_NETWORK_MODULE_OUTPUT_CACHE_H
+
+#include <map>
+#include <vector>
+#include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/optional.hpp>
+#include <Core/Algorithms/Base/Variable.h>
+#include <Core/Datatypes/DatatypeFwd.h>
+#include <Core/Utils/Singleton.h>
+#include <Dataflow/Network/ModuleDescription.h>
+#include <Dataflow/Network/share.h>
+
+namespace SCIRun {
+namespace Dataflow {
+namespace Networks {
+
+  /// Memoizes module outputs by content. The key of an execution is a hash of the module type,
+  /// its state and the contents of its inputs, so a module whose state is set back to an earlier
+  /// value, or that sees the same data again after a network is reloaded, can resend the outputs
+  /// it computed then instead of executing.
+  ///
+  /// Entries are kept in memory up to a size limit, least recently used first out. With a cache
+  /// directory every entry is also written to disk, where it outlives the application; disk
+  /// entries are bounded the same way. Contents are hashed and saved through the persistent io
+  /// of the datatypes, so inputs and outputs without one (geometry, for instance) are not cached.
+  ///
+  /// Hashes are remembered per datatype object: datatypes must not be modified after they have
+  /// been sent, which the ports already assume.
+  class SCISHARE ModuleOutputCache : boost::noncopyable
+  {
+    CORE_SINGLETON(ModuleOutputCache)
+
+  public:
+    struct SCISHARE Settings
+    {
+      Settings();
+      bool enabled;
+      unsigned long long memoryLimitBytes;
+      /// Empty for a cache in memory only
+      boost::filesystem::path directory;
+      unsigned long long diskLimitBytes;
+    };
+
+    struct SCISHARE Statistics
+    {
+      Statistics();
+      size_t memoryHits, diskHits, misses;
+      size_t stores;
+      /// Executions that could not be keyed or whose outputs could not be stored
+      size_t uncacheable;
+      size_t memoryEvictions, diskEvictions;
+      size_t memoryEntries, diskEntries;
+      unsigned long long memoryBytes, diskBytes;
+
+      double hitRate() const;
+    };
+
+    typedef std::vector<std::pair<PortId, Core::Datatypes::DatatypeHandleOption>> Inputs;
+    typedef std::map<PortId, Core::Datatypes::DatatypeHandle> Outputs;
+
+    ModuleOutputCache();
+    explicit ModuleOutputCache(const Settings& settings);
+    ~ModuleOutputCache();
+
+    /// Changing the directory drops the memory entries and indexes the new directory.
+    void configure(const Settings& settings);
+    Settings settings() const;
+    bool enabled() const;
+
+    /// None if an input has no persistent representation. Unconnected inputs (no handle) and
+    /// null data are told apart.
+    boost::optional<std::string> key(const std::string& moduleType, const std::vector<Core::Algorithms::Variable>& state, const Inputs& inputs);
+    boost::optional<Outputs> find(const std::string& key);
+    /// Returns false if an output has no persistent representation.
+    bool store(const std::string& key, const Outputs& outputs);
+    void recordUncacheable();
+
+    Statistics statistics() const;
+    void resetStatistics();
+    /// Removes all entries, including the ones on disk.
+    void clear();
+
+  private:
+    boost::shared_ptr<class ModuleOutputCacheImpl> impl_;
+  };
+
+}}}
+
+#endif
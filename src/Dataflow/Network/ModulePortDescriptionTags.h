@@ -48,6 +48,7 @@ namespace Modules
 {
   struct SCISHARE MatrixPortTag {};
   struct SCISHARE ComplexMatrixPortTag {};
+  struct SCISHARE MatrixStreamPortTag {};
   struct SCISHARE ScalarPortTag {};
   struct SCISHARE StringPortTag {};
   struct SCISHARE FieldPortTag {};
@@ -325,6 +326,7 @@ namespace Modules
   PORT_SPEC(Bundle);
   PORT_SPEC(Nrrd);
   PORT_SPEC(ComplexMatrix);
+  PORT_SPEC(MatrixStream);
   PORT_SPEC(Datatype);
 
 #define ATTACH_NAMESPACE(type) Core::Datatypes::type
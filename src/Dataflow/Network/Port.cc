@@ -35,11 +35,30 @@
 #include <Dataflow/Network/ModuleDescription.h>
 #include <Dataflow/Network/DataflowInterfaces.h>
 #include <Core/Logging/Log.h>
+#include <Core/Logging/Profiler.h>
 
 using namespace SCIRun::Dataflow::Networks;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Logging;
 
+namespace
+{
+  std::string traceName(const Port& port, const char* direction)
+  {
+    if (!Profiler::Instance().enabled())
+      return std::string();
+    return port.getUnderlyingModuleId().id_ + " " + direction + " " + port.get_portname();
+  }
+
+  // sizes of fields take several virtual calls, so they are only asked for while tracing
+  long long traceBytes(const DatatypeHandle& data)
+  {
+    if (!Profiler::Instance().enabled())
+      return -1;
+    return data ? static_cast<long long>(data->sizeInBytes()) : 0;
+  }
+}
+
 Port::Port(ModuleInterface* module, const ConstructionParams& params)
   : module_(module), index_(0), id_(params.id_), typeName_(params.type_name), portName_(params.port_name), colorName_(PortColorLookup::toColor(params.type_name)),
   connectionCountIncreasedFlag_(false)
@@ -132,8 +151,12 @@ DatatypeHandleOption InputPort::getData() const
   if (0 == nconnections())
     return DatatypeHandleOption();
 
+  ScopedProfile profile("port", traceName(*this, "receive"));
   sink_->waitForData();
-  return sink_->receive();
+  auto data = sink_->receive();
+  if (data)
+    profile.setBytes(traceBytes(*data));
+  return data;
 }
 
 void InputPort::attach(Connection* conn)
@@ -219,6 +242,8 @@ void OutputPort::sendData(DatatypeHandle data)
   if (0 == nconnections())
     return;
 
+  ScopedProfile profile("port", traceName(*this, "send"));
+  profile.setBytes(traceBytes(data));
   for (auto c : connections_)
   {
     if (c && c->iport_)
@@ -0,0 +1,266 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   License for the specific language governing rights and limitations under
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+#include <Dataflow/Network/ModuleOutputCache.h>
+#include <Dataflow/Network/Module.h>
+#include <Dataflow/Network/Port.h>
+#include <Dataflow/Network/SimpleSourceSink.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/MatrixIO.h>
+#include <Core/Datatypes/String.h>
+#include <boost/filesystem.hpp>
+
+using namespace SCIRun;
+using namespace SCIRun::Dataflow::Networks;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms;
+
+namespace
+{
+  DenseMatrixHandle matrix(int n, double scale)
+  {
+    DenseMatrixHandle m(new DenseMatrix(n, n));
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < n; j++)
+        (*m)(i, j) = scale * (i + 0.5 * j);
+    return m;
+  }
+
+  ModuleOutputCache::Inputs inputs(DatatypeHandleOption data)
+  {
+    return { { PortId(0, "Matrix"), data } };
+  }
+
+  ModuleOutputCache::Outputs outputs(DatatypeHandle data)
+  {
+    return { { PortId(0, "Result"), data } };
+  }
+
+  std::vector<Variable> state(double value)
+  {
+    return { makeVariable("Tolerance", value), makeVariable("Method", std::string("cg")) };
+  }
+
+  ModuleOutputCache::Settings inMemory(unsigned long long limit = 1ull << 30)
+  {
+    ModuleOutputCache::Settings settings;
+    settings.enabled = true;
+    settings.memoryLimitBytes = limit;
+    return settings;
+  }
+
+  // Datatype without a persistent representation
+  class Unsaved : public Datatype
+  {
+  public:
+    Datatype* clone() const override { return new Unsaved(*this); }
+    std::string dynamic_type_name() const override { return "Unsaved"; }
+  };
+
+  class ScopedDirectory
+  {
+  public:
+    ScopedDirectory() : path(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("outputcache-%%%%-%%%%")) {}
+    ~ScopedDirectory() { boost::system::error_code ec; boost::filesystem::remove_all(path, ec); }
+    const boost::filesystem::path path;
+  };
+}
+
+TEST(ModuleOutputCacheTests, KeysFollowContentNotObjects)
+{
+  ModuleOutputCache cache(inMemory());
+  auto key = cache.key("Math::SolveLinearSystem", state(1e-6), inputs(DatatypeHandle(matrix(10, 1.0))));
+  ASSERT_TRUE(!!key);
+  EXPECT_EQ(32u, key->size());
+
+  EXPECT_EQ(*key, *cache.key("Math::SolveLinearSystem", state(1e-6), inputs(DatatypeHandle(matrix(10, 1.0)))));
+
+  auto changed = matrix(10, 1.0);
+  (*changed)(3, 4) += 1e-12;
+  EXPECT_NE(*key, *cache.key("Math::SolveLinearSystem", state(1e-6), inputs(DatatypeHandle(changed))));
+  EXPECT_NE(*key, *cache.key("Math::SolveLinearSystem", state(1e-7), inputs(DatatypeHandle(matrix(10, 1.0)))));
+  EXPECT_NE(*key, *cache.key("Math::OtherModule", state(1e-6), inputs(DatatypeHandle(matrix(10, 1.0)))));
+
+  // unconnected and null inputs are different
+  auto unconnected = cache.key("Math::SolveLinearSystem", state(1e-6), inputs(boost::none));
+  auto null = cache.key("Math::SolveLinearSystem", state(1e-6), inputs(DatatypeHandle()));
+  ASSERT_TRUE(unconnected && null);
+  EXPECT_NE(*unconnected, *null);
+
+  EXPECT_FALSE(cache.key("Math::SolveLinearSystem", state(1e-6), inputs(DatatypeHandle(new Unsaved))));
+}
+
+TEST(ModuleOutputCacheTests, MemoryHitReturnsStoredOutputs)
+{
+  ModuleOutputCache cache(inMemory());
+  auto key = *cache.key("Test", state(1), inputs(DatatypeHandle(matrix(5, 1.0))));
+  EXPECT_FALSE(cache.find(key));
+
+  auto result = matrix(5, 2.0);
+  EXPECT_TRUE(cache.store(key, outputs(result)));
+  auto found = cache.find(key);
+  ASSERT_TRUE(!!found);
+  EXPECT_EQ(result, found->at(PortId(0, "Result")));
+
+  EXPECT_FALSE(cache.store("other", outputs(DatatypeHandle(new Unsaved))));
+
+  auto stats = cache.statistics();
+  EXPECT_EQ(1u, stats.memoryHits);
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(1u, stats.stores);
+  EXPECT_EQ(1u, stats.uncacheable);
+  EXPECT_EQ(1u, stats.memoryEntries);
+  EXPECT_GE(stats.memoryBytes, 25 * sizeof(double));
+  EXPECT_DOUBLE_EQ(0.5, stats.hitRate());
+}
+
+TEST(ModuleOutputCacheTests, LeastRecentlyUsedLeavesMemoryFirst)
+{
+  // room for two 20x20 matrices, not three
+  ModuleOutputCache cache(inMemory(2 * 400 * sizeof(double) + 1000));
+  cache.store("a", outputs(matrix(20, 1.0)));
+  cache.store("b", outputs(matrix(20, 2.0)));
+  EXPECT_TRUE(!!cache.find("a"));
+  cache.store("c", outputs(matrix(20, 3.0)));
+
+  EXPECT_TRUE(!!cache.find("a"));
+  EXPECT_FALSE(cache.find("b"));
+  EXPECT_TRUE(!!cache.find("c"));
+  EXPECT_EQ(1u, cache.statistics().memoryEvictions);
+  EXPECT_EQ(2u, cache.statistics().memoryEntries);
+}
+
+TEST(ModuleOutputCacheTests, DiskEntriesOutliveTheCache)
+{
+  ScopedDirectory dir;
+  auto settings = inMemory();
+  settings.directory = dir.path;
+
+  std::string key;
+  {
+    ModuleOutputCache cache(settings);
+    key = *cache.key("Test", state(1), inputs(DatatypeHandle(matrix(8, 1.0))));
+    ModuleOutputCache::Outputs results = outputs(matrix(8, 3.0));
+    results[PortId(1, "Name")] = boost::make_shared<String>("eight");
+    cache.store(key, results);
+    EXPECT_EQ(1u, cache.statistics().diskEntries);
+  }
+
+  ModuleOutputCache restarted(settings);
+  EXPECT_EQ(1u, restarted.statistics().diskEntries);
+  EXPECT_EQ(key, *restarted.key("Test", state(1), inputs(DatatypeHandle(matrix(8, 1.0)))));
+  auto found = restarted.find(key);
+  ASSERT_TRUE(!!found);
+  ASSERT_EQ(2u, found->size());
+  auto m = boost::dynamic_pointer_cast<DenseMatrix>(found->at(PortId(0, "Result")));
+  ASSERT_TRUE(!!m);
+  EXPECT_EQ(0, (*m - *matrix(8, 3.0)).norm());
+  auto s = boost::dynamic_pointer_cast<String>(found->at(PortId(1, "Name")));
+  ASSERT_TRUE(!!s);
+  EXPECT_EQ("eight", s->value());
+  EXPECT_EQ(1u, restarted.statistics().diskHits);
+
+  // now in memory as well
+  restarted.find(key);
+  EXPECT_EQ(1u, restarted.statistics().memoryHits);
+
+  restarted.clear();
+  EXPECT_TRUE(boost::filesystem::is_empty(dir.path));
+}
+
+TEST(ModuleOutputCacheTests, DiskLimitRemovesOldestFiles)
+{
+  ScopedDirectory dir;
+  auto settings = inMemory(0);
+  settings.directory = dir.path;
+  settings.diskLimitBytes = 2 * 400 * sizeof(double) + 2000;
+
+  ModuleOutputCache cache(settings);
+  cache.store("a", outputs(matrix(20, 1.0)));
+  cache.store("b", outputs(matrix(20, 2.0)));
+  cache.store("c", outputs(matrix(20, 3.0)));
+
+  auto stats = cache.statistics();
+  EXPECT_EQ(0u, stats.memoryEntries);
+  EXPECT_EQ(2u, stats.diskEntries);
+  EXPECT_EQ(1u, stats.diskEvictions);
+  EXPECT_FALSE(boost::filesystem::exists(dir.path / "a.cache"));
+  EXPECT_FALSE(cache.find("a"));
+  EXPECT_TRUE(!!cache.find("c"));
+}
+
+namespace
+{
+  // Output depends on nothing, so every execution after the first can be skipped
+  class Constant : public Module
+  {
+  public:
+    explicit Constant(bool memoizable) : Module(ModuleLookupInfo("Constant", "Test", "SCIRun"), false), executions(0), memoizable_(memoizable)
+    {
+      add_output_port(boost::make_shared<OutputPort>(this, Port::ConstructionParams(PortId(0, "Output"), "Matrix", false), boost::make_shared<SimpleSource>()));
+    }
+    void execute() override
+    {
+      ++executions;
+      send_output_handle(PortId(0, "Output"), matrix(3, 1.0));
+    }
+    void setStateDefaults() override {}
+    bool isMemoizable() const override { return memoizable_; }
+    int executions;
+  private:
+    bool memoizable_;
+  };
+}
+
+TEST(ModuleOutputCacheTests, MemoizableModuleSkipsRepeatedExecution)
+{
+  auto& cache = ModuleOutputCache::Instance();
+  cache.configure(inMemory());
+  cache.clear();
+  cache.resetStatistics();
+
+  Constant memoized(true);
+  EXPECT_TRUE(memoized.executeWithSignals());
+  EXPECT_TRUE(memoized.executeWithSignals());
+  EXPECT_EQ(1, memoized.executions);
+  EXPECT_EQ(1u, cache.statistics().memoryHits);
+  EXPECT_EQ(1u, cache.statistics().stores);
+
+  Constant plain(false);
+  plain.executeWithSignals();
+  plain.executeWithSignals();
+  EXPECT_EQ(2, plain.executions);
+
+  cache.configure(ModuleOutputCache::Settings());
+  Constant disabled(true);
+  disabled.executeWithSignals();
+  EXPECT_EQ(1, disabled.executions);
+  EXPECT_EQ(1u, cache.statistics().memoryHits);
+  cache.clear();
+}
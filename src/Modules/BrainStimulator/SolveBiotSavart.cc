@@ -56,6 +56,8 @@ void SolveBiotSavart::setStateDefaults()
 {
   auto state = get_state();
   setStateIntFromAlgo(Parameters::OutType);
+  setStateBoolFromAlgo(Parameters::UseTreeCode);
+  setStateDoubleFromAlgo(Parameters::TreeCodeOpeningAngle);
 }
 
 void SolveBiotSavart::execute()
@@ -67,6 +69,8 @@ void SolveBiotSavart::execute()
   if (oport_connected(VectorBField) || oport_connected(VectorAField))
   {
     setAlgoIntFromState(Parameters::OutType);
+    setAlgoBoolFromState(Parameters::UseTreeCode);
+    setAlgoDoubleFromState(Parameters::TreeCodeOpeningAngle);
 
     if (oport_connected(VectorBField) && oport_connected(VectorAField))
     {
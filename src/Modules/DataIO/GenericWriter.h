@@ -168,6 +168,10 @@ void GenericWriter<HType, PortTag, PortDescriber>::execute()
       {
         stream = auto_ostream(filename_, "Binary", getLogger());
       }
+      else if (filetype_ == "Compressed")
+      {
+        stream = auto_ostream(filename_, "Compressed", getLogger());
+      }
       else
       {
         stream = auto_ostream(filename_, "Text", getLogger());
@@ -0,0 +1,62 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MODULES_DATAIO_READMATRIXSTREAM_H
+#define MODULES_DATAIO_READMATRIXSTREAM_H
+
+#include <Dataflow/Network/Module.h>
+#include <Modules/DataIO/share.h>
+
+namespace SCIRun {
+namespace Modules {
+namespace DataIO {
+
+  /// Reads a matrix in any format with an import plugin (IGB, ECGSim, Matlab, text...) and
+  /// sends it as a stream of StreamBlockSize columns. These formats are read whole, so only
+  /// the downstream stages run in bounded memory; raw files can be streamed from disk
+  /// with ReadRawMatrixStream instead.
+  class SCISHARE ReadMatrixStream : public Dataflow::Networks::Module,
+    public Has1InputPort<StringPortTag>,
+    public Has1OutputPort<MatrixStreamPortTag>
+  {
+  public:
+    ReadMatrixStream();
+    virtual void execute() override;
+    virtual void setStateDefaults() override;
+
+    INPUT_PORT(0, Filename, String);
+    OUTPUT_PORT(0, Stream, MatrixStream);
+
+    static std::string fileTypeList();
+
+    MODULE_TRAITS_AND_INFO(ModuleHasUI)
+  };
+
+}}}
+
+#endif
@@ -0,0 +1,77 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Modules/DataIO/ReadRawMatrixStream.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Algorithms/DataIO/MatrixStreamIO.h>
+#include <Core/Datatypes/String.h>
+
+using namespace SCIRun::Modules::DataIO;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::DataIO;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Dataflow::Networks;
+
+MODULE_INFO_DEF(ReadRawMatrixStream, DataIO, SCIRun)
+
+ALGORITHM_PARAMETER_DEF(DataIO, StreamRows);
+ALGORITHM_PARAMETER_DEF(DataIO, StreamBlockSize);
+
+ReadRawMatrixStream::ReadRawMatrixStream() : Module(staticInfo_)
+{
+  INITIALIZE_PORT(Filename);
+  INITIALIZE_PORT(Stream);
+}
+
+void ReadRawMatrixStream::setStateDefaults()
+{
+  auto state = get_state();
+  state->setValue(Variables::Filename, std::string());
+  state->setValue(Parameters::StreamRows, 1);
+  state->setValue(Parameters::StreamBlockSize, 1000);
+}
+
+void ReadRawMatrixStream::execute()
+{
+  auto filenameInput = getOptionalInput(Filename);
+  if (needToExecute())
+  {
+    auto state = get_state();
+    if (filenameInput && *filenameInput)
+      state->setValue(Variables::Filename, (*filenameInput)->value());
+
+    const auto filename = state->getValue(Variables::Filename).toString();
+    const auto rows = state->getValue(Parameters::StreamRows).toInt();
+    const auto blockSize = state->getValue(Parameters::StreamBlockSize).toInt();
+    if (rows <= 0 || blockSize <= 0)
+      THROW_ALGORITHM_INPUT_ERROR("Number of rows and block size must be positive.");
+
+    sendOutput(Stream, streamMatrixFromRawFile(filename, rows, blockSize));
+  }
+}
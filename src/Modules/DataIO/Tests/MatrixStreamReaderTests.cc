@@ -0,0 +1,108 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include <Testing/ModuleTestBase/ModuleTestBase.h>
+#include <Modules/DataIO/ReadMatrixStream.h>
+#include <Modules/DataIO/ReadRawMatrixStream.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/MatrixStream.h>
+#include <Core/ImportExport/Matrix/MatrixIEPlugin.h>
+
+using namespace SCIRun;
+using namespace SCIRun::Testing;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::DataIO;
+using namespace SCIRun::Dataflow::Networks;
+
+namespace
+{
+  DenseMatrixHandle recording()
+  {
+    auto m = boost::make_shared<DenseMatrix>(3, 20);
+    for (int i = 0; i < 3; i++)
+      for (int t = 0; t < 20; t++)
+        (*m)(i, t) = i + 0.01 * t;
+    return m;
+  }
+
+  MatrixHandle readRecording(Core::Logging::LoggerHandle, const char*)
+  {
+    return recording();
+  }
+}
+
+class MatrixStreamReaderTests : public ModuleTest
+{
+};
+
+TEST_F(MatrixStreamReaderTests, ReadsAnyPluginFormatAsAStream)
+{
+  MatrixIEPluginLegacyAdapter plugin("StreamTestFormat", "*.tst", "", readRecording, nullptr);
+
+  auto read = makeModule("ReadMatrixStream");
+  read->get_state()->setValue(Variables::Filename, std::string("recording.tst"));
+  read->get_state()->setValue(Variables::FileTypeName, std::string("StreamTestFormat"));
+  read->get_state()->setValue(Parameters::StreamBlockSize, 8);
+  connectDummyOutputConnection(read, 0);
+  EXPECT_NO_THROW(read->execute());
+
+  auto stream = boost::dynamic_pointer_cast<MatrixStream>(getDataOnThisOutputPort(read, 0));
+  ASSERT_TRUE(stream != nullptr);
+  EXPECT_EQ(3, stream->nrows());
+  EXPECT_EQ(20, stream->ncols());
+  EXPECT_EQ(3, stream->numBlocks());
+  EXPECT_EQ(recording()->middleCols(16, 4), stream->block(2));
+}
+
+TEST_F(MatrixStreamReaderTests, StreamsARawFile)
+{
+  const auto path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("stream-%%%%-%%%%.raw");
+  {
+    const auto m = recording();
+    const Eigen::MatrixXd columns(*m);
+    std::ofstream out(path.string(), std::ios::binary);
+    out.write(reinterpret_cast<const char*>(columns.data()), columns.size() * sizeof(double));
+  }
+
+  auto read = makeModule("ReadRawMatrixStream");
+  read->get_state()->setValue(Variables::Filename, path.string());
+  read->get_state()->setValue(Parameters::StreamRows, 3);
+  read->get_state()->setValue(Parameters::StreamBlockSize, 5);
+  connectDummyOutputConnection(read, 0);
+  EXPECT_NO_THROW(read->execute());
+
+  auto stream = boost::dynamic_pointer_cast<MatrixStream>(getDataOnThisOutputPort(read, 0));
+  ASSERT_TRUE(stream != nullptr);
+  EXPECT_EQ(4, stream->numBlocks());
+  EXPECT_EQ(*recording(), *stream->toDense());
+  boost::filesystem::remove(path);
+}
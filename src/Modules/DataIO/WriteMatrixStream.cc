@@ -0,0 +1,64 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Modules/DataIO/WriteMatrixStream.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Algorithms/DataIO/MatrixStreamIO.h>
+
+using namespace SCIRun::Modules::DataIO;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::DataIO;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Dataflow::Networks;
+
+MODULE_INFO_DEF(WriteMatrixStream, DataIO, SCIRun)
+
+WriteMatrixStream::WriteMatrixStream() : Module(staticInfo_)
+{
+  INITIALIZE_PORT(Stream);
+}
+
+void WriteMatrixStream::setStateDefaults()
+{
+  get_state()->setValue(Variables::Filename, std::string());
+}
+
+void WriteMatrixStream::execute()
+{
+  auto stream = getRequiredInput(Stream);
+  if (needToExecute())
+  {
+    const auto filename = get_state()->getValue(Variables::Filename).toString();
+    if (filename.empty())
+      THROW_ALGORITHM_INPUT_ERROR("No filename specified.");
+
+    remark("Writing " + std::to_string(stream->numBlocks()) + " blocks of " + std::to_string(stream->blockSize()) + " columns to " + filename);
+    writeMatrixStreamToRawFile(*stream, filename);
+  }
+}
@@ -64,6 +64,7 @@ void ExtractIsosurface::setStateDefaults()
   setStateIntFromAlgo(Parameters::IsovalueQuantityFromField);
   setStateDoubleFromAlgo(Parameters::ManualMaximumIsovalue);
   setStateDoubleFromAlgo(Parameters::ManualMinimumIsovalue);
+  setStateBoolFromAlgo(Parameters::BuildCellIndex);
   get_state()->setValue(Parameters::IsovalueListString, std::string());
   get_state()->setValue(Parameters::IsovalueChoice, std::string("Single"));
 }
@@ -168,6 +169,7 @@ void ExtractIsosurface::execute()
     VariableList isos;
     std::transform(isoDoubles.begin(), isoDoubles.end(), std::back_inserter(isos), [](double x) { return makeVariable("iso", x); });
     algo().set(Parameters::Isovalues, isos);
+    setAlgoBoolFromState(Parameters::BuildCellIndex);
 
     auto output = algo().run(withInputData((InputField, field)));
     sendOutputFromAlgorithm(OutputField, output);
@@ -53,6 +53,7 @@ namespace SCIRun {
         INPUT_PORT(1, Conductivity_Table, Matrix);
         OUTPUT_PORT(0, Stiffness_Matrix, Matrix);
         OUTPUT_PORT(1, Stiffness_Matrix_Complex, ComplexSparseRowMatrix);
+        MEMOIZABLE_MODULE
         MODULE_TRAITS_AND_INFO(ModuleHasAlgorithm)
       };
 
@@ -68,6 +68,7 @@ void BuildBEMatrix::setStateDefaults()
   get_state()->setValue(Parameters::BoundaryConditionList, VariableList());
   get_state()->setValue(Parameters::OutsideConductivityList, VariableList());
   get_state()->setValue(Parameters::InsideConductivityList, VariableList());
+  get_state()->setValue(Parameters::UseHierarchicalMatrix, false);
 }
 
 void BuildBEMatrix::execute()
@@ -82,7 +83,9 @@ void BuildBEMatrix::execute()
     auto outsideConds = state->getValue(Parameters::OutsideConductivityList).toVector();
     auto insideConds = state->getValue(Parameters::InsideConductivityList).toVector();
 
-    BuildBEMatrixImpl impl(fieldNames, boundaryConditions, outsideConds, insideConds, this);
+    auto hierarchical = state->getValue(Parameters::UseHierarchicalMatrix).toBool();
+
+    BuildBEMatrixImpl impl(fieldNames, boundaryConditions, outsideConds, insideConds, this, hierarchical);
     MatrixHandle transferMatrix = impl.executeImpl(inputs);
     auto fieldTypes = impl.getInputTypes();
     state->setTransientValue(Parameters::FieldTypeList, fieldTypes);
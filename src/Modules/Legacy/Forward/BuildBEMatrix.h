@@ -51,6 +51,7 @@ namespace SCIRun {
         OUTPUT_PORT(0, BEM_Forward_Matrix, Matrix);
 
         LEGACY_BIOPSE_MODULE
+        MEMOIZABLE_MODULE
 
         MODULE_TRAITS_AND_INFO(ModuleHasUI)
       };
@@ -58,12 +58,14 @@ BuildBEMatrixImpl::BuildBEMatrixImpl(const VariableList& names,
   const VariableList& bdyConds,
   const VariableList& outside,
   const VariableList& inside,
-  LegacyLoggerInterface* log) : 
+  LegacyLoggerInterface* log,
+  bool hierarchical) :
   names_(names),
   bdyConds_(bdyConds),
   outside_(outside),
   inside_(inside),
-  log_(log)
+  log_(log),
+  hierarchical_(hierarchical)
 {
 
 }
@@ -129,7 +131,7 @@ MatrixHandle BuildBEMatrixImpl::executeImpl(const FieldList& inputs)
 
   // The specific BEM routine (2 so far) to be called is dependent on the inputs in the fields vector,
   // so we check for the conditions and call the appropriate routine:
-  auto BEMalgo = BEMAlgoImplFactory::create(fields);
+  auto BEMalgo = BEMAlgoImplFactory::create(fields, hierarchical_);
 
   if (!BEMalgo)
   {
@@ -77,6 +77,8 @@ void SolveInverseProblemWithTikhonov::setStateDefaults()
 	setStateDoubleFromAlgo(Parameters::LambdaSliderValue);
 	setStateIntFromAlgo(Parameters::regularizationSolutionSubcase);
 	setStateIntFromAlgo(Parameters::regularizationResidualSubcase);
+	setStateBoolFromAlgo(Parameters::UseSpectralDecomposition);
+	setStateIntFromAlgo(Parameters::SpectralRank);
 }
 // execute function
 void SolveInverseProblemWithTikhonov::execute()
@@ -108,6 +110,8 @@ void SolveInverseProblemWithTikhonov::execute()
     setAlgoDoubleFromState(Parameters::LambdaSliderValue);
     setAlgoIntFromState(Parameters::regularizationSolutionSubcase);
     setAlgoIntFromState(Parameters::regularizationResidualSubcase);
+    setAlgoBoolFromState(Parameters::UseSpectralDecomposition);
+    setAlgoIntFromState(Parameters::SpectralRank);
 
 		// run
 		auto output = algo().run( withInputData((ForwardMatrix, forward_matrix_h)(MeasuredPotentials,hMatrixMeasDat)(MeasuredPotentials,hMatrixMeasDat)(WeightingInSourceSpace,optionalAlgoInput(hMatrixRegMat))(WeightingInSensorSpace,optionalAlgoInput(hMatrixNoiseCov))) );
@@ -0,0 +1,71 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Modules/Math/GetMatrixStreamColumns.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Datatypes/MatrixStream.h>
+
+using namespace SCIRun::Modules::Math;
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Dataflow::Networks;
+
+MODULE_INFO_DEF(GetMatrixStreamColumns, Math, SCIRun)
+
+ALGORITHM_PARAMETER_DEF(Math, FirstColumn);
+ALGORITHM_PARAMETER_DEF(Math, NumberOfColumns);
+
+GetMatrixStreamColumns::GetMatrixStreamColumns() : Module(staticInfo_)
+{
+  INITIALIZE_PORT(InputStream);
+  INITIALIZE_PORT(OutputMatrix);
+}
+
+void GetMatrixStreamColumns::setStateDefaults()
+{
+  auto state = get_state();
+  state->setValue(Parameters::FirstColumn, 0);
+  state->setValue(Parameters::NumberOfColumns, 0);
+}
+
+void GetMatrixStreamColumns::execute()
+{
+  auto stream = getRequiredInput(InputStream);
+  if (needToExecute())
+  {
+    auto state = get_state();
+    const auto first = state->getValue(Parameters::FirstColumn).toInt();
+    auto count = state->getValue(Parameters::NumberOfColumns).toInt();
+    if (first < 0 || count < 0 || static_cast<size_t>(first) > stream->ncols())
+      THROW_ALGORITHM_INPUT_ERROR("Column window out of range.");
+    if (0 == count || static_cast<size_t>(first + count) > stream->ncols())
+      count = static_cast<int>(stream->ncols()) - first;
+
+    sendOutput(OutputMatrix, boost::make_shared<DenseMatrix>(stream->columns(first, count)));
+  }
+}
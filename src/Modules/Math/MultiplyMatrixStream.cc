@@ -0,0 +1,56 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Modules/Math/MultiplyMatrixStream.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Datatypes/MatrixStream.h>
+
+using namespace SCIRun::Modules::Math;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Dataflow::Networks;
+
+MODULE_INFO_DEF(MultiplyMatrixStream, Math, SCIRun)
+
+MultiplyMatrixStream::MultiplyMatrixStream() : Module(staticInfo_, false)
+{
+  INITIALIZE_PORT(Operator);
+  INITIALIZE_PORT(InputStream);
+  INITIALIZE_PORT(OutputStream);
+}
+
+void MultiplyMatrixStream::execute()
+{
+  auto op = getRequiredInput(Operator);
+  auto stream = getRequiredInput(InputStream);
+  if (needToExecute())
+  {
+    if (op->ncols() != stream->nrows())
+      THROW_ALGORITHM_INPUT_ERROR("Operator has " + std::to_string(op->ncols()) + " columns, stream has " + std::to_string(stream->nrows()) + " rows.");
+    sendOutput(OutputStream, stream->multiply(op));
+  }
+}
@@ -0,0 +1,61 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MODULES_MATH_MULTIPLYMATRIXSTREAM_H
+#define MODULES_MATH_MULTIPLYMATRIXSTREAM_H
+
+#include <Dataflow/Network/Module.h>
+#include <Modules/Math/share.h>
+
+namespace SCIRun {
+namespace Modules {
+namespace Math {
+
+  /// Left-multiplies every block of a matrix stream by a dense or sparse operator: a mapping
+  /// matrix, a lead field, or the RegInverse of SolveInverseProblemWithTikhonov (which it
+  /// produces when UseSpectralDecomposition is set).
+  /// Nothing is computed until a downstream module pulls the block.
+  class SCISHARE MultiplyMatrixStream : public Dataflow::Networks::Module,
+    public Has2InputPorts<MatrixPortTag, MatrixStreamPortTag>,
+    public Has1OutputPort<MatrixStreamPortTag>
+  {
+  public:
+    MultiplyMatrixStream();
+    virtual void execute() override;
+    virtual void setStateDefaults() override {}
+
+    INPUT_PORT(0, Operator, Matrix);
+    INPUT_PORT(1, InputStream, MatrixStream);
+    OUTPUT_PORT(0, OutputStream, MatrixStream);
+
+    MODULE_TRAITS_AND_INFO(NoAlgoOrUI)
+  };
+
+}}}
+
+#endif
@@ -31,6 +31,7 @@
 #include <Modules/Math/SolveLinearSystem.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
 #include <Core/Algorithms/Base/AlgorithmVariableNames.h>
+#include <Core/Algorithms/Math/LinearSystem/SolveLinearSystemAlgo.h>
 #include <Core/Datatypes/DenseMatrix.h>
 #include <Core/Datatypes/DenseColumnMatrix.h>
 #include <Core/Datatypes/MatrixTypeConversions.h>
@@ -40,6 +41,7 @@ using namespace SCIRun::Modules::Math;
 using namespace SCIRun::Core;
 using namespace SCIRun::Core::Datatypes;
 using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Math;
 using namespace SCIRun::Dataflow::Networks;
 using namespace SCIRun::Core::Logging;
 
@@ -56,6 +58,7 @@ void SolveLinearSystem::setStateDefaults()
   setStateIntFromAlgo(Variables::MaxIterations);
   setStateStringFromAlgoOption(Variables::Method);
   setStateStringFromAlgoOption(Variables::Preconditioner);
+  setStateStringFromAlgoOption(Parameters::SparseFormat);
 }
 
 void SolveLinearSystem::execute()
@@ -66,14 +69,25 @@ void SolveLinearSystem::execute()
   if (needToExecute())
   {
     /// @todo: why aren't these checks in the algo class?
-    if (rhs->ncols() != 1)
-      THROW_ALGORITHM_INPUT_ERROR("Right-hand side matrix must contain only one column.");
     if (!matrixIs::sparse(A))
       THROW_ALGORITHM_INPUT_ERROR("Left-hand side matrix to solve must be sparse.");
 
-    auto rhsCol = castMatrix::toColumn(rhs);
-    if (!rhsCol)
-      rhsCol = convertMatrix::toColumn(rhs);
+    // Several right-hand side columns are passed as one dense matrix and solved together
+    MatrixHandle rhsInput;
+    if (rhs->ncols() == 1)
+    {
+      auto rhsCol = castMatrix::toColumn(rhs);
+      if (!rhsCol)
+        rhsCol = convertMatrix::toColumn(rhs);
+      rhsInput = rhsCol;
+    }
+    else
+    {
+      auto rhsDense = castMatrix::toDense(rhs);
+      if (!rhsDense)
+        rhsDense = convertMatrix::toDense(rhs);
+      rhsInput = rhsDense;
+    }
 
     auto tolerance = get_state()->getValue(Variables::TargetError).toDouble();
     auto maxIterations = get_state()->getValue(Variables::MaxIterations).toInt();
@@ -90,6 +104,9 @@ void SolveLinearSystem::execute()
       algo().setOption(Variables::Method, method);
     if (!precond.empty())
       algo().setOption(Variables::Preconditioner, precond);
+    auto format = get_state()->getValue(Parameters::SparseFormat).toString();
+    if (!format.empty())
+      algo().setOption(Parameters::SparseFormat, format);
 
     std::ostringstream ostr;
     ostr << "Running algorithm Parallel " << method << " Solver with tolerance " << tolerance << " and maximum iterations " << maxIterations;
@@ -99,7 +116,7 @@ void SolveLinearSystem::execute()
       ScopedTimeRemarker perf(this, "Linear solver");
       remark("Using preconditioner: " + precond);
 
-      auto output = algo().run(withInputData((LHS, A)(RHS, rhsCol)));
+      auto output = algo().run(withInputData((LHS, A)(RHS, rhsInput)));
 
       sendOutputFromAlgorithm(Solution, output);
     }
@@ -50,6 +50,8 @@ namespace Math {
     INPUT_PORT(1, RHS, Matrix);
     OUTPUT_PORT(0, Solution, Matrix);
 
+    MEMOIZABLE_MODULE
+
     MODULE_TRAITS_AND_INFO(ModuleHasUIAndAlgorithm)
   };
 
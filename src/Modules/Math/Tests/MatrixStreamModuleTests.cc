@@ -0,0 +1,79 @@
+/*
+   For more information, please see: http://software.sci.utah.edu
+
+   The MIT License
+
+   Copyright (c) 2015 Scientific Computing and Imaging Institute,
+   University of Utah.
+
+   
+   Permission is hereby granted, free of charge, to any person obtaining a
+   copy of this software and associated documentation files (the "Software"),
+   to deal in the Software without restriction, including without limitation
+   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+   and/or sell copies of the Software, and to permit persons to whom the
+   Software is furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included
+   in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+   OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+   DEALINGS IN THE SOFTWARE.
+*/
+
+#include <Testing/ModuleTestBase/ModuleTestBase.h>
+#include <Modules/Math/MultiplyMatrixStream.h>
+#include <Modules/Math/GetMatrixStreamColumns.h>
+#include <Core/Datatypes/DenseMatrix.h>
+#include <Core/Datatypes/MatrixStream.h>
+#include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+
+using namespace SCIRun::Testing;
+using namespace SCIRun::Modules::Math;
+using namespace SCIRun::Core::Datatypes;
+using namespace SCIRun::Core::Algorithms;
+using namespace SCIRun::Core::Algorithms::Math;
+using namespace SCIRun::Dataflow::Networks;
+
+class MatrixStreamModuleTests : public ModuleTest
+{
+};
+
+TEST_F(MatrixStreamModuleTests, MultipliesAndReadsAWindow)
+{
+  auto data = boost::make_shared<DenseMatrix>(DenseMatrix::Random(3, 50));
+  auto op = boost::make_shared<DenseMatrix>(DenseMatrix::Random(2, 3));
+
+  auto multiply = makeModule("MultiplyMatrixStream");
+  stubPortNWithThisData(multiply, 0, op);
+  stubPortNWithThisData(multiply, 1, MatrixStream::fromMatrix(data, 8));
+  connectDummyOutputConnection(multiply, 0);
+  EXPECT_NO_THROW(multiply->execute());
+  auto product = boost::dynamic_pointer_cast<MatrixStream>(getDataOnThisOutputPort(multiply, 0));
+  ASSERT_TRUE(product != nullptr);
+  EXPECT_EQ(2, product->nrows());
+  EXPECT_EQ(50, product->ncols());
+
+  auto window = makeModule("GetMatrixStreamColumns");
+  window->get_state()->setValue(Parameters::FirstColumn, 10);
+  window->get_state()->setValue(Parameters::NumberOfColumns, 5);
+  stubPortNWithThisData(window, 0, product);
+  connectDummyOutputConnection(window, 0);
+  EXPECT_NO_THROW(window->execute());
+  auto columns = boost::dynamic_pointer_cast<DenseMatrix>(getDataOnThisOutputPort(window, 0));
+  ASSERT_TRUE(columns != nullptr);
+  EXPECT_TRUE(columns->isApprox(*op * data->middleCols(10, 5)));
+}
+
+TEST_F(MatrixStreamModuleTests, ThrowsForMismatchedOperator)
+{
+  auto multiply = makeModule("MultiplyMatrixStream");
+  stubPortNWithThisData(multiply, 0, boost::make_shared<DenseMatrix>(DenseMatrix::Zero(2, 4)));
+  stubPortNWithThisData(multiply, 1, MatrixStream::fromMatrix(boost::make_shared<DenseMatrix>(DenseMatrix::Zero(3, 10)), 4));
+  EXPECT_THROW(multiply->execute(), AlgorithmInputException);
+}
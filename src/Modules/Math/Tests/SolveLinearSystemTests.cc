@@ -29,6 +29,7 @@
 #include <Testing/ModuleTestBase/ModuleTestBase.h>
 #include <Modules/Math/SolveLinearSystem.h>
 #include <Core/Algorithms/Base/AlgorithmPreconditions.h>
+#include <Core/Algorithms/Base/AlgorithmVariableNames.h>
 #include <Core/Datatypes/DenseMatrix.h>
 #include <Core/Datatypes/SparseRowMatrix.h>
 
@@ -83,4 +84,40 @@ TEST_F(SolveLinearSystemModuleTest, CanSolveSimple)
   stubPortNWithThisData(sls, 1, rhs);
 
   sls->execute();
-}
\ No newline at end of file
+}
+
+TEST_F(SolveLinearSystemModuleTest, CanSolveMultipleColumns)
+{
+  UseRealAlgorithmFactory f;
+
+  auto sls = makeModule("SolveLinearSystem");
+  SparseRowMatrixHandle lhs(new SparseRowMatrix(3,3));
+  for (int i = 0; i < 3; ++i)
+  {
+    lhs->insert(i,i) = 4;
+    if (i > 0)
+      lhs->insert(i,i-1) = lhs->insert(i-1,i) = -1;
+  }
+  lhs->makeCompressed();
+  DenseMatrixHandle rhs(new DenseMatrix(3,2));
+  *rhs << 1, 0,
+          2, -1,
+          3, 5;
+
+  stubPortNWithThisData(sls, 0, lhs);
+  stubPortNWithThisData(sls, 1, rhs);
+
+  sls->execute();
+
+  auto solution = boost::dynamic_pointer_cast<DenseMatrix>(getDataOnThisOutputPort(sls, 0));
+  ASSERT_TRUE(solution != nullptr);
+  ASSERT_EQ(3, solution->nrows());
+  ASSERT_EQ(2, solution->ncols());
+  const double targetError = sls->get_state()->getValue(Variables::TargetError).toDouble();
+  for (int j = 0; j < 2; ++j)
+  {
+    const Eigen::VectorXd b = rhs->col(j);
+    const double residual = (*lhs * solution->col(j) - b).norm();
+    EXPECT_LE(residual, targetError * b.norm()) << "column " << j;
+  }
+}
@@ -506,6 +506,8 @@ void GeometryBuilder::renderFacesLinear(
   mesh->get_nodes(nodes, *fiter);
   mesh->get_point(idpt, nodes[0]);
 
+  VMesh::PointSpan nodePoints = mesh->node_span();
+
   while (fiter != fiterEnd)
   {
     interruptible->checkForInterruption();
@@ -517,7 +519,10 @@ void GeometryBuilder::renderFacesLinear(
 
     for (size_t i = 0; i < nodes.size(); i++)
     {
-      mesh->get_point(points[i], nodes[i]);
+      if (nodePoints.empty())
+        mesh->get_point(points[i], nodes[i]);
+      else
+        points[i] = nodePoints[nodes[i]];
     }
 
     //TODO fix so the withNormals tp be woth lighting is called correctly, and the meshes are fixed.
@@ -1250,13 +1255,19 @@ void GeometryBuilder::renderNodes(
   if (state.get(RenderState::USE_SPHERE))
     primIn = SpireIBO::PRIMITIVE::TRIANGLES;
 
+  // Irregular meshes hand out their node storage directly
+  VMesh::PointSpan nodePoints = mesh->node_span();
+
   GlyphGeom glyphs;
   while (eiter != eiter_end)
   {
     interruptible->checkForInterruption();
 
     Point p;
-    mesh->get_point(p, *eiter);
+    if (nodePoints.empty())
+      mesh->get_point(p, *eiter);
+    else
+      p = nodePoints[*eiter];
     //coloring options
     if (colorScheme != ColorScheme::COLOR_UNIFORM)
     {
@@ -289,6 +289,37 @@ FieldHandle CubeTriSurfLinearBasis(data_info_type type)
   return field;
 }
 
+FieldHandle TetBlockTetVolConstantBasis(int n, data_info_type type)
+{
+  FieldInformation fi(TETVOLMESH_E, CONSTANTDATA_E, type);
+  FieldHandle field = CreateField(fi);
+  VMesh* mesh = field->vmesh();
+
+  for (int k = 0; k <= n; k++)
+    for (int j = 0; j <= n; j++)
+      for (int i = 0; i <= n; i++)
+        mesh->add_point(Point(i, j, k));
+
+  static const int tets[6][4] = { {0,1,3,7}, {0,1,7,5}, {0,5,7,4},
+                                  {0,3,2,7}, {0,2,6,7}, {0,6,4,7} };
+  VMesh::Node::array_type nodes(4);
+  for (int k = 0; k < n; k++)
+    for (int j = 0; j < n; j++)
+      for (int i = 0; i < n; i++)
+        for (int t = 0; t < 6; t++)
+        {
+          for (int q = 0; q < 4; q++)
+          {
+            const int b = tets[t][q];
+            nodes[q] = ((k + ((b>>2)&1))*(n+1) + j + ((b>>1)&1))*(n+1) + i + (b&1);
+          }
+          mesh->add_elem(nodes);
+        }
+  field->vfield()->resize_values();
+
+  return field;
+}
+
 }}
 
 FieldHandle SCIRun::TestUtils::CreateEmptyLatVol()
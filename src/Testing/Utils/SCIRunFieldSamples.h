@@ -90,6 +90,9 @@ SCISHARE FieldHandle CubeTriSurfLinearBasis(data_info_type type);
 SCISHARE FieldHandle TetrahedronTriSurfConstantBasis(data_info_type type);
 SCISHARE FieldHandle TetrahedronTriSurfLinearBasis(data_info_type type);
 
+/// Block of n*n*n unit cubes, each split into 6 tets
+SCISHARE FieldHandle TetBlockTetVolConstantBasis(int n, data_info_type type = DOUBLE_E);
+
 SCISHARE FieldHandle CreateEmptyLatVol();
 SCISHARE FieldHandle CreateEmptyLatVol(size_type sizex, size_type sizey, size_type sizez, 
   data_info_type type = DOUBLE_E,